@@ -39,12 +39,29 @@
 
 #include "dtn_bpsec.h"
 #include "dtn_cbor.h"
+#include "dtn_cbor_view.h"
 #include <stdio.h>
 
 #include <dtn_base/dtn_buffer.h>
 #include <dtn_core/dtn_key_store.h>
 
 typedef struct dtn_bundle dtn_bundle;
+typedef struct dtn_bundle_decoder dtn_bundle_decoder;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_bundle_decoder_config {
+
+    struct {
+
+        void *userdata;
+
+        // closed primary (index 0) and canonical blocks
+        void (*block)(void *userdata, const dtn_cbor *block, uint64_t index);
+
+    } callbacks;
+
+} dtn_bundle_decoder_config;
 
 /*
  *      ------------------------------------------------------------------------
@@ -71,6 +88,14 @@ void *dtn_bundle_free_void(void *self);
  *      ------------------------------------------------------------------------
  */
 
+/**
+ *      Decode a bundle.
+ *
+ *      All items of a decoded bundle are allocated within an arena owned by
+ *      the bundle (@see dtn_cbor_arena.h) and released at once with the
+ *      bundle. Items of a decoded bundle MUST NOT outlive the bundle,
+ *      use dtn_cbor_copy to keep an item.
+ */
 dtn_cbor_match dtn_bundle_decode(const uint8_t *buffer, size_t size,
                                  dtn_bundle **out, uint8_t **next);
 
@@ -83,6 +108,95 @@ bool dtn_bundle_encode(dtn_bundle *self, uint8_t *buffer, size_t size,
 
 uint64_t dtn_bundle_encoding_size(const dtn_bundle *self);
 
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      STREAMING DECODER
+ *
+ *      ------------------------------------------------------------------------
+ *
+ *      A decoder keeps its parse position across calls. Each push parses
+ *      only the newly appended bytes, so a bundle received in pieces
+ *      is decoded in linear time.
+ */
+
+dtn_bundle_decoder *dtn_bundle_decoder_create(dtn_bundle_decoder_config config);
+dtn_bundle_decoder *dtn_bundle_decoder_cast(const void *data);
+void *dtn_bundle_decoder_free(void *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Drop all buffered bytes and any partially decoded bundle.
+ */
+bool dtn_bundle_decoder_reset(dtn_bundle_decoder *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Append size bytes of buffer and continue decoding.
+ *
+ *      Returns DTN_CBOR_MATCH_FULL and sets out to the first completed
+ *      bundle. Bytes following the bundle stay buffered, push again with
+ *      size 0 to decode them.
+ *
+ *      Returns DTN_CBOR_MATCH_PARTIAL if more bytes are required.
+ *
+ *      Returns DTN_CBOR_NO_MATCH on invalid input, the decoder is reset.
+ */
+dtn_cbor_match dtn_bundle_decoder_push(dtn_bundle_decoder *self,
+                                       const uint8_t *buffer, size_t size,
+                                       dtn_bundle **out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Number of buffered bytes not yet consumed by a decoded item.
+ */
+size_t dtn_bundle_decoder_pending(const dtn_bundle_decoder *self);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ZERO COPY VIEW
+ *
+ *      ------------------------------------------------------------------------
+ *
+ *      Read only access to an encoded bundle without decoding it to
+ *      dtn_cbor items, see dtn_cbor_view.h. The view checks the bundle
+ *      layout only, CRCs are NOT checked.
+ */
+
+dtn_cbor_match dtn_bundle_view_decode(const uint8_t *buffer, size_t size,
+                                      dtn_cbor_view *view, uint8_t **next);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Get the view index of the block array at position nbr,
+ *      position 0 is the primary block.
+ *
+ *      @returns index or -1
+ */
+int64_t dtn_bundle_view_get_block(const dtn_cbor_view *view, uint64_t nbr);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Get the block type specific data of the canonical block
+ *      at view index block in place.
+ */
+bool dtn_bundle_view_get_data(const dtn_cbor_view *view, int64_t block,
+                              const uint8_t **data, size_t *size);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Get the payload in place.
+ */
+bool dtn_bundle_view_get_payload(const dtn_cbor_view *view,
+                                 const uint8_t **data, size_t *size);
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -165,6 +279,17 @@ bool dtn_bundle_primary_set_fragment_offset(dtn_bundle *self, uint64_t type);
 uint64_t dtn_bundle_primary_get_totel_data_length(const dtn_bundle *self);
 bool dtn_bundle_primary_set_total_data_length(dtn_bundle *self, uint64_t type);
 
+/*----------------------------------------------------------------------------*/
+
+/**
+        Write the bundle id "source|timestamp|sequence|fragment offset",
+        which identifies a bundle (fragment) network wide.
+
+        @param id       buffer to write the id to
+        @param size     size of id, false if the id does not fit
+*/
+bool dtn_bundle_primary_get_id(const dtn_bundle *self, char *id, size_t size);
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -244,12 +369,29 @@ dtn_cbor *dtn_bundle_add_previous_node(dtn_bundle *self, const char *node_id);
 
 /*----------------------------------------------------------------------------*/
 
+/**
+ *      Block type specific data of the bundle age and hop count blocks is
+ *      the CBOR encoding of the values within a byte string.
+ */
 dtn_cbor *dtn_bundle_add_bundle_age(dtn_bundle *self, uint64_t age);
+bool dtn_bundle_get_bundle_age(dtn_bundle *self, uint64_t *age);
+
+/**
+ *      Set the age of an existing bundle age block.
+ */
+bool dtn_bundle_set_bundle_age(dtn_bundle *self, uint64_t age);
 
 /*----------------------------------------------------------------------------*/
 
 dtn_cbor *dtn_bundle_add_hop_count(dtn_bundle *self, uint64_t count,
                                    uint64_t limit);
+bool dtn_bundle_get_hop_count(dtn_bundle *self, uint64_t *count,
+                              uint64_t *limit);
+
+/**
+ *      Set the count of an existing hop count block, the limit is kept.
+ */
+bool dtn_bundle_set_hop_count(dtn_bundle *self, uint64_t count);
 
 /*
  *      ------------------------------------------------------------------------
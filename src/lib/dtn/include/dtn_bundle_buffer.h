@@ -26,17 +26,51 @@
 
         This is a buffer for dtn_bundles, which may be fragmeneted.
 
+        The buffer is safe to be pushed to from several threads. Pending
+        reassemblies are spread over limits.shards shards by a hash of
+        the bundle key, each with its own lock. Expired reassemblies are
+        dropped incrementally, one shard per cleanup timer.
+
+        Delivered bundles are remembered for limits.history_secs within a
+        dtn_duplicate_filter per shard to drop late fragments, the filter
+        type and the memory for all shards is set in history.
+
+        Security blocks are processed per pushed bundle, i.e. each fragment
+        is unprotected and verified at arrival, before its shard is locked.
+        Reassembly copies verified plaintext only, so delivery of the last
+        fragment costs the same as of any other fragment.
+
+        With limits.workers set, pushed bundles are queued and processed
+        by a pool of worker threads, which spreads unprotect and verify of
+        fragments over several cores. Payload callbacks are then called
+        from the worker threads, in no particular order. If the queue is
+        full, push processes the bundle within the pushing thread.
+
+        The payload of a reassembly is allocated with the first fragment
+        of its bundle. Allocations of all pending reassemblies are limited
+        to limits.max_pending_bytes, fragments of new bundles are rejected
+        while the budget is exhausted and counted in dtn_bundle_buffer_stats.
+
         ------------------------------------------------------------------------
 */
 #ifndef dtn_bundle_buffer_h
 #define dtn_bundle_buffer_h
 
 #include "dtn_bundle.h"
+#include "dtn_duplicate_filter.h"
 #include <dtn_base/dtn_buffer.h>
 #include <dtn_base/dtn_event_loop.h>
 
 /*---------------------------------------------------------------------------*/
 
+#define DTN_BUNDLE_BUFFER_MAX_PAYLOAD_DEFAULT 64 * 1024 * 1024
+#define DTN_BUNDLE_BUFFER_MAX_PENDING_DEFAULT 256 * 1024 * 1024
+#define DTN_BUNDLE_BUFFER_SHARDS_DEFAULT 64
+#define DTN_BUNDLE_BUFFER_HISTORY_MEMORY_DEFAULT 16 * 1024 * 1024
+#define DTN_BUNDLE_BUFFER_QUEUE_DEFAULT 1024
+
+/*---------------------------------------------------------------------------*/
+
 typedef struct dtn_bundle_buffer dtn_bundle_buffer;
 
 /*---------------------------------------------------------------------------*/
@@ -52,8 +86,41 @@ typedef struct dtn_bundle_buffer_config {
         uint64_t threadlock_timeout_usecs;
         uint64_t history_secs;
 
+        // largest total data length of a fragmented bundle,
+        // 0 for DTN_BUNDLE_BUFFER_MAX_PAYLOAD_DEFAULT
+        uint64_t max_payload_bytes;
+
+        // sum of the total data lengths of all pending reassemblies,
+        // 0 for DTN_BUNDLE_BUFFER_MAX_PENDING_DEFAULT
+        uint64_t max_pending_bytes;
+
+        // number of independently locked shards,
+        // 0 for DTN_BUNDLE_BUFFER_SHARDS_DEFAULT
+        uint64_t shards;
+
+        // threads processing pushed bundles,
+        // 0 to process within the pushing thread
+        uint64_t workers;
+
+        // bundles queued for the workers,
+        // 0 for DTN_BUNDLE_BUFFER_QUEUE_DEFAULT
+        uint64_t queue_size;
+
     } limits;
 
+    struct {
+
+        dtn_duplicate_filter_type type;
+
+        // memory of all shards,
+        // 0 for DTN_BUNDLE_BUFFER_HISTORY_MEMORY_DEFAULT
+        uint64_t memory_bytes;
+
+        // Bloom only, expected bundles within limits.history_secs
+        uint64_t capacity;
+
+    } history;
+
     struct {
 
         void *userdata;
@@ -67,6 +134,15 @@ typedef struct dtn_bundle_buffer_config {
 
 } dtn_bundle_buffer_config;
 
+/*---------------------------------------------------------------------------*/
+
+typedef struct dtn_bundle_buffer_stats {
+
+    uint64_t pending_bytes; // allocated by pending reassemblies
+    uint64_t rejected;      // reassemblies rejected over max_pending_bytes
+
+} dtn_bundle_buffer_stats;
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -80,10 +156,36 @@ dtn_bundle_buffer *dtn_bundle_buffer_free(dtn_bundle_buffer *self);
 
 /*----------------------------------------------------------------------------*/
 
+/**
+        Push a bundle, the buffer takes ownership.
+
+        Unfragmented bundles are delivered at once. Fragments are
+        reassembled by source, creation timestamp and sequence number,
+        each payload is copied to its fragment offset within a buffer of
+        the total data length. Overlapping and duplicate fragments are
+        accepted, the payload is delivered once all bytes were received.
+
+        With workers push returns once the bundle is queued, failures of
+        processing are logged only.
+*/
 bool dtn_bundle_buffer_push(dtn_bundle_buffer *self, dtn_bundle *bundle);
 
 /*----------------------------------------------------------------------------*/
 
 bool dtn_bundle_buffer_clear(dtn_bundle_buffer *self);
 
+/*----------------------------------------------------------------------------*/
+
+/**
+        Statistics of the history summed up over all shards, the false
+        positive rate is the mean of all shards.
+*/
+bool dtn_bundle_buffer_get_history_stats(dtn_bundle_buffer *self,
+                                         dtn_duplicate_filter_stats *stats);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_buffer_get_stats(dtn_bundle_buffer *self,
+                                 dtn_bundle_buffer_stats *stats);
+
 #endif /* dtn_bundle_buffer_h */
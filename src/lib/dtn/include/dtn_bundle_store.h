@@ -0,0 +1,216 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_bundle_store.h
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        Persistent store of encoded bundles, to hold bundles in custody
+        over link outages and restarts.
+
+        Bundles are appended to preallocated segment files of
+        config.limits.segment_size, which are memory mapped. Each record
+        carries a CRC32C over its content. The index of records by id,
+        destination, expiry and priority is kept in a memory mapped
+        index file.
+
+        The index file is only trusted after a clean shutdown. Otherwise
+        it is rebuild from the segment files, scanning each segment up to
+        the first invalid record. Removed records are marked within their
+        segment, a segment file is deleted once it holds no live record.
+        dtn_bundle_store_compact moves the records of sparse segments to
+        the active segment.
+
+        Expiry is kept in real time, to survive restarts.
+
+        With config.sync set each record is synced to disk when written
+        or removed, otherwise syncing is left to the kernel.
+
+        Functions are thread safe.
+
+        ------------------------------------------------------------------------
+*/
+#ifndef dtn_bundle_store_h
+#define dtn_bundle_store_h
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DTN_BUNDLE_STORE_SEGMENT_SIZE 16 * 1024 * 1024
+#define DTN_BUNDLE_STORE_SEGMENTS_MAX 64
+#define DTN_BUNDLE_STORE_RECORDS 65536
+
+#define DTN_BUNDLE_STORE_ID_MAX 1024
+#define DTN_BUNDLE_STORE_DESTINATION_MAX 1024
+
+typedef struct dtn_bundle_store dtn_bundle_store;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_bundle_store_config {
+
+    char path[PATH_MAX];
+
+    bool sync;
+
+    struct {
+
+        uint64_t segment_size; // bytes per segment file
+        uint64_t segments;     // segment files, max SEGMENTS_MAX
+        uint64_t records;      // records of the index
+
+        uint64_t threadlock_timeout_usecs;
+
+    } limits;
+
+} dtn_bundle_store_config;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_bundle_store_record {
+
+    const char *id;
+    const char *destination;
+
+    uint64_t lifetime_usecs; // 0 to never expire
+    uint8_t priority;        // highest first
+
+} dtn_bundle_store_record;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_bundle_store_stats {
+
+    uint64_t records;  // live records
+    uint64_t bytes;    // bytes of live records
+    uint64_t segments; // segment files
+    uint64_t capacity; // records of the index
+
+    uint64_t expired;   // records removed by expiry
+    uint64_t compacted; // segments removed by compaction
+
+} dtn_bundle_store_stats;
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+        Open the store at config.path, the directory is created if not
+        present. Records of a previous store at path are recovered.
+*/
+dtn_bundle_store *dtn_bundle_store_create(dtn_bundle_store_config config);
+
+dtn_bundle_store *dtn_bundle_store_cast(const void *data);
+void *dtn_bundle_store_free(void *self);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+        Store a copy of data.
+
+        @returns false if the id is already stored or the store is full
+*/
+bool dtn_bundle_store_put(dtn_bundle_store *self,
+                          dtn_bundle_store_record record, const uint8_t *data,
+                          size_t size);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_store_contains(dtn_bundle_store *self, const char *id);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_store_remove(dtn_bundle_store *self, const char *id);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Hand all records of destination to send, highest priority
+        first and in order of storage within a priority. Expired records
+        are removed.
+
+        data of send points into the segment file and is valid within
+        send only. expires_usecs is the real time the record expires
+        at, 0 without expiry. Records send returns true for are removed.
+        send is called under the lock of the store and MUST NOT call
+        functions of the store.
+
+        @param destination      destination to drain, NULL for all
+        @returns number of removed records, expired records excluded
+*/
+int64_t dtn_bundle_store_drain(
+    dtn_bundle_store *self, const char *destination,
+    bool (*send)(void *userdata, const char *destination, const uint8_t *data,
+                 size_t size, uint64_t expires_usecs),
+    void *userdata);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Hand each destination of stored records to found once. found is
+        called under the lock of the store and MUST NOT call functions
+        of the store.
+
+        @returns number of destinations
+*/
+int64_t dtn_bundle_store_destinations(
+    dtn_bundle_store *self,
+    bool (*found)(void *userdata, const char *destination), void *userdata);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Remove expired records.
+
+        @returns number of removed records
+*/
+int64_t dtn_bundle_store_expire(dtn_bundle_store *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Expire records, move the records of segments less than half
+        used to the active segment and delete those segments.
+
+        @returns number of deleted segments
+*/
+int64_t dtn_bundle_store_compact(dtn_bundle_store *self);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_store_get_stats(dtn_bundle_store *self,
+                                dtn_bundle_store_stats *stats);
+
+#endif /* dtn_bundle_store_h */
@@ -127,6 +127,25 @@ void *dtn_cbor_copy(void **copy, void *self);
  */
 bool dtn_cbor_configure(dtn_cbor_config config);
 
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Enables caching of up to capacity released items per thread and
+ *  of up to capacity arenas (@see dtn_cbor_arena.h).
+ *
+ *  BEWARE: Call dtn_cbor_cache_flush() and dtn_registered_cache_free_all()
+ *  before exiting your process to avoid memleaks!
+ */
+void dtn_cbor_enable_caching(size_t capacity);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Release the cached items of the calling thread. Caches of other threads
+ *  are released on thread exit.
+ */
+void dtn_cbor_cache_flush();
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -186,8 +205,65 @@ bool dtn_cbor_encode_array_of_indefinite_length(const dtn_cbor *value,
 
 /*----------------------------------------------------------------------------*/
 
+/**
+ *  Encode the head of a byte string only, i.e. the encoding of value
+ *  without its content. Used to stream large byte strings.
+ *
+ *  @param value    byte string to encode the head of
+ *  @param buffer   pointer to buffer, 9 bytes are always sufficient
+ *  @param size     size of buffer
+ *  @param next     pointer to next byte after encoded head
+ */
+bool dtn_cbor_encode_string_head(const dtn_cbor *value, uint8_t *buffer,
+                                 size_t size, uint8_t **next);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Encoding size of value, may be larger than the actual encoding.
+ *
+ *  Arrays and maps cache their size until some item is changed by a
+ *  setter, so encoding a tree shared between threads needs the same lock
+ *  as changing it.
+ */
 uint64_t dtn_cbor_encoding_size(const dtn_cbor *value);
 
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ENCODING CACHE
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+ *  Mark self and all containers of self as changed. All setters do this,
+ *  call it after writing through pointers returned by a getter.
+ */
+void dtn_cbor_touch(dtn_cbor *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Keep a copy of the encoding of an array or map, encode will copy it
+ *  until self or some item of self is changed.
+ *
+ *  @param self     array or map
+ *  @param buffer   encoding of self, MUST be valid CBOR of self
+ *  @param size     size of buffer
+ */
+bool dtn_cbor_cache_encoding(dtn_cbor *self, const uint8_t *buffer,
+                             size_t size);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Get the encoding of an array or map cached with
+ *  dtn_cbor_cache_encoding, if it is still valid.
+ */
+bool dtn_cbor_get_cached_encoding(const dtn_cbor *self,
+                                  const uint8_t **buffer, size_t *size);
+
 /*
  *      ------------------------------------------------------------------------
  *
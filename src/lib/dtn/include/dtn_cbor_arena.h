@@ -0,0 +1,136 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_cbor_arena.h
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        Bump allocator for dtn_cbor items.
+
+        While an arena is activated for the calling thread, all dtn_cbor
+        items and their string content are allocated within the arena.
+        Freeing such an item does not release its memory, the memory is
+        released at once with dtn_cbor_arena_reset or dtn_cbor_arena_free.
+
+        Items allocated within an arena MUST NOT outlive the arena,
+        use dtn_cbor_copy to keep an item.
+
+        Containers (arrays and maps) still allocate their internal storage
+        on the heap and are released on dtn_cbor_free.
+
+        ------------------------------------------------------------------------
+*/
+#ifndef dtn_cbor_arena_h
+#define dtn_cbor_arena_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DTN_CBOR_ARENA_DEFAULT_CHUNK_SIZE 4096
+
+typedef struct dtn_cbor_arena dtn_cbor_arena;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_cbor_arena_config {
+
+    size_t chunk_size; // default DTN_CBOR_ARENA_DEFAULT_CHUNK_SIZE
+
+} dtn_cbor_arena_config;
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_cbor_arena *dtn_cbor_arena_create(dtn_cbor_arena_config config);
+dtn_cbor_arena *dtn_cbor_arena_cast(const void *data);
+
+/**
+ *      Free the arena. If caching is enabled, the arena is reset and
+ *      returned to the cache.
+ */
+void *dtn_cbor_arena_free(void *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Release all allocations of the arena at once.
+ *      The first chunk is kept for reuse.
+ */
+bool dtn_cbor_arena_reset(dtn_cbor_arena *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Allocate zeroed memory of size within the arena.
+ *      Allocations bigger than half of a chunk get a chunk on their own.
+ */
+void *dtn_cbor_arena_alloc(dtn_cbor_arena *self, size_t size);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Bytes allocated since create or the last reset.
+ */
+size_t dtn_cbor_arena_used(const dtn_cbor_arena *self);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ACTIVATION
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+ *      Activate an arena for the calling thread.
+ *
+ *      @param self     arena to activate, NULL to deactivate
+ *      @returns        previous active arena of the thread
+ */
+dtn_cbor_arena *dtn_cbor_arena_activate(dtn_cbor_arena *self);
+
+/*----------------------------------------------------------------------------*/
+
+dtn_cbor_arena *dtn_cbor_arena_active();
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CACHING
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+ *      Enables caching of arenas.
+ *      BEWARE: Call dtn_registered_cache_free_all() before exiting your
+ *      process to avoid memleaks!
+ */
+void dtn_cbor_arena_enable_caching(size_t capacity);
+
+#endif /* dtn_cbor_arena_h */
@@ -0,0 +1,153 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_cbor_view.h
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        Read only zero copy view of CBOR encoded data.
+
+        A view decodes a buffer into a flat array of items in pre-order.
+        Items point into the decoded buffer, no string is copied and no
+        item is allocated on its own. The buffer MUST outlive the view.
+
+        Children of a container follow the container, item.next is the
+        index of the next sibling, so a whole subtree is skipped in one step.
+
+        Indefinite length strings are not supported.
+
+        ------------------------------------------------------------------------
+*/
+#ifndef dtn_cbor_view_h
+#define dtn_cbor_view_h
+
+#include "dtn_cbor.h"
+
+#define DTN_CBOR_VIEW_MAX_DEPTH 32
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_cbor_view_item {
+
+    dtn_cbor_type type;
+
+    const uint8_t *start; // first byte of the encoded item
+    size_t size;          // encoded size including all children
+
+    // uint value, raw argument of negative ints, string length,
+    // number of array items or map pairs, tag number, simple value
+    // or raw bits of a float
+    uint64_t value;
+
+    const uint8_t *data; // string content or NULL
+
+    uint32_t next; // index of next sibling
+
+} dtn_cbor_view_item;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_cbor_view {
+
+    dtn_cbor_view_item *items;
+    size_t count;
+    size_t capacity;
+
+    bool owned;
+
+} dtn_cbor_view;
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+ *      Init a view.
+ *
+ *      @param view     view to init
+ *      @param items    caller provided item storage, if NULL the view
+ *                      allocates and grows its own storage
+ *      @param capacity number of items in storage
+ */
+bool dtn_cbor_view_init(dtn_cbor_view *view, dtn_cbor_view_item *items,
+                        size_t capacity);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Release storage allocated by the view.
+ */
+bool dtn_cbor_view_clear(dtn_cbor_view *view);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Decode the CBOR item at buffer into view.
+ *
+ *      Returns DTN_CBOR_NO_MATCH if the data is invalid or a view with
+ *      caller provided storage is too small.
+ *
+ *      @param buffer   pointer to buffer to decode
+ *      @param size     size of buffer
+ *      @param view     view to fill
+ *      @param next     pointer to next byte after decoded value
+ */
+dtn_cbor_match dtn_cbor_view_decode(const uint8_t *buffer, size_t size,
+                                    dtn_cbor_view *view, uint8_t **next);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ITEM ACCESS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+const dtn_cbor_view_item *dtn_cbor_view_get(const dtn_cbor_view *view,
+                                            size_t index);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Get the index of the child nbr of the array at index.
+ *      For maps keys are at even, values at odd positions.
+ *
+ *      @returns index of the child or -1
+ */
+int64_t dtn_cbor_view_child(const dtn_cbor_view *view, size_t index,
+                            uint64_t nbr);
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_cbor_view_count(const dtn_cbor_view_item *item);
+
+bool dtn_cbor_view_get_uint(const dtn_cbor_view_item *item, uint64_t *out);
+bool dtn_cbor_view_get_int(const dtn_cbor_view_item *item, int64_t *out);
+
+bool dtn_cbor_view_get_string(const dtn_cbor_view_item *item,
+                              const uint8_t **data, size_t *size);
+
+#endif /* dtn_cbor_view_h */
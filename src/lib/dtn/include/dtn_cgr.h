@@ -0,0 +1,200 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_cgr.h
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        Contact Graph Routing over a plan of scheduled contacts.
+
+        A contact is a link from one node to another, open from start to
+        end with a transmission rate and a one way light time (OWLT).
+        Routes are searched for the earliest arrival at the destination,
+        with bundles waiting at nodes for the next usable contact.
+
+        Up to config.limits.routes routes are computed per destination,
+        each over another neighbor of the local node, earliest arrival
+        first. Route lists are cached per destination with the time and
+        bundle size of the computation. Cached routes are computed again
+        at lookup for a smaller bundle or an earlier time, or once one of
+        them became unusable or arrives out of order. With the limit of
+        routes reached, also once one arrives later than the last route
+        arrived at the computation, as a route not cached may be better.
+        Changed contacts invalidate only the destinations they may change:
+        added contacts those which could arrive earlier, removed contacts
+        those with a route over the contact.
+
+        Nodes are the name of an endpoint "dtn://name/demux" or the node
+        of an endpoint "ipn:node.service" written as "ipn:node".
+
+        Contact plans are JSON files of contacts and the next hop of
+        neighbors, times in seconds of real time, negative times are 0.
+        Rates are bytes per second, 0 or none for unlimited, a plan with
+        a negative rate is invalid:
+
+        {
+            "contacts" : [
+                {
+                    "from" : "a", "to" : "b",
+                    "start" : 1000, "end" : 2000,
+                    "rate" : 125000, "owlt" : 1
+                }
+            ],
+            "hops" : {
+                "b" : {
+                    "interface" : "127.0.0.1",
+                    "socket" : {"host":"127.0.0.1", "port":4556, "type":"UDP"}
+                }
+            }
+        }
+
+        Functions are thread safe.
+
+        ------------------------------------------------------------------------
+*/
+#ifndef dtn_cgr_h
+#define dtn_cgr_h
+
+#include "dtn_routing.h"
+
+#define DTN_CGR_NODE_MAX DTN_HOST_NAME_MAX
+#define DTN_CGR_ROUTES_MAX 4
+#define DTN_CGR_HOPS_MAX 32
+
+typedef struct dtn_cgr dtn_cgr;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_cgr_config {
+
+    char node[DTN_CGR_NODE_MAX]; // local node
+
+    struct {
+
+        uint64_t routes; // per destination, max DTN_CGR_ROUTES_MAX
+        uint64_t threadlock_timeout_usecs;
+
+    } limits;
+
+} dtn_cgr_config;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_cgr_contact {
+
+    const char *from;
+    const char *to;
+
+    uint64_t start_usecs; // real time
+    uint64_t end_usecs;   // real time
+
+    uint64_t rate;       // bytes per second, 0 for unlimited
+    uint64_t owlt_usecs; // one way light time
+
+} dtn_cgr_contact;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_cgr_stats {
+
+    uint64_t contacts;    // contacts of the plan
+    uint64_t nodes;       // nodes of the plan
+    uint64_t computed;    // route lists computed
+    uint64_t cached;      // lookups answered from the cache
+    uint64_t invalidated; // route lists invalidated by contact changes
+
+} dtn_cgr_stats;
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_cgr *dtn_cgr_create(dtn_cgr_config config);
+dtn_cgr *dtn_cgr_free(dtn_cgr *self);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CONTACT PLAN
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+        Replace the contacts and hops with the contact plan at path.
+        The current plan stays if the file is not a valid contact plan.
+*/
+bool dtn_cgr_load(dtn_cgr *self, const char *path);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        @returns id of the contact, -1 on error
+*/
+int64_t dtn_cgr_contact_add(dtn_cgr *self, dtn_cgr_contact contact);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cgr_contact_remove(dtn_cgr *self, uint64_t id);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Set the next hop used for routes over neighbor node.
+*/
+bool dtn_cgr_set_hop(dtn_cgr *self, const char *node,
+                     const dtn_routing_info *hop);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ROUTING
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+        Find the routes to the node of eid for a bundle of size bytes sent
+        at now_usecs, earliest arrival first. Routes over neighbors
+        without a next hop are left out. Routes are of class
+        DTN_ROUTING_CONTACT.
+
+        @param routes   array to fill
+        @param starts   optional array to fill with the start of the first
+                        contact of each route, which is before or at
+                        now_usecs if the contact is open
+        @param max      size of routes and starts
+        @returns number of routes written, -1 on error
+*/
+int64_t dtn_cgr_lookup(dtn_cgr *self, const char *eid, uint64_t now_usecs,
+                       uint64_t size, dtn_routing_info *routes,
+                       uint64_t *starts, size_t max);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cgr_get_stats(dtn_cgr *self, dtn_cgr_stats *stats);
+
+#endif /* dtn_cgr_h */
@@ -0,0 +1,148 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_duplicate_filter.h
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        Duplicate detection of keys seen within a history time, within a
+        fixed memory budget. Keys are reduced to 128 bit hashes.
+
+        DTN_DUPLICATE_FILTER_EXACT keeps the hashes in a ring ordered by
+        insertion time with a compact index. It is exact up to hash
+        collisions. If the ring is full the oldest hash is evicted before
+        its history time.
+
+        DTN_DUPLICATE_FILTER_BLOOM keeps time sliced Bloom filters, the
+        oldest slice is cleared on rotation. It may report false
+        positives, but keeps any key for at least the history time.
+
+        A filter is NOT THREAD SAFE.
+
+        ------------------------------------------------------------------------
+*/
+#ifndef dtn_duplicate_filter_h
+#define dtn_duplicate_filter_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DTN_DUPLICATE_FILTER_MEMORY_DEFAULT 1024 * 1024
+#define DTN_DUPLICATE_FILTER_BLOOM_SLICES 4
+
+typedef struct dtn_duplicate_filter dtn_duplicate_filter;
+
+/*----------------------------------------------------------------------------*/
+
+typedef enum dtn_duplicate_filter_type {
+
+    DTN_DUPLICATE_FILTER_EXACT = 0,
+    DTN_DUPLICATE_FILTER_BLOOM
+
+} dtn_duplicate_filter_type;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_duplicate_filter_config {
+
+    dtn_duplicate_filter_type type;
+
+    uint64_t history_usecs;
+
+    // 0 for DTN_DUPLICATE_FILTER_MEMORY_DEFAULT
+    uint64_t memory_bytes;
+
+    // Bloom only, expected keys within history_usecs to size the
+    // number of hash functions, 0 to use 7 hash functions
+    uint64_t capacity;
+
+} dtn_duplicate_filter_config;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_duplicate_filter_stats {
+
+    dtn_duplicate_filter_type type;
+
+    uint64_t memory_bytes; // allocated for keys and index
+    uint64_t entries;      // keys within the history
+    uint64_t capacity;     // exact only, keys until eviction
+
+    uint64_t checks;     // calls of contains
+    uint64_t duplicates; // contains returned true
+    uint64_t evicted;    // exact only, keys dropped before history time
+
+    // estimated probability of contains being true for a new key
+    double false_positive_rate;
+
+} dtn_duplicate_filter_stats;
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_duplicate_filter *
+dtn_duplicate_filter_create(dtn_duplicate_filter_config config);
+
+dtn_duplicate_filter *dtn_duplicate_filter_cast(const void *data);
+void *dtn_duplicate_filter_free(void *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Check if key was added within the history time.
+
+        @param now_usecs        current time, monotonic increasing
+*/
+bool dtn_duplicate_filter_contains(dtn_duplicate_filter *self,
+                                   const void *key, size_t size,
+                                   uint64_t now_usecs);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_duplicate_filter_add(dtn_duplicate_filter *self, const void *key,
+                              size_t size, uint64_t now_usecs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Drop keys older than the history time. Expiry is done within
+        contains and add as well, this is for idle filters.
+*/
+bool dtn_duplicate_filter_expire(dtn_duplicate_filter *self,
+                                 uint64_t now_usecs);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_duplicate_filter_get_stats(const dtn_duplicate_filter *self,
+                                    dtn_duplicate_filter_stats *stats);
+
+/*----------------------------------------------------------------------------*/
+
+const char *dtn_duplicate_filter_type_to_string(dtn_duplicate_filter_type type);
+
+#endif /* dtn_duplicate_filter_h */
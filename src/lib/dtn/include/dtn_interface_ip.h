@@ -38,6 +38,12 @@
 
 /*---------------------------------------------------------------------------*/
 
+#define DTN_INTERFACE_IP_BATCH_DEFAULT 32
+#define DTN_INTERFACE_IP_DATAGRAM_MAX 2048
+#define DTN_INTERFACE_IP_PEERS_MAX 1024
+
+/*---------------------------------------------------------------------------*/
+
 typedef struct dtn_interface_ip dtn_interface_ip;
 
 /*---------------------------------------------------------------------------*/
@@ -52,6 +58,10 @@ typedef struct dtn_interface_ip_config {
         uint64_t link_check;
         uint64_t threadlock_timeout_usecs;
 
+        // datagrams per recvmmsg / sendmmsg,
+        // 0 for DTN_INTERFACE_IP_BATCH_DEFAULT
+        uint32_t batch;
+
     } limits;
 
     struct {
@@ -87,8 +97,25 @@ dtn_interface_ip *dtn_interface_ip_cast(const void *self);
 
 const char *dtn_interface_ip_name(const dtn_interface_ip *self);
 
+/**
+        Queue a datagram to remote. The queue is sent in batches as long
+        as the link is up, a full socket buffer is drained once the socket
+        is writable again. Remote addresses are resolved for the address
+        family of the socket and cached.
+*/
 bool dtn_interface_ip_send(dtn_interface_ip *self,
                            dtn_socket_configuration remote,
                            const uint8_t *buffer, size_t size);
 
+/**
+        dtn_interface_ip_send to an address resolved before, e.g. the
+        address of a dtn_routing_info. remote is resolved as for
+        dtn_interface_ip_send if address is NULL or not of the address
+        family of the socket of the interface.
+*/
+bool dtn_interface_ip_send_to(dtn_interface_ip *self,
+                              dtn_socket_configuration remote,
+                              const struct sockaddr_storage *address,
+                              const uint8_t *buffer, size_t size);
+
 #endif /* dtn_interface_ip_h */
@@ -38,10 +38,17 @@ typedef enum dtn_routing_class {
     DTN_ROUTING_ERROR = 0,
     DTN_ROUTING_DIRECT = 1,
     DTN_ROUTING_REGNAME = 2,
-    DTN_ROUTING_DEFAULT = 3
+    DTN_ROUTING_DEFAULT = 3,
+    DTN_ROUTING_CONTACT = 4 // route of a contact plan, see dtn_cgr.h
 
 } dtn_routing_class;
 
+// key of a next hop "interface|host:port"
+#define DTN_ROUTING_KEY_MAX (2 * DTN_HOST_NAME_MAX + 8)
+
+// routes of a lookup sufficient for all callers
+#define DTN_ROUTING_LOOKUP_MAX 8
+
 /*---------------------------------------------------------------------------*/
 
 typedef struct dtn_routing_info {
@@ -50,6 +57,10 @@ typedef struct dtn_routing_info {
     dtn_socket_configuration remote;
     char interface[DTN_HOST_NAME_MAX];
 
+    // remote resolved at load and used to send to the next hop,
+    // AF_UNSPEC if not resolved, remote is resolved when sending then
+    struct sockaddr_storage address;
+
 } dtn_routing_info;
 
 /*---------------------------------------------------------------------------*/
@@ -97,7 +108,57 @@ dtn_list *dtn_routing_get_info_for_uri(dtn_routing *self,
 
 /*---------------------------------------------------------------------------*/
 
+/**
+ *  Find the routes of an endpoint "dtn://name/demux" or "ipn:node.service"
+ *  without allocation or locking.
+ *
+ *  Routes of the full endpoint are DTN_ROUTING_DIRECT, routes of name or
+ *  node are DTN_ROUTING_REGNAME and follow the direct ones. Only if none
+ *  of both exist the routes of the longest matching prefix route
+ *  "prefix*" are returned as DTN_ROUTING_DEFAULT, "*" matches all.
+ *
+ *  @param routes   array to fill
+ *  @param max      size of routes
+ *  @returns number of routes written, -1 if eid is not a valid endpoint
+ */
+int64_t dtn_routing_lookup(dtn_routing *self, const char *eid,
+                           dtn_routing_info *routes, size_t max);
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ *  Load and activate the routes at path, or at the current path if NULL.
+ *
+ *  Routes are compiled aside and swapped in atomically, lookups neither
+ *  block nor fail during a load. The previous routes are freed once no
+ *  lookup uses them anymore.
+ *
+ *  @returns false if path could not be loaded, the current routes stay
+ */
 bool dtn_routing_load(dtn_routing *self, const char *path);
 bool dtn_routing_save(dtn_routing *self, const char *path);
 
+/*---------------------------------------------------------------------------*/
+
+/**
+ *  Read a route {"interface":..., "socket":{...}} of a route file,
+ *  the remote address is resolved.
+ */
+bool dtn_routing_info_from_item(dtn_routing_info *info, const dtn_item *item);
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ *  Write the next hop of info as "interface|host:port" to key.
+ *  Keys are used to name next hops in queues and stores.
+ */
+bool dtn_routing_info_to_key(const dtn_routing_info *info, char *key,
+                             size_t size);
+
+/**
+ *  Parse a key of dtn_routing_info_to_key, the remote type is UDP
+ *  as used by dtn_interface_ip, the class is DTN_ROUTING_DIRECT.
+ */
+bool dtn_routing_info_from_key(dtn_routing_info *info, const char *key);
+
 #endif /* dtn_routing_h */
@@ -28,6 +28,7 @@
         ------------------------------------------------------------------------
 */
 #include "../include/dtn_bundle.h"
+#include "../include/dtn_cbor_arena.h"
 
 #include <dtn_base/dtn_buffer.h>
 #include <dtn_base/dtn_crc16.h>
@@ -35,19 +36,24 @@
 #include <dtn_base/dtn_data_function.h>
 #include <dtn_base/dtn_dump.h>
 #include <dtn_base/dtn_utils.h>
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include <dtn_core/dtn_aes_key_wrap.h>
 #include <dtn_core/dtn_hmac.h>
 
+#include <openssl/crypto.h>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
+#include <pthread.h>
 
 /*----------------------------------------------------------------------------*/
 
 struct dtn_bundle {
 
     dtn_cbor *data;
+    dtn_cbor_arena *arena; // owner of the items of decoded bundles
 };
 
 /*----------------------------------------------------------------------------*/
@@ -72,6 +78,7 @@ dtn_bundle *dtn_bundle_free(dtn_bundle *self) {
         return self;
 
     self->data = dtn_cbor_free(self->data);
+    self->arena = dtn_cbor_arena_free(self->arena);
 
     self = dtn_data_pointer_free(self);
     return NULL;
@@ -85,77 +92,122 @@ dtn_bundle *dtn_bundle_free(dtn_bundle *self) {
  *      ------------------------------------------------------------------------
  */
 
-static bool check_crc(const dtn_cbor *block, const char *alg,
-                      const dtn_cbor *crc) {
+/*
+ *      The CRC of a block is calculated over its encoding with the content
+ *      of the CRC field set to zero. The CRC is the last item, so its
+ *      content is the tail of the encoding.
+ */
 
-    bool crc_check = false;
-    dtn_buffer *buffer = NULL;
+static const uint8_t crc_zero[4] = {0};
 
-    if (!block || !alg || !crc)
-        goto error;
+/*
+ *      Blocks keep their encoding up to this size, so unchanged blocks of a
+ *      received bundle are copied when the bundle is encoded again. Larger
+ *      blocks are mostly payload, which is copied by the encoder anyway.
+ */
 
-    uint8_t *next = NULL;
-    uint64_t length = dtn_cbor_encoding_size(block);
-    buffer = dtn_buffer_create(length);
+#define BUNDLE_BLOCK_CACHE_MAX 4096
 
-    if (!dtn_cbor_encode(block, buffer->start, buffer->capacity, &next))
-        goto error;
+/*----------------------------------------------------------------------------*/
 
-    buffer->length = next - buffer->start;
+static void cache_block(dtn_cbor *block, const uint8_t *buffer, size_t size) {
+
+    if (size > BUNDLE_BLOCK_CACHE_MAX)
+        return;
+
+    dtn_cbor_cache_encoding(block, buffer, size);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint32_t crc_width(const char *alg) {
+
+    if (0 == strcmp(alg, DTN_BUNDLE_CRC16))
+        return 2;
+
+    if (0 == strcmp(alg, DTN_BUNDLE_CRC32))
+        return 4;
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool crc_expect(const dtn_cbor *crc, uint32_t width, uint32_t *out) {
 
     uint8_t *crc_num = NULL;
     size_t size = 0;
 
+    if (0 == width)
+        goto error;
+
     if (!dtn_cbor_get_byte_string(crc, &crc_num, &size))
         goto error;
 
     if (!crc_num)
         goto error;
-    if (size < 2)
+    if (size < width)
         goto error;
 
-    if (0 == strcmp(alg, DTN_BUNDLE_CRC16)) {
+    uint32_t expect = 0;
 
-        buffer->start[buffer->length] = 0x00;
-        buffer->start[buffer->length - 1] = 0x00;
-        buffer->start[buffer->length - 2] = 0x00;
-        ;
+    for (uint32_t i = 0; i < width; i++) {
+        expect = (expect << 8) + crc_num[i];
+    }
 
-        uint16_t crc_sum = crc16x25(buffer->start, buffer->length);
-        uint16_t expect = crc_num[0] << 8;
-        expect += crc_num[1];
+    *out = expect;
+    return true;
+error:
+    return false;
+}
 
-        if (crc_sum == expect) {
+/*----------------------------------------------------------------------------*/
 
-            crc_check = true;
-        }
+static bool check_crc(const dtn_cbor *block, const char *alg,
+                      const dtn_cbor *crc) {
+
+    bool crc_check = false;
+    dtn_buffer *buffer = NULL;
 
-    } else if (0 == strcmp(alg, DTN_BUNDLE_CRC32)) {
+    if (!block || !alg || !crc)
+        goto error;
 
-        if (size < 4)
-            goto error;
+    uint32_t width = crc_width(alg);
+    uint32_t expect = 0;
 
-        buffer->start[buffer->length] = 0x00;
-        buffer->start[buffer->length - 1] = 0x00;
-        buffer->start[buffer->length - 2] = 0x00;
-        buffer->start[buffer->length - 3] = 0x00;
-        buffer->start[buffer->length - 4] = 0x00;
+    if (!crc_expect(crc, width, &expect))
+        goto error;
 
-        uint32_t expect = crc_num[0] << 24;
-        expect += crc_num[1] << 16;
-        expect += crc_num[2] << 8;
-        expect += crc_num[3];
+    uint8_t *next = NULL;
+    uint64_t length = dtn_cbor_encoding_size(block);
+    buffer = dtn_buffer_create(length);
 
-        uint32_t crc_sum = dtn_crc32c(buffer->start, buffer->length);
+    if (!dtn_cbor_encode(block, buffer->start, buffer->capacity, &next))
+        goto error;
 
-        if (crc_sum == expect) {
+    buffer->length = next - buffer->start;
 
-            crc_check = true;
-        }
+    if (buffer->length < width)
+        goto error;
+
+    uint32_t crc_sum = 0;
+    size_t open = buffer->length - width;
+
+    if (2 == width) {
+
+        crc_sum = dtn_crc16x25_update(0, buffer->start, open);
+        crc_sum = dtn_crc16x25_update(crc_sum, crc_zero, width);
 
     } else {
 
-        goto error;
+        crc_sum = dtn_crc32c_update(0, buffer->start, open);
+        crc_sum = dtn_crc32c_update(crc_sum, crc_zero, width);
+    }
+
+    if (crc_sum == expect) {
+
+        crc_check = true;
     }
 
     if (!crc_check)
@@ -170,7 +222,12 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
-static bool check_primary_block(dtn_bundle *self) {
+/*
+ *      With verify_crc false the CRC was already checked over the received
+ *      bytes by the decoder and is not calculated again.
+ */
+
+static bool check_primary_block(dtn_bundle *self, bool verify_crc) {
 
     if (!self)
         goto error;
@@ -260,7 +317,7 @@ static bool check_primary_block(dtn_bundle *self) {
         if (crc_alg) {
 
             crc = dtn_cbor_array_get(data, 10);
-            if (!check_crc(data, crc_alg, crc))
+            if (verify_crc && !check_crc(data, crc_alg, crc))
                 goto error;
         }
 
@@ -269,7 +326,7 @@ static bool check_primary_block(dtn_bundle *self) {
         if (crc_alg) {
 
             crc = dtn_cbor_array_get(data, 8);
-            if (!check_crc(data, crc_alg, crc))
+            if (verify_crc && !check_crc(data, crc_alg, crc))
                 goto error;
         }
     }
@@ -281,7 +338,7 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
-static bool check_canonical_block(const dtn_cbor *array) {
+static bool check_canonical_block(const dtn_cbor *array, bool verify_crc) {
 
     if (!dtn_cbor_is_array(array))
         goto error;
@@ -338,7 +395,7 @@ static bool check_canonical_block(const dtn_cbor *array) {
     if (crc_alg) {
 
         crc = dtn_cbor_array_get(array, 5);
-        if (!check_crc(array, crc_alg, crc))
+        if (verify_crc && !check_crc(array, crc_alg, crc))
             goto error;
     }
 
@@ -360,7 +417,7 @@ static bool check_canonical_blocks(const dtn_bundle *self) {
 
         dtn_cbor *item = dtn_cbor_array_get(self->data, i);
 
-        if (!check_canonical_block(item))
+        if (!check_canonical_block(item, true))
             goto error;
     }
 
@@ -398,614 +455,591 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
-static bool check_primary_bytes(uint8_t *start, size_t size) {
-
-    uint8_t *ptr = start;
-    dtn_cbor *item = NULL;
+/*
+ *      The decoder works on the bundle layout only, i.e. an indefinite length
+ *      array of definite length block arrays. Each block item is decoded
+ *      exactly once when it is complete, so a bundle received in N pieces
+ *      is parsed once instead of N times.
+ */
 
-    uint64_t flags = 0;
-    uint64_t crc = 0;
+typedef enum {
 
-    switch (ptr[0]) {
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-        break;
-    default:
-        goto error;
-    }
+    DECODER_START = 0,
+    DECODER_BLOCK = 1,
+    DECODER_ITEM = 2
 
-    ptr++;
+} decoder_phase;
 
-    if ((int64_t)size - (ptr - start) <= 0)
-        return true;
+/*----------------------------------------------------------------------------*/
 
-    dtn_cbor_match match =
-        dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-    if (match == DTN_CBOR_MATCH_PARTIAL)
-        return true;
-    if (match != DTN_CBOR_MATCH_FULL)
-        goto error;
-    if (!dtn_cbor_is_uint(item))
-        goto error;
-    if (0x07 != dtn_cbor_get_uint(item))
-        goto error;
-    item = dtn_cbor_free(item);
+typedef struct {
 
-    if ((int64_t)size - (ptr - start) <= 0)
-        return true;
+    decoder_phase phase;
+    size_t pos;
 
-    match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-    if (match == DTN_CBOR_MATCH_PARTIAL)
-        return true;
-    if (match != DTN_CBOR_MATCH_FULL)
-        goto error;
-    if (!dtn_cbor_is_uint(item))
-        goto error;
-    flags = dtn_cbor_get_uint(item);
-    item = dtn_cbor_free(item);
+    dtn_bundle *bundle;
+    dtn_cbor *block;
 
-    if ((int64_t)size - (ptr - start) <= 0)
-        return true;
+    uint64_t items;
+    uint64_t flags;
 
-    match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-    if (match == DTN_CBOR_MATCH_PARTIAL)
-        return true;
-    if (match != DTN_CBOR_MATCH_FULL)
-        goto error;
-    if (!dtn_cbor_is_uint(item))
-        goto error;
-    crc = dtn_cbor_get_uint(item);
-    item = dtn_cbor_free(item);
+    // CRC of the open block, updated with each decoded item
+    struct {
 
-    if ((int64_t)size - (ptr - start) <= 0)
-        return true;
+        bool known;
+        bool valid;
+        uint64_t type;
+        uint16_t crc16;
+        uint32_t crc32;
 
-    match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-    if (match == DTN_CBOR_MATCH_PARTIAL)
-        return true;
-    if (match != DTN_CBOR_MATCH_FULL)
-        goto error;
-    if (!dtn_cbor_is_string(item))
-        goto error;
-    item = dtn_cbor_free(item);
+    } crc;
 
-    if ((int64_t)size - (ptr - start) <= 0)
-        return true;
+    dtn_bundle_decoder_config config;
 
-    match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-    if (match == DTN_CBOR_MATCH_PARTIAL)
-        return true;
-    if (match != DTN_CBOR_MATCH_FULL)
-        goto error;
-    if (!dtn_cbor_is_string(item))
-        goto error;
-    item = dtn_cbor_free(item);
+} decoder_state;
 
-    if ((int64_t)size - (ptr - start) <= 0)
-        return true;
+/*----------------------------------------------------------------------------*/
 
-    match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-    if (match == DTN_CBOR_MATCH_PARTIAL)
-        return true;
-    if (match != DTN_CBOR_MATCH_FULL)
-        goto error;
-    if (!dtn_cbor_is_string(item))
-        goto error;
-    item = dtn_cbor_free(item);
+static void decoder_state_clear(decoder_state *state) {
 
-    if ((int64_t)size - (ptr - start) <= 0)
-        return true;
+    // the block may live in the arena of the bundle
+    state->block = dtn_cbor_free(state->block);
+    state->bundle = dtn_bundle_free(state->bundle);
+    state->phase = DECODER_START;
+    state->items = 0;
+    state->flags = 0;
+    return;
+}
 
-    match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-    if (match == DTN_CBOR_MATCH_PARTIAL)
-        return true;
-    if (match != DTN_CBOR_MATCH_FULL)
-        goto error;
-    if (!dtn_cbor_is_array(item))
-        goto error;
-    if (dtn_cbor_array_count(item) != 2)
-        goto error;
-    item = dtn_cbor_free(item);
+/*----------------------------------------------------------------------------*/
 
-    if ((int64_t)size - (ptr - start) <= 0)
-        return true;
+static bool check_primary_item(decoder_state *state, const dtn_cbor *item) {
 
-    match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-    if (match == DTN_CBOR_MATCH_PARTIAL)
-        return true;
-    if (match != DTN_CBOR_MATCH_FULL)
-        goto error;
-    if (!dtn_cbor_is_uint(item))
-        goto error;
-    item = dtn_cbor_free(item);
+    uint64_t index = dtn_cbor_array_count(state->block);
 
-    if ((int64_t)size - (ptr - start) <= 0)
-        return true;
+    switch (index) {
 
-    if (flags & 0x01) {
+    case 0:
 
-        match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-        if (match == DTN_CBOR_MATCH_PARTIAL)
-            return true;
-        if (match != DTN_CBOR_MATCH_FULL)
-            goto error;
         if (!dtn_cbor_is_uint(item))
             goto error;
-        item = dtn_cbor_free(item);
+        if (0x07 != dtn_cbor_get_uint(item))
+            goto error;
+        break;
 
-        if ((int64_t)size - (ptr - start) <= 0)
-            return true;
+    case 1:
 
-        match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-        if (match == DTN_CBOR_MATCH_PARTIAL)
-            return true;
-        if (match != DTN_CBOR_MATCH_FULL)
-            goto error;
         if (!dtn_cbor_is_uint(item))
             goto error;
-        item = dtn_cbor_free(item);
-
-        if ((int64_t)size - (ptr - start) <= 0)
-            return true;
+        state->flags = dtn_cbor_get_uint(item);
+        break;
 
-        if (crc > 0) {
+    case 2:
+    case 7:
 
-            match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-            if (match == DTN_CBOR_MATCH_PARTIAL)
-                return true;
-            if (match != DTN_CBOR_MATCH_FULL)
-                goto error;
-            if (!dtn_cbor_is_array(item))
-                goto error;
-            if (2 != dtn_cbor_array_count(item))
-                goto error;
-            item = dtn_cbor_free(item);
-        }
+        if (!dtn_cbor_is_uint(item))
+            goto error;
+        break;
 
-    } else if (crc > 0) {
+    case 3:
+    case 4:
+    case 5:
 
-        match = dtn_cbor_decode(ptr, size - (ptr - start), &item, &ptr);
-        if (match == DTN_CBOR_MATCH_PARTIAL)
-            return true;
-        if (match != DTN_CBOR_MATCH_FULL)
+        if (!dtn_cbor_is_string(item))
             goto error;
+        break;
+
+    case 6:
+
         if (!dtn_cbor_is_array(item))
             goto error;
         if (2 != dtn_cbor_array_count(item))
             goto error;
-        item = dtn_cbor_free(item);
+        break;
+
+    case 8:
+    case 9:
+
+        // fragment offset and total data length, CRC is checked on close
+        if (state->flags & 0x01) {
+
+            if (!dtn_cbor_is_uint(item))
+                goto error;
+        }
+        break;
+
+    default:
+        break;
     }
 
-    dtn_cbor_free(item);
     return true;
 error:
-    dtn_cbor_free(item);
     return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-dtn_cbor_match dtn_bundle_decode(const uint8_t *buffer, size_t size,
-                                 dtn_bundle **out, uint8_t **next) {
+static void decoder_crc_start(decoder_state *state, const uint8_t *ptr) {
 
-    dtn_bundle *bundle = NULL;
+    state->crc.known = false;
+    state->crc.valid = false;
+    state->crc.type = 0;
+    state->crc.crc16 = dtn_crc16x25_update(0, ptr, 1);
+    state->crc.crc32 = dtn_crc32c_update(0, ptr, 1);
+    return;
+}
 
-    if (!buffer || !out || !next)
-        goto error;
+/*----------------------------------------------------------------------------*/
 
-    if (size < 1)
-        goto error;
-    if (buffer[0] != 0x9f)
-        goto error;
-    if (size == 1)
-        return DTN_CBOR_MATCH_PARTIAL;
+static void decoder_crc_update(decoder_state *state, const uint8_t *data,
+                               size_t size) {
+
+    // both CRCs are updated until the CRC type item is decoded
 
-    bundle = dtn_bundle_create();
-    bundle->data = dtn_cbor_array();
+    if (!state->crc.known || 0x01 == state->crc.type)
+        state->crc.crc16 = dtn_crc16x25_update(state->crc.crc16, data, size);
 
-    uint8_t *ptr = (uint8_t *)buffer + 1;
-    dtn_cbor_match match = DTN_CBOR_NO_MATCH;
+    if (!state->crc.known || 0x02 == state->crc.type)
+        state->crc.crc32 = dtn_crc32c_update(state->crc.crc32, data, size);
 
-    uint64_t counter = 0;
-    uint8_t *start = ptr;
+    return;
+}
 
-    while ((int64_t)size > ptr - buffer) {
+/*----------------------------------------------------------------------------*/
 
-        dtn_cbor *item = NULL;
-        start = ptr;
-        if (counter == 0) {
+static void decoder_crc_item(decoder_state *state, const dtn_cbor *item,
+                             const uint8_t *ptr, const uint8_t *next) {
 
-            // expect primary block
-            switch (ptr[0]) {
+    bool primary = (0 == dtn_cbor_array_count(state->bundle->data));
+    uint64_t index = dtn_cbor_array_count(state->block);
+    size_t size = next - ptr;
 
-            case 0x88:
-            case 0x89:
-            case 0x8A:
-            case 0x8B:
+    uint64_t type_index = primary ? 2 : 3;
+    uint64_t crc_index = 5;
 
-                // primary array detected
+    if (primary)
+        crc_index = (state->flags & 0x01) ? 10 : 8;
 
-                match =
-                    dtn_cbor_decode(ptr, size - (ptr - buffer), &item, &ptr);
+    uint32_t width = 0;
 
-                switch (match) {
+    switch (state->crc.type) {
 
-                case DTN_CBOR_NO_MATCH:
-                    goto error;
+    case 0x01:
+        width = 2;
+        break;
+    case 0x02:
+        width = 4;
+        break;
+    default:
+        break;
+    }
 
-                case DTN_CBOR_MATCH_PARTIAL:
-                    *next = ptr;
-                    if (!check_primary_bytes(start, (ptr - start)))
-                        goto error;
-                    bundle = dtn_bundle_free(bundle);
-                    return match;
+    if (!state->crc.known || 0 == width || index != crc_index) {
 
-                case DTN_CBOR_MATCH_FULL:
+        decoder_crc_update(state, ptr, size);
 
-                    dtn_cbor_array_push(bundle->data, item);
+        if (index == type_index) {
 
-                    if (!check_primary_block(bundle)) {
-                        fprintf(stdout, "\nprimary failed\n");
-                        bundle = dtn_bundle_free(bundle);
-                        goto error;
-                    }
+            state->crc.known = true;
+            if (dtn_cbor_is_uint(item))
+                state->crc.type = dtn_cbor_get_uint(item);
+        }
 
-                    break;
-                }
-                break;
+        return;
+    }
 
-            default:
-                *next = ptr;
-                goto error;
-            }
+    uint32_t expect = 0;
 
-        } else {
+    if (size < width || !crc_expect(item, width, &expect))
+        return;
 
-            // expect canonical block
-            switch (ptr[0]) {
+    decoder_crc_update(state, ptr, size - width);
+    decoder_crc_update(state, crc_zero, width);
 
-            case 0x85:
-            case 0x86:
+    if (2 == width) {
+        state->crc.valid = (state->crc.crc16 == expect);
+    } else {
+        state->crc.valid = (state->crc.crc32 == expect);
+    }
 
-                // canonical block detected
+    return;
+}
 
-                match =
-                    dtn_cbor_decode(ptr, size - (ptr - buffer), &item, &ptr);
+/*----------------------------------------------------------------------------*/
 
-                switch (match) {
+static bool close_block(decoder_state *state) {
 
-                case DTN_CBOR_NO_MATCH:
-                    goto error;
+    // the CRC was calculated over the received bytes of the block
 
-                case DTN_CBOR_MATCH_PARTIAL:
-                    *next = ptr;
-                    bundle = dtn_bundle_free(bundle);
-                    return match;
+    switch (state->crc.type) {
 
-                case DTN_CBOR_MATCH_FULL:
+    case 0x01:
+    case 0x02:
 
-                    if (!check_canonical_block(item)) {
-                        fprintf(stdout, "\ncheck_canonical_block failed\n");
-                        bundle = dtn_bundle_free(bundle);
-                        item = dtn_cbor_free(item);
-                        goto error;
-                    }
+        if (!state->crc.valid) {
+            dtn_log_error("CRC check failed.");
+            goto error;
+        }
+        break;
 
-                    dtn_cbor_array_push(bundle->data, item);
-                    break;
-                }
+    default:
+        break;
+    }
 
-                break;
+    dtn_cbor *block = state->block;
+    state->block = NULL;
 
-            default:
-                *next = ptr;
-                goto error;
-            }
-        }
+    if (0 == dtn_cbor_array_count(state->bundle->data)) {
 
-        if ((int64_t)size == ptr - buffer) {
-            *next = ptr;
-            bundle = dtn_bundle_free(bundle);
-            return DTN_CBOR_MATCH_PARTIAL;
-        }
+        dtn_cbor_array_push(state->bundle->data, block);
 
-        if (ptr[0] == 0xff) {
-            // bundle_close
-            *next = ptr + 1;
-            goto done;
+        if (!check_primary_block(state->bundle, false))
+            goto error;
+
+    } else {
+
+        if (!check_canonical_block(block, false)) {
+            block = dtn_cbor_free(block);
+            goto error;
         }
 
-        counter++;
+        dtn_cbor_array_push(state->bundle->data, block);
     }
 
-done:
-    counter = dtn_cbor_array_count(bundle->data);
-    if (counter < 2)
-        goto error;
+    if (state->config.callbacks.block) {
 
-    // we verify again to check for payload block
-    if (!dtn_bundle_verify(bundle))
-        goto error;
+        dtn_cbor_arena *arena = dtn_cbor_arena_activate(NULL);
 
-    *out = bundle;
-    return DTN_CBOR_MATCH_FULL;
+        state->config.callbacks.block(
+            state->config.callbacks.userdata, block,
+            dtn_cbor_array_count(state->bundle->data) - 1);
+
+        dtn_cbor_arena_activate(arena);
+    }
+
+    state->phase = DECODER_BLOCK;
+    return true;
 error:
-    if (next)
-        *next = (uint8_t *)buffer;
-    dtn_bundle_free(bundle);
-    return DTN_CBOR_NO_MATCH;
+    return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-static bool set_crc_primary(dtn_cbor *block) {
+static dtn_cbor_match decoder_run(decoder_state *state, const uint8_t *buffer,
+                                  size_t size, dtn_bundle **out) {
 
-    dtn_buffer *buffer = NULL;
+    dtn_cbor *item = NULL;
+    uint8_t *next = NULL;
 
-    if (!block)
-        goto error;
+    // start of a block received within this run
+    const uint8_t *block_start = NULL;
 
-    uint64_t count = dtn_cbor_array_count(block);
+    /* All items of a bundle are decoded into the arena of the bundle. */
 
-    const dtn_cbor *crc_type = dtn_cbor_array_get(block, 2);
-    if (!dtn_cbor_is_uint(crc_type))
-        goto error;
+    dtn_cbor_arena *previous = dtn_cbor_arena_active();
 
-    uint64_t crc_flags = dtn_cbor_get_uint(crc_type);
+    if (state->bundle)
+        dtn_cbor_arena_activate(state->bundle->arena);
 
-    dtn_cbor *crc = NULL;
+    while (state->pos < size) {
 
-    switch (crc_flags) {
+        const uint8_t *ptr = buffer + state->pos;
 
-    case 0x00:
-        crc = NULL;
-        goto done;
-        break;
-    case 0x01:
+        switch (state->phase) {
 
-        if (count == 9) {
+        case DECODER_START:
 
-            crc = dtn_cbor_array_get(block, 8);
+            if (ptr[0] != 0x9f)
+                goto error;
 
-        } else if (count == 11) {
+            state->bundle = dtn_bundle_create();
+            if (!state->bundle)
+                goto error;
 
-            crc = dtn_cbor_array_get(block, 10);
+            state->bundle->arena =
+                dtn_cbor_arena_create((dtn_cbor_arena_config){0});
+            if (!state->bundle->arena)
+                goto error;
 
-        } else {
+            dtn_cbor_arena_activate(state->bundle->arena);
 
-            crc = dtn_cbor_string("12");
-            if (!dtn_cbor_array_push(block, crc))
+            state->bundle->data = dtn_cbor_array();
+            if (!state->bundle->data)
                 goto error;
-        }
 
-        break;
+            state->pos++;
+            state->phase = DECODER_BLOCK;
+            break;
 
-    case 0x02:
+        case DECODER_BLOCK:
 
-        if (count == 9) {
+            if (ptr[0] == 0xff) {
 
-            crc = dtn_cbor_array_get(block, 8);
+                // bundle_close
+                if (dtn_cbor_array_count(state->bundle->data) < 2)
+                    goto error;
 
-        } else if (count == 11) {
+                // primary and canonical blocks are checked on close
+                if (!check_payload_block(state->bundle))
+                    goto error;
 
-            crc = dtn_cbor_array_get(block, 10);
+                state->pos++;
+                *out = state->bundle;
+                state->bundle = NULL;
+                state->phase = DECODER_START;
+                dtn_cbor_arena_activate(previous);
+                return DTN_CBOR_MATCH_FULL;
+            }
 
-        } else {
+            if (0 == dtn_cbor_array_count(state->bundle->data)) {
 
-            crc = dtn_cbor_string("1234");
-            if (!dtn_cbor_array_push(block, crc))
-                goto error;
-        }
+                // expect primary block
+                switch (ptr[0]) {
+                case 0x88:
+                case 0x89:
+                case 0x8A:
+                case 0x8B:
+                    break;
+                default:
+                    goto error;
+                }
 
-        break;
+            } else {
 
-    default:
-        goto error;
-    }
+                // expect canonical block
+                switch (ptr[0]) {
+                case 0x85:
+                case 0x86:
+                    break;
+                default:
+                    goto error;
+                }
+            }
 
-    uint8_t *next = NULL;
-    uint64_t length = dtn_cbor_encoding_size(block);
-    buffer = dtn_buffer_create(length);
+            state->items = ptr[0] & 0x1F;
+            state->block = dtn_cbor_array();
+            if (!state->block)
+                goto error;
 
-    if (!dtn_cbor_encode(block, buffer->start, buffer->capacity, &next))
-        goto error;
+            decoder_crc_start(state, ptr);
+            block_start = ptr;
 
-    buffer->length = next - buffer->start;
+            state->pos++;
+            state->phase = DECODER_ITEM;
+            break;
 
-    uint32_t crc_sum32 = 0;
-    uint16_t crc_sum16 = 0;
-    char *bytes = NULL;
+        case DECODER_ITEM:
 
-    switch (crc_flags) {
+            switch (dtn_cbor_decode(ptr, size - state->pos, &item, &next)) {
 
-    case 0x01:
+            case DTN_CBOR_MATCH_PARTIAL:
+                dtn_cbor_arena_activate(previous);
+                return DTN_CBOR_MATCH_PARTIAL;
 
-        buffer->start[buffer->length] = 0x00;
-        buffer->start[buffer->length - 1] = 0x00;
-        buffer->start[buffer->length - 2] = 0x00;
+            case DTN_CBOR_MATCH_FULL:
+                break;
 
-        crc_sum16 = crc16x25(buffer->start, buffer->length);
+            default:
+                goto error;
+            }
 
-        bytes = (char *)dtn_cbor_get_string(crc);
-        if (!bytes)
-            goto error;
+            if (0 == dtn_cbor_array_count(state->bundle->data)) {
 
-        bytes[0] = crc_sum16 >> 8;
-        bytes[1] = crc_sum16;
+                if (!check_primary_item(state, item))
+                    goto error;
+            }
 
-        break;
-    case 0x02:
+            decoder_crc_item(state, item, ptr, next);
 
-        buffer->start[buffer->length] = 0x00;
-        buffer->start[buffer->length - 1] = 0x00;
-        buffer->start[buffer->length - 2] = 0x00;
-        buffer->start[buffer->length - 3] = 0x00;
-        buffer->start[buffer->length - 4] = 0x00;
+            if (!dtn_cbor_array_push(state->block, item))
+                goto error;
 
-        crc_sum32 = dtn_crc32c(buffer->start, buffer->length);
-        bytes = (char *)dtn_cbor_get_string(crc);
-        if (!bytes)
-            goto error;
+            item = NULL;
+            state->pos = next - buffer;
 
-        bytes[0] = crc_sum32 >> 24;
-        bytes[1] = crc_sum32 >> 16;
-        bytes[2] = crc_sum32 >> 8;
-        bytes[3] = crc_sum32;
-        break;
-    default:
-        goto error;
+            if (state->items == dtn_cbor_array_count(state->block)) {
+
+                if (block_start)
+                    cache_block(state->block, block_start, next - block_start);
+
+                block_start = NULL;
+
+                if (!close_block(state))
+                    goto error;
+            }
+
+            break;
+        }
     }
 
-done:
-    dtn_buffer_free(buffer);
-    return true;
+    dtn_cbor_arena_activate(previous);
+    return DTN_CBOR_MATCH_PARTIAL;
 error:
-    dtn_buffer_free(buffer);
-    return false;
+    dtn_cbor_free(item);
+    decoder_state_clear(state);
+    dtn_cbor_arena_activate(previous);
+    return DTN_CBOR_NO_MATCH;
 }
 
 /*----------------------------------------------------------------------------*/
 
-static bool set_crc_block(dtn_cbor *block) {
+dtn_cbor_match dtn_bundle_decode(const uint8_t *buffer, size_t size,
+                                 dtn_bundle **out, uint8_t **next) {
 
-    dtn_buffer *buffer = NULL;
+    decoder_state state = {0};
 
-    if (!block)
+    if (!buffer || !out || !next)
         goto error;
 
-    uint64_t count = dtn_cbor_array_count(block);
-
-    const dtn_cbor *crc_type = dtn_cbor_array_get(block, 3);
-    if (!dtn_cbor_is_uint(crc_type))
+    if (size < 1)
         goto error;
 
-    uint64_t crc_flags = dtn_cbor_get_uint(crc_type);
+    dtn_cbor_match match = decoder_run(&state, buffer, size, out);
 
-    dtn_cbor *crc = NULL;
+    switch (match) {
 
-    switch (crc_flags) {
+    case DTN_CBOR_MATCH_FULL:
+        *next = (uint8_t *)buffer + state.pos;
+        break;
 
-    case 0x00:
-        goto done;
+    case DTN_CBOR_MATCH_PARTIAL:
+        *next = (uint8_t *)buffer + size;
+        decoder_state_clear(&state);
         break;
-    case 0x01:
 
-        if (count == 6) {
+    default:
+        goto error;
+    }
+
+    return match;
+error:
+    if (next)
+        *next = (uint8_t *)buffer;
+    return DTN_CBOR_NO_MATCH;
+}
 
-            crc = dtn_cbor_array_get(block, 5);
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      STREAMING DECODER
+ *
+ *      ------------------------------------------------------------------------
+ */
 
-        } else {
+#define DTN_BUNDLE_DECODER_MAGIC_BYTE 0xdec0
+#define DTN_BUNDLE_DECODER_BUFFER_SIZE 2048
 
-            crc = dtn_cbor_string("12");
-            if (!dtn_cbor_array_push(block, crc))
-                goto error;
-        }
+/*----------------------------------------------------------------------------*/
 
-        break;
-    case 0x02:
+struct dtn_bundle_decoder {
 
-        if (count == 6) {
+    uint16_t magic_byte;
 
-            crc = dtn_cbor_array_get(block, 5);
+    decoder_state state;
+    dtn_buffer *buffer;
+};
 
-        } else {
+/*----------------------------------------------------------------------------*/
 
-            crc = dtn_cbor_string("1234");
-            if (!dtn_cbor_array_push(block, crc))
-                goto error;
-        }
+dtn_bundle_decoder *
+dtn_bundle_decoder_create(dtn_bundle_decoder_config config) {
 
-        break;
-    default:
+    dtn_bundle_decoder *self = calloc(1, sizeof(dtn_bundle_decoder));
+    if (!self)
         goto error;
-    }
 
-    uint8_t *next = NULL;
-    uint64_t length = dtn_cbor_encoding_size(block);
-    buffer = dtn_buffer_create(length);
+    self->magic_byte = DTN_BUNDLE_DECODER_MAGIC_BYTE;
+    self->state.config = config;
 
-    if (!dtn_cbor_encode(block, buffer->start, buffer->capacity, &next))
+    self->buffer = dtn_buffer_create(DTN_BUNDLE_DECODER_BUFFER_SIZE);
+    if (!self->buffer)
         goto error;
 
-    buffer->length = next - buffer->start;
+    return self;
+error:
+    dtn_bundle_decoder_free(self);
+    return NULL;
+}
 
-    uint32_t crc_sum32 = 0;
-    uint16_t crc_sum16 = 0;
-    char *bytes = NULL;
+/*----------------------------------------------------------------------------*/
 
-    switch (crc_flags) {
+dtn_bundle_decoder *dtn_bundle_decoder_cast(const void *data) {
 
-    case 0x01:
+    if (!data)
+        return NULL;
 
-        buffer->start[buffer->length] = 0x00;
-        buffer->start[buffer->length - 1] = 0x00;
-        buffer->start[buffer->length - 2] = 0x00;
+    if (*(uint16_t *)data != DTN_BUNDLE_DECODER_MAGIC_BYTE)
+        return NULL;
 
-        crc_sum16 = crc16x25(buffer->start, buffer->length);
+    return (dtn_bundle_decoder *)data;
+}
 
-        bytes = (char *)dtn_cbor_get_string(crc);
-        if (!bytes)
-            goto error;
+/*----------------------------------------------------------------------------*/
 
-        bytes[0] = crc_sum16 >> 8;
-        bytes[1] = crc_sum16;
+void *dtn_bundle_decoder_free(void *data) {
 
-        break;
-    case 0x02:
+    dtn_bundle_decoder *self = dtn_bundle_decoder_cast(data);
+    if (!self)
+        return data;
 
-        buffer->start[buffer->length] = 0x00;
-        buffer->start[buffer->length - 1] = 0x00;
-        buffer->start[buffer->length - 2] = 0x00;
-        buffer->start[buffer->length - 3] = 0x00;
-        buffer->start[buffer->length - 4] = 0x00;
+    decoder_state_clear(&self->state);
+    self->buffer = dtn_buffer_free(self->buffer);
+    self = dtn_data_pointer_free(self);
+    return NULL;
+}
 
-        crc_sum32 = dtn_crc32c(buffer->start, buffer->length);
-        bytes = (char *)dtn_cbor_get_string(crc);
-        if (!bytes)
-            goto error;
+/*----------------------------------------------------------------------------*/
 
-        bytes[0] = crc_sum32 >> 24;
-        bytes[1] = crc_sum32 >> 16;
-        bytes[2] = crc_sum32 >> 8;
-        bytes[3] = crc_sum32;
+bool dtn_bundle_decoder_reset(dtn_bundle_decoder *self) {
 
-        break;
-    default:
+    if (!self)
         goto error;
-    }
 
-done:
-    dtn_buffer_free(buffer);
+    decoder_state_clear(&self->state);
+    self->state.pos = 0;
+    self->buffer->length = 0;
     return true;
 error:
-    dtn_buffer_free(buffer);
     return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-static bool set_crcs(dtn_bundle *self) {
+static bool decoder_append(dtn_bundle_decoder *self, const uint8_t *buffer,
+                           size_t size) {
 
-    if (!self)
-        goto error;
+    dtn_buffer *buf = self->buffer;
 
-    uint64_t count = dtn_cbor_array_count(self->data);
+    /*
+     *      Drop consumed bytes, once they make up at least half of the
+     *      buffer. This keeps the moved bytes amortized linear to the input,
+     *      even if a large item is still incomplete.
+     */
 
-    for (uint64_t i = 0; i < count; i++) {
+    size_t open = buf->length - self->state.pos;
 
-        dtn_cbor *block = dtn_cbor_array_get(self->data, i);
+    if (self->state.pos > 0 && self->state.pos >= open) {
 
-        if (i == 0) {
-            if (!set_crc_primary(block))
-                goto error;
-        } else {
-            if (!set_crc_block(block))
-                goto error;
-        }
+        memmove(buf->start, buf->start + self->state.pos, open);
+        buf->length = open;
+        self->state.pos = 0;
     }
 
+    if (0 == size)
+        return true;
+
+    if (buf->capacity < buf->length + size) {
+
+        size_t add = buf->capacity;
+        if (add < buf->length + size - buf->capacity)
+            add = buf->length + size - buf->capacity;
+
+        if (!dtn_buffer_extend(buf, add))
+            goto error;
+    }
+
+    memcpy(buf->start + buf->length, buffer, size);
+    buf->length += size;
     return true;
 error:
     return false;
@@ -1013,420 +1047,547 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_encode(dtn_bundle *self, uint8_t *buffer, size_t size,
-                       uint8_t **next) {
+dtn_cbor_match dtn_bundle_decoder_push(dtn_bundle_decoder *self,
+                                       const uint8_t *buffer, size_t size,
+                                       dtn_bundle **out) {
 
-    if (!self || !buffer || size < 1 || !next)
+    if (!self || !out)
         goto error;
 
-    if (!set_crcs(self))
-        goto error;
-    if (!dtn_bundle_verify(self))
+    if (size > 0 && !buffer)
         goto error;
 
-    return dtn_cbor_encode_array_of_indefinite_length(self->data, buffer, size,
-                                                      next);
-error:
-    return false;
-}
-
-/*----------------------------------------------------------------------------*/
+    if (!decoder_append(self, buffer, size))
+        goto error;
 
-uint64_t dtn_bundle_encoding_size(const dtn_bundle *self) {
+    dtn_cbor_match match = decoder_run(&self->state, self->buffer->start,
+                                       self->buffer->length, out);
 
-    if (!self)
-        return 0;
-    // NOTE this may return a larger buffer due to the
-    // bundle array infinitie length encoding.
+    if (DTN_CBOR_NO_MATCH == match)
+        goto error;
 
-    return dtn_cbor_encoding_size(self->data);
+    return match;
+error:
+    dtn_bundle_decoder_reset(self);
+    return DTN_CBOR_NO_MATCH;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_verify(dtn_bundle *self) {
+size_t dtn_bundle_decoder_pending(const dtn_bundle_decoder *self) {
 
     if (!self)
-        goto error;
-
-    if (!check_primary_block(self))
-        goto error;
-    if (!check_canonical_blocks(self))
-        goto error;
-    if (!check_payload_block(self))
-        goto error;
+        return 0;
 
-    return true;
-error:
-    return false;
+    return self->buffer->length - self->state.pos;
 }
 
 /*
  *      ------------------------------------------------------------------------
  *
- *      GETTER / SETTER PRIMARY
+ *      ZERO COPY VIEW
  *
  *      ------------------------------------------------------------------------
  */
 
-dtn_cbor *dtn_bundle_add_primary_block(dtn_bundle *self, uint64_t flags,
-                                       uint64_t crc_type,
-                                       const char *destination,
-                                       const char *source,
-                                       const char *report_to, uint64_t time,
-                                       uint64_t seq, uint64_t lifetime,
-                                       uint64_t offset, uint64_t length) {
+static bool view_check_block(const dtn_cbor_view *view, int64_t index,
+                             bool primary) {
 
-    if (!self)
+    const dtn_cbor_view_item *block = dtn_cbor_view_get(view, index);
+    if (!block || block->type != DTN_CBOR_ARRAY)
         goto error;
-    if (!self->data)
-        self->data = dtn_cbor_array();
 
-    if (dtn_cbor_array_get(self->data, 0)) {
-        dtn_log_error("Primary bundle already set - abort.");
-        goto error;
-    }
+    uint64_t count = dtn_cbor_view_count(block);
+    uint64_t min = primary ? 8 : 5;
+    uint64_t max = primary ? 11 : 6;
 
-    if (!dtn_bundle_primary_set_version(self))
-        goto error;
-    if (!dtn_bundle_primary_set_flags(self, flags))
-        goto error;
-    if (!dtn_bundle_primary_set_crc_type(self, crc_type))
-        goto error;
-    if (!dtn_bundle_primary_set_destination(self, destination))
-        goto error;
-    if (!dtn_bundle_primary_set_source(self, source))
-        goto error;
-    if (!dtn_bundle_primary_set_report(self, report_to))
-        goto error;
-    if (!dtn_bundle_primary_set_timestamp(self, time, seq))
-        goto error;
-    if (!dtn_bundle_primary_set_lifetime(self, lifetime))
+    if (count < min || count > max)
         goto error;
 
-    if (flags & 0x01) {
-        if (!dtn_bundle_primary_set_fragment_offset(self, offset))
+    for (uint64_t i = 0; i < min; i++) {
+
+        const dtn_cbor_view_item *item =
+            dtn_cbor_view_get(view, dtn_cbor_view_child(view, index, i));
+
+        dtn_cbor_type expect = DTN_CBOR_UINT64;
+
+        if (primary) {
+
+            if (i >= 3 && i <= 5)
+                expect = DTN_CBOR_STRING;
+            if (i == 6)
+                expect = DTN_CBOR_ARRAY;
+
+        } else if (i == 4) {
+
+            expect = DTN_CBOR_STRING;
+        }
+
+        if (!item || item->type != expect)
             goto error;
-        if (!dtn_bundle_primary_set_total_data_length(self, length))
+
+        if (primary && i == 0 && item->value != 0x07)
             goto error;
     }
 
-    return dtn_cbor_array_get(self->data, 0);
+    return true;
 error:
-    return NULL;
+    return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-uint64_t dtn_bundle_primary_get_version(const dtn_bundle *self) {
+dtn_cbor_match dtn_bundle_view_decode(const uint8_t *buffer, size_t size,
+                                      dtn_cbor_view *view, uint8_t **next) {
 
-    if (!self || !self->data)
+    if (!buffer || !view || !next)
         goto error;
 
-    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 0);
-    return dtn_cbor_get_uint(item);
+    if (size > 0 && buffer[0] != 0x9f)
+        goto error;
 
-error:
-    return 0;
-}
+    dtn_cbor_match match = dtn_cbor_view_decode(buffer, size, view, next);
+    if (DTN_CBOR_MATCH_FULL != match)
+        return match;
 
-/*----------------------------------------------------------------------------*/
+    const dtn_cbor_view_item *root = dtn_cbor_view_get(view, 0);
+    uint64_t count = dtn_cbor_view_count(root);
 
-bool dtn_bundle_primary_set_version(dtn_bundle *self) {
+    if (count < 2)
+        goto error;
 
-    if (!self)
+    if (!view_check_block(view, 1, true))
         goto error;
 
-    if (!self->data)
-        self->data = dtn_cbor_array();
+    int64_t index = view->items[1].next;
 
-    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
-    if (!block) {
-        block = dtn_cbor_array();
-        if (!dtn_cbor_array_push((dtn_cbor *)self->data, block)) {
-            block = dtn_cbor_free(block);
-            goto error;
-        }
-    }
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 0);
-    if (!item) {
-        item = dtn_cbor_uint(0x07);
-        if (!dtn_cbor_array_push(block, item)) {
-            item = dtn_cbor_free(item);
+    for (uint64_t i = 1; i < count; i++) {
+
+        if (!view_check_block(view, index, false))
             goto error;
-        }
+
+        if (i + 1 < count)
+            index = view->items[index].next;
     }
-    return dtn_cbor_set_uint(item, 0x07);
 
+    // last block is the payload block
+    if (1 != view->items[index + 1].value)
+        goto error;
+
+    return DTN_CBOR_MATCH_FULL;
 error:
-    return false;
+    if (view)
+        view->count = 0;
+    if (next)
+        *next = (uint8_t *)buffer;
+    return DTN_CBOR_NO_MATCH;
 }
 
 /*----------------------------------------------------------------------------*/
 
-uint64_t dtn_bundle_primary_get_flags(const dtn_bundle *self) {
+int64_t dtn_bundle_view_get_block(const dtn_cbor_view *view, uint64_t nbr) {
 
-    if (!self || !self->data)
-        goto error;
-
-    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 1);
-    return dtn_cbor_get_uint(item);
-
-error:
-    return 0;
-}
+    return dtn_cbor_view_child(view, 0, nbr);
+}
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_primary_set_flags(dtn_bundle *self, uint64_t flags) {
-
-    if (!self || !self->data)
-        goto error;
-
-    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
-    if (!block)
-        goto error;
+bool dtn_bundle_view_get_data(const dtn_cbor_view *view, int64_t block,
+                              const uint8_t **data, size_t *size) {
 
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 1);
-    if (!item) {
-        item = dtn_cbor_uint(flags);
-        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
-            item = dtn_cbor_free(item);
-            goto error;
-        }
-    }
-    return dtn_cbor_set_uint(item, flags);
+    // canonical blocks only
+    if (dtn_cbor_view_count(dtn_cbor_view_get(view, block)) > 6)
+        return false;
 
-error:
-    return false;
+    return dtn_cbor_view_get_string(
+        dtn_cbor_view_get(view, dtn_cbor_view_child(view, block, 4)), data,
+        size);
 }
 
 /*----------------------------------------------------------------------------*/
 
-uint64_t dtn_bundle_primary_get_crc_type(const dtn_bundle *self) {
+bool dtn_bundle_view_get_payload(const dtn_cbor_view *view,
+                                 const uint8_t **data, size_t *size) {
 
-    if (!self || !self->data)
-        goto error;
+    const dtn_cbor_view_item *root = dtn_cbor_view_get(view, 0);
+    uint64_t count = dtn_cbor_view_count(root);
 
-    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 2);
-    return dtn_cbor_get_uint(item);
+    if (count < 2)
+        return false;
 
-error:
-    return 0;
+    return dtn_bundle_view_get_data(
+        view, dtn_bundle_view_get_block(view, count - 1), data, size);
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_primary_set_crc_type(dtn_bundle *self, uint64_t type) {
+/*
+ *      The encoder serializes each block once. The CRC field is reserved
+ *      as the last item of a block with the width of the CRC type, the CRC
+ *      is calculated over the bytes just written and patched in place.
+ */
 
-    if (!self || !self->data)
-        goto error;
+static bool prepare_crc(dtn_cbor *block, bool primary, uint32_t *width) {
 
-    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
-    if (!block)
+    uint64_t count = dtn_cbor_array_count(block);
+
+    const dtn_cbor *crc_type = dtn_cbor_array_get(block, primary ? 2 : 3);
+    if (!dtn_cbor_is_uint(crc_type))
         goto error;
 
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 2);
-    if (!item) {
-        item = dtn_cbor_uint(type);
-        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
-            item = dtn_cbor_free(item);
-            goto error;
-        }
+    switch (dtn_cbor_get_uint(crc_type)) {
+
+    case 0x00:
+        *width = 0;
+        return true;
+    case 0x01:
+        *width = 2;
+        break;
+    case 0x02:
+        *width = 4;
+        break;
+    default:
+        goto error;
     }
-    return dtn_cbor_set_uint(item, type);
 
-error:
-    return false;
-}
+    dtn_cbor *crc = NULL;
+    uint8_t *bytes = NULL;
+    size_t size = 0;
 
-/*----------------------------------------------------------------------------*/
+    if ((primary && (9 == count || 11 == count)) || (!primary && 6 == count)) {
 
-const char *dtn_bundle_primary_get_destination(const dtn_bundle *self) {
+        crc = dtn_cbor_array_get(block, count - 1);
 
-    if (!self || !self->data)
-        goto error;
+        if (!dtn_cbor_get_byte_string(crc, &bytes, &size))
+            goto error;
 
-    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 3);
-    if (!dtn_cbor_is_string(item))
+        if (bytes && size == *width)
+            return true;
+
+        return dtn_cbor_set_byte_string(crc, crc_zero, *width);
+    }
+
+    crc = dtn_cbor_string(NULL);
+    if (!crc)
         goto error;
 
-    return dtn_cbor_get_string(item);
+    if (!dtn_cbor_set_byte_string(crc, crc_zero, *width) ||
+        !dtn_cbor_array_push(block, crc)) {
+        dtn_cbor_free(crc);
+        goto error;
+    }
 
+    return true;
 error:
-    return NULL;
+    return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_primary_set_destination(dtn_bundle *self, const char *value) {
+static bool encode_block(dtn_cbor *block, uint32_t width, uint8_t *buffer,
+                         size_t size, uint8_t **next) {
 
-    if (!self || !self->data)
+    if (!dtn_cbor_encode(block, buffer, size, next))
         goto error;
 
-    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
-    if (!block)
-        goto error;
+    size_t length = *next - buffer;
 
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 3);
-    if (!item) {
+    if (0 == width) {
+        cache_block(block, buffer, length);
+        return true;
+    }
 
-        item = dtn_cbor_string(value);
-        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
-            item = dtn_cbor_free(item);
-            goto error;
-        }
+    uint8_t *field = *next - width;
+    uint32_t crc_sum = 0;
 
+    memset(field, 0, width);
+
+    if (2 == width) {
+        crc_sum = dtn_crc16x25_update(0, buffer, length);
     } else {
+        crc_sum = dtn_crc32c_update(0, buffer, length);
+    }
 
-        if (!dtn_cbor_is_string(item))
-            goto error;
+    for (uint32_t i = 0; i < width; i++) {
+        field[i] = crc_sum >> (8 * (width - 1 - i));
     }
 
-    return dtn_cbor_set_string(item, value);
+    // keep the CRC item of the block in sync with the encoding
+
+    dtn_cbor *crc =
+        dtn_cbor_array_get(block, dtn_cbor_array_count(block) - 1);
 
+    uint8_t *bytes = NULL;
+    size_t crc_size = 0;
+    if (!dtn_cbor_get_byte_string(crc, &bytes, &crc_size) || !bytes)
+        goto error;
+
+    memcpy(bytes, field, width);
+    dtn_cbor_touch(crc);
+
+    cache_block(block, buffer, length);
+    return true;
 error:
     return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-const char *dtn_bundle_primary_get_source(const dtn_bundle *self) {
+bool dtn_bundle_encode(dtn_bundle *self, uint8_t *buffer, size_t size,
+                       uint8_t **next) {
 
-    if (!self || !self->data)
+    if (!self || !buffer || size < 2 || !next)
         goto error;
 
-    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 4);
-    if (!dtn_cbor_is_string(item))
-        goto error;
-    return dtn_cbor_get_string(item);
+    uint64_t count = dtn_cbor_array_count(self->data);
+    uint8_t *ptr = buffer + 1;
+    uint32_t width = 0;
 
-error:
-    return NULL;
-}
+    const uint8_t *cached = NULL;
+    size_t length = 0;
 
-/*----------------------------------------------------------------------------*/
+    buffer[0] = 0x9F;
 
-bool dtn_bundle_primary_set_source(dtn_bundle *self, const char *value) {
+    for (uint64_t i = 0; i < count; i++) {
 
-    if (!self || !self->data)
-        goto error;
+        dtn_cbor *block = dtn_cbor_array_get(self->data, i);
 
-    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
-    if (!block)
-        goto error;
+        // unchanged since checked and encoded or received
+        if (dtn_cbor_get_cached_encoding(block, &cached, &length)) {
 
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 4);
-    if (!item) {
+            if (length > size - (ptr - buffer))
+                goto error;
 
-        item = dtn_cbor_string(value);
-        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
-            item = dtn_cbor_free(item);
-            goto error;
+            memcpy(ptr, cached, length);
+            ptr += length;
+            continue;
         }
 
-    } else {
+        if (0 == i) {
 
-        if (!dtn_cbor_is_string(item))
+            if (!prepare_crc(block, true, &width))
+                goto error;
+
+            if (!check_primary_block(self, false))
+                goto error;
+
+        } else {
+
+            if (!prepare_crc(block, false, &width))
+                goto error;
+
+            if (!check_canonical_block(block, false))
+                goto error;
+        }
+
+        if (!encode_block(block, width, ptr, size - (ptr - buffer), &ptr))
             goto error;
     }
 
-    return dtn_cbor_set_string(item, value);
+    if (!check_payload_block(self))
+        goto error;
+
+    if (ptr - buffer == (int64_t)size)
+        goto error;
 
+    ptr[0] = 0xFF;
+    *next = ptr + 1;
+    return true;
 error:
     return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-const char *dtn_bundle_primary_get_report(const dtn_bundle *self) {
+uint64_t dtn_bundle_encoding_size(const dtn_bundle *self) {
 
-    if (!self || !self->data)
+    if (!self)
+        return 0;
+    // NOTE this may return a larger buffer due to the
+    // bundle array infinitie length encoding.
+
+    return dtn_cbor_encoding_size(self->data);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_verify(dtn_bundle *self) {
+
+    if (!self)
         goto error;
 
-    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 5);
-    if (!dtn_cbor_is_string(item))
+    if (!check_primary_block(self, true))
+        goto error;
+    if (!check_canonical_blocks(self))
+        goto error;
+    if (!check_payload_block(self))
         goto error;
-    return dtn_cbor_get_string(item);
 
+    return true;
 error:
-    return NULL;
+    return false;
 }
 
-/*----------------------------------------------------------------------------*/
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GETTER / SETTER PRIMARY
+ *
+ *      ------------------------------------------------------------------------
+ */
 
-bool dtn_bundle_primary_set_report(dtn_bundle *self, const char *value) {
+dtn_cbor *dtn_bundle_add_primary_block(dtn_bundle *self, uint64_t flags,
+                                       uint64_t crc_type,
+                                       const char *destination,
+                                       const char *source,
+                                       const char *report_to, uint64_t time,
+                                       uint64_t seq, uint64_t lifetime,
+                                       uint64_t offset, uint64_t length) {
 
-    if (!self || !self->data)
+    if (!self)
         goto error;
+    if (!self->data)
+        self->data = dtn_cbor_array();
 
-    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
-    if (!block)
+    if (dtn_cbor_array_get(self->data, 0)) {
+        dtn_log_error("Primary bundle already set - abort.");
         goto error;
+    }
 
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 5);
-    if (!item) {
+    if (!dtn_bundle_primary_set_version(self))
+        goto error;
+    if (!dtn_bundle_primary_set_flags(self, flags))
+        goto error;
+    if (!dtn_bundle_primary_set_crc_type(self, crc_type))
+        goto error;
+    if (!dtn_bundle_primary_set_destination(self, destination))
+        goto error;
+    if (!dtn_bundle_primary_set_source(self, source))
+        goto error;
+    if (!dtn_bundle_primary_set_report(self, report_to))
+        goto error;
+    if (!dtn_bundle_primary_set_timestamp(self, time, seq))
+        goto error;
+    if (!dtn_bundle_primary_set_lifetime(self, lifetime))
+        goto error;
 
-        item = dtn_cbor_string(value);
-        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
-            item = dtn_cbor_free(item);
+    if (flags & 0x01) {
+        if (!dtn_bundle_primary_set_fragment_offset(self, offset))
             goto error;
-        }
-
-    } else {
-
-        if (!dtn_cbor_is_string(item))
+        if (!dtn_bundle_primary_set_total_data_length(self, length))
             goto error;
     }
 
-    return dtn_cbor_set_string(item, value);
-
+    return dtn_cbor_array_get(self->data, 0);
 error:
-    return false;
+    return NULL;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_primary_get_timestamp(const dtn_bundle *self, uint64_t *time,
-                                      uint64_t *sequence_number) {
+uint64_t dtn_bundle_primary_get_version(const dtn_bundle *self) {
 
-    if (!self || !self->data || !time || !sequence_number)
+    if (!self || !self->data)
         goto error;
 
     const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 6);
-    if (!dtn_cbor_is_array(item))
-        goto error;
+    const dtn_cbor *item = dtn_cbor_array_get(block, 0);
+    return dtn_cbor_get_uint(item);
 
-    const dtn_cbor *timestamp = dtn_cbor_array_get(item, 0);
-    if (timestamp) {
-        *time = dtn_cbor_get_uint(timestamp);
-    } else {
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_version(dtn_bundle *self) {
+
+    if (!self)
         goto error;
+
+    if (!self->data)
+        self->data = dtn_cbor_array();
+
+    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
+    if (!block) {
+        block = dtn_cbor_array();
+        if (!dtn_cbor_array_push((dtn_cbor *)self->data, block)) {
+            block = dtn_cbor_free(block);
+            goto error;
+        }
+    }
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 0);
+    if (!item) {
+        item = dtn_cbor_uint(0x07);
+        if (!dtn_cbor_array_push(block, item)) {
+            item = dtn_cbor_free(item);
+            goto error;
+        }
     }
+    return dtn_cbor_set_uint(item, 0x07);
 
-    const dtn_cbor *sequence = dtn_cbor_array_get(item, 1);
-    if (sequence) {
-        *sequence_number = dtn_cbor_get_uint(sequence);
-    } else {
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_bundle_primary_get_flags(const dtn_bundle *self) {
+
+    if (!self || !self->data)
+        goto error;
+
+    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
+    const dtn_cbor *item = dtn_cbor_array_get(block, 1);
+    return dtn_cbor_get_uint(item);
+
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_flags(dtn_bundle *self, uint64_t flags) {
+
+    if (!self || !self->data)
+        goto error;
+
+    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
+    if (!block)
         goto error;
+
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 1);
+    if (!item) {
+        item = dtn_cbor_uint(flags);
+        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
+            item = dtn_cbor_free(item);
+            goto error;
+        }
     }
+    return dtn_cbor_set_uint(item, flags);
 
-    return true;
 error:
     return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_primary_set_timestamp(dtn_bundle *self, uint64_t time,
-                                      uint64_t sequence_number) {
+uint64_t dtn_bundle_primary_get_crc_type(const dtn_bundle *self) {
+
+    if (!self || !self->data)
+        goto error;
+
+    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
+    const dtn_cbor *item = dtn_cbor_array_get(block, 2);
+    return dtn_cbor_get_uint(item);
+
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_crc_type(dtn_bundle *self, uint64_t type) {
 
     if (!self || !self->data)
         goto error;
@@ -1435,10 +1596,53 @@ bool dtn_bundle_primary_set_timestamp(dtn_bundle *self, uint64_t time,
     if (!block)
         goto error;
 
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 6);
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 2);
     if (!item) {
+        item = dtn_cbor_uint(type);
+        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
+            item = dtn_cbor_free(item);
+            goto error;
+        }
+    }
+    return dtn_cbor_set_uint(item, type);
 
-        item = dtn_cbor_array();
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+const char *dtn_bundle_primary_get_destination(const dtn_bundle *self) {
+
+    if (!self || !self->data)
+        goto error;
+
+    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
+    const dtn_cbor *item = dtn_cbor_array_get(block, 3);
+    if (!dtn_cbor_is_string(item))
+        goto error;
+
+    return dtn_cbor_get_string(item);
+
+error:
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_destination(dtn_bundle *self, const char *value) {
+
+    if (!self || !self->data)
+        goto error;
+
+    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
+    if (!block)
+        goto error;
+
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 3);
+    if (!item) {
+
+        item = dtn_cbor_string(value);
         if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
             item = dtn_cbor_free(item);
             goto error;
@@ -1446,33 +1650,60 @@ bool dtn_bundle_primary_set_timestamp(dtn_bundle *self, uint64_t time,
 
     } else {
 
-        if (!dtn_cbor_is_array(item))
+        if (!dtn_cbor_is_string(item))
             goto error;
     }
 
-    dtn_cbor *timestamp = (dtn_cbor *)dtn_cbor_array_get(item, 0);
-    if (timestamp) {
-        dtn_cbor_set_uint(timestamp, time);
-    } else {
-        timestamp = dtn_cbor_uint(time);
-        if (!dtn_cbor_array_push((dtn_cbor *)item, timestamp)) {
-            timestamp = dtn_cbor_free(timestamp);
+    return dtn_cbor_set_string(item, value);
+
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+const char *dtn_bundle_primary_get_source(const dtn_bundle *self) {
+
+    if (!self || !self->data)
+        goto error;
+
+    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
+    const dtn_cbor *item = dtn_cbor_array_get(block, 4);
+    if (!dtn_cbor_is_string(item))
+        goto error;
+    return dtn_cbor_get_string(item);
+
+error:
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_source(dtn_bundle *self, const char *value) {
+
+    if (!self || !self->data)
+        goto error;
+
+    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
+    if (!block)
+        goto error;
+
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 4);
+    if (!item) {
+
+        item = dtn_cbor_string(value);
+        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
+            item = dtn_cbor_free(item);
             goto error;
         }
-    }
 
-    dtn_cbor *sequence = (dtn_cbor *)dtn_cbor_array_get(item, 1);
-    if (sequence) {
-        dtn_cbor_set_uint(sequence, sequence_number);
     } else {
-        sequence = dtn_cbor_uint(sequence_number);
-        if (!dtn_cbor_array_push((dtn_cbor *)item, sequence)) {
-            sequence = dtn_cbor_free(sequence);
+
+        if (!dtn_cbor_is_string(item))
             goto error;
-        }
     }
 
-    return true;
+    return dtn_cbor_set_string(item, value);
 
 error:
     return false;
@@ -1480,147 +1711,661 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
-uint64_t dtn_bundle_primary_get_lifetime(const dtn_bundle *self) {
+const char *dtn_bundle_primary_get_report(const dtn_bundle *self) {
 
     if (!self || !self->data)
         goto error;
 
     const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 7);
-    if (!dtn_cbor_is_uint(item))
+    const dtn_cbor *item = dtn_cbor_array_get(block, 5);
+    if (!dtn_cbor_is_string(item))
         goto error;
-    return dtn_cbor_get_uint(item);
+    return dtn_cbor_get_string(item);
+
+error:
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_report(dtn_bundle *self, const char *value) {
+
+    if (!self || !self->data)
+        goto error;
+
+    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
+    if (!block)
+        goto error;
+
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 5);
+    if (!item) {
 
+        item = dtn_cbor_string(value);
+        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
+            item = dtn_cbor_free(item);
+            goto error;
+        }
+
+    } else {
+
+        if (!dtn_cbor_is_string(item))
+            goto error;
+    }
+
+    return dtn_cbor_set_string(item, value);
+
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_get_timestamp(const dtn_bundle *self, uint64_t *time,
+                                      uint64_t *sequence_number) {
+
+    if (!self || !self->data || !time || !sequence_number)
+        goto error;
+
+    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
+    const dtn_cbor *item = dtn_cbor_array_get(block, 6);
+    if (!dtn_cbor_is_array(item))
+        goto error;
+
+    const dtn_cbor *timestamp = dtn_cbor_array_get(item, 0);
+    if (timestamp) {
+        *time = dtn_cbor_get_uint(timestamp);
+    } else {
+        goto error;
+    }
+
+    const dtn_cbor *sequence = dtn_cbor_array_get(item, 1);
+    if (sequence) {
+        *sequence_number = dtn_cbor_get_uint(sequence);
+    } else {
+        goto error;
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_timestamp(dtn_bundle *self, uint64_t time,
+                                      uint64_t sequence_number) {
+
+    if (!self || !self->data)
+        goto error;
+
+    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
+    if (!block)
+        goto error;
+
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 6);
+    if (!item) {
+
+        item = dtn_cbor_array();
+        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
+            item = dtn_cbor_free(item);
+            goto error;
+        }
+
+    } else {
+
+        if (!dtn_cbor_is_array(item))
+            goto error;
+    }
+
+    dtn_cbor *timestamp = (dtn_cbor *)dtn_cbor_array_get(item, 0);
+    if (timestamp) {
+        dtn_cbor_set_uint(timestamp, time);
+    } else {
+        timestamp = dtn_cbor_uint(time);
+        if (!dtn_cbor_array_push((dtn_cbor *)item, timestamp)) {
+            timestamp = dtn_cbor_free(timestamp);
+            goto error;
+        }
+    }
+
+    dtn_cbor *sequence = (dtn_cbor *)dtn_cbor_array_get(item, 1);
+    if (sequence) {
+        dtn_cbor_set_uint(sequence, sequence_number);
+    } else {
+        sequence = dtn_cbor_uint(sequence_number);
+        if (!dtn_cbor_array_push((dtn_cbor *)item, sequence)) {
+            sequence = dtn_cbor_free(sequence);
+            goto error;
+        }
+    }
+
+    return true;
+
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_bundle_primary_get_lifetime(const dtn_bundle *self) {
+
+    if (!self || !self->data)
+        goto error;
+
+    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
+    const dtn_cbor *item = dtn_cbor_array_get(block, 7);
+    if (!dtn_cbor_is_uint(item))
+        goto error;
+    return dtn_cbor_get_uint(item);
+
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_lifetime(dtn_bundle *self, uint64_t type) {
+
+    if (!self || !self->data)
+        goto error;
+
+    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
+    if (!block)
+        goto error;
+
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 7);
+    if (!item) {
+
+        item = dtn_cbor_uint(type);
+        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
+            item = dtn_cbor_free(item);
+            goto error;
+        }
+
+    } else {
+
+        if (!dtn_cbor_is_uint(item))
+            goto error;
+    }
+
+    return dtn_cbor_set_uint(item, type);
+
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_bundle_primary_get_fragment_offset(const dtn_bundle *self) {
+
+    if (!self || !self->data)
+        goto error;
+
+    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
+    const dtn_cbor *item = dtn_cbor_array_get(block, 8);
+    if (!dtn_cbor_is_uint(item))
+        goto error;
+    return dtn_cbor_get_uint(item);
+
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_fragment_offset(dtn_bundle *self, uint64_t type) {
+
+    if (!self || !self->data)
+        goto error;
+
+    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
+    if (!block)
+        goto error;
+
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 8);
+    if (!item) {
+
+        item = dtn_cbor_uint(type);
+        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
+            item = dtn_cbor_free(item);
+            goto error;
+        }
+
+    } else {
+
+        if (!dtn_cbor_is_uint(item))
+            goto error;
+    }
+
+    return dtn_cbor_set_uint(item, type);
+
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_bundle_primary_get_totel_data_length(const dtn_bundle *self) {
+
+    if (!self || !self->data)
+        goto error;
+
+    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
+    const dtn_cbor *item = dtn_cbor_array_get(block, 9);
+    if (!dtn_cbor_is_uint(item))
+        goto error;
+    return dtn_cbor_get_uint(item);
+
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_set_total_data_length(dtn_bundle *self, uint64_t type) {
+
+    if (!self || !self->data)
+        goto error;
+
+    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
+    if (!block)
+        goto error;
+
+    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 9);
+    if (!item) {
+
+        item = dtn_cbor_uint(type);
+        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
+            item = dtn_cbor_free(item);
+            goto error;
+        }
+
+    } else {
+
+        if (!dtn_cbor_is_uint(item))
+            goto error;
+    }
+
+    return dtn_cbor_set_uint(item, type);
+
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_primary_get_id(const dtn_bundle *self, char *id, size_t size) {
+
+    if (!self || !id || size == 0)
+        goto error;
+
+    uint64_t timestamp = 0;
+    uint64_t sequence = 0;
+
+    const char *source = dtn_bundle_primary_get_source(self);
+    if (!source)
+        goto error;
+
+    if (!dtn_bundle_primary_get_timestamp(self, &timestamp, &sequence))
+        goto error;
+
+    int bytes = snprintf(id, size, "%s|%" PRIu64 "|%" PRIu64 "|%" PRIu64,
+                         source, timestamp, sequence,
+                         dtn_bundle_primary_get_fragment_offset(self));
+
+    if (bytes < 0 || (size_t)bytes >= size)
+        goto error;
+
+    return true;
+error:
+    if (id && size > 0)
+        id[0] = 0;
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GETTER / SETTER CANNONICAL
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_cbor *dtn_bundle_add_block(dtn_bundle *self, uint64_t code, uint64_t nbr,
+                               uint64_t flags, uint64_t crc_type,
+                               dtn_cbor *payload) {
+
+    dtn_cbor *array = NULL;
+    dtn_cbor *item = NULL;
+
+    if (!self)
+        goto error;
+    if (!self->data)
+        goto error;
+
+    array = dtn_cbor_array();
+    if (!array)
+        goto error;
+
+    item = dtn_cbor_uint(code);
+    if (!dtn_cbor_array_push(array, item))
+        goto error;
+
+    item = dtn_cbor_uint(nbr);
+    if (!dtn_cbor_array_push(array, item))
+        goto error;
+
+    item = dtn_cbor_uint(flags);
+    if (!dtn_cbor_array_push(array, item))
+        goto error;
+
+    item = dtn_cbor_uint(crc_type);
+    if (!dtn_cbor_array_push(array, item))
+        goto error;
+
+    item = NULL;
+
+    if (payload)
+        if (!dtn_cbor_array_push(array, payload))
+            goto error;
+
+    if (!dtn_cbor_array_push(self->data, array))
+        goto error;
+
+    return array;
+error:
+    dtn_cbor_free(array);
+    dtn_cbor_free(item);
+    return NULL;
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_cbor *dtn_bundle_get_block(dtn_bundle *self, uint64_t nbr) {
+
+    if (!self || !self->data)
+        return NULL;
+
+    if (nbr == 0)
+        return dtn_cbor_array_get(self->data, 0);
+
+    uint64_t count = dtn_cbor_array_count(self->data);
+
+    for (uint64_t i = 1; i < count; i++) {
+
+        dtn_cbor *item = dtn_cbor_array_get(self->data, i);
+
+        if (dtn_bundle_get_number(item) == nbr)
+            return item;
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_bundle_get_number(const dtn_cbor *self) {
+
+    if (!self)
+        return 0;
+    if (!dtn_cbor_is_array(self))
+        goto error;
+
+    dtn_cbor *item = dtn_cbor_array_get(self, 1);
+    return dtn_cbor_get_uint(item);
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_set_number(dtn_cbor *self, uint64_t number) {
+
+    if (!self)
+        goto error;
+
+    dtn_cbor *item = dtn_cbor_array_get(self, 1);
+    if (!item)
+        goto error;
+
+    return dtn_cbor_set_uint(item, number);
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_bundle_get_code(const dtn_cbor *self) {
+
+    if (!self)
+        return 0;
+    if (!dtn_cbor_is_array(self))
+        goto error;
+
+    dtn_cbor *item = dtn_cbor_array_get(self, 0);
+    return dtn_cbor_get_uint(item);
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_set_code(dtn_cbor *self, uint64_t number) {
+
+    if (!self)
+        goto error;
+
+    dtn_cbor *item = dtn_cbor_array_get(self, 0);
+    if (!item)
+        goto error;
+
+    return dtn_cbor_set_uint(item, number);
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_bundle_get_flags(const dtn_cbor *self) {
+
+    if (!self)
+        return 0;
+    if (!dtn_cbor_is_array(self))
+        goto error;
+
+    dtn_cbor *item = dtn_cbor_array_get(self, 2);
+    return dtn_cbor_get_uint(item);
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_set_flags(dtn_cbor *self, uint64_t number) {
+
+    if (!self)
+        goto error;
+
+    dtn_cbor *item = dtn_cbor_array_get(self, 2);
+    if (!item)
+        goto error;
+
+    return dtn_cbor_set_uint(item, number);
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_bundle_get_crc_type(const dtn_cbor *self) {
+
+    if (!self)
+        return 0;
+    if (!dtn_cbor_is_array(self))
+        goto error;
+
+    dtn_cbor *item = dtn_cbor_array_get(self, 3);
+    return dtn_cbor_get_uint(item);
+error:
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_set_crc_type(dtn_cbor *self, uint64_t number) {
+
+    if (!self)
+        goto error;
+
+    dtn_cbor *item = dtn_cbor_array_get(self, 3);
+    if (!item)
+        goto error;
+
+    return dtn_cbor_set_uint(item, number);
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_cbor *dtn_bundle_get_data(const dtn_cbor *self) {
+
+    if (!self)
+        return 0;
+    if (!dtn_cbor_is_array(self))
+        goto error;
+
+    dtn_cbor *item = dtn_cbor_array_get(self, 4);
+    return item;
 error:
-    return 0;
+    return NULL;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_primary_set_lifetime(dtn_bundle *self, uint64_t type) {
-
-    if (!self || !self->data)
-        goto error;
+bool dtn_bundle_set_data(dtn_cbor *self, dtn_cbor *data) {
 
-    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
-    if (!block)
+    if (!self)
+        return 0;
+    if (!dtn_cbor_is_array(self))
         goto error;
 
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 7);
-    if (!item) {
-
-        item = dtn_cbor_uint(type);
-        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
-            item = dtn_cbor_free(item);
-            goto error;
-        }
-
-    } else {
-
-        if (!dtn_cbor_is_uint(item))
-            goto error;
-    }
-
-    return dtn_cbor_set_uint(item, type);
-
+    return dtn_cbor_array_set(self, 4, data);
 error:
     return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-uint64_t dtn_bundle_primary_get_fragment_offset(const dtn_bundle *self) {
-
-    if (!self || !self->data)
-        goto error;
+bool dtn_bundle_clear(void *self) {
 
-    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 8);
-    if (!dtn_cbor_is_uint(item))
+    if (!self)
         goto error;
-    return dtn_cbor_get_uint(item);
+    dtn_bundle *bundle = (dtn_bundle *)self;
 
+    bundle->data = dtn_cbor_free(bundle->data);
+    dtn_cbor_arena_reset(bundle->arena);
+    return true;
 error:
-    return 0;
+    return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_primary_set_fragment_offset(dtn_bundle *self, uint64_t type) {
+bool dtn_bundle_dump(FILE *stream, void *bundle) {
 
-    if (!self || !self->data)
-        goto error;
+    dtn_buffer *buffer = NULL;
+    uint8_t *next = NULL;
 
-    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
-    if (!block)
+    if (!stream || !bundle)
         goto error;
 
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 8);
-    if (!item) {
+    dtn_bundle *self = (dtn_bundle *)bundle;
 
-        item = dtn_cbor_uint(type);
-        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
-            item = dtn_cbor_free(item);
-            goto error;
-        }
+    size_t size = dtn_bundle_encoding_size(self);
 
-    } else {
+    buffer = dtn_buffer_create(size);
+    if (!buffer)
+        goto error;
 
-        if (!dtn_cbor_is_uint(item))
-            goto error;
-    }
+    if (!dtn_bundle_encode(self, buffer->start, buffer->capacity, &next))
+        goto error;
 
-    return dtn_cbor_set_uint(item, type);
+    buffer->length = next - buffer->start;
+
+    dtn_dump_binary_as_hex(stream, buffer->start, buffer->length);
 
+    buffer = dtn_buffer_free(buffer);
+    return true;
 error:
+    dtn_buffer_free(buffer);
     return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-uint64_t dtn_bundle_primary_get_totel_data_length(const dtn_bundle *self) {
+void *dtn_bundle_copy(void **destination, const void *source) {
 
-    if (!self || !self->data)
+    dtn_bundle *copy = NULL;
+
+    if (!destination || !source)
+        goto error;
+    if (*destination)
         goto error;
 
-    const dtn_cbor *block = dtn_cbor_array_get(self->data, 0);
-    const dtn_cbor *item = dtn_cbor_array_get(block, 9);
-    if (!dtn_cbor_is_uint(item))
+    dtn_bundle *self = (dtn_bundle *)source;
+
+    copy = dtn_bundle_create();
+    if (!copy)
         goto error;
-    return dtn_cbor_get_uint(item);
 
+    if (self->data)
+        if (!dtn_cbor_copy((void **)&copy->data, self->data))
+            goto error;
+
+    *destination = copy;
+    return copy;
 error:
-    return 0;
+    dtn_bundle_free(copy);
+    return NULL;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_primary_set_total_data_length(dtn_bundle *self, uint64_t type) {
+void *dtn_bundle_free_void(void *self) {
 
-    if (!self || !self->data)
-        goto error;
+    if (!self)
+        return self;
+    dtn_bundle *bundle = (dtn_bundle *)self;
+    return dtn_bundle_free(bundle);
+}
 
-    dtn_cbor *block = (dtn_cbor *)dtn_cbor_array_get(self->data, 0);
-    if (!block)
-        goto error;
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      SPECIAL Functionality
+ *
+ *      ------------------------------------------------------------------------
+ */
 
-    dtn_cbor *item = (dtn_cbor *)dtn_cbor_array_get(block, 9);
-    if (!item) {
+dtn_cbor *dtn_bundle_get_raw(const dtn_bundle *self) {
 
-        item = dtn_cbor_uint(type);
-        if (!dtn_cbor_array_push((dtn_cbor *)block, item)) {
-            item = dtn_cbor_free(item);
-            goto error;
-        }
+    if (!self)
+        return NULL;
+    return self->data;
+}
 
-    } else {
+/*----------------------------------------------------------------------------*/
 
-        if (!dtn_cbor_is_uint(item))
-            goto error;
-    }
+bool dtn_bundle_set_raw(dtn_bundle *self, dtn_cbor *array) {
 
-    return dtn_cbor_set_uint(item, type);
+    if (!self || !dtn_cbor_is_array(array))
+        goto error;
 
+    self->data = dtn_cbor_free(self->data);
+    self->data = array;
+    return true;
 error:
     return false;
 }
@@ -1628,69 +2373,60 @@ error:
 /*
  *      ------------------------------------------------------------------------
  *
- *      GETTER / SETTER CANNONICAL
+ *      SPECIAL BLOCKS
  *
  *      ------------------------------------------------------------------------
  */
 
-dtn_cbor *dtn_bundle_add_block(dtn_bundle *self, uint64_t code, uint64_t nbr,
-                               uint64_t flags, uint64_t crc_type,
-                               dtn_cbor *payload) {
+dtn_cbor *dtn_bundle_add_previous_node(dtn_bundle *self, const char *node_id) {
 
-    dtn_cbor *array = NULL;
-    dtn_cbor *item = NULL;
+    if (!self || !node_id)
+        return NULL;
 
-    if (!self)
-        goto error;
-    if (!self->data)
-        goto error;
+    return dtn_bundle_add_block(self, 6, 6, 0, 0, dtn_cbor_string(node_id));
+}
 
-    array = dtn_cbor_array();
-    if (!array)
-        goto error;
+/*----------------------------------------------------------------------------*/
 
-    item = dtn_cbor_uint(code);
-    if (!dtn_cbor_array_push(array, item))
-        goto error;
+/*
+ *      Block type specific data of the age and hop count blocks is the
+ *      CBOR encoding of the values within a byte string (RFC 9171 4.4).
+ */
 
-    item = dtn_cbor_uint(nbr);
-    if (!dtn_cbor_array_push(array, item))
-        goto error;
+#define SPECIAL_DATA_MAX 32
 
-    item = dtn_cbor_uint(flags);
-    if (!dtn_cbor_array_push(array, item))
-        goto error;
+/*----------------------------------------------------------------------------*/
 
-    item = dtn_cbor_uint(crc_type);
-    if (!dtn_cbor_array_push(array, item))
-        goto error;
+static dtn_cbor *special_data(const dtn_cbor *value) {
 
-    item = NULL;
+    uint8_t buffer[SPECIAL_DATA_MAX] = {0};
+    uint8_t *next = NULL;
 
-    if (payload)
-        if (!dtn_cbor_array_push(array, payload))
-            goto error;
+    dtn_cbor *data = NULL;
 
-    if (!dtn_cbor_array_push(self->data, array))
+    if (!dtn_cbor_encode(value, buffer, SPECIAL_DATA_MAX, &next))
         goto error;
 
-    return array;
+    data = dtn_cbor_string(NULL);
+
+    if (!dtn_cbor_set_byte_string(data, buffer, next - buffer))
+        goto error;
+
+    return data;
 error:
-    dtn_cbor_free(array);
-    dtn_cbor_free(item);
-    return NULL;
+    dtn_cbor_free(data);
     return NULL;
 }
 
 /*----------------------------------------------------------------------------*/
 
-dtn_cbor *dtn_bundle_get_block(dtn_bundle *self, uint64_t nbr) {
-
-    if (!self || !self->data)
-        return NULL;
+static dtn_cbor *special_value(dtn_bundle *self, uint64_t code,
+                               dtn_cbor **block) {
 
-    if (nbr == 0)
-        return dtn_cbor_array_get(self->data, 0);
+    dtn_cbor *value = NULL;
+    uint8_t *bytes = NULL;
+    uint8_t *next = NULL;
+    size_t size = 0;
 
     uint64_t count = dtn_cbor_array_count(self->data);
 
@@ -1698,494 +2434,672 @@ dtn_cbor *dtn_bundle_get_block(dtn_bundle *self, uint64_t nbr) {
 
         dtn_cbor *item = dtn_cbor_array_get(self->data, i);
 
-        if (dtn_bundle_get_number(item) == nbr)
-            return item;
+        if (dtn_bundle_get_code(item) != code)
+            continue;
+
+        if (!dtn_cbor_get_byte_string(dtn_bundle_get_data(item), &bytes,
+                                      &size) ||
+            !bytes)
+            goto error;
+
+        if (DTN_CBOR_MATCH_FULL != dtn_cbor_decode(bytes, size, &value, &next))
+            goto error;
+
+        if (block)
+            *block = item;
+
+        return value;
     }
 
+error:
+    dtn_cbor_free(value);
     return NULL;
 }
 
 /*----------------------------------------------------------------------------*/
 
-uint64_t dtn_bundle_get_number(const dtn_cbor *self) {
+dtn_cbor *dtn_bundle_add_bundle_age(dtn_bundle *self, uint64_t age) {
+
+    dtn_cbor *value = dtn_cbor_uint(age);
+    dtn_cbor *data = NULL;
+
+    if (!self || !value)
+        goto error;
+
+    data = special_data(value);
+    value = dtn_cbor_free(value);
+
+    if (!data)
+        goto error;
+
+    return dtn_bundle_add_block(self, 7, 7, 0, 0, data);
+error:
+    dtn_cbor_free(value);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_get_bundle_age(dtn_bundle *self, uint64_t *age) {
+
+    if (!self || !age)
+        return false;
+
+    dtn_cbor *value = special_value(self, 7, NULL);
+    if (!dtn_cbor_is_uint(value))
+        goto error;
+
+    *age = dtn_cbor_get_uint(value);
+    dtn_cbor_free(value);
+    return true;
+error:
+    dtn_cbor_free(value);
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_set_bundle_age(dtn_bundle *self, uint64_t age) {
+
+    dtn_cbor *block = NULL;
+    dtn_cbor *data = NULL;
 
     if (!self)
-        return 0;
-    if (!dtn_cbor_is_array(self))
         goto error;
 
-    dtn_cbor *item = dtn_cbor_array_get(self, 1);
-    return dtn_cbor_get_uint(item);
+    dtn_cbor *value = special_value(self, 7, &block);
+    bool parsed = dtn_cbor_is_uint(value);
+    value = dtn_cbor_free(value);
+
+    if (!parsed)
+        goto error;
+
+    value = dtn_cbor_uint(age);
+    if (!value)
+        goto error;
+
+    data = special_data(value);
+    value = dtn_cbor_free(value);
+
+    if (!data || !dtn_bundle_set_data(block, data))
+        goto error;
+
+    return true;
 error:
-    return 0;
+    dtn_cbor_free(data);
+    return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_set_number(dtn_cbor *self, uint64_t number) {
+static dtn_cbor *hop_count_data(uint64_t count, uint64_t limit) {
+
+    dtn_cbor *arr = dtn_cbor_array();
+    dtn_cbor *data = NULL;
 
-    if (!self)
+    if (!arr)
         goto error;
 
-    dtn_cbor *item = dtn_cbor_array_get(self, 1);
-    if (!item)
+    if (!dtn_cbor_array_push(arr, dtn_cbor_uint(limit)))
+        goto error;
+    if (!dtn_cbor_array_push(arr, dtn_cbor_uint(count)))
         goto error;
 
-    return dtn_cbor_set_uint(item, number);
+    data = special_data(arr);
 error:
-    return false;
+    dtn_cbor_free(arr);
+    return data;
 }
 
 /*----------------------------------------------------------------------------*/
 
-uint64_t dtn_bundle_get_code(const dtn_cbor *self) {
+dtn_cbor *dtn_bundle_add_hop_count(dtn_bundle *self, uint64_t count,
+                                   uint64_t limit) {
 
     if (!self)
-        return 0;
-    if (!dtn_cbor_is_array(self))
-        goto error;
+        return NULL;
 
-    dtn_cbor *item = dtn_cbor_array_get(self, 0);
-    return dtn_cbor_get_uint(item);
-error:
-    return 0;
+    dtn_cbor *data = hop_count_data(count, limit);
+    if (!data)
+        return NULL;
+
+    return dtn_bundle_add_block(self, 10, 10, 0, 0, data);
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_set_code(dtn_cbor *self, uint64_t number) {
+static bool hop_count_parse(const dtn_cbor *value, uint64_t *count,
+                            uint64_t *limit) {
 
-    if (!self)
-        goto error;
+    if (2 != dtn_cbor_array_count(value))
+        return false;
 
-    dtn_cbor *item = dtn_cbor_array_get(self, 0);
-    if (!item)
-        goto error;
+    dtn_cbor *l = dtn_cbor_array_get(value, 0);
+    dtn_cbor *c = dtn_cbor_array_get(value, 1);
 
-    return dtn_cbor_set_uint(item, number);
-error:
-    return false;
+    if (!dtn_cbor_is_uint(l) || !dtn_cbor_is_uint(c))
+        return false;
+
+    *limit = dtn_cbor_get_uint(l);
+    *count = dtn_cbor_get_uint(c);
+    return true;
 }
 
 /*----------------------------------------------------------------------------*/
 
-uint64_t dtn_bundle_get_flags(const dtn_cbor *self) {
+bool dtn_bundle_get_hop_count(dtn_bundle *self, uint64_t *count,
+                              uint64_t *limit) {
 
-    if (!self)
-        return 0;
-    if (!dtn_cbor_is_array(self))
-        goto error;
+    if (!self || !count || !limit)
+        return false;
 
-    dtn_cbor *item = dtn_cbor_array_get(self, 2);
-    return dtn_cbor_get_uint(item);
-error:
-    return 0;
+    dtn_cbor *value = special_value(self, 10, NULL);
+    bool result = hop_count_parse(value, count, limit);
+    dtn_cbor_free(value);
+    return result;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_set_flags(dtn_cbor *self, uint64_t number) {
+bool dtn_bundle_set_hop_count(dtn_bundle *self, uint64_t count) {
+
+    dtn_cbor *block = NULL;
+    dtn_cbor *data = NULL;
+    uint64_t current = 0;
+    uint64_t limit = 0;
 
     if (!self)
         goto error;
 
-    dtn_cbor *item = dtn_cbor_array_get(self, 2);
-    if (!item)
+    dtn_cbor *value = special_value(self, 10, &block);
+    bool parsed = hop_count_parse(value, &current, &limit);
+    value = dtn_cbor_free(value);
+
+    if (!parsed)
         goto error;
 
-    return dtn_cbor_set_uint(item, number);
+    data = hop_count_data(count, limit);
+    if (!data || !dtn_bundle_set_data(block, data))
+        goto error;
+
+    return true;
 error:
+    dtn_cbor_free(data);
     return false;
 }
 
-/*----------------------------------------------------------------------------*/
-
-uint64_t dtn_bundle_get_crc_type(const dtn_cbor *self) {
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      SECURITY BLOCKS
+ *
+ *      ------------------------------------------------------------------------
+ */
+/*
+static bool set_crc_flags_to_null(void *item, void *data){
 
-    if (!self)
-        return 0;
-    if (!dtn_cbor_is_array(self))
-        goto error;
+    uint64_t nbr = dtn_cbor_get_uint(item);
+    dtn_bundle *bundle = (dtn_bundle*) data;
 
-    dtn_cbor *item = dtn_cbor_array_get(self, 3);
-    return dtn_cbor_get_uint(item);
-error:
-    return 0;
+    dtn_cbor *block = dtn_bundle_get_block(bundle, nbr);
+    return dtn_bundle_set_crc_type(block, 0);
 }
+*/
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_set_crc_type(dtn_cbor *self, uint64_t number) {
+static dtn_buffer *generate_new_key(dtn_bpsec_sha_variant sha) {
 
-    if (!self)
+    dtn_buffer *buffer = NULL;
+
+    size_t len = 256;
+
+    switch (sha) {
+    case HMAC256:
+        len = 256;
+        break;
+    case HMAC384:
+        len = 384;
+        break;
+    case HMAC512:
+        len = 512;
+        break;
+    }
+
+    buffer = dtn_buffer_create(len);
+    if (!buffer)
         goto error;
 
-    dtn_cbor *item = dtn_cbor_array_get(self, 3);
-    if (!item)
+    if (1 != RAND_bytes(buffer->start, len))
         goto error;
 
-    return dtn_cbor_set_uint(item, number);
+    buffer->length = len;
+    return buffer;
 error:
-    return false;
+    return NULL;
 }
 
 /*----------------------------------------------------------------------------*/
 
-dtn_cbor *dtn_bundle_get_data(const dtn_cbor *self) {
+static dtn_buffer *generate_iv(size_t len) {
 
-    if (!self)
-        return 0;
-    if (!dtn_cbor_is_array(self))
+    dtn_buffer *buffer = NULL;
+
+    buffer = dtn_buffer_create(len);
+    if (!buffer)
         goto error;
 
-    dtn_cbor *item = dtn_cbor_array_get(self, 4);
-    return item;
+    if (1 != RAND_bytes(buffer->start, len))
+        goto error;
+
+    buffer->length = len;
+    return buffer;
 error:
     return NULL;
 }
+/*----------------------------------------------------------------------------*/
+
+/*
+ *      Each thread keeps its HMAC and AES-GCM contexts for reuse, as the
+ *      setup of a context costs more than the crypto of small blocks. A
+ *      context remembers its last key, processing with the same key skips
+ *      the key setup. Ciphers are fetched once for all threads. The keys
+ *      copied for the comparison are cleansed on thread exit.
+ */
+
+#define CRYPTO_KEY_MAX 512
+
+struct crypto_key {
+
+    size_t size; // 0 if the context has no reusable key
+    uint8_t bytes[CRYPTO_KEY_MAX];
+};
+
+struct crypto_cache {
+
+    dtn_hmac_context *hmac[3];
+    struct crypto_key hmac_key[3];
+
+    EVP_CIPHER_CTX *gcm[2];
+    struct crypto_key gcm_key[2];
+
+    bool registered;
+};
+
+static _Thread_local struct crypto_cache g_crypto = {0};
+
+static pthread_key_t g_crypto_key;
+static pthread_once_t g_crypto_once = PTHREAD_ONCE_INIT;
+
+static EVP_CIPHER *g_gcm[2] = {0};
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_set_data(dtn_cbor *self, dtn_cbor *data) {
+static void crypto_release(void *data) {
 
-    if (!self)
-        return 0;
-    if (!dtn_cbor_is_array(self))
-        goto error;
+    struct crypto_cache *cache = (struct crypto_cache *)data;
+    if (!cache)
+        return;
 
-    return dtn_cbor_array_set(self, 4, data);
-error:
-    return false;
+    for (size_t i = 0; i < 3; i++) {
+        cache->hmac[i] = dtn_hmac_context_free(cache->hmac[i]);
+    }
+
+    for (size_t i = 0; i < 2; i++) {
+        EVP_CIPHER_CTX_free(cache->gcm[i]);
+        cache->gcm[i] = NULL;
+    }
+
+    OPENSSL_cleanse(cache->hmac_key, sizeof(cache->hmac_key));
+    OPENSSL_cleanse(cache->gcm_key, sizeof(cache->gcm_key));
+    return;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_clear(void *self) {
+static void crypto_init() {
 
-    if (!self)
-        goto error;
-    dtn_bundle *bundle = (dtn_bundle *)self;
+    pthread_key_create(&g_crypto_key, crypto_release);
 
-    bundle->data = dtn_cbor_free(bundle->data);
-    return true;
-error:
-    return false;
+    g_gcm[0] = EVP_CIPHER_fetch(NULL, "AES-128-GCM", NULL);
+    g_gcm[1] = EVP_CIPHER_fetch(NULL, "AES-256-GCM", NULL);
+    return;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_dump(FILE *stream, void *bundle) {
+static void crypto_register() {
 
-    dtn_buffer *buffer = NULL;
-    uint8_t *next = NULL;
+    pthread_once(&g_crypto_once, crypto_init);
 
-    if (!stream || !bundle)
-        goto error;
+    if (!g_crypto.registered) {
 
-    dtn_bundle *self = (dtn_bundle *)bundle;
+        // free the contexts of the thread on thread exit
+        pthread_setspecific(g_crypto_key, &g_crypto);
+        g_crypto.registered = true;
+    }
 
-    size_t size = dtn_bundle_encoding_size(self);
+    return;
+}
 
-    buffer = dtn_buffer_create(size);
-    if (!buffer)
-        goto error;
+/*----------------------------------------------------------------------------*/
 
-    if (!dtn_bundle_encode(self, buffer->start, buffer->capacity, &next))
-        goto error;
+static bool crypto_key_matches(const struct crypto_key *self,
+                               const uint8_t *key, size_t size) {
 
-    buffer->length = next - buffer->start;
+    return (self->size == size) && (size > 0) &&
+           (0 == CRYPTO_memcmp(self->bytes, key, size));
+}
 
-    dtn_dump_binary_as_hex(stream, buffer->start, buffer->length);
+/*----------------------------------------------------------------------------*/
 
-    buffer = dtn_buffer_free(buffer);
-    return true;
-error:
-    dtn_buffer_free(buffer);
-    return false;
+static void crypto_key_set(struct crypto_key *self, const uint8_t *key,
+                           size_t size) {
+
+    if (!key || size > CRYPTO_KEY_MAX) {
+        self->size = 0;
+        return;
+    }
+
+    memcpy(self->bytes, key, size);
+    self->size = size;
+    return;
 }
 
 /*----------------------------------------------------------------------------*/
 
-void *dtn_bundle_copy(void **destination, const void *source) {
-
-    dtn_bundle *copy = NULL;
+static dtn_hmac_context *crypto_hmac(dtn_bpsec_sha_variant sha,
+                                     const uint8_t *key, size_t key_size,
+                                     const dtn_key *prepared) {
 
-    if (!destination || !source)
-        goto error;
-    if (*destination)
-        goto error;
+    size_t index = 1;
+    dtn_hash_function functions[] = {DTN_HASH_SHA256, DTN_HASH_SHA384,
+                                     DTN_HASH_SHA512};
 
-    dtn_bundle *self = (dtn_bundle *)source;
+    switch (sha) {
+    case HMAC256:
+        index = 0;
+        break;
+    case HMAC384:
+        index = 1;
+        break;
+    case HMAC512:
+        index = 2;
+        break;
+    }
 
-    copy = dtn_bundle_create();
-    if (!copy)
+    if (!key)
         goto error;
 
-    if (self->data)
-        if (!dtn_cbor_copy((void **)&copy->data, self->data))
-            goto error;
+    crypto_register();
 
-    *destination = copy;
-    return copy;
-error:
-    dtn_bundle_free(copy);
-    return NULL;
-}
+    struct crypto_key *cached = &g_crypto.hmac_key[index];
 
-/*----------------------------------------------------------------------------*/
+    if (g_crypto.hmac[index] && crypto_key_matches(cached, key, key_size)) {
 
-void *dtn_bundle_free_void(void *self) {
+        if (!dtn_hmac_context_reset(g_crypto.hmac[index], NULL, 0))
+            goto error;
 
-    if (!self)
-        return self;
-    dtn_bundle *bundle = (dtn_bundle *)self;
-    return dtn_bundle_free(bundle);
-}
+    } else if (prepared) {
 
-/*
- *      ------------------------------------------------------------------------
- *
- *      SPECIAL Functionality
- *
- *      ------------------------------------------------------------------------
- */
+        // copy the key setup done by the key store
+        dtn_hmac_context_free(g_crypto.hmac[index]);
+        g_crypto.hmac[index] = dtn_key_hmac_create(prepared, functions[index]);
 
-dtn_cbor *dtn_bundle_get_raw(const dtn_bundle *self) {
+        if (!g_crypto.hmac[index])
+            goto error;
 
-    if (!self)
-        return NULL;
-    return self->data;
-}
+    } else if (!g_crypto.hmac[index]) {
 
-/*----------------------------------------------------------------------------*/
+        g_crypto.hmac[index] =
+            dtn_hmac_context_create(functions[index], key, key_size);
 
-bool dtn_bundle_set_raw(dtn_bundle *self, dtn_cbor *array) {
+        if (!g_crypto.hmac[index])
+            goto error;
+
+    } else if (!dtn_hmac_context_reset(g_crypto.hmac[index], key, key_size)) {
 
-    if (!self || !dtn_cbor_is_array(array))
         goto error;
+    }
 
-    self->data = dtn_cbor_free(self->data);
-    self->data = array;
-    return true;
+    crypto_key_set(cached, key, key_size);
+    return g_crypto.hmac[index];
 error:
-    return false;
+    g_crypto.hmac_key[index].size = 0;
+    return NULL;
 }
 
+/*----------------------------------------------------------------------------*/
+
 /*
- *      ------------------------------------------------------------------------
- *
- *      SPECIAL BLOCKS
- *
- *      ------------------------------------------------------------------------
+ *      Prepare the GCM context of the thread for a new message of key and iv.
  */
+static EVP_CIPHER_CTX *crypto_gcm(bool encrypt, dtn_bpsec_aes_variant aes,
+                                  const uint8_t *key, const uint8_t *iv,
+                                  size_t iv_size) {
 
-dtn_cbor *dtn_bundle_add_previous_node(dtn_bundle *self, const char *node_id) {
+    size_t index = 0;
+
+    switch (aes) {
+    case A128GCM:
+        index = 0;
+        break;
+    case A256GCM:
+        index = 1;
+        break;
+    default:
+        return NULL;
+    }
 
-    if (!self || !node_id)
+    if (!key || !iv)
         return NULL;
 
-    return dtn_bundle_add_block(self, 6, 6, 0, 0, dtn_cbor_string(node_id));
-}
+    crypto_register();
 
-/*----------------------------------------------------------------------------*/
+    struct crypto_key *cached = &g_crypto.gcm_key[index];
+    EVP_CIPHER_CTX *ctx = g_crypto.gcm[index];
 
-dtn_cbor *dtn_bundle_add_bundle_age(dtn_bundle *self, uint64_t age) {
+    if (!ctx) {
 
-    if (!self)
-        return NULL;
+        if (!g_gcm[index])
+            goto error;
 
-    return dtn_bundle_add_block(self, 7, 7, 0, 0, dtn_cbor_uint(age));
-}
+        if (!(ctx = EVP_CIPHER_CTX_new()))
+            goto error;
 
-/*----------------------------------------------------------------------------*/
+        g_crypto.gcm[index] = ctx;
 
-dtn_cbor *dtn_bundle_add_hop_count(dtn_bundle *self, uint64_t count,
-                                   uint64_t limit) {
+        if (1 != EVP_CipherInit_ex(ctx, g_gcm[index], NULL, NULL, NULL,
+                                   encrypt))
+            goto error;
+    }
 
-    dtn_cbor *arr = NULL;
+    size_t key_size = EVP_CIPHER_get_key_length(g_gcm[index]);
 
-    if (!self)
-        goto error;
+    if (crypto_key_matches(cached, key, key_size))
+        key = NULL;
 
-    arr = dtn_cbor_array();
-    if (!arr)
+    if (1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, iv_size, NULL))
         goto error;
 
-    if (!dtn_cbor_array_push(arr, dtn_cbor_uint(limit)))
-        goto error;
-    if (!dtn_cbor_array_push(arr, dtn_cbor_uint(count)))
+    if (1 != EVP_CipherInit_ex(ctx, NULL, NULL, key, iv, encrypt))
         goto error;
 
-    return dtn_bundle_add_block(self, 10, 10, 0, 0, arr);
+    if (key)
+        crypto_key_set(cached, key, key_size);
+
+    return ctx;
 error:
-    dtn_cbor_free(arr);
+    cached->size = 0;
     return NULL;
 }
 
+/*----------------------------------------------------------------------------*/
+
 /*
- *      ------------------------------------------------------------------------
- *
- *      SECURITY BLOCKS
- *
- *      ------------------------------------------------------------------------
+ *      The security input of a BIB or BCB (RFC 9173 3.7 and 4.7) is fed
+ *      item by item into the HMAC or into the AAD of the cipher. Byte
+ *      strings are fed from the block data, so the input is never copied
+ *      as a whole and its size is limited by memory only.
  */
-/*
-static bool set_crc_flags_to_null(void *item, void *data){
 
-    uint64_t nbr = dtn_cbor_get_uint(item);
-    dtn_bundle *bundle = (dtn_bundle*) data;
+typedef bool (*security_sink)(void *context, const uint8_t *data,
+                              size_t size);
 
-    dtn_cbor *block = dtn_bundle_get_block(bundle, nbr);
-    return dtn_bundle_set_crc_type(block, 0);
-}
-*/
+#define SECURITY_SCRATCH_SIZE 256
 
 /*----------------------------------------------------------------------------*/
 
-static dtn_buffer *generate_new_key(dtn_bpsec_sha_variant sha) {
+static bool feed_item(const dtn_cbor *item, security_sink sink,
+                      void *context) {
 
-    dtn_buffer *buffer = NULL;
+    uint8_t scratch[SECURITY_SCRATCH_SIZE] = {0};
+    uint8_t *buffer = scratch;
+    uint8_t *next = NULL;
+    uint8_t *bytes = NULL;
+    const uint8_t *cached = NULL;
+    size_t size = 0;
 
-    size_t len = 256;
+    if (dtn_cbor_is_string(item)) {
 
-    switch (sha) {
-    case HMAC256:
-        len = 256;
-        break;
-    case HMAC384:
-        len = 384;
-        break;
-    case HMAC512:
-        len = 512;
-        break;
+        if (!dtn_cbor_encode_string_head(item, scratch, sizeof(scratch),
+                                         &next))
+            goto error;
+
+        if (!dtn_cbor_get_byte_string(item, &bytes, &size))
+            goto error;
+
+        if (!sink(context, scratch, next - scratch))
+            goto error;
+
+        return (0 == size) || sink(context, bytes, size);
     }
 
-    buffer = dtn_buffer_create(len);
-    if (!buffer)
-        goto error;
+    if (dtn_cbor_get_cached_encoding(item, &cached, &size))
+        return sink(context, cached, size);
 
-    if (1 != RAND_bytes(buffer->start, len))
+    size = dtn_cbor_encoding_size(item);
+    if (0 == size)
         goto error;
 
-    buffer->length = len;
-    return buffer;
+    if (size > sizeof(scratch)) {
+
+        buffer = calloc(1, size);
+        if (!buffer)
+            goto error;
+    }
+
+    bool result = dtn_cbor_encode(item, buffer, size, &next) &&
+                  sink(context, buffer, next - buffer);
+
+    if (buffer != scratch)
+        free(buffer);
+
+    return result;
 error:
-    return NULL;
+    return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-static dtn_buffer *generate_iv(size_t len) {
+static bool feed_block_header(const dtn_cbor *block, security_sink sink,
+                              void *context) {
 
-    dtn_buffer *buffer = NULL;
+    // block type code, block number and block processing control flags
 
-    buffer = dtn_buffer_create(len);
-    if (!buffer)
-        goto error;
+    for (uint64_t i = 0; i < 3; i++) {
 
-    if (1 != RAND_bytes(buffer->start, len))
-        goto error;
+        if (!feed_item(dtn_cbor_array_get(block, i), sink, context))
+            return false;
+    }
 
-    buffer->length = len;
-    return buffer;
-error:
-    return NULL;
+    return true;
 }
+
 /*----------------------------------------------------------------------------*/
 
-static bool generate_hash_input(dtn_bundle *self, dtn_cbor *bib,
-                                dtn_cbor *target, uint8_t aad_flags,
-                                uint8_t *buffer, size_t *len,
-                                bool target_payload) {
+static bool security_input(dtn_bundle *self, dtn_cbor *asb_block,
+                           dtn_cbor *target, uint8_t aad_flags,
+                           bool target_payload, security_sink sink,
+                           void *context) {
 
-    if (!self || !bib || !target || !buffer)
+    if (!self || !asb_block || !target || !sink)
         goto error;
 
-    dtn_cbor *block = NULL;
-
-    buffer[0] = aad_flags;
-    uint8_t *ptr = buffer + 1;
+    if (!sink(context, &aad_flags, 1))
+        goto error;
 
-    size_t size = *len;
+    dtn_cbor *primary = dtn_cbor_array_get(self->data, 0);
 
-    if (target == dtn_cbor_array_get(self->data, 0)) {
+    if (target == primary) {
 
         // primary block target
         if (!dtn_bundle_primary_set_crc_type(self, 0))
             goto error;
 
-        if (aad_flags & 0x03) {
-
-            block = dtn_cbor_array_get(bib, 0);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
-
-            block = dtn_cbor_array_get(bib, 1);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
+        if (aad_flags & 0x03)
+            if (!feed_block_header(asb_block, sink, context))
                 goto error;
 
-            block = dtn_cbor_array_get(bib, 2);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
-        }
+        return feed_item(primary, sink, context);
+    }
 
-        block = dtn_cbor_array_get(self->data, 0);
-        if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
+    if (aad_flags & 0x01)
+        if (!dtn_bundle_primary_set_crc_type(self, 0))
             goto error;
 
-    } else {
+    if (!dtn_bundle_set_crc_type(target, 0))
+        goto error;
 
-        if (aad_flags & 0x01)
-            if (!dtn_bundle_primary_set_crc_type(self, 0))
-                goto error;
+    if (aad_flags & 0x01)
+        if (!feed_item(primary, sink, context))
+            goto error;
 
-        if (!dtn_bundle_set_crc_type(target, 0))
+    if (aad_flags & 0x02)
+        if (!feed_block_header(target, sink, context))
             goto error;
 
-        if (aad_flags & 0x01) {
-            block = dtn_cbor_array_get(self->data, 0);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
-        }
+    if (aad_flags & 0x03)
+        if (!feed_block_header(asb_block, sink, context))
+            goto error;
 
-        if (aad_flags & 0x02) {
+    if (target_payload)
+        if (!feed_item(dtn_bundle_get_data(target), sink, context))
+            goto error;
 
-            block = dtn_cbor_array_get(target, 0);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
+    return true;
+error:
+    return false;
+}
 
-            block = dtn_cbor_array_get(target, 1);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
+/*----------------------------------------------------------------------------*/
 
-            block = dtn_cbor_array_get(target, 2);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
-        }
+static bool hmac_sink(void *context, const uint8_t *data, size_t size) {
 
-        if (aad_flags & 0x03) {
+    return dtn_hmac_update((dtn_hmac_context *)context, data, size);
+}
 
-            block = dtn_cbor_array_get(bib, 0);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
+/*----------------------------------------------------------------------------*/
 
-            block = dtn_cbor_array_get(bib, 1);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
+/*
+ *      prepared is the key of the store key was taken from, if any.
+ */
+static bool security_hmac(dtn_bundle *self, dtn_cbor *bib, dtn_cbor *target,
+                          uint8_t aad_flags, dtn_bpsec_sha_variant sha,
+                          const uint8_t *key, size_t key_size,
+                          const dtn_key *prepared, uint8_t *hash,
+                          size_t *hash_size) {
 
-            block = dtn_cbor_array_get(bib, 2);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
-        }
+    dtn_hmac_context *hmac = crypto_hmac(sha, key, key_size, prepared);
+    if (!hmac)
+        goto error;
 
-        if (target_payload) {
-            block = dtn_bundle_get_data(target);
-            if (!dtn_cbor_encode(block, ptr, size - (ptr - buffer), &ptr))
-                goto error;
-        }
-    }
+    if (!security_input(self, bib, target, aad_flags, true, hmac_sink, hmac))
+        goto error;
+
+    if (!dtn_hmac_final(hmac, hash, hash_size))
+        goto error;
 
-    *len = ptr - buffer;
     return true;
 error:
     return false;
@@ -2201,18 +3115,12 @@ bool dtn_bundle_bib_protect(dtn_bundle *self, dtn_cbor *bib, dtn_cbor *target,
     dtn_bpsec_asb *asb = NULL;
     dtn_buffer *new_key = NULL;
 
-    uint8_t buffer[4096] = {0};
-    size_t size = 4096;
-
-    uint8_t hash[4096] = {0};
-    size_t hash_size = 4096;
+    uint8_t hash[EVP_MAX_MD_SIZE] = {0};
+    size_t hash_size = EVP_MAX_MD_SIZE;
 
     uint8_t wrapped[4096] = {0};
     size_t wrapped_size = 4096;
 
-    if (!generate_hash_input(self, bib, target, aad_flags, buffer, &size, true))
-        goto error;
-
     if (add_new_key) {
 
         new_key = generate_new_key(sha);
@@ -2225,22 +3133,8 @@ bool dtn_bundle_bib_protect(dtn_bundle *self, dtn_cbor *bib, dtn_cbor *target,
         new_key = (dtn_buffer *)key;
     }
 
-    dtn_hash_function hash_function = DTN_HASH_SHA384;
-
-    switch (sha) {
-    case HMAC256:
-        hash_function = DTN_HASH_SHA256;
-        break;
-    case HMAC384:
-        hash_function = DTN_HASH_SHA384;
-        break;
-    case HMAC512:
-        hash_function = DTN_HASH_SHA512;
-        break;
-    }
-
-    if (!dtn_hmac(hash_function, buffer, size, new_key->start, new_key->length,
-                  hash, &hash_size))
+    if (!security_hmac(self, bib, target, aad_flags, sha, new_key->start,
+                       new_key->length, NULL, hash, &hash_size))
         goto error;
 
     uint64_t nbr = 0;
@@ -2345,7 +3239,9 @@ static bool check_integrity_for_target(void *item, void *data) {
     dtn_dtn_uri *uri = NULL;
     dtn_ipn *ipn = NULL;
 
-    dtn_buffer *master_key = NULL;
+    dtn_key *handle = NULL;
+    const dtn_buffer *master_key = NULL;
+    const dtn_key *prepared = NULL;
 
     uint8_t *result = NULL;
     size_t result_size = 0;
@@ -2358,11 +3254,8 @@ static bool check_integrity_for_target(void *item, void *data) {
     char source[4096] = {0};
     size_t source_size = 4096;
 
-    uint8_t hash_input[4096] = {0};
-    size_t hash_input_size = 4096;
-
-    uint8_t hash[4096] = {0};
-    size_t hash_size = 4096;
+    uint8_t hash[EVP_MAX_MD_SIZE] = {0};
+    size_t hash_size = EVP_MAX_MD_SIZE;
 
     dtn_cbor *target_id = (dtn_cbor *)item;
     uint64_t id = dtn_cbor_get_uint(target_id);
@@ -2394,7 +3287,8 @@ static bool check_integrity_for_target(void *item, void *data) {
         goto error;
     }
 
-    master_key = dtn_key_store_get(container->store, source);
+    handle = dtn_key_store_acquire(container->store, source);
+    master_key = dtn_key_get_buffer(handle);
     if (!master_key) {
         dtn_log_error("no masterkey found for %s", source);
         goto error;
@@ -2414,29 +3308,12 @@ static bool check_integrity_for_target(void *item, void *data) {
     } else {
 
         key = master_key->start, key_size = master_key->length;
+        prepared = handle;
     }
 
-    if (!generate_hash_input(container->self, container->bib, target,
-                             container->integrity_flags, hash_input,
-                             &hash_input_size, true))
-        goto error;
-
-    dtn_hash_function hash_function = DTN_HASH_SHA384;
-
-    switch (container->sha) {
-    case HMAC256:
-        hash_function = DTN_HASH_SHA256;
-        break;
-    case HMAC384:
-        hash_function = DTN_HASH_SHA384;
-        break;
-    case HMAC512:
-        hash_function = DTN_HASH_SHA512;
-        break;
-    }
-
-    if (!dtn_hmac(hash_function, hash_input, hash_input_size, key, key_size,
-                  hash, &hash_size))
+    if (!security_hmac(container->self, container->bib, target,
+                       container->integrity_flags, container->sha, key,
+                       key_size, prepared, hash, &hash_size))
         goto error;
 
     if (hash_size != result_size)
@@ -2447,12 +3324,12 @@ static bool check_integrity_for_target(void *item, void *data) {
 
     uri = dtn_dtn_uri_free(uri);
     ipn = dtn_ipn_free(ipn);
-    master_key = dtn_buffer_free(master_key);
+    handle = dtn_key_release(handle);
     return true;
 error:
     uri = dtn_dtn_uri_free(uri);
     ipn = dtn_ipn_free(ipn);
-    master_key = dtn_buffer_free(master_key);
+    handle = dtn_key_release(handle);
     return false;
 }
 
@@ -2519,132 +3396,94 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
-static bool gcm_encrypt(dtn_bpsec_aes_variant aes, uint8_t *plaintext,
-                        size_t plaintext_size, uint8_t *aad, size_t aad_size,
-                        uint8_t *key, size_t key_size, uint8_t *iv,
-                        size_t iv_len, uint8_t *ciphertext,
-                        size_t *ciphertext_size, uint8_t *tag,
-                        size_t tag_size) {
-
-    EVP_CIPHER_CTX *ctx;
-
-    UNUSED(key_size);
-
-    int len = 0;
-    int ciphertext_len = 0;
-
-    if (!(ctx = EVP_CIPHER_CTX_new()))
-        goto error;
-
-    switch (aes) {
-
-    case A128GCM:
-
-        if (1 != EVP_EncryptInit_ex(ctx, EVP_aes_128_gcm(), NULL, NULL, NULL))
-            goto error;
+/*
+ *      AES-GCM of the data of target in place, with the security input of
+ *      the BCB as AAD. On failure the data of target is undefined.
+ */
 
-        break;
+#define GCM_CHUNK_MAX 0x40000000
 
-    case A256GCM:
+/*----------------------------------------------------------------------------*/
 
-        if (1 != EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, NULL, NULL))
-            goto error;
+static bool cipher_update(EVP_CIPHER_CTX *ctx, uint8_t *out, const uint8_t *in,
+                          size_t size) {
 
-        break;
-    };
+    int len = 0;
 
-    if (1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, iv_len, NULL))
-        goto error;
+    // EVP lengths are int, GCM outputs each byte of input immediately
 
-    if (1 != EVP_EncryptInit_ex(ctx, NULL, NULL, key, iv))
-        goto error;
+    while (size > 0) {
 
-    if (1 != EVP_EncryptUpdate(ctx, NULL, &len, aad, aad_size))
-        goto error;
+        int chunk = size > GCM_CHUNK_MAX ? GCM_CHUNK_MAX : (int)size;
 
-    if (1 !=
-        EVP_EncryptUpdate(ctx, ciphertext, &len, plaintext, plaintext_size))
-        goto error;
+        if (1 != EVP_CipherUpdate(ctx, out, &len, in, chunk))
+            return false;
 
-    ciphertext_len = len;
+        if (out)
+            out += len;
 
-    if (1 != EVP_EncryptFinal_ex(ctx, ciphertext + len, &len))
-        goto error;
+        in += chunk;
+        size -= chunk;
+    }
 
-    ciphertext_len += len;
+    return true;
+}
 
-    if (1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, tag_size, tag))
-        goto error;
+/*----------------------------------------------------------------------------*/
 
-    *ciphertext_size = ciphertext_len;
+static bool gcm_aad_sink(void *context, const uint8_t *data, size_t size) {
 
-    EVP_CIPHER_CTX_free(ctx);
-    return true;
-error:
-    if (ctx)
-        EVP_CIPHER_CTX_free(ctx);
-    return false;
+    return cipher_update((EVP_CIPHER_CTX *)context, NULL, data, size);
 }
 
 /*----------------------------------------------------------------------------*/
 
-static bool gcm_decrypt(dtn_bpsec_aes_variant aes, uint8_t *ciphertext,
-                        size_t ciphertext_size, uint8_t *aad, size_t aad_size,
-                        uint8_t *tag, size_t tag_size, uint8_t *key,
-                        uint8_t *iv, size_t iv_size, uint8_t *plaintext,
-                        size_t *plaintext_size) {
+static bool gcm_crypt(bool encrypt, dtn_bpsec_aes_variant aes,
+                      const uint8_t *key, const uint8_t *iv, size_t iv_size,
+                      dtn_bundle *bundle, dtn_cbor *bcb, dtn_cbor *target,
+                      uint8_t aad_flags, uint8_t *tag, size_t tag_size) {
 
-    EVP_CIPHER_CTX *ctx = NULL;
+    uint8_t final[EVP_MAX_BLOCK_LENGTH] = {0};
     int len = 0;
-    int plaintext_len = 0;
-    int ret = 0;
 
-    if (!(ctx = EVP_CIPHER_CTX_new()))
+    EVP_CIPHER_CTX *ctx = crypto_gcm(encrypt, aes, key, iv, iv_size);
+    if (!ctx)
         goto error;
 
-    switch (aes) {
-
-    case A128GCM:
-        if (!EVP_DecryptInit_ex(ctx, EVP_aes_128_gcm(), NULL, NULL, NULL))
-            goto error;
-        break;
-    case A256GCM:
-        if (!EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, NULL, NULL))
-            goto error;
-    }
-
-    if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, iv_size, NULL))
+    if (!security_input(bundle, bcb, target, aad_flags, false, gcm_aad_sink,
+                        ctx))
         goto error;
 
-    if (!EVP_DecryptInit_ex(ctx, NULL, NULL, key, iv))
-        goto error;
+    dtn_cbor *item = dtn_bundle_get_data(target);
 
-    if (!EVP_DecryptUpdate(ctx, NULL, &len, aad, aad_size))
-        goto error;
+    uint8_t *data = NULL;
+    size_t size = 0;
 
-    if (!EVP_DecryptUpdate(ctx, plaintext, &len, ciphertext, ciphertext_size))
+    if (!dtn_cbor_get_byte_string(item, &data, &size))
         goto error;
 
-    plaintext_len = len;
-
-    if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, tag_size, tag))
+    if (!cipher_update(ctx, data, data, size))
         goto error;
 
-    ret = EVP_DecryptFinal_ex(ctx, plaintext + len, &len);
+    dtn_cbor_touch(item);
 
-    if (ret > 0) {
+    if (!encrypt) {
 
-        EVP_CIPHER_CTX_free(ctx);
+        if (1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, tag_size, tag))
+            goto error;
+    }
 
-        plaintext_len += len;
-        *plaintext_size = plaintext_len;
+    if (1 != EVP_CipherFinal_ex(ctx, final, &len))
+        goto error;
 
-        return true;
+    if (encrypt) {
+
+        if (1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, tag_size, tag))
+            goto error;
     }
 
+    return true;
 error:
-    if (ctx)
-        EVP_CIPHER_CTX_free(ctx);
     return false;
 }
 
@@ -2660,39 +3499,23 @@ static bool add_new_item_to_bcb(dtn_bundle *bundle, dtn_bpsec_asb *asb,
     uint8_t *iv = NULL;
     size_t iv_len = 0;
 
-    uint8_t *plaintext = NULL;
-    size_t plaintext_size = 0;
-
     uint8_t *wrapped_key = NULL;
     size_t wrapped_key_size = 0;
 
     uint8_t contained_key[4096] = {0};
     size_t contained_key_size = 4096;
 
-    uint8_t ciphertext[4096] = {0};
-    size_t ciphertext_size = 4096;
-
-    uint8_t aad_input[4096] = {0};
-    size_t aad_input_size = 4096;
-
     uint8_t tag[16] = {0};
     size_t tag_size = 16;
 
     uint64_t aad_flags = 0;
 
-    dtn_cbor *data = dtn_bundle_get_data(target);
-
-    if (!dtn_cbor_get_byte_string(data, &plaintext, &plaintext_size))
-        goto error;
-
     dtn_bpsec_aes_variant aes = dtn_bpsec_get_aes_variant(asb);
     dtn_bpsec_get_iv(asb, &iv, &iv_len);
     dtn_bpsec_get_wrapped_key(asb, &wrapped_key, &wrapped_key_size);
     dtn_bpsec_get_integrity_flags_bcb(asb, &aad_flags);
 
-    if (!generate_hash_input(bundle, bcb, target, aad_flags,
-                             (uint8_t *)aad_input, &aad_input_size, false))
-        goto error;
+    const uint8_t *content_key = key->start;
 
     if (wrapped_key) {
 
@@ -2700,20 +3523,13 @@ static bool add_new_item_to_bcb(dtn_bundle *bundle, dtn_bpsec_asb *asb,
                                 &contained_key_size, key->start, key->length))
             goto error;
 
-        if (!gcm_encrypt(aes, plaintext, plaintext_size, (uint8_t *)aad_input,
-                         aad_input_size, (uint8_t *)contained_key,
-                         contained_key_size, iv, iv_len, ciphertext,
-                         &ciphertext_size, tag, tag_size))
-            goto error;
-
-    } else {
-
-        if (!gcm_encrypt(aes, plaintext, plaintext_size, (uint8_t *)aad_input,
-                         aad_input_size, key->start, key->length, iv, iv_len,
-                         ciphertext, &ciphertext_size, tag, tag_size))
-            goto error;
+        content_key = contained_key;
     }
 
+    if (!gcm_crypt(true, aes, content_key, iv, iv_len, bundle, bcb, target,
+                   aad_flags, tag, tag_size))
+        goto error;
+
     if (!dtn_bpsec_add_target(asb, dtn_bundle_get_number(target)))
         goto error;
 
@@ -2724,9 +3540,6 @@ static bool add_new_item_to_bcb(dtn_bundle *bundle, dtn_bpsec_asb *asb,
     if (!dtn_bundle_set_data(bcb, result))
         goto error;
 
-    if (!dtn_cbor_set_byte_string(data, ciphertext, ciphertext_size))
-        goto error;
-
     asb = dtn_bpsec_asb_free(asb);
     return true;
 error:
@@ -2748,18 +3561,9 @@ bool dtn_bundle_bcb_protect(dtn_bundle *self, dtn_cbor *bcb, dtn_cbor *target,
     if (!self || !key || !bcb || !target)
         goto error;
 
-    uint8_t aad_input[4096] = {0};
-    size_t aad_input_size = 4096;
-
-    uint8_t ciphertext[4096] = {0};
-    size_t ciphertext_size = 4096;
-
     uint8_t tag[16] = {0};
     size_t tag_size = 16;
 
-    uint8_t *plaintext = NULL;
-    size_t plaintext_size = 0;
-
     uint8_t wrapped[4096] = {0};
     size_t wrapped_size = 4096;
 
@@ -2776,35 +3580,15 @@ bool dtn_bundle_bcb_protect(dtn_bundle *self, dtn_cbor *bcb, dtn_cbor *target,
             goto error;
     }
 
-    dtn_cbor *data = dtn_bundle_get_data(target);
-
-    if (!dtn_cbor_get_byte_string(data, &plaintext, &plaintext_size))
-        goto error;
-
-    if (!generate_hash_input(self, bcb, target, aad_flags, aad_input,
-                             &aad_input_size, false))
-        goto error;
-
     iv = generate_iv(12);
     if (!iv)
         goto error;
 
-    if (new_key) {
-
-        if (!gcm_encrypt(aes, plaintext, plaintext_size, aad_input,
-                         aad_input_size, new_key->start, new_key->length,
-                         iv->start, iv->length, ciphertext, &ciphertext_size,
-                         tag, tag_size))
-            goto error;
-
-    } else {
+    const uint8_t *content_key = new_key ? new_key->start : key->start;
 
-        if (!gcm_encrypt(aes, plaintext, plaintext_size, aad_input,
-                         aad_input_size, key->start, key->length, iv->start,
-                         iv->length, ciphertext, &ciphertext_size, tag,
-                         tag_size))
-            goto error;
-    }
+    if (!gcm_crypt(true, aes, content_key, iv->start, iv->length, self, bcb,
+                   target, aad_flags, tag, tag_size))
+        goto error;
 
     asb = dtn_bpsec_asb_create();
     if (!dtn_bpsec_add_target(asb, dtn_bundle_get_number(target)))
@@ -2834,9 +3618,6 @@ bool dtn_bundle_bcb_protect(dtn_bundle *self, dtn_cbor *bcb, dtn_cbor *target,
     if (!dtn_bundle_set_data(bcb, result))
         goto error;
 
-    if (!dtn_cbor_set_byte_string(data, ciphertext, ciphertext_size))
-        goto error;
-
     new_key = dtn_buffer_free(new_key);
     iv = dtn_buffer_free(iv);
     return true;
@@ -2888,12 +3669,10 @@ static bool bcb_unprotect_target(void *item, void *data) {
     uint8_t key_buffer[1024] = {0};
     size_t key_size = 1024;
 
-    uint8_t aad_input[4096] = {0};
-    size_t aad_input_size = 4096;
-
     uint8_t *key = key_buffer;
 
-    dtn_buffer *master_key = NULL;
+    dtn_key *handle = NULL;
+    const dtn_buffer *master_key = NULL;
 
     uint8_t *result = NULL;
     size_t result_size = 0;
@@ -2901,12 +3680,6 @@ static bool bcb_unprotect_target(void *item, void *data) {
     char source[4096] = {0};
     size_t source_size = 4096;
 
-    uint8_t *ciphertext = NULL;
-    size_t ciphertext_size = 0;
-
-    uint8_t plaintext[4096] = {0};
-    size_t plaintext_size = 4096;
-
     dtn_cbor *target_id = (dtn_cbor *)item;
     struct container *container = (struct container *)data;
 
@@ -2915,8 +3688,7 @@ static bool bcb_unprotect_target(void *item, void *data) {
     if (!target)
         goto error;
 
-    dtn_cbor *target_data = dtn_bundle_get_data(target);
-    if (!dtn_cbor_get_byte_string(target_data, &ciphertext, &ciphertext_size))
+    if (!dtn_cbor_is_string(dtn_bundle_get_data(target)))
         goto error;
 
     container->count++;
@@ -2937,7 +3709,8 @@ static bool bcb_unprotect_target(void *item, void *data) {
         goto error;
     }
 
-    master_key = dtn_key_store_get(container->store, source);
+    handle = dtn_key_store_acquire(container->store, source);
+    master_key = dtn_key_get_buffer(handle);
     if (!master_key) {
         dtn_log_error("no masterkey found for %s", source);
         goto error;
@@ -2959,30 +3732,20 @@ static bool bcb_unprotect_target(void *item, void *data) {
         key = master_key->start, key_size = master_key->length;
     }
 
-    if (!generate_hash_input(container->self, container->bib, target,
-                             container->integrity_flags, aad_input,
-                             &aad_input_size, false))
-        goto error;
-
-    if (!gcm_decrypt(container->aes, ciphertext, ciphertext_size, aad_input,
-                     aad_input_size, result, result_size, key, container->iv,
-                     container->iv_size, plaintext, &plaintext_size))
-        goto error;
-
-    fprintf(stderr, "PLAINTEXT %s\n", plaintext);
-
-    if (!dtn_cbor_set_byte_string(target_data, plaintext, plaintext_size))
+    if (!gcm_crypt(false, container->aes, key, container->iv,
+                   container->iv_size, container->self, container->bib,
+                   target, container->integrity_flags, result, result_size))
         goto error;
 
     uri = dtn_dtn_uri_free(uri);
     ipn = dtn_ipn_free(ipn);
-    master_key = dtn_buffer_free(master_key);
+    handle = dtn_key_release(handle);
 
     return true;
 error:
     uri = dtn_dtn_uri_free(uri);
     ipn = dtn_ipn_free(ipn);
-    master_key = dtn_buffer_free(master_key);
+    handle = dtn_key_release(handle);
     return false;
 }
 
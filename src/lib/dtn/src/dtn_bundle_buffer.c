@@ -30,11 +30,31 @@
 #include "../include/dtn_bundle_buffer.h"
 
 #include <dtn_base/dtn_dict.h>
+#include <dtn_base/dtn_hash_functions.h>
 #include <dtn_base/dtn_linked_list.h>
+#include <dtn_base/dtn_ringbuffer.h>
 #include <dtn_base/dtn_string.h>
 #include <dtn_base/dtn_thread_lock.h>
+#include <dtn_base/dtn_thread_pool.h>
 #include <dtn_base/dtn_time.h>
 
+#include <stdatomic.h>
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ *      Reassemblies and delivery history are sharded by a hash of the
+ *      bundle key, each shard is guarded by its own lock.
+ */
+typedef struct Shard {
+
+    dtn_thread_lock lock;
+
+    dtn_dict *data;
+    dtn_duplicate_filter *history;
+
+} Shard;
+
 /*---------------------------------------------------------------------------*/
 
 struct dtn_bundle_buffer {
@@ -43,44 +63,96 @@ struct dtn_bundle_buffer {
 
     struct {
 
-        dtn_thread_lock lock;
-        dtn_dict *dict;
+        size_t count;
+        size_t next; // next shard to cleanup
+        Shard *items;
+
+    } shards;
+
+    struct {
+
+        uint32_t cleanup;
+        uint64_t interval_usecs;
 
-    } data;
+    } timer;
 
     struct {
 
+        dtn_thread_pool *pool;
         dtn_thread_lock lock;
-        dtn_dict *dict;
+        dtn_ringbuffer *queue;
+
+        // queued or in process, never more than queue capacity
+        atomic_uint_fast64_t pending;
 
-    } history;
+    } workers;
 
     struct {
 
-        uint32_t cleanup;
+        // total data length of all pending reassemblies
+        atomic_uint_fast64_t bytes;
+        atomic_uint_fast64_t rejected;
 
-    } timer;
+    } pending;
 };
 
 /*---------------------------------------------------------------------------*/
 
+typedef struct Range {
+
+    uint64_t start;
+    uint64_t end; // exclusive
+
+} Range;
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ *      Reassembly of one bundle. Fragment payloads are copied to their
+ *      offset within payload, received bytes are kept as sorted disjoint
+ *      ranges, adjacent or overlapping ranges are merged on insert.
+ *      The bundle is complete once received equals total.
+ */
 typedef struct Data {
 
     uint64_t created;
-    dtn_list *queue;
+
+    uint64_t total;
+    uint64_t received;
+    uint8_t *payload;
+
+    // budget to release total to at free, if any
+    atomic_uint_fast64_t *pending;
+
+    struct {
+
+        Range *items;
+        size_t count;
+        size_t size;
+
+    } ranges;
 
 } Data;
 
 /*---------------------------------------------------------------------------*/
 
-static Data *data_create() {
+static Data *data_create(uint64_t total) {
 
     Data *self = calloc(1, sizeof(Data));
+    if (!self)
+        goto error;
+
     self->created = dtn_time_get_current_time_usecs();
-    self->queue = dtn_linked_list_create(
-        (dtn_list_config){.item.free = dtn_bundle_free_void});
+    self->total = total;
+
+    self->payload = calloc(1, total);
+    if (!self->payload)
+        goto error;
 
     return self;
+error:
+    dtn_data_pointer_free(self);
+    return NULL;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -91,13 +163,114 @@ static void *data_free(void *self) {
         return NULL;
 
     Data *data = (Data *)self;
-    data->queue = dtn_list_free(data->queue);
+
+    if (data->pending)
+        atomic_fetch_sub(data->pending, data->total);
+
+    data->payload = dtn_data_pointer_free(data->payload);
+    data->ranges.items = dtn_data_pointer_free(data->ranges.items);
     data = dtn_data_pointer_free(data);
     return NULL;
 }
 
 /*---------------------------------------------------------------------------*/
 
+static bool data_is_complete(const Data *self) {
+
+    return self->received == self->total;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static size_t data_first_range_ending_at_or_after(const Data *self,
+                                                  uint64_t start) {
+
+    size_t lo = 0;
+    size_t hi = self->ranges.count;
+
+    while (lo < hi) {
+
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (self->ranges.items[mid].end < start) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ *      Add range [start, end) to the received ranges.
+ *
+ *      @returns number of bytes not received before
+ */
+static uint64_t data_add_range(Data *self, uint64_t start, uint64_t end) {
+
+    /* ranges touching or overlapping [start, end) are [lo, hi) */
+
+    size_t lo = data_first_range_ending_at_or_after(self, start);
+    size_t hi = lo;
+
+    uint64_t covered = 0;
+
+    while ((hi < self->ranges.count) &&
+           (self->ranges.items[hi].start <= end)) {
+
+        Range *r = &self->ranges.items[hi];
+
+        if (r->start < start)
+            start = r->start;
+
+        if (r->end > end)
+            end = r->end;
+
+        covered += r->end - r->start;
+        hi++;
+    }
+
+    if (lo == hi) {
+
+        if (self->ranges.count == self->ranges.size) {
+
+            size_t size = self->ranges.size ? 2 * self->ranges.size : 4;
+
+            Range *items = realloc(self->ranges.items, size * sizeof(Range));
+
+            if (!items)
+                return 0;
+
+            self->ranges.items = items;
+            self->ranges.size = size;
+        }
+
+        memmove(self->ranges.items + lo + 1, self->ranges.items + lo,
+                (self->ranges.count - lo) * sizeof(Range));
+
+        self->ranges.count++;
+
+    } else if (hi - lo > 1) {
+
+        memmove(self->ranges.items + lo + 1, self->ranges.items + hi,
+                (self->ranges.count - hi) * sizeof(Range));
+
+        self->ranges.count -= hi - lo - 1;
+    }
+
+    self->ranges.items[lo] = (Range){.start = start, .end = end};
+
+    uint64_t added = (end - start) - covered;
+    self->received += added;
+
+    return added;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static bool init_config(dtn_bundle_buffer_config *config) {
 
     if (!config || !config->loop)
@@ -115,6 +288,23 @@ static bool init_config(dtn_bundle_buffer_config *config) {
     if (0 == config->limits.history_secs)
         config->limits.history_secs = 24 * 60 * 60; // 24h
 
+    if (0 == config->limits.max_payload_bytes)
+        config->limits.max_payload_bytes =
+            DTN_BUNDLE_BUFFER_MAX_PAYLOAD_DEFAULT;
+
+    if (0 == config->limits.max_pending_bytes)
+        config->limits.max_pending_bytes =
+            DTN_BUNDLE_BUFFER_MAX_PENDING_DEFAULT;
+
+    if (0 == config->limits.shards)
+        config->limits.shards = DTN_BUNDLE_BUFFER_SHARDS_DEFAULT;
+
+    if (0 == config->history.memory_bytes)
+        config->history.memory_bytes = DTN_BUNDLE_BUFFER_HISTORY_MEMORY_DEFAULT;
+
+    if (0 == config->limits.queue_size)
+        config->limits.queue_size = DTN_BUNDLE_BUFFER_QUEUE_DEFAULT;
+
     return true;
 error:
     return false;
@@ -159,78 +349,200 @@ static bool drop_expired_keys(void *item, void *data) {
 
 /*---------------------------------------------------------------------------*/
 
-static bool search_expired_keys_history(const void *key, void *val,
-                                        void *data) {
+static bool run_cleanup(uint32_t id, void *data) {
 
-    if (!key)
-        return true;
+    UNUSED(id);
+    dtn_bundle_buffer *self = (dtn_bundle_buffer *)data;
 
-    struct container *container = (struct container *)data;
+    // one shard per run, each shard is visited once per cleanup interval
 
-    uint64_t created = (uintptr_t)val;
+    Shard *shard = &self->shards.items[self->shards.next];
+    self->shards.next = (self->shards.next + 1) % self->shards.count;
 
-    if (container->now - created >
-        1000000 * container->self->config.limits.history_secs) {
+    if (!dtn_thread_lock_try_lock(&shard->lock))
+        goto reschedule;
 
-        dtn_list_push(container->list, (void *)key);
+    struct container container = (struct container){
+
+        .now = dtn_time_get_current_time_usecs(),
+        .self = self,
+        .list = dtn_linked_list_create((dtn_list_config){0})};
+
+    dtn_dict_for_each(shard->data, &container, search_expired_keys);
+    dtn_list_for_each(container.list, shard->data, drop_expired_keys);
+
+    container.list = dtn_list_free(container.list);
+
+    dtn_duplicate_filter_expire(shard->history, container.now);
+
+    if (!dtn_thread_lock_unlock(&shard->lock)) {
+        dtn_log_error("failed to unlock shard");
     }
 
+reschedule:
+
+    self->timer.cleanup = dtn_event_loop_timer_set(
+        self->config.loop, self->timer.interval_usecs, self, run_cleanup);
+
     return true;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static bool run_cleanup(uint32_t id, void *data) {
+static bool shard_init(Shard *shard, const dtn_bundle_buffer_config *config) {
 
-    UNUSED(id);
-    dtn_bundle_buffer *self = (dtn_bundle_buffer *)data;
+    dtn_dict_config d_config = dtn_dict_string_key_config(255);
+    d_config.type = DTN_DICT_FLAT;
+    d_config.value.data_function.free = data_free;
 
-    if (!dtn_thread_lock_try_lock(&self->data.lock))
-        goto reschedule;
+    shard->data = dtn_dict_create(d_config);
+    if (!shard->data)
+        goto error;
 
-    struct container container = (struct container){
+    // the history memory is split over all shards
 
-        .now = dtn_time_get_current_time_usecs(),
-        .self = self,
-        .list = dtn_linked_list_create((dtn_list_config){0})};
+    shard->history = dtn_duplicate_filter_create((dtn_duplicate_filter_config){
 
-    dtn_dict_for_each(self->data.dict, &container, search_expired_keys);
+        .type = config->history.type,
+        .history_usecs = 1000000 * config->limits.history_secs,
+        .memory_bytes = config->history.memory_bytes / config->limits.shards,
+        .capacity = config->history.capacity / config->limits.shards});
 
-    dtn_list_for_each(container.list, self->data.dict, drop_expired_keys);
+    if (!shard->history)
+        goto error;
 
-    container.list = dtn_list_free(container.list);
+    if (!dtn_thread_lock_init(&shard->lock,
+                              config->limits.threadlock_timeout_usecs))
+        goto error;
 
-    if (!dtn_thread_lock_unlock(&self->data.lock)) {
-        dtn_log_error("failed to unlock data");
-    }
+    return true;
+error:
+    return false;
+}
 
-    if (!dtn_thread_lock_try_lock(&self->history.lock))
-        goto reschedule;
+/*---------------------------------------------------------------------------*/
 
-    container = (struct container){
+static void shard_clear(Shard *shard) {
 
-        .now = dtn_time_get_current_time_usecs(),
-        .self = self,
-        .list = dtn_linked_list_create((dtn_list_config){0})};
+    dtn_thread_lock_clear(&shard->lock);
+    shard->data = dtn_dict_free(shard->data);
+    shard->history = dtn_duplicate_filter_free(shard->history);
+    return;
+}
 
-    dtn_dict_for_each(self->history.dict, &container,
-                      search_expired_keys_history);
+/*---------------------------------------------------------------------------*/
 
-    dtn_list_for_each(container.list, self->history.dict, drop_expired_keys);
+static Shard *get_shard(dtn_bundle_buffer *self, const char *key) {
 
-    container.list = dtn_list_free(container.list);
+    // use the high bits, the low bits of the same hash index the dicts
+    uint64_t hash = dtn_hash_c_string(key) >> 32;
+    return &self->shards.items[hash % self->shards.count];
+}
 
-    if (!dtn_thread_lock_unlock(&self->history.lock)) {
-        dtn_log_error("failed to unlock data");
-    }
+/*---------------------------------------------------------------------------*/
 
-reschedule:
+static bool process_bundle(dtn_bundle_buffer *self, dtn_bundle *bundle);
 
-    self->timer.cleanup = dtn_event_loop_timer_set(
-        self->config.loop, self->config.limits.buffer_time_cleanup_usecs, self,
-        run_cleanup);
+/*---------------------------------------------------------------------------*/
+
+static void free_queued(void *arg, void *element) {
+
+    UNUSED(arg);
+    dtn_bundle_free(element);
+    return;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool process_queued(void *userdata, void *element) {
+
+    dtn_bundle_buffer *self = (dtn_bundle_buffer *)userdata;
+
+    bool result = process_bundle(self, element);
+    atomic_fetch_sub(&self->workers.pending, 1);
+    return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool workers_start(dtn_bundle_buffer *self) {
+
+    uint64_t timeout_usecs = self->config.limits.threadlock_timeout_usecs;
+
+    if (!dtn_thread_lock_init(&self->workers.lock, timeout_usecs))
+        goto error;
+
+    self->workers.queue = dtn_ringbuffer_create(
+        self->config.limits.queue_size, free_queued, NULL);
+
+    if (!self->workers.queue)
+        goto error;
+
+    self->workers.pool = dtn_thread_pool_create(
+        (dtn_thread_queue){.lock = &self->workers.lock,
+                           .queue = self->workers.queue},
+        process_queued,
+        (dtn_thread_pool_config){.num_threads = self->config.limits.workers,
+                                 .userdata = self});
+
+    if (!self->workers.pool)
+        goto error;
+
+    if (!self->workers.pool->start(self->workers.pool))
+        goto error;
 
     return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void workers_stop(dtn_bundle_buffer *self) {
+
+    if (self->workers.pool)
+        self->workers.pool = self->workers.pool->free(self->workers.pool);
+
+    // bundles not processed yet are dropped
+    self->workers.queue = dtn_ringbuffer_free(self->workers.queue);
+    dtn_thread_lock_clear(&self->workers.lock);
+    return;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ *      Queue bundle for the workers.
+ *
+ *      @returns false if the queue is full, bundle is not consumed then
+ */
+static bool queue_bundle(dtn_bundle_buffer *self, dtn_bundle *bundle) {
+
+    bool queued = false;
+
+    if (atomic_fetch_add(&self->workers.pending, 1) >=
+        self->config.limits.queue_size)
+        goto done;
+
+    if (!dtn_thread_lock_try_lock(&self->workers.lock))
+        goto done;
+
+    queued = self->workers.queue->insert(self->workers.queue, bundle);
+
+    if (queued && !dtn_thread_lock_notify(&self->workers.lock)) {
+        dtn_log_error("failed to notify workers");
+    }
+
+    if (!dtn_thread_lock_unlock(&self->workers.lock)) {
+        dtn_log_error("failed to unlock worker queue");
+    }
+
+done:
+
+    if (!queued)
+        atomic_fetch_sub(&self->workers.pending, 1);
+
+    return queued;
 }
 
 /*
@@ -254,31 +566,29 @@ dtn_bundle_buffer *dtn_bundle_buffer_create(dtn_bundle_buffer_config config) {
 
     self->config = config;
 
-    dtn_dict_config d_config = dtn_dict_string_key_config(255);
-    d_config.value.data_function.free = data_free;
-
-    self->data.dict = dtn_dict_create(d_config);
-    if (!self->data.dict)
+    self->shards.items = calloc(config.limits.shards, sizeof(Shard));
+    if (!self->shards.items)
         goto error;
 
-    d_config = dtn_dict_string_key_config(255);
-    d_config.value.data_function.free = NULL;
+    self->shards.count = config.limits.shards;
 
-    self->history.dict = dtn_dict_create(d_config);
-    if (!self->history.dict)
-        goto error;
+    for (size_t i = 0; i < self->shards.count; i++) {
 
-    if (!dtn_thread_lock_init(&self->data.lock,
-                              config.limits.threadlock_timeout_usecs))
-        goto error;
+        if (!shard_init(&self->shards.items[i], &self->config))
+            goto error;
+    }
 
-    if (!dtn_thread_lock_init(&self->history.lock,
-                              config.limits.threadlock_timeout_usecs))
-        goto error;
+    self->timer.interval_usecs =
+        config.limits.buffer_time_cleanup_usecs / self->shards.count;
+
+    if (0 == self->timer.interval_usecs)
+        self->timer.interval_usecs = 1;
 
     self->timer.cleanup = dtn_event_loop_timer_set(
-        self->config.loop, self->config.limits.buffer_time_cleanup_usecs, self,
-        run_cleanup);
+        self->config.loop, self->timer.interval_usecs, self, run_cleanup);
+
+    if ((0 < config.limits.workers) && !workers_start(self))
+        goto error;
 
     return self;
 error:
@@ -293,27 +603,40 @@ dtn_bundle_buffer *dtn_bundle_buffer_free(dtn_bundle_buffer *self) {
     if (!self)
         return self;
 
+    // workers use the shards, stop them first
+    if (0 < self->config.limits.workers)
+        workers_stop(self);
+
     if (DTN_TIMER_INVALID != self->timer.cleanup) {
 
         dtn_event_loop_timer_unset(self->config.loop, self->timer.cleanup,
                                    NULL);
     }
 
-    dtn_thread_lock_clear(&self->data.lock);
-    self->data.dict = dtn_dict_free(self->data.dict);
+    for (size_t i = 0; i < self->shards.count; i++) {
+        shard_clear(&self->shards.items[i]);
+    }
+
+    self->shards.items = dtn_data_pointer_free(self->shards.items);
     self = dtn_data_pointer_free(self);
     return NULL;
 }
 
 /*----------------------------------------------------------------------------*/
 
-static bool unfragmented_bundle(dtn_bundle_buffer *self, dtn_bundle *bundle) {
+static dtn_key_store *get_keys(dtn_bundle_buffer *self) {
 
-    const char *dest = dtn_bundle_primary_get_destination(bundle);
-    const char *source = dtn_bundle_primary_get_source(bundle);
+    if (!self->config.callbacks.get_keys)
+        return NULL;
+
+    return self->config.callbacks.get_keys(self->config.callbacks.userdata);
+}
+
+/*----------------------------------------------------------------------------*/
 
-    dtn_key_store *keys =
-        self->config.callbacks.get_keys(self->config.callbacks.userdata);
+static bool unprotect_bundle(dtn_bundle_buffer *self, dtn_bundle *bundle) {
+
+    dtn_key_store *keys = get_keys(self);
 
     if (dtn_bundle_is_bcb_protected(bundle)) {
 
@@ -331,16 +654,37 @@ static bool unfragmented_bundle(dtn_bundle_buffer *self, dtn_bundle *bundle) {
         }
     }
 
-    dtn_cbor *payload = dtn_bundle_get_block(bundle, 1);
-    if (!payload)
-        goto error;
+    return true;
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool get_payload(dtn_bundle *bundle, uint8_t **payload, size_t *size) {
 
-    dtn_cbor *data = dtn_bundle_get_data(payload);
+    dtn_cbor *block = dtn_bundle_get_block(bundle, 1);
+    if (!block)
+        return false;
+
+    return dtn_cbor_get_byte_string(dtn_bundle_get_data(block), payload,
+                                    size);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool unfragmented_bundle(dtn_bundle_buffer *self, dtn_bundle *bundle) {
+
+    const char *dest = dtn_bundle_primary_get_destination(bundle);
+    const char *source = dtn_bundle_primary_get_source(bundle);
+
+    if (!unprotect_bundle(self, bundle))
+        goto error;
 
     uint8_t *payload_data = NULL;
     size_t size = 0;
 
-    if (!dtn_cbor_get_byte_string(data, &payload_data, &size))
+    if (!get_payload(bundle, &payload_data, &size))
         goto error;
 
     if (self->config.callbacks.payload)
@@ -357,302 +701,283 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
-struct container1 {
+/**
+ *      Reserve bytes of the pending budget.
+ *
+ *      @returns false if the budget would be exceeded
+ */
+static bool pending_reserve(dtn_bundle_buffer *self, uint64_t bytes) {
 
-    dtn_bundle_buffer *self;
-    dtn_buffer *buffer;
-};
+    uint64_t max = self->config.limits.max_pending_bytes;
+    uint64_t current = atomic_load(&self->pending.bytes);
 
-/*----------------------------------------------------------------------------*/
+    do {
 
-static bool add_payload_to_buffer(void *val, void *data) {
+        if ((bytes > max) || (current > max - bytes))
+            return false;
 
-    struct container1 *container = (struct container1 *)data;
+    } while (!atomic_compare_exchange_weak(&self->pending.bytes, &current,
+                                           current + bytes));
 
-    dtn_buffer *buffer = container->buffer;
-    dtn_bundle *bundle = (dtn_bundle *)val;
+    return true;
+}
 
-    dtn_key_store *keys = container->self->config.callbacks.get_keys(
-        container->self->config.callbacks.userdata);
+/*----------------------------------------------------------------------------*/
 
-    if (dtn_bundle_is_bcb_protected(bundle)) {
+static Data *get_data(dtn_bundle_buffer *self, Shard *shard, const char *key,
+                      uint64_t total) {
 
-        if (!dtn_bundle_bcb_unprotect(bundle, keys)) {
-            dtn_log_error("BCB unprotect failed.");
-            goto error;
-        }
-    }
+    char *copy = NULL;
 
-    if (dtn_bundle_is_bib_protected(bundle)) {
+    Data *data = dtn_dict_get(shard->data, key);
+    if (data)
+        return data;
 
-        if (!dtn_bundle_bib_verify(bundle, keys)) {
-            dtn_log_error("BIB verify failed.");
-            goto error;
-        }
-    }
+    if (!pending_reserve(self, total)) {
 
-    dtn_cbor *payload = dtn_bundle_get_block(bundle, 1);
-    dtn_cbor *pdata = dtn_bundle_get_data(payload);
+        atomic_fetch_add(&self->pending.rejected, 1);
+        dtn_log_error("pending reassemblies exceed %" PRIu64
+                      " bytes, rejected %s",
+                      self->config.limits.max_pending_bytes, key);
+        return NULL;
+    }
 
-    uint8_t *start = NULL;
-    size_t length = 0;
+    data = data_create(total);
 
-    if (!dtn_cbor_get_byte_string(pdata, &start, &length))
-        goto error;
-    if (!dtn_buffer_push(buffer, start, length))
+    if (!data) {
+        atomic_fetch_sub(&self->pending.bytes, total);
         goto error;
+    }
 
-    return true;
-error:
-    return false;
-}
-
-/*----------------------------------------------------------------------------*/
-
-static dtn_buffer *get_output_buffer(dtn_bundle_buffer *self, dtn_list *queue) {
-
-    dtn_buffer *buffer = dtn_buffer_create(2048);
+    data->pending = &self->pending.bytes;
+    copy = dtn_string_dup(key);
 
-    struct container1 container =
-        (struct container1){.self = self, .buffer = buffer};
+    if (!copy)
+        goto error;
 
-    if (!dtn_list_for_each(queue, &container, add_payload_to_buffer))
+    if (!dtn_dict_set(shard->data, copy, data, NULL))
         goto error;
 
-    return buffer;
+    return data;
 error:
-    dtn_buffer_free(buffer);
+    data_free(data);
+    dtn_data_pointer_free(copy);
     return NULL;
 }
 
 /*----------------------------------------------------------------------------*/
 
-static bool bundle_history_contained(dtn_bundle_buffer *self,
-                                     const char *source, uint64_t timestamp,
-                                     uint64_t sequence) {
+static bool process_bundle(dtn_bundle_buffer *self, dtn_bundle *bundle) {
 
-    char buffer[2048];
-    ssize_t size = 2048;
-    memset(buffer, 0, size);
+    char key[2048] = {0};
+    Data *complete = NULL;
 
-    snprintf(buffer, size, "%s|%" PRIu64 "|%" PRIu64, source, timestamp,
-             sequence);
+    uint64_t flags = dtn_bundle_primary_get_flags(bundle);
+    if (!(flags & 0x01))
+        return unfragmented_bundle(self, bundle);
 
-    if (!dtn_thread_lock_try_lock(&self->history.lock))
-        goto error;
+    const char *source = dtn_bundle_primary_get_source(bundle);
+    const char *destination = dtn_bundle_primary_get_destination(bundle);
 
-    bool result = dtn_dict_is_set(self->history.dict, buffer);
+    uint64_t timestamp = 0;
+    uint64_t sequence = 0;
 
-    if (!result) {
+    if (!dtn_bundle_primary_get_timestamp(bundle, &timestamp, &sequence))
+        goto error;
 
-        uint64_t now = dtn_time_get_current_time_usecs();
-        char *key = dtn_string_dup(buffer);
+    // fragments of a bundle share source, timestamp and sequence
 
-        if (!dtn_dict_set(self->history.dict, key, (void *)(uintptr_t)now,
-                          NULL)) {
-            key = dtn_data_pointer_free(key);
-        }
-    }
+    ssize_t bytes = snprintf(key, sizeof(key), "%s|%" PRIu64 "|%" PRIu64,
+                             source, timestamp, sequence);
 
-    if (!dtn_thread_lock_unlock(&self->history.lock)) {
-        dtn_log_error("failed to unlock history");
-    }
+    if ((bytes < 0) || ((size_t)bytes >= sizeof(key)))
+        goto error;
 
-    return result;
-error:
-    return false;
-}
+    uint64_t offset = dtn_bundle_primary_get_fragment_offset(bundle);
+    uint64_t total = dtn_bundle_primary_get_totel_data_length(bundle);
 
-/*----------------------------------------------------------------------------*/
+    if (!unprotect_bundle(self, bundle))
+        goto error;
 
-bool dtn_bundle_buffer_push(dtn_bundle_buffer *self, dtn_bundle *bundle) {
+    uint8_t *payload = NULL;
+    size_t size = 0;
 
-    char buffer[2048];
-    ssize_t size = 2048;
-    memset(buffer, 0, size);
+    if (!get_payload(bundle, &payload, &size))
+        goto error;
 
-    dtn_buffer *out = NULL;
+    if ((0 == total) || (total > self->config.limits.max_payload_bytes) ||
+        (offset > total) || (size > total - offset)) {
 
-    if (!self || !bundle)
+        dtn_log_error("invalid fragment of %s offset %" PRIu64
+                      " size %zu total %" PRIu64,
+                      key, offset, size, total);
         goto error;
+    }
 
-    uint64_t flags = dtn_bundle_primary_get_flags(bundle);
-    if (!flags & 0x01)
-        return unfragmented_bundle(self, bundle);
+    Shard *shard = get_shard(self, key);
 
-    const char *source = dtn_bundle_primary_get_source(bundle);
-    const char *destination = dtn_bundle_primary_get_destination(bundle);
+    if (!dtn_thread_lock_try_lock(&shard->lock))
+        goto error;
 
-    uint64_t timestamp = 0;
-    uint64_t sequence = 0;
+    uint64_t now = dtn_time_get_current_time_usecs();
 
-    if (!dtn_bundle_primary_get_timestamp(bundle, &timestamp, &sequence))
-        goto error;
+    // late fragment of a bundle already delivered
+    if (dtn_duplicate_filter_contains(shard->history, key, bytes, now))
+        goto unlock;
 
-    if (bundle_history_contained(self, source, timestamp, sequence))
-        goto drop;
+    Data *data = get_data(self, shard, key, total);
 
-    ssize_t bytes = snprintf(buffer, size, "%s|%" PRIu64, source, timestamp);
-    if (bytes >= size)
-        goto error;
-    if (bytes < 0)
-        goto error;
+    if (!data || (data->total != total)) {
 
-    uint64_t size_payload = 0;
-    uint64_t size_all = dtn_bundle_primary_get_totel_data_length(bundle);
+        if (!dtn_thread_lock_unlock(&shard->lock)) {
+            dtn_log_error("failed to unlock shard");
+        }
 
-    if (!dtn_thread_lock_try_lock(&self->data.lock))
         goto error;
+    }
 
-    Data *data = dtn_dict_get(self->data.dict, buffer);
-    if (!data) {
+    // copy what was not received, duplicates are dropped
 
-        data = data_create();
-        if (!data)
-            goto error;
+    if ((0 < size) && (0 < data_add_range(data, offset, offset + size)))
+        memcpy(data->payload + offset, payload, size);
 
-        char *key = dtn_string_dup(buffer);
-        if (!key) {
-            data = data_free(data);
-            goto error;
-        }
+    if (data_is_complete(data)) {
 
-        if (!dtn_dict_set(self->data.dict, key, data, NULL)) {
-            data = data_free(data);
-            key = dtn_data_pointer_free(key);
-            goto error;
-        }
+        complete = dtn_dict_remove(shard->data, key);
+        dtn_duplicate_filter_add(shard->history, key, bytes, now);
+    }
 
-        if (!dtn_list_push(data->queue, bundle))
-            goto error;
+unlock:
 
-        goto done;
+    if (!dtn_thread_lock_unlock(&shard->lock)) {
+        dtn_log_error("failed to unlock shard");
     }
 
-    void *item = NULL;
+    if (complete) {
 
-    dtn_bundle *current = NULL;
-    dtn_cbor *payload_data = NULL;
-    dtn_cbor *payload = NULL;
+        if (self->config.callbacks.payload) {
 
-    uint8_t *buf = NULL;
-    size_t buf_size = 0;
+            self->config.callbacks.payload(self->config.callbacks.userdata,
+                                           complete->payload, complete->total,
+                                           source, destination);
+        }
 
-    uint64_t current_time;
-    uint64_t current_sequence;
+        complete = data_free(complete);
+    }
 
-    void *next = data->queue->iter(data->queue);
-    while (next) {
+    dtn_bundle_free(bundle);
+    return true;
+error:
+    dtn_bundle_free(bundle);
+    return false;
+}
 
-        current = NULL;
+/*----------------------------------------------------------------------------*/
 
-        next = data->queue->next(data->queue, next, (void **)&item);
+bool dtn_bundle_buffer_push(dtn_bundle_buffer *self, dtn_bundle *bundle) {
 
-        current = (dtn_bundle *)item;
+    if (!self || !bundle)
+        goto error;
 
-        if (!dtn_bundle_primary_get_timestamp(current, &current_time,
-                                              &current_sequence))
-            goto error;
+    if (self->workers.pool && queue_bundle(self, bundle))
+        return true;
 
-        payload = dtn_bundle_get_block(current, 1);
-        if (!payload)
-            goto error;
+    return process_bundle(self, bundle);
+error:
+    dtn_bundle_free(bundle);
+    return false;
+}
 
-        payload_data = dtn_bundle_get_data(payload);
+/*----------------------------------------------------------------------------*/
 
-        if (!dtn_cbor_get_byte_string(payload_data, &buf, &buf_size))
-            goto error;
+bool dtn_bundle_buffer_clear(dtn_bundle_buffer *self) {
 
-        size_payload += buf_size;
+    if (!self)
+        goto error;
 
-        if (current_sequence >= sequence)
-            goto insert_before_current;
-    }
+    bool result = true;
 
-    if (!next) {
+    for (size_t i = 0; i < self->shards.count; i++) {
 
-        dtn_list_push(data->queue, bundle);
+        Shard *shard = &self->shards.items[i];
 
-    } else {
+        if (!dtn_thread_lock_try_lock(&shard->lock)) {
+            result = false;
+            continue;
+        }
 
-    insert_before_current:
+        if (!dtn_dict_clear(shard->data))
+            result = false;
 
-        size_t pos = dtn_list_get_pos(data->queue, current);
-        dtn_list_insert(data->queue, pos, bundle);
+        if (!dtn_thread_lock_unlock(&shard->lock)) {
+            dtn_log_error("failed to unlock shard");
+        }
     }
 
-    payload = dtn_bundle_get_block(bundle, 1);
-    if (!payload)
-        goto error;
-
-    payload_data = dtn_bundle_get_data(payload);
+    return result;
+error:
+    return false;
+}
 
-    dtn_cbor_get_byte_string(payload_data, &buf, &buf_size);
-    size_payload += buf_size;
+/*----------------------------------------------------------------------------*/
 
-    if (size_payload >= size_all) {
-        out = get_output_buffer(self, data->queue);
-    }
+bool dtn_bundle_buffer_get_history_stats(dtn_bundle_buffer *self,
+                                         dtn_duplicate_filter_stats *stats) {
 
-done:
+    if (!self || !stats)
+        goto error;
 
-    if (out) {
+    *stats = (dtn_duplicate_filter_stats){.type = self->config.history.type};
 
-        char s[strlen(source) + 1];
-        memset(s, 0, strlen(source) + 1);
-        strcat(s, source);
+    dtn_duplicate_filter_stats shard_stats = {0};
 
-        char d[strlen(destination) + 1];
-        memset(d, 0, strlen(destination) + 1);
-        strcat(d, destination);
+    for (size_t i = 0; i < self->shards.count; i++) {
 
-        dtn_dict_del(self->data.dict, buffer);
+        Shard *shard = &self->shards.items[i];
 
-        if (!dtn_thread_lock_unlock(&self->data.lock)) {
-            dtn_log_error("failed to unlock data");
-        }
+        if (!dtn_thread_lock_try_lock(&shard->lock))
+            goto error;
 
-        if (self->config.callbacks.payload) {
+        bool ok = dtn_duplicate_filter_get_stats(shard->history, &shard_stats);
 
-            self->config.callbacks.payload(self->config.callbacks.userdata,
-                                           out->start, out->length, s, d);
+        if (!dtn_thread_lock_unlock(&shard->lock)) {
+            dtn_log_error("failed to unlock shard");
         }
 
-        out = dtn_buffer_free(out);
+        if (!ok)
+            goto error;
 
-    } else {
+        stats->memory_bytes += shard_stats.memory_bytes;
+        stats->entries += shard_stats.entries;
+        stats->capacity += shard_stats.capacity;
+        stats->checks += shard_stats.checks;
+        stats->duplicates += shard_stats.duplicates;
+        stats->evicted += shard_stats.evicted;
 
-        if (!dtn_thread_lock_unlock(&self->data.lock)) {
-            dtn_log_error("failed to unlock data");
-        }
+        // keys are spread evenly, a new key hits any shard
+        stats->false_positive_rate +=
+            shard_stats.false_positive_rate / self->shards.count;
     }
 
-    return true;
-drop:
-    dtn_bundle_free(bundle);
     return true;
 error:
-    dtn_bundle_free(bundle);
     return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool dtn_bundle_buffer_clear(dtn_bundle_buffer *self) {
+bool dtn_bundle_buffer_get_stats(dtn_bundle_buffer *self,
+                                 dtn_bundle_buffer_stats *stats) {
 
-    if (!self)
+    if (!self || !stats)
         goto error;
 
-    if (!dtn_thread_lock_try_lock(&self->data.lock))
-        goto error;
+    *stats = (dtn_bundle_buffer_stats){
 
-    bool result = dtn_dict_clear(self->data.dict);
+        .pending_bytes = atomic_load(&self->pending.bytes),
+        .rejected = atomic_load(&self->pending.rejected)};
 
-    if (!dtn_thread_lock_unlock(&self->data.lock)) {
-        dtn_log_error("failed to unlock data");
-    }
-
-    return result;
+    return true;
 error:
     return false;
-}
\ No newline at end of file
+}
@@ -30,6 +30,9 @@
 #include "dtn_bundle_buffer.c"
 #include <dtn_base/testrun.h>
 
+#include <pthread.h>
+#include <stdatomic.h>
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -47,9 +50,22 @@ int test_dtn_bundle_buffer_create() {
         dtn_bundle_buffer_create((dtn_bundle_buffer_config){.loop = loop});
 
     testrun(self);
-    testrun(self->data.dict);
+    testrun(DTN_BUNDLE_BUFFER_SHARDS_DEFAULT == self->shards.count);
+    testrun(self->shards.items[0].data);
+    testrun(self->shards.items[0].history);
     testrun(DTN_TIMER_INVALID != self->timer.cleanup);
 
+    testrun(NULL == dtn_bundle_buffer_free(self));
+
+    self = dtn_bundle_buffer_create((dtn_bundle_buffer_config){
+        .loop = loop,
+        .limits.shards = 4,
+        .limits.buffer_time_cleanup_usecs = 1000});
+
+    testrun(self);
+    testrun(4 == self->shards.count);
+    testrun(250 == self->timer.interval_usecs);
+
     testrun(NULL == dtn_bundle_buffer_free(self));
     testrun(NULL == dtn_event_loop_free(loop));
 
@@ -169,7 +185,7 @@ int test_dtn_bundle_buffer_push() {
     testrun(bundle);
 
     primary = dtn_bundle_add_primary_block(bundle, 1, 0, "destination",
-                                           "source", "report", 3, 0, 5, 0, 12);
+                                           "source", "report", 3, 7, 5, 0, 12);
 
     payload = dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("test"));
 
@@ -183,7 +199,7 @@ int test_dtn_bundle_buffer_push() {
     testrun(bundle);
 
     primary = dtn_bundle_add_primary_block(bundle, 1, 0, "destination",
-                                           "source", "report", 3, 1, 5, 4, 12);
+                                           "source", "report", 3, 7, 5, 4, 12);
 
     payload = dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("1234"));
 
@@ -197,7 +213,7 @@ int test_dtn_bundle_buffer_push() {
     testrun(bundle);
 
     primary = dtn_bundle_add_primary_block(bundle, 1, 0, "destination",
-                                           "source", "report", 3, 3, 5, 8, 12);
+                                           "source", "report", 3, 7, 5, 8, 12);
 
     payload = dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("5678"));
 
@@ -214,13 +230,13 @@ int test_dtn_bundle_buffer_push() {
 
     dummy_data_clear(&dummy);
 
-    // add 3 bundle fragments unordered delivery
+    // add 3 bundle fragments unordered delivery, placed by offset
 
     bundle = dtn_bundle_create();
     testrun(bundle);
 
     primary = dtn_bundle_add_primary_block(bundle, 1, 0, "destination",
-                                           "source", "report", 3, 1, 5, 0, 12);
+                                           "source", "report", 3, 8, 5, 4, 12);
 
     payload = dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("test"));
 
@@ -234,7 +250,7 @@ int test_dtn_bundle_buffer_push() {
     testrun(bundle);
 
     primary = dtn_bundle_add_primary_block(bundle, 1, 0, "destination",
-                                           "source", "report", 3, 0, 5, 4, 12);
+                                           "source", "report", 3, 8, 5, 0, 12);
 
     payload = dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("1234"));
 
@@ -248,7 +264,7 @@ int test_dtn_bundle_buffer_push() {
     testrun(bundle);
 
     primary = dtn_bundle_add_primary_block(bundle, 1, 0, "destination",
-                                           "source", "report", 3, 2, 5, 8, 12);
+                                           "source", "report", 3, 8, 5, 8, 12);
 
     payload = dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("5678"));
 
@@ -273,6 +289,569 @@ int test_dtn_bundle_buffer_push() {
 
 /*----------------------------------------------------------------------------*/
 
+int check_data_add_range() {
+
+    Data *data = data_create(100);
+    testrun(data);
+    testrun(!data_is_complete(data));
+
+    testrun(10 == data_add_range(data, 10, 20));
+    testrun(1 == data->ranges.count);
+
+    // duplicate
+    testrun(0 == data_add_range(data, 10, 20));
+    testrun(0 == data_add_range(data, 12, 18));
+    testrun(1 == data->ranges.count);
+
+    // disjoint before and after
+    testrun(5 == data_add_range(data, 0, 5));
+    testrun(10 == data_add_range(data, 50, 60));
+    testrun(3 == data->ranges.count);
+    testrun(0 == data->ranges.items[0].start);
+    testrun(10 == data->ranges.items[1].start);
+    testrun(50 == data->ranges.items[2].start);
+
+    // touching range merges
+    testrun(5 == data_add_range(data, 20, 25));
+    testrun(3 == data->ranges.count);
+    testrun(25 == data->ranges.items[1].end);
+
+    // overlap spanning several ranges
+    testrun(30 == data_add_range(data, 3, 55));
+    testrun(1 == data->ranges.count);
+    testrun(0 == data->ranges.items[0].start);
+    testrun(60 == data->ranges.items[0].end);
+    testrun(60 == data->received);
+
+    testrun(40 == data_add_range(data, 40, 100));
+    testrun(1 == data->ranges.count);
+    testrun(data_is_complete(data));
+
+    testrun(NULL == data_free(data));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool push_fragment(dtn_bundle_buffer *self, uint64_t sequence,
+                          uint64_t offset, uint64_t total,
+                          const char *content) {
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    if (!bundle)
+        return false;
+
+    dtn_bundle_add_primary_block(bundle, 1, 0, "destination", "source",
+                                 "report", 3, sequence, 5, offset, total);
+
+    dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string(content));
+
+    return dtn_bundle_buffer_push(self, bundle);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_buffer_push_overlapping() {
+
+    struct dummy_data dummy = {0};
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_bundle_buffer *self = dtn_bundle_buffer_create(
+        (dtn_bundle_buffer_config){.loop = loop,
+                                   .limits.max_payload_bytes = 100,
+                                   .callbacks.userdata = &dummy,
+                                   .callbacks.payload = dummy_callback});
+
+    testrun(self);
+
+    // overlapping and duplicate fragments
+
+    testrun(push_fragment(self, 1, 2, 12, "st1234"));
+    testrun(push_fragment(self, 1, 2, 12, "st1234"));
+    testrun(push_fragment(self, 1, 0, 12, "test"));
+    testrun(!dummy.buffer);
+    testrun(push_fragment(self, 1, 6, 12, "345678"));
+    testrun(dummy.buffer);
+    testrun(12 == dummy.buffer->length);
+    testrun(0 == memcmp(dummy.buffer->start, "test12345678", 12));
+
+    dummy_data_clear(&dummy);
+
+    // late fragment after delivery is dropped
+
+    testrun(push_fragment(self, 1, 0, 12, "test"));
+    testrun(push_fragment(self, 1, 4, 12, "12345678"));
+    testrun(!dummy.buffer);
+
+    // invalid fragments
+
+    testrun(!push_fragment(self, 2, 13, 12, "test"));
+    testrun(!push_fragment(self, 2, 10, 12, "test"));
+    testrun(!push_fragment(self, 2, 0, 101, "test"));
+    testrun(!dummy.buffer);
+
+    // total must match for all fragments
+
+    testrun(push_fragment(self, 3, 0, 8, "test"));
+    testrun(!push_fragment(self, 3, 4, 12, "1234"));
+    testrun(push_fragment(self, 3, 4, 8, "1234"));
+    testrun(dummy.buffer);
+    testrun(0 == memcmp(dummy.buffer->start, "test1234", 8));
+
+    dummy_data_clear(&dummy);
+
+    testrun(NULL == dtn_bundle_buffer_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_buffer_get_history_stats() {
+
+    struct dummy_data dummy = {0};
+    dtn_duplicate_filter_stats stats = {0};
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_duplicate_filter_type types[] = {DTN_DUPLICATE_FILTER_EXACT,
+                                         DTN_DUPLICATE_FILTER_BLOOM};
+
+    for (size_t i = 0; i < 2; i++) {
+
+        dtn_bundle_buffer *self = dtn_bundle_buffer_create(
+            (dtn_bundle_buffer_config){.loop = loop,
+                                       .limits.shards = 4,
+                                       .history.type = types[i],
+                                       .history.memory_bytes = 4 * 4096,
+                                       .callbacks.userdata = &dummy,
+                                       .callbacks.payload = dummy_callback});
+
+        testrun(self);
+
+        testrun(!dtn_bundle_buffer_get_history_stats(NULL, &stats));
+        testrun(!dtn_bundle_buffer_get_history_stats(self, NULL));
+
+        testrun(push_fragment(self, 1, 0, 8, "test"));
+        testrun(push_fragment(self, 1, 4, 8, "1234"));
+        testrun(dummy.buffer);
+        dummy_data_clear(&dummy);
+
+        testrun(push_fragment(self, 2, 0, 4, "test"));
+        testrun(dummy.buffer);
+        dummy_data_clear(&dummy);
+
+        // late fragment is dropped
+        testrun(push_fragment(self, 1, 4, 8, "1234"));
+        testrun(!dummy.buffer);
+
+        testrun(dtn_bundle_buffer_get_history_stats(self, &stats));
+        testrun(types[i] == stats.type);
+        testrun(2 == stats.entries);
+        testrun(4 == stats.checks);
+        testrun(1 == stats.duplicates);
+        testrun(0 == stats.evicted);
+        testrun(0 < stats.memory_bytes);
+        testrun(4 * 4096 >= stats.memory_bytes);
+        testrun(0.001 > stats.false_positive_rate);
+
+        testrun(NULL == dtn_bundle_buffer_free(self));
+    }
+
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_buffer_get_stats() {
+
+    struct dummy_data dummy = {0};
+    dtn_bundle_buffer_stats stats = {0};
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_bundle_buffer *self = dtn_bundle_buffer_create(
+        (dtn_bundle_buffer_config){.loop = loop,
+                                   .limits.max_payload_bytes = 100,
+                                   .limits.max_pending_bytes = 20,
+                                   .callbacks.userdata = &dummy,
+                                   .callbacks.payload = dummy_callback});
+
+    testrun(self);
+
+    testrun(!dtn_bundle_buffer_get_stats(NULL, &stats));
+    testrun(!dtn_bundle_buffer_get_stats(self, NULL));
+
+    testrun(dtn_bundle_buffer_get_stats(self, &stats));
+    testrun(0 == stats.pending_bytes);
+    testrun(0 == stats.rejected);
+
+    testrun(push_fragment(self, 1, 0, 12, "test"));
+    testrun(dtn_bundle_buffer_get_stats(self, &stats));
+    testrun(12 == stats.pending_bytes);
+
+    // new reassembly exceeds the budget, pending ones continue
+
+    testrun(!push_fragment(self, 2, 0, 12, "test"));
+    testrun(push_fragment(self, 3, 0, 8, "test"));
+    testrun(dtn_bundle_buffer_get_stats(self, &stats));
+    testrun(20 == stats.pending_bytes);
+    testrun(1 == stats.rejected);
+
+    testrun(push_fragment(self, 1, 4, 12, "12345678"));
+    testrun(dummy.buffer);
+    testrun(0 == memcmp(dummy.buffer->start, "test12345678", 12));
+    dummy_data_clear(&dummy);
+
+    // delivery releases the budget
+
+    testrun(dtn_bundle_buffer_get_stats(self, &stats));
+    testrun(8 == stats.pending_bytes);
+
+    testrun(push_fragment(self, 2, 0, 12, "test"));
+    testrun(dtn_bundle_buffer_get_stats(self, &stats));
+    testrun(20 == stats.pending_bytes);
+    testrun(1 == stats.rejected);
+
+    // clear releases the budget
+
+    testrun(dtn_bundle_buffer_clear(self));
+    testrun(dtn_bundle_buffer_get_stats(self, &stats));
+    testrun(0 == stats.pending_bytes);
+
+    // larger than the budget at all
+
+    testrun(!push_fragment(self, 4, 0, 21, "test"));
+    testrun(dtn_bundle_buffer_get_stats(self, &stats));
+    testrun(0 == stats.pending_bytes);
+    testrun(2 == stats.rejected);
+
+    testrun(NULL == dtn_bundle_buffer_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_get_shard() {
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_bundle_buffer *self = dtn_bundle_buffer_create(
+        (dtn_bundle_buffer_config){.loop = loop, .limits.shards = 8});
+
+    testrun(self);
+
+    char key[100] = {0};
+    size_t used[8] = {0};
+
+    for (size_t i = 0; i < 1000; i++) {
+
+        snprintf(key, sizeof(key), "source|1000|%zu", i);
+
+        Shard *shard = get_shard(self, key);
+        testrun(shard == get_shard(self, key));
+        used[shard - self->shards.items]++;
+    }
+
+    // keys are spread over all shards
+
+    for (size_t i = 0; i < 8; i++) {
+        testrun(50 < used[i]);
+    }
+
+    testrun(NULL == dtn_bundle_buffer_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_run_cleanup() {
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_bundle_buffer *self = dtn_bundle_buffer_create(
+        (dtn_bundle_buffer_config){.loop = loop,
+                                   .limits.shards = 2,
+                                   .limits.max_buffer_time_secs = 1});
+
+    testrun(self);
+
+    testrun(push_fragment(self, 1, 0, 12, "test"));
+
+    Shard *shard = get_shard(self, "source|3|1");
+    size_t index = shard - self->shards.items;
+
+    Data *data = dtn_dict_get(shard->data, "source|3|1");
+    testrun(data);
+    data->created = 0;
+
+    // cleanup of the other shard keeps the expired reassembly
+
+    self->shards.next = 1 - index;
+    testrun(dtn_event_loop_timer_unset(loop, self->timer.cleanup, NULL));
+    testrun(run_cleanup(0, self));
+    testrun(index == self->shards.next);
+    testrun(dtn_dict_get(shard->data, "source|3|1"));
+
+    testrun(dtn_event_loop_timer_unset(loop, self->timer.cleanup, NULL));
+    testrun(run_cleanup(0, self));
+    testrun(1 - index == self->shards.next);
+    testrun(!dtn_dict_get(shard->data, "source|3|1"));
+
+    // expiry releases the pending budget
+
+    dtn_bundle_buffer_stats stats = {0};
+    testrun(dtn_bundle_buffer_get_stats(self, &stats));
+    testrun(0 == stats.pending_bytes);
+
+    testrun(NULL == dtn_bundle_buffer_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+#define PUSH_THREADS 4
+#define PUSH_BUNDLES 200
+
+struct push_worker {
+
+    dtn_bundle_buffer *buffer;
+    uint64_t first;
+    size_t failed;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static void count_callback(void *userdata, const uint8_t *payload, size_t size,
+                           const char *source, const char *destination) {
+
+    UNUSED(source);
+    UNUSED(destination);
+
+    if ((12 == size) && (0 == memcmp(payload, "test12345678", 12)))
+        atomic_fetch_add((atomic_size_t *)userdata, 1);
+
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *push_fragments(void *arg) {
+
+    struct push_worker *worker = arg;
+
+    for (uint64_t i = 0; i < PUSH_BUNDLES; i++) {
+
+        uint64_t sequence = worker->first + i;
+
+        if (!push_fragment(worker->buffer, sequence, 8, 12, "5678"))
+            worker->failed++;
+
+        if (!push_fragment(worker->buffer, sequence, 0, 12, "test"))
+            worker->failed++;
+
+        if (!push_fragment(worker->buffer, sequence, 4, 12, "1234"))
+            worker->failed++;
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_buffer_push_threads() {
+
+    atomic_size_t delivered = 0;
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_bundle_buffer *self = dtn_bundle_buffer_create(
+        (dtn_bundle_buffer_config){.loop = loop,
+                                   .limits.shards = 4,
+                                   .limits.threadlock_timeout_usecs = 1000000,
+                                   .callbacks.userdata = &delivered,
+                                   .callbacks.payload = count_callback});
+
+    testrun(self);
+
+    pthread_t threads[PUSH_THREADS] = {0};
+    struct push_worker workers[PUSH_THREADS] = {0};
+
+    for (size_t i = 0; i < PUSH_THREADS; i++) {
+
+        workers[i].buffer = self;
+        workers[i].first = i * PUSH_BUNDLES;
+        testrun(0 == pthread_create(threads + i, 0, push_fragments,
+                                    workers + i));
+    }
+
+    for (size_t i = 0; i < PUSH_THREADS; i++) {
+        testrun(0 == pthread_join(threads[i], NULL));
+        testrun(0 == workers[i].failed);
+    }
+
+    testrun(PUSH_THREADS * PUSH_BUNDLES == atomic_load(&delivered));
+
+    for (size_t i = 0; i < self->shards.count; i++) {
+        testrun(0 == dtn_dict_count(self->shards.items[i].data));
+    }
+
+    testrun(NULL == dtn_bundle_buffer_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct protected_data {
+
+    dtn_key_store *store;
+    atomic_size_t delivered;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_key_store *protected_keys(void *userdata) {
+
+    return ((struct protected_data *)userdata)->store;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void protected_callback(void *userdata, const uint8_t *payload,
+                               size_t size, const char *source,
+                               const char *destination) {
+
+    struct protected_data *data = (struct protected_data *)userdata;
+    count_callback(&data->delivered, payload, size, source, destination);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool push_protected(dtn_bundle_buffer *self, const dtn_buffer *key,
+                           dtn_dtn_uri *source, uint64_t sequence,
+                           uint64_t offset, const char *content) {
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    if (!bundle)
+        return false;
+
+    dtn_bundle_add_primary_block(bundle, 1, 0, "destination", "source",
+                                 "report", 3, sequence, 5, offset, 12);
+
+    dtn_cbor *bcb =
+        dtn_bundle_add_block(bundle, 12, 2, 0, 0, dtn_cbor_string(NULL));
+    dtn_cbor *payload =
+        dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string(content));
+
+    if (!dtn_bundle_bcb_protect(bundle, bcb, payload, key, source, 0x07,
+                                A256GCM, false)) {
+        dtn_bundle_free(bundle);
+        return false;
+    }
+
+    return dtn_bundle_buffer_push(self, bundle);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_buffer_push_workers() {
+
+    struct protected_data data = {0};
+
+    uint8_t bytes[32] = {1, 2, 3};
+    dtn_buffer *key = dtn_buffer_create(sizeof(bytes));
+    testrun(dtn_buffer_set(key, bytes, sizeof(bytes)));
+
+    dtn_dtn_uri *source = dtn_dtn_uri_decode("dtn://source/1");
+    data.store = dtn_key_store_create((dtn_key_store_config){0});
+    testrun(dtn_key_store_set(data.store, "source/1", key));
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    // a small queue for pushes to fall back to the pushing thread
+
+    dtn_bundle_buffer *self = dtn_bundle_buffer_create(
+        (dtn_bundle_buffer_config){.loop = loop,
+                                   .limits.shards = 4,
+                                   .limits.workers = 3,
+                                   .limits.queue_size = 4,
+                                   .limits.threadlock_timeout_usecs = 1000000,
+                                   .callbacks.userdata = &data,
+                                   .callbacks.payload = protected_callback,
+                                   .callbacks.get_keys = protected_keys});
+
+    testrun(self);
+    testrun(self->workers.pool);
+
+    for (uint64_t i = 0; i < PUSH_BUNDLES; i++) {
+
+        testrun(push_protected(self, key, source, i, 8, "5678"));
+        testrun(push_protected(self, key, source, i, 0, "test"));
+        testrun(push_protected(self, key, source, i, 4, "1234"));
+    }
+
+    // fragments are processed by the workers
+
+    for (size_t i = 0; i < 1000; i++) {
+
+        if ((PUSH_BUNDLES == atomic_load(&data.delivered)) &&
+            (0 == atomic_load(&self->workers.pending)))
+            break;
+
+        usleep(1000);
+    }
+
+    testrun(PUSH_BUNDLES == atomic_load(&data.delivered));
+    testrun(0 == atomic_load(&self->workers.pending));
+
+    for (size_t i = 0; i < self->shards.count; i++) {
+        testrun(0 == dtn_dict_count(self->shards.items[i].data));
+    }
+
+    // queued bundles are dropped on free
+
+    for (uint64_t i = 0; i < PUSH_BUNDLES; i++) {
+        testrun(push_protected(self, key, source, 1000 + i, 0, "test"));
+    }
+
+    testrun(NULL == dtn_bundle_buffer_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    data.store = dtn_key_store_free(data.store);
+    source = dtn_dtn_uri_free(source);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -286,7 +865,15 @@ int all_tests() {
     testrun_init();
     testrun_test(test_dtn_bundle_buffer_create);
     testrun_test(test_dtn_bundle_buffer_free);
+    testrun_test(check_data_add_range);
     testrun_test(test_dtn_bundle_buffer_push);
+    testrun_test(test_dtn_bundle_buffer_push_overlapping);
+    testrun_test(test_dtn_bundle_buffer_get_history_stats);
+    testrun_test(test_dtn_bundle_buffer_get_stats);
+    testrun_test(check_get_shard);
+    testrun_test(check_run_cleanup);
+    testrun_test(test_dtn_bundle_buffer_push_threads);
+    testrun_test(test_dtn_bundle_buffer_push_workers);
 
     return testrun_counter;
 }
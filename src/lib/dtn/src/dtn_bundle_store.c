@@ -0,0 +1,1463 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_bundle_store.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_bundle_store.h"
+
+#include <dtn_base/dtn_crc32.h>
+#include <dtn_base/dtn_data_function.h>
+#include <dtn_base/dtn_dir.h>
+#include <dtn_base/dtn_hash_functions.h>
+#include <dtn_base/dtn_log.h>
+#include <dtn_base/dtn_thread_lock.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DTN_BUNDLE_STORE_MAGIC_BYTE 0xb5f0
+
+#define INDEX_MAGIC 0x78646e49  // "Indx"
+#define RECORD_MAGIC 0x64636552 // "Recd"
+#define INDEX_VERSION 1
+
+#define INDEX_FILE "index"
+#define SEGMENT_FILE "segment_%08" PRIu32
+#define FILE_MAX (PATH_MAX + 32)
+
+#define NO_SEGMENT UINT32_MAX
+#define HASH_SEED 0x9e3779b97f4a7c15ull
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      FILE LAYOUT
+ *
+ *      A segment is a sequence of records, each record is its header
+ *      followed by id and destination, both zero terminated, and the
+ *      data, padded to 8 bytes. The CRC covers the header from sequence
+ *      to priority and all content, so removed may be set in place.
+ *
+ *      The index file is an IndexHeader followed by the slots of an
+ *      open addressing table with linear probing, keyed by the hash of
+ *      the id. Slots of removed records are DELETED until rehash.
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+typedef struct Record {
+
+    uint32_t magic;
+    uint32_t crc;
+    uint64_t sequence;
+    uint64_t expires; // real time usecs, 0 without expiry
+    uint32_t size;
+    uint16_t id_size;
+    uint16_t destination_size;
+    uint8_t priority;
+    uint8_t removed;
+    uint8_t pad[6];
+
+} Record;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct SegmentInfo {
+
+    uint32_t number;
+    uint32_t used;
+    uint64_t live;
+    uint64_t end;
+    uint64_t size;
+    uint64_t live_bytes;
+
+} SegmentInfo;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct IndexHeader {
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t clean;
+    uint32_t active;
+
+    uint64_t slots;
+    uint64_t segment_size;
+    uint64_t records;
+    uint64_t deleted;
+    uint64_t sequence;
+    uint64_t next_number;
+
+    SegmentInfo segments[DTN_BUNDLE_STORE_SEGMENTS_MAX];
+
+} IndexHeader;
+
+/*----------------------------------------------------------------------------*/
+
+typedef enum SlotState {
+
+    SLOT_FREE = 0,
+    SLOT_USED,
+    SLOT_DELETED
+
+} SlotState;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Slot {
+
+    uint64_t id;
+    uint64_t destination;
+    uint64_t expires;
+    uint64_t sequence;
+    uint64_t offset;
+    uint32_t segment;
+    uint32_t size;
+    uint8_t priority;
+    uint8_t state;
+    uint8_t pad[6];
+
+} Slot;
+
+/*----------------------------------------------------------------------------*/
+
+struct dtn_bundle_store {
+
+    uint16_t magic_byte;
+    dtn_bundle_store_config config;
+
+    dtn_thread_lock lock;
+
+    struct {
+
+        size_t size;
+        IndexHeader *header;
+        Slot *slots;
+        uint64_t mask;
+
+    } index;
+
+    uint8_t *segments[DTN_BUNDLE_STORE_SEGMENTS_MAX];
+
+    struct {
+
+        uint64_t expired;
+        uint64_t compacted;
+
+    } counter;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t now_usecs() {
+
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t align8(uint64_t value) { return (value + 7) & ~(uint64_t)7; }
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t pow2_ceil(uint64_t value) {
+
+    uint64_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t hash_string(const char *string) {
+
+    return dtn_hash_bytes_seed(string, strlen(string), HASH_SEED);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void sync_range(void *start, size_t size) {
+
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t from = (uintptr_t)start & ~(page - 1);
+
+    if (0 != msync((void *)from, (uintptr_t)start + size - from, MS_SYNC))
+        dtn_log_error("failed to sync store %s", strerror(errno));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *map_file(const char *path, uint64_t *size, bool create) {
+
+    void *data = NULL;
+    struct stat st = {0};
+
+    int fd = open(path, create ? O_RDWR | O_CREAT : O_RDWR, 0600);
+    if (fd < 0)
+        goto error;
+
+    if (create) {
+
+        if (0 != ftruncate(fd, *size))
+            goto error;
+
+    } else {
+
+        if (0 != fstat(fd, &st) || st.st_size < (off_t)sizeof(Record))
+            goto error;
+
+        *size = st.st_size;
+    }
+
+    data = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == data)
+        goto error;
+
+    close(fd);
+    return data;
+error:
+    dtn_log_error("failed to map %s %s", path, strerror(errno));
+    if (fd >= 0)
+        close(fd);
+    return NULL;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      RECORDS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static char *record_id(Record *record) { return (char *)(record + 1); }
+
+/*----------------------------------------------------------------------------*/
+
+static char *record_destination(Record *record) {
+
+    return record_id(record) + record->id_size;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint8_t *record_data(Record *record) {
+
+    return (uint8_t *)record_destination(record) + record->destination_size;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t record_total(uint64_t id_size, uint64_t destination_size,
+                             uint64_t size) {
+
+    return align8(sizeof(Record) + id_size + destination_size + size);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint32_t record_crc(Record *record) {
+
+    uint32_t crc = dtn_crc32c_update(
+        0, (uint8_t *)&record->sequence,
+        offsetof(Record, removed) - offsetof(Record, sequence));
+
+    return dtn_crc32c_update(crc, (uint8_t *)record_id(record),
+                             (size_t)record->id_size +
+                                 record->destination_size + record->size);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        @returns size of a valid record at offset, 0 if invalid
+*/
+static uint64_t record_check(uint8_t *segment, uint64_t size,
+                             uint64_t offset) {
+
+    if (offset + sizeof(Record) > size)
+        return 0;
+
+    Record *record = (Record *)(segment + offset);
+
+    if (RECORD_MAGIC != record->magic)
+        return 0;
+
+    if (0 == record->id_size || 0 == record->destination_size)
+        return 0;
+
+    uint64_t total = record_total(record->id_size, record->destination_size,
+                                  record->size);
+
+    if (total > size - offset)
+        return 0;
+
+    if (0 != record_id(record)[record->id_size - 1])
+        return 0;
+
+    if (0 != record_destination(record)[record->destination_size - 1])
+        return 0;
+
+    if (record->crc != record_crc(record))
+        return 0;
+
+    return total;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      SEGMENTS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static void segment_file(const dtn_bundle_store *self, uint32_t number,
+                         char *file) {
+
+    snprintf(file, FILE_MAX, "%s/" SEGMENT_FILE, self->config.path, number);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static Record *slot_record(dtn_bundle_store *self, const Slot *slot) {
+
+    return (Record *)(self->segments[slot->segment] + slot->offset);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void segment_unmap(dtn_bundle_store *self, uint32_t i) {
+
+    SegmentInfo *info = &self->index.header->segments[i];
+
+    if (self->segments[i])
+        munmap(self->segments[i], info->size);
+
+    self->segments[i] = NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void segment_delete(dtn_bundle_store *self, uint32_t i) {
+
+    char file[FILE_MAX] = {0};
+
+    SegmentInfo *info = &self->index.header->segments[i];
+    segment_file(self, info->number, file);
+
+    segment_unmap(self, i);
+
+    if (0 != unlink(file))
+        dtn_log_error("failed to delete %s", file);
+
+    *info = (SegmentInfo){0};
+
+    if (self->index.header->active == i)
+        self->index.header->active = NO_SEGMENT;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool segment_roll(dtn_bundle_store *self) {
+
+    char file[FILE_MAX] = {0};
+
+    IndexHeader *header = self->index.header;
+    uint32_t i = 0;
+
+    for (i = 0; i < self->config.limits.segments; i++) {
+
+        if (!header->segments[i].used)
+            break;
+    }
+
+    if (i == self->config.limits.segments)
+        goto error;
+
+    uint64_t size = self->config.limits.segment_size;
+    uint32_t number = header->next_number;
+
+    segment_file(self, number, file);
+
+    self->segments[i] = map_file(file, &size, true);
+    if (!self->segments[i])
+        goto error;
+
+    header->next_number++;
+    header->segments[i] =
+        (SegmentInfo){.number = number, .used = 1, .size = size};
+
+    uint32_t last = header->active;
+    header->active = i;
+
+    if ((NO_SEGMENT != last) && (0 == header->segments[last].live))
+        segment_delete(self, last);
+
+    return true;
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint8_t *segment_reserve(dtn_bundle_store *self, uint64_t total,
+                                uint32_t *segment, uint64_t *offset) {
+
+    IndexHeader *header = self->index.header;
+
+    if ((NO_SEGMENT == header->active) ||
+        (header->segments[header->active].end + total >
+         header->segments[header->active].size)) {
+
+        if (!segment_roll(self))
+            return NULL;
+    }
+
+    *segment = header->active;
+    *offset = header->segments[header->active].end;
+
+    return self->segments[*segment] + *offset;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void segment_commit(dtn_bundle_store *self, uint32_t segment,
+                           uint64_t offset, uint64_t total) {
+
+    SegmentInfo *info = &self->index.header->segments[segment];
+
+    info->end = offset + total;
+    info->live++;
+    info->live_bytes += total;
+
+    if (self->config.sync)
+        sync_range(self->segments[segment] + offset, total);
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      INDEX
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static Slot *slot_find(dtn_bundle_store *self, const char *id) {
+
+    uint64_t hash = hash_string(id);
+    uint64_t pos = hash & self->index.mask;
+
+    for (uint64_t i = 0; i <= self->index.mask; i++) {
+
+        Slot *slot = &self->index.slots[pos];
+
+        if (SLOT_FREE == slot->state)
+            return NULL;
+
+        if ((SLOT_USED == slot->state) && (slot->id == hash) &&
+            (0 == strcmp(id, record_id(slot_record(self, slot)))))
+            return slot;
+
+        pos = (pos + 1) & self->index.mask;
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void slot_insert(dtn_bundle_store *self, const Slot *slot) {
+
+    uint64_t pos = slot->id & self->index.mask;
+
+    while (SLOT_USED == self->index.slots[pos].state)
+        pos = (pos + 1) & self->index.mask;
+
+    if (SLOT_DELETED == self->index.slots[pos].state)
+        self->index.header->deleted--;
+
+    self->index.slots[pos] = *slot;
+    self->index.slots[pos].state = SLOT_USED;
+    self->index.header->records++;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void slot_remove(dtn_bundle_store *self, Slot *slot) {
+
+    IndexHeader *header = self->index.header;
+    Record *record = slot_record(self, slot);
+
+    record->removed = 1;
+
+    if (self->config.sync)
+        sync_range(record, sizeof(Record));
+
+    SegmentInfo *info = &header->segments[slot->segment];
+    info->live--;
+    info->live_bytes -= slot->size;
+
+    if ((0 == info->live) && (header->active != slot->segment))
+        segment_delete(self, slot->segment);
+
+    slot->state = SLOT_DELETED;
+    header->records--;
+    header->deleted++;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool rehash(dtn_bundle_store *self) {
+
+    IndexHeader *header = self->index.header;
+
+    Slot *used = calloc(header->records + 1, sizeof(Slot));
+    if (!used)
+        return false;
+
+    uint64_t count = 0;
+
+    for (uint64_t i = 0; i <= self->index.mask; i++) {
+
+        if (SLOT_USED == self->index.slots[i].state)
+            used[count++] = self->index.slots[i];
+    }
+
+    memset(self->index.slots, 0, header->slots * sizeof(Slot));
+    header->records = 0;
+    header->deleted = 0;
+
+    for (uint64_t i = 0; i < count; i++) {
+        slot_insert(self, &used[i]);
+    }
+
+    free(used);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void rehash_if_required(dtn_bundle_store *self) {
+
+    IndexHeader *header = self->index.header;
+
+    if ((header->records + header->deleted) * 4 >= header->slots * 3)
+        rehash(self);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int64_t expire(dtn_bundle_store *self, uint64_t now) {
+
+    int64_t count = 0;
+
+    for (uint64_t i = 0; i <= self->index.mask; i++) {
+
+        Slot *slot = &self->index.slots[i];
+
+        if ((SLOT_USED != slot->state) || (0 == slot->expires) ||
+            (slot->expires > now))
+            continue;
+
+        slot_remove(self, slot);
+        count++;
+    }
+
+    self->counter.expired += count;
+    return count;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      RECOVERY
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static void segments_unmap(dtn_bundle_store *self) {
+
+    for (uint32_t i = 0; i < DTN_BUNDLE_STORE_SEGMENTS_MAX; i++) {
+        segment_unmap(self, i);
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool segments_map(dtn_bundle_store *self) {
+
+    char file[FILE_MAX] = {0};
+
+    for (uint32_t i = 0; i < DTN_BUNDLE_STORE_SEGMENTS_MAX; i++) {
+
+        SegmentInfo *info = &self->index.header->segments[i];
+        if (!info->used)
+            continue;
+
+        uint64_t size = 0;
+        segment_file(self, info->number, file);
+
+        self->segments[i] = map_file(file, &size, false);
+
+        if (!self->segments[i] || (size != info->size)) {
+            segments_unmap(self);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void index_init(dtn_bundle_store *self) {
+
+    IndexHeader *header = self->index.header;
+
+    memset(header, 0, self->index.size);
+
+    header->magic = INDEX_MAGIC;
+    header->version = INDEX_VERSION;
+    header->active = NO_SEGMENT;
+    header->slots = self->index.mask + 1;
+    header->segment_size = self->config.limits.segment_size;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool index_is_valid(dtn_bundle_store *self) {
+
+    IndexHeader *header = self->index.header;
+
+    if ((INDEX_MAGIC != header->magic) || (INDEX_VERSION != header->version))
+        return false;
+
+    if (!header->clean)
+        return false;
+
+    if ((header->slots != self->index.mask + 1) ||
+        (header->segment_size != self->config.limits.segment_size))
+        return false;
+
+    if ((NO_SEGMENT != header->active) &&
+        (header->active >= DTN_BUNDLE_STORE_SEGMENTS_MAX))
+        return false;
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void recover_segment(dtn_bundle_store *self, uint32_t i, uint64_t now) {
+
+    IndexHeader *header = self->index.header;
+    SegmentInfo *info = &header->segments[i];
+    uint8_t *segment = self->segments[i];
+
+    uint64_t offset = 0;
+    uint64_t total = record_check(segment, info->size, offset);
+
+    while (total > 0) {
+
+        Record *record = (Record *)(segment + offset);
+
+        if (record->sequence >= header->sequence)
+            header->sequence = record->sequence + 1;
+
+        if (record->removed) {
+
+            // skip
+
+        } else if ((0 != record->expires) && (record->expires <= now)) {
+
+            record->removed = 1;
+            self->counter.expired++;
+
+        } else if (slot_find(self, record_id(record)) ||
+                   ((header->records + 1) * 4 > header->slots * 3)) {
+
+            // copy of a compaction or above the index capacity
+            record->removed = 1;
+
+        } else {
+
+            Slot slot = (Slot){.id = hash_string(record_id(record)),
+                               .destination = hash_string(
+                                   record_destination(record)),
+                               .expires = record->expires,
+                               .sequence = record->sequence,
+                               .offset = offset,
+                               .segment = i,
+                               .size = total,
+                               .priority = record->priority};
+
+            slot_insert(self, &slot);
+            info->live++;
+            info->live_bytes += total;
+        }
+
+        offset += total;
+        total = record_check(segment, info->size, offset);
+    }
+
+    info->end = offset;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int filter_segment(const struct dirent *entry) {
+
+    uint32_t number = 0;
+    char name[64] = {0};
+
+    if (1 != sscanf(entry->d_name, "segment_%" SCNu32, &number))
+        return 0;
+
+    snprintf(name, sizeof(name), SEGMENT_FILE, number);
+    return 0 == strcmp(name, entry->d_name);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool recover(dtn_bundle_store *self) {
+
+    char file[FILE_MAX] = {0};
+    struct dirent **list = NULL;
+
+    IndexHeader *header = self->index.header;
+    uint64_t now = now_usecs();
+
+    dtn_log_info("recovering bundle store %s", self->config.path);
+
+    segments_unmap(self);
+    index_init(self);
+
+    // zero padded names, so sorted in order of creation
+
+    int n = scandir(self->config.path, &list, filter_segment, alphasort);
+    if (n < 0)
+        goto error;
+
+    uint32_t loaded = 0;
+
+    for (int k = 0; k < n; k++) {
+
+        uint32_t number = 0;
+        sscanf(list[k]->d_name, "segment_%" SCNu32, &number);
+
+        if (number >= header->next_number)
+            header->next_number = number + 1;
+
+        if (loaded == DTN_BUNDLE_STORE_SEGMENTS_MAX) {
+            dtn_log_error("bundle store %s ignores %s", self->config.path,
+                          list[k]->d_name);
+            continue;
+        }
+
+        uint64_t size = 0;
+        segment_file(self, number, file);
+
+        self->segments[loaded] = map_file(file, &size, false);
+        if (!self->segments[loaded])
+            continue;
+
+        header->segments[loaded] =
+            (SegmentInfo){.number = number, .used = 1, .size = size};
+
+        recover_segment(self, loaded, now);
+        loaded++;
+    }
+
+    for (int k = 0; k < n; k++) {
+        free(list[k]);
+    }
+    free(list);
+
+    // the last segment continues as active one
+
+    if (loaded > 0)
+        header->active = loaded - 1;
+
+    for (uint32_t i = 0; i + 1 < loaded; i++) {
+
+        if (0 == header->segments[i].live)
+            segment_delete(self, i);
+    }
+
+    dtn_log_info("recovered %" PRIu64 " records of bundle store %s",
+                 header->records, self->config.path);
+
+    return true;
+error:
+    dtn_log_error("failed to recover bundle store %s", self->config.path);
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool index_open(dtn_bundle_store *self) {
+
+    char file[FILE_MAX] = {0};
+    struct stat st = {0};
+
+    self->index.mask = pow2_ceil(self->config.limits.records * 2) - 1;
+    self->index.size =
+        sizeof(IndexHeader) + (self->index.mask + 1) * sizeof(Slot);
+
+    snprintf(file, FILE_MAX, "%s/" INDEX_FILE, self->config.path);
+
+    bool created = (0 != stat(file, &st)) ||
+                   ((uint64_t)st.st_size != (uint64_t)self->index.size);
+
+    if (created && (0 == access(file, F_OK)) && (0 != truncate(file, 0)))
+        goto error;
+
+    uint64_t size = self->index.size;
+
+    self->index.header = map_file(file, &size, true);
+    if (!self->index.header)
+        goto error;
+
+    self->index.slots = (Slot *)(self->index.header + 1);
+
+    if (created || !index_is_valid(self) || !segments_map(self)) {
+
+        if (!recover(self))
+            goto error;
+    }
+
+    self->index.header->clean = 0;
+    sync_range(self->index.header, sizeof(IndexHeader));
+
+    return true;
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool init_config(dtn_bundle_store_config *config) {
+
+    if (0 == config->path[0])
+        goto error;
+
+    if (0 == config->limits.segment_size)
+        config->limits.segment_size = DTN_BUNDLE_STORE_SEGMENT_SIZE;
+
+    if ((0 == config->limits.segments) ||
+        (config->limits.segments > DTN_BUNDLE_STORE_SEGMENTS_MAX))
+        config->limits.segments = DTN_BUNDLE_STORE_SEGMENTS_MAX;
+
+    if (0 == config->limits.records)
+        config->limits.records = DTN_BUNDLE_STORE_RECORDS;
+
+    if (0 == config->limits.threadlock_timeout_usecs)
+        config->limits.threadlock_timeout_usecs = 100000;
+
+    if (config->limits.segment_size < 4096)
+        goto error;
+
+    return true;
+error:
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_bundle_store *dtn_bundle_store_create(dtn_bundle_store_config config) {
+
+    dtn_bundle_store *self = NULL;
+
+    if (!init_config(&config))
+        goto error;
+
+    if (!dtn_dir_tree_create(config.path))
+        goto error;
+
+    self = calloc(1, sizeof(dtn_bundle_store));
+    if (!self)
+        goto error;
+
+    self->magic_byte = DTN_BUNDLE_STORE_MAGIC_BYTE;
+    self->config = config;
+
+    if (!dtn_thread_lock_init(&self->lock,
+                              config.limits.threadlock_timeout_usecs))
+        goto error;
+
+    if (!index_open(self))
+        goto error;
+
+    return self;
+error:
+    if (self) {
+        segments_unmap(self);
+        if (self->index.header)
+            munmap(self->index.header, self->index.size);
+        dtn_thread_lock_clear(&self->lock);
+    }
+    dtn_data_pointer_free(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_bundle_store *dtn_bundle_store_cast(const void *data) {
+
+    if (!data)
+        return NULL;
+
+    if (*(uint16_t *)data != DTN_BUNDLE_STORE_MAGIC_BYTE)
+        return NULL;
+
+    return (dtn_bundle_store *)data;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void *dtn_bundle_store_free(void *data) {
+
+    dtn_bundle_store *self = dtn_bundle_store_cast(data);
+    if (!self)
+        return data;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        return self;
+
+    // segments first, the index is only clean with all records on disk
+
+    IndexHeader *header = self->index.header;
+
+    for (uint32_t i = 0; i < DTN_BUNDLE_STORE_SEGMENTS_MAX; i++) {
+
+        if (self->segments[i])
+            sync_range(self->segments[i], header->segments[i].end);
+    }
+
+    segments_unmap(self);
+
+    header->clean = 1;
+    sync_range(header, self->index.size);
+    munmap(header, self->index.size);
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock bundle store.");
+    }
+
+    dtn_thread_lock_clear(&self->lock);
+    self = dtn_data_pointer_free(self);
+    return NULL;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+bool dtn_bundle_store_put(dtn_bundle_store *self,
+                          dtn_bundle_store_record record, const uint8_t *data,
+                          size_t size) {
+
+    bool result = false;
+    uint32_t segment = 0;
+    uint64_t offset = 0;
+
+    if (!self || !record.id || !record.destination || !data || 0 == size)
+        goto error;
+
+    size_t id_size = strlen(record.id) + 1;
+    size_t destination_size = strlen(record.destination) + 1;
+
+    if ((id_size > DTN_BUNDLE_STORE_ID_MAX) ||
+        (destination_size > DTN_BUNDLE_STORE_DESTINATION_MAX) ||
+        (size > UINT32_MAX))
+        goto error;
+
+    uint64_t total = record_total(id_size, destination_size, size);
+    if (total > self->config.limits.segment_size)
+        goto error;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+
+    IndexHeader *header = self->index.header;
+    uint64_t now = now_usecs();
+
+    if (slot_find(self, record.id))
+        goto done;
+
+    if (header->records >= self->config.limits.records)
+        expire(self, now);
+
+    if (header->records >= self->config.limits.records)
+        goto done;
+
+    Record *out = (Record *)segment_reserve(self, total, &segment, &offset);
+    if (!out)
+        goto done;
+
+    *out = (Record){.sequence = header->sequence++,
+                    .expires = record.lifetime_usecs
+                                   ? now + record.lifetime_usecs
+                                   : 0,
+                    .size = size,
+                    .id_size = id_size,
+                    .destination_size = destination_size,
+                    .priority = record.priority};
+
+    memcpy(record_id(out), record.id, id_size);
+    memcpy(record_destination(out), record.destination, destination_size);
+    memcpy(record_data(out), data, size);
+
+    out->crc = record_crc(out);
+    out->magic = RECORD_MAGIC;
+
+    segment_commit(self, segment, offset, total);
+
+    Slot slot = (Slot){.id = hash_string(record.id),
+                       .destination = hash_string(record.destination),
+                       .expires = out->expires,
+                       .sequence = out->sequence,
+                       .offset = offset,
+                       .segment = segment,
+                       .size = total,
+                       .priority = record.priority};
+
+    slot_insert(self, &slot);
+    rehash_if_required(self);
+    result = true;
+
+done:
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock bundle store.");
+    }
+error:
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_store_contains(dtn_bundle_store *self, const char *id) {
+
+    if (!self || !id)
+        return false;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        return false;
+
+    bool result = (NULL != slot_find(self, id));
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock bundle store.");
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_store_remove(dtn_bundle_store *self, const char *id) {
+
+    if (!self || !id)
+        return false;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        return false;
+
+    Slot *slot = slot_find(self, id);
+
+    if (slot) {
+        slot_remove(self, slot);
+        rehash_if_required(self);
+    }
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock bundle store.");
+    }
+
+    return (NULL != slot);
+}
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Pending {
+
+    uint64_t sequence;
+    uint64_t slot;
+    uint8_t priority;
+
+} Pending;
+
+/*----------------------------------------------------------------------------*/
+
+static int compare_pending(const void *a, const void *b) {
+
+    const Pending *x = (const Pending *)a;
+    const Pending *y = (const Pending *)b;
+
+    if (x->priority != y->priority)
+        return (x->priority > y->priority) ? -1 : 1;
+
+    if (x->sequence != y->sequence)
+        return (x->sequence < y->sequence) ? -1 : 1;
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int64_t dtn_bundle_store_drain(
+    dtn_bundle_store *self, const char *destination,
+    bool (*send)(void *userdata, const char *destination, const uint8_t *data,
+                 size_t size, uint64_t expires_usecs),
+    void *userdata) {
+
+    int64_t count = -1;
+    Pending *pending = NULL;
+
+    if (!self || !send)
+        goto error;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+
+    expire(self, now_usecs());
+
+    IndexHeader *header = self->index.header;
+    uint64_t hash = destination ? hash_string(destination) : 0;
+    uint64_t n = 0;
+
+    pending = calloc(header->records + 1, sizeof(Pending));
+    if (!pending)
+        goto done;
+
+    for (uint64_t i = 0; i <= self->index.mask; i++) {
+
+        Slot *slot = &self->index.slots[i];
+
+        if (SLOT_USED != slot->state)
+            continue;
+
+        if (destination && (slot->destination != hash))
+            continue;
+
+        pending[n++] = (Pending){
+            .sequence = slot->sequence, .slot = i, .priority = slot->priority};
+    }
+
+    qsort(pending, n, sizeof(Pending), compare_pending);
+
+    count = 0;
+
+    for (uint64_t i = 0; i < n; i++) {
+
+        Slot *slot = &self->index.slots[pending[i].slot];
+        Record *record = slot_record(self, slot);
+
+        if (destination && (0 != strcmp(destination,
+                                        record_destination(record))))
+            continue;
+
+        if (!send(userdata, record_destination(record), record_data(record),
+                  record->size, record->expires))
+            continue;
+
+        slot_remove(self, slot);
+        count++;
+    }
+
+    rehash_if_required(self);
+
+done:
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock bundle store.");
+    }
+error:
+    free(pending);
+    return count;
+}
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Destination {
+
+    uint64_t hash;
+    uint64_t slot;
+
+} Destination;
+
+/*----------------------------------------------------------------------------*/
+
+static int compare_destination(const void *a, const void *b) {
+
+    const Destination *x = (const Destination *)a;
+    const Destination *y = (const Destination *)b;
+
+    if (x->hash != y->hash)
+        return (x->hash < y->hash) ? -1 : 1;
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool destination_seen(dtn_bundle_store *self, const Destination *first,
+                             const Destination *current) {
+
+    // records of one hash are compared by their destination
+
+    Record *own = slot_record(self, &self->index.slots[current->slot]);
+    const char *destination = record_destination(own);
+
+    for (const Destination *d = first; d < current; d++) {
+
+        Record *record = slot_record(self, &self->index.slots[d->slot]);
+
+        if (0 == strcmp(destination, record_destination(record)))
+            return true;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int64_t dtn_bundle_store_destinations(
+    dtn_bundle_store *self,
+    bool (*found)(void *userdata, const char *destination), void *userdata) {
+
+    int64_t count = -1;
+    Destination *destinations = NULL;
+
+    if (!self || !found)
+        goto error;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+
+    IndexHeader *header = self->index.header;
+    uint64_t n = 0;
+
+    destinations = calloc(header->records + 1, sizeof(Destination));
+    if (!destinations)
+        goto done;
+
+    for (uint64_t i = 0; i <= self->index.mask; i++) {
+
+        Slot *slot = &self->index.slots[i];
+
+        if (SLOT_USED != slot->state)
+            continue;
+
+        destinations[n++] =
+            (Destination){.hash = slot->destination, .slot = i};
+    }
+
+    qsort(destinations, n, sizeof(Destination), compare_destination);
+
+    count = 0;
+    Destination *first = destinations;
+
+    for (uint64_t i = 0; i < n; i++) {
+
+        if (first->hash != destinations[i].hash)
+            first = &destinations[i];
+
+        if (destination_seen(self, first, &destinations[i]))
+            continue;
+
+        Slot *slot = &self->index.slots[destinations[i].slot];
+        found(userdata, record_destination(slot_record(self, slot)));
+        count++;
+    }
+
+done:
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock bundle store.");
+    }
+error:
+    free(destinations);
+    return count;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int64_t dtn_bundle_store_expire(dtn_bundle_store *self) {
+
+    if (!self)
+        return -1;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        return -1;
+
+    int64_t count = expire(self, now_usecs());
+    rehash_if_required(self);
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock bundle store.");
+    }
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool compact_segment(dtn_bundle_store *self, uint32_t i) {
+
+    IndexHeader *header = self->index.header;
+    SegmentInfo *info = &header->segments[i];
+
+    for (uint64_t k = 0; k <= self->index.mask; k++) {
+
+        Slot *slot = &self->index.slots[k];
+
+        if ((SLOT_USED != slot->state) || (slot->segment != i))
+            continue;
+
+        uint32_t segment = 0;
+        uint64_t offset = 0;
+
+        uint8_t *out = segment_reserve(self, slot->size, &segment, &offset);
+        if (!out)
+            return false;
+
+        Record *record = slot_record(self, slot);
+        memcpy(out, record, slot->size);
+        segment_commit(self, segment, offset, slot->size);
+
+        // mark the source, to not recover both copies
+
+        record->removed = 1;
+        info->live--;
+        info->live_bytes -= slot->size;
+
+        slot->segment = segment;
+        slot->offset = offset;
+    }
+
+    segment_delete(self, i);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int64_t dtn_bundle_store_compact(dtn_bundle_store *self) {
+
+    if (!self)
+        return -1;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        return -1;
+
+    IndexHeader *header = self->index.header;
+    int64_t count = 0;
+
+    expire(self, now_usecs());
+
+    for (uint32_t i = 0; i < DTN_BUNDLE_STORE_SEGMENTS_MAX; i++) {
+
+        SegmentInfo *info = &header->segments[i];
+
+        if (!info->used || (i == header->active))
+            continue;
+
+        if (info->live_bytes * 2 >= info->end)
+            continue;
+
+        if (!compact_segment(self, i))
+            break;
+
+        count++;
+    }
+
+    self->counter.compacted += count;
+    rehash(self);
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock bundle store.");
+    }
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_bundle_store_get_stats(dtn_bundle_store *self,
+                                dtn_bundle_store_stats *stats) {
+
+    if (!self || !stats)
+        return false;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        return false;
+
+    IndexHeader *header = self->index.header;
+
+    *stats = (dtn_bundle_store_stats){
+        .records = header->records,
+        .capacity = self->config.limits.records,
+        .expired = self->counter.expired,
+        .compacted = self->counter.compacted};
+
+    for (uint32_t i = 0; i < DTN_BUNDLE_STORE_SEGMENTS_MAX; i++) {
+
+        if (!header->segments[i].used)
+            continue;
+
+        stats->segments++;
+        stats->bytes += header->segments[i].live_bytes;
+    }
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock bundle store.");
+    }
+
+    return true;
+}
@@ -0,0 +1,828 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_bundle_store_test.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "dtn_bundle_store.c"
+#include <dtn_base/testrun.h>
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST HELPER                                                     #HELPER
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static dtn_bundle_store_config test_config(char *path) {
+
+    dtn_bundle_store_config config = (dtn_bundle_store_config){
+        .limits.segment_size = 4096, .limits.records = 64};
+
+    strncpy(config.path, path, PATH_MAX - 1);
+    return config;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static char *test_dir(char *buffer) {
+
+    strcpy(buffer, "/tmp/dtn_bundle_store_XXXXXX");
+    return mkdtemp(buffer);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool put(dtn_bundle_store *self, const char *id, const char *dest,
+                uint8_t priority, const char *data) {
+
+    return dtn_bundle_store_put(
+        self,
+        (dtn_bundle_store_record){
+            .id = id, .destination = dest, .priority = priority},
+        (const uint8_t *)data, strlen(data));
+}
+
+/*----------------------------------------------------------------------------*/
+
+// terminate the process without shutdown, files are left as they are
+
+static void crash(dtn_bundle_store *self) {
+
+    segments_unmap(self);
+    munmap(self->index.header, self->index.size);
+    dtn_thread_lock_clear(&self->lock);
+    free(self);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t segment_files(const char *path) {
+
+    struct dirent **list = NULL;
+
+    int n = scandir(path, &list, filter_segment, alphasort);
+
+    for (int i = 0; i < n; i++) {
+        free(list[i]);
+    }
+    free(list);
+
+    return n < 0 ? 0 : n;
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct sent {
+
+    dtn_bundle_store *store;
+
+    char data[20][32];
+    char destination[20][32];
+    uint64_t expires[20];
+    size_t count;
+
+    size_t reject; // reject from this count on
+    bool zero_copy;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static bool test_send(void *userdata, const char *destination,
+                      const uint8_t *data, size_t size,
+                      uint64_t expires_usecs) {
+
+    struct sent *sent = (struct sent *)userdata;
+
+    if (sent->count >= sent->reject)
+        return false;
+
+    // data is read within the mapped segments
+
+    for (uint32_t i = 0; i < DTN_BUNDLE_STORE_SEGMENTS_MAX; i++) {
+
+        uint8_t *segment = sent->store->segments[i];
+        if (!segment)
+            continue;
+
+        if ((data > segment) &&
+            (data < segment + sent->store->index.header->segments[i].size))
+            sent->zero_copy = true;
+    }
+
+    memcpy(sent->data[sent->count], data, size < 32 ? size : 31);
+    strcpy(sent->destination[sent->count], destination);
+    sent->expires[sent->count] = expires_usecs;
+    sent->count++;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool test_found(void *userdata, const char *destination) {
+
+    struct sent *sent = (struct sent *)userdata;
+
+    strcpy(sent->destination[sent->count], destination);
+    sent->count++;
+    return true;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CASES                                                      #CASES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int test_dtn_bundle_store_create() {
+
+    char path[PATH_MAX] = {0};
+    char file[FILE_MAX] = {0};
+
+    testrun(test_dir(path));
+
+    dtn_bundle_store_config config = (dtn_bundle_store_config){0};
+    testrun(!dtn_bundle_store_create(config));
+
+    config = test_config(path);
+    config.limits.segment_size = 100;
+    testrun(!dtn_bundle_store_create(config));
+
+    config = test_config(path);
+    strcat(config.path, "/sub/dir");
+
+    dtn_bundle_store *self = dtn_bundle_store_create(config);
+    testrun(self);
+    testrun(dtn_bundle_store_cast(self));
+    testrun(DTN_BUNDLE_STORE_SEGMENTS_MAX == self->config.limits.segments);
+    testrun(128 == self->index.header->slots);
+    testrun(0 == self->index.header->clean);
+    testrun(NO_SEGMENT == self->index.header->active);
+
+    snprintf(file, FILE_MAX, "%s/sub/dir/index", path);
+    testrun(0 == access(file, F_OK));
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_cast() {
+
+    char path[PATH_MAX] = {0};
+    testrun(test_dir(path));
+
+    dtn_bundle_store *self = dtn_bundle_store_create(test_config(path));
+    testrun(self);
+
+    testrun(!dtn_bundle_store_cast(NULL));
+    testrun(!dtn_bundle_store_cast("test"));
+    testrun(self == dtn_bundle_store_cast(self));
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_free() {
+
+    char path[PATH_MAX] = {0};
+    testrun(test_dir(path));
+
+    testrun(NULL == dtn_bundle_store_free(NULL));
+
+    dtn_bundle_store *self = dtn_bundle_store_create(test_config(path));
+    testrun(self);
+    testrun(put(self, "1", "a", 0, "data"));
+    testrun(NULL == dtn_bundle_store_free(self));
+
+    testrun(dtn_dir_tree_remove(path));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_put() {
+
+    char path[PATH_MAX] = {0};
+    char id[DTN_BUNDLE_STORE_ID_MAX + 1] = {0};
+    dtn_bundle_store_stats stats = {0};
+
+    testrun(test_dir(path));
+
+    dtn_bundle_store_config config = test_config(path);
+    config.limits.records = 4;
+
+    dtn_bundle_store *self = dtn_bundle_store_create(config);
+    testrun(self);
+
+    testrun(!put(NULL, "1", "a", 0, "data"));
+    testrun(!put(self, NULL, "a", 0, "data"));
+    testrun(!put(self, "1", NULL, 0, "data"));
+    testrun(!put(self, "1", "a", 0, ""));
+
+    memset(id, 'x', DTN_BUNDLE_STORE_ID_MAX);
+    testrun(!put(self, id, "a", 0, "data"));
+
+    // larger than a segment
+    uint8_t large[4096] = {0};
+    testrun(!dtn_bundle_store_put(
+        self, (dtn_bundle_store_record){.id = "1", .destination = "a"},
+        large, sizeof(large)));
+
+    testrun(put(self, "1", "a", 0, "data"));
+    testrun(!put(self, "1", "b", 0, "other"));
+    testrun(dtn_bundle_store_contains(self, "1"));
+    testrun(!dtn_bundle_store_contains(self, "2"));
+
+    Slot *slot = slot_find(self, "1");
+    testrun(slot);
+    Record *record = slot_record(self, slot);
+    testrun(RECORD_MAGIC == record->magic);
+    testrun(record->crc == record_crc(record));
+    testrun(0 == strcmp("1", record_id(record)));
+    testrun(0 == strcmp("a", record_destination(record)));
+    testrun(0 == memcmp("data", record_data(record), 4));
+    testrun(0 == record->expires);
+    testrun(48 == slot->size);
+
+    testrun(put(self, "2", "a", 0, "data"));
+    testrun(put(self, "3", "a", 0, "data"));
+    testrun(put(self, "4", "a", 0, "data"));
+
+    // index is full
+    testrun(!put(self, "5", "a", 0, "data"));
+
+    testrun(dtn_bundle_store_get_stats(self, &stats));
+    testrun(4 == stats.records);
+    testrun(4 * 48 == stats.bytes);
+    testrun(1 == stats.segments);
+    testrun(4 == stats.capacity);
+
+    testrun(dtn_bundle_store_remove(self, "4"));
+    testrun(put(self, "5", "a", 0, "data"));
+
+    // records roll over to the next segment
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    testrun(test_dir(path));
+    self = dtn_bundle_store_create(test_config(path));
+    testrun(self);
+
+    uint8_t data[1000] = {0};
+
+    for (int i = 0; i < 10; i++) {
+
+        snprintf(id, sizeof(id), "%i", i);
+        testrun(dtn_bundle_store_put(
+            self, (dtn_bundle_store_record){.id = id, .destination = "a"},
+            data, sizeof(data)));
+    }
+
+    testrun(dtn_bundle_store_get_stats(self, &stats));
+    testrun(10 == stats.records);
+    testrun(4 == stats.segments);
+    testrun(4 == segment_files(path));
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_contains() {
+
+    char path[PATH_MAX] = {0};
+    testrun(test_dir(path));
+
+    dtn_bundle_store *self = dtn_bundle_store_create(test_config(path));
+    testrun(self);
+
+    testrun(!dtn_bundle_store_contains(NULL, "1"));
+    testrun(!dtn_bundle_store_contains(self, NULL));
+    testrun(!dtn_bundle_store_contains(self, "1"));
+
+    testrun(put(self, "1", "a", 0, "data"));
+    testrun(dtn_bundle_store_contains(self, "1"));
+    testrun(!dtn_bundle_store_contains(self, "10"));
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_remove() {
+
+    char path[PATH_MAX] = {0};
+    char id[10] = {0};
+    uint8_t data[1000] = {0};
+    dtn_bundle_store_stats stats = {0};
+
+    testrun(test_dir(path));
+
+    dtn_bundle_store *self = dtn_bundle_store_create(test_config(path));
+    testrun(self);
+
+    testrun(!dtn_bundle_store_remove(NULL, "1"));
+    testrun(!dtn_bundle_store_remove(self, NULL));
+    testrun(!dtn_bundle_store_remove(self, "1"));
+
+    testrun(put(self, "1", "a", 0, "data"));
+    Record *record = slot_record(self, slot_find(self, "1"));
+
+    testrun(dtn_bundle_store_remove(self, "1"));
+    testrun(!dtn_bundle_store_contains(self, "1"));
+    testrun(!dtn_bundle_store_remove(self, "1"));
+    testrun(1 == record->removed);
+    testrun(1 == self->index.header->deleted);
+
+    // the active segment is kept if empty
+
+    testrun(dtn_bundle_store_get_stats(self, &stats));
+    testrun(0 == stats.records);
+    testrun(0 == stats.bytes);
+    testrun(1 == stats.segments);
+
+    // segments are deleted once empty
+
+    for (int i = 0; i < 8; i++) {
+
+        snprintf(id, sizeof(id), "%i", i);
+        testrun(dtn_bundle_store_put(
+            self, (dtn_bundle_store_record){.id = id, .destination = "a"},
+            data, sizeof(data)));
+    }
+
+    testrun(3 == segment_files(path));
+
+    for (int i = 0; i < 4; i++) {
+
+        snprintf(id, sizeof(id), "%i", i);
+        testrun(dtn_bundle_store_remove(self, id));
+    }
+
+    testrun(2 == segment_files(path));
+
+    for (int i = 4; i < 8; i++) {
+
+        snprintf(id, sizeof(id), "%i", i);
+        testrun(dtn_bundle_store_remove(self, id));
+    }
+
+    testrun(1 == segment_files(path));
+    testrun(dtn_bundle_store_get_stats(self, &stats));
+    testrun(0 == stats.records);
+    testrun(1 == stats.segments);
+
+    // tombstones are dropped on rehash
+
+    for (int i = 0; i < 200; i++) {
+
+        testrun(put(self, "x", "a", 0, "data"));
+        testrun(dtn_bundle_store_remove(self, "x"));
+    }
+
+    testrun(self->index.header->deleted < 96);
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_drain() {
+
+    char path[PATH_MAX] = {0};
+    struct sent sent = {0};
+
+    testrun(test_dir(path));
+
+    dtn_bundle_store *self = dtn_bundle_store_create(test_config(path));
+    testrun(self);
+
+    sent = (struct sent){.store = self, .reject = 20};
+
+    testrun(-1 == dtn_bundle_store_drain(NULL, NULL, test_send, &sent));
+    testrun(-1 == dtn_bundle_store_drain(self, NULL, NULL, &sent));
+    testrun(0 == dtn_bundle_store_drain(self, NULL, test_send, &sent));
+
+    testrun(put(self, "1", "a", 0, "a1"));
+    testrun(put(self, "2", "b", 0, "b2"));
+    testrun(put(self, "3", "a", 2, "a3"));
+    testrun(put(self, "4", "a", 1, "a4"));
+    testrun(put(self, "5", "a", 2, "a5"));
+    testrun(put(self, "6", "b", 1, "b6"));
+
+    // highest priority first, in order of storage
+
+    testrun(4 == dtn_bundle_store_drain(self, "a", test_send, &sent));
+    testrun(4 == sent.count);
+    testrun(sent.zero_copy);
+    testrun(0 == strcmp(sent.data[0], "a3"));
+    testrun(0 == strcmp(sent.data[1], "a5"));
+    testrun(0 == strcmp(sent.data[2], "a4"));
+    testrun(0 == strcmp(sent.data[3], "a1"));
+    testrun(0 == strcmp(sent.destination[0], "a"));
+    testrun(0 == sent.expires[0]);
+
+    testrun(!dtn_bundle_store_contains(self, "1"));
+    testrun(dtn_bundle_store_contains(self, "2"));
+
+    testrun(0 == dtn_bundle_store_drain(self, "a", test_send, &sent));
+    testrun(0 == dtn_bundle_store_drain(self, "c", test_send, &sent));
+
+    // rejected records are kept
+
+    testrun(put(self, "7", "a", 0, "a7"));
+
+    sent = (struct sent){.store = self, .reject = 1};
+    testrun(1 == dtn_bundle_store_drain(self, NULL, test_send, &sent));
+    testrun(0 == strcmp(sent.data[0], "b6"));
+    testrun(dtn_bundle_store_contains(self, "2"));
+    testrun(dtn_bundle_store_contains(self, "7"));
+
+    sent = (struct sent){.store = self, .reject = 20};
+    testrun(2 == dtn_bundle_store_drain(self, NULL, test_send, &sent));
+    testrun(0 == strcmp(sent.data[0], "b2"));
+    testrun(0 == strcmp(sent.destination[0], "b"));
+    testrun(0 == strcmp(sent.data[1], "a7"));
+    testrun(0 == strcmp(sent.destination[1], "a"));
+    testrun(0 == self->index.header->records);
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_destinations() {
+
+    char path[PATH_MAX] = {0};
+    struct sent sent = {0};
+
+    testrun(test_dir(path));
+
+    dtn_bundle_store *self = dtn_bundle_store_create(test_config(path));
+    testrun(self);
+
+    testrun(-1 == dtn_bundle_store_destinations(NULL, test_found, &sent));
+    testrun(-1 == dtn_bundle_store_destinations(self, NULL, &sent));
+    testrun(0 == dtn_bundle_store_destinations(self, test_found, &sent));
+    testrun(0 == sent.count);
+
+    testrun(put(self, "1", "a", 0, "a1"));
+    testrun(put(self, "2", "b", 0, "b2"));
+    testrun(put(self, "3", "a", 2, "a3"));
+    testrun(put(self, "4", "c", 1, "c4"));
+
+    // each destination once
+
+    testrun(3 == dtn_bundle_store_destinations(self, test_found, &sent));
+    testrun(3 == sent.count);
+
+    bool a = false, b = false, c = false;
+
+    for (size_t i = 0; i < sent.count; i++) {
+        a |= (0 == strcmp(sent.destination[i], "a"));
+        b |= (0 == strcmp(sent.destination[i], "b"));
+        c |= (0 == strcmp(sent.destination[i], "c"));
+    }
+
+    testrun(a && b && c);
+
+    testrun(dtn_bundle_store_remove(self, "2"));
+
+    sent = (struct sent){0};
+    testrun(2 == dtn_bundle_store_destinations(self, test_found, &sent));
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_expire() {
+
+    char path[PATH_MAX] = {0};
+    struct sent sent = {0};
+    dtn_bundle_store_stats stats = {0};
+
+    testrun(test_dir(path));
+
+    dtn_bundle_store *self = dtn_bundle_store_create(test_config(path));
+    testrun(self);
+
+    testrun(-1 == dtn_bundle_store_expire(NULL));
+    testrun(0 == dtn_bundle_store_expire(self));
+
+    testrun(put(self, "1", "a", 0, "a1"));
+
+    testrun(dtn_bundle_store_put(self,
+                                 (dtn_bundle_store_record){
+                                     .id = "2",
+                                     .destination = "a",
+                                     .lifetime_usecs = 1000},
+                                 (uint8_t *)"a2", 2));
+
+    testrun(dtn_bundle_store_put(self,
+                                 (dtn_bundle_store_record){
+                                     .id = "3",
+                                     .destination = "a",
+                                     .lifetime_usecs = 1000},
+                                 (uint8_t *)"a3", 2));
+
+    testrun(dtn_bundle_store_put(self,
+                                 (dtn_bundle_store_record){
+                                     .id = "4",
+                                     .destination = "a",
+                                     .lifetime_usecs = 60000000},
+                                 (uint8_t *)"a4", 2));
+
+    testrun(0 == dtn_bundle_store_expire(self));
+    usleep(2000);
+
+    testrun(2 == dtn_bundle_store_expire(self));
+    testrun(!dtn_bundle_store_contains(self, "2"));
+    testrun(!dtn_bundle_store_contains(self, "3"));
+
+    testrun(dtn_bundle_store_get_stats(self, &stats));
+    testrun(2 == stats.records);
+    testrun(2 == stats.expired);
+
+    // drain skips expired records
+
+    testrun(dtn_bundle_store_put(self,
+                                 (dtn_bundle_store_record){
+                                     .id = "5",
+                                     .destination = "a",
+                                     .lifetime_usecs = 1000},
+                                 (uint8_t *)"a5", 2));
+    usleep(2000);
+
+    uint64_t now = now_usecs();
+
+    sent = (struct sent){.store = self, .reject = 20};
+    testrun(2 == dtn_bundle_store_drain(self, "a", test_send, &sent));
+    testrun(0 == strcmp(sent.data[0], "a1"));
+    testrun(0 == strcmp(sent.data[1], "a4"));
+
+    // real time of expiry
+
+    testrun(0 == sent.expires[0]);
+    testrun(sent.expires[1] > now);
+    testrun(sent.expires[1] < now + 60000000);
+
+    testrun(dtn_bundle_store_get_stats(self, &stats));
+    testrun(0 == stats.records);
+    testrun(3 == stats.expired);
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_compact() {
+
+    char path[PATH_MAX] = {0};
+    char id[10] = {0};
+    uint8_t data[1000] = {0};
+    struct sent sent = {0};
+    dtn_bundle_store_stats stats = {0};
+
+    testrun(test_dir(path));
+
+    dtn_bundle_store *self = dtn_bundle_store_create(test_config(path));
+    testrun(self);
+
+    testrun(-1 == dtn_bundle_store_compact(NULL));
+    testrun(0 == dtn_bundle_store_compact(self));
+
+    // 3 records per segment, segments 0 to 3
+
+    for (int i = 0; i < 12; i++) {
+
+        snprintf(id, sizeof(id), "%i", i);
+        snprintf((char *)data, sizeof(data), "data %i", i);
+        testrun(dtn_bundle_store_put(
+            self, (dtn_bundle_store_record){.id = id, .destination = "a"},
+            data, sizeof(data)));
+    }
+
+    testrun(4 == segment_files(path));
+
+    // keep one record of segment 0 and 1, two of segment 2
+
+    const char *removed[] = {"0", "1", "3", "5", "6"};
+
+    for (size_t i = 0; i < 5; i++) {
+        testrun(dtn_bundle_store_remove(self, removed[i]));
+    }
+
+    testrun(4 == segment_files(path));
+
+    // moved to a new active segment, the former one is full
+
+    testrun(2 == dtn_bundle_store_compact(self));
+    testrun(3 == segment_files(path));
+    testrun(0 == self->index.header->deleted);
+
+    testrun(dtn_bundle_store_get_stats(self, &stats));
+    testrun(7 == stats.records);
+    testrun(2 == stats.compacted);
+
+    // moved records are intact and keep their order
+
+    sent = (struct sent){.store = self, .reject = 20};
+    testrun(7 == dtn_bundle_store_drain(self, "a", test_send, &sent));
+    testrun(0 == strcmp(sent.data[0], "data 2"));
+    testrun(0 == strcmp(sent.data[1], "data 4"));
+    testrun(0 == strcmp(sent.data[2], "data 7"));
+    testrun(0 == strcmp(sent.data[6], "data 11"));
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_store_recover() {
+
+    char path[PATH_MAX] = {0};
+    char id[10] = {0};
+    uint8_t data[1000] = {0};
+    struct sent sent = {0};
+
+    testrun(test_dir(path));
+
+    dtn_bundle_store_config config = test_config(path);
+    config.sync = true;
+
+    dtn_bundle_store *self = dtn_bundle_store_create(config);
+    testrun(self);
+
+    for (int i = 0; i < 5; i++) {
+
+        snprintf(id, sizeof(id), "%i", i);
+        snprintf((char *)data, sizeof(data), "data %i", i);
+        testrun(dtn_bundle_store_put(
+            self,
+            (dtn_bundle_store_record){
+                .id = id, .destination = "a", .priority = i % 2},
+            data, sizeof(data)));
+    }
+
+    testrun(dtn_bundle_store_remove(self, "0"));
+
+    // clean shutdown, index is used as is
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    self = dtn_bundle_store_create(config);
+    testrun(self);
+
+    testrun(4 == self->index.header->records);
+    testrun(1 == self->index.header->deleted);
+    testrun(!dtn_bundle_store_contains(self, "0"));
+    testrun(dtn_bundle_store_contains(self, "4"));
+
+    // crash, index is rebuild from the segments
+
+    crash(self);
+    self = dtn_bundle_store_create(config);
+    testrun(self);
+
+    testrun(4 == self->index.header->records);
+    testrun(0 == self->index.header->deleted);
+    testrun(5 == self->index.header->sequence);
+    testrun(!dtn_bundle_store_contains(self, "0"));
+    testrun(dtn_bundle_store_contains(self, "1"));
+    testrun(dtn_bundle_store_contains(self, "4"));
+
+    // a torn write of the last record ends the segment
+
+    Record *record = slot_record(self, slot_find(self, "4"));
+    record_data(record)[100] ^= 0xff;
+
+    crash(self);
+    self = dtn_bundle_store_create(config);
+    testrun(self);
+
+    testrun(3 == self->index.header->records);
+    testrun(!dtn_bundle_store_contains(self, "4"));
+
+    // the torn record is overwritten by the next one
+
+    uint32_t active = self->index.header->active;
+    uint64_t end = self->index.header->segments[active].end;
+
+    testrun(put(self, "5", "a", 0, "data 5"));
+    testrun(dtn_bundle_store_contains(self, "5"));
+    testrun(slot_find(self, "5")->offset == end);
+
+    // other geometry of the index, index is rebuild
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    config.limits.records = 1000;
+    self = dtn_bundle_store_create(config);
+    testrun(self);
+
+    testrun(2048 == self->index.header->slots);
+    testrun(4 == self->index.header->records);
+
+    sent = (struct sent){.store = self, .reject = 20};
+    testrun(4 == dtn_bundle_store_drain(self, NULL, test_send, &sent));
+    testrun(0 == strcmp(sent.data[0], "data 1"));
+    testrun(0 == strcmp(sent.data[1], "data 3"));
+    testrun(0 == strcmp(sent.data[2], "data 2"));
+    testrun(0 == strcmp(sent.data[3], "data 5"));
+
+    testrun(NULL == dtn_bundle_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CLUSTER                                                    #CLUSTER
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int all_tests() {
+
+    testrun_init();
+    testrun_test(test_dtn_bundle_store_create);
+    testrun_test(test_dtn_bundle_store_cast);
+    testrun_test(test_dtn_bundle_store_free);
+    testrun_test(test_dtn_bundle_store_put);
+    testrun_test(test_dtn_bundle_store_contains);
+    testrun_test(test_dtn_bundle_store_remove);
+    testrun_test(test_dtn_bundle_store_drain);
+    testrun_test(test_dtn_bundle_store_destinations);
+    testrun_test(test_dtn_bundle_store_expire);
+    testrun_test(test_dtn_bundle_store_compact);
+    testrun_test(test_dtn_bundle_store_recover);
+
+    return testrun_counter;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST EXECUTION                                                  #EXEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+testrun_run(all_tests);
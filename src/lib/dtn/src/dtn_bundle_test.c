@@ -71,7 +71,7 @@ int test_check_primary_block() {
 
     dtn_bundle *self = dtn_bundle_create();
     testrun(self);
-    testrun(!check_primary_block(self));
+    testrun(!check_primary_block(self, true));
 
     testrun(dtn_bundle_primary_set_version(self));
     testrun(dtn_bundle_primary_set_flags(self, 0));
@@ -81,7 +81,7 @@ int test_check_primary_block() {
     testrun(dtn_bundle_primary_set_report(self, "dtn:3"));
     testrun(dtn_bundle_primary_set_timestamp(self, 1, 2));
     testrun(dtn_bundle_primary_set_lifetime(self, 3));
-    testrun(check_primary_block(self));
+    testrun(check_primary_block(self, true));
 
     testrun(NULL == dtn_bundle_free(self));
 
@@ -94,7 +94,7 @@ int test_check_blocks() {
 
     dtn_bundle *self = dtn_bundle_create();
     testrun(self);
-    testrun(!check_primary_block(self));
+    testrun(!check_primary_block(self, true));
     testrun(check_canonical_blocks(self));
 
     testrun(dtn_bundle_primary_set_version(self));
@@ -105,7 +105,7 @@ int test_check_blocks() {
     testrun(dtn_bundle_primary_set_report(self, "dtn:3"));
     testrun(dtn_bundle_primary_set_timestamp(self, 1, 2));
     testrun(dtn_bundle_primary_set_lifetime(self, 3));
-    testrun(check_primary_block(self));
+    testrun(check_primary_block(self, true));
     testrun(check_canonical_blocks(self));
 
     dtn_cbor *payload = dtn_cbor_string("test");
@@ -134,7 +134,7 @@ int test_check_payload_block() {
 
     dtn_bundle *self = dtn_bundle_create();
     testrun(self);
-    testrun(!check_primary_block(self));
+    testrun(!check_primary_block(self, true));
     testrun(!check_payload_block(self));
 
     testrun(dtn_bundle_primary_set_version(self));
@@ -145,7 +145,7 @@ int test_check_payload_block() {
     testrun(dtn_bundle_primary_set_report(self, "dtn:3"));
     testrun(dtn_bundle_primary_set_timestamp(self, 1, 2));
     testrun(dtn_bundle_primary_set_lifetime(self, 3));
-    testrun(check_primary_block(self));
+    testrun(check_primary_block(self, true));
     testrun(check_canonical_blocks(self));
 
     dtn_cbor *payload = dtn_cbor_string("test");
@@ -258,6 +258,22 @@ int test_dtn_bundle_decode() {
     testrun(out);
     testrun(next == buffer + 38);
 
+    // items are decoded into the arena of the bundle
+    testrun(out->arena);
+    testrun(dtn_cbor_arena_used(out->arena) > 0);
+    testrun(!dtn_cbor_arena_active());
+
+    uint8_t *payload = NULL;
+    size_t payload_size = 0;
+    testrun(dtn_cbor_get_byte_string(
+        dtn_bundle_get_data(dtn_bundle_get_block(out, 2)), &payload,
+        &payload_size));
+    testrun(4 == payload_size);
+    testrun(0 == memcmp(payload, "test", 4));
+
+    testrun(dtn_bundle_clear(out));
+    testrun(0 == dtn_cbor_arena_used(out->arena));
+
     out = dtn_bundle_free(out);
 
     testrun(DTN_CBOR_MATCH_FULL ==
@@ -797,6 +813,244 @@ int test_dtn_bundle_decode() {
 
 /*----------------------------------------------------------------------------*/
 
+int test_dtn_bundle_decoder_push() {
+
+    size_t size = 100000;
+    uint8_t *buffer = calloc(2 * size, sizeof(uint8_t));
+    uint8_t *data = calloc(size / 2, sizeof(uint8_t));
+    uint8_t *next = NULL;
+
+    for (size_t i = 0; i < size / 2; i++) {
+        data[i] = i;
+    }
+
+    dtn_bundle *out = NULL;
+    dtn_bundle *bundle = dtn_bundle_create();
+
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 2, "dtn://dest", "dtn://src",
+                                         "dtn://report", 1, 2, 3, 0, 0));
+
+    dtn_cbor *payload = dtn_cbor_string(NULL);
+    testrun(dtn_cbor_set_byte_string(payload, data, size / 2));
+    testrun(dtn_bundle_add_block(bundle, 1, 1, 0, 2, payload));
+
+    testrun(dtn_bundle_encode(bundle, buffer, 2 * size, &next));
+    size_t len = next - buffer;
+
+    // two bundles back to back
+    memcpy(buffer + len, buffer, len);
+
+    dtn_bundle_decoder *decoder =
+        dtn_bundle_decoder_create((dtn_bundle_decoder_config){0});
+    testrun(decoder);
+
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_decoder_push(NULL, buffer, len, &out));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_decoder_push(decoder, buffer, len, NULL));
+
+    // push in chunks of 1000 bytes
+    size_t pos = 0;
+    size_t chunk = 1000;
+    dtn_cbor_match match = DTN_CBOR_MATCH_PARTIAL;
+
+    while (pos + chunk < len) {
+
+        match = dtn_bundle_decoder_push(decoder, buffer + pos, chunk, &out);
+        testrun(DTN_CBOR_MATCH_PARTIAL == match);
+        testrun(!out);
+        testrun(dtn_bundle_decoder_pending(decoder) <= pos + chunk);
+        pos += chunk;
+    }
+
+    // push remaining bytes of first and all bytes of second bundle
+    match = dtn_bundle_decoder_push(decoder, buffer + pos, 2 * len - pos, &out);
+    testrun(DTN_CBOR_MATCH_FULL == match);
+    testrun(out);
+    testrun(dtn_bundle_decoder_pending(decoder) == len);
+    testrun(0 == strcmp("dtn://dest", dtn_bundle_primary_get_destination(out)));
+    out = dtn_bundle_free(out);
+
+    match = dtn_bundle_decoder_push(decoder, NULL, 0, &out);
+    testrun(DTN_CBOR_MATCH_FULL == match);
+    testrun(out);
+    testrun(dtn_bundle_decoder_pending(decoder) == 0);
+    testrun(dtn_bundle_verify(out));
+    out = dtn_bundle_free(out);
+
+    match = dtn_bundle_decoder_push(decoder, NULL, 0, &out);
+    testrun(DTN_CBOR_MATCH_PARTIAL == match);
+    testrun(!out);
+
+    // byte by byte
+    for (size_t i = 0; i < len - 1; i++) {
+
+        testrun(DTN_CBOR_MATCH_PARTIAL ==
+                dtn_bundle_decoder_push(decoder, buffer + i, 1, &out));
+    }
+
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_decoder_push(decoder, buffer + len - 1, 1, &out));
+    testrun(out);
+    out = dtn_bundle_free(out);
+
+    // invalid input resets the decoder
+    testrun(DTN_CBOR_MATCH_PARTIAL ==
+            dtn_bundle_decoder_push(decoder, buffer, 1, &out));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_decoder_push(decoder, (uint8_t *)"\x84", 1, &out));
+    testrun(0 == dtn_bundle_decoder_pending(decoder));
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_decoder_push(decoder, buffer, len, &out));
+    out = dtn_bundle_free(out);
+
+    // broken CRC is detected when the payload block closes
+    buffer[len - 3] ^= 0xff;
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_decoder_push(decoder, buffer, len, &out));
+    testrun(!out);
+
+    testrun(NULL == dtn_bundle_decoder_free(decoder));
+    bundle = dtn_bundle_free(bundle);
+    free(buffer);
+    free(data);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_decode_crc_received() {
+
+    dtn_bundle *out = NULL;
+    uint8_t *next = NULL;
+
+    // block number of the payload block is not encoded in preferred
+    // serialization, the CRC is taken over the received bytes
+
+    uint8_t buffer[] = {0x9f, 0x88, 0x07, 0x00, 0x00, 0x41, 'd',  0x41,
+                        's',  0x41, 'r',  0x82, 0x01, 0x02, 0x03, 0x86,
+                        0x01, 0x18, 0x01, 0x00, 0x02, 0x44, 't',  'e',
+                        's',  't',  0x44, 0x00, 0x00, 0x00, 0x00, 0xff};
+
+    size_t len = sizeof(buffer);
+    uint32_t crc = dtn_crc32c(buffer + 15, 16);
+
+    buffer[27] = crc >> 24;
+    buffer[28] = crc >> 16;
+    buffer[29] = crc >> 8;
+    buffer[30] = crc;
+
+    testrun(DTN_CBOR_MATCH_FULL == dtn_bundle_decode(buffer, len, &out, &next));
+    testrun(out);
+    testrun(next == buffer + len);
+    out = dtn_bundle_free(out);
+
+    dtn_bundle_decoder *decoder =
+        dtn_bundle_decoder_create((dtn_bundle_decoder_config){0});
+
+    for (size_t i = 0; i < len - 1; i++) {
+
+        testrun(DTN_CBOR_MATCH_PARTIAL ==
+                dtn_bundle_decoder_push(decoder, buffer + i, 1, &out));
+    }
+
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_decoder_push(decoder, buffer + len - 1, 1, &out));
+    testrun(out);
+    out = dtn_bundle_free(out);
+
+    // any changed byte of the block breaks the CRC
+    for (size_t i = 22; i < 31; i++) {
+
+        buffer[i] ^= 0x01;
+        testrun(DTN_CBOR_NO_MATCH ==
+                dtn_bundle_decode(buffer, len, &out, &next));
+        testrun(!out);
+        buffer[i] ^= 0x01;
+    }
+
+    // CRC type 1 expects the CRC16 in the same position
+    buffer[20] = 0x01;
+    testrun(DTN_CBOR_NO_MATCH == dtn_bundle_decode(buffer, len, &out, &next));
+
+    testrun(NULL == dtn_bundle_decoder_free(decoder));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_view_decode() {
+
+    uint8_t buffer[1000] = {0};
+    uint8_t *next = NULL;
+    const uint8_t *data = NULL;
+    size_t size = 0;
+
+    dtn_cbor_view view = {0};
+    dtn_cbor_view_item items[100] = {0};
+    testrun(dtn_cbor_view_init(&view, items, 100));
+
+    dtn_bundle *bundle = dtn_bundle_create();
+
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 1, "dtn://dest", "dtn://src",
+                                         "dtn://report", 1, 2, 3, 0, 0));
+    testrun(dtn_bundle_add_block(bundle, 7, 2, 0, 0, dtn_cbor_string("age")));
+    testrun(dtn_bundle_add_block(bundle, 1, 1, 0, 2, dtn_cbor_string("test")));
+
+    testrun(dtn_bundle_encode(bundle, buffer, 1000, &next));
+    size_t len = next - buffer;
+
+    for (size_t i = 1; i < len; i++) {
+
+        testrun(DTN_CBOR_MATCH_PARTIAL ==
+                dtn_bundle_view_decode(buffer, i, &view, &next));
+    }
+
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_view_decode(buffer, len, &view, &next));
+    testrun(next == buffer + len);
+
+    testrun(1 == dtn_bundle_view_get_block(&view, 0));
+    testrun(-1 == dtn_bundle_view_get_block(&view, 3));
+
+    testrun(dtn_bundle_view_get_data(
+        &view, dtn_bundle_view_get_block(&view, 1), &data, &size));
+    testrun(3 == size);
+    testrun(0 == memcmp(data, "age", 3));
+
+    testrun(dtn_bundle_view_get_payload(&view, &data, &size));
+    testrun(4 == size);
+    testrun(0 == memcmp(data, "test", 4));
+    testrun(data > buffer && data < buffer + len);
+
+    // primary block has no data
+    testrun(!dtn_bundle_view_get_data(&view, 1, &data, &size));
+
+    // extension block data is no byte string
+    int64_t index =
+        dtn_cbor_view_child(&view, dtn_bundle_view_get_block(&view, 1), 4);
+    size_t offset = view.items[index].start - buffer;
+    testrun(buffer[offset] == 0x43);
+
+    buffer[offset] = 0x63;
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_view_decode(buffer, len, &view, &next));
+    testrun(0 == view.count);
+    buffer[offset] = 0x43;
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_view_decode(buffer, len, &view, &next));
+
+    // not a bundle
+    buffer[0] = 0x83;
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_view_decode(buffer, len, &view, &next));
+
+    bundle = dtn_bundle_free(bundle);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
 int test_dtn_bundle_add_primary_block() {
 
     dtn_bundle *bundle = dtn_bundle_create();
@@ -1291,6 +1545,40 @@ int test_dtn_bundle_primary_set_total_data_length() {
 
 /*----------------------------------------------------------------------------*/
 
+int test_dtn_bundle_primary_get_id() {
+
+    char id[100] = {0};
+
+    dtn_bundle *bundle = dtn_bundle_create();
+
+    testrun(!dtn_bundle_primary_get_id(NULL, id, sizeof(id)));
+    testrun(!dtn_bundle_primary_get_id(bundle, id, sizeof(id)));
+    testrun(0 == id[0]);
+
+    dtn_cbor *primary = dtn_bundle_add_primary_block(
+        bundle, 1, 2, "destination", "source", "report", 3, 4, 5, 0, 0);
+    testrun(primary);
+
+    testrun(!dtn_bundle_primary_get_id(bundle, NULL, sizeof(id)));
+    testrun(!dtn_bundle_primary_get_id(bundle, id, 0));
+
+    testrun(dtn_bundle_primary_get_id(bundle, id, sizeof(id)));
+    testrun(0 == strcmp(id, "source|3|4|0"));
+
+    testrun(dtn_bundle_primary_set_fragment_offset(bundle, 123));
+    testrun(dtn_bundle_primary_get_id(bundle, id, sizeof(id)));
+    testrun(0 == strcmp(id, "source|3|4|123"));
+
+    // does not fit
+    testrun(!dtn_bundle_primary_get_id(bundle, id, 10));
+    testrun(0 == id[0]);
+
+    bundle = dtn_bundle_free(bundle);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
 int test_dtn_bundle_add_block() {
 
     // NOTE this will add a block at the end of some bundle.
@@ -1586,7 +1874,131 @@ int test_dtn_bundle_set_data() {
 
 /*----------------------------------------------------------------------------*/
 
-int check_set_crc_primary() {
+int test_dtn_bundle_add_bundle_age() {
+
+    uint8_t buffer[1024] = {0};
+    uint8_t *next = NULL;
+    uint64_t age = 0;
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    dtn_bundle *decoded = NULL;
+
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 0, "destination", "source",
+                                         "report", 3, 4, 5, 0, 0));
+
+    testrun(!dtn_bundle_add_bundle_age(NULL, 1));
+    testrun(!dtn_bundle_get_bundle_age(bundle, &age));
+    testrun(!dtn_bundle_set_bundle_age(bundle, 1));
+
+    dtn_cbor *block = dtn_bundle_add_bundle_age(bundle, 1000);
+    testrun(block);
+    testrun(7 == dtn_bundle_get_code(block));
+    testrun(dtn_cbor_is_string(dtn_bundle_get_data(block)));
+
+    testrun(!dtn_bundle_get_bundle_age(NULL, &age));
+    testrun(!dtn_bundle_get_bundle_age(bundle, NULL));
+    testrun(dtn_bundle_get_bundle_age(bundle, &age));
+    testrun(1000 == age);
+
+    testrun(!dtn_bundle_set_bundle_age(NULL, 2000));
+    testrun(dtn_bundle_set_bundle_age(bundle, 2000));
+    testrun(dtn_bundle_get_bundle_age(bundle, &age));
+    testrun(2000 == age);
+
+    testrun(dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("data")));
+    testrun(dtn_bundle_encode(bundle, buffer, sizeof(buffer), &next));
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_decode(buffer, next - buffer, &decoded, &next));
+
+    age = 0;
+    testrun(dtn_bundle_get_bundle_age(decoded, &age));
+    testrun(2000 == age);
+
+    decoded = dtn_bundle_free(decoded);
+    bundle = dtn_bundle_free(bundle);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_bundle_add_hop_count() {
+
+    uint8_t buffer[1024] = {0};
+    uint8_t *next = NULL;
+    uint64_t count = 0;
+    uint64_t limit = 0;
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    dtn_bundle *decoded = NULL;
+
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 0, "destination", "source",
+                                         "report", 3, 4, 5, 0, 0));
+
+    testrun(!dtn_bundle_get_hop_count(bundle, &count, &limit));
+    testrun(!dtn_bundle_set_hop_count(bundle, 1));
+
+    dtn_cbor *block = dtn_bundle_add_hop_count(bundle, 1, 30);
+    testrun(block);
+    testrun(10 == dtn_bundle_get_code(block));
+    testrun(dtn_cbor_is_string(dtn_bundle_get_data(block)));
+
+    testrun(!dtn_bundle_get_hop_count(NULL, &count, &limit));
+    testrun(!dtn_bundle_get_hop_count(bundle, NULL, &limit));
+    testrun(!dtn_bundle_get_hop_count(bundle, &count, NULL));
+    testrun(dtn_bundle_get_hop_count(bundle, &count, &limit));
+    testrun(1 == count);
+    testrun(30 == limit);
+
+    testrun(!dtn_bundle_set_hop_count(NULL, 2));
+    testrun(dtn_bundle_set_hop_count(bundle, 2));
+    testrun(dtn_bundle_get_hop_count(bundle, &count, &limit));
+    testrun(2 == count);
+    testrun(30 == limit);
+
+    testrun(dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("data")));
+    testrun(dtn_bundle_encode(bundle, buffer, sizeof(buffer), &next));
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_decode(buffer, next - buffer, &decoded, &next));
+
+    testrun(dtn_bundle_get_hop_count(decoded, &count, &limit));
+    testrun(2 == count);
+    testrun(30 == limit);
+
+    decoded = dtn_bundle_free(decoded);
+    bundle = dtn_bundle_free(bundle);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool encode_crc(dtn_cbor *block, bool primary) {
+
+    uint8_t buffer[1024] = {0};
+    uint8_t expect[1024] = {0};
+    uint8_t *next = NULL;
+    uint8_t *end = NULL;
+    uint32_t width = 0;
+
+    if (!prepare_crc(block, primary, &width))
+        return false;
+
+    if (!encode_block(block, width, buffer, sizeof(buffer), &next))
+        return false;
+
+    // the patched encoding equals the encoding of the updated block
+
+    if (!dtn_cbor_encode(block, expect, sizeof(expect), &end))
+        return false;
+
+    if (end - expect != next - buffer)
+        return false;
+
+    return 0 == memcmp(expect, buffer, next - buffer);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_encode_crc_primary() {
 
     // NOTE this will add a block at the end of some bundle.
     // we preset a primary bundle here for potential further tests.
@@ -1597,41 +2009,41 @@ int check_set_crc_primary() {
     dtn_cbor *block = dtn_bundle_add_primary_block(
         bundle, 0, 0, "destination", "source", "report", 3, 4, 5, 0, 0);
 
-    testrun(set_crc_primary(block));
+    testrun(encode_crc(block, true));
     testrun(8 == dtn_cbor_array_count(block));
 
     // crc_type 1 8 block bundle
     testrun(dtn_bundle_primary_set_crc_type(bundle, 1));
-    testrun(set_crc_primary(block));
+    testrun(encode_crc(block, true));
     testrun(9 == dtn_cbor_array_count(block));
-    testrun(check_primary_block(bundle));
+    testrun(check_primary_block(bundle, true));
     bundle = dtn_bundle_free(bundle);
 
     // crc_type 2 8 block
     bundle = dtn_bundle_create();
     block = dtn_bundle_add_primary_block(bundle, 0, 1, "destination", "source",
                                          "report", 3, 4, 5, 0, 0);
-    testrun(set_crc_primary(block));
+    testrun(encode_crc(block, true));
     testrun(9 == dtn_cbor_array_count(block));
-    testrun(check_primary_block(bundle));
+    testrun(check_primary_block(bundle, true));
     bundle = dtn_bundle_free(bundle);
 
     // crc_type 2 10 block
     bundle = dtn_bundle_create();
     block = dtn_bundle_add_primary_block(bundle, 1, 2, "destination", "source",
                                          "report", 3, 4, 5, 123, 456);
-    testrun(set_crc_primary(block));
+    testrun(encode_crc(block, true));
     testrun(11 == dtn_cbor_array_count(block));
-    testrun(check_primary_block(bundle));
+    testrun(check_primary_block(bundle, true));
     bundle = dtn_bundle_free(bundle);
 
     // crc_type 1 10 block
     bundle = dtn_bundle_create();
     block = dtn_bundle_add_primary_block(bundle, 1, 1, "destination", "source",
                                          "report", 3, 4, 5, 123, 456);
-    testrun(set_crc_primary(block));
+    testrun(encode_crc(block, true));
     testrun(11 == dtn_cbor_array_count(block));
-    testrun(check_primary_block(bundle));
+    testrun(check_primary_block(bundle, true));
     bundle = dtn_bundle_free(bundle);
 
     bundle = dtn_bundle_free(bundle);
@@ -1640,7 +2052,7 @@ int check_set_crc_primary() {
 
 /*----------------------------------------------------------------------------*/
 
-int check_set_crc_block() {
+int check_encode_crc_block() {
 
     // NOTE we use the primary block based tests here to be able to
     // use the canonical checks.
@@ -1656,12 +2068,12 @@ int check_set_crc_block() {
         dtn_bundle_add_block(bundle, 0, 0, 0, 0, dtn_cbor_string("test"));
     testrun(block);
 
-    testrun(set_crc_block(block));
+    testrun(encode_crc(block, false));
     testrun(5 == dtn_cbor_array_count(block));
     testrun(check_canonical_blocks(bundle));
 
     dtn_bundle_set_crc_type(block, 1);
-    testrun(set_crc_block(block));
+    testrun(encode_crc(block, false));
     testrun(6 == dtn_cbor_array_count(block));
     testrun(check_canonical_blocks(bundle));
 
@@ -1677,11 +2089,106 @@ int check_set_crc_block() {
     testrun(block);
 
     dtn_bundle_set_crc_type(block, 2);
-    testrun(set_crc_block(block));
+    testrun(encode_crc(block, false));
+    testrun(6 == dtn_cbor_array_count(block));
+    testrun(check_canonical_blocks(bundle));
+
+    // CRC field is resized to the width of the CRC type
+    dtn_bundle_set_crc_type(block, 1);
+    testrun(encode_crc(block, false));
     testrun(6 == dtn_cbor_array_count(block));
     testrun(check_canonical_blocks(bundle));
 
+    uint8_t *bytes = NULL;
+    size_t size = 0;
+    testrun(dtn_cbor_get_byte_string(dtn_cbor_array_get(block, 5), &bytes,
+                                     &size));
+    testrun(2 == size);
+
+    // output buffer too small for the CRC field
+    uint8_t buffer[100] = {0};
+    uint8_t *next = NULL;
+    size_t len = dtn_cbor_encoding_size(block);
+    testrun(!encode_block(block, 2, buffer, len - 1, &next));
+    testrun(encode_block(block, 2, buffer, len, &next));
+    testrun(next == buffer + len);
+
+    bundle = dtn_bundle_free(bundle);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_encode_cached() {
+
+    uint8_t original[1000] = {0};
+    uint8_t forward[1000] = {0};
+    uint8_t *next = NULL;
+    const uint8_t *cached = NULL;
+    size_t size = 0;
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 2, "destination",
+                                         "source", "report", 3, 4, 5, 0, 0));
+    // bundle age block with the age encoded as block data
+    dtn_cbor *data = dtn_cbor_string(NULL);
+    testrun(dtn_cbor_set_byte_string(data, (uint8_t *)"\x18\x64", 2));
+    testrun(dtn_bundle_add_block(bundle, 7, 2, 0, 2, data));
+    testrun(dtn_bundle_add_block(bundle, 1, 1, 0, 2, dtn_cbor_string("test")));
+
+    testrun(dtn_bundle_encode(bundle, original, 1000, &next));
+    size_t len = next - original;
+
+    // blocks keep their encoding
+    dtn_cbor *raw = dtn_bundle_get_raw(bundle);
+    for (uint64_t i = 0; i < 3; i++) {
+        testrun(dtn_cbor_get_cached_encoding(dtn_cbor_array_get(raw, i),
+                                             &cached, &size));
+    }
+
+    testrun(dtn_bundle_encode(bundle, forward, 1000, &next));
+    testrun(next == forward + len);
+    testrun(0 == memcmp(original, forward, len));
     bundle = dtn_bundle_free(bundle);
+
+    // blocks of a received bundle keep the received encoding
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_decode(original, len, &bundle, &next));
+
+    raw = dtn_bundle_get_raw(bundle);
+    dtn_cbor *primary = dtn_cbor_array_get(raw, 0);
+    dtn_cbor *age = dtn_cbor_array_get(raw, 1);
+    dtn_cbor *payload = dtn_cbor_array_get(raw, 2);
+
+    testrun(dtn_cbor_get_cached_encoding(primary, &cached, &size));
+    testrun(0 == memcmp(original + 1, cached, size));
+    size_t primary_size = size;
+
+    // changed blocks are encoded again with a new CRC
+    data = dtn_bundle_get_data(age);
+    testrun(dtn_cbor_set_byte_string(data, (uint8_t *)"\x19\x12\x34", 3));
+    testrun(!dtn_cbor_get_cached_encoding(age, &cached, &size));
+    testrun(dtn_cbor_get_cached_encoding(payload, &cached, &size));
+
+    testrun(dtn_bundle_encode(bundle, forward, 1000, &next));
+    // age 100 is encoded in 2 bytes, 0x1234 in 3 bytes
+    testrun(next == forward + len + 1);
+    testrun(0 == memcmp(original, forward, 1 + primary_size));
+    testrun(0 == memcmp(original + len - 1 - size, forward + len - size,
+                        size + 1));
+    testrun(dtn_cbor_get_cached_encoding(age, &cached, &size));
+    bundle = dtn_bundle_free(bundle);
+
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_decode(forward, len + 1, &bundle, &next));
+    testrun(dtn_bundle_verify(bundle));
+    age = dtn_cbor_array_get(dtn_bundle_get_raw(bundle), 1);
+    uint8_t *bytes = NULL;
+    testrun(dtn_cbor_get_byte_string(dtn_bundle_get_data(age), &bytes, &size));
+    testrun(3 == size);
+    testrun(0 == memcmp(bytes, "\x19\x12\x34", 3));
+    bundle = dtn_bundle_free(bundle);
+
     return testrun_log_success();
 }
 
@@ -2024,9 +2531,12 @@ int test_dtn_bundle_copy() {
 
 /*----------------------------------------------------------------------------*/
 
-int test_check_primary_bytes() {
+int test_check_primary_item() {
 
     uint8_t buffer[100] = {0};
+    uint8_t *next = NULL;
+    dtn_bundle *out = NULL;
+
     // min valid
     buffer[0] = 0x9f;
     buffer[1] = 0x88;
@@ -2056,7 +2566,8 @@ int test_check_primary_bytes() {
     buffer[25] = 0x02; // sequence number
     buffer[26] = 0x03; // lifetime
 
-    testrun(check_primary_bytes(buffer + 1, 26));
+    testrun(DTN_CBOR_MATCH_PARTIAL ==
+            dtn_bundle_decode(buffer, 27, &out, &next));
 
     // full valid without crc
     buffer[0] = 0x9f;
@@ -2091,7 +2602,8 @@ int test_check_primary_bytes() {
     buffer[29] = 0x18;
     buffer[30] = 200;
 
-    testrun(check_primary_bytes(buffer + 1, 30));
+    testrun(DTN_CBOR_MATCH_PARTIAL ==
+            dtn_bundle_decode(buffer, 31, &out, &next));
 
     // app data not int
     buffer[0] = 0x9f;
@@ -2126,7 +2638,8 @@ int test_check_primary_bytes() {
     buffer[29] = 0x41;
     buffer[30] = 200;
 
-    testrun(!check_primary_bytes(buffer + 1, 30));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_decode(buffer, 31, &out, &next));
 
     // fragment not int
     buffer[0] = 0x9f;
@@ -2194,7 +2707,8 @@ int test_check_primary_bytes() {
     buffer[29] = 0x18;
     buffer[30] = 200;
 
-    testrun(!check_primary_bytes(buffer + 1, 30));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_decode(buffer, 31, &out, &next));
 
     // source not string
     buffer[0] = 0x9f;
@@ -2229,7 +2743,8 @@ int test_check_primary_bytes() {
     buffer[29] = 0x18;
     buffer[30] = 200;
 
-    testrun(!check_primary_bytes(buffer + 1, 30));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_decode(buffer, 31, &out, &next));
 
     // report not string
     buffer[0] = 0x9f;
@@ -2264,7 +2779,8 @@ int test_check_primary_bytes() {
     buffer[29] = 0x18;
     buffer[30] = 200;
 
-    testrun(!check_primary_bytes(buffer + 1, 30));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_decode(buffer, 31, &out, &next));
 
     // timestamp not array
     buffer[0] = 0x9f;
@@ -2299,7 +2815,8 @@ int test_check_primary_bytes() {
     buffer[29] = 0x18;
     buffer[30] = 200;
 
-    testrun(!check_primary_bytes(buffer + 1, 30));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_bundle_decode(buffer, 31, &out, &next));
 
     return testrun_log_success();
 }
@@ -3154,6 +3671,316 @@ int test_dtn_bundle_bcb_unprotect() {
     return testrun_log_success();
 }
 
+/*----------------------------------------------------------------------------*/
+
+struct sink_buffer {
+
+    uint8_t *start;
+    size_t length;
+    size_t size;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static bool sink_append(void *context, const uint8_t *data, size_t size) {
+
+    struct sink_buffer *buffer = (struct sink_buffer *)context;
+
+    if (buffer->length + size > buffer->size)
+        return false;
+
+    memcpy(buffer->start + buffer->length, data, size);
+    buffer->length += size;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint8_t *encode_items(uint8_t *ptr, const dtn_cbor *block,
+                             uint64_t count) {
+
+    for (uint64_t i = 0; i < count; i++) {
+
+        if (!dtn_cbor_encode(dtn_cbor_array_get(block, i), ptr, 1000, &ptr))
+            return NULL;
+    }
+
+    return ptr;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_security_input() {
+
+    uint8_t expect[2000] = {0};
+    uint8_t streamed[2000] = {0};
+    uint8_t payload_data[600] = {0};
+    uint8_t *ptr = NULL;
+
+    struct sink_buffer sink = {.start = streamed, .size = sizeof(streamed)};
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    dtn_cbor *primary = dtn_bundle_add_primary_block(
+        bundle, 0, 0, "dtn://destination", "dtn://source", "dtn://report", 3, 4,
+        5, 0, 0);
+    dtn_cbor *bib =
+        dtn_bundle_add_block(bundle, 11, 2, 0, 0, dtn_cbor_string(NULL));
+
+    dtn_cbor *data = dtn_cbor_string(NULL);
+    testrun(dtn_cbor_set_byte_string(data, payload_data, 600));
+    dtn_cbor *payload = dtn_bundle_add_block(bundle, 1, 1, 0, 0, data);
+
+    // canonical target, all AAD flags and the payload
+    expect[0] = 0x07;
+    ptr = expect + 1;
+    testrun(dtn_cbor_encode(primary, ptr, 1000, &ptr));
+    ptr = encode_items(ptr, payload, 3);
+    ptr = encode_items(ptr, bib, 3);
+    testrun(dtn_cbor_encode(data, ptr, 1000, &ptr));
+
+    testrun(security_input(bundle, bib, payload, 0x07, true, sink_append,
+                           &sink));
+    testrun(sink.length == (size_t)(ptr - expect));
+    testrun(0 == memcmp(expect, streamed, sink.length));
+
+    // AAD only
+    sink.length = 0;
+    expect[0] = 0x00;
+    testrun(security_input(bundle, bib, payload, 0x00, false, sink_append,
+                           &sink));
+    testrun(1 == sink.length);
+    testrun(0 == memcmp(expect, streamed, sink.length));
+
+    // primary block target
+    sink.length = 0;
+    expect[0] = 0x03;
+    ptr = encode_items(expect + 1, bib, 3);
+    testrun(dtn_cbor_encode(primary, ptr, 1000, &ptr));
+
+    testrun(security_input(bundle, bib, primary, 0x03, true, sink_append,
+                           &sink));
+    testrun(sink.length == (size_t)(ptr - expect));
+    testrun(0 == memcmp(expect, streamed, sink.length));
+
+    // sink failure
+    sink.length = 0;
+    sink.size = 10;
+    testrun(!security_input(bundle, bib, payload, 0x07, true, sink_append,
+                            &sink));
+
+    bundle = dtn_bundle_free(bundle);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_bundle *large_payload_bundle(size_t size, uint64_t code,
+                                        dtn_cbor **block, dtn_cbor **payload) {
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    uint8_t *bytes = calloc(1, size);
+
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = i;
+    }
+
+    dtn_cbor *data = dtn_cbor_string(NULL);
+    dtn_cbor_set_byte_string(data, bytes, size);
+    free(bytes);
+
+    dtn_bundle_add_primary_block(bundle, 0, 1, "dtn://destination",
+                                 "dtn://source", "dtn://report", 3, 4, 5, 0,
+                                 0);
+
+    *block = dtn_bundle_add_block(bundle, code, 2, 0, 0, dtn_cbor_string(NULL));
+    *payload = dtn_bundle_add_block(bundle, 1, 1, 0, 2, data);
+    return bundle;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_bpsec_large_payload() {
+
+    size_t size = 1024 * 1024 + 3;
+
+    dtn_cbor *block = NULL;
+    dtn_cbor *payload = NULL;
+    uint8_t *bytes = NULL;
+    size_t length = 0;
+
+    dtn_dtn_uri *source = dtn_dtn_uri_decode("dtn://source/1");
+    dtn_buffer *key = generate_new_key(HMAC256);
+    dtn_key_store *store = dtn_key_store_create((dtn_key_store_config){0});
+    testrun(dtn_key_store_set(store, "source/1", key));
+
+    // integrity of a payload larger than any stack buffer
+
+    dtn_bundle *bundle = large_payload_bundle(size, 11, &block, &payload);
+    testrun(dtn_bundle_bib_protect(bundle, block, payload, key, 0x07, HMAC512,
+                                   source, false));
+    testrun(dtn_bundle_bib_verify(bundle, store));
+
+    testrun(dtn_cbor_get_byte_string(dtn_bundle_get_data(payload), &bytes,
+                                     &length));
+    bytes[size - 1] ^= 0x01;
+    testrun(!dtn_bundle_bib_verify(bundle, store));
+    bundle = dtn_bundle_free(bundle);
+
+    // confidentiality encrypts the payload in place
+
+    bundle = large_payload_bundle(size, 12, &block, &payload);
+    testrun(dtn_bundle_bcb_protect(bundle, block, payload, key, source, 0x07,
+                                   A256GCM, false));
+
+    testrun(dtn_cbor_get_byte_string(dtn_bundle_get_data(payload), &bytes,
+                                     &length));
+    testrun(size == length);
+    testrun(bytes[1] != 1 || bytes[2] != 2 || bytes[3] != 3);
+
+    testrun(dtn_bundle_bcb_unprotect(bundle, store));
+    testrun(dtn_cbor_get_byte_string(dtn_bundle_get_data(payload), &bytes,
+                                     &length));
+    testrun(size == length);
+    for (size_t i = 0; i < size; i++) {
+        testrun(bytes[i] == (uint8_t)i);
+    }
+    bundle = dtn_bundle_free(bundle);
+
+    // a changed ciphertext fails the tag check
+
+    bundle = large_payload_bundle(size, 12, &block, &payload);
+    testrun(dtn_bundle_bcb_protect(bundle, block, payload, key, source, 0x07,
+                                   A128GCM, false));
+    testrun(dtn_cbor_get_byte_string(dtn_bundle_get_data(payload), &bytes,
+                                     &length));
+    bytes[size / 2] ^= 0x01;
+    testrun(!dtn_bundle_bcb_unprotect(bundle, store));
+    bundle = dtn_bundle_free(bundle);
+
+    store = dtn_key_store_free(store);
+    source = dtn_dtn_uri_free(source);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool bpsec_round_trip(dtn_key_store *store, const dtn_buffer *key,
+                             dtn_dtn_uri *source, dtn_bpsec_sha_variant sha,
+                             dtn_bpsec_aes_variant aes) {
+
+    dtn_cbor *block = NULL;
+    dtn_cbor *payload = NULL;
+    bool result = false;
+
+    dtn_bundle *bundle = large_payload_bundle(100, 11, &block, &payload);
+    if (!dtn_bundle_bib_protect(bundle, block, payload, key, 0x07, sha,
+                                source, false))
+        goto done;
+
+    if (!dtn_bundle_bib_verify(bundle, store))
+        goto done;
+
+    bundle = dtn_bundle_free(bundle);
+    bundle = large_payload_bundle(100, 12, &block, &payload);
+
+    if (!dtn_bundle_bcb_protect(bundle, block, payload, key, source, 0x07, aes,
+                                false))
+        goto done;
+
+    result = dtn_bundle_bcb_unprotect(bundle, store);
+done:
+    dtn_bundle_free(bundle);
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *bpsec_thread(void *data) {
+
+    dtn_key_store *store = (dtn_key_store *)data;
+    dtn_dtn_uri *source = dtn_dtn_uri_decode("dtn://source/1");
+    dtn_key *key = dtn_key_store_acquire(store, "source/1");
+    void *result = NULL;
+
+    for (size_t i = 0; i < 10; i++) {
+
+        if (!bpsec_round_trip(store, dtn_key_get_buffer(key), source,
+                              HMAC384, A256GCM))
+            goto done;
+    }
+
+    result = data;
+done:
+    dtn_key_release(key);
+    dtn_dtn_uri_free(source);
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_bpsec_context_cache() {
+
+    dtn_dtn_uri *source = dtn_dtn_uri_decode("dtn://source/1");
+    dtn_dtn_uri *other = dtn_dtn_uri_decode("dtn://source/2");
+    dtn_buffer *key = generate_new_key(HMAC256);
+    dtn_buffer *key_other = generate_new_key(HMAC256);
+    dtn_key_store *store = dtn_key_store_create((dtn_key_store_config){0});
+    testrun(dtn_key_store_set(store, "source/1", key));
+    testrun(dtn_key_store_set(store, "source/2", key_other));
+
+    dtn_bpsec_sha_variant sha[] = {HMAC256, HMAC384, HMAC512};
+    dtn_bpsec_aes_variant aes[] = {A128GCM, A256GCM};
+
+    // the contexts of the thread are reused with changing keys
+
+    for (size_t i = 0; i < 12; i++) {
+
+        testrun(bpsec_round_trip(store, key, source, sha[i % 3], aes[i % 2]));
+        testrun(bpsec_round_trip(store, key_other, other, sha[i % 3],
+                                 aes[i % 2]));
+    }
+
+    // a wrong key fails with a reused context and does not break it
+
+    dtn_cbor *block = NULL;
+    dtn_cbor *payload = NULL;
+
+    dtn_bundle *bundle = large_payload_bundle(100, 11, &block, &payload);
+    testrun(dtn_bundle_bib_protect(bundle, block, payload, key_other, 0x07,
+                                   HMAC256, source, false));
+    testrun(!dtn_bundle_bib_verify(bundle, store));
+    bundle = dtn_bundle_free(bundle);
+
+    bundle = large_payload_bundle(100, 12, &block, &payload);
+    testrun(dtn_bundle_bcb_protect(bundle, block, payload, key_other, source,
+                                   0x07, A128GCM, false));
+    testrun(!dtn_bundle_bcb_unprotect(bundle, store));
+    bundle = dtn_bundle_free(bundle);
+
+    testrun(bpsec_round_trip(store, key, source, HMAC256, A128GCM));
+
+    // other threads use contexts of their own
+
+    pthread_t threads[2];
+    void *result = NULL;
+
+    for (size_t i = 0; i < 2; i++) {
+        testrun(0 == pthread_create(&threads[i], NULL, bpsec_thread, store));
+    }
+
+    for (size_t i = 0; i < 2; i++) {
+        testrun(0 == pthread_join(threads[i], &result));
+        testrun(result == store);
+    }
+
+    testrun(bpsec_round_trip(store, key, source, HMAC384, A256GCM));
+
+    store = dtn_key_store_free(store);
+    source = dtn_dtn_uri_free(source);
+    other = dtn_dtn_uri_free(other);
+    return testrun_log_success();
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -3165,7 +3992,7 @@ int test_dtn_bundle_bcb_unprotect() {
 int all_tests() {
 
     testrun_init();
-    testrun_test(test_check_primary_bytes);
+    testrun_test(test_check_primary_item);
     testrun_test(test_dtn_bundle_create);
     testrun_test(test_dtn_bundle_free);
     testrun_test(test_check_primary_block);
@@ -3173,6 +4000,9 @@ int all_tests() {
     testrun_test(test_check_payload_block);
     testrun_test(test_dtn_bundle_verify);
     testrun_test(test_dtn_bundle_decode);
+    testrun_test(test_dtn_bundle_decoder_push);
+    testrun_test(test_dtn_bundle_decode_crc_received);
+    testrun_test(test_dtn_bundle_view_decode);
     testrun_test(test_dtn_bundle_add_primary_block);
     testrun_test(test_dtn_bundle_primary_get_version);
     testrun_test(test_dtn_bundle_primary_set_version);
@@ -3194,6 +4024,7 @@ int all_tests() {
     testrun_test(test_dtn_bundle_primary_set_fragment_offset);
     testrun_test(test_dtn_bundle_primary_get_total_data_length);
     testrun_test(test_dtn_bundle_primary_set_total_data_length);
+    testrun_test(test_dtn_bundle_primary_get_id);
     testrun_test(test_dtn_bundle_add_block);
     testrun_test(test_dtn_bundle_get_code);
     testrun_test(test_dtn_bundle_set_code);
@@ -3205,8 +4036,11 @@ int all_tests() {
     testrun_test(test_dtn_bundle_set_crc_type);
     testrun_test(test_dtn_bundle_get_data);
     testrun_test(test_dtn_bundle_set_data);
-    testrun_test(check_set_crc_primary);
-    testrun_test(check_set_crc_block);
+    testrun_test(test_dtn_bundle_add_bundle_age);
+    testrun_test(test_dtn_bundle_add_hop_count);
+    testrun_test(check_encode_crc_primary);
+    testrun_test(check_encode_crc_block);
+    testrun_test(check_encode_cached);
     testrun_test(test_dtn_bundle_encode);
     testrun_test(test_dtn_bundle_clear);
     testrun_test(test_dtn_bundle_free_void);
@@ -3217,6 +4051,9 @@ int all_tests() {
     testrun_test(test_dtn_bundle_bib_verify);
     testrun_test(test_dtn_bundle_bcb_protect);
     testrun_test(test_dtn_bundle_bcb_unprotect);
+    testrun_test(check_security_input);
+    testrun_test(check_bpsec_large_payload);
+    testrun_test(check_bpsec_context_cache);
 
     return testrun_counter;
 }
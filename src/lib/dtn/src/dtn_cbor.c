@@ -28,23 +28,42 @@
         ------------------------------------------------------------------------
 */
 #include "../include/dtn_cbor.h"
+#include "../include/dtn_cbor_arena.h"
 
 #include <dtn_base/dtn_buffer.h>
 #include <dtn_base/dtn_dict.h>
 #include <dtn_base/dtn_dump.h>
-#include <dtn_base/dtn_linked_list.h>
+#include <dtn_base/dtn_vector_list.h>
 #include <dtn_base/dtn_string.h>
 #include <dtn_base/dtn_utf8.h>
 
+#include <pthread.h>
+
 static dtn_cbor_config g_config = {0};
 
 /*----------------------------------------------------------------------------*/
 
+/* Encoding of an array or map, valid while CBOR_BYTES_VALID is set. */
+
+struct cbor_cache {
+
+    size_t length;
+    size_t capacity;
+    uint8_t bytes[];
+};
+
+/*----------------------------------------------------------------------------*/
+
 struct dtn_cbor {
 
     dtn_cbor_type type;
+    uint8_t flags;
+
+    union {
 
-    uint64_t tag;
+        uint64_t tag;
+        struct cbor_cache *cache; // arrays and maps
+    };
 
     union {
 
@@ -55,17 +74,310 @@ struct dtn_cbor {
 
     union {
 
-        uint64_t nbr_uint;
+        uint64_t nbr_uint; // arrays and maps: cached encoding size
         int64_t nbr_int;
 
         double nbr_double;
         float nbr_float;
     };
+
+    // array, map or tag containing the item
+    dtn_cbor *parent;
 };
 
 /*----------------------------------------------------------------------------*/
 
 static dtn_cbor *dtn_cbor_create(dtn_cbor_type type);
+static dtn_list *cbor_array_list(uint64_t items);
+static dtn_cbor *cbor_array_create(uint64_t items);
+
+/* Arrays are vectors, default slots of an array created empty. */
+#define CBOR_ARRAY_SLOTS 8
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      NODE ALLOCATION
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+#define CBOR_NODE_ARENA 0x01 // node allocated in an arena
+#define CBOR_DATA_ARENA 0x02 // bytes or string allocated in an arena
+#define CBOR_SIZE_VALID 0x04 // nbr_uint of an array or map is the size
+#define CBOR_BYTES_VALID 0x08 // cache of an array or map is the encoding
+
+/*----------------------------------------------------------------------------*/
+
+/* Released nodes are kept in a per thread slab and linked via data. */
+
+struct cbor_slab {
+
+    dtn_cbor *nodes;
+    size_t count;
+    bool registered;
+};
+
+static size_t g_slab_capacity = 0;
+static _Thread_local struct cbor_slab g_slab = {0};
+
+static pthread_key_t g_slab_key;
+static pthread_once_t g_slab_once = PTHREAD_ONCE_INIT;
+
+/*----------------------------------------------------------------------------*/
+
+static void slab_release(void *data) {
+
+    struct cbor_slab *slab = (struct cbor_slab *)data;
+    if (!slab)
+        return;
+
+    while (slab->nodes) {
+        dtn_cbor *node = slab->nodes;
+        slab->nodes = node->data;
+        free(node);
+    }
+
+    slab->count = 0;
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void slab_key_create() {
+
+    pthread_key_create(&g_slab_key, slab_release);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_cbor *cbor_node_alloc() {
+
+    dtn_cbor *self = NULL;
+    dtn_cbor_arena *arena = dtn_cbor_arena_active();
+
+    if (arena) {
+
+        self = dtn_cbor_arena_alloc(arena, sizeof(dtn_cbor));
+        if (self)
+            self->flags = CBOR_NODE_ARENA;
+
+        return self;
+    }
+
+    if (g_slab.nodes) {
+
+        self = g_slab.nodes;
+        g_slab.nodes = self->data;
+        g_slab.count--;
+
+        memset(self, 0, sizeof(dtn_cbor));
+        return self;
+    }
+
+    return calloc(1, sizeof(dtn_cbor));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void cbor_node_release(dtn_cbor *self) {
+
+    if (self->flags & CBOR_NODE_ARENA)
+        return;
+
+    if (g_slab.count < g_slab_capacity) {
+
+        if (!g_slab.registered) {
+
+            // free the slab of the thread on thread exit
+            pthread_once(&g_slab_once, slab_key_create);
+            pthread_setspecific(g_slab_key, &g_slab);
+            g_slab.registered = true;
+        }
+
+        self->data = g_slab.nodes;
+        g_slab.nodes = self;
+        g_slab.count++;
+        return;
+    }
+
+    free(self);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *cbor_data_alloc(dtn_cbor *self, size_t size) {
+
+    dtn_cbor_arena *arena = dtn_cbor_arena_active();
+
+    if (arena) {
+
+        self->flags |= CBOR_DATA_ARENA;
+        return dtn_cbor_arena_alloc(arena, size);
+    }
+
+    self->flags &= ~CBOR_DATA_ARENA;
+    return calloc(size, sizeof(uint8_t));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void cbor_data_free(dtn_cbor *self) {
+
+    if (!(self->flags & CBOR_DATA_ARENA))
+        free(self->data);
+
+    self->flags &= ~CBOR_DATA_ARENA;
+    self->data = NULL;
+    return;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ENCODING CACHE
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/*
+ *      Arrays and maps cache their encoding size and optionally their
+ *      encoding. Any change of an item drops the caches of all containers
+ *      up to the root, so each item links to its container.
+ */
+
+static void cbor_touch(dtn_cbor *self) {
+
+    while (self) {
+
+        self->flags &= ~(CBOR_SIZE_VALID | CBOR_BYTES_VALID);
+        self = self->parent;
+    }
+
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void cbor_adopt(dtn_cbor *self, dtn_cbor *item) {
+
+    if (item)
+        item->parent = self;
+
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool adopt_list_item(void *item, void *data) {
+
+    cbor_adopt((dtn_cbor *)data, (dtn_cbor *)item);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool adopt_map_item(const void *key, void *val, void *data) {
+
+    cbor_adopt((dtn_cbor *)data, (dtn_cbor *)key);
+    cbor_adopt((dtn_cbor *)data, (dtn_cbor *)val);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool cbor_is_container(const dtn_cbor *self) {
+
+    return (self->type == DTN_CBOR_ARRAY) || (self->type == DTN_CBOR_MAP);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void cbor_cache_free(dtn_cbor *self) {
+
+    if (!cbor_is_container(self))
+        return;
+
+    free(self->cache);
+    self->cache = NULL;
+    self->flags &= ~(CBOR_SIZE_VALID | CBOR_BYTES_VALID);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void dtn_cbor_touch(dtn_cbor *self) {
+
+    cbor_touch(self);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cbor_cache_encoding(dtn_cbor *self, const uint8_t *buffer,
+                             size_t size) {
+
+    if (!self || !buffer || 0 == size)
+        goto error;
+
+    if (!cbor_is_container(self))
+        goto error;
+
+    struct cbor_cache *cache = self->cache;
+
+    if (!cache || cache->capacity < size) {
+
+        cache = realloc(cache, sizeof(struct cbor_cache) + size);
+        if (!cache)
+            goto error;
+
+        cache->capacity = size;
+        self->cache = cache;
+    }
+
+    memcpy(cache->bytes, buffer, size);
+    cache->length = size;
+    self->flags |= CBOR_BYTES_VALID;
+    return true;
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cbor_get_cached_encoding(const dtn_cbor *self,
+                                  const uint8_t **buffer, size_t *size) {
+
+    if (!self || !buffer || !size)
+        goto error;
+
+    if (!cbor_is_container(self) || !(self->flags & CBOR_BYTES_VALID))
+        goto error;
+
+    *buffer = self->cache->bytes;
+    *size = self->cache->length;
+    return true;
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void dtn_cbor_enable_caching(size_t capacity) {
+
+    g_slab_capacity = capacity;
+    dtn_cbor_arena_enable_caching(capacity);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void dtn_cbor_cache_flush() {
+
+    slab_release(&g_slab);
+    return;
+}
 
 /*----------------------------------------------------------------------------*/
 
@@ -92,14 +404,16 @@ static bool cbor_clear(void *source) {
 
     case DTN_CBOR_MAP:
         self->data = dtn_dict_free(self->data);
+        cbor_cache_free(self);
         break;
 
     case DTN_CBOR_ARRAY:
         self->data = dtn_list_free(self->data);
+        cbor_cache_free(self);
         break;
 
     case DTN_CBOR_STRING:
-        self->string = dtn_data_pointer_free(self->string);
+        cbor_data_free(self);
         break;
 
     case DTN_CBOR_DEC_FRACTION:
@@ -113,7 +427,7 @@ static bool cbor_clear(void *source) {
     case DTN_CBOR_UBIGNUM:
     case DTN_CBOR_IBIGNUM:
 
-        self->bytes = dtn_data_pointer_free(self->bytes);
+        cbor_data_free(self);
         break;
     case DTN_CBOR_TAG:
 
@@ -127,6 +441,7 @@ static bool cbor_clear(void *source) {
     self->type = DTN_CBOR_UNDEF;
     self->bytes = NULL;
     self->nbr_uint = 0;
+    self->parent = NULL;
     return true;
 }
 
@@ -148,17 +463,22 @@ static void *cbor_copy(void **destination, const void *source) {
     case DTN_CBOR_MAP:
         copy->data = NULL;
         result = dtn_dict_copy((void **)&copy->data, self->data);
+        if (result)
+            dtn_dict_for_each(copy->data, copy, adopt_map_item);
         break;
 
     case DTN_CBOR_ARRAY:
-        copy->data = NULL;
+        copy->data = cbor_array_list(dtn_list_count(self->data));
         result = dtn_list_copy((void **)&copy->data, self->data);
+        if (result)
+            dtn_list_for_each(copy->data, copy, adopt_list_item);
         break;
 
     case DTN_CBOR_DEC_FRACTION:
     case DTN_CBOR_BIGFLOAT:
         copy->data = NULL;
         result = cbor_copy((void **)&copy->data, self->data);
+        cbor_adopt(copy, copy->data);
         break;
 
     case DTN_CBOR_STRING:
@@ -175,6 +495,7 @@ static void *cbor_copy(void **destination, const void *source) {
 
     case DTN_CBOR_TAG:
         copy->data = cbor_copy((void **)&copy->data, self->data);
+        cbor_adopt(copy, copy->data);
         break;
     default:
         break;
@@ -300,9 +621,6 @@ static uint64_t cbor_hash(const void *key) {
 
     dtn_cbor *self = (dtn_cbor *)key;
 
-    uint64_t result = 0;
-    dtn_buffer *buffer = NULL;
-
     switch (self->type) {
 
     case DTN_CBOR_UNDEF:
@@ -318,14 +636,10 @@ static uint64_t cbor_hash(const void *key) {
         return (uint64_t)self->nbr_int;
         break;
     case DTN_CBOR_STRING:
-        return dtn_hash_simple_c_string(self->string);
+        return dtn_hash_c_string(self->string);
         break;
     case DTN_CBOR_UTF8:
-        buffer = dtn_buffer_create(self->nbr_uint);
-        dtn_buffer_set(buffer, self->bytes, self->nbr_uint);
-        result = dtn_hash_simple_c_string(buffer->start);
-        buffer = dtn_buffer_free(buffer);
-        return result;
+        return dtn_hash_bytes(self->bytes, self->nbr_uint);
         break;
     case DTN_CBOR_ARRAY:
         return (uint64_t)(uintptr_t)self->data;
@@ -334,7 +648,7 @@ static uint64_t cbor_hash(const void *key) {
         return (uint64_t)(uintptr_t)self->data;
         break;
     case DTN_CBOR_DATE_TIME:
-        return dtn_hash_simple_c_string(self->string);
+        return dtn_hash_c_string(self->string);
         break;
     case DTN_CBOR_DATE_TIME_EPOCH:
         return self->nbr_uint;
@@ -585,7 +899,7 @@ static dtn_dict_config dtn_cbor_dict_config(uint64_t slots) {
 
 static dtn_cbor *dtn_cbor_create(dtn_cbor_type type) {
 
-    dtn_cbor *self = calloc(1, sizeof(dtn_cbor));
+    dtn_cbor *self = cbor_node_alloc();
     if (!self)
         goto error;
 
@@ -630,7 +944,7 @@ dtn_cbor *dtn_cbor_free(dtn_cbor *self) {
     if (!cbor_clear(self))
         return self;
 
-    self = dtn_data_pointer_free(self);
+    cbor_node_release(self);
     return NULL;
 }
 
@@ -993,9 +1307,6 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
             if (str_len > g_config.limits.string_size)
                 goto error;
 
-            self->string = calloc(str_len + 1, sizeof(char));
-            if (!self->string)
-                goto error;
 
             if (!dtn_cbor_set_byte_string(self, (uint8_t *)buffer + 1, str_len))
                 goto error;
@@ -1017,7 +1328,7 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
 
         str_len = buffer[1];
 
-        if (size < str_len + 1)
+        if (size < str_len + 2)
             goto partial;
 
         if (0 != str_len) {
@@ -1025,9 +1336,6 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
             if (str_len > g_config.limits.string_size)
                 goto error;
 
-            self->string = calloc(str_len + 2, sizeof(char));
-            if (!self->string)
-                goto error;
 
             if (!dtn_cbor_set_byte_string(self, (uint8_t *)buffer + 2, str_len))
                 goto error;
@@ -1046,7 +1354,7 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
         str_len = buffer[1] << 8;
         str_len += buffer[2];
 
-        if (size < str_len + 1)
+        if (size < str_len + 3)
             goto partial;
 
         self = dtn_cbor_create(DTN_CBOR_STRING);
@@ -1058,9 +1366,6 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
             if (str_len > g_config.limits.string_size)
                 goto error;
 
-            self->string = calloc(str_len + 2, sizeof(char));
-            if (!self->string)
-                goto error;
 
             if (!dtn_cbor_set_byte_string(self, (uint8_t *)buffer + 3, str_len))
                 goto error;
@@ -1085,7 +1390,7 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
         local = buffer[4];
         str_len += local;
 
-        if (size < str_len + 1)
+        if (size < str_len + 5)
             goto partial;
 
         self = dtn_cbor_create(DTN_CBOR_STRING);
@@ -1097,9 +1402,6 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
             if (str_len > g_config.limits.string_size)
                 goto error;
 
-            self->string = calloc(str_len + 2, sizeof(char));
-            if (!self->string)
-                goto error;
 
             if (!dtn_cbor_set_byte_string(self, (uint8_t *)buffer + 5, str_len))
                 goto error;
@@ -1135,7 +1437,7 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
         if (str_len == UINT64_MAX)
             goto error;
 
-        if (size < str_len + 1)
+        if (size - 9 < str_len)
             goto partial;
 
         self = dtn_cbor_create(DTN_CBOR_STRING);
@@ -1147,9 +1449,6 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
             if (str_len > g_config.limits.string_size)
                 goto error;
 
-            self->string = calloc(str_len + 1, sizeof(char));
-            if (!self->string)
-                goto error;
 
             if (!dtn_cbor_set_byte_string(self, (uint8_t *)buffer + 9, str_len))
                 goto error;
@@ -1184,9 +1483,6 @@ static dtn_cbor_match decode_text_string(const uint8_t *buffer, size_t size,
             if (str_len > g_config.limits.string_size)
                 goto error;
 
-            self->string = calloc(str_len + 1, sizeof(char));
-            if (!self->string)
-                goto error;
 
             if (!dtn_cbor_set_byte_string(self, (uint8_t *)buffer + 1, str_len))
                 goto error;
@@ -1268,7 +1564,9 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
 
         if (0 != str_len) {
 
-            self->bytes = calloc(str_len + 1, sizeof(uint8_t));
+            self->bytes = cbor_data_alloc(self, str_len + 1);
+            if (!self->bytes)
+                goto error;
 
             if (!memcpy(self->bytes, buffer + 1, str_len))
                 goto error;
@@ -1287,7 +1585,7 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
 
         str_len = buffer[1];
 
-        if (size < str_len + 1)
+        if (size < str_len + 2)
             goto partial;
 
         if (str_len > g_config.limits.utf8_string_size)
@@ -1299,7 +1597,9 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
 
         if (0 != str_len) {
 
-            self->bytes = calloc(str_len + 1, sizeof(uint8_t));
+            self->bytes = cbor_data_alloc(self, str_len + 1);
+            if (!self->bytes)
+                goto error;
 
             if (!memcpy(self->bytes, buffer + 2, str_len))
                 goto error;
@@ -1321,7 +1621,7 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
         local = buffer[2];
         str_len += local;
 
-        if (size < str_len + 1)
+        if (size < str_len + 3)
             goto partial;
 
         if (str_len > g_config.limits.utf8_string_size)
@@ -1333,7 +1633,9 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
 
         if (0 != str_len) {
 
-            self->bytes = calloc(str_len + 1, sizeof(uint8_t));
+            self->bytes = cbor_data_alloc(self, str_len + 1);
+            if (!self->bytes)
+                goto error;
 
             if (!memcpy(self->bytes, buffer + 3, str_len))
                 goto error;
@@ -1358,7 +1660,7 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
         local = buffer[4];
         str_len += local;
 
-        if (size < str_len + 1)
+        if (size < str_len + 5)
             goto partial;
 
         if (str_len > g_config.limits.utf8_string_size)
@@ -1370,7 +1672,9 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
 
         if (0 != str_len) {
 
-            self->bytes = calloc(str_len + 1, sizeof(uint8_t));
+            self->bytes = cbor_data_alloc(self, str_len + 1);
+            if (!self->bytes)
+                goto error;
 
             if (!memcpy(self->bytes, buffer + 5, str_len))
                 goto error;
@@ -1404,7 +1708,7 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
         local = buffer[8];
         str_len += local;
 
-        if (size < str_len + 1)
+        if (size - 9 < str_len)
             goto partial;
 
         if (str_len > g_config.limits.utf8_string_size)
@@ -1416,7 +1720,9 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
 
         if (0 != str_len) {
 
-            self->bytes = calloc(str_len + 1, sizeof(uint8_t));
+            self->bytes = cbor_data_alloc(self, str_len + 1);
+            if (!self->bytes)
+                goto error;
 
             if (!memcpy(self->bytes, buffer + 9, str_len))
                 goto error;
@@ -1450,7 +1756,9 @@ static dtn_cbor_match decode_utf8_string(const uint8_t *buffer, size_t size,
         if (!self)
             goto error;
 
-        self->bytes = calloc(str_len + 1, sizeof(uint8_t));
+        self->bytes = cbor_data_alloc(self, str_len + 1);
+        if (!self->bytes)
+            goto error;
 
         if (!memcpy(self->bytes, (char *)buffer + 1, str_len))
             goto error;
@@ -1661,7 +1969,7 @@ static dtn_cbor_match decode_array(const uint8_t *buffer, size_t size,
                 if (!item)
                     goto error;
 
-                if (!dtn_list_push(self->data, item)) {
+                if (!dtn_cbor_array_push(self, item)) {
                     item = dtn_cbor_free(item);
                     goto error;
                 }
@@ -1695,13 +2003,11 @@ static dtn_cbor_match decode_array(const uint8_t *buffer, size_t size,
         goto error;
     }
 
-    self = dtn_cbor_array();
+    // arr_items is bounded by size
+    self = cbor_array_create(arr_items);
     if (!self)
         goto error;
 
-    if (!self->data)
-        goto error;
-
     ptr = (uint8_t *)buffer + len;
 
     for (uint64_t i = 0; i < arr_items; i++) {
@@ -1723,6 +2029,8 @@ static dtn_cbor_match decode_array(const uint8_t *buffer, size_t size,
                 goto error;
             }
 
+            cbor_adopt(self, item);
+
             break;
 
         case DTN_CBOR_MATCH_PARTIAL:
@@ -1950,6 +2258,9 @@ static dtn_cbor_match decode_map(const uint8_t *buffer, size_t size,
                 self = dtn_cbor_free(self);
                 goto error;
             }
+
+            cbor_adopt(self, key);
+            cbor_adopt(self, val);
             if (ptr[0] == 0xFF)
                 goto out;
         }
@@ -2020,6 +2331,9 @@ static dtn_cbor_match decode_map(const uint8_t *buffer, size_t size,
             val = dtn_cbor_free(val);
             goto error;
         }
+
+        cbor_adopt(self, key);
+        cbor_adopt(self, val);
     }
 
     if (map_items > 0)
@@ -2107,6 +2421,7 @@ static dtn_cbor_match decode_tag(const uint8_t *buffer, size_t size,
         case DTN_CBOR_MATCH_FULL:
             self = dtn_cbor_create(DTN_CBOR_DEC_FRACTION);
             self->data = child;
+            cbor_adopt(self, child);
             goto done;
         default:
             return match;
@@ -2120,6 +2435,7 @@ static dtn_cbor_match decode_tag(const uint8_t *buffer, size_t size,
         case DTN_CBOR_MATCH_FULL:
             self = dtn_cbor_create(DTN_CBOR_BIGFLOAT);
             self->data = child;
+            cbor_adopt(self, child);
             goto done;
         default:
             return match;
@@ -2157,6 +2473,7 @@ static dtn_cbor_match decode_tag(const uint8_t *buffer, size_t size,
         case DTN_CBOR_MATCH_FULL:
             self = dtn_cbor_create(DTN_CBOR_TAG);
             self->data = child;
+            cbor_adopt(self, child);
             self->nbr_uint = buffer[0];
             break;
         default:
@@ -2184,6 +2501,7 @@ static dtn_cbor_match decode_tag(const uint8_t *buffer, size_t size,
         case DTN_CBOR_MATCH_FULL:
             self = dtn_cbor_create(DTN_CBOR_TAG);
             self->data = child;
+            cbor_adopt(self, child);
             break;
         default:
             return match;
@@ -2204,6 +2522,7 @@ static dtn_cbor_match decode_tag(const uint8_t *buffer, size_t size,
         case DTN_CBOR_MATCH_FULL:
             self = dtn_cbor_create(DTN_CBOR_TAG);
             self->data = child;
+            cbor_adopt(self, child);
             break;
         default:
             return match;
@@ -2229,6 +2548,7 @@ static dtn_cbor_match decode_tag(const uint8_t *buffer, size_t size,
         case DTN_CBOR_MATCH_FULL:
             self = dtn_cbor_create(DTN_CBOR_TAG);
             self->data = child;
+            cbor_adopt(self, child);
             break;
         default:
             return match;
@@ -2559,6 +2879,19 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
+/*
+ *      Sizes of arrays and maps are cached until an item changes, so the
+ *      const tree is updated here.
+ */
+static void cbor_cache_size(dtn_cbor *self, uint64_t size) {
+
+    self->nbr_uint = size;
+    self->flags |= CBOR_SIZE_VALID;
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
 static uint64_t cbor_array_encoding_size(const dtn_cbor *self) {
 
     uint64_t size = 0;
@@ -2567,6 +2900,9 @@ static uint64_t cbor_array_encoding_size(const dtn_cbor *self) {
     if (!self)
         goto error;
 
+    if (self->flags & CBOR_SIZE_VALID)
+        return self->nbr_uint;
+
     if (!self->data)
         return 1;
 
@@ -2592,6 +2928,7 @@ static uint64_t cbor_array_encoding_size(const dtn_cbor *self) {
     }
 
     size += items;
+    cbor_cache_size((dtn_cbor *)self, size);
     return size;
 error:
     return 0;
@@ -2607,6 +2944,9 @@ static uint64_t cbor_map_encoding_size(const dtn_cbor *self) {
     if (!self)
         goto error;
 
+    if (self->flags & CBOR_SIZE_VALID)
+        return self->nbr_uint;
+
     if (dtn_dict_is_empty(self->data))
         return 1;
 
@@ -2627,6 +2967,7 @@ static uint64_t cbor_map_encoding_size(const dtn_cbor *self) {
     }
 
     size += items;
+    cbor_cache_size((dtn_cbor *)self, size);
     return size;
 error:
     return 0;
@@ -3183,6 +3524,16 @@ static bool encode_array(const dtn_cbor *self, uint8_t *buffer, size_t size,
     if (self->type != DTN_CBOR_ARRAY)
         goto error;
 
+    if (self->flags & CBOR_BYTES_VALID) {
+
+        if (size < self->cache->length)
+            goto error;
+
+        memcpy(buffer, self->cache->bytes, self->cache->length);
+        *next = buffer + self->cache->length;
+        return true;
+    }
+
     uint64_t len = 0;
     uint8_t *ptr = NULL;
 
@@ -3336,6 +3687,16 @@ static bool encode_map(const dtn_cbor *self, uint8_t *buffer, size_t size,
     if (self->type != DTN_CBOR_MAP)
         goto error;
 
+    if (self->flags & CBOR_BYTES_VALID) {
+
+        if (size < self->cache->length)
+            goto error;
+
+        memcpy(buffer, self->cache->bytes, self->cache->length);
+        *next = buffer + self->cache->length;
+        return true;
+    }
+
     uint64_t len = 0;
     uint8_t *ptr = NULL;
 
@@ -4513,6 +4874,50 @@ bool dtn_cbor_encode_array_of_indefinite_length(const dtn_cbor *value,
 error:
     return false;
 }
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cbor_encode_string_head(const dtn_cbor *value, uint8_t *buffer,
+                                 size_t size, uint8_t **next) {
+
+    if (!value || !buffer || !next)
+        goto error;
+
+    if (value->type != DTN_CBOR_STRING)
+        goto error;
+
+    uint64_t length = value->nbr_uint;
+    size_t len = 9;
+    uint8_t head = 0x5B;
+
+    if (length <= 0x17) {
+        len = 1;
+        head = 0x40 | length;
+    } else if (length <= 0xFF) {
+        len = 2;
+        head = 0x58;
+    } else if (length <= 0xFFFF) {
+        len = 3;
+        head = 0x59;
+    } else if (length <= 0xFFFFffff) {
+        len = 5;
+        head = 0x5A;
+    }
+
+    if (size < len)
+        goto error;
+
+    buffer[0] = head;
+    for (size_t i = 1; i < len; i++) {
+        buffer[i] = length >> (8 * (len - 1 - i));
+    }
+
+    *next = buffer + len;
+    return true;
+error:
+    return false;
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -4556,7 +4961,13 @@ bool dtn_cbor_map_set(dtn_cbor *map, dtn_cbor *key, dtn_cbor *val) {
     if (map->type != DTN_CBOR_MAP)
         goto error;
 
-    return dtn_dict_set(map->data, key, val, NULL);
+    if (!dtn_dict_set(map->data, key, val, NULL))
+        goto error;
+
+    cbor_adopt(map, key);
+    cbor_adopt(map, val);
+    cbor_touch(map);
+    return true;
 error:
     return false;
 }
@@ -4581,6 +4992,10 @@ bool dtn_cbor_map_set_string(dtn_cbor *map, const char *key, dtn_cbor *val) {
 
     if (!dtn_dict_set(map->data, k, val, NULL))
         goto error;
+
+    cbor_adopt(map, k);
+    cbor_adopt(map, val);
+    cbor_touch(map);
     return true;
 error:
     k = cbor_free(k);
@@ -4659,18 +5074,25 @@ error:
  *      ------------------------------------------------------------------------
  */
 
-dtn_cbor *dtn_cbor_array() {
+static dtn_list *cbor_array_list(uint64_t items) {
+
+    return dtn_vector_list_create_sized(
+        (dtn_list_config){.item.copy = cbor_copy,
+                          .item.clear = cbor_clear,
+                          .item.free = cbor_free,
+                          .item.dump = cbor_dump},
+        items);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_cbor *cbor_array_create(uint64_t items) {
 
     dtn_cbor *out = dtn_cbor_create(DTN_CBOR_ARRAY);
     if (!out)
         goto error;
 
-    out->data =
-        dtn_linked_list_create((dtn_list_config){.item.copy = cbor_copy,
-                                                 .item.clear = cbor_clear,
-                                                 .item.free = cbor_free,
-                                                 .item.dump = cbor_dump});
-
+    out->data = cbor_array_list(items);
     if (!out->data)
         goto error;
 
@@ -4682,6 +5104,10 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
+dtn_cbor *dtn_cbor_array() { return cbor_array_create(CBOR_ARRAY_SLOTS); }
+
+/*----------------------------------------------------------------------------*/
+
 bool dtn_cbor_is_array(const dtn_cbor *self) {
 
     if (!self || self->type != DTN_CBOR_ARRAY)
@@ -4699,7 +5125,17 @@ bool dtn_cbor_array_push(dtn_cbor *self, dtn_cbor *val) {
     if (self->type != DTN_CBOR_ARRAY)
         return false;
 
-    return dtn_list_push(self->data, val);
+    // grow by doubling the slots of the vector
+    uint64_t count = dtn_list_count(self->data);
+    if (count >= CBOR_ARRAY_SLOTS)
+        dtn_vector_list_set_rate(self->data, count);
+
+    if (!dtn_list_push(self->data, val))
+        return false;
+
+    cbor_adopt(self, val);
+    cbor_touch(self);
+    return true;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -4710,6 +5146,11 @@ dtn_cbor *dtn_cbor_array_pop_queue(dtn_cbor *self) {
         return NULL;
 
     dtn_cbor *out = dtn_list_remove(self->data, 1);
+    if (!out)
+        return NULL;
+
+    out->parent = NULL;
+    cbor_touch(self);
     return out;
 }
 
@@ -4720,7 +5161,13 @@ dtn_cbor *dtn_cbor_array_pop_stack(dtn_cbor *self) {
     if (self->type != DTN_CBOR_ARRAY)
         return NULL;
 
-    return dtn_list_pop(self->data);
+    dtn_cbor *out = dtn_list_pop(self->data);
+    if (!out)
+        return NULL;
+
+    out->parent = NULL;
+    cbor_touch(self);
+    return out;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -4758,6 +5205,12 @@ bool dtn_cbor_array_set(dtn_cbor *self, uint64_t index, dtn_cbor *data) {
 
     bool result = dtn_list_set(self->data, index + 1, data, (void **)&out);
     out = dtn_cbor_free(out);
+
+    if (result) {
+        cbor_adopt(self, data);
+        cbor_touch(self);
+    }
+
     return result;
 }
 
@@ -4822,7 +5275,8 @@ bool dtn_cbor_set_string(dtn_cbor *self, const char *string) {
     if (!self || self->type != DTN_CBOR_STRING)
         goto error;
 
-    self->string = dtn_data_pointer_free(self->string);
+    cbor_touch(self);
+    cbor_data_free(self);
     self->string = dtn_string_dup(string);
     self->nbr_uint = strlen(self->string);
 
@@ -4839,8 +5293,12 @@ bool dtn_cbor_set_byte_string(dtn_cbor *self, const uint8_t *byte,
     if (!self || self->type != DTN_CBOR_STRING)
         goto error;
 
-    self->string = dtn_data_pointer_free(self->string);
-    self->bytes = calloc(size + 1, (sizeof(uint8_t)));
+    cbor_touch(self);
+    cbor_data_free(self);
+    self->bytes = cbor_data_alloc(self, size + 1);
+    if (!self->bytes)
+        goto error;
+
     self->nbr_uint = size;
     memcpy(self->bytes, byte, size);
 
@@ -4886,7 +5344,7 @@ dtn_cbor *dtn_cbor_utf8(const uint8_t *buffer, size_t size) {
     if (buffer) {
 
         self->nbr_uint = size;
-        self->bytes = calloc(size, sizeof(uint8_t));
+        self->bytes = cbor_data_alloc(self, size);
         if (!self->bytes)
             goto error;
 
@@ -4938,8 +5396,9 @@ bool dtn_cbor_set_utf8(dtn_cbor *self, const uint8_t *buffer, size_t size) {
     if (!dtn_utf8_validate_sequence(buffer, size))
         goto error;
 
-    self->bytes = dtn_data_pointer_free(self->bytes);
-    self->bytes = calloc(size, sizeof(uint8_t));
+    cbor_touch(self);
+    cbor_data_free(self);
+    self->bytes = cbor_data_alloc(self, size);
     if (!self->bytes)
         goto error;
     self->nbr_uint = size;
@@ -5049,6 +5508,7 @@ bool dtn_cbor_set_uint(dtn_cbor *self, uint64_t value) {
 
     if (!self || self->type != DTN_CBOR_UINT64)
         return false;
+    cbor_touch(self);
     self->nbr_uint = value;
     return true;
 }
@@ -5095,6 +5555,7 @@ bool dtn_cbor_set_int(dtn_cbor *self, int64_t value) {
     if (value > 0)
         return false;
 
+    cbor_touch(self);
     self->nbr_int = value;
     return true;
 }
@@ -5146,7 +5607,8 @@ bool dtn_cbor_set_time(dtn_cbor *self, const char *timestamp) {
     if (!self || self->type != DTN_CBOR_DATE_TIME)
         return false;
 
-    self->string = dtn_data_pointer_free(self->string);
+    cbor_touch(self);
+    cbor_data_free(self);
 
     if (timestamp) {
         self->string = dtn_string_dup(timestamp);
@@ -5192,6 +5654,7 @@ bool dtn_cbor_set_time_epoch(dtn_cbor *self, uint64_t value) {
 
     if (!self || self->type != DTN_CBOR_DATE_TIME_EPOCH)
         return false;
+    cbor_touch(self);
     self->nbr_uint = value;
     return true;
 }
@@ -5250,7 +5713,8 @@ bool dtn_cbor_set_ubignum(dtn_cbor *self, const char *string) {
     if (!self || self->type != DTN_CBOR_UBIGNUM)
         goto error;
 
-    self->string = dtn_data_pointer_free(self->string);
+    cbor_touch(self);
+    cbor_data_free(self);
     if (string) {
         self->string = dtn_string_dup(string);
         self->nbr_uint = strlen(self->string);
@@ -5308,7 +5772,8 @@ bool dtn_cbor_set_ibignum(dtn_cbor *self, const char *string) {
     if (!self || self->type != DTN_CBOR_IBIGNUM)
         goto error;
 
-    self->string = dtn_data_pointer_free(self->string);
+    cbor_touch(self);
+    cbor_data_free(self);
     if (string) {
         self->string = dtn_string_dup(string);
         self->nbr_uint = strlen(self->string);
@@ -5331,6 +5796,7 @@ dtn_cbor *dtn_cbor_dec_fraction(dtn_cbor *array) {
         if (array->type != DTN_CBOR_ARRAY)
             goto error;
         self->data = array;
+        cbor_adopt(self, array);
     }
 
     return self;
@@ -5369,8 +5835,10 @@ bool dtn_cbor_set_dec_fraction(dtn_cbor *self, dtn_cbor *array) {
     if (array->type != DTN_CBOR_ARRAY)
         goto error;
 
+    cbor_touch(self);
     self->data = cbor_free(self->data);
     self->data = array;
+    cbor_adopt(self, array);
     return true;
 error:
     return false;
@@ -5388,6 +5856,7 @@ dtn_cbor *dtn_cbor_bigfloat(dtn_cbor *array) {
         if (array->type != DTN_CBOR_ARRAY)
             goto error;
         self->data = array;
+        cbor_adopt(self, array);
     }
 
     return self;
@@ -5426,8 +5895,10 @@ bool dtn_cbor_set_bigfloat(dtn_cbor *self, dtn_cbor *array) {
     if (array->type != DTN_CBOR_ARRAY)
         goto error;
 
+    cbor_touch(self);
     self->data = cbor_free(self->data);
     self->data = array;
+    cbor_adopt(self, array);
     return true;
 error:
     return false;
@@ -5496,6 +5967,7 @@ bool dtn_cbor_set_tag(dtn_cbor *self, uint64_t tag) {
 
     if (!self || self->type != DTN_CBOR_TAG)
         return false;
+    cbor_touch(self);
     self->tag = tag;
     return true;
 }
@@ -5506,8 +5978,10 @@ bool dtn_cbor_set_tag_data(dtn_cbor *self, dtn_cbor *data) {
 
     if (!self || self->type != DTN_CBOR_TAG)
         return false;
+    cbor_touch(self);
     self->data = cbor_free(self->data);
     self->data = data;
+    cbor_adopt(self, data);
     return true;
 }
 
@@ -5517,6 +5991,7 @@ bool dtn_cbor_set_tag_value(dtn_cbor *self, uint64_t val) {
 
     if (!self || self->type != DTN_CBOR_TAG)
         return false;
+    cbor_touch(self);
     self->nbr_uint = val;
     return true;
 }
@@ -5569,6 +6044,7 @@ bool dtn_cbor_set_simple(dtn_cbor *self, uint64_t nbr) {
 
     if (!self || self->type != DTN_CBOR_SIMPLE)
         return false;
+    cbor_touch(self);
     self->tag = nbr;
     return true;
 }
@@ -5579,6 +6055,7 @@ bool dtn_cbor_set_simple_value(dtn_cbor *self, uint64_t nbr) {
 
     if (!self || self->type != DTN_CBOR_SIMPLE)
         return false;
+    cbor_touch(self);
     self->nbr_uint = nbr;
     return true;
 }
@@ -5619,6 +6096,7 @@ bool dtn_cbor_set_float(dtn_cbor *self, float nbr) {
 
     if (!self || self->type != DTN_CBOR_FLOAT)
         return false;
+    cbor_touch(self);
     self->nbr_float = nbr;
     return true;
 }
@@ -5659,6 +6137,7 @@ bool dtn_cbor_set_double(dtn_cbor *self, double nbr) {
 
     if (!self || self->type != DTN_CBOR_DOUBLE)
         return false;
+    cbor_touch(self);
     self->nbr_double = nbr;
     return true;
 }
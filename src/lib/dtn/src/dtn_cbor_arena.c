@@ -0,0 +1,307 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_cbor_arena.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_cbor_arena.h"
+
+#include <dtn_base/dtn_registered_cache.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DTN_CBOR_ARENA_MAGIC_BYTE 0xa4e4
+#define DTN_CBOR_ARENA_ALIGN 16
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct arena_chunk {
+
+    struct arena_chunk *next;
+    size_t size;
+    size_t pos;
+
+    _Alignas(DTN_CBOR_ARENA_ALIGN) uint8_t data[];
+
+} arena_chunk;
+
+/*----------------------------------------------------------------------------*/
+
+struct dtn_cbor_arena {
+
+    uint16_t magic_byte;
+    dtn_cbor_arena_config config;
+
+    arena_chunk *chunks; // head is the chunk to allocate from
+    size_t used;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_registered_cache *g_cache = NULL;
+static _Thread_local dtn_cbor_arena *g_active = NULL;
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static arena_chunk *chunk_create(size_t size) {
+
+    arena_chunk *chunk = calloc(1, sizeof(arena_chunk) + size);
+    if (!chunk)
+        return NULL;
+
+    chunk->size = size;
+    return chunk;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void chunks_free(arena_chunk *chunk) {
+
+    while (chunk) {
+        arena_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_cbor_arena *dtn_cbor_arena_create(dtn_cbor_arena_config config) {
+
+    if (0 == config.chunk_size)
+        config.chunk_size = DTN_CBOR_ARENA_DEFAULT_CHUNK_SIZE;
+
+    dtn_cbor_arena *self = dtn_registered_cache_get(g_cache);
+
+    if (!self) {
+
+        self = calloc(1, sizeof(dtn_cbor_arena));
+        if (!self)
+            goto error;
+
+        self->magic_byte = DTN_CBOR_ARENA_MAGIC_BYTE;
+    }
+
+    self->config = config;
+    return self;
+error:
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_cbor_arena *dtn_cbor_arena_cast(const void *data) {
+
+    if (!data)
+        return NULL;
+
+    if (*(uint16_t *)data != DTN_CBOR_ARENA_MAGIC_BYTE)
+        return NULL;
+
+    return (dtn_cbor_arena *)data;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *arena_free_uncached(void *data) {
+
+    dtn_cbor_arena *self = dtn_cbor_arena_cast(data);
+    if (!self)
+        return data;
+
+    if (g_active == self)
+        g_active = NULL;
+
+    chunks_free(self->chunks);
+    free(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void *dtn_cbor_arena_free(void *data) {
+
+    dtn_cbor_arena *self = dtn_cbor_arena_cast(data);
+    if (!self)
+        return data;
+
+    if (g_active == self)
+        g_active = NULL;
+
+    dtn_cbor_arena_reset(self);
+
+    self = dtn_registered_cache_put(g_cache, self);
+    return arena_free_uncached(self);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cbor_arena_reset(dtn_cbor_arena *self) {
+
+    if (!self)
+        return false;
+
+    if (!self->chunks)
+        goto done;
+
+    /* Keep the first standard sized chunk, dedicated chunks of big
+     * allocations are released. */
+
+    arena_chunk *keep = NULL;
+    arena_chunk *chunk = self->chunks;
+
+    while (chunk) {
+
+        arena_chunk *next = chunk->next;
+
+        if (!keep && chunk->size == self->config.chunk_size) {
+            keep = chunk;
+        } else {
+            free(chunk);
+        }
+
+        chunk = next;
+    }
+
+    if (keep) {
+        memset(keep->data, 0, keep->pos);
+        keep->pos = 0;
+        keep->next = NULL;
+    }
+
+    self->chunks = keep;
+
+done:
+    self->used = 0;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void *dtn_cbor_arena_alloc(dtn_cbor_arena *self, size_t size) {
+
+    if (!self || 0 == size)
+        goto error;
+
+    size_t aligned = (size + DTN_CBOR_ARENA_ALIGN - 1) &
+                     ~((size_t)DTN_CBOR_ARENA_ALIGN - 1);
+
+    if (aligned < size)
+        goto error;
+
+    arena_chunk *chunk = self->chunks;
+
+    if (aligned > self->config.chunk_size / 2) {
+
+        // dedicated chunk behind the head, the head stays in use
+
+        chunk = chunk_create(aligned);
+        if (!chunk)
+            goto error;
+
+        if (self->chunks) {
+            chunk->next = self->chunks->next;
+            self->chunks->next = chunk;
+        } else {
+            self->chunks = chunk;
+        }
+
+    } else if (!chunk || chunk->size - chunk->pos < aligned) {
+
+        chunk = chunk_create(self->config.chunk_size);
+        if (!chunk)
+            goto error;
+
+        chunk->next = self->chunks;
+        self->chunks = chunk;
+    }
+
+    /* Chunks are zeroed on create and reset, so memory handed out is
+     * always zeroed. */
+
+    void *ptr = chunk->data + chunk->pos;
+    chunk->pos += aligned;
+    self->used += aligned;
+    return ptr;
+error:
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t dtn_cbor_arena_used(const dtn_cbor_arena *self) {
+
+    if (!self)
+        return 0;
+
+    return self->used;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ACTIVATION
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_cbor_arena *dtn_cbor_arena_activate(dtn_cbor_arena *self) {
+
+    dtn_cbor_arena *previous = g_active;
+    g_active = self;
+    return previous;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_cbor_arena *dtn_cbor_arena_active() { return g_active; }
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CACHING
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+void dtn_cbor_arena_enable_caching(size_t capacity) {
+
+    dtn_registered_cache_config cfg = {
+
+        .capacity = capacity,
+        .item_free = arena_free_uncached,
+
+    };
+
+    g_cache = dtn_registered_cache_extend("cbor_arena", cfg);
+}
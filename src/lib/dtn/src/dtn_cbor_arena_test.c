@@ -0,0 +1,245 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_cbor_arena_test.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "dtn_cbor_arena.c"
+#include <dtn_base/testrun.h>
+
+#include "../include/dtn_cbor.h"
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CASES                                                      #CASES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int test_dtn_cbor_arena_create() {
+
+    dtn_cbor_arena *arena = dtn_cbor_arena_create((dtn_cbor_arena_config){0});
+    testrun(arena);
+    testrun(dtn_cbor_arena_cast(arena));
+    testrun(arena->config.chunk_size == DTN_CBOR_ARENA_DEFAULT_CHUNK_SIZE);
+    testrun(NULL == arena->chunks);
+    testrun(0 == dtn_cbor_arena_used(arena));
+
+    testrun(NULL == dtn_cbor_arena_free(arena));
+
+    arena = dtn_cbor_arena_create((dtn_cbor_arena_config){.chunk_size = 100});
+    testrun(arena->config.chunk_size == 100);
+    testrun(NULL == dtn_cbor_arena_free(arena));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_arena_cast() {
+
+    uint16_t data = 0;
+
+    testrun(!dtn_cbor_arena_cast(NULL));
+    testrun(!dtn_cbor_arena_cast(&data));
+
+    data = DTN_CBOR_ARENA_MAGIC_BYTE;
+    testrun(dtn_cbor_arena_cast(&data));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_arena_free() {
+
+    dtn_cbor_arena *arena = dtn_cbor_arena_create((dtn_cbor_arena_config){0});
+
+    testrun(NULL == dtn_cbor_arena_free(NULL));
+    testrun(dtn_cbor_arena_alloc(arena, 100));
+    testrun(dtn_cbor_arena_alloc(arena, 10000));
+
+    testrun(NULL == dtn_cbor_arena_activate(arena));
+    testrun(arena == dtn_cbor_arena_active());
+    testrun(NULL == dtn_cbor_arena_free(arena));
+    testrun(NULL == dtn_cbor_arena_active());
+
+    // cached arenas are reset and reused
+
+    dtn_cbor_arena_enable_caching(2);
+
+    arena = dtn_cbor_arena_create((dtn_cbor_arena_config){0});
+    testrun(dtn_cbor_arena_alloc(arena, 100));
+    testrun(dtn_cbor_arena_alloc(arena, 10000));
+
+    dtn_cbor_arena *cached = arena;
+    testrun(NULL == dtn_cbor_arena_free(arena));
+
+    arena = dtn_cbor_arena_create((dtn_cbor_arena_config){0});
+    testrun(arena == cached);
+    testrun(0 == dtn_cbor_arena_used(arena));
+    testrun(arena->chunks);
+    testrun(NULL == arena->chunks->next);
+    testrun(0 == arena->chunks->pos);
+    testrun(NULL == dtn_cbor_arena_free(arena));
+
+    dtn_registered_cache_free_all();
+    g_cache = NULL;
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_arena_reset() {
+
+    dtn_cbor_arena *arena =
+        dtn_cbor_arena_create((dtn_cbor_arena_config){.chunk_size = 64});
+
+    testrun(!dtn_cbor_arena_reset(NULL));
+    testrun(dtn_cbor_arena_reset(arena));
+
+    uint8_t *ptr = dtn_cbor_arena_alloc(arena, 32);
+    testrun(ptr);
+    memset(ptr, 0xff, 32);
+
+    testrun(dtn_cbor_arena_alloc(arena, 32));
+    testrun(dtn_cbor_arena_alloc(arena, 32));
+    testrun(dtn_cbor_arena_alloc(arena, 100));
+    testrun(dtn_cbor_arena_used(arena) == 3 * 32 + 112);
+
+    testrun(dtn_cbor_arena_reset(arena));
+    testrun(0 == dtn_cbor_arena_used(arena));
+    testrun(arena->chunks);
+    testrun(NULL == arena->chunks->next);
+
+    // memory is zeroed on reuse
+    uint8_t *reuse = dtn_cbor_arena_alloc(arena, 32);
+    testrun(reuse);
+    for (size_t i = 0; i < 32; i++) {
+        testrun(0 == reuse[i]);
+    }
+
+    testrun(NULL == dtn_cbor_arena_free(arena));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_arena_alloc() {
+
+    dtn_cbor_arena *arena =
+        dtn_cbor_arena_create((dtn_cbor_arena_config){.chunk_size = 64});
+
+    testrun(!dtn_cbor_arena_alloc(NULL, 1));
+    testrun(!dtn_cbor_arena_alloc(arena, 0));
+    testrun(!dtn_cbor_arena_alloc(arena, SIZE_MAX));
+
+    uint8_t *one = dtn_cbor_arena_alloc(arena, 1);
+    uint8_t *two = dtn_cbor_arena_alloc(arena, 17);
+    testrun(one);
+    testrun(two);
+    testrun(0 == ((uintptr_t)one % DTN_CBOR_ARENA_ALIGN));
+    testrun(0 == ((uintptr_t)two % DTN_CBOR_ARENA_ALIGN));
+    testrun(two == one + 16);
+    testrun(48 == dtn_cbor_arena_used(arena));
+
+    arena_chunk *head = arena->chunks;
+
+    // big allocation gets a dedicated chunk, head stays in use
+    uint8_t *big = dtn_cbor_arena_alloc(arena, 1000);
+    testrun(big);
+    testrun(head == arena->chunks);
+    testrun(arena->chunks->next->size == 1008);
+
+    uint8_t *three = dtn_cbor_arena_alloc(arena, 16);
+    testrun(three == two + 32);
+
+    // head exhausted, new chunk
+    uint8_t *four = dtn_cbor_arena_alloc(arena, 16);
+    testrun(four);
+    testrun(head != arena->chunks);
+    testrun(head == arena->chunks->next);
+
+    testrun(NULL == dtn_cbor_arena_free(arena));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_arena_activate() {
+
+    dtn_cbor_arena *arena = dtn_cbor_arena_create((dtn_cbor_arena_config){0});
+
+    testrun(NULL == dtn_cbor_arena_active());
+    testrun(NULL == dtn_cbor_arena_activate(arena));
+
+    // items and their content are allocated within the arena
+    dtn_cbor *item = dtn_cbor_utf8((uint8_t *)"test", 4);
+    testrun(item);
+    testrun(dtn_cbor_arena_used(arena) > 0);
+
+    size_t used = dtn_cbor_arena_used(arena);
+
+    testrun(NULL == dtn_cbor_free(item));
+    testrun(used == dtn_cbor_arena_used(arena));
+
+    testrun(arena == dtn_cbor_arena_activate(NULL));
+    testrun(NULL == dtn_cbor_arena_active());
+
+    item = dtn_cbor_utf8((uint8_t *)"test", 4);
+    testrun(used == dtn_cbor_arena_used(arena));
+    testrun(NULL == dtn_cbor_free(item));
+
+    testrun(NULL == dtn_cbor_arena_free(arena));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int all_tests() {
+
+    testrun_init();
+    testrun_test(test_dtn_cbor_arena_create);
+    testrun_test(test_dtn_cbor_arena_cast);
+    testrun_test(test_dtn_cbor_arena_free);
+    testrun_test(test_dtn_cbor_arena_reset);
+    testrun_test(test_dtn_cbor_arena_alloc);
+    testrun_test(test_dtn_cbor_arena_activate);
+
+    return testrun_counter;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST EXECUTION                                                  #EXEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+testrun_run(all_tests);
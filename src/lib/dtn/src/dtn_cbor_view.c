@@ -0,0 +1,530 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_cbor_view.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_cbor_view.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DTN_CBOR_VIEW_DEFAULT_CAPACITY 32
+
+/*----------------------------------------------------------------------------*/
+
+struct open_container {
+
+    size_t index;
+    uint64_t open;   // items still expected, UINT64_MAX for indefinite
+    uint64_t childs; // number of direct childs decoded
+};
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+bool dtn_cbor_view_init(dtn_cbor_view *view, dtn_cbor_view_item *items,
+                        size_t capacity) {
+
+    if (!view)
+        goto error;
+
+    *view = (dtn_cbor_view){0};
+
+    if (items) {
+
+        if (0 == capacity)
+            goto error;
+
+        view->items = items;
+        view->capacity = capacity;
+        view->owned = false;
+
+    } else {
+
+        view->owned = true;
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cbor_view_clear(dtn_cbor_view *view) {
+
+    if (!view)
+        goto error;
+
+    if (view->owned) {
+        free(view->items);
+        view->items = NULL;
+        view->capacity = 0;
+    }
+
+    view->count = 0;
+    return true;
+error:
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      DECODER
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static dtn_cbor_match read_head(const uint8_t *buffer, size_t size,
+                                uint8_t *info, uint64_t *value,
+                                size_t *length) {
+
+    if (size < 1)
+        return DTN_CBOR_MATCH_PARTIAL;
+
+    *info = buffer[0] & 0x1F;
+    *value = 0;
+
+    size_t bytes = 0;
+
+    switch (*info) {
+
+    case 0x18:
+        bytes = 1;
+        break;
+    case 0x19:
+        bytes = 2;
+        break;
+    case 0x1A:
+        bytes = 4;
+        break;
+    case 0x1B:
+        bytes = 8;
+        break;
+    case 0x1C:
+    case 0x1D:
+    case 0x1E:
+        return DTN_CBOR_NO_MATCH;
+    case 0x1F:
+        // indefinite length, checked by caller
+        break;
+    default:
+        *value = *info;
+        break;
+    }
+
+    if (size < bytes + 1)
+        return DTN_CBOR_MATCH_PARTIAL;
+
+    for (size_t i = 1; i <= bytes; i++) {
+        *value = (*value << 8) | buffer[i];
+    }
+
+    *length = bytes + 1;
+    return DTN_CBOR_MATCH_FULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_cbor_view_item *add_item(dtn_cbor_view *view) {
+
+    if (view->count == view->capacity) {
+
+        if (!view->owned)
+            goto error;
+
+        size_t capacity = view->capacity * 2;
+        if (0 == capacity)
+            capacity = DTN_CBOR_VIEW_DEFAULT_CAPACITY;
+
+        dtn_cbor_view_item *items =
+            realloc(view->items, capacity * sizeof(dtn_cbor_view_item));
+        if (!items)
+            goto error;
+
+        view->items = items;
+        view->capacity = capacity;
+    }
+
+    if (view->count >= UINT32_MAX)
+        goto error;
+
+    dtn_cbor_view_item *item = &view->items[view->count];
+    *item = (dtn_cbor_view_item){0};
+    view->count++;
+    return item;
+error:
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_cbor_type simple_type(uint8_t info) {
+
+    switch (info) {
+
+    case 0x14:
+        return DTN_CBOR_FALSE;
+    case 0x15:
+        return DTN_CBOR_TRUE;
+    case 0x16:
+        return DTN_CBOR_NULL;
+    case 0x17:
+        return DTN_CBOR_UNDEF;
+    case 0x19:
+    case 0x1A:
+        return DTN_CBOR_FLOAT;
+    case 0x1B:
+        return DTN_CBOR_DOUBLE;
+    default:
+        break;
+    }
+
+    return DTN_CBOR_SIMPLE;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_cbor_match dtn_cbor_view_decode(const uint8_t *buffer, size_t size,
+                                    dtn_cbor_view *view, uint8_t **next) {
+
+    struct open_container stack[DTN_CBOR_VIEW_MAX_DEPTH];
+    size_t depth = 0;
+    size_t pos = 0;
+
+    dtn_cbor_match match = DTN_CBOR_NO_MATCH;
+
+    if (!buffer || !view || !next)
+        goto error;
+
+    *next = (uint8_t *)buffer;
+    view->count = 0;
+
+    do {
+
+        if (pos == size) {
+            match = DTN_CBOR_MATCH_PARTIAL;
+            goto error;
+        }
+
+        const uint8_t *ptr = buffer + pos;
+
+        if (0xFF == ptr[0]) {
+
+            // break of an indefinite length container
+            if (0 == depth || UINT64_MAX != stack[depth - 1].open)
+                goto error;
+
+            stack[depth - 1].open = 0;
+            pos++;
+
+        } else {
+
+            uint8_t major = ptr[0] >> 5;
+            uint8_t info = 0;
+            uint64_t value = 0;
+            size_t length = 0;
+
+            match = read_head(ptr, size - pos, &info, &value, &length);
+            if (DTN_CBOR_MATCH_FULL != match)
+                goto error;
+
+            match = DTN_CBOR_NO_MATCH;
+
+            dtn_cbor_view_item *item = add_item(view);
+            if (!item)
+                goto error;
+
+            item->start = ptr;
+            item->value = value;
+
+            bool container = false;
+            uint64_t open = value;
+
+            switch (major) {
+
+            case 0:
+                item->type = DTN_CBOR_UINT64;
+                break;
+
+            case 1:
+                item->type = DTN_CBOR_INT64;
+                break;
+
+            case 2:
+            case 3:
+
+                if (0x1F == info)
+                    goto error;
+
+                item->type = (2 == major) ? DTN_CBOR_STRING : DTN_CBOR_UTF8;
+
+                if (size - pos - length < value) {
+                    match = DTN_CBOR_MATCH_PARTIAL;
+                    goto error;
+                }
+
+                item->data = ptr + length;
+                length += value;
+                break;
+
+            case 4:
+            case 5:
+
+                item->type = (4 == major) ? DTN_CBOR_ARRAY : DTN_CBOR_MAP;
+                container = true;
+
+                if (0x1F == info) {
+                    open = UINT64_MAX;
+                } else if (5 == major) {
+                    if (value > UINT64_MAX / 2 - 1)
+                        goto error;
+                    open = 2 * value;
+                }
+                break;
+
+            case 6:
+
+                item->type = DTN_CBOR_TAG;
+                container = true;
+                open = 1;
+                break;
+
+            case 7:
+
+                if (0x1F == info)
+                    goto error;
+
+                item->type = simple_type(info);
+                break;
+            }
+
+            pos += length;
+            item->size = length;
+            item->next = view->count;
+
+            if (container && 0 != open) {
+
+                if (DTN_CBOR_VIEW_MAX_DEPTH == depth)
+                    goto error;
+
+                stack[depth] = (struct open_container){
+                    .index = view->count - 1, .open = open, .childs = 0};
+
+                depth++;
+                continue;
+            }
+
+            if (depth > 0) {
+                stack[depth - 1].childs++;
+                if (UINT64_MAX != stack[depth - 1].open)
+                    stack[depth - 1].open--;
+            }
+        }
+
+        // close all completed containers
+
+        while (depth > 0 && 0 == stack[depth - 1].open) {
+
+            depth--;
+
+            dtn_cbor_view_item *item = &view->items[stack[depth].index];
+
+            item->size = (buffer + pos) - item->start;
+            item->next = view->count;
+
+            if (DTN_CBOR_MAP == item->type)
+                item->value = stack[depth].childs / 2;
+            else if (DTN_CBOR_ARRAY == item->type)
+                item->value = stack[depth].childs;
+
+            if (DTN_CBOR_MAP == item->type && (stack[depth].childs % 2))
+                goto error;
+
+            if (depth > 0) {
+                stack[depth - 1].childs++;
+                if (UINT64_MAX != stack[depth - 1].open)
+                    stack[depth - 1].open--;
+            }
+        }
+
+    } while (depth > 0);
+
+    *next = (uint8_t *)buffer + pos;
+    return DTN_CBOR_MATCH_FULL;
+error:
+    if (view)
+        view->count = 0;
+    return match;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ITEM ACCESS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+const dtn_cbor_view_item *dtn_cbor_view_get(const dtn_cbor_view *view,
+                                            size_t index) {
+
+    if (!view || index >= view->count)
+        return NULL;
+
+    return &view->items[index];
+}
+
+/*----------------------------------------------------------------------------*/
+
+int64_t dtn_cbor_view_child(const dtn_cbor_view *view, size_t index,
+                            uint64_t nbr) {
+
+    const dtn_cbor_view_item *item = dtn_cbor_view_get(view, index);
+    if (!item)
+        goto error;
+
+    uint64_t childs = 0;
+
+    switch (item->type) {
+
+    case DTN_CBOR_ARRAY:
+        childs = item->value;
+        break;
+    case DTN_CBOR_MAP:
+        childs = 2 * item->value;
+        break;
+    case DTN_CBOR_TAG:
+        childs = 1;
+        break;
+    default:
+        goto error;
+    }
+
+    if (nbr >= childs)
+        goto error;
+
+    size_t child = index + 1;
+
+    for (uint64_t i = 0; i < nbr; i++) {
+        child = view->items[child].next;
+    }
+
+    return (int64_t)child;
+error:
+    return -1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_cbor_view_count(const dtn_cbor_view_item *item) {
+
+    if (!item)
+        return 0;
+
+    switch (item->type) {
+
+    case DTN_CBOR_ARRAY:
+    case DTN_CBOR_MAP:
+        return item->value;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cbor_view_get_uint(const dtn_cbor_view_item *item, uint64_t *out) {
+
+    if (!item || !out || DTN_CBOR_UINT64 != item->type)
+        return false;
+
+    *out = item->value;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cbor_view_get_int(const dtn_cbor_view_item *item, int64_t *out) {
+
+    if (!item || !out)
+        return false;
+
+    switch (item->type) {
+
+    case DTN_CBOR_UINT64:
+
+        if (item->value > INT64_MAX)
+            return false;
+
+        *out = (int64_t)item->value;
+        return true;
+
+    case DTN_CBOR_INT64:
+
+        if (item->value > INT64_MAX)
+            return false;
+
+        *out = -1 - (int64_t)item->value;
+        return true;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cbor_view_get_string(const dtn_cbor_view_item *item,
+                              const uint8_t **data, size_t *size) {
+
+    if (!item || !data || !size)
+        return false;
+
+    switch (item->type) {
+
+    case DTN_CBOR_STRING:
+    case DTN_CBOR_UTF8:
+        break;
+    default:
+        return false;
+    }
+
+    *data = item->data;
+    *size = item->value;
+    return true;
+}
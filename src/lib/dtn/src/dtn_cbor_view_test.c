@@ -0,0 +1,300 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_cbor_view_test.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "dtn_cbor_view.c"
+#include <dtn_base/testrun.h>
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CASES                                                      #CASES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int test_dtn_cbor_view_init() {
+
+    dtn_cbor_view view = {0};
+    dtn_cbor_view_item items[10] = {0};
+
+    testrun(!dtn_cbor_view_init(NULL, NULL, 0));
+    testrun(!dtn_cbor_view_init(&view, items, 0));
+
+    testrun(dtn_cbor_view_init(&view, items, 10));
+    testrun(view.items == items);
+    testrun(view.capacity == 10);
+    testrun(!view.owned);
+
+    testrun(dtn_cbor_view_init(&view, NULL, 0));
+    testrun(view.items == NULL);
+    testrun(view.owned);
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_view_clear() {
+
+    dtn_cbor_view view = {0};
+    dtn_cbor_view_item items[10] = {0};
+    uint8_t *next = NULL;
+    uint8_t buffer[] = {0x83, 0x01, 0x02, 0x03};
+
+    testrun(!dtn_cbor_view_clear(NULL));
+
+    testrun(dtn_cbor_view_init(&view, items, 10));
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_cbor_view_decode(buffer, sizeof(buffer), &view, &next));
+    testrun(view.count == 4);
+    testrun(dtn_cbor_view_clear(&view));
+    testrun(view.count == 0);
+    testrun(view.items == items);
+
+    testrun(dtn_cbor_view_init(&view, NULL, 0));
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_cbor_view_decode(buffer, sizeof(buffer), &view, &next));
+    testrun(view.items);
+    testrun(dtn_cbor_view_clear(&view));
+    testrun(view.items == NULL);
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_view_decode() {
+
+    dtn_cbor_view view = {0};
+    dtn_cbor_view_item items[6] = {0};
+    uint8_t *next = NULL;
+    const uint8_t *data = NULL;
+    size_t size = 0;
+    uint64_t nbr = 0;
+    int64_t inbr = 0;
+
+    testrun(dtn_cbor_view_init(&view, items, 6));
+
+    // [1, h'616263', [-2, "xy"]] 0xff
+    uint8_t buffer[] = {0x83, 0x01, 0x43, 'a', 'b', 'c',
+                        0x82, 0x21, 0x62, 'x', 'y', 0xff};
+
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_cbor_view_decode(NULL, sizeof(buffer), &view, &next));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_cbor_view_decode(buffer, sizeof(buffer), NULL, &next));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_cbor_view_decode(buffer, sizeof(buffer), &view, NULL));
+
+    for (size_t i = 0; i < 11; i++) {
+
+        testrun(DTN_CBOR_MATCH_PARTIAL ==
+                dtn_cbor_view_decode(buffer, i, &view, &next));
+        testrun(0 == view.count);
+    }
+
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_cbor_view_decode(buffer, sizeof(buffer), &view, &next));
+    testrun(next == buffer + 11);
+    testrun(6 == view.count);
+
+    testrun(view.items[0].type == DTN_CBOR_ARRAY);
+    testrun(view.items[0].value == 3);
+    testrun(view.items[0].size == 11);
+    testrun(view.items[0].next == 6);
+    testrun(3 == dtn_cbor_view_count(&view.items[0]));
+
+    testrun(dtn_cbor_view_get_uint(dtn_cbor_view_get(&view, 1), &nbr));
+    testrun(1 == nbr);
+
+    testrun(dtn_cbor_view_get_string(dtn_cbor_view_get(&view, 2), &data, &size));
+    testrun(view.items[2].type == DTN_CBOR_STRING);
+    testrun(3 == size);
+    testrun(data == buffer + 3);
+
+    testrun(view.items[3].type == DTN_CBOR_ARRAY);
+    testrun(view.items[3].next == 6);
+
+    testrun(dtn_cbor_view_get_int(dtn_cbor_view_get(&view, 4), &inbr));
+    testrun(-2 == inbr);
+
+    testrun(dtn_cbor_view_get_string(dtn_cbor_view_get(&view, 5), &data, &size));
+    testrun(view.items[5].type == DTN_CBOR_UTF8);
+    testrun(2 == size);
+    testrun(0 == memcmp(data, "xy", 2));
+    testrun(!dtn_cbor_view_get(&view, 6));
+
+    // storage too small
+    testrun(dtn_cbor_view_init(&view, items, 5));
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_cbor_view_decode(buffer, sizeof(buffer), &view, &next));
+
+    // indefinite length array with nested map
+    uint8_t indef[] = {0x9f, 0x01, 0xa1, 0x01, 0x41, 'z', 0xff};
+
+    testrun(dtn_cbor_view_init(&view, NULL, 0));
+
+    for (size_t i = 0; i < sizeof(indef); i++) {
+
+        testrun(DTN_CBOR_MATCH_PARTIAL ==
+                dtn_cbor_view_decode(indef, i, &view, &next));
+    }
+
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_cbor_view_decode(indef, sizeof(indef), &view, &next));
+    testrun(next == indef + sizeof(indef));
+    testrun(5 == view.count);
+    testrun(view.items[0].value == 2);
+    testrun(view.items[0].size == sizeof(indef));
+    testrun(view.items[2].type == DTN_CBOR_MAP);
+    testrun(view.items[2].value == 1);
+    testrun(view.items[2].size == 4);
+
+    // invalid break and unsupported indefinite string
+    uint8_t invalid[] = {0x82, 0x01, 0xff};
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_cbor_view_decode(invalid, sizeof(invalid), &view, &next));
+    invalid[0] = 0x5f;
+    testrun(DTN_CBOR_NO_MATCH ==
+            dtn_cbor_view_decode(invalid, sizeof(invalid), &view, &next));
+
+    // incomplete string header
+    uint8_t header[] = {0x59, 0x01, 0x00};
+    testrun(DTN_CBOR_MATCH_PARTIAL ==
+            dtn_cbor_view_decode(header, 2, &view, &next));
+    testrun(DTN_CBOR_MATCH_PARTIAL ==
+            dtn_cbor_view_decode(header, 3, &view, &next));
+
+    testrun(dtn_cbor_view_clear(&view));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_view_child() {
+
+    dtn_cbor_view view = {0};
+    uint8_t *next = NULL;
+
+    // [[1, 2], {1: [3]}, 4]
+    uint8_t buffer[] = {0x83, 0x82, 0x01, 0x02, 0xa1, 0x01, 0x81, 0x03, 0x04};
+
+    testrun(dtn_cbor_view_init(&view, NULL, 0));
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_cbor_view_decode(buffer, sizeof(buffer), &view, &next));
+
+    testrun(-1 == dtn_cbor_view_child(NULL, 0, 0));
+    testrun(-1 == dtn_cbor_view_child(&view, 2, 0));
+    testrun(-1 == dtn_cbor_view_child(&view, 0, 3));
+
+    testrun(1 == dtn_cbor_view_child(&view, 0, 0));
+    testrun(4 == dtn_cbor_view_child(&view, 0, 1));
+    testrun(8 == dtn_cbor_view_child(&view, 0, 2));
+
+    testrun(3 == dtn_cbor_view_child(&view, 1, 1));
+    testrun(5 == dtn_cbor_view_child(&view, 4, 0));
+    testrun(6 == dtn_cbor_view_child(&view, 4, 1));
+    testrun(-1 == dtn_cbor_view_child(&view, 4, 2));
+
+    testrun(dtn_cbor_view_clear(&view));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_view_get_int() {
+
+    dtn_cbor_view_item item = {0};
+    int64_t nbr = 0;
+
+    testrun(!dtn_cbor_view_get_int(NULL, &nbr));
+    testrun(!dtn_cbor_view_get_int(&item, &nbr));
+
+    item.type = DTN_CBOR_UINT64;
+    item.value = 5;
+    testrun(dtn_cbor_view_get_int(&item, &nbr));
+    testrun(5 == nbr);
+
+    item.type = DTN_CBOR_INT64;
+    testrun(dtn_cbor_view_get_int(&item, &nbr));
+    testrun(-6 == nbr);
+
+    item.value = UINT64_MAX;
+    testrun(!dtn_cbor_view_get_int(&item, &nbr));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cbor_view_get_string() {
+
+    uint8_t buffer[] = {0x62, 'a', 'b'};
+    dtn_cbor_view_item item = {0};
+    const uint8_t *data = NULL;
+    size_t size = 0;
+
+    testrun(!dtn_cbor_view_get_string(NULL, &data, &size));
+    testrun(!dtn_cbor_view_get_string(&item, &data, &size));
+
+    item = (dtn_cbor_view_item){
+        .type = DTN_CBOR_UTF8, .start = buffer, .data = buffer + 1, .value = 2};
+
+    testrun(!dtn_cbor_view_get_string(&item, NULL, &size));
+    testrun(dtn_cbor_view_get_string(&item, &data, &size));
+    testrun(data == buffer + 1);
+    testrun(size == 2);
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int all_tests() {
+
+    testrun_init();
+    testrun_test(test_dtn_cbor_view_init);
+    testrun_test(test_dtn_cbor_view_clear);
+    testrun_test(test_dtn_cbor_view_decode);
+    testrun_test(test_dtn_cbor_view_child);
+    testrun_test(test_dtn_cbor_view_get_int);
+    testrun_test(test_dtn_cbor_view_get_string);
+
+    return testrun_counter;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST EXECUTION                                                  #EXEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+testrun_run(all_tests);
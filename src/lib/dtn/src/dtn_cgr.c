@@ -0,0 +1,1128 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_cgr.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_cgr.h"
+
+#include <dtn_base/dtn_data_function.h>
+#include <dtn_base/dtn_dict.h>
+#include <dtn_base/dtn_item_json.h>
+#include <dtn_base/dtn_log.h>
+#include <dtn_base/dtn_string.h>
+#include <dtn_base/dtn_thread_lock.h>
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NONE UINT32_MAX
+#define NEVER UINT64_MAX
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Contact {
+
+    uint32_t from;
+    uint32_t to;
+
+    uint64_t start;
+    uint64_t end;
+    uint64_t rate;
+    uint64_t owlt;
+
+    bool removed;
+    bool suppressed; // excluded while searching alternative routes
+
+} Contact;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Route {
+
+    uint32_t neighbor;
+    uint64_t arrival;
+
+    size_t hops;
+    uint32_t contacts[DTN_CGR_HOPS_MAX]; // first hop first
+
+} Route;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Node {
+
+    char name[DTN_CGR_NODE_MAX];
+
+    bool has_hop;
+    dtn_routing_info hop;
+
+    // contacts from node
+    uint32_t *out;
+    size_t out_count;
+    size_t out_size;
+
+    // search state
+    uint64_t arrival;
+    uint32_t via;
+
+    // routes to node
+    struct {
+
+        bool valid;
+        uint64_t now;  // time of the computation
+        uint64_t size; // bundle size of the computation
+        size_t count;
+        Route routes[DTN_CGR_ROUTES_MAX];
+
+    } cache;
+
+} Node;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Plan {
+
+    dtn_dict *names; // name to node index + 1
+
+    Node *nodes;
+    size_t nodes_count;
+    size_t nodes_size;
+
+    Contact *contacts;
+    size_t contacts_count;
+    size_t contacts_size;
+
+    size_t active; // contacts not removed
+
+} Plan;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Entry {
+
+    uint64_t arrival;
+    uint32_t node;
+
+} Entry;
+
+/*----------------------------------------------------------------------------*/
+
+struct dtn_cgr {
+
+    dtn_cgr_config config;
+
+    dtn_thread_lock lock;
+    Plan plan;
+
+    // search queue of nodes, earliest arrival first
+    struct {
+
+        Entry *entries;
+        size_t count;
+        size_t size;
+
+    } queue;
+
+    struct {
+
+        uint64_t computed;
+        uint64_t cached;
+        uint64_t invalidated;
+
+    } counter;
+};
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      PLAN
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static void plan_clear(Plan *plan) {
+
+    plan->names = dtn_dict_free(plan->names);
+
+    for (size_t i = 0; i < plan->nodes_count; i++) {
+        plan->nodes[i].out = dtn_data_pointer_free(plan->nodes[i].out);
+    }
+
+    plan->nodes = dtn_data_pointer_free(plan->nodes);
+    plan->contacts = dtn_data_pointer_free(plan->contacts);
+
+    *plan = (Plan){0};
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool plan_init(Plan *plan) {
+
+    *plan = (Plan){0};
+
+    plan->names = dtn_dict_create(dtn_dict_string_key_config(255));
+    return plan->names != NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint32_t plan_node(Plan *plan, const char *name, bool create) {
+
+    if (!name || 0 == name[0] || strlen(name) >= DTN_CGR_NODE_MAX)
+        return NONE;
+
+    uintptr_t index = (uintptr_t)dtn_dict_get(plan->names, name);
+
+    if (0 != index)
+        return index - 1;
+
+    if (!create || plan->nodes_count >= NONE)
+        return NONE;
+
+    if (plan->nodes_count == plan->nodes_size) {
+
+        size_t size = plan->nodes_size ? 2 * plan->nodes_size : 16;
+
+        Node *nodes = realloc(plan->nodes, size * sizeof(Node));
+        if (!nodes)
+            return NONE;
+
+        plan->nodes = nodes;
+        plan->nodes_size = size;
+    }
+
+    char *key = dtn_string_dup(name);
+    index = plan->nodes_count + 1;
+
+    if (!key || !dtn_dict_set(plan->names, key, (void *)index, NULL)) {
+        dtn_data_pointer_free(key);
+        return NONE;
+    }
+
+    Node *node = &plan->nodes[plan->nodes_count];
+    *node = (Node){0};
+    strncpy(node->name, name, DTN_CGR_NODE_MAX - 1);
+
+    plan->nodes_count++;
+    return index - 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int64_t plan_contact(Plan *plan, dtn_cgr_contact contact) {
+
+    if (contact.end_usecs <= contact.start_usecs)
+        return -1;
+
+    uint32_t from = plan_node(plan, contact.from, true);
+    uint32_t to = plan_node(plan, contact.to, true);
+
+    if (NONE == from || NONE == to || from == to)
+        return -1;
+
+    if (plan->contacts_count >= NONE)
+        return -1;
+
+    if (plan->contacts_count == plan->contacts_size) {
+
+        size_t size = plan->contacts_size ? 2 * plan->contacts_size : 64;
+
+        Contact *contacts = realloc(plan->contacts, size * sizeof(Contact));
+        if (!contacts)
+            return -1;
+
+        plan->contacts = contacts;
+        plan->contacts_size = size;
+    }
+
+    Node *node = &plan->nodes[from];
+
+    if (node->out_count == node->out_size) {
+
+        size_t size = node->out_size ? 2 * node->out_size : 8;
+
+        uint32_t *out = realloc(node->out, size * sizeof(uint32_t));
+        if (!out)
+            return -1;
+
+        node->out = out;
+        node->out_size = size;
+    }
+
+    uint32_t id = plan->contacts_count;
+
+    plan->contacts[id] = (Contact){.from = from,
+                                   .to = to,
+                                   .start = contact.start_usecs,
+                                   .end = contact.end_usecs,
+                                   .rate = contact.rate,
+                                   .owlt = contact.owlt_usecs};
+
+    node->out[node->out_count] = id;
+    node->out_count++;
+
+    plan->contacts_count++;
+    plan->active++;
+    return id;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool plan_hop(Plan *plan, const char *name,
+                     const dtn_routing_info *hop) {
+
+    uint32_t index = plan_node(plan, name, true);
+    if (NONE == index)
+        return false;
+
+    plan->nodes[index].hop = *hop;
+    plan->nodes[index].hop.class = DTN_ROUTING_CONTACT;
+    plan->nodes[index].has_hop = true;
+    return true;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CONTACT PLAN FILE
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static uint64_t item_usecs(const dtn_item *item) {
+
+    double seconds = dtn_item_get_number(item);
+
+    if (seconds <= 0)
+        return 0;
+
+    return (uint64_t)(seconds * 1000000.0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  @returns false for a rate out of range, 0 is unlimited
+ */
+static bool item_rate(const dtn_item *item, uint64_t *rate) {
+
+    double bytes = dtn_item_get_number(item);
+
+    // !(x >= 0) to reject NaN as well
+
+    if (!(bytes >= 0) || (bytes >= (double)UINT64_MAX))
+        return false;
+
+    *rate = (uint64_t)bytes;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool read_contact(void *item, void *userdata) {
+
+    Plan *plan = (Plan *)userdata;
+    dtn_item *contact = (dtn_item *)item;
+
+    dtn_cgr_contact c = (dtn_cgr_contact){
+        .from = dtn_item_get_string(dtn_item_object_get(contact, "from")),
+        .to = dtn_item_get_string(dtn_item_object_get(contact, "to")),
+        .start_usecs = item_usecs(dtn_item_object_get(contact, "start")),
+        .end_usecs = item_usecs(dtn_item_object_get(contact, "end")),
+        .owlt_usecs = item_usecs(dtn_item_object_get(contact, "owlt"))};
+
+    if (item_rate(dtn_item_object_get(contact, "rate"), &c.rate) &&
+        (0 <= plan_contact(plan, c)))
+        return true;
+
+    dtn_log_error("invalid contact %s to %s", c.from ? c.from : "-",
+                  c.to ? c.to : "-");
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool read_hop(const char *key, dtn_item const *val, void *userdata) {
+
+    dtn_routing_info hop = {0};
+
+    if (!key)
+        return true;
+
+    if (!dtn_routing_info_from_item(&hop, val))
+        return false;
+
+    return plan_hop((Plan *)userdata, key, &hop);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool read_plan(Plan *plan, const char *path) {
+
+    dtn_item *item = dtn_item_json_read_file(path);
+    if (!item)
+        goto error;
+
+    dtn_item *contacts = dtn_item_object_get(item, "contacts");
+    dtn_item *hops = dtn_item_object_get(item, "hops");
+
+    if (!dtn_item_is_array(contacts))
+        goto error;
+
+    if (!dtn_item_array_for_each(contacts, plan, read_contact))
+        goto error;
+
+    if (hops && !dtn_item_object_for_each(hops, read_hop, plan))
+        goto error;
+
+    dtn_item_free(item);
+    return true;
+error:
+    dtn_item_free(item);
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      SEARCH
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static void queue_push(dtn_cgr *self, uint64_t arrival, uint32_t node) {
+
+    Entry *entries = self->queue.entries;
+    size_t i = self->queue.count++;
+
+    while (i > 0) {
+
+        size_t parent = (i - 1) / 2;
+
+        if (entries[parent].arrival <= arrival)
+            break;
+
+        entries[i] = entries[parent];
+        i = parent;
+    }
+
+    entries[i] = (Entry){.arrival = arrival, .node = node};
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static Entry queue_pop(dtn_cgr *self) {
+
+    Entry *entries = self->queue.entries;
+    Entry top = entries[0];
+    Entry last = entries[--self->queue.count];
+
+    size_t count = self->queue.count;
+    size_t i = 0;
+
+    while (2 * i + 1 < count) {
+
+        size_t child = 2 * i + 1;
+
+        if (child + 1 < count &&
+            entries[child + 1].arrival < entries[child].arrival)
+            child++;
+
+        if (last.arrival <= entries[child].arrival)
+            break;
+
+        entries[i] = entries[child];
+        i = child;
+    }
+
+    if (count > 0)
+        entries[i] = last;
+
+    return top;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  @returns arrival at contact->to for a bundle of size ready at time,
+ *  NEVER if the contact is not usable
+ */
+static uint64_t contact_arrival(const Contact *contact, uint64_t time,
+                                uint64_t size) {
+
+    if (contact->removed || contact->suppressed)
+        return NEVER;
+
+    uint64_t start = time > contact->start ? time : contact->start;
+    uint64_t transmit = 0;
+
+    if (contact->rate > 0)
+        transmit = (size * 1000000 + contact->rate - 1) / contact->rate;
+
+    if (start >= contact->end || contact->end - start < transmit)
+        return NEVER;
+
+    return start + transmit + contact->owlt;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Earliest arrival search from local at now, nodes are left with the
+ *  arrival and the contact of the arrival.
+ *
+ *  @returns true if destination is reachable
+ */
+static bool search(dtn_cgr *self, uint32_t local, uint32_t destination,
+                   uint64_t now, uint64_t size) {
+
+    Plan *plan = &self->plan;
+
+    for (size_t i = 0; i < plan->nodes_count; i++) {
+        plan->nodes[i].arrival = NEVER;
+        plan->nodes[i].via = NONE;
+    }
+
+    // a node is queued at most once per contact to it
+
+    self->queue.count = 0;
+
+    plan->nodes[local].arrival = now;
+    queue_push(self, now, local);
+
+    while (self->queue.count > 0) {
+
+        Entry entry = queue_pop(self);
+        Node *node = &plan->nodes[entry.node];
+
+        if (entry.arrival > node->arrival)
+            continue;
+
+        if (entry.node == destination)
+            return true;
+
+        for (size_t i = 0; i < node->out_count; i++) {
+
+            const Contact *contact = &plan->contacts[node->out[i]];
+            Node *next = &plan->nodes[contact->to];
+
+            uint64_t arrival = contact_arrival(contact, entry.arrival, size);
+
+            if (arrival >= next->arrival)
+                continue;
+
+            next->arrival = arrival;
+            next->via = node->out[i];
+            queue_push(self, arrival, contact->to);
+        }
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool route_from_search(dtn_cgr *self, uint32_t local,
+                              uint32_t destination, Route *route) {
+
+    Plan *plan = &self->plan;
+
+    size_t hops = 0;
+    uint32_t node = destination;
+
+    while (node != local) {
+
+        if (hops == DTN_CGR_HOPS_MAX) {
+            dtn_log_debug("route to %s exceeds %i hops",
+                          plan->nodes[destination].name, DTN_CGR_HOPS_MAX);
+            return false;
+        }
+
+        node = plan->contacts[plan->nodes[node].via].from;
+        hops++;
+    }
+
+    route->hops = hops;
+    route->arrival = plan->nodes[destination].arrival;
+
+    node = destination;
+
+    for (size_t i = hops; i > 0; i--) {
+
+        uint32_t via = plan->nodes[node].via;
+        route->contacts[i - 1] = via;
+        node = plan->contacts[via].from;
+    }
+
+    route->neighbor = plan->contacts[route->contacts[0]].to;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  @returns arrival over route at now, NEVER if not usable anymore
+ */
+static uint64_t route_arrival(const dtn_cgr *self, const Route *route,
+                              uint64_t now, uint64_t size) {
+
+    uint64_t time = now;
+
+    for (size_t i = 0; i < route->hops && time != NEVER; i++) {
+        time = contact_arrival(&self->plan.contacts[route->contacts[i]], time,
+                               size);
+    }
+
+    return time;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool route_uses(const Route *route, uint32_t contact) {
+
+    for (size_t i = 0; i < route->hops; i++) {
+
+        if (route->contacts[i] == contact)
+            return true;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Compute the routes to destination, each over another neighbor.
+ */
+static void compute(dtn_cgr *self, uint32_t local, uint32_t destination,
+                    uint64_t now, uint64_t size) {
+
+    Plan *plan = &self->plan;
+    Node *source = &plan->nodes[local];
+    Node *target = &plan->nodes[destination];
+
+    target->cache.count = 0;
+
+    while (target->cache.count < self->config.limits.routes) {
+
+        Route *route = &target->cache.routes[target->cache.count];
+
+        if (!search(self, local, destination, now, size))
+            break;
+
+        if (!route_from_search(self, local, destination, route))
+            break;
+
+        target->cache.count++;
+
+        for (size_t i = 0; i < source->out_count; i++) {
+
+            Contact *contact = &plan->contacts[source->out[i]];
+
+            if (contact->to == route->neighbor)
+                contact->suppressed = true;
+        }
+    }
+
+    for (size_t i = 0; i < source->out_count; i++) {
+        plan->contacts[source->out[i]].suppressed = false;
+    }
+
+    target->cache.valid = true;
+    target->cache.now = now;
+    target->cache.size = size;
+    self->counter.computed++;
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool cache_is_usable(const dtn_cgr *self, const Node *node,
+                            uint64_t now, uint64_t size) {
+
+    if (!node->cache.valid)
+        return false;
+
+    // a smaller bundle may use contacts too small before,
+    // an earlier bundle contacts ended at the computation
+
+    if ((size < node->cache.size) || (now < node->cache.now))
+        return false;
+
+    if (0 == node->cache.count)
+        return true;
+
+    // routes not cached arrived at or after the last route, once a
+    // cached route arrives later or out of order one may be better
+
+    uint64_t last = NEVER;
+    uint64_t previous = 0;
+
+    if (node->cache.count == self->config.limits.routes)
+        last = node->cache.routes[node->cache.count - 1].arrival;
+
+    for (size_t i = 0; i < node->cache.count; i++) {
+
+        uint64_t arrival =
+            route_arrival(self, &node->cache.routes[i], now, size);
+
+        if ((NEVER == arrival) || (arrival > last) || (arrival < previous))
+            return false;
+
+        previous = arrival;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void invalidate(dtn_cgr *self, Node *node) {
+
+    if (!node->cache.valid)
+        return;
+
+    node->cache.valid = false;
+    self->counter.invalidated++;
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void invalidate_added(dtn_cgr *self, uint32_t id) {
+
+    const Contact *contact = &self->plan.contacts[id];
+
+    for (size_t i = 0; i < self->plan.nodes_count; i++) {
+
+        Node *node = &self->plan.nodes[i];
+
+        if (!node->cache.valid)
+            continue;
+
+        if (node->cache.count < self->config.limits.routes) {
+            invalidate(self, node);
+            continue;
+        }
+
+        // may only improve routes arriving after the contact
+
+        const Route *last = &node->cache.routes[node->cache.count - 1];
+
+        if (contact->start + contact->owlt < last->arrival)
+            invalidate(self, node);
+    }
+
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void invalidate_removed(dtn_cgr *self, uint32_t id) {
+
+    for (size_t i = 0; i < self->plan.nodes_count; i++) {
+
+        Node *node = &self->plan.nodes[i];
+
+        for (size_t r = 0; node->cache.valid && r < node->cache.count; r++) {
+
+            if (route_uses(&node->cache.routes[r], id))
+                invalidate(self, node);
+        }
+    }
+
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void invalidate_all(dtn_cgr *self) {
+
+    for (size_t i = 0; i < self->plan.nodes_count; i++) {
+        invalidate(self, &self->plan.nodes[i]);
+    }
+
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool queue_reserve(dtn_cgr *self, size_t contacts) {
+
+    // each contact is relaxed once at most, after its node was queued
+
+    size_t size = contacts + 1;
+
+    if (size <= self->queue.size)
+        return true;
+
+    Entry *entries = realloc(self->queue.entries, size * sizeof(Entry));
+    if (!entries)
+        return false;
+
+    self->queue.entries = entries;
+    self->queue.size = size;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Write the node of "dtn://name/demux" or "ipn:node.service" to node.
+ */
+static bool eid_node(const char *eid, char *node, size_t size) {
+
+    const char *name = NULL;
+    size_t length = 0;
+
+    if (0 == strncmp(eid, "dtn://", 6)) {
+
+        name = eid + 6;
+        length = strcspn(name, "/");
+
+    } else if (0 == strncmp(eid, "ipn:", 4)) {
+
+        name = eid;
+        length = strcspn(name, ".");
+
+    } else {
+
+        return false;
+    }
+
+    if (0 == length || length >= size)
+        return false;
+
+    memcpy(node, name, length);
+    node[length] = 0;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool init_config(dtn_cgr_config *config) {
+
+    if (0 == config->node[0])
+        goto error;
+
+    if (0 == config->limits.routes)
+        config->limits.routes = DTN_CGR_ROUTES_MAX;
+
+    if (config->limits.routes > DTN_CGR_ROUTES_MAX)
+        config->limits.routes = DTN_CGR_ROUTES_MAX;
+
+    if (0 == config->limits.threadlock_timeout_usecs)
+        config->limits.threadlock_timeout_usecs = 100000;
+
+    return true;
+error:
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_cgr *dtn_cgr_create(dtn_cgr_config config) {
+
+    dtn_cgr *self = NULL;
+
+    if (!init_config(&config))
+        goto error;
+
+    self = calloc(1, sizeof(dtn_cgr));
+    if (!self)
+        goto error;
+
+    self->config = config;
+
+    if (!dtn_thread_lock_init(&self->lock,
+                              self->config.limits.threadlock_timeout_usecs))
+        goto error;
+
+    if (!plan_init(&self->plan))
+        goto error;
+
+    if (NONE == plan_node(&self->plan, self->config.node, true))
+        goto error;
+
+    return self;
+error:
+    dtn_cgr_free(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_cgr *dtn_cgr_free(dtn_cgr *self) {
+
+    if (!self)
+        return self;
+
+    dtn_thread_lock_clear(&self->lock);
+    plan_clear(&self->plan);
+    self->queue.entries = dtn_data_pointer_free(self->queue.entries);
+    self = dtn_data_pointer_free(self);
+    return NULL;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CONTACT PLAN
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+bool dtn_cgr_load(dtn_cgr *self, const char *path) {
+
+    Plan plan = {0};
+
+    if (!self || !path)
+        goto error;
+
+    if (!plan_init(&plan))
+        goto error;
+
+    if (NONE == plan_node(&plan, self->config.node, true))
+        goto error;
+
+    if (!read_plan(&plan, path)) {
+        dtn_log_error("failed to read contact plan %s", path);
+        goto error;
+    }
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+
+    if (!queue_reserve(self, plan.contacts_count)) {
+
+        if (!dtn_thread_lock_unlock(&self->lock)) {
+            dtn_log_error("failed to unlock contact plan");
+        }
+
+        goto error;
+    }
+
+    invalidate_all(self);
+
+    plan_clear(&self->plan);
+    self->plan = plan;
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock contact plan");
+    }
+
+    dtn_log_info("loaded %zu contacts from %s", plan.contacts_count, path);
+    return true;
+error:
+    plan_clear(&plan);
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int64_t dtn_cgr_contact_add(dtn_cgr *self, dtn_cgr_contact contact) {
+
+    int64_t id = -1;
+
+    if (!self)
+        goto error;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+
+    id = plan_contact(&self->plan, contact);
+
+    if (0 <= id && !queue_reserve(self, self->plan.contacts_count)) {
+        self->plan.contacts[id].removed = true;
+        self->plan.active--;
+        id = -1;
+    }
+
+    if (0 <= id)
+        invalidate_added(self, id);
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock contact plan");
+    }
+
+    return id;
+error:
+    return -1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cgr_contact_remove(dtn_cgr *self, uint64_t id) {
+
+    bool result = false;
+
+    if (!self)
+        goto error;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+
+    if (id < self->plan.contacts_count && !self->plan.contacts[id].removed) {
+
+        self->plan.contacts[id].removed = true;
+        self->plan.active--;
+
+        invalidate_removed(self, id);
+        result = true;
+    }
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock contact plan");
+    }
+
+    return result;
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cgr_set_hop(dtn_cgr *self, const char *node,
+                     const dtn_routing_info *hop) {
+
+    if (!self || !node || !hop)
+        goto error;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+
+    bool result = plan_hop(&self->plan, node, hop);
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock contact plan");
+    }
+
+    return result;
+error:
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ROUTING
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int64_t dtn_cgr_lookup(dtn_cgr *self, const char *eid, uint64_t now_usecs,
+                       uint64_t size, dtn_routing_info *routes,
+                       uint64_t *starts, size_t max) {
+
+    char name[DTN_CGR_NODE_MAX] = {0};
+    int64_t count = 0;
+
+    if (!self || !eid || !routes)
+        goto error;
+
+    if (!eid_node(eid, name, DTN_CGR_NODE_MAX))
+        goto error;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+
+    Plan *plan = &self->plan;
+
+    uint32_t local = plan_node(plan, self->config.node, false);
+    uint32_t destination = plan_node(plan, name, false);
+
+    if (NONE == destination || local == destination)
+        goto done;
+
+    Node *node = &plan->nodes[destination];
+
+    if (cache_is_usable(self, node, now_usecs, size)) {
+        self->counter.cached++;
+    } else {
+        compute(self, local, destination, now_usecs, size);
+    }
+
+    for (size_t i = 0; i < node->cache.count && (size_t)count < max; i++) {
+
+        const Route *route = &node->cache.routes[i];
+        const Node *neighbor = &plan->nodes[route->neighbor];
+
+        if (!neighbor->has_hop)
+            continue;
+
+        routes[count] = neighbor->hop;
+
+        if (starts)
+            starts[count] = plan->contacts[route->contacts[0]].start;
+
+        count++;
+    }
+
+done:
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock contact plan");
+    }
+
+    return count;
+error:
+    return -1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_cgr_get_stats(dtn_cgr *self, dtn_cgr_stats *stats) {
+
+    if (!self || !stats)
+        goto error;
+
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+
+    *stats = (dtn_cgr_stats){.contacts = self->plan.active,
+                             .nodes = self->plan.nodes_count,
+                             .computed = self->counter.computed,
+                             .cached = self->counter.cached,
+                             .invalidated = self->counter.invalidated};
+
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock contact plan");
+    }
+
+    return true;
+error:
+    return false;
+}
@@ -0,0 +1,492 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_cgr_test.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "dtn_cgr.c"
+#include <dtn_base/testrun.h>
+
+#ifndef DTN_TEST_RESOURCE_DIR
+#error "Must provide -D DTN_TEST_RESOURCE_DIR=value while compiling this file."
+#endif
+
+#define TEST_PLAN DTN_TEST_RESOURCE_DIR "/contacts/test.plan"
+#define SECONDS 1000000ULL
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CASES                                                      #CASES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static dtn_cgr *cgr_create(uint64_t routes) {
+
+    dtn_cgr_config config = (dtn_cgr_config){.node = "a",
+                                             .limits.routes = routes};
+
+    dtn_cgr *self = dtn_cgr_create(config);
+
+    if (self && !dtn_cgr_load(self, TEST_PLAN))
+        self = dtn_cgr_free(self);
+
+    return self;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cgr_create() {
+
+    dtn_cgr *self = dtn_cgr_create((dtn_cgr_config){0});
+    testrun(!self);
+
+    self = dtn_cgr_create((dtn_cgr_config){.node = "a"});
+    testrun(self);
+    testrun(DTN_CGR_ROUTES_MAX == self->config.limits.routes);
+    testrun(1 == self->plan.nodes_count);
+    testrun(NULL == dtn_cgr_free(self));
+
+    self = dtn_cgr_create(
+        (dtn_cgr_config){.node = "a", .limits.routes = 100});
+    testrun(self);
+    testrun(DTN_CGR_ROUTES_MAX == self->config.limits.routes);
+    testrun(NULL == dtn_cgr_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cgr_free() {
+
+    testrun(NULL == dtn_cgr_free(NULL));
+
+    dtn_cgr *self = cgr_create(0);
+    testrun(self);
+    testrun(NULL == dtn_cgr_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cgr_load() {
+
+    dtn_cgr_stats stats = {0};
+
+    dtn_cgr *self = dtn_cgr_create((dtn_cgr_config){.node = "a"});
+    testrun(self);
+
+    testrun(!dtn_cgr_load(NULL, TEST_PLAN));
+    testrun(!dtn_cgr_load(self, NULL));
+    testrun(!dtn_cgr_load(self, "/nonexisting/test.plan"));
+
+    testrun(dtn_cgr_load(self, TEST_PLAN));
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(4 == stats.contacts);
+    testrun(4 == stats.nodes);
+
+    Node *node = &self->plan.nodes[plan_node(&self->plan, "b", false)];
+    testrun(node->has_hop);
+    testrun(0 == strcmp("eth0", node->hop.interface));
+    testrun(4556 == node->hop.remote.port);
+    testrun(DTN_ROUTING_CONTACT == node->hop.class);
+
+    const Contact *contact = &self->plan.contacts[0];
+    testrun(100 * SECONDS == contact->start);
+    testrun(200 * SECONDS == contact->end);
+    testrun(1000 == contact->rate);
+    testrun(1 * SECONDS == contact->owlt);
+
+    // reload replaces the plan
+
+    testrun(dtn_cgr_load(self, TEST_PLAN));
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(4 == stats.contacts);
+    testrun(4 == stats.nodes);
+
+    // negative rates are invalid, the current plan stays
+
+    char path[PATH_MAX] = "/tmp/dtn_cgr_XXXXXX";
+    testrun(mkdtemp(path));
+
+    char file[PATH_MAX + 16] = {0};
+    snprintf(file, sizeof(file), "%s/negative.plan", path);
+
+    dtn_item *plan = dtn_item_from_json(
+        "{\"contacts\":[{\"from\":\"a\",\"to\":\"b\",\"start\":1,"
+        "\"end\":2,\"rate\":-1,\"owlt\":1}]}");
+    testrun(dtn_item_json_write_file(file, plan));
+    plan = dtn_item_free(plan);
+
+    testrun(!dtn_cgr_load(self, file));
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(4 == stats.contacts);
+
+    testrun(0 == unlink(file));
+    testrun(0 == rmdir(path));
+
+    testrun(NULL == dtn_cgr_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cgr_contact_add() {
+
+    dtn_cgr_stats stats = {0};
+
+    dtn_cgr *self = cgr_create(1);
+    testrun(self);
+
+    dtn_cgr_contact contact = (dtn_cgr_contact){.from = "a",
+                                                .to = "c",
+                                                .start_usecs = 1000 * SECONDS,
+                                                .end_usecs = 2000 * SECONDS};
+
+    testrun(-1 == dtn_cgr_contact_add(NULL, contact));
+
+    contact.end_usecs = contact.start_usecs;
+    testrun(-1 == dtn_cgr_contact_add(self, contact));
+    contact.end_usecs = 2000 * SECONDS;
+
+    contact.to = "a";
+    testrun(-1 == dtn_cgr_contact_add(self, contact));
+    contact.to = NULL;
+    testrun(-1 == dtn_cgr_contact_add(self, contact));
+    contact.to = "c";
+
+    dtn_routing_info routes[DTN_CGR_ROUTES_MAX] = {0};
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 4));
+    testrun(0 == strcmp("eth0", routes[0].interface));
+
+    // routes arriving before the contact are kept
+
+    testrun(4 == dtn_cgr_contact_add(self, contact));
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(5 == stats.contacts);
+    testrun(0 == stats.invalidated);
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 4));
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(1 == stats.computed);
+    testrun(1 == stats.cached);
+
+    // an earlier contact may improve the route
+
+    contact.start_usecs = 0;
+    contact.end_usecs = 10 * SECONDS;
+
+    testrun(5 == dtn_cgr_contact_add(self, contact));
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(1 == stats.invalidated);
+
+    // direct route, but no hop to c
+
+    testrun(0 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 4));
+
+    testrun(dtn_cgr_set_hop(
+        self, "c",
+        &(dtn_routing_info){.interface = "eth2", .remote.port = 4558}));
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 4));
+    testrun(0 == strcmp("eth2", routes[0].interface));
+    testrun(DTN_ROUTING_CONTACT == routes[0].class);
+
+    testrun(NULL == dtn_cgr_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cgr_contact_remove() {
+
+    dtn_cgr_stats stats = {0};
+    dtn_routing_info routes[DTN_CGR_ROUTES_MAX] = {0};
+
+    dtn_cgr *self = cgr_create(0);
+    testrun(self);
+
+    testrun(2 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 4));
+    testrun(1 == dtn_cgr_lookup(self, "dtn://b/1", 0, 100, routes, NULL, 4));
+
+    testrun(!dtn_cgr_contact_remove(NULL, 2));
+    testrun(!dtn_cgr_contact_remove(self, 100));
+
+    // only the routes over the contact are invalidated
+
+    testrun(dtn_cgr_contact_remove(self, 2));
+    testrun(!dtn_cgr_contact_remove(self, 2));
+
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(3 == stats.contacts);
+    testrun(1 == stats.invalidated);
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://b/1", 0, 100, routes, NULL, 4));
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(2 == stats.computed);
+    testrun(1 == stats.cached);
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 4));
+    testrun(0 == strcmp("eth0", routes[0].interface));
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(3 == stats.computed);
+
+    testrun(0 == dtn_cgr_lookup(self, "ipn:4.1", 0, 100, routes, NULL, 4));
+
+    testrun(NULL == dtn_cgr_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cgr_set_hop() {
+
+    dtn_routing_info hop = (dtn_routing_info){.interface = "eth3"};
+    dtn_routing_info routes[DTN_CGR_ROUTES_MAX] = {0};
+
+    dtn_cgr *self = cgr_create(0);
+    testrun(self);
+
+    testrun(!dtn_cgr_set_hop(NULL, "b", &hop));
+    testrun(!dtn_cgr_set_hop(self, NULL, &hop));
+    testrun(!dtn_cgr_set_hop(self, "b", NULL));
+
+    testrun(dtn_cgr_set_hop(self, "b", &hop));
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://b/1", 0, 100, routes, NULL, 4));
+    testrun(0 == strcmp("eth3", routes[0].interface));
+    testrun(DTN_ROUTING_CONTACT == routes[0].class);
+
+    testrun(NULL == dtn_cgr_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cgr_lookup() {
+
+    dtn_cgr_stats stats = {0};
+    dtn_routing_info routes[DTN_CGR_ROUTES_MAX] = {0};
+
+    dtn_cgr *self = cgr_create(0);
+    testrun(self);
+
+    testrun(-1 == dtn_cgr_lookup(NULL, "dtn://c/1", 0, 100, routes, NULL, 4));
+    testrun(-1 == dtn_cgr_lookup(self, NULL, 0, 100, routes, NULL, 4));
+    testrun(-1 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, NULL, NULL, 4));
+    testrun(-1 == dtn_cgr_lookup(self, "c", 0, 100, routes, NULL, 4));
+    testrun(-1 == dtn_cgr_lookup(self, "dtn:///1", 0, 100, routes, NULL, 4));
+
+    testrun(0 == dtn_cgr_lookup(self, "dtn://x/1", 0, 100, routes, NULL, 4));
+    testrun(0 == dtn_cgr_lookup(self, "dtn://a/1", 0, 100, routes, NULL, 4));
+
+    // earliest arrival first, over b at 151.1s and ipn:4 at 502s
+
+    testrun(2 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 4));
+    testrun(0 == strcmp("eth0", routes[0].interface));
+    testrun(4556 == routes[0].remote.port);
+    testrun(DTN_ROUTING_CONTACT == routes[0].class);
+    testrun(0 == strcmp("eth1", routes[1].interface));
+    testrun(4557 == routes[1].remote.port);
+
+    uint32_t c = plan_node(&self->plan, "c", false);
+    testrun(151100000 == self->plan.nodes[c].cache.routes[0].arrival);
+    testrun(2 == self->plan.nodes[c].cache.routes[0].hops);
+    testrun(502 * SECONDS == self->plan.nodes[c].cache.routes[1].arrival);
+
+    // start of the first contact of each route
+
+    uint64_t starts[DTN_CGR_ROUTES_MAX] = {0};
+
+    testrun(2 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, starts, 4));
+    testrun(100 * SECONDS == starts[0]);
+    testrun(500 * SECONDS == starts[1]);
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 1));
+    testrun(0 == strcmp("eth0", routes[0].interface));
+
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(1 == stats.computed);
+    testrun(2 == stats.cached);
+
+    // contact to b closed, the cached routes are computed again
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 250 * SECONDS, 100, routes,
+                                NULL, 4));
+    testrun(0 == strcmp("eth1", routes[0].interface));
+
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(2 == stats.computed);
+
+    // 200s of transmission exceed the contact to b
+
+    testrun(0 == dtn_cgr_lookup(self, "dtn://b/1", 0, 200000, routes, NULL, 4));
+    testrun(1 == dtn_cgr_lookup(self, "dtn://b/1", 0, 100, routes, NULL, 4));
+    testrun(0 == strcmp("eth0", routes[0].interface));
+
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(4 == stats.computed);
+
+    // ipn endpoints route to the node
+
+    testrun(1 == dtn_cgr_lookup(self, "ipn:4.1", 0, 100, routes, NULL, 4));
+    testrun(0 == strcmp("eth1", routes[0].interface));
+
+    testrun(1 == dtn_cgr_lookup(self, "ipn:4", 0, 100, routes, NULL, 4));
+    testrun(0 == dtn_cgr_lookup(self, "ipn:4.1", 700 * SECONDS, 100, routes,
+                                NULL, 4));
+
+    testrun(NULL == dtn_cgr_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cgr_lookup_cache() {
+
+    dtn_cgr_stats stats = {0};
+    dtn_routing_info routes[DTN_CGR_ROUTES_MAX] = {0};
+
+    dtn_cgr *self = cgr_create(1);
+    testrun(self);
+
+    uint32_t c = plan_node(&self->plan, "c", false);
+
+    // 200s of transmission exceed the contacts over b
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 0, 200000, routes, NULL, 4));
+    testrun(0 == strcmp("eth1", routes[0].interface));
+
+    // a smaller bundle is routed over b
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 4));
+    testrun(0 == strcmp("eth0", routes[0].interface));
+    testrun(151100000 == self->plan.nodes[c].cache.routes[0].arrival);
+
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(2 == stats.computed);
+    testrun(0 == stats.cached);
+
+    // arrival unchanged until the contact to b starts
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 50 * SECONDS, 100,
+                                routes, NULL, 4));
+    testrun(0 == strcmp("eth0", routes[0].interface));
+
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(2 == stats.computed);
+    testrun(1 == stats.cached);
+
+    // route over b usable at 160s, but arrives later than cached
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 160 * SECONDS, 100,
+                                routes, NULL, 4));
+    testrun(0 == strcmp("eth0", routes[0].interface));
+    testrun(162200000 == self->plan.nodes[c].cache.routes[0].arrival);
+
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(3 == stats.computed);
+
+    // earlier than the computation
+
+    testrun(1 == dtn_cgr_lookup(self, "dtn://c/1", 0, 100, routes, NULL, 4));
+    testrun(151100000 == self->plan.nodes[c].cache.routes[0].arrival);
+
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(4 == stats.computed);
+    testrun(1 == stats.cached);
+
+    testrun(NULL == dtn_cgr_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_cgr_get_stats() {
+
+    dtn_cgr_stats stats = {0};
+
+    dtn_cgr *self = cgr_create(0);
+    testrun(self);
+
+    testrun(!dtn_cgr_get_stats(NULL, &stats));
+    testrun(!dtn_cgr_get_stats(self, NULL));
+
+    testrun(dtn_cgr_get_stats(self, &stats));
+    testrun(4 == stats.contacts);
+    testrun(4 == stats.nodes);
+    testrun(0 == stats.computed);
+    testrun(0 == stats.cached);
+    testrun(0 == stats.invalidated);
+
+    testrun(NULL == dtn_cgr_free(self));
+
+    return testrun_log_success();
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CLUSTER                                                    #CLUSTER
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int all_tests() {
+
+    testrun_init();
+    testrun_test(test_dtn_cgr_create);
+    testrun_test(test_dtn_cgr_free);
+    testrun_test(test_dtn_cgr_load);
+    testrun_test(test_dtn_cgr_contact_add);
+    testrun_test(test_dtn_cgr_contact_remove);
+    testrun_test(test_dtn_cgr_set_hop);
+    testrun_test(test_dtn_cgr_lookup);
+    testrun_test(test_dtn_cgr_lookup_cache);
+    testrun_test(test_dtn_cgr_get_stats);
+
+    return testrun_counter;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST EXECUTION                                                  #EXEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+testrun_run(all_tests);
@@ -0,0 +1,706 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_duplicate_filter.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_duplicate_filter.h"
+
+#include <dtn_base/dtn_data_function.h>
+#include <dtn_base/dtn_hash_functions.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DTN_DUPLICATE_FILTER_MAGIC_BYTE 0xd0f1
+
+#define SEED_HI 0x9e3779b97f4a7c15ull
+#define SEED_LO 0xc2b2ae3d27d4eb4full
+
+// 2^-128, probability of a 128 bit hash to match another one
+#define HASH_COLLISION 2.938735877055719e-39
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Hash {
+
+    uint64_t hi;
+    uint64_t lo;
+
+} Hash;
+
+/*----------------------------------------------------------------------------*/
+
+struct dtn_duplicate_filter {
+
+    uint16_t magic_byte;
+    dtn_duplicate_filter_config config;
+
+    struct {
+
+        uint64_t checks;
+        uint64_t duplicates;
+        uint64_t evicted;
+
+    } counter;
+
+    bool (*contains)(dtn_duplicate_filter *self, Hash hash, uint64_t now);
+    bool (*add)(dtn_duplicate_filter *self, Hash hash, uint64_t now);
+    void (*expire)(dtn_duplicate_filter *self, uint64_t now);
+    void (*stats)(const dtn_duplicate_filter *self,
+                  dtn_duplicate_filter_stats *stats);
+    void (*clear)(dtn_duplicate_filter *self);
+};
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t pow2_floor(uint64_t value) {
+
+    if (0 == value)
+        return 0;
+
+    return (uint64_t)1 << (63 - __builtin_clzll(value));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool is_older(uint64_t created, uint64_t now, uint64_t usecs) {
+
+    return (now > created) && (now - created > usecs);
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      EXACT FILTER
+ *
+ *      Hashes are kept in a ring in order of insertion, oldest at head.
+ *      The index is an open addressing table with linear probing of
+ *      ring positions + 1, 0 is an empty slot. Index slots are twice the
+ *      ring size, entries are removed with backward shift deletion.
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+typedef struct Entry {
+
+    Hash hash;
+    uint64_t created;
+
+} Entry;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct ExactFilter {
+
+    dtn_duplicate_filter public;
+
+    Entry *ring;
+    uint64_t capacity;
+    uint64_t head;
+    uint64_t count;
+
+    uint32_t *index;
+    uint64_t mask;
+
+} ExactFilter;
+
+/*----------------------------------------------------------------------------*/
+
+static inline uint64_t exact_home(const ExactFilter *f, Hash hash) {
+
+    return hash.lo & f->mask;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static inline bool hash_equal(Hash a, Hash b) {
+
+    return (a.hi == b.hi) && (a.lo == b.lo);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int64_t exact_find(const ExactFilter *f, Hash hash) {
+
+    for (uint64_t i = exact_home(f, hash); f->index[i];
+         i = (i + 1) & f->mask) {
+
+        if (hash_equal(f->ring[f->index[i] - 1].hash, hash))
+            return i;
+    }
+
+    return -1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void exact_drop_oldest(ExactFilter *f) {
+
+    uint32_t position = f->head + 1;
+    uint64_t i = exact_home(f, f->ring[f->head].hash);
+
+    while (f->index[i] != position) {
+        i = (i + 1) & f->mask;
+    }
+
+    // shift back entries of the cluster which may move to i
+
+    uint64_t j = i;
+
+    while (true) {
+
+        j = (j + 1) & f->mask;
+
+        if (!f->index[j])
+            break;
+
+        uint64_t k = exact_home(f, f->ring[f->index[j] - 1].hash);
+
+        bool stays = (i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j));
+
+        if (stays)
+            continue;
+
+        f->index[i] = f->index[j];
+        i = j;
+    }
+
+    f->index[i] = 0;
+
+    f->head = (f->head + 1) % f->capacity;
+    f->count--;
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void exact_expire(dtn_duplicate_filter *self, uint64_t now) {
+
+    ExactFilter *f = (ExactFilter *)self;
+
+    while ((f->count > 0) &&
+           is_older(f->ring[f->head].created, now,
+                    self->config.history_usecs)) {
+
+        exact_drop_oldest(f);
+    }
+
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool exact_contains(dtn_duplicate_filter *self, Hash hash,
+                           uint64_t now) {
+
+    exact_expire(self, now);
+    return -1 != exact_find((ExactFilter *)self, hash);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool exact_add(dtn_duplicate_filter *self, Hash hash, uint64_t now) {
+
+    ExactFilter *f = (ExactFilter *)self;
+
+    exact_expire(self, now);
+
+    if (-1 != exact_find(f, hash))
+        return true;
+
+    if (f->count == f->capacity) {
+
+        exact_drop_oldest(f);
+        self->counter.evicted++;
+    }
+
+    uint64_t position = (f->head + f->count) % f->capacity;
+    f->ring[position] = (Entry){.hash = hash, .created = now};
+    f->count++;
+
+    uint64_t i = exact_home(f, hash);
+
+    while (f->index[i]) {
+        i = (i + 1) & f->mask;
+    }
+
+    f->index[i] = position + 1;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void exact_stats(const dtn_duplicate_filter *self,
+                        dtn_duplicate_filter_stats *stats) {
+
+    const ExactFilter *f = (const ExactFilter *)self;
+
+    stats->memory_bytes =
+        f->capacity * sizeof(Entry) + (f->mask + 1) * sizeof(uint32_t);
+    stats->entries = f->count;
+    stats->capacity = f->capacity;
+    stats->false_positive_rate = (double)f->count * HASH_COLLISION;
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void exact_clear(dtn_duplicate_filter *self) {
+
+    ExactFilter *f = (ExactFilter *)self;
+    f->ring = dtn_data_pointer_free(f->ring);
+    f->index = dtn_data_pointer_free(f->index);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_duplicate_filter *exact_create(dtn_duplicate_filter_config config) {
+
+    ExactFilter *f = calloc(1, sizeof(ExactFilter));
+    if (!f)
+        goto error;
+
+    f->public.clear = exact_clear;
+
+    // per key one ring entry and two index slots
+
+    uint64_t slots = pow2_floor(
+        config.memory_bytes / (sizeof(Entry) / 2 + sizeof(uint32_t)));
+
+    if ((slots < 2) || (slots / 2 >= UINT32_MAX))
+        goto error;
+
+    f->capacity = slots / 2;
+    f->mask = slots - 1;
+
+    f->ring = calloc(f->capacity, sizeof(Entry));
+    f->index = calloc(slots, sizeof(uint32_t));
+
+    if (!f->ring || !f->index)
+        goto error;
+
+    f->public.contains = exact_contains;
+    f->public.add = exact_add;
+    f->public.expire = exact_expire;
+    f->public.stats = exact_stats;
+
+    return (dtn_duplicate_filter *)f;
+error:
+    if (f)
+        exact_clear((dtn_duplicate_filter *)f);
+    dtn_data_pointer_free(f);
+    return NULL;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      BLOOM FILTER
+ *
+ *      DTN_DUPLICATE_FILTER_BLOOM_SLICES filters of equal size, each
+ *      taking keys for history / (slices - 1). Keys are added to the
+ *      current slice and checked against all slices. On rotation the
+ *      oldest slice is cleared and becomes the current one, so keys
+ *      are kept for at least history and at most history + 1 slice.
+ *      Bit positions use double hashing hi + i * lo.
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+#define SLICES DTN_DUPLICATE_FILTER_BLOOM_SLICES
+
+typedef struct BloomFilter {
+
+    dtn_duplicate_filter public;
+
+    uint64_t *bits;
+    uint64_t words; // per slice
+    uint64_t mask;  // bits per slice - 1
+    uint64_t hashes;
+
+    uint64_t current;
+    uint64_t started;
+    uint64_t slice_usecs;
+    bool running;
+
+    uint64_t inserted[SLICES];
+
+} BloomFilter;
+
+/*----------------------------------------------------------------------------*/
+
+static void bloom_rotate(BloomFilter *f, uint64_t now) {
+
+    if (!f->running) {
+
+        f->started = now;
+        f->running = true;
+        return;
+    }
+
+    if ((now <= f->started) || (now - f->started < f->slice_usecs))
+        return;
+
+    uint64_t steps = (now - f->started) / f->slice_usecs;
+    f->started += steps * f->slice_usecs;
+
+    if (steps > SLICES)
+        steps = SLICES;
+
+    for (uint64_t i = 0; i < steps; i++) {
+
+        f->current = (f->current + 1) % SLICES;
+        memset(f->bits + f->current * f->words, 0,
+               f->words * sizeof(uint64_t));
+        f->inserted[f->current] = 0;
+    }
+
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool bloom_slice_contains(const BloomFilter *f, uint64_t slice,
+                                 Hash hash) {
+
+    const uint64_t *bits = f->bits + slice * f->words;
+    uint64_t step = hash.lo | 1;
+
+    for (uint64_t i = 0; i < f->hashes; i++) {
+
+        uint64_t bit = (hash.hi + i * step) & f->mask;
+
+        if (!(bits[bit >> 6] & ((uint64_t)1 << (bit & 63))))
+            return false;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool bloom_contains(dtn_duplicate_filter *self, Hash hash,
+                           uint64_t now) {
+
+    BloomFilter *f = (BloomFilter *)self;
+    bloom_rotate(f, now);
+
+    for (uint64_t i = 0; i < SLICES; i++) {
+
+        // newest slices first
+        uint64_t slice = (f->current + SLICES - i) % SLICES;
+
+        if (bloom_slice_contains(f, slice, hash))
+            return true;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool bloom_add(dtn_duplicate_filter *self, Hash hash, uint64_t now) {
+
+    BloomFilter *f = (BloomFilter *)self;
+    bloom_rotate(f, now);
+
+    uint64_t *bits = f->bits + f->current * f->words;
+    uint64_t step = hash.lo | 1;
+
+    for (uint64_t i = 0; i < f->hashes; i++) {
+
+        uint64_t bit = (hash.hi + i * step) & f->mask;
+        bits[bit >> 6] |= (uint64_t)1 << (bit & 63);
+    }
+
+    f->inserted[f->current]++;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void bloom_expire(dtn_duplicate_filter *self, uint64_t now) {
+
+    bloom_rotate((BloomFilter *)self, now);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void bloom_stats(const dtn_duplicate_filter *self,
+                        dtn_duplicate_filter_stats *stats) {
+
+    const BloomFilter *f = (const BloomFilter *)self;
+
+    stats->memory_bytes = SLICES * f->words * sizeof(uint64_t);
+
+    // a new key is a false positive if all its bits are set in any slice
+
+    double negative = 1;
+
+    for (uint64_t slice = 0; slice < SLICES; slice++) {
+
+        stats->entries += f->inserted[slice];
+
+        uint64_t set = 0;
+        const uint64_t *bits = f->bits + slice * f->words;
+
+        for (uint64_t i = 0; i < f->words; i++) {
+            set += __builtin_popcountll(bits[i]);
+        }
+
+        double fill = (double)set / (double)(f->mask + 1);
+        double positive = 1;
+
+        for (uint64_t i = 0; i < f->hashes; i++) {
+            positive *= fill;
+        }
+
+        negative *= 1 - positive;
+    }
+
+    stats->false_positive_rate = 1 - negative;
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void bloom_clear(dtn_duplicate_filter *self) {
+
+    BloomFilter *f = (BloomFilter *)self;
+    f->bits = dtn_data_pointer_free(f->bits);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_duplicate_filter *bloom_create(dtn_duplicate_filter_config config) {
+
+    BloomFilter *f = calloc(1, sizeof(BloomFilter));
+    if (!f)
+        goto error;
+
+    f->words = pow2_floor(config.memory_bytes / (SLICES * sizeof(uint64_t)));
+    if (0 == f->words)
+        goto error;
+
+    f->mask = f->words * 64 - 1;
+
+    f->slice_usecs = config.history_usecs / (SLICES - 1);
+    if (0 == f->slice_usecs)
+        f->slice_usecs = 1;
+
+    // optimal number of hashes is bits / keys * ln(2)
+
+    f->hashes = 7;
+
+    if (config.capacity > 0) {
+
+        uint64_t keys = config.capacity / (SLICES - 1) + 1;
+        f->hashes = ((f->mask + 1) * 693 / 1000) / keys;
+
+        if (f->hashes < 1)
+            f->hashes = 1;
+
+        if (f->hashes > 16)
+            f->hashes = 16;
+    }
+
+    f->bits = calloc(SLICES * f->words, sizeof(uint64_t));
+    if (!f->bits)
+        goto error;
+
+    f->public.contains = bloom_contains;
+    f->public.add = bloom_add;
+    f->public.expire = bloom_expire;
+    f->public.stats = bloom_stats;
+    f->public.clear = bloom_clear;
+
+    return (dtn_duplicate_filter *)f;
+error:
+    dtn_data_pointer_free(f);
+    return NULL;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_duplicate_filter *
+dtn_duplicate_filter_create(dtn_duplicate_filter_config config) {
+
+    dtn_duplicate_filter *self = NULL;
+
+    if (0 == config.history_usecs)
+        goto error;
+
+    if (0 == config.memory_bytes)
+        config.memory_bytes = DTN_DUPLICATE_FILTER_MEMORY_DEFAULT;
+
+    switch (config.type) {
+
+    case DTN_DUPLICATE_FILTER_EXACT:
+        self = exact_create(config);
+        break;
+
+    case DTN_DUPLICATE_FILTER_BLOOM:
+        self = bloom_create(config);
+        break;
+
+    default:
+        goto error;
+    }
+
+    if (!self)
+        goto error;
+
+    self->magic_byte = DTN_DUPLICATE_FILTER_MAGIC_BYTE;
+    self->config = config;
+
+    return self;
+error:
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_duplicate_filter *dtn_duplicate_filter_cast(const void *data) {
+
+    if (!data)
+        return NULL;
+
+    if (*(uint16_t *)data != DTN_DUPLICATE_FILTER_MAGIC_BYTE)
+        return NULL;
+
+    return (dtn_duplicate_filter *)data;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void *dtn_duplicate_filter_free(void *data) {
+
+    dtn_duplicate_filter *self = dtn_duplicate_filter_cast(data);
+    if (!self)
+        return data;
+
+    self->clear(self);
+    self = dtn_data_pointer_free(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static Hash hash_key(const void *key, size_t size) {
+
+    return (Hash){.hi = dtn_hash_bytes_seed(key, size, SEED_HI),
+                  .lo = dtn_hash_bytes_seed(key, size, SEED_LO)};
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_duplicate_filter_contains(dtn_duplicate_filter *self,
+                                   const void *key, size_t size,
+                                   uint64_t now_usecs) {
+
+    if (!self || !key)
+        return false;
+
+    self->counter.checks++;
+
+    if (!self->contains(self, hash_key(key, size), now_usecs))
+        return false;
+
+    self->counter.duplicates++;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_duplicate_filter_add(dtn_duplicate_filter *self, const void *key,
+                              size_t size, uint64_t now_usecs) {
+
+    if (!self || !key)
+        return false;
+
+    return self->add(self, hash_key(key, size), now_usecs);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_duplicate_filter_expire(dtn_duplicate_filter *self,
+                                 uint64_t now_usecs) {
+
+    if (!self)
+        return false;
+
+    self->expire(self, now_usecs);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_duplicate_filter_get_stats(const dtn_duplicate_filter *self,
+                                    dtn_duplicate_filter_stats *stats) {
+
+    if (!self || !stats)
+        return false;
+
+    *stats = (dtn_duplicate_filter_stats){
+
+        .type = self->config.type,
+        .checks = self->counter.checks,
+        .duplicates = self->counter.duplicates,
+        .evicted = self->counter.evicted};
+
+    self->stats(self, stats);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+const char *
+dtn_duplicate_filter_type_to_string(dtn_duplicate_filter_type type) {
+
+    switch (type) {
+
+    case DTN_DUPLICATE_FILTER_EXACT:
+        return "exact";
+
+    case DTN_DUPLICATE_FILTER_BLOOM:
+        return "bloom";
+
+    default:
+        break;
+    }
+
+    return NULL;
+}
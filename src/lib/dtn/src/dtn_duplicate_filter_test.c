@@ -0,0 +1,409 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_duplicate_filter_test.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "dtn_duplicate_filter.c"
+#include <dtn_base/testrun.h>
+
+#include <stdio.h>
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CASES                                                      #CASES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static size_t key(char *buffer, size_t size, uint64_t nbr) {
+
+    return snprintf(buffer, size, "dtn://node-%" PRIu64 "/|1000|%" PRIu64,
+                    nbr % 7, nbr);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_duplicate_filter_create() {
+
+    dtn_duplicate_filter *self =
+        dtn_duplicate_filter_create((dtn_duplicate_filter_config){0});
+    testrun(!self);
+
+    self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.history_usecs = 1000});
+    testrun(self);
+    testrun(dtn_duplicate_filter_cast(self));
+    testrun(DTN_DUPLICATE_FILTER_MEMORY_DEFAULT == self->config.memory_bytes);
+
+    // default memory is split between ring and index
+
+    ExactFilter *exact = (ExactFilter *)self;
+    testrun(exact->capacity == (exact->mask + 1) / 2);
+    testrun(exact->capacity * sizeof(Entry) +
+                (exact->mask + 1) * sizeof(uint32_t) <=
+            DTN_DUPLICATE_FILTER_MEMORY_DEFAULT);
+    testrun(NULL == dtn_duplicate_filter_free(self));
+
+    // memory too small
+
+    self = dtn_duplicate_filter_create((dtn_duplicate_filter_config){
+        .history_usecs = 1000, .memory_bytes = 16});
+    testrun(!self);
+
+    self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.type = DTN_DUPLICATE_FILTER_BLOOM,
+                                      .history_usecs = 3000,
+                                      .memory_bytes = 4096,
+                                      .capacity = 2430});
+    testrun(self);
+
+    BloomFilter *bloom = (BloomFilter *)self;
+    testrun(128 == bloom->words);
+    testrun(8191 == bloom->mask);
+    testrun(7 == bloom->hashes);
+    testrun(1000 == bloom->slice_usecs);
+    testrun(NULL == dtn_duplicate_filter_free(self));
+
+    self = dtn_duplicate_filter_create((dtn_duplicate_filter_config){
+        .type = DTN_DUPLICATE_FILTER_BLOOM,
+        .history_usecs = 1000,
+        .memory_bytes = 16});
+    testrun(!self);
+
+    self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.type = 100, .history_usecs = 1000});
+    testrun(!self);
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_duplicate_filter_free() {
+
+    testrun(NULL == dtn_duplicate_filter_free(NULL));
+
+    int nbr = 0;
+    testrun(&nbr == dtn_duplicate_filter_free(&nbr));
+
+    dtn_duplicate_filter *self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.type = DTN_DUPLICATE_FILTER_BLOOM,
+                                      .history_usecs = 1000});
+    testrun(self);
+    testrun(NULL == dtn_duplicate_filter_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_duplicate_filter_add() {
+
+    char buffer[100] = {0};
+
+    dtn_duplicate_filter *self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.history_usecs = 1000});
+    testrun(self);
+
+    testrun(!dtn_duplicate_filter_add(NULL, "a", 1, 0));
+    testrun(!dtn_duplicate_filter_add(self, NULL, 1, 0));
+
+    for (uint64_t i = 0; i < 1000; i++) {
+
+        size_t size = key(buffer, sizeof(buffer), i);
+        testrun(!dtn_duplicate_filter_contains(self, buffer, size, 10));
+        testrun(dtn_duplicate_filter_add(self, buffer, size, 10));
+        testrun(dtn_duplicate_filter_contains(self, buffer, size, 10));
+    }
+
+    // adding twice keeps one entry
+    testrun(dtn_duplicate_filter_add(self, buffer, strlen(buffer), 10));
+    testrun(1000 == ((ExactFilter *)self)->count);
+
+    testrun(NULL == dtn_duplicate_filter_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_exact_expire() {
+
+    dtn_duplicate_filter *self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.history_usecs = 100});
+    testrun(self);
+
+    testrun(dtn_duplicate_filter_add(self, "a", 1, 1000));
+    testrun(dtn_duplicate_filter_add(self, "b", 1, 1050));
+
+    testrun(dtn_duplicate_filter_contains(self, "a", 1, 1100));
+    testrun(!dtn_duplicate_filter_contains(self, "a", 1, 1101));
+    testrun(dtn_duplicate_filter_contains(self, "b", 1, 1101));
+
+    testrun(dtn_duplicate_filter_expire(self, 1151));
+    testrun(0 == ((ExactFilter *)self)->count);
+    testrun(!dtn_duplicate_filter_contains(self, "b", 1, 1151));
+
+    testrun(NULL == dtn_duplicate_filter_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_exact_evict() {
+
+    char buffer[100] = {0};
+
+    // 16 index slots, 8 ring entries
+
+    dtn_duplicate_filter *self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.history_usecs = 1000,
+                                      .memory_bytes = 16 * 16});
+    testrun(self);
+
+    ExactFilter *f = (ExactFilter *)self;
+    testrun(8 == f->capacity);
+    testrun(15 == f->mask);
+
+    // the last 8 keys are kept, index stays consistent over deletions
+
+    for (uint64_t i = 0; i < 10000; i++) {
+
+        size_t size = key(buffer, sizeof(buffer), i);
+        testrun(dtn_duplicate_filter_add(self, buffer, size, 1));
+
+        uint64_t first = i < 8 ? 0 : i - 7;
+
+        for (uint64_t k = first; k <= i; k++) {
+            size = key(buffer, sizeof(buffer), k);
+            testrun(dtn_duplicate_filter_contains(self, buffer, size, 1));
+        }
+
+        if (first > 0) {
+            size = key(buffer, sizeof(buffer), first - 1);
+            testrun(!dtn_duplicate_filter_contains(self, buffer, size, 1));
+        }
+
+        uint64_t used = 0;
+        for (uint64_t k = 0; k <= f->mask; k++) {
+            if (f->index[k])
+                used++;
+        }
+
+        testrun(used == f->count);
+    }
+
+    dtn_duplicate_filter_stats stats = {0};
+    testrun(dtn_duplicate_filter_get_stats(self, &stats));
+    testrun(10000 - 8 == stats.evicted);
+    testrun(8 == stats.entries);
+    testrun(8 == stats.capacity);
+
+    testrun(NULL == dtn_duplicate_filter_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_bloom_rotate() {
+
+    dtn_duplicate_filter *self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.type = DTN_DUPLICATE_FILTER_BLOOM,
+                                      .history_usecs = 300});
+    testrun(self);
+
+    BloomFilter *f = (BloomFilter *)self;
+    testrun(100 == f->slice_usecs);
+
+    // slices [0, 100) [100, 200) ...
+
+    testrun(dtn_duplicate_filter_add(self, "a", 1, 0));
+    testrun(dtn_duplicate_filter_add(self, "b", 1, 150));
+
+    testrun(dtn_duplicate_filter_contains(self, "a", 1, 399));
+    testrun(dtn_duplicate_filter_contains(self, "b", 1, 399));
+
+    // kept for at least history, at most history + 1 slice
+
+    testrun(!dtn_duplicate_filter_contains(self, "a", 1, 400));
+    testrun(dtn_duplicate_filter_contains(self, "b", 1, 499));
+    testrun(!dtn_duplicate_filter_contains(self, "b", 1, 500));
+
+    // idle for longer than all slices
+
+    testrun(dtn_duplicate_filter_add(self, "c", 1, 550));
+    testrun(dtn_duplicate_filter_expire(self, 10000));
+    testrun(!dtn_duplicate_filter_contains(self, "c", 1, 10000));
+
+    dtn_duplicate_filter_stats stats = {0};
+    testrun(dtn_duplicate_filter_get_stats(self, &stats));
+    testrun(0 == stats.entries);
+    testrun(0 == stats.false_positive_rate);
+
+    testrun(NULL == dtn_duplicate_filter_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_bloom_false_positives() {
+
+    char buffer[100] = {0};
+
+    // 4 slices of 8192 bits for 3000 keys in history
+
+    dtn_duplicate_filter *self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.type = DTN_DUPLICATE_FILTER_BLOOM,
+                                      .history_usecs = 3000,
+                                      .memory_bytes = 4 * 1024,
+                                      .capacity = 3000});
+    testrun(self);
+
+    // fill 3 slices with 1000 keys each, no false negatives
+
+    for (uint64_t i = 0; i < 3000; i++) {
+
+        size_t size = key(buffer, sizeof(buffer), i);
+        testrun(dtn_duplicate_filter_add(self, buffer, size, i));
+    }
+
+    for (uint64_t i = 0; i < 3000; i++) {
+
+        size_t size = key(buffer, sizeof(buffer), i);
+        testrun(dtn_duplicate_filter_contains(self, buffer, size, 2999));
+    }
+
+    dtn_duplicate_filter_stats stats = {0};
+    testrun(dtn_duplicate_filter_get_stats(self, &stats));
+    testrun(3000 == stats.entries);
+    testrun(4 * 1024 == stats.memory_bytes);
+
+    // about 1 % per slice with 8 bits per key
+
+    uint64_t positives = 0;
+
+    for (uint64_t i = 3000; i < 103000; i++) {
+
+        size_t size = key(buffer, sizeof(buffer), i);
+        if (dtn_duplicate_filter_contains(self, buffer, size, 2999))
+            positives++;
+    }
+
+    double measured = (double)positives / 100000;
+
+    testrun(0.01 < stats.false_positive_rate);
+    testrun(0.10 > stats.false_positive_rate);
+    testrun(measured < 2 * stats.false_positive_rate);
+    testrun(measured > stats.false_positive_rate / 2);
+
+    testrun(dtn_duplicate_filter_get_stats(self, &stats));
+    testrun(103000 == stats.checks);
+    testrun(3000 + positives == stats.duplicates);
+
+    testrun(NULL == dtn_duplicate_filter_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_duplicate_filter_get_stats() {
+
+    dtn_duplicate_filter_stats stats = {0};
+
+    dtn_duplicate_filter *self = dtn_duplicate_filter_create(
+        (dtn_duplicate_filter_config){.history_usecs = 1000,
+                                      .memory_bytes = 1024});
+    testrun(self);
+
+    testrun(!dtn_duplicate_filter_get_stats(NULL, &stats));
+    testrun(!dtn_duplicate_filter_get_stats(self, NULL));
+
+    testrun(dtn_duplicate_filter_add(self, "a", 1, 0));
+    testrun(dtn_duplicate_filter_contains(self, "a", 1, 0));
+    testrun(!dtn_duplicate_filter_contains(self, "b", 1, 0));
+
+    testrun(dtn_duplicate_filter_get_stats(self, &stats));
+    testrun(DTN_DUPLICATE_FILTER_EXACT == stats.type);
+    testrun(32 == stats.capacity);
+    testrun(32 * sizeof(Entry) + 64 * sizeof(uint32_t) == stats.memory_bytes);
+    testrun(1 == stats.entries);
+    testrun(2 == stats.checks);
+    testrun(1 == stats.duplicates);
+    testrun(0 == stats.evicted);
+    testrun(0 < stats.false_positive_rate);
+    testrun(1e-30 > stats.false_positive_rate);
+
+    testrun(NULL == dtn_duplicate_filter_free(self));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_duplicate_filter_type_to_string() {
+
+    testrun(0 == strcmp("exact", dtn_duplicate_filter_type_to_string(
+                                     DTN_DUPLICATE_FILTER_EXACT)));
+    testrun(0 == strcmp("bloom", dtn_duplicate_filter_type_to_string(
+                                     DTN_DUPLICATE_FILTER_BLOOM)));
+    testrun(NULL == dtn_duplicate_filter_type_to_string(100));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int all_tests() {
+
+    testrun_init();
+    testrun_test(test_dtn_duplicate_filter_create);
+    testrun_test(test_dtn_duplicate_filter_free);
+    testrun_test(test_dtn_duplicate_filter_add);
+    testrun_test(check_exact_expire);
+    testrun_test(check_exact_evict);
+    testrun_test(check_bloom_rotate);
+    testrun_test(check_bloom_false_positives);
+    testrun_test(test_dtn_duplicate_filter_get_stats);
+    testrun_test(test_dtn_duplicate_filter_type_to_string);
+
+    return testrun_counter;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST EXECUTION                                                  #EXEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+testrun_run(all_tests);
@@ -27,21 +27,31 @@
 
         ------------------------------------------------------------------------
 */
+/* recvmmsg and sendmmsg */
+#define _GNU_SOURCE
+
 #include "../include/dtn_interface_ip.h"
 
 #include "../include/dtn_bundle.h"
 
 #include <dtn_base/dtn_dump.h>
-#include <dtn_base/dtn_io_buffer.h>
+#include <dtn_base/dtn_dict.h>
 #include <dtn_base/dtn_thread_lock.h>
 #include <dtn_base/dtn_utils.h>
 
+#include <netdb.h>
+#include <sys/socket.h>
+
 /*---------------------------------------------------------------------------*/
 
 #define DTN_INTERFACE_IP_MAGIC_BYTE 0x1ff1
 
 /*---------------------------------------------------------------------------*/
 
+struct out_data;
+
+/*---------------------------------------------------------------------------*/
+
 struct dtn_interface_ip {
 
     uint16_t magic_byte;
@@ -52,13 +62,29 @@ struct dtn_interface_ip {
 
     dtn_ip_link_state link;
 
-    dtn_io_buffer *buffer;
+    dtn_dict *decoder;
+
+    struct {
+
+        uint8_t *buffer; // batch * DTN_INTERFACE_IP_DATAGRAM_MAX
+        struct mmsghdr *msgs;
+        struct iovec *iov;
+        struct sockaddr_storage *sa;
+
+    } in;
 
     struct {
 
         dtn_thread_lock lock;
         dtn_list *queue;
 
+        dtn_dict *peers; // resolved remotes
+        bool waiting;    // for the socket to become writable
+
+        struct mmsghdr *msgs;
+        struct iovec *iov;
+        struct out_data **pending;
+
     } out;
 
     struct {
@@ -73,6 +99,7 @@ struct dtn_interface_ip {
 struct out_data {
 
     dtn_socket_configuration remote;
+    struct sockaddr_storage address; // remote resolved before, if any
     dtn_buffer *buffer;
 };
 
@@ -91,46 +118,195 @@ static void *out_data_free(void *data) {
 
 /*---------------------------------------------------------------------------*/
 
+static socklen_t sockaddr_len(const struct sockaddr_storage *sa) {
+
+    if (AF_INET == sa->ss_family)
+        return sizeof(struct sockaddr_in);
+
+    return sizeof(struct sockaddr_in6);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static const dtn_socket_data *
+get_peer(dtn_interface_ip *self, const dtn_socket_configuration *remote) {
+
+    dtn_socket_data *peer = NULL;
+    dtn_socket_data key = {.port = remote->port};
+
+    strncpy(key.host, remote->host, DTN_HOST_NAME_MAX - 1);
+
+    peer = dtn_dict_get(self->out.peers, &key);
+    if (peer)
+        return peer;
+
+    peer = calloc(1, sizeof(dtn_socket_data));
+    if (!peer)
+        goto error;
+
+    *peer = key;
+
+    // resolved for the address family of the socket
+
+    char port[6] = {0};
+    snprintf(port, sizeof(port), "%" PRIu16, remote->port);
+
+    struct addrinfo *result = NULL;
+    struct addrinfo hints = (struct addrinfo){
+        .ai_family = self->local.sa.ss_family, .ai_socktype = SOCK_DGRAM};
+
+    int r = getaddrinfo(remote->host, port, &hints, &result);
+
+    if (0 != r) {
+        dtn_log_debug("failed to resolve %s - %s", remote->host,
+                      gai_strerror(r));
+        goto error;
+    }
+
+    memcpy(&peer->sa, result->ai_addr, result->ai_addrlen);
+    freeaddrinfo(result);
+
+    // key and value are the same pointer, freed with the key
+    if (!dtn_dict_set(self->out.peers, peer, peer, NULL))
+        goto error;
+
+    return peer;
+error:
+    dtn_data_pointer_free(peer);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool cb_io(int socket, uint8_t event, void *userdata);
+
+/*---------------------------------------------------------------------------*/
+
+static bool wait_for_writable(dtn_interface_ip *self, bool wait) {
+
+    if (wait == self->out.waiting)
+        return true;
+
+    uint8_t events = DTN_EVENT_IO_IN | DTN_EVENT_IO_ERR | DTN_EVENT_IO_CLOSE;
+
+    if (wait)
+        events |= DTN_EVENT_IO_OUT;
+
+    if (!dtn_event_loop_set(self->config.loop, self->socket, events, self,
+                            cb_io)) {
+
+        dtn_log_error("failed to change events of interface %s",
+                      self->config.socket.host);
+        return false;
+    }
+
+    self->out.waiting = wait;
+    return true;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static size_t prepare_batch(dtn_interface_ip *self) {
+
+    size_t count = 0;
+
+    if (DTN_INTERFACE_IP_PEERS_MAX <= dtn_dict_count(self->out.peers))
+        dtn_dict_clear(self->out.peers);
+
+    while (count < self->config.limits.batch) {
+
+        struct out_data *data = dtn_list_queue_pop(self->out.queue);
+        if (!data)
+            break;
+
+        const struct sockaddr_storage *sa = &data->address;
+
+        if (self->local.sa.ss_family != sa->ss_family) {
+
+            const dtn_socket_data *peer = get_peer(self, &data->remote);
+            sa = peer ? &peer->sa : NULL;
+        }
+
+        if (!sa) {
+
+            dtn_log_error("cannot send to %s:%i, dropping datagram",
+                          data->remote.host, data->remote.port);
+
+            out_data_free(data);
+            continue;
+        }
+
+        self->out.pending[count] = data;
+
+        self->out.iov[count] = (struct iovec){.iov_base = data->buffer->start,
+                                              .iov_len = data->buffer->length};
+
+        self->out.msgs[count] = (struct mmsghdr){
+            .msg_hdr.msg_name = (void *)sa,
+            .msg_hdr.msg_namelen = sockaddr_len(sa),
+            .msg_hdr.msg_iov = &self->out.iov[count],
+            .msg_hdr.msg_iovlen = 1};
+
+        count++;
+    }
+
+    return count;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static bool start_sending_queue(dtn_interface_ip *self) {
 
     if (!dtn_thread_lock_try_lock(&self->out.lock))
         goto done;
 
-    struct out_data *data = dtn_list_queue_pop(self->out.queue);
+    bool blocked = false;
 
-    while (data) {
+    while (!blocked) {
 
-        struct sockaddr_storage sa = {0};
-        socklen_t sock_len = sizeof(sa);
+        size_t count = prepare_batch(self);
+        if (0 == count)
+            break;
 
-        int type = AF_INET;
+        int sent = sendmmsg(self->socket, self->out.msgs, count, 0);
 
-        char *ptr = memchr(data->remote.host, '.', strlen(data->remote.host));
+        if (-1 == sent) {
 
-        if (ptr) {
-            sock_len = sizeof(struct sockaddr_in);
-            type = AF_INET;
-        } else {
-            sock_len = sizeof(struct sockaddr_in6);
-            type = AF_INET6;
-        }
+            if ((EAGAIN == errno) || (EWOULDBLOCK == errno) ||
+                (ENOBUFS == errno)) {
 
-        dtn_socket_fill_sockaddr_storage(&sa, type, data->remote.host,
-                                         data->remote.port);
+                blocked = true;
+                sent = 0;
 
-        ssize_t bytes =
-            sendto(self->socket, data->buffer->start, data->buffer->length, 0,
-                   (struct sockaddr *)&sa, sock_len);
+            } else {
 
-        if (-1 == bytes) {
-            dtn_list_queue_push(self->out.queue, data);
-            data = NULL;
+                // no retry of a datagram the socket does not accept
+
+                dtn_log_error("failed to send to %s:%i - %s",
+                              self->out.pending[0]->remote.host,
+                              self->out.pending[0]->remote.port,
+                              strerror(errno));
+                sent = 1;
+            }
+        }
+
+        for (size_t i = 0; i < (size_t)sent; i++) {
+            self->out.pending[i] = out_data_free(self->out.pending[i]);
         }
 
-        data = out_data_free(data);
-        data = dtn_list_queue_pop(self->out.queue);
+        // back to the head of the queue in order
+
+        for (size_t i = count; i > (size_t)sent; i--) {
+
+            if (!dtn_list_push(self->out.queue, self->out.pending[i - 1]))
+                out_data_free(self->out.pending[i - 1]);
+
+            self->out.pending[i - 1] = NULL;
+        }
     }
 
+    wait_for_writable(self, blocked);
+
     if (!dtn_thread_lock_unlock(&self->out.lock)) {
         dtn_log_error("failed to unlock out queue");
     }
@@ -245,141 +421,138 @@ error:
 
 /*---------------------------------------------------------------------------*/
 
-static bool cb_io(int socket, uint8_t event, void *userdata) {
+static dtn_bundle_decoder *get_decoder(dtn_interface_ip *self,
+                                       const dtn_socket_data *remote) {
 
-    uint8_t buffer[2048] = {0};
-    size_t size = 2048;
-    uint8_t *next = NULL;
-    dtn_socket_data remote = {0};
-    socklen_t src_addr_len = sizeof(remote.sa);
+    dtn_socket_data *key = NULL;
 
-    dtn_interface_ip *self = dtn_interface_ip_cast(userdata);
-    if (!self || socket < 1)
+    dtn_bundle_decoder *decoder = dtn_dict_get(self->decoder, remote);
+    if (decoder)
+        return decoder;
+
+    decoder = dtn_bundle_decoder_create((dtn_bundle_decoder_config){0});
+    if (!decoder)
         goto error;
 
-    if (event & DTN_EVENT_IO_ERR || event & DTN_EVENT_IO_CLOSE) {
+    key = calloc(1, sizeof(dtn_socket_data));
+    if (!key)
+        goto error;
 
-        dtn_log_error("failure at interface, socket closed.");
-        TODO("... handle socket close");
+    *key = *remote;
 
-        if (self->config.callbacks.close)
-            self->config.callbacks.close(self->config.callbacks.userdata,
-                                         dtn_interface_ip_name(self));
-    }
+    if (!dtn_dict_set(self->decoder, key, decoder, NULL))
+        goto error;
 
-    ssize_t bytes = recvfrom(socket, (char *)buffer, size, 0,
-                             (struct sockaddr *)&remote.sa, &src_addr_len);
+    return decoder;
+error:
+    dtn_bundle_decoder_free(decoder);
+    dtn_data_pointer_free(key);
+    return NULL;
+}
 
-    if (bytes < 0)
-        goto done;
+/*---------------------------------------------------------------------------*/
 
-    if (!dtn_socket_parse_sockaddr_storage(&remote.sa, remote.host,
-                                           DTN_HOST_NAME_MAX, &remote.port))
-        goto error;
+static bool process_datagram(dtn_interface_ip *self,
+                             const dtn_socket_data *remote,
+                             const uint8_t *buffer, size_t bytes) {
 
-    dtn_buffer *out = dtn_io_buffer_pop(self->buffer, &remote);
-    if (!out)
-        out = dtn_buffer_create(bytes);
-    if (!dtn_buffer_push(out, buffer, bytes))
+    dtn_bundle_decoder *decoder = get_decoder(self, remote);
+    if (!decoder)
         goto error;
 
     dtn_bundle *bundle = NULL;
     dtn_cbor_match match =
-        dtn_bundle_decode(out->start, out->length, &bundle, &next);
-
-    switch (match) {
+        dtn_bundle_decoder_push(decoder, buffer, bytes, &bundle);
 
-    case DTN_CBOR_NO_MATCH:
+    while (DTN_CBOR_MATCH_FULL == match) {
 
-        out = dtn_buffer_free(out);
-        goto error;
-        break;
-
-    case DTN_CBOR_MATCH_PARTIAL:
+        DTN_ASSERT(bundle);
 
-        DTN_ASSERT(next);
+        process_bundle(self, remote, bundle);
+        bundle = NULL;
 
-        if (next - out->start != (int64_t)out->length) {
-            dtn_buffer_free(out);
-            goto error;
-        }
+        if (0 == dtn_bundle_decoder_pending(decoder))
+            break;
 
-        if (!dtn_io_buffer_push(self->buffer, &remote, out->start,
-                                out->length)) {
-            dtn_buffer_free(out);
-            goto error;
-        }
-        goto done;
-        break;
+        match = dtn_bundle_decoder_push(decoder, NULL, 0, &bundle);
+    }
 
-    case DTN_CBOR_MATCH_FULL:
+    if (DTN_CBOR_NO_MATCH == match)
+        goto error;
 
-        DTN_ASSERT(bundle);
-        DTN_ASSERT(next);
+    return true;
+error:
+    return false;
+}
 
-        if (next - out->start < (int64_t)out->length)
-            dtn_io_buffer_push(self->buffer, &remote, next,
-                               (out->length) - (next - out->start));
+/*---------------------------------------------------------------------------*/
 
-        out = dtn_buffer_free(out);
+static bool cb_io(int socket, uint8_t event, void *userdata) {
 
-        break;
-    }
+    bool result = true;
+    dtn_socket_data remote = {0};
+    socklen_t remote_len = 0;
 
-    DTN_ASSERT(!out);
+    dtn_interface_ip *self = dtn_interface_ip_cast(userdata);
+    if (!self || socket < 1)
+        goto error;
 
-    while (bundle) {
+    if (event & DTN_EVENT_IO_ERR || event & DTN_EVENT_IO_CLOSE) {
 
-        process_bundle(self, &remote, bundle);
-        bundle = NULL;
+        dtn_log_error("failure at interface, socket closed.");
+        TODO("... handle socket close");
 
-        out = dtn_io_buffer_pop(self->buffer, &remote);
-        if (!out)
-            break;
+        if (self->config.callbacks.close)
+            self->config.callbacks.close(self->config.callbacks.userdata,
+                                         dtn_interface_ip_name(self));
+    }
 
-        match = dtn_bundle_decode(out->start, out->length, &bundle, &next);
+    if (event & DTN_EVENT_IO_OUT)
+        start_sending_queue(self);
 
-        switch (match) {
+    if (!(event & (DTN_EVENT_IO_IN | DTN_EVENT_IO_ERR)))
+        goto done;
 
-        case DTN_CBOR_NO_MATCH:
+    uint32_t batch = self->config.limits.batch;
 
-            out = dtn_buffer_free(out);
-            goto error;
-            break;
+    for (uint32_t i = 0; i < batch; i++) {
+        self->in.msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
 
-        case DTN_CBOR_MATCH_PARTIAL:
+    int received = recvmmsg(socket, self->in.msgs, batch, MSG_DONTWAIT, NULL);
 
-            DTN_ASSERT(next);
+    if (received < 0)
+        goto done;
 
-            if (next - out->start + 1 != (int64_t)out->length) {
-                dtn_buffer_free(out);
-                goto error;
-            }
+    for (int i = 0; i < received; i++) {
 
-            if (!dtn_io_buffer_push(self->buffer, &remote, out->start,
-                                    out->length)) {
-                dtn_buffer_free(out);
-                goto error;
-            }
-            goto done;
-            break;
+        struct msghdr *hdr = &self->in.msgs[i].msg_hdr;
 
-        case DTN_CBOR_MATCH_FULL:
+        // datagrams of a batch mostly share the sender, parse once
 
-            DTN_ASSERT(bundle);
-            DTN_ASSERT(next);
+        if ((remote_len != hdr->msg_namelen) ||
+            (0 != memcmp(&remote.sa, hdr->msg_name, remote_len))) {
 
-            if (next - out->start < (int64_t)out->length)
-                dtn_io_buffer_push(self->buffer, &remote, next,
-                                   (out->length) - (next - out->start));
+            memset(&remote, 0, sizeof(remote));
+            memcpy(&remote.sa, hdr->msg_name, hdr->msg_namelen);
+            remote_len = hdr->msg_namelen;
 
-            out = dtn_buffer_free(out);
+            if (!dtn_socket_parse_sockaddr_storage(
+                    &remote.sa, remote.host, DTN_HOST_NAME_MAX, &remote.port)) {
 
-            break;
+                remote_len = 0;
+                result = false;
+                continue;
+            }
         }
+
+        if (!process_datagram(self, &remote, hdr->msg_iov->iov_base,
+                              self->in.msgs[i].msg_len))
+            result = false;
     }
+
 done:
-    return true;
+    return result;
 error:
     return false;
 }
@@ -399,6 +572,47 @@ static bool init_config(dtn_interface_ip_config *config) {
     if (0 == config->limits.threadlock_timeout_usecs)
         config->limits.threadlock_timeout_usecs = 100000;
 
+    if (0 == config->limits.batch)
+        config->limits.batch = DTN_INTERFACE_IP_BATCH_DEFAULT;
+
+    return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool init_batches(dtn_interface_ip *self) {
+
+    size_t batch = self->config.limits.batch;
+
+    self->in.buffer = calloc(batch, DTN_INTERFACE_IP_DATAGRAM_MAX);
+    self->in.msgs = calloc(batch, sizeof(struct mmsghdr));
+    self->in.iov = calloc(batch, sizeof(struct iovec));
+    self->in.sa = calloc(batch, sizeof(struct sockaddr_storage));
+
+    self->out.msgs = calloc(batch, sizeof(struct mmsghdr));
+    self->out.iov = calloc(batch, sizeof(struct iovec));
+    self->out.pending = calloc(batch, sizeof(struct out_data *));
+
+    if (!self->in.buffer || !self->in.msgs || !self->in.iov ||
+        !self->in.sa || !self->out.msgs || !self->out.iov ||
+        !self->out.pending)
+        goto error;
+
+    for (size_t i = 0; i < batch; i++) {
+
+        self->in.iov[i] = (struct iovec){
+            .iov_base = self->in.buffer + i * DTN_INTERFACE_IP_DATAGRAM_MAX,
+            .iov_len = DTN_INTERFACE_IP_DATAGRAM_MAX};
+
+        self->in.msgs[i].msg_hdr = (struct msghdr){
+            .msg_name = &self->in.sa[i],
+            .msg_namelen = sizeof(struct sockaddr_storage),
+            .msg_iov = &self->in.iov[i],
+            .msg_iovlen = 1};
+    }
+
     return true;
 error:
     return false;
@@ -419,6 +633,10 @@ dtn_interface_ip *dtn_interface_ip_create(dtn_interface_ip_config config) {
 
     self->magic_byte = DTN_INTERFACE_IP_MAGIC_BYTE;
     self->config = config;
+    self->socket = -1;
+
+    if (!init_batches(self))
+        goto error;
 
     self->socket = dtn_socket_create(self->config.socket, false, NULL);
     if (self->socket < 1) {
@@ -442,8 +660,14 @@ dtn_interface_ip *dtn_interface_ip_create(dtn_interface_ip_config config) {
     if (!start_link_check(self))
         goto error;
 
-    self->buffer = dtn_io_buffer_create((dtn_io_buffer_config){0});
-    if (!self->buffer)
+    self->decoder = dtn_dict_create((dtn_dict_config){
+        .slots = 255,
+        .key.data_function.free = dtn_data_pointer_free,
+        .key.hash = dtn_hash_dtn_socket_data,
+        .key.match = dtn_match_dtn_socket_data,
+        .value.data_function.free = dtn_bundle_decoder_free});
+
+    if (!self->decoder)
         goto error;
 
     if (!dtn_thread_lock_init(&self->out.lock,
@@ -456,6 +680,15 @@ dtn_interface_ip *dtn_interface_ip_create(dtn_interface_ip_config config) {
     if (!self->out.queue)
         goto error;
 
+    self->out.peers = dtn_dict_create((dtn_dict_config){
+        .slots = 255,
+        .key.data_function.free = dtn_data_pointer_free,
+        .key.hash = dtn_hash_dtn_socket_data,
+        .key.match = dtn_match_dtn_socket_data});
+
+    if (!self->out.peers)
+        goto error;
+
     dtn_log_info("IP interface %s:%i activated", self->config.socket.host,
                  self->config.socket.port);
 
@@ -473,17 +706,29 @@ void *dtn_interface_ip_free(void *data) {
     if (!self)
         return data;
 
-    if (self->socket > 0)
+    if (self->socket > 0) {
+        dtn_event_loop_unset(self->config.loop, self->socket, NULL);
         close(self->socket);
+    }
 
-    self->buffer = dtn_io_buffer_free(self->buffer);
+    self->decoder = dtn_dict_free(self->decoder);
 
     if (DTN_TIMER_INVALID != self->timer.link_check) {
         dtn_event_loop_timer_unset(self->config.loop, self->timer.link_check,
                                    NULL);
     }
 
-    close(self->socket);
+    self->out.queue = dtn_list_free(self->out.queue);
+    self->out.peers = dtn_dict_free(self->out.peers);
+
+    free(self->in.buffer);
+    free(self->in.msgs);
+    free(self->in.iov);
+    free(self->in.sa);
+    free(self->out.msgs);
+    free(self->out.iov);
+    free(self->out.pending);
+
     self = dtn_data_pointer_free(self);
     return NULL;
 }
@@ -516,6 +761,16 @@ bool dtn_interface_ip_send(dtn_interface_ip *self,
                            dtn_socket_configuration remote,
                            const uint8_t *buffer, size_t size) {
 
+    return dtn_interface_ip_send_to(self, remote, NULL, buffer, size);
+}
+
+/*------------------------------------------------------------------*/
+
+bool dtn_interface_ip_send_to(dtn_interface_ip *self,
+                              dtn_socket_configuration remote,
+                              const struct sockaddr_storage *address,
+                              const uint8_t *buffer, size_t size) {
+
     struct out_data *data = NULL;
 
     if (!self || !buffer || size < 1)
@@ -526,21 +781,29 @@ bool dtn_interface_ip_send(dtn_interface_ip *self,
         goto error;
 
     data->remote = remote;
+
+    if (address)
+        data->address = *address;
     data->buffer = dtn_buffer_create(size);
     dtn_buffer_push(data->buffer, (uint8_t *)buffer, size);
 
     if (!dtn_thread_lock_try_lock(&self->out.lock))
         goto error;
-    if (!dtn_list_queue_push(self->out.queue, data))
-        goto error;
+
+    bool queued = dtn_list_queue_push(self->out.queue, data);
+
     if (!dtn_thread_lock_unlock(&self->out.lock)) {
         dtn_log_error("failed to unlock out queue");
     }
 
+    if (!queued)
+        goto error;
+
     if (DTN_IP_LINK_UP == self->link)
         start_sending_queue(self);
 
     return true;
 error:
+    out_data_free(data);
     return false;
 }
\ No newline at end of file
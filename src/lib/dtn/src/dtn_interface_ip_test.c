@@ -52,7 +52,7 @@ int test_dtn_interface_ip_create() {
     dtn_interface_ip *self = dtn_interface_ip_create(config);
     testrun(self);
     testrun(dtn_interface_ip_cast(self));
-    testrun(self->buffer) testrun(DTN_TIMER_INVALID != self->timer.link_check);
+    testrun(self->decoder) testrun(DTN_TIMER_INVALID != self->timer.link_check);
 
     testrun(NULL == dtn_interface_ip_free(self));
     testrun(NULL == dtn_event_loop_free(loop));
@@ -297,6 +297,277 @@ int check_io() {
     return testrun_log_success();
 }
 
+/*----------------------------------------------------------------------------*/
+
+struct counter {
+
+    size_t bundles;
+    dtn_socket_data remote;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static void count_io(void *userdata, const dtn_socket_data *remote,
+                     dtn_bundle *bundle, const char *name) {
+
+    UNUSED(name);
+
+    struct counter *counter = (struct counter *)userdata;
+    counter->bundles++;
+    counter->remote = *remote;
+    dtn_bundle_free(bundle);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t encode_test_bundle(uint8_t *buffer, size_t size) {
+
+    dtn_bundle *bundle = dtn_bundle_create();
+
+    dtn_bundle_add_primary_block(bundle, 0, 0, "destination", "source",
+                                 "report", 3, 4, 5, 0, 0);
+    dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("test"));
+
+    uint8_t *next = NULL;
+    bool encoded = dtn_bundle_encode(bundle, buffer, size, &next);
+    dtn_bundle_free(bundle);
+
+    if (!encoded)
+        return 0;
+
+    return next - buffer;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_io_batch() {
+
+    struct counter counter = {0};
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_interface_ip_config config = (dtn_interface_ip_config){
+        .loop = loop,
+        .socket = dtn_socket_load_dynamic_port(
+            (dtn_socket_configuration){.host = "127.0.0.1", .type = UDP}),
+        .limits.batch = 8,
+        .callbacks.userdata = &counter,
+        .callbacks.io = count_io};
+
+    dtn_interface_ip *self = dtn_interface_ip_create(config);
+    testrun(self);
+    testrun(8 == self->config.limits.batch);
+
+    dtn_socket_configuration client_config = dtn_socket_load_dynamic_port(
+        (dtn_socket_configuration){.host = "127.0.0.1", .type = UDP});
+
+    int client = dtn_socket_create(client_config, false, NULL);
+    testrun(client > 0);
+
+    struct sockaddr_storage sa = {0};
+    testrun(dtn_socket_fill_sockaddr_storage(&sa, AF_INET, config.socket.host,
+                                             config.socket.port));
+
+    uint8_t buffer[1024] = {0};
+    size_t size = encode_test_bundle(buffer, sizeof(buffer));
+    testrun(size > 0);
+
+    // more datagrams than one batch are pending
+
+    for (size_t i = 0; i < 10; i++) {
+        testrun((ssize_t)size == sendto(client, buffer, size, 0,
+                                        (struct sockaddr *)&sa,
+                                        sizeof(struct sockaddr_in)));
+    }
+
+    testrun(cb_io(self->socket, DTN_EVENT_IO_IN, self));
+    testrun(8 == counter.bundles);
+    testrun(0 == strcmp("127.0.0.1", counter.remote.host));
+    testrun(client_config.port == counter.remote.port);
+
+    testrun(cb_io(self->socket, DTN_EVENT_IO_IN, self));
+    testrun(10 == counter.bundles);
+
+    // nothing pending
+    testrun(cb_io(self->socket, DTN_EVENT_IO_IN, self));
+    testrun(10 == counter.bundles);
+
+    close(client);
+    testrun(NULL == dtn_interface_ip_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_send_batch() {
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_interface_ip_config config = (dtn_interface_ip_config){
+        .loop = loop,
+        .socket = dtn_socket_load_dynamic_port(
+            (dtn_socket_configuration){.host = "127.0.0.1", .type = UDP}),
+        .limits.batch = 4};
+
+    dtn_interface_ip *self = dtn_interface_ip_create(config);
+    testrun(self);
+
+    dtn_socket_configuration remote = dtn_socket_load_dynamic_port(
+        (dtn_socket_configuration){.host = "127.0.0.1", .type = UDP});
+
+    int client = dtn_socket_create(remote, false, NULL);
+    testrun(client > 0);
+    testrun(dtn_socket_ensure_nonblocking(client));
+
+    // queued while the link is down
+
+    testrun(DTN_IP_LINK_UP != self->link);
+
+    for (uint8_t i = 0; i < 10; i++) {
+        testrun(dtn_interface_ip_send(self, remote, &i, 1));
+    }
+
+    testrun(10 == dtn_list_count(self->out.queue));
+    testrun(0 == dtn_dict_count(self->out.peers));
+
+    // drained in batches and in order once the link is up
+
+    self->link = DTN_IP_LINK_UP;
+    testrun(process_state_change(self));
+    testrun(0 == dtn_list_count(self->out.queue));
+    testrun(!self->out.waiting);
+
+    // one resolved peer for all datagrams
+    testrun(1 == dtn_dict_count(self->out.peers));
+
+    for (uint8_t i = 0; i < 10; i++) {
+
+        uint8_t byte = 0xff;
+        testrun(1 == recv(client, &byte, 1, 0));
+        testrun(i == byte);
+    }
+
+    // an unresolvable remote is dropped instead of being retried
+
+    dtn_socket_configuration invalid = {.host = "host.invalid", .port = 1};
+    testrun(dtn_interface_ip_send(self, invalid, (uint8_t *)"x", 1));
+    testrun(0 == dtn_list_count(self->out.queue));
+    testrun(1 == dtn_dict_count(self->out.peers));
+
+    // a blocked queue waits for the socket to become writable
+
+    testrun(wait_for_writable(self, true));
+    testrun(self->out.waiting);
+
+    uint8_t z = 'z';
+    self->link = DTN_IP_LINK_DOWN;
+    testrun(dtn_interface_ip_send(self, remote, &z, 1));
+    testrun(1 == dtn_list_count(self->out.queue));
+
+    testrun(cb_io(self->socket, DTN_EVENT_IO_OUT, self));
+    testrun(0 == dtn_list_count(self->out.queue));
+    testrun(!self->out.waiting);
+
+    uint8_t byte = 0;
+    testrun(1 == recv(client, &byte, 1, 0));
+    testrun('z' == byte);
+
+    close(client);
+    testrun(NULL == dtn_interface_ip_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int check_send_to() {
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_interface_ip_config config = (dtn_interface_ip_config){
+        .loop = loop,
+        .socket = dtn_socket_load_dynamic_port(
+            (dtn_socket_configuration){.host = "127.0.0.1", .type = UDP})};
+
+    dtn_interface_ip *self = dtn_interface_ip_create(config);
+    testrun(self);
+    self->link = DTN_IP_LINK_UP;
+
+    dtn_socket_configuration remote = dtn_socket_load_dynamic_port(
+        (dtn_socket_configuration){.host = "127.0.0.1", .type = UDP});
+
+    int client = dtn_socket_create(remote, false, NULL);
+    testrun(client > 0);
+    testrun(dtn_socket_ensure_nonblocking(client));
+
+    struct sockaddr_storage address = {0};
+    socklen_t len = sizeof(address);
+    testrun(dtn_socket_configuration_to_sockaddr(remote, &address, &len));
+
+    uint8_t byte = 'a';
+
+    testrun(!dtn_interface_ip_send_to(NULL, remote, &address, &byte, 1));
+    testrun(!dtn_interface_ip_send_to(self, remote, &address, NULL, 1));
+    testrun(!dtn_interface_ip_send_to(self, remote, &address, &byte, 0));
+
+    // sent to the address given, remote is not resolved
+
+    dtn_socket_configuration named = remote;
+    strcpy(named.host, "host.invalid");
+
+    testrun(dtn_interface_ip_send_to(self, named, &address, &byte, 1));
+    testrun(0 == dtn_dict_count(self->out.peers));
+
+    byte = 0;
+    testrun(1 == recv(client, &byte, 1, 0));
+    testrun('a' == byte);
+
+    // remote is resolved without an address
+
+    byte = 'b';
+    address = (struct sockaddr_storage){0};
+    testrun(dtn_interface_ip_send_to(self, remote, &address, &byte, 1));
+    testrun(dtn_interface_ip_send_to(self, remote, NULL, &byte, 1));
+    testrun(1 == dtn_dict_count(self->out.peers));
+
+    byte = 0;
+    testrun(1 == recv(client, &byte, 1, 0));
+    testrun('b' == byte);
+    testrun(1 == recv(client, &byte, 1, 0));
+
+    // an address of another family than the socket resolves remote
+
+    testrun(dtn_socket_fill_sockaddr_storage(&address, AF_INET6, "::1",
+                                             remote.port));
+
+    byte = 'c';
+    testrun(dtn_interface_ip_send_to(self, remote, &address, &byte, 1));
+
+    byte = 0;
+    testrun(1 == recv(client, &byte, 1, 0));
+    testrun('c' == byte);
+
+    // no IPv6 remote for an IPv4 socket
+
+    dtn_socket_configuration ipv6 = remote;
+    strcpy(ipv6.host, "::1");
+    testrun(dtn_interface_ip_send(self, ipv6, (uint8_t *)"d", 1));
+    testrun(1 == dtn_dict_count(self->out.peers));
+    testrun(0 == dtn_list_count(self->out.queue));
+
+    close(client);
+    testrun(NULL == dtn_interface_ip_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+    return testrun_log_success();
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -312,6 +583,9 @@ int all_tests() {
     testrun_test(test_dtn_interface_ip_free);
     testrun_test(test_dtn_interface_ip_name);
     testrun_test(check_io);
+    testrun_test(check_io_batch);
+    testrun_test(check_send_batch);
+    testrun_test(check_send_to);
 
     return testrun_counter;
 }
@@ -31,14 +31,64 @@
 #include "../include/dtn_dtn_uri.h"
 
 #include <dtn_base/dtn_dir.h>
+#include <dtn_base/dtn_hash_functions.h>
 #include <dtn_base/dtn_item_json.h>
 #include <dtn_base/dtn_linked_list.h>
 #include <dtn_base/dtn_socket.h>
+#include <dtn_base/dtn_epoch.h>
 #include <dtn_base/dtn_thread_lock.h>
 
+#include <ctype.h>
+#include <inttypes.h>
+
 #define ROUTING_NAME "router"
 #define ROUTING_CONFIG "/etc/opendtn/dtn_router/routes"
 
+#define ROUTE_KEY_MAX 1024
+#define ROUTE_PREFIX '*'
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ *      Routes are compiled at load into an immutable Table, indexed by an
+ *      open addressing hash over the route key. Keys are "name/demux",
+ *      "name", "ipn:node.service" and "ipn:node", keys ending with '*'
+ *      are prefix routes and used only if no exact route matches.
+ *
+ *      The table is published by dtn_epoch, lookups are lock free and do
+ *      not allocate. Writers are serialized by lock, which is never taken
+ *      by readers.
+ */
+
+typedef struct Route {
+
+    uint64_t hash;
+    size_t length;
+    bool prefix;
+
+    char key[ROUTE_KEY_MAX];
+    dtn_routing_info info;
+
+} Route;
+
+/*---------------------------------------------------------------------------*/
+
+typedef struct Table {
+
+    dtn_item *source; // routes as loaded, for dump and save
+
+    size_t count;
+    size_t size;
+    Route *routes;
+
+    uint64_t mask;
+    uint32_t *slots; // index + 1 of a route, 0 if empty
+
+    size_t prefixes;
+    size_t *lengths; // distinct lengths of prefix routes, longest first
+
+} Table;
+
 /*---------------------------------------------------------------------------*/
 
 struct dtn_routing {
@@ -48,25 +98,369 @@ struct dtn_routing {
     struct {
 
         dtn_thread_lock lock;
-        dtn_item *data;
+        dtn_epoch table;
 
     } routes;
 };
 
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TABLE
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static void *table_free(void *data) {
+
+    Table *table = (Table *)data;
+    if (!table)
+        return NULL;
+
+    table->source = dtn_item_free(table->source);
+    table->routes = dtn_data_pointer_free(table->routes);
+    table->slots = dtn_data_pointer_free(table->slots);
+    table->lengths = dtn_data_pointer_free(table->lengths);
+    return dtn_data_pointer_free(table);
+}
+
 /*---------------------------------------------------------------------------*/
 
-static bool load_config(dtn_routing *self) {
+/**
+ *  Write the canonical form of an ipn key "ipn:node[.service]" to key,
+ *  e.g. "ipn:007.01" becomes "ipn:7.1".
+ *
+ *  @returns length of the key, 0 if string is not an ipn key
+ */
+static size_t ipn_key(const char *string, size_t size, char *key,
+                      size_t max) {
 
-    if (!self)
+    if (size < 5 || 0 != strncmp(string, "ipn:", 4))
+        return 0;
+
+    const char *ptr = string + 4;
+    const char *end = string + size;
+
+    uint64_t node = 0;
+    uint64_t service = 0;
+    bool has_service = false;
+
+    if (!isdigit((unsigned char)*ptr))
+        return 0;
+
+    while (ptr < end && isdigit((unsigned char)*ptr)) {
+        node = node * 10 + (*ptr - '0');
+        ptr++;
+    }
+
+    if (ptr < end && *ptr == '.') {
+
+        ptr++;
+        has_service = true;
+
+        if (ptr == end || !isdigit((unsigned char)*ptr))
+            return 0;
+
+        while (ptr < end && isdigit((unsigned char)*ptr)) {
+            service = service * 10 + (*ptr - '0');
+            ptr++;
+        }
+    }
+
+    if (ptr != end)
+        return 0;
+
+    int bytes = 0;
+
+    if (has_service) {
+        bytes = snprintf(key, max, "ipn:%" PRIu64 ".%" PRIu64, node, service);
+    } else {
+        bytes = snprintf(key, max, "ipn:%" PRIu64, node);
+    }
+
+    if (bytes < 0 || (size_t)bytes >= max)
+        return 0;
+
+    return bytes;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool table_add(Table *table, const char *key, dtn_item const *val) {
+
+    size_t length = strlen(key);
+
+    if (length >= ROUTE_KEY_MAX) {
+        dtn_log_error("route key too long, ignoring %.32s...", key);
+        return true;
+    }
+
+    if (table->count == table->size) {
+
+        size_t size = table->size ? 2 * table->size : 16;
+
+        Route *routes = realloc(table->routes, size * sizeof(Route));
+        if (!routes)
+            goto error;
+
+        table->routes = routes;
+        table->size = size;
+    }
+
+    Route *route = &table->routes[table->count];
+    memset(route, 0, sizeof(Route));
+
+    if ((0 < length) && (ROUTE_PREFIX == key[length - 1])) {
+
+        route->prefix = true;
+        length--;
+        memcpy(route->key, key, length);
+
+    } else {
+
+        size_t canonical = ipn_key(key, length, route->key, ROUTE_KEY_MAX);
+
+        if (0 < canonical) {
+            length = canonical;
+        } else {
+            memcpy(route->key, key, length);
+        }
+    }
+
+    route->length = length;
+    route->hash = dtn_hash_bytes(route->key, length);
+
+    dtn_routing_info_from_item(&route->info, val);
+
+    table->count++;
+    return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool add_uri(const char *key, dtn_item const *val, void *userdata) {
+
+    if (!key)
+        return true;
+
+    return table_add((Table *)userdata, key, val);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool add_file(const char *key, dtn_item const *val, void *userdata) {
+
+    if (!key)
+        return true;
+
+    dtn_item *uris = dtn_item_object_get(val, "uris");
+    if (!uris)
+        return true;
+
+    return dtn_item_object_for_each(uris, add_uri, userdata);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool table_index(Table *table) {
+
+    uint64_t slots = 16;
+
+    while (slots < 2 * table->count)
+        slots *= 2;
+
+    table->mask = slots - 1;
+    table->slots = calloc(slots, sizeof(uint32_t));
+    if (!table->slots)
+        goto error;
+
+    if (table->count > 0) {
+        table->lengths = calloc(table->count, sizeof(size_t));
+        if (!table->lengths)
+            goto error;
+    }
+
+    for (size_t i = 0; i < table->count; i++) {
+
+        Route *route = &table->routes[i];
+
+        uint64_t slot = route->hash & table->mask;
+
+        while (0 != table->slots[slot])
+            slot = (slot + 1) & table->mask;
+
+        table->slots[slot] = i + 1;
+
+        if (!route->prefix)
+            continue;
+
+        // insert sorted, longest first
+
+        size_t n = 0;
+
+        while (n < table->prefixes && table->lengths[n] > route->length)
+            n++;
+
+        if (n < table->prefixes && table->lengths[n] == route->length)
+            continue;
+
+        memmove(table->lengths + n + 1, table->lengths + n,
+                (table->prefixes - n) * sizeof(size_t));
+
+        table->lengths[n] = route->length;
+        table->prefixes++;
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ *  Compile data to a table, data is consumed.
+ */
+static Table *table_create(dtn_item *data) {
+
+    Table *table = calloc(1, sizeof(Table));
+    if (!table) {
+        dtn_item_free(data);
+        goto error;
+    }
+
+    table->source = data;
+
+    if (!dtn_item_object_for_each(data, add_file, table))
+        goto error;
+
+    if (table->count >= UINT32_MAX)
+        goto error;
+
+    if (!table_index(table))
         goto error;
 
-    if (0 == self->config.route_config_path[0])
+    return table;
+error:
+    table_free(table);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ *  Copy the routes of key to routes, starting at routes[count].
+ *  @returns count of routes after the copy
+ */
+static size_t table_find(const Table *table, const char *key, size_t length,
+                         bool prefix, dtn_routing_class class,
+                         dtn_routing_info *routes, size_t count,
+                         size_t max) {
+
+    uint64_t hash = dtn_hash_bytes(key, length);
+    uint64_t slot = hash & table->mask;
+
+    while (count < max && 0 != table->slots[slot]) {
+
+        const Route *route = &table->routes[table->slots[slot] - 1];
+
+        if ((route->hash == hash) && (route->length == length) &&
+            (route->prefix == prefix) &&
+            (0 == memcmp(route->key, key, length))) {
+
+            routes[count] = route->info;
+            routes[count].class = class;
+            count++;
+        }
+
+        slot = (slot + 1) & table->mask;
+    }
+
+    return count;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ *  Lookup key, where key[0..node) is the node name of key,
+ *  node equals length if key contains no demux or service.
+ */
+static size_t table_lookup(const Table *table, const char *key,
+                           size_t length, size_t node,
+                           dtn_routing_info *routes, size_t max) {
+
+    size_t count = 0;
+
+    if (!table)
+        return 0;
+
+    if (node < length)
+        count = table_find(table, key, length, false, DTN_ROUTING_DIRECT,
+                           routes, count, max);
+
+    count = table_find(table, key, node, false, DTN_ROUTING_REGNAME, routes,
+                       count, max);
+
+    if (count > 0)
+        return count;
+
+    for (size_t i = 0; i < table->prefixes; i++) {
+
+        if (table->lengths[i] > length)
+            continue;
+
+        count = table_find(table, key, table->lengths[i], true,
+                           DTN_ROUTING_DEFAULT, routes, count, max);
+
+        if (count > 0)
+            break;
+    }
+
+    return count;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void write_lock(dtn_routing *self) {
+
+    // writers wait for each other instead of failing,
+    // each try waits for the timeout of the lock
+
+    while (!dtn_thread_lock_try_lock(&self->routes.lock))
+        continue;
+
+    return;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void write_unlock(dtn_routing *self) {
+
+    if (!dtn_thread_lock_unlock(&self->routes.lock)) {
+        dtn_log_error("failed to unlock routes");
+    }
+
+    return;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CONFIG
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static bool load_config(dtn_routing *self, const char *path) {
+
+    if (!self || !path || (0 == path[0]))
         goto error;
 
-    dtn_log_debug("loading routes from %s", self->config.route_config_path);
+    dtn_log_debug("loading routes from %s", path);
 
-    dtn_item *routes =
-        dtn_item_json_read_dir(self->config.route_config_path, "route");
+    dtn_item *routes = dtn_item_json_read_dir(path, "route");
 
     if (!routes)
         goto error;
@@ -75,17 +469,21 @@ static bool load_config(dtn_routing *self) {
     dtn_log_debug("loaded routes %s", string);
     string = dtn_data_pointer_free(string);
 
-    if (!dtn_thread_lock_try_lock(&self->routes.lock))
+    // compiled aside, lookups use the current table meanwhile
+
+    Table *table = table_create(routes);
+    if (!table)
         goto error;
 
-    self->routes.data = dtn_item_free(self->routes.data);
-    self->routes.data = routes;
+    write_lock(self);
 
-    if (!dtn_thread_lock_unlock(&self->routes.lock)) {
-        dtn_log_error("failed to unlock routes");
-    }
+    if (path != self->config.route_config_path)
+        strncpy(self->config.route_config_path, path, PATH_MAX - 1);
+
+    dtn_log_info("activated %zu routes from %s", table->count, path);
 
-    dtn_log_info("activated routes from %s", self->config.route_config_path);
+    dtn_epoch_publish(&self->routes.table, table);
+    write_unlock(self);
 
     return true;
 error:
@@ -138,7 +536,9 @@ dtn_routing *dtn_routing_create(dtn_routing_config config) {
                               self->config.limits.threadlock_timeout_usecs))
         goto error;
 
-    if (!load_config(self))
+    dtn_epoch_init(&self->routes.table, NULL, table_free);
+
+    if (!load_config(self, self->config.route_config_path))
         dtn_log_error("failed to load routes for %s",
                       self->config.route_config_path);
 
@@ -157,89 +557,60 @@ dtn_routing *dtn_routing_free(dtn_routing *self) {
         return self;
 
     dtn_thread_lock_clear(&self->routes.lock);
-    self->routes.data = dtn_item_free(self->routes.data);
+    dtn_epoch_clear(&self->routes.table);
+
     self = dtn_data_pointer_free(self);
     return NULL;
 }
 
-/*----------------------------------------------------------------------------*/
-
-struct container {
-
-    dtn_routing *self;
-    const dtn_dtn_uri *uri;
-    dtn_list *list;
-};
+/*---------------------------------------------------------------------------*/
 
-/*----------------------------------------------------------------------------*/
+int64_t dtn_routing_lookup(dtn_routing *self, const char *eid,
+                           dtn_routing_info *routes, size_t max) {
 
-static bool find_socket_config(const char *key, dtn_item const *val,
-                               void *userdata) {
+    char buffer[ROUTE_KEY_MAX];
 
-    dtn_routing_info *info = NULL;
+    if (!self || !eid || !routes)
+        goto error;
 
-    if (!key)
-        return true;
+    size_t size = strlen(eid);
 
-    struct container *container = (struct container *)userdata;
+    const char *key = NULL;
+    size_t length = 0;
+    size_t node = 0;
 
-    if (!container->uri)
-        return true;
-    if (!container->uri->name)
-        return true;
+    if (0 == strncmp(eid, "dtn://", 6)) {
 
-    dtn_item *uris = dtn_item_object_get(val, "uris");
-    if (!uris)
-        goto done;
+        key = eid + 6;
+        length = size - 6;
 
-    dtn_item *uri = dtn_item_object_get(uris, container->uri->name);
-    dtn_item *in = dtn_item_object_get(uri, "interface");
-    const char *interface = dtn_item_get_string(in);
+        const char *slash = memchr(key, '/', length);
+        node = slash ? (size_t)(slash - key) : length;
 
-    if (uri) {
+    } else {
 
-        info = calloc(1, sizeof(dtn_routing_info));
-        if (!info)
+        length = ipn_key(eid, size, buffer, ROUTE_KEY_MAX);
+        if (0 == length)
             goto error;
 
-        info->class = DTN_ROUTING_REGNAME;
-        info->remote = dtn_socket_configuration_from_item(
-            dtn_item_object_get(uri, "socket"));
-
-        if (interface)
-            strncpy(info->interface, interface, strlen(interface));
+        key = buffer;
 
-        dtn_list_push(container->list, info);
+        const char *dot = memchr(key, '.', length);
+        node = dot ? (size_t)(dot - key) : length;
     }
 
-    char dtn_uri[2028] = {0};
-    snprintf(dtn_uri, 2048, "%s/%s", container->uri->name,
-             container->uri->demux);
-
-    uri = dtn_item_object_get(uris, dtn_uri);
-    in = dtn_item_object_get(uri, "interface");
-    interface = dtn_item_get_string(in);
-
-    if (uri) {
-
-        info = calloc(1, sizeof(dtn_routing_info));
-        if (!info)
-            goto error;
-
-        info->class = DTN_ROUTING_DIRECT;
-        info->remote = dtn_socket_configuration_from_item(
-            dtn_item_object_get(uri, "socket"));
+    if (0 == node)
+        goto error;
 
-        if (interface)
-            strncpy(info->interface, interface, strlen(interface));
+    uint64_t epoch = dtn_epoch_enter(&self->routes.table);
 
-        dtn_list_push(container->list, info);
-    }
+    size_t count = table_lookup(dtn_epoch_data(&self->routes.table), key,
+                                length, node, routes, max);
 
-done:
-    return true;
+    dtn_epoch_leave(&self->routes.table, epoch);
+    return count;
 error:
-    return false;
+    return -1;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -247,23 +618,55 @@ error:
 dtn_list *dtn_routing_get_info_for_uri(dtn_routing *self,
                                        const dtn_dtn_uri *uri) {
 
-    struct container container =
-        (struct container){.self = self,
-                           .uri = uri,
-                           .list = dtn_linked_list_create((dtn_list_config){
-                               .item.free = dtn_data_pointer_free})};
+    dtn_list *list = NULL;
+    dtn_routing_info routes[DTN_ROUTING_LOOKUP_MAX];
+    char key[ROUTE_KEY_MAX];
 
-    if (!dtn_thread_lock_try_lock(&self->routes.lock))
+    if (!self || !uri || !uri->name)
         goto error;
 
-    dtn_item_object_for_each(self->routes.data, find_socket_config, &container);
+    int bytes = 0;
 
-    if (!dtn_thread_lock_unlock(&self->routes.lock)) {
-        dtn_log_error("failed to unlock routes");
+    if (uri->demux) {
+        bytes = snprintf(key, ROUTE_KEY_MAX, "%s/%s", uri->name, uri->demux);
+    } else {
+        bytes = snprintf(key, ROUTE_KEY_MAX, "%s", uri->name);
+    }
+
+    if (bytes < 0 || bytes >= ROUTE_KEY_MAX)
+        goto error;
+
+    list = dtn_linked_list_create(
+        (dtn_list_config){.item.free = dtn_data_pointer_free});
+
+    if (!list)
+        goto error;
+
+    uint64_t epoch = dtn_epoch_enter(&self->routes.table);
+
+    size_t count =
+        table_lookup(dtn_epoch_data(&self->routes.table), key, bytes,
+                     strlen(uri->name), routes, DTN_ROUTING_LOOKUP_MAX);
+
+    dtn_epoch_leave(&self->routes.table, epoch);
+
+    for (size_t i = 0; i < count; i++) {
+
+        dtn_routing_info *info = calloc(1, sizeof(dtn_routing_info));
+        if (!info)
+            goto error;
+
+        *info = routes[i];
+
+        if (!dtn_list_push(list, info)) {
+            info = dtn_data_pointer_free(info);
+            goto error;
+        }
     }
 
-    return container.list;
+    return list;
 error:
+    dtn_list_free(list);
     return NULL;
 }
 
@@ -271,12 +674,21 @@ error:
 
 bool dtn_routing_load(dtn_routing *self, const char *path) {
 
+    char current[PATH_MAX] = {0};
+
     if (!self)
         goto error;
 
-    if (path)
-        strncpy(self->config.route_config_path, path, PATH_MAX);
-    return load_config(self);
+    if (!path) {
+
+        write_lock(self);
+        strncpy(current, self->config.route_config_path, PATH_MAX - 1);
+        write_unlock(self);
+
+        path = current;
+    }
+
+    return load_config(self, path);
 
 error:
     return false;
@@ -322,15 +734,16 @@ bool dtn_routing_save(dtn_routing *self, const char *path) {
     struct container2 container =
         (struct container2){.self = self, .path = path};
 
-    if (!dtn_thread_lock_try_lock(&self->routes.lock))
-        goto error;
+    // the table is not replaced within write_lock
 
-    dtn_item_object_for_each(self->routes.data, write_route_info, &container);
+    write_lock(self);
 
-    if (!dtn_thread_lock_unlock(&self->routes.lock)) {
-        dtn_log_error("failed to unlock routes");
-    }
+    Table *table = dtn_epoch_data(&self->routes.table);
 
+    if (table)
+        dtn_item_object_for_each(table->source, write_route_info, &container);
+
+    write_unlock(self);
     return true;
 
 error:
@@ -344,19 +757,117 @@ bool dtn_routing_dump(FILE *file, dtn_routing *self) {
     if (!file || !self)
         goto error;
 
-    if (!dtn_thread_lock_try_lock(&self->routes.lock))
-        goto error;
+    write_lock(self);
 
-    char *string = dtn_item_to_json(self->routes.data);
+    Table *table = dtn_epoch_data(&self->routes.table);
+
+    char *string = dtn_item_to_json(table ? table->source : NULL);
     fprintf(file, "\n%s\n", string);
     string = dtn_data_pointer_free(string);
 
-    if (!dtn_thread_lock_unlock(&self->routes.lock)) {
-        dtn_log_error("failed to unlock routes");
+    write_unlock(self);
+    return true;
+
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool dtn_routing_info_from_item(dtn_routing_info *info, const dtn_item *item) {
+
+    if (!info || !item)
+        goto error;
+
+    *info = (dtn_routing_info){0};
+
+    info->remote =
+        dtn_socket_configuration_from_item(dtn_item_object_get(item, "socket"));
+
+    const char *interface =
+        dtn_item_get_string(dtn_item_object_get(item, "interface"));
+
+    if (interface)
+        strncpy(info->interface, interface, DTN_HOST_NAME_MAX - 1);
+
+    if (0 == info->remote.host[0])
+        return true;
+
+    // next hops are sent datagrams, resolved for any address family
+
+    dtn_socket_configuration remote = info->remote;
+    remote.type = UDP;
+
+    socklen_t len = sizeof(info->address);
+
+    if (!dtn_socket_configuration_to_sockaddr(remote, &info->address, &len)) {
+
+        memset(&info->address, 0, sizeof(info->address));
+        dtn_log_debug("route to %s not resolved", info->remote.host);
     }
 
     return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool dtn_routing_info_to_key(const dtn_routing_info *info, char *key,
+                             size_t size) {
+
+    if (!info || !key || size == 0)
+        goto error;
+
+    int bytes = snprintf(key, size, "%s|%s:%" PRIu16, info->interface,
+                         info->remote.host, info->remote.port);
+
+    if (bytes < 0 || (size_t)bytes >= size)
+        goto error;
+
+    return true;
+error:
+    if (key && size > 0)
+        key[0] = 0;
+    return false;
+}
 
+/*---------------------------------------------------------------------------*/
+
+bool dtn_routing_info_from_key(dtn_routing_info *info, const char *key) {
+
+    if (!info || !key)
+        goto error;
+
+    const char *bar = strchr(key, '|');
+    const char *colon = strrchr(key, ':');
+
+    if (!bar || !colon || colon < bar)
+        goto error;
+
+    size_t interface = bar - key;
+    size_t host = colon - bar - 1;
+
+    if (interface == 0 || interface >= DTN_HOST_NAME_MAX)
+        goto error;
+
+    if (host == 0 || host >= DTN_HOST_NAME_MAX)
+        goto error;
+
+    char *end = NULL;
+    unsigned long port = strtoul(colon + 1, &end, 10);
+
+    if ((end == colon + 1) || (0 != *end) || (port > UINT16_MAX))
+        goto error;
+
+    *info = (dtn_routing_info){.class = DTN_ROUTING_DIRECT};
+
+    memcpy(info->interface, key, interface);
+    memcpy(info->remote.host, bar + 1, host);
+    info->remote.port = port;
+    info->remote.type = UDP;
+
+    return true;
 error:
     return false;
-}
\ No newline at end of file
+}
@@ -30,10 +30,39 @@
 #include "dtn_routing.c"
 #include <dtn_base/testrun.h>
 
+#include <pthread.h>
+
 #ifndef DTN_TEST_RESOURCE_DIR
 #error "Must provide -D DTN_TEST_RESOURCE_DIR=value while compiling this file."
 #endif
 
+static const char *routes_json =
+    "{\"uris\":{"
+    "\"node/a\":{\"interface\":\"eth0\","
+    "\"socket\":{\"host\":\"127.0.0.1\",\"port\":1,\"type\":\"UDP\"}},"
+    "\"node\":{\"interface\":\"eth1\","
+    "\"socket\":{\"host\":\"127.0.0.1\",\"port\":2,\"type\":\"UDP\"}},"
+    "\"ipn:05.1\":{\"interface\":\"eth2\","
+    "\"socket\":{\"host\":\"::1\",\"port\":3,\"type\":\"UDP\"}},"
+    "\"ipn:5\":{\"interface\":\"eth3\","
+    "\"socket\":{\"host\":\"host.invalid\",\"port\":4,\"type\":\"UDP\"}},"
+    "\"ground*\":{\"interface\":\"eth4\"},"
+    "\"ground/station*\":{\"interface\":\"eth5\"},"
+    "\"*\":{\"interface\":\"eth6\"}}}";
+
+/*----------------------------------------------------------------------------*/
+
+static bool write_routes(const char *path, const char *json) {
+
+    char file[PATH_MAX] = {0};
+    snprintf(file, PATH_MAX, "%s/test.route", path);
+
+    dtn_item *item = dtn_item_from_json(json);
+    bool result = dtn_item_json_write_file(file, item);
+    dtn_item_free(item);
+    return result;
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -55,7 +84,7 @@ int test_dtn_routing_create() {
 
     dtn_routing *self = dtn_routing_create(config);
     testrun(self);
-    testrun(self->routes.data);
+    testrun(dtn_epoch_data(&self->routes.table));
 
     testrun(NULL == dtn_routing_free(self));
     testrun(NULL == dtn_event_loop_free(loop));
@@ -78,7 +107,7 @@ int test_dtn_routing_free() {
 
     dtn_routing *self = dtn_routing_create(config);
     testrun(self);
-    testrun(self->routes.data);
+    testrun(dtn_epoch_data(&self->routes.table));
 
     testrun(NULL == dtn_routing_free(self));
     testrun(NULL == dtn_event_loop_free(loop));
@@ -157,6 +186,392 @@ int test_dtn_routing_load() {
     return testrun_log_success();
 }
 
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_routing_lookup() {
+
+    dtn_event_loop_config loop_config =
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100};
+
+    dtn_event_loop *loop = dtn_event_loop_default(loop_config);
+    testrun(loop);
+
+    dtn_routing_config config = (dtn_routing_config){
+        .loop = loop, .route_config_path = DTN_TEST_RESOURCE_DIR "/routes"};
+
+    dtn_routing *self = dtn_routing_create(config);
+    testrun(self);
+
+    dtn_routing_info routes[DTN_ROUTING_LOOKUP_MAX] = {0};
+
+    testrun(-1 == dtn_routing_lookup(NULL, "dtn://test/one", routes, 8));
+    testrun(-1 == dtn_routing_lookup(self, NULL, routes, 8));
+    testrun(-1 == dtn_routing_lookup(self, "dtn://test/one", NULL, 8));
+    testrun(-1 == dtn_routing_lookup(self, "dtn:none", routes, 8));
+    testrun(-1 == dtn_routing_lookup(self, "dtn:///one", routes, 8));
+    testrun(-1 == dtn_routing_lookup(self, "ipn:x.1", routes, 8));
+    testrun(-1 == dtn_routing_lookup(self, "ipn:1.", routes, 8));
+
+    testrun(0 == dtn_routing_lookup(self, "dtn://unknown/one", routes, 8));
+    testrun(0 == dtn_routing_lookup(self, "dtn://test/three", routes, 8));
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://test/one", routes, 8));
+    testrun(DTN_ROUTING_DIRECT == routes[0].class);
+    testrun(0 == strcmp("127.0.0.1", routes[0].interface));
+    testrun(0 == strcmp("127.0.0.1", routes[0].remote.host));
+    testrun(4556 == routes[0].remote.port);
+    testrun(AF_INET == routes[0].address.ss_family);
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://default", routes, 8));
+    testrun(DTN_ROUTING_REGNAME == routes[0].class);
+    testrun(0 == routes[0].remote.host[0]);
+    testrun(AF_UNSPEC == routes[0].address.ss_family);
+
+    testrun(0 == dtn_routing_lookup(self, "dtn://test/one", routes, 0));
+
+    char path[PATH_MAX] = "/tmp/dtn_routing_XXXXXX";
+    testrun(mkdtemp(path));
+    testrun(write_routes(path, routes_json));
+    testrun(dtn_routing_load(self, path));
+
+    // direct before name
+
+    testrun(2 == dtn_routing_lookup(self, "dtn://node/a", routes, 8));
+    testrun(DTN_ROUTING_DIRECT == routes[0].class);
+    testrun(0 == strcmp("eth0", routes[0].interface));
+    testrun(1 == routes[0].remote.port);
+    testrun(DTN_ROUTING_REGNAME == routes[1].class);
+    testrun(0 == strcmp("eth1", routes[1].interface));
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://node/a", routes, 1));
+    testrun(DTN_ROUTING_DIRECT == routes[0].class);
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://node/b", routes, 8));
+    testrun(DTN_ROUTING_REGNAME == routes[0].class);
+    testrun(0 == strcmp("eth1", routes[0].interface));
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://node", routes, 8));
+    testrun(DTN_ROUTING_REGNAME == routes[0].class);
+
+    // ipn numbers are compared canonical
+
+    testrun(2 == dtn_routing_lookup(self, "ipn:5.1", routes, 8));
+    testrun(DTN_ROUTING_DIRECT == routes[0].class);
+    testrun(0 == strcmp("eth2", routes[0].interface));
+    testrun(AF_INET6 == routes[0].address.ss_family);
+    testrun(DTN_ROUTING_REGNAME == routes[1].class);
+    testrun(0 == strcmp("eth3", routes[1].interface));
+    testrun(AF_UNSPEC == routes[1].address.ss_family);
+
+    testrun(2 == dtn_routing_lookup(self, "ipn:005.0001", routes, 8));
+    testrun(1 == dtn_routing_lookup(self, "ipn:5.2", routes, 8));
+    testrun(0 == strcmp("eth3", routes[0].interface));
+    testrun(1 == dtn_routing_lookup(self, "ipn:5", routes, 8));
+    testrun(0 == strcmp("eth3", routes[0].interface));
+
+    // longest prefix
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://ground/station1", routes, 8));
+    testrun(DTN_ROUTING_DEFAULT == routes[0].class);
+    testrun(0 == strcmp("eth5", routes[0].interface));
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://ground/station", routes, 8));
+    testrun(0 == strcmp("eth5", routes[0].interface));
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://groundx/1", routes, 8));
+    testrun(0 == strcmp("eth4", routes[0].interface));
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://other/1", routes, 8));
+    testrun(0 == strcmp("eth6", routes[0].interface));
+
+    testrun(1 == dtn_routing_lookup(self, "ipn:6.1", routes, 8));
+    testrun(DTN_ROUTING_DEFAULT == routes[0].class);
+    testrun(0 == strcmp("eth6", routes[0].interface));
+
+    // routes of the previous load are gone
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://test/one", routes, 8));
+    testrun(0 == strcmp("eth6", routes[0].interface));
+
+    testrun(dtn_dir_tree_remove(path));
+
+    testrun(NULL == dtn_routing_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct reader {
+
+    dtn_routing *routing;
+    atomic_bool *stop;
+
+    uint64_t lookups;
+    uint64_t failed;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static void *lookup_routes(void *arg) {
+
+    struct reader *reader = (struct reader *)arg;
+    dtn_routing_info routes[DTN_ROUTING_LOOKUP_MAX];
+
+    while (!atomic_load(reader->stop)) {
+
+        int64_t count = dtn_routing_lookup(reader->routing, "dtn://test/one",
+                                           routes, DTN_ROUTING_LOOKUP_MAX);
+
+        if ((1 != count) || ((4556 != routes[0].remote.port) &&
+                             (9999 != routes[0].remote.port)))
+            reader->failed++;
+
+        reader->lookups++;
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_routing_reload() {
+
+    dtn_event_loop_config loop_config =
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100};
+
+    dtn_event_loop *loop = dtn_event_loop_default(loop_config);
+    testrun(loop);
+
+    dtn_routing_config config = (dtn_routing_config){
+        .loop = loop, .route_config_path = DTN_TEST_RESOURCE_DIR "/routes"};
+
+    dtn_routing *self = dtn_routing_create(config);
+    testrun(self);
+
+    char path[PATH_MAX] = "/tmp/dtn_routing_XXXXXX";
+    testrun(mkdtemp(path));
+    testrun(write_routes(
+        path, "{\"uris\":{\"test/one\":{\"interface\":\"eth0\","
+              "\"socket\":{\"host\":\"127.0.0.1\",\"port\":9999,"
+              "\"type\":\"UDP\"}}}}"));
+
+    atomic_bool stop;
+    atomic_init(&stop, false);
+
+    struct reader readers[4] = {0};
+    pthread_t threads[4];
+
+    for (size_t i = 0; i < 4; i++) {
+        readers[i] = (struct reader){.routing = self, .stop = &stop};
+        testrun(0 == pthread_create(&threads[i], NULL, lookup_routes,
+                                    &readers[i]));
+    }
+
+    // readers never fail while tables are replaced and freed
+
+    for (size_t i = 0; i < 100; i++) {
+        testrun(dtn_routing_load(self, path));
+        testrun(dtn_routing_load(self, DTN_TEST_RESOURCE_DIR "/routes"));
+    }
+
+    testrun(dtn_routing_load(self, path));
+    testrun(0 == strcmp(path, self->config.route_config_path));
+
+    atomic_store(&stop, true);
+
+    for (size_t i = 0; i < 4; i++) {
+        testrun(0 == pthread_join(threads[i], NULL));
+        testrun(0 < readers[i].lookups);
+        testrun(0 == readers[i].failed);
+    }
+
+    dtn_routing_info routes[DTN_ROUTING_LOOKUP_MAX] = {0};
+
+    testrun(1 == dtn_routing_lookup(self, "dtn://test/one", routes, 8));
+    testrun(9999 == routes[0].remote.port);
+
+    // a failed load keeps the current table
+
+    testrun(!dtn_routing_load(self, "/nonexisting/routes"));
+    testrun(1 == dtn_routing_lookup(self, "dtn://test/one", routes, 8));
+    testrun(9999 == routes[0].remote.port);
+
+    // reload of the current path
+
+    testrun(dtn_routing_load(self, NULL));
+    testrun(1 == dtn_routing_lookup(self, "dtn://test/one", routes, 8));
+    testrun(9999 == routes[0].remote.port);
+
+    testrun(dtn_dir_tree_remove(path));
+
+    testrun(NULL == dtn_routing_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_routing_get_info_for_uri() {
+
+    dtn_event_loop_config loop_config =
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100};
+
+    dtn_event_loop *loop = dtn_event_loop_default(loop_config);
+    testrun(loop);
+
+    dtn_routing_config config = (dtn_routing_config){
+        .loop = loop, .route_config_path = DTN_TEST_RESOURCE_DIR "/routes"};
+
+    dtn_routing *self = dtn_routing_create(config);
+    testrun(self);
+
+    dtn_dtn_uri *uri = dtn_dtn_uri_decode("dtn://test/two");
+    testrun(uri);
+
+    testrun(NULL == dtn_routing_get_info_for_uri(NULL, uri));
+    testrun(NULL == dtn_routing_get_info_for_uri(self, NULL));
+
+    dtn_list *list = dtn_routing_get_info_for_uri(self, uri);
+    testrun(list);
+    testrun(1 == list->count(list));
+
+    dtn_routing_info *info = dtn_list_get(list, 1);
+    testrun(info);
+    testrun(DTN_ROUTING_DIRECT == info->class);
+    testrun(4557 == info->remote.port);
+
+    list = dtn_list_free(list);
+    uri = dtn_dtn_uri_free(uri);
+
+    uri = dtn_dtn_uri_decode("dtn://none/two");
+    list = dtn_routing_get_info_for_uri(self, uri);
+    testrun(list);
+    testrun(0 == list->count(list));
+
+    list = dtn_list_free(list);
+    uri = dtn_dtn_uri_free(uri);
+
+    testrun(NULL == dtn_routing_free(self));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_routing_info_from_item() {
+
+    dtn_routing_info info = {0};
+
+    dtn_item *item = dtn_item_from_json(
+        "{\"interface\":\"eth0\","
+        "\"socket\":{\"host\":\"127.0.0.1\",\"port\":1,\"type\":\"UDP\"}}");
+    testrun(item);
+
+    testrun(!dtn_routing_info_from_item(NULL, item));
+    testrun(!dtn_routing_info_from_item(&info, NULL));
+
+    testrun(dtn_routing_info_from_item(&info, item));
+    testrun(0 == strcmp("eth0", info.interface));
+    testrun(0 == strcmp("127.0.0.1", info.remote.host));
+    testrun(AF_INET == info.address.ss_family);
+    testrun(htons(1) == ((struct sockaddr_in *)&info.address)->sin_port);
+    item = dtn_item_free(item);
+
+    // family of the address, not of the notation
+
+    item = dtn_item_from_json(
+        "{\"interface\":\"eth0\","
+        "\"socket\":{\"host\":\"::ffff:127.0.0.1\",\"port\":2,"
+        "\"type\":\"TCP\"}}");
+    testrun(dtn_routing_info_from_item(&info, item));
+    testrun(AF_INET6 == info.address.ss_family);
+    testrun(htons(2) == ((struct sockaddr_in6 *)&info.address)->sin6_port);
+    item = dtn_item_free(item);
+
+    item = dtn_item_from_json(
+        "{\"interface\":\"eth0\","
+        "\"socket\":{\"host\":\"host.invalid\",\"port\":3,"
+        "\"type\":\"UDP\"}}");
+    testrun(dtn_routing_info_from_item(&info, item));
+    testrun(AF_UNSPEC == info.address.ss_family);
+    item = dtn_item_free(item);
+
+    item = dtn_item_from_json("{\"interface\":\"eth0\"}");
+    testrun(dtn_routing_info_from_item(&info, item));
+    testrun(0 == info.remote.host[0]);
+    testrun(AF_UNSPEC == info.address.ss_family);
+    item = dtn_item_free(item);
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_routing_info_to_key() {
+
+    char key[DTN_ROUTING_KEY_MAX] = {0};
+
+    dtn_routing_info info = (dtn_routing_info){
+        .class = DTN_ROUTING_REGNAME,
+        .remote = (dtn_socket_configuration){
+            .host = "127.0.0.1", .port = 4556, .type = UDP},
+        .interface = "192.168.1.1"};
+
+    testrun(!dtn_routing_info_to_key(NULL, key, sizeof(key)));
+    testrun(!dtn_routing_info_to_key(&info, NULL, sizeof(key)));
+    testrun(!dtn_routing_info_to_key(&info, key, 0));
+
+    testrun(dtn_routing_info_to_key(&info, key, sizeof(key)));
+    testrun(0 == strcmp(key, "192.168.1.1|127.0.0.1:4556"));
+
+    testrun(!dtn_routing_info_to_key(&info, key, 10));
+    testrun(0 == key[0]);
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_routing_info_from_key() {
+
+    char key[DTN_ROUTING_KEY_MAX] = {0};
+    dtn_routing_info info = {0};
+
+    testrun(!dtn_routing_info_from_key(NULL, "a|b:1"));
+    testrun(!dtn_routing_info_from_key(&info, NULL));
+    testrun(!dtn_routing_info_from_key(&info, ""));
+    testrun(!dtn_routing_info_from_key(&info, "a"));
+    testrun(!dtn_routing_info_from_key(&info, "a|b"));
+    testrun(!dtn_routing_info_from_key(&info, "|b:1"));
+    testrun(!dtn_routing_info_from_key(&info, "a|:1"));
+    testrun(!dtn_routing_info_from_key(&info, "a|b:"));
+    testrun(!dtn_routing_info_from_key(&info, "a|b:1x"));
+    testrun(!dtn_routing_info_from_key(&info, "a|b:65536"));
+    testrun(!dtn_routing_info_from_key(&info, "a:1|b"));
+
+    testrun(dtn_routing_info_from_key(&info, "192.168.1.1|127.0.0.1:4556"));
+    testrun(DTN_ROUTING_DIRECT == info.class);
+    testrun(0 == strcmp(info.interface, "192.168.1.1"));
+    testrun(0 == strcmp(info.remote.host, "127.0.0.1"));
+    testrun(4556 == info.remote.port);
+    testrun(UDP == info.remote.type);
+
+    // IPv6 hosts are split at the last colon
+    testrun(dtn_routing_info_from_key(&info, "::1|::1:4556"));
+    testrun(0 == strcmp(info.interface, "::1"));
+    testrun(0 == strcmp(info.remote.host, "::1"));
+    testrun(4556 == info.remote.port);
+
+    testrun(dtn_routing_info_to_key(&info, key, sizeof(key)));
+    testrun(0 == strcmp(key, "::1|::1:4556"));
+
+    return testrun_log_success();
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -173,6 +588,12 @@ int all_tests() {
     testrun_test(test_dtn_routing_dump);
     testrun_test(test_dtn_routing_save);
     testrun_test(test_dtn_routing_load);
+    testrun_test(test_dtn_routing_lookup);
+    testrun_test(test_dtn_routing_reload);
+    testrun_test(test_dtn_routing_get_info_for_uri);
+    testrun_test(test_dtn_routing_info_from_item);
+    testrun_test(test_dtn_routing_info_to_key);
+    testrun_test(test_dtn_routing_info_from_key);
 
     return testrun_counter;
 }
@@ -37,4 +37,11 @@
 // RFC 1662
 uint16_t crc16x25(const uint8_t *buffer, size_t size);
 
+/**
+        Rolling update of a CRC16 X25, use init value of 0. The result
+        equals crc16x25 over all chunks.
+*/
+uint16_t dtn_crc16x25_update(uint16_t crc, const uint8_t *buffer,
+                             size_t size);
+
 #endif /* dtn_crc16_h */
@@ -130,5 +130,42 @@ uint32_t dtn_crc32_zlib(uint32_t init, uint8_t const *data, size_t len_octets);
  */
 uint32_t dtn_crc32c(uint8_t const *data, size_t len_octets);
 
+/**
+ * Rolling update of a CRC32C checksum, use init value of 0:
+ *
+ * uint32_t crc = dtn_crc32c_update(0, chunk1, sizeof(chunk1));
+ * crc = dtn_crc32c_update(crc, chunk2, sizeof(chunk2));
+ *
+ * The result equals dtn_crc32c over all chunks, no final XOR is required.
+ *
+ * The engine is selected once at runtime, the SSE4.2 crc32 instruction
+ * if the CPU supports it, slice-by-8 lookup tables otherwise.
+ */
+uint32_t dtn_crc32c_update(uint32_t crc, uint8_t const *data,
+                           size_t len_octets);
+
+/*----------------------------------------------------------------------------*/
+
+typedef enum dtn_crc32c_engine {
+
+    DTN_CRC32C_AUTO = 0,
+    DTN_CRC32C_TABLE,  // byte wise lookup table
+    DTN_CRC32C_SLICE8, // slice-by-8 lookup tables
+    DTN_CRC32C_SSE42   // crc32 instruction, x86_64 only
+
+} dtn_crc32c_engine;
+
+/**
+ * Engine used by dtn_crc32c_update, never DTN_CRC32C_AUTO.
+ */
+dtn_crc32c_engine dtn_crc32c_engine_active();
+
+/**
+ * dtn_crc32c_update with a dedicated engine, e.g. for benchmarks.
+ * DTN_CRC32C_SSE42 falls back to DTN_CRC32C_SLICE8 if not supported.
+ */
+uint32_t dtn_crc32c_update_engine(dtn_crc32c_engine engine, uint32_t crc,
+                                  uint8_t const *data, size_t len_octets);
+
 /*----------------------------------------------------------------------------*/
 #endif
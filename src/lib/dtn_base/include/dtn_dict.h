@@ -48,8 +48,18 @@
 typedef struct dtn_dict dtn_dict;
 typedef struct dtn_dict_config dtn_dict_config;
 
+typedef enum dtn_dict_type {
+
+    DTN_DICT_CHAINED = 0, // default, buckets with overflow lists
+    DTN_DICT_FLAT = 1     // open addressing, @see dtn_flat_dict.h
+
+} dtn_dict_type;
+
 struct dtn_dict_config {
 
+    /* Implementation to be used by dtn_dict_create */
+    dtn_dict_type type;
+
     /* Buckets to be used */
     uint64_t slots;
 
@@ -158,6 +168,9 @@ struct dtn_dict {
         which means it need to include a hash as well as a match
         function for keys, and a given slotsize > 0
         MOST used config will be @see dtn_dict_string_key_config
+
+        config.type DTN_DICT_FLAT creates an open addressing dict,
+        @see dtn_flat_dict_create
 */
 dtn_dict *dtn_dict_create(dtn_dict_config config);
 
@@ -229,7 +242,7 @@ bool dtn_dict_for_each(dtn_dict *dict, void *data,
                 .key.data_function.copy         = dtn_data_string_copy,
                 .key.data_function.dump         = dtn_data_string_dump,
 
-                .key.hash                       = dtn_hash_pearson_c_string,
+                .key.hash                       = dtn_hash_c_string,
                 .key.match                      = dtn_match_c_string_strict,
 
                 .value.data_function.free       = NULL,
@@ -0,0 +1,121 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_epoch.h
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        @ingroup        dtn_base
+
+        @brief          Epoch based reclamation of published data.
+
+        Data is published as an immutable snapshot, readers access the
+        current snapshot between dtn_epoch_enter and dtn_epoch_leave
+        without taking a lock.
+
+        Readers register within the readers of the current epoch.
+        Publishing advances the epoch and frees the previous snapshot
+        once all readers registered within the previous epoch left.
+
+        Publishing MUST be serialized by the caller, e.g. by a lock of
+        the writers, which is never taken by readers.
+
+        ------------------------------------------------------------------------
+*/
+#ifndef dtn_epoch_h
+#define dtn_epoch_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_epoch {
+
+    _Atomic(void *) data;
+
+    atomic_uint_fast64_t epoch;
+    atomic_uint_fast64_t readers[2];
+
+    void *(*free)(void *data);
+
+} dtn_epoch;
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+        Initialize self with data as first snapshot.
+
+        @param data     first snapshot, may be NULL
+        @param free     free function of snapshots, may be NULL
+*/
+bool dtn_epoch_init(dtn_epoch *self, void *data, void *(*free)(void *data));
+
+/**
+        Free the current snapshot.
+        YOU need to ENSURE that there are no readers and writers anymore.
+*/
+bool dtn_epoch_clear(dtn_epoch *self);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+        Register as reader.
+
+        @returns epoch to leave
+*/
+uint64_t dtn_epoch_enter(dtn_epoch *self);
+
+/*----------------------------------------------------------------------------*/
+
+void dtn_epoch_leave(dtn_epoch *self, uint64_t epoch);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Current snapshot, valid until dtn_epoch_leave for readers and
+        until the next publish for writers.
+*/
+void *dtn_epoch_data(dtn_epoch *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Publish data as current snapshot. Waits for the readers of the
+        previous snapshot and frees it.
+*/
+bool dtn_epoch_publish(dtn_epoch *self, void *data);
+
+#endif /* dtn_epoch_h */
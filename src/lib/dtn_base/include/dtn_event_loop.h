@@ -85,6 +85,7 @@
 
 #define DTN_EVENT_LOOP_MAX_SOCKETS_DEFAULT 1024
 #define DTN_EVENT_LOOP_MAX_TIMERS_DEFAULT 1024
+#define DTN_EVENT_LOOP_MAX_EVENTS_DEFAULT 64
 
 #define DTN_EVENT_LOOP_SOCKETS_MIN 1
 #define DTN_EVENT_LOOP_TIMERS_MIN 1
@@ -102,25 +103,60 @@
 #define DTN_EVENT_LOOP_KEY "eventloop"
 #define DTN_EVENT_LOOP_KEY_MAX_SOCKETS "sockets"
 #define DTN_EVENT_LOOP_KEY_MAX_TIMERS "timers"
+#define DTN_EVENT_LOOP_KEY_MAX_EVENTS "events"
+#define DTN_EVENT_LOOP_KEY_BACKEND "backend"
 
 typedef struct dtn_event_loop dtn_event_loop;
 typedef struct dtn_event_loop_config dtn_event_loop_config;
 typedef struct dtn_event_loop_event dtn_event_loop_event;
+typedef struct dtn_event_loop_statistics dtn_event_loop_statistics;
+
+/*---------------------------------------------------------------------------*/
+
+/**
+        Backend of the event loop created by dtn_os_event_loop.
+        Backends not available on the platform fall back to the default.
+*/
+typedef enum dtn_event_loop_backend {
+
+    DTN_EVENT_LOOP_BACKEND_DEFAULT = 0, // best backend of the platform
+    DTN_EVENT_LOOP_BACKEND_POLL,        // POSIX poll
+    DTN_EVENT_LOOP_BACKEND_EPOLL,       // Linux epoll
+    DTN_EVENT_LOOP_BACKEND_IO_URING     // Linux io_uring, epoll fallback
+
+} dtn_event_loop_backend;
 
 /*---------------------------------------------------------------------------*/
 
 struct dtn_event_loop_config {
 
+    dtn_event_loop_backend backend;
+
     struct {
 
         uint32_t sockets;
         uint32_t timers;
 
+        /* ready events harvested with one wait call,
+         * 0 for DTN_EVENT_LOOP_MAX_EVENTS_DEFAULT */
+        uint32_t events;
+
     } max;
 };
 
 /*---------------------------------------------------------------------------*/
 
+struct dtn_event_loop_statistics {
+
+    uint64_t wait_calls; // syscalls waiting for ready events
+    uint64_t events;     // ready events harvested
+    uint64_t stale;      // events dropped, fd unset within the same batch
+
+    double syscalls_per_event;
+};
+
+/*---------------------------------------------------------------------------*/
+
 struct dtn_event_loop {
 
     uint16_t magic_byte; // identify an event loop structure
@@ -233,6 +269,13 @@ struct dtn_event_loop {
 
     } timer;
 
+    /*------------------------------------------------------------------*/
+
+    /*
+     *      Optional, get the statistics of the loop since creation.
+     */
+    dtn_event_loop_statistics (*get_statistics)(const dtn_event_loop *self);
+
     int log_fd;
 };
 
@@ -249,13 +292,27 @@ struct dtn_event_loop {
 
                 {
                         .sockets = dtn_EVENT_LOOP_MAX_SOCKETS_DEFAULT,
-                        .timers  = dtn_EVENT_LOOP_MAX_TIMERS_DEFAULT
+                        .timers  = dtn_EVENT_LOOP_MAX_TIMERS_DEFAULT,
+                        .events  = dtn_EVENT_LOOP_MAX_EVENTS_DEFAULT
                 } max;
 */
 dtn_event_loop_config dtn_event_loop_config_default();
 
 /*---------------------------------------------------------------------------*/
 
+/**
+        String representation of a backend as used within JSON configs,
+        one of "default", "poll", "epoll" or "io_uring".
+*/
+const char *dtn_event_loop_backend_to_string(dtn_event_loop_backend backend);
+
+/**
+        Parse a backend, unknown strings are DTN_EVENT_LOOP_BACKEND_DEFAULT.
+*/
+dtn_event_loop_backend dtn_event_loop_backend_from_string(const char *string);
+
+/*---------------------------------------------------------------------------*/
+
 /**
         Return a default event loop.
 */
@@ -294,6 +351,15 @@ bool dtn_event_loop_stop(dtn_event_loop *self);
 
 /*----------------------------------------------------------------------------*/
 
+/**
+        Get the statistics of the loop,
+        all zero if the implementation does not support statistics.
+*/
+dtn_event_loop_statistics dtn_event_loop_get_statistics(
+    const dtn_event_loop *self);
+
+/*----------------------------------------------------------------------------*/
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -386,6 +452,7 @@ bool dtn_event_remove_default_connection_accept(dtn_event_loop *self,
                 {
                         "dtn_EVENT_LOOP_KEY_MAX_SOCKETS" : 1,
                         "dtn_EVENT_LOOP_KEY_MAX_TIMERS" : 1,
+                        "dtn_EVENT_LOOP_KEY_MAX_EVENTS" : 1,
                 }
         }
 
@@ -394,6 +461,8 @@ bool dtn_event_remove_default_connection_accept(dtn_event_loop *self,
         {
                 "dtn_EVENT_LOOP_KEY_MAX_SOCKETS" : 1,
                 "dtn_EVENT_LOOP_KEY_MAX_TIMERS" : 1,
+                "dtn_EVENT_LOOP_KEY_MAX_EVENTS" : 1,
+                "dtn_EVENT_LOOP_KEY_BACKEND" : "io_uring"
         }
 
         @NOTE this double input is done to support automated
@@ -421,6 +490,8 @@ dtn_event_loop_config dtn_event_loop_config_from_json(const dtn_item *value);
         {
                 "dtn_EVENT_LOOP_KEY_MAX_SOCKETS" : 1,
                 "dtn_EVENT_LOOP_KEY_MAX_TIMERS" : 1,
+                "dtn_EVENT_LOOP_KEY_MAX_EVENTS" : 1,
+                "dtn_EVENT_LOOP_KEY_BACKEND" : "default"
         }
 
         The return value was choosen to add the output to some
@@ -0,0 +1,71 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_flat_dict.h
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        @ingroup        dtn_base
+
+        @brief          Definition of an open addressing dict implementation.
+
+        All pairs are stored inline within one array together with the
+        hash of the key. A control byte per slot holds 7 bits of the hash,
+        lookups compare a group of 16 control bytes at once (SSE2 if
+        available) and call the key match function only for candidates.
+
+        config.slots is used as expected number of entries and is set
+        to the capacity of the table. The table grows once 7/8 of the
+        capacity is used. No resize is done while for_each is running.
+
+        Use dtn_dict_create with config.type = DTN_DICT_FLAT or
+        dtn_flat_dict_create to create a flat dict.
+
+        ------------------------------------------------------------------------
+*/
+#ifndef dtn_flat_dict_h
+#define dtn_flat_dict_h
+
+#include "dtn_dict.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+        Create an open addressing dict. config.type is set to DTN_DICT_FLAT.
+*/
+dtn_dict *dtn_flat_dict_create(dtn_dict_config config);
+
+/*---------------------------------------------------------------------------*/
+
+/**
+        Check if key is set within a flat dict.
+*/
+bool dtn_flat_dict_is_set(const dtn_dict *dict, const void *key);
+
+/*---------------------------------------------------------------------------*/
+
+/**
+        Number of pairs within a flat dict, -1 on error.
+*/
+int64_t dtn_flat_dict_count(const dtn_dict *dict);
+
+#endif /* dtn_flat_dict_h */
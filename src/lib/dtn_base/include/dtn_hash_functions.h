@@ -36,6 +36,7 @@
 #define dtn_hash_functions_h
 
 #include <inttypes.h>
+#include <stddef.h>
 
 /**
         Simple hash function for c strings (null-terminated!).
@@ -60,6 +61,44 @@ uint64_t dtn_hash_pearson_c_string(const void *c_string);
 
 /*---------------------------------------------------------------------------*/
 
+/**
+        64 bit hash of size bytes at data.
+
+        @param data     bytes to hash
+        @param size     number of bytes
+        @return values in the range of 0 ... UINT64_MAX
+*/
+uint64_t dtn_hash_bytes(const void *data, size_t size);
+
+/*---------------------------------------------------------------------------*/
+
+/**
+        64 bit hash of size bytes at data with a seed. Hashes of the same
+        bytes with different seeds are independent, e.g. to combine two
+        of them to a 128 bit hash. dtn_hash_bytes uses seed 0.
+*/
+uint64_t dtn_hash_bytes_seed(const void *data, size_t size, uint64_t seed);
+
+/*---------------------------------------------------------------------------*/
+
+/**
+        64 bit hash for c strings.
+
+        @param c_string zero-terminated array of bytes
+        @return values in the range of 0 ... UINT64_MAX
+*/
+uint64_t dtn_hash_c_string(const void *c_string);
+
+/*---------------------------------------------------------------------------*/
+
+/**
+        Finalizer to spread all bits of value over the 64 bit result,
+        e.g. for identity hashes of integers or pointers.
+*/
+uint64_t dtn_hash_mix64(uint64_t value);
+
+/*---------------------------------------------------------------------------*/
+
 /**
         Returns the content of the intptr.
 */
@@ -0,0 +1,142 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_timer_wheel.h
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        @ingroup        dtn_base
+
+        @brief          Hierarchical timing wheel.
+
+        One shot timers are kept within 4 levels of 256 slots, each level
+        covering 256 times the range of the level below. Set and unset
+        are O(1), timers of higher levels are moved down once their slot
+        is reached.
+
+        The wheel has no clock of its own. Time is counted in ticks of
+        any unit, the owner drives the wheel with dtn_timer_wheel_advance
+        and uses dtn_timer_wheel_next to decide when to advance again.
+
+        Timers are allocated from blocks, which are added on demand.
+        Timer ids contain a generation, so an id of an expired or unset
+        timer will not match a later timer.
+
+        ------------------------------------------------------------------------
+*/
+#ifndef dtn_timer_wheel_h
+#define dtn_timer_wheel_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DTN_TIMER_WHEEL_DEFAULT_TIMERS 256
+
+typedef struct dtn_timer_wheel dtn_timer_wheel;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_timer_wheel_config {
+
+    uint32_t timers; // preallocated, default DTN_TIMER_WHEEL_DEFAULT_TIMERS
+
+} dtn_timer_wheel_config;
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_timer_wheel *dtn_timer_wheel_create(dtn_timer_wheel_config config);
+dtn_timer_wheel *dtn_timer_wheel_cast(const void *data);
+dtn_timer_wheel *dtn_timer_wheel_free(dtn_timer_wheel *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Set a one shot timer.
+ *
+ *      @param self     wheel to use
+ *      @param tick     absolute tick to expire, ticks not after the
+ *                      current tick expire with the next tick
+ *      @param data     optional user data for callback
+ *      @param callback mandatory callback
+ *
+ *      @returns        timer id, 0 on error
+ */
+uint32_t dtn_timer_wheel_set(dtn_timer_wheel *self, uint64_t tick, void *data,
+                             bool (*callback)(uint32_t id, void *data));
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Unset a timer. Unset of an expired or unknown timer is no error.
+ *
+ *      @param self     wheel to use
+ *      @param id       timer id
+ *      @param userdata optional pointer to return the data of the timer
+ */
+bool dtn_timer_wheel_unset(dtn_timer_wheel *self, uint32_t id,
+                           void **userdata);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Advance the wheel to tick and run the callbacks of all timers
+ *      expired up to tick in order of expiry.
+ *
+ *      Callbacks MAY set and unset timers.
+ *
+ *      @returns        number of expired timers
+ */
+uint64_t dtn_timer_wheel_advance(dtn_timer_wheel *self, uint64_t tick);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Tick at which the wheel needs to be advanced next. This is either
+ *      the expiry of the next timer or the tick to move timers of a higher
+ *      level down.
+ *
+ *      @returns        next tick, UINT64_MAX if no timer is set
+ */
+uint64_t dtn_timer_wheel_next(const dtn_timer_wheel *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Tick the wheel was advanced to.
+ */
+uint64_t dtn_timer_wheel_current(const dtn_timer_wheel *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Number of timers set.
+ */
+size_t dtn_timer_wheel_count(const dtn_timer_wheel *self);
+
+#endif /* dtn_timer_wheel_h */
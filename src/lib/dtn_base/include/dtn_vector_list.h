@@ -51,6 +51,14 @@ dtn_list *dtn_vector_list_create(dtn_list_config config);
 
 /*----------------------------------------------------------------------------*/
 
+/**
+        Create a vector (array) based list with slots for items.
+        The growth rate is set to items.
+*/
+dtn_list *dtn_vector_list_create_sized(dtn_list_config config, size_t items);
+
+/*----------------------------------------------------------------------------*/
+
 /**
         Set the vector items array to shrink automatically (shrink == true).
 
@@ -29,6 +29,7 @@
 */
 #include "../include/dtn_crc16.h"
 
+#include <pthread.h>
 #include <stdio.h>
 
 #define PPPINITFCS16 0xffff /* Initial FCS value */
@@ -67,6 +68,32 @@ static uint16_t fcstab[256] = {
 
 /*----------------------------------------------------------------------------*/
 
+/*
+ *      fcsslice[k][i] is the FCS of byte i followed by k zero bytes,
+ *      fcsslice[0] equals fcstab.
+ */
+
+static pthread_once_t fcsslice_once = PTHREAD_ONCE_INIT;
+static uint16_t fcsslice[8][256] = {0};
+
+/*----------------------------------------------------------------------------*/
+
+static void fcsslice_init(void) {
+
+    for (size_t i = 0; i < 256; i++) {
+
+        uint16_t fcs = fcstab[i];
+        fcsslice[0][i] = fcs;
+
+        for (size_t k = 1; k < 8; k++) {
+            fcs = (fcs >> 8) ^ fcstab[fcs & 0xff];
+            fcsslice[k][i] = fcs;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
 static uint16_t pppfcs16(uint16_t fcs, const uint8_t *cp, size_t len) {
 
     while (len--) {
@@ -78,16 +105,45 @@ static uint16_t pppfcs16(uint16_t fcs, const uint8_t *cp, size_t len) {
 
 /*----------------------------------------------------------------------------*/
 
+static uint16_t pppfcs16_slice8(uint16_t fcs, const uint8_t *cp, size_t len) {
+
+    pthread_once(&fcsslice_once, fcsslice_init);
+
+    while (len >= 8) {
+
+        fcs ^= (uint16_t)(cp[0] | cp[1] << 8);
+
+        fcs = fcsslice[7][fcs & 0xff] ^ fcsslice[6][fcs >> 8] ^
+              fcsslice[5][cp[2]] ^ fcsslice[4][cp[3]] ^ fcsslice[3][cp[4]] ^
+              fcsslice[2][cp[5]] ^ fcsslice[1][cp[6]] ^ fcsslice[0][cp[7]];
+
+        cp += 8;
+        len -= 8;
+    }
+
+    return pppfcs16(fcs, cp, len);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint16_t dtn_crc16x25_update(uint16_t crc, const uint8_t *buffer,
+                             size_t size) {
+
+    if (!buffer || size < 1)
+        return crc;
+
+    return 0xffff ^ pppfcs16_slice8(0xffff ^ crc, buffer, size);
+}
+
+/*----------------------------------------------------------------------------*/
+
 uint16_t crc16x25(const uint8_t *buffer, size_t size) {
 
     if (!buffer || size < 1)
         goto error;
 
-    uint16_t trialfcs = 0;
-    trialfcs = pppfcs16(PPPINITFCS16, buffer, size);
-    trialfcs ^= 0xffff; /* complement */
-    return trialfcs;
+    return dtn_crc16x25_update(0, buffer, size);
 
 error:
     return 0;
-}
\ No newline at end of file
+}
@@ -77,6 +77,47 @@ int test_crc16x25() {
 
 /*----------------------------------------------------------------------------*/
 
+int test_dtn_crc16x25_update() {
+
+    uint8_t buffer[0xff] = {0};
+
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    testrun(0x1234 == dtn_crc16x25_update(0x1234, NULL, 10));
+    testrun(0x1234 == dtn_crc16x25_update(0x1234, buffer, 0));
+
+    testrun(0x906E == dtn_crc16x25_update(0, (uint8_t *)"123456789", 9));
+    testrun(0x906E == crc16x25((uint8_t *)"123456789", 9));
+
+    // slice by 8 matches the byte wise table at any offset and length
+
+    for (size_t offset = 0; offset < 8; offset++) {
+
+        for (size_t len = 1; len < 100; len++) {
+
+            uint16_t expect =
+                0xffff ^ pppfcs16(0xffff, buffer + offset, len);
+
+            testrun(expect == crc16x25(buffer + offset, len));
+
+            for (size_t split = 0; split <= len; split += 3) {
+
+                uint16_t crc = dtn_crc16x25_update(0, buffer + offset, split);
+                crc = dtn_crc16x25_update(crc, buffer + offset + split,
+                                          len - split);
+
+                testrun(expect == crc);
+            }
+        }
+    }
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -89,6 +130,7 @@ int all_tests() {
 
     testrun_init();
     testrun_test(test_crc16x25);
+    testrun_test(test_dtn_crc16x25_update);
 
     return testrun_counter;
 }
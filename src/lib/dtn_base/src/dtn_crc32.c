@@ -31,6 +31,14 @@
 #include "../include/dtn_crc32.h"
 #include "../include/dtn_utils.h"
 
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DTN_CRC32C_HAVE_SSE42
+#include <nmmintrin.h>
+#endif
+
 /*----------------------------------------------------------------------------*/
 
 static uint32_t reflect_bits(uint32_t n) {
@@ -219,16 +227,165 @@ uint32_t dtn_crc32_zlib(uint32_t init, uint8_t const *data, size_t len_octets) {
 
 /*----------------------------------------------------------------------------*/
 
-uint32_t dtn_crc32c(uint8_t const *data, size_t len_octets) {
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CRC32C
+ *
+ *      ------------------------------------------------------------------------
+ */
 
-    static bool initialized = false;
-    static uint32_t lookup[0x100] = {0};
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+static dtn_crc32c_engine crc32c_engine = DTN_CRC32C_SLICE8;
 
-    if (!initialized) {
-        dtn_crc32_generate_table_for(0x1EDC6F41, true, lookup);
-        initialized = true;
+/*
+ *      crc32c_slice[k][i] is the CRC of byte i followed by k zero bytes,
+ *      crc32c_slice[0] is the common byte wise lookup table.
+ */
+static uint32_t crc32c_slice[8][0x100] = {0};
+
+/*----------------------------------------------------------------------------*/
+
+static void crc32c_init(void) {
+
+    dtn_crc32_generate_table_for(0x1EDC6F41, true, crc32c_slice[0]);
+
+    for (size_t i = 0; i < 0x100; ++i) {
+
+        uint32_t crc = crc32c_slice[0][i];
+
+        for (size_t k = 1; k < 8; ++k) {
+            crc = (crc >> 8) ^ crc32c_slice[0][crc & 0xff];
+            crc32c_slice[k][i] = crc;
+        }
+    }
+
+#ifdef DTN_CRC32C_HAVE_SSE42
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2"))
+        crc32c_engine = DTN_CRC32C_SSE42;
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint32_t crc32c_slice8(uint32_t crc, uint8_t const *data,
+                              size_t len_octets) {
+
+    while (len_octets >= 8) {
+
+        uint32_t low = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 |
+                              (uint32_t)data[2] << 16 |
+                              (uint32_t)data[3] << 24);
+
+        crc = crc32c_slice[7][low & 0xff] ^
+              crc32c_slice[6][(low >> 8) & 0xff] ^
+              crc32c_slice[5][(low >> 16) & 0xff] ^
+              crc32c_slice[4][low >> 24] ^ crc32c_slice[3][data[4]] ^
+              crc32c_slice[2][data[5]] ^ crc32c_slice[1][data[6]] ^
+              crc32c_slice[0][data[7]];
+
+        data += 8;
+        len_octets -= 8;
+    }
+
+    return crc32_reflected_in(crc, data, len_octets, crc32c_slice[0]);
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef DTN_CRC32C_HAVE_SSE42
+
+__attribute__((target("sse4.2"))) static uint32_t
+crc32c_sse42(uint32_t crc, uint8_t const *data, size_t len_octets) {
+
+    while (len_octets > 0 && ((uintptr_t)data & 7)) {
+        crc = _mm_crc32_u8(crc, *data++);
+        len_octets--;
+    }
+
+    uint64_t crc64 = crc;
+
+    while (len_octets >= 8) {
+
+        uint64_t chunk = 0;
+        memcpy(&chunk, data, 8);
+        crc64 = _mm_crc32_u64(crc64, chunk);
+
+        data += 8;
+        len_octets -= 8;
     }
 
-    return 0xffffffff ^
-           dtn_crc32_sum(0xFFFFFFFF, data, len_octets, true, true, lookup);
+    crc = (uint32_t)crc64;
+
+    while (len_octets-- > 0) {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+
+    return crc;
+}
+
+#endif
+
+/*----------------------------------------------------------------------------*/
+
+dtn_crc32c_engine dtn_crc32c_engine_active() {
+
+    pthread_once(&crc32c_once, crc32c_init);
+    return crc32c_engine;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint32_t dtn_crc32c_update_engine(dtn_crc32c_engine engine, uint32_t crc,
+                                  uint8_t const *data, size_t len_octets) {
+
+    pthread_once(&crc32c_once, crc32c_init);
+
+    if (!data || 0 == len_octets)
+        return crc;
+
+    if (DTN_CRC32C_AUTO == engine)
+        engine = crc32c_engine;
+
+    crc = 0xffffffff ^ crc;
+
+    switch (engine) {
+
+    case DTN_CRC32C_TABLE:
+        crc = crc32_reflected_in(crc, data, len_octets, crc32c_slice[0]);
+        break;
+
+#ifdef DTN_CRC32C_HAVE_SSE42
+    case DTN_CRC32C_SSE42:
+
+        if (DTN_CRC32C_SSE42 == crc32c_engine) {
+            crc = crc32c_sse42(crc, data, len_octets);
+            break;
+        }
+        crc = crc32c_slice8(crc, data, len_octets);
+        break;
+#endif
+
+    default:
+        crc = crc32c_slice8(crc, data, len_octets);
+        break;
+    }
+
+    return 0xffffffff ^ crc;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint32_t dtn_crc32c_update(uint32_t crc, uint8_t const *data,
+                           size_t len_octets) {
+
+    return dtn_crc32c_update_engine(DTN_CRC32C_AUTO, crc, data, len_octets);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint32_t dtn_crc32c(uint8_t const *data, size_t len_octets) {
+
+    return dtn_crc32c_update(0, data, len_octets);
 }
@@ -182,6 +182,83 @@ static int test_dtn_crc32c() {
     return testrun_log_success();
 }
 
+/*----------------------------------------------------------------------------*/
+
+static int test_dtn_crc32c_update() {
+
+    uint8_t buffer[0xff] = {0};
+
+    testrun(0x1234 == dtn_crc32c_update(0x1234, NULL, 10));
+    testrun(0x1234 == dtn_crc32c_update(0x1234, buffer, 0));
+
+    testrun(0xE3069283 == dtn_crc32c((uint8_t const *)"123456789", 9));
+    testrun(0xE3069283 ==
+            dtn_crc32c_update(0, (uint8_t const *)"123456789", 9));
+
+    // 32 zero bytes, RFC 3720 B.4
+    testrun(0x8A9136AA == dtn_crc32c(buffer, 32));
+
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    for (size_t len = 0; len < 100; len++) {
+
+        uint32_t expect = dtn_crc32c(buffer, len);
+
+        for (size_t split = 0; split <= len; split += 5) {
+
+            uint32_t crc = dtn_crc32c_update(0, buffer, split);
+            crc = dtn_crc32c_update(crc, buffer + split, len - split);
+            testrun(expect == crc);
+        }
+    }
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int test_dtn_crc32c_update_engine() {
+
+    uint8_t buffer[0xff] = {0};
+
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)(i * 17 + 3);
+    }
+
+    dtn_crc32c_engine active = dtn_crc32c_engine_active();
+    testrun(DTN_CRC32C_AUTO != active);
+
+    dtn_crc32c_engine engines[] = {DTN_CRC32C_AUTO, DTN_CRC32C_TABLE,
+                                   DTN_CRC32C_SLICE8, DTN_CRC32C_SSE42};
+
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+
+        testrun(0xE3069283 ==
+                dtn_crc32c_update_engine(engines[e], 0,
+                                         (uint8_t const *)"123456789", 9));
+
+        // unaligned start and tails for all engines
+
+        for (size_t offset = 0; offset < 8; offset++) {
+
+            for (size_t len = 1; len < 100; len++) {
+
+                uint32_t expect = 0xffffffff ^
+                                  crc32_reflected_in(0xffffffff,
+                                                     buffer + offset, len,
+                                                     crc32c_slice[0]);
+
+                testrun(expect == dtn_crc32c_update_engine(
+                                      engines[e], 0, buffer + offset, len));
+            }
+        }
+    }
+
+    return testrun_log_success();
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -198,6 +275,8 @@ int all_tests() {
     testrun_test(test_dtn_crc32_ogg);
     testrun_test(test_dtn_crc32_zlib);
     testrun_test(test_dtn_crc32c);
+    testrun_test(test_dtn_crc32c_update);
+    testrun_test(test_dtn_crc32c_update_engine);
 
     return testrun_counter;
 }
@@ -34,10 +34,17 @@
         The linked list ALWAYS starts off with a dummy pair (0, 0).
         This pair must be ignored when doing anything with the dict.
 
+        The table is rehashed to twice the slots, once there are more
+        pairs than slots, and to half the slots, once less than 1/8 of
+        the slots are used, but never below the configured slots.
+        Clear returns the table to the configured slots.
+        No rehash is done while for_each is running.
+
 
         ------------------------------------------------------------------------
 */
 #include "../include/dtn_dict.h"
+#include "../include/dtn_flat_dict.h"
 #include "../include/dtn_utils.h"
 
 /*
@@ -67,6 +74,10 @@ typedef struct {
     dtn_dict public;
     dict_pair *items;
 
+    uint64_t count;     // pairs in the table
+    uint64_t min_slots; // configured slots
+    uint64_t iterating; // running for_each calls
+
 } DefaultDict;
 
 #define AS_DEFAULT_DICT(x)                                                     \
@@ -109,8 +120,66 @@ static bool dict_calculate_slot(const dtn_dict *self, const void *key,
     if (!dtn_dict_config_is_valid(&self->config))
         return false;
 
-    *slot = (self->config.key.hash(key) % self->config.slots);
+    *slot = dtn_hash_mix64(self->config.key.hash(key)) % self->config.slots;
+    return true;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool dict_rehash(DefaultDict *d, uint64_t slots) {
+
+    dtn_dict *self = (dtn_dict *)d;
+
+    dict_pair *items = calloc(slots + 1, sizeof(dict_pair));
+    if (!items)
+        goto error;
+
+    for (size_t i = 0; i < self->config.slots; i++) {
+
+        dict_pair *pair = d->items[i].next;
+
+        while (pair) {
+
+            dict_pair *next = pair->next;
+
+            size_t slot =
+                dtn_hash_mix64(self->config.key.hash(pair->key)) % slots;
+
+            pair->next = items[slot].next;
+            items[slot].next = pair;
+
+            pair = next;
+        }
+    }
+
+    free(d->items);
+    d->items = items;
+    self->config.slots = slots;
     return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void dict_adjust_load(DefaultDict *d) {
+
+    if (d->iterating)
+        return;
+
+    uint64_t slots = d->public.config.slots;
+
+    if (d->count > slots) {
+
+        // a failed rehash keeps the current table
+        dict_rehash(d, 2 * slots);
+
+    } else if ((d->count < slots / 8) && (slots / 2 >= d->min_slots)) {
+
+        dict_rehash(d, slots / 2);
+    }
+
+    return;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -199,6 +268,9 @@ dtn_dict *dtn_dict_create(dtn_dict_config config) {
     if (!dtn_dict_config_is_valid(&config))
         goto error;
 
+    if (DTN_DICT_FLAT == config.type)
+        return dtn_flat_dict_create(config);
+
     dict = calloc(1, sizeof(DefaultDict));
     if (!dict)
         goto error;
@@ -231,6 +303,8 @@ dtn_dict *dtn_dict_create(dtn_dict_config config) {
     if (!d->items)
         goto error;
 
+    d->min_slots = dict->config.slots;
+
     return dict;
 error:
     return impl_dict_free(dict);
@@ -243,6 +317,9 @@ bool dtn_dict_is_set(const dtn_dict *self, const void *key) {
     if (!self)
         goto error;
 
+    if (DTN_DICT_FLAT == self->config.type)
+        return dtn_flat_dict_is_set(self, key);
+
     size_t slot = 0;
 
     if (!dict_calculate_slot(self, key, &slot))
@@ -265,40 +342,19 @@ error:
 
 /*---------------------------------------------------------------------------*/
 
-static bool count_keys(const void *key, void *value, void *data) {
-
-    if (!key)
-        return true;
-
-    if (!data)
-        goto error;
-
-    intptr_t *ptr = (intptr_t *)data;
-    if (*ptr < 0)
-        goto error;
-
-    *ptr = *ptr + 1;
-    return true;
-
-error:
-    if (value) { /* unused */
-    };
-    return false;
-}
-
-/*---------------------------------------------------------------------------*/
-
 int64_t dtn_dict_count(const dtn_dict *self) {
 
     if (!self)
         goto error;
 
-    intptr_t counter = 0;
+    if (DTN_DICT_FLAT == self->config.type)
+        return dtn_flat_dict_count(self);
 
-    if (!self->for_each((dtn_dict *)self, &counter, count_keys))
+    DefaultDict *d = AS_DEFAULT_DICT(self);
+    if (!d)
         goto error;
 
-    return counter;
+    return d->count;
 
 error:
     return -1;
@@ -374,6 +430,12 @@ static bool impl_dict_clear(dtn_dict *self) {
         }
     }
 
+    d->count = 0;
+
+    // an empty table returns to the configured slots
+    if (!d->iterating && (self->config.slots != d->min_slots))
+        dict_rehash(d, d->min_slots);
+
     return true;
 error:
     return false;
@@ -547,6 +609,9 @@ static bool dict_pair_push_value(dict_pair *pair, void *key, void *value) {
     }
 
     pair->next = calloc(1, sizeof(dict_pair));
+    if (!pair->next)
+        return false;
+
     pair->next->key = key;
     pair->next->value = value;
 
@@ -594,7 +659,13 @@ static bool impl_dict_set(dtn_dict *self, void *key, void *value,
         }
     }
 
-    return dict_pair_push_value(pair, key, value);
+    if (!dict_pair_push_value(pair, key, value))
+        goto error;
+
+    DefaultDict *d = AS_DEFAULT_DICT(self);
+    d->count++;
+    dict_adjust_load(d);
+    return true;
 
 error:
     return false;
@@ -652,6 +723,10 @@ static void *impl_dict_remove(dtn_dict *self, const void *key) {
 
             pair->next = drop->next;
             free(drop);
+
+            DefaultDict *d = AS_DEFAULT_DICT(self);
+            d->count--;
+            dict_adjust_load(d);
             break;
         }
 
@@ -676,6 +751,8 @@ static bool impl_dict_for_each(dtn_dict *self, void *data,
     if (!d || !d->items)
         goto error;
 
+    d->iterating++;
+
     // walk all slots
     for (size_t i = 0; i < self->config.slots; i++) {
 
@@ -691,11 +768,14 @@ static bool impl_dict_for_each(dtn_dict *self, void *data,
             if (NULL == pair)
                 continue;
 
-            if (!function(pair->key, pair->value, data))
+            if (!function(pair->key, pair->value, data)) {
+                d->iterating--;
                 goto error;
+            }
         }
     }
 
+    d->iterating--;
     return true;
 
 error:
@@ -719,7 +799,7 @@ dtn_dict_config dtn_dict_string_key_config(size_t slots) {
 
         .slots = slots,
         .key.data_function = dtn_data_string_data_functions(),
-        .key.hash = dtn_hash_pearson_c_string,
+        .key.hash = dtn_hash_c_string,
         .key.match = dtn_match_c_string_strict,
 
     };
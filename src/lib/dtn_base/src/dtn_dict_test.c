@@ -61,7 +61,7 @@ int test_dtn_dict_create() {
     testrun(dict->config.key.data_function.clear == dtn_data_string_clear);
     testrun(dict->config.key.data_function.copy == dtn_data_string_copy);
     testrun(dict->config.key.data_function.dump == dtn_data_string_dump);
-    testrun(dict->config.key.hash == dtn_hash_pearson_c_string);
+    testrun(dict->config.key.hash == dtn_hash_c_string);
     testrun(dict->config.key.match == dtn_match_c_string_strict);
     testrun(dict->config.value.data_function.free == NULL);
     testrun(dict->config.value.data_function.clear == NULL);
@@ -88,6 +88,16 @@ int test_dtn_dict_create() {
     config.key.hash = NULL;
     testrun(!dtn_dict_create(config));
 
+    // open addressing implementation
+    config = dtn_dict_string_key_config(slots);
+    config.type = DTN_DICT_FLAT;
+    dict = dtn_dict_create(config);
+    testrun(dict);
+    testrun(dict->type != IMPL_DEFAULT_DICT_TYPE);
+    testrun(dict->config.type == DTN_DICT_FLAT);
+    testrun(dict->create == dtn_flat_dict_create);
+    testrun(NULL == dtn_dict_free(dict));
+
     return testrun_log_success();
 }
 
@@ -123,7 +133,7 @@ int test_dtn_dict_config_is_valid() {
 
     // prepare min valid
     config.slots = 1;
-    config.key.hash = dtn_hash_pearson_c_string;
+    config.key.hash = dtn_hash_c_string;
     config.key.match = dtn_match_c_string_strict;
     testrun(dtn_dict_config_is_valid(&config));
 
@@ -328,7 +338,7 @@ int test_dtn_dict_string_key_config() {
         testrun(config.key.data_function.clear == dtn_data_string_clear);
         testrun(config.key.data_function.copy == dtn_data_string_copy);
         testrun(config.key.data_function.dump == dtn_data_string_dump);
-        testrun(config.key.hash == dtn_hash_pearson_c_string);
+        testrun(config.key.hash == dtn_hash_c_string);
         testrun(config.key.match == dtn_match_c_string_strict);
         testrun(config.value.data_function.free == NULL);
         testrun(config.value.data_function.clear == NULL);
@@ -430,6 +440,18 @@ int test_dtn_dict_count() {
     testrun(dict->del(dict, key));
     testrun(2 == dtn_dict_count(dict));
 
+    // replaced, removed and unknown keys
+
+    testrun(dict->set(dict, strdup("key1"), NULL, NULL));
+    testrun(2 == dtn_dict_count(dict));
+    testrun(!dict->remove(dict, "key2"));
+    testrun(1 == dtn_dict_count(dict));
+    testrun(dict->del(dict, "unknown"));
+    testrun(1 == dtn_dict_count(dict));
+
+    testrun(dict->clear(dict));
+    testrun(0 == dtn_dict_count(dict));
+
     dict->free(dict);
 
     return testrun_log_success();
@@ -466,7 +488,7 @@ int test_dtn_dict_copy() {
     testrun(copy->config.key.data_function.clear == dtn_data_string_clear);
     testrun(copy->config.key.data_function.copy == dtn_data_string_copy);
     testrun(copy->config.key.data_function.dump == dtn_data_string_dump);
-    testrun(copy->config.key.hash == dtn_hash_pearson_c_string);
+    testrun(copy->config.key.hash == dtn_hash_c_string);
     testrun(copy->config.key.match == dtn_match_c_string_strict);
     testrun(copy->config.value.data_function.free == dtn_data_string_free);
     testrun(copy->config.value.data_function.clear == dtn_data_string_clear);
@@ -0,0 +1,136 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_epoch.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_epoch.h"
+
+#include <sched.h>
+#include <stddef.h>
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+bool dtn_epoch_init(dtn_epoch *self, void *data, void *(*free)(void *data)) {
+
+    if (!self)
+        return false;
+
+    atomic_init(&self->data, data);
+    atomic_init(&self->epoch, 0);
+    atomic_init(&self->readers[0], 0);
+    atomic_init(&self->readers[1], 0);
+
+    self->free = free;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_epoch_clear(dtn_epoch *self) {
+
+    if (!self)
+        return false;
+
+    void *data = atomic_exchange(&self->data, NULL);
+
+    if (data && self->free)
+        self->free(data);
+
+    return true;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+uint64_t dtn_epoch_enter(dtn_epoch *self) {
+
+    uint64_t epoch = 0;
+
+    // retry if the epoch advanced before registration
+
+    while (true) {
+
+        epoch = atomic_load(&self->epoch);
+        atomic_fetch_add(&self->readers[epoch & 1], 1);
+
+        if (epoch == atomic_load(&self->epoch))
+            break;
+
+        atomic_fetch_sub(&self->readers[epoch & 1], 1);
+    }
+
+    return epoch;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void dtn_epoch_leave(dtn_epoch *self, uint64_t epoch) {
+
+    atomic_fetch_sub(&self->readers[epoch & 1], 1);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void *dtn_epoch_data(dtn_epoch *self) {
+
+    if (!self)
+        return NULL;
+
+    return atomic_load(&self->data);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_epoch_publish(dtn_epoch *self, void *data) {
+
+    if (!self)
+        return false;
+
+    void *previous = atomic_exchange(&self->data, data);
+    uint64_t epoch = atomic_fetch_add(&self->epoch, 1);
+
+    while (0 < atomic_load(&self->readers[epoch & 1])) {
+        sched_yield();
+    }
+
+    if (previous && self->free)
+        self->free(previous);
+
+    return true;
+}
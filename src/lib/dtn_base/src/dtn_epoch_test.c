@@ -0,0 +1,294 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_epoch_test.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "dtn_epoch.c"
+#include "../include/testrun.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+/*---------------------------------------------------------------------------*/
+
+static atomic_size_t freed = 0;
+
+/*---------------------------------------------------------------------------*/
+
+static void *snapshot_free(void *data) {
+
+    atomic_fetch_add(&freed, 1);
+    free(data);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint64_t *snapshot(uint64_t value) {
+
+    uint64_t *data = calloc(1, sizeof(uint64_t));
+    if (data)
+        *data = value;
+
+    return data;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CASES                                                      #CASES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int test_dtn_epoch_init() {
+
+    dtn_epoch epoch;
+
+    testrun(!dtn_epoch_init(NULL, NULL, NULL));
+
+    testrun(dtn_epoch_init(&epoch, NULL, NULL));
+    testrun(NULL == dtn_epoch_data(&epoch));
+    testrun(0 == atomic_load(&epoch.epoch));
+    testrun(NULL == epoch.free);
+
+    uint64_t *data = snapshot(1);
+    testrun(dtn_epoch_init(&epoch, data, snapshot_free));
+    testrun(data == dtn_epoch_data(&epoch));
+    testrun(snapshot_free == epoch.free);
+
+    testrun(dtn_epoch_clear(&epoch));
+    return testrun_log_success();
+}
+
+/*---------------------------------------------------------------------------*/
+
+int test_dtn_epoch_clear() {
+
+    dtn_epoch epoch;
+    atomic_store(&freed, 0);
+
+    testrun(!dtn_epoch_clear(NULL));
+
+    testrun(dtn_epoch_init(&epoch, snapshot(1), snapshot_free));
+    testrun(dtn_epoch_clear(&epoch));
+    testrun(1 == atomic_load(&freed));
+    testrun(NULL == dtn_epoch_data(&epoch));
+
+    // cleared once
+
+    testrun(dtn_epoch_clear(&epoch));
+    testrun(1 == atomic_load(&freed));
+
+    // without free function
+
+    uint64_t value = 1;
+    testrun(dtn_epoch_init(&epoch, &value, NULL));
+    testrun(dtn_epoch_clear(&epoch));
+    testrun(1 == atomic_load(&freed));
+
+    return testrun_log_success();
+}
+
+/*---------------------------------------------------------------------------*/
+
+int test_dtn_epoch_enter() {
+
+    dtn_epoch epoch;
+    testrun(dtn_epoch_init(&epoch, NULL, NULL));
+
+    uint64_t e = dtn_epoch_enter(&epoch);
+    testrun(0 == e);
+    testrun(1 == atomic_load(&epoch.readers[0]));
+
+    uint64_t f = dtn_epoch_enter(&epoch);
+    testrun(0 == f);
+    testrun(2 == atomic_load(&epoch.readers[0]));
+
+    dtn_epoch_leave(&epoch, e);
+    dtn_epoch_leave(&epoch, f);
+    testrun(0 == atomic_load(&epoch.readers[0]));
+
+    // registered within the readers of the current epoch
+
+    testrun(dtn_epoch_publish(&epoch, NULL));
+
+    e = dtn_epoch_enter(&epoch);
+    testrun(1 == e);
+    testrun(1 == atomic_load(&epoch.readers[1]));
+    testrun(0 == atomic_load(&epoch.readers[0]));
+
+    dtn_epoch_leave(&epoch, e);
+    testrun(0 == atomic_load(&epoch.readers[1]));
+
+    testrun(dtn_epoch_clear(&epoch));
+    return testrun_log_success();
+}
+
+/*---------------------------------------------------------------------------*/
+
+int test_dtn_epoch_data() {
+
+    dtn_epoch epoch;
+    uint64_t one = 1;
+    uint64_t two = 2;
+
+    testrun(NULL == dtn_epoch_data(NULL));
+
+    testrun(dtn_epoch_init(&epoch, &one, NULL));
+    testrun(&one == dtn_epoch_data(&epoch));
+
+    testrun(dtn_epoch_publish(&epoch, &two));
+    testrun(&two == dtn_epoch_data(&epoch));
+
+    testrun(dtn_epoch_clear(&epoch));
+    return testrun_log_success();
+}
+
+/*---------------------------------------------------------------------------*/
+
+struct reader {
+
+    dtn_epoch *epoch;
+    atomic_bool *stop;
+    uint64_t reads;
+    bool failed;
+};
+
+/*---------------------------------------------------------------------------*/
+
+static void *run_reader(void *arg) {
+
+    struct reader *reader = (struct reader *)arg;
+
+    while (!atomic_load(reader->stop)) {
+
+        uint64_t e = dtn_epoch_enter(reader->epoch);
+        uint64_t *data = dtn_epoch_data(reader->epoch);
+
+        // freed snapshots are overwritten before free
+
+        if (!data || (0 == *data))
+            reader->failed = true;
+
+        dtn_epoch_leave(reader->epoch, e);
+        reader->reads++;
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void *poison_free(void *data) {
+
+    *(uint64_t *)data = 0;
+    return snapshot_free(data);
+}
+
+/*---------------------------------------------------------------------------*/
+
+int test_dtn_epoch_publish() {
+
+    dtn_epoch epoch;
+    atomic_store(&freed, 0);
+
+    testrun(!dtn_epoch_publish(NULL, NULL));
+
+    testrun(dtn_epoch_init(&epoch, snapshot(1), snapshot_free));
+
+    testrun(dtn_epoch_publish(&epoch, snapshot(2)));
+    testrun(1 == atomic_load(&freed));
+    testrun(2 == *(uint64_t *)dtn_epoch_data(&epoch));
+    testrun(1 == atomic_load(&epoch.epoch));
+
+    testrun(dtn_epoch_clear(&epoch));
+    testrun(2 == atomic_load(&freed));
+
+    // concurrent readers never see a freed snapshot
+
+    atomic_store(&freed, 0);
+    atomic_bool stop = false;
+
+    testrun(dtn_epoch_init(&epoch, snapshot(1), poison_free));
+
+    struct reader readers[4] = {0};
+    pthread_t threads[4];
+
+    for (size_t i = 0; i < 4; i++) {
+        readers[i] = (struct reader){.epoch = &epoch, .stop = &stop};
+        testrun(0 == pthread_create(&threads[i], NULL, run_reader,
+                                    &readers[i]));
+    }
+
+    for (uint64_t i = 2; i < 1000; i++) {
+        testrun(dtn_epoch_publish(&epoch, snapshot(i)));
+    }
+
+    atomic_store(&stop, true);
+
+    for (size_t i = 0; i < 4; i++) {
+        testrun(0 == pthread_join(threads[i], NULL));
+        testrun(!readers[i].failed);
+    }
+
+    testrun(998 == atomic_load(&freed));
+    testrun(999 == *(uint64_t *)dtn_epoch_data(&epoch));
+
+    testrun(dtn_epoch_clear(&epoch));
+    return testrun_log_success();
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CLUSTER                                                    #CLUSTER
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int all_tests() {
+
+    testrun_init();
+    testrun_test(test_dtn_epoch_init);
+    testrun_test(test_dtn_epoch_clear);
+    testrun_test(test_dtn_epoch_enter);
+    testrun_test(test_dtn_epoch_data);
+    testrun_test(test_dtn_epoch_publish);
+
+    return testrun_counter;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST EXECUTION                                                  #EXEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+testrun_run(all_tests);
@@ -131,6 +131,17 @@ bool dtn_event_loop_stop(dtn_event_loop *self) {
 
 /*---------------------------------------------------------------------------*/
 
+dtn_event_loop_statistics dtn_event_loop_get_statistics(
+    const dtn_event_loop *self) {
+
+    if (!self || !self->get_statistics)
+        return (dtn_event_loop_statistics){0};
+
+    return self->get_statistics(self);
+}
+
+/*---------------------------------------------------------------------------*/
+
 dtn_event_loop *dtn_event_loop_cast(const void *self) {
 
     if (!self)
@@ -188,13 +199,55 @@ dtn_event_loop_config dtn_event_loop_config_default() {
     dtn_event_loop_config config = {
 
         .max.sockets = DTN_EVENT_LOOP_MAX_SOCKETS_DEFAULT,
-        .max.timers = DTN_EVENT_LOOP_MAX_TIMERS_DEFAULT};
+        .max.timers = DTN_EVENT_LOOP_MAX_TIMERS_DEFAULT,
+        .max.events = DTN_EVENT_LOOP_MAX_EVENTS_DEFAULT};
 
     return config;
 }
 
 /*---------------------------------------------------------------------------*/
 
+const char *dtn_event_loop_backend_to_string(dtn_event_loop_backend backend) {
+
+    switch (backend) {
+
+    case DTN_EVENT_LOOP_BACKEND_POLL:
+        return "poll";
+
+    case DTN_EVENT_LOOP_BACKEND_EPOLL:
+        return "epoll";
+
+    case DTN_EVENT_LOOP_BACKEND_IO_URING:
+        return "io_uring";
+
+    default:
+        break;
+    }
+
+    return "default";
+}
+
+/*---------------------------------------------------------------------------*/
+
+dtn_event_loop_backend dtn_event_loop_backend_from_string(const char *string) {
+
+    if (!string)
+        return DTN_EVENT_LOOP_BACKEND_DEFAULT;
+
+    if (0 == strcmp(string, "poll"))
+        return DTN_EVENT_LOOP_BACKEND_POLL;
+
+    if (0 == strcmp(string, "epoll"))
+        return DTN_EVENT_LOOP_BACKEND_EPOLL;
+
+    if (0 == strcmp(string, "io_uring"))
+        return DTN_EVENT_LOOP_BACKEND_IO_URING;
+
+    return DTN_EVENT_LOOP_BACKEND_DEFAULT;
+}
+
+/*---------------------------------------------------------------------------*/
+
 void *dtn_event_loop_free(void *eventloop) {
 
     dtn_event_loop *loop = dtn_event_loop_cast(eventloop);
@@ -292,6 +345,9 @@ dtn_event_loop_config_adapt_to_runtime(dtn_event_loop_config config) {
     if (config.max.timers == 0)
         config.max.timers = DTN_EVENT_LOOP_TIMERS_MIN;
 
+    if (config.max.events == 0)
+        config.max.events = DTN_EVENT_LOOP_MAX_EVENTS_DEFAULT;
+
     struct rlimit limit = {0};
 
     // Limit config to system MAX
@@ -563,14 +619,24 @@ dtn_event_loop_config dtn_event_loop_config_from_json(const dtn_item *value) {
     double timers = dtn_item_get_number(
         dtn_item_object_get(obj, DTN_EVENT_LOOP_KEY_MAX_TIMERS));
 
+    double events = dtn_item_get_number(
+        dtn_item_object_get(obj, DTN_EVENT_LOOP_KEY_MAX_EVENTS));
+
     if (sockets > UINT32_MAX)
         goto error;
 
     if (timers > UINT32_MAX)
         goto error;
 
+    if (events > UINT32_MAX)
+        goto error;
+
     config.max.sockets = (uint32_t)sockets;
     config.max.timers = (uint32_t)timers;
+    config.max.events = (uint32_t)events;
+
+    config.backend = dtn_event_loop_backend_from_string(dtn_item_get_string(
+        dtn_item_object_get(obj, DTN_EVENT_LOOP_KEY_BACKEND)));
 
     return config;
 error:
@@ -594,6 +660,14 @@ dtn_item *dtn_event_loop_config_to_json(dtn_event_loop_config config) {
     if (!dtn_item_object_set(out, DTN_EVENT_LOOP_KEY_MAX_SOCKETS, val))
         goto error;
 
+    val = dtn_item_number(config.max.events);
+    if (!dtn_item_object_set(out, DTN_EVENT_LOOP_KEY_MAX_EVENTS, val))
+        goto error;
+
+    val = dtn_item_string(dtn_event_loop_backend_to_string(config.backend));
+    if (!dtn_item_object_set(out, DTN_EVENT_LOOP_KEY_BACKEND, val))
+        goto error;
+
     return out;
 error:
     dtn_item_free(out);
@@ -53,6 +53,7 @@ int test_dtn_event_loop_config_default() {
 
     testrun(config.max.sockets == DTN_EVENT_LOOP_MAX_SOCKETS_DEFAULT);
     testrun(config.max.timers == DTN_EVENT_LOOP_MAX_TIMERS_DEFAULT);
+    testrun(config.max.events == DTN_EVENT_LOOP_MAX_EVENTS_DEFAULT);
 
     return testrun_log_success();
 }
@@ -78,6 +79,7 @@ int test_dtn_event_loop_config_adapt_to_runtime() {
     config = dtn_event_loop_config_adapt_to_runtime(config);
     testrun(config.max.sockets == DTN_EVENT_LOOP_SOCKETS_MIN);
     testrun(config.max.timers == DTN_EVENT_LOOP_TIMERS_MIN);
+    testrun(config.max.events == DTN_EVENT_LOOP_MAX_EVENTS_DEFAULT);
 
     config.max.sockets = file_limit.rlim_max + 1;
 
@@ -222,6 +224,35 @@ int test_dtn_event_loop_free() {
     return testrun_log_success();
 }
 
+/*---------------------------------------------------------------------------*/
+
+static dtn_event_loop_statistics dummy_statistics(const dtn_event_loop *self) {
+
+    UNUSED(self);
+    return (dtn_event_loop_statistics){.wait_calls = 1, .events = 2};
+}
+
+/*---------------------------------------------------------------------------*/
+
+int test_dtn_event_loop_get_statistics() {
+
+    dtn_event_loop loop = {0};
+
+    dtn_event_loop_statistics stats = dtn_event_loop_get_statistics(NULL);
+    testrun(0 == stats.wait_calls);
+    testrun(0 == stats.events);
+
+    stats = dtn_event_loop_get_statistics(&loop);
+    testrun(0 == stats.wait_calls);
+
+    loop.get_statistics = dummy_statistics;
+    stats = dtn_event_loop_get_statistics(&loop);
+    testrun(1 == stats.wait_calls);
+    testrun(2 == stats.events);
+
+    return testrun_log_success();
+}
+
 /*----------------------------------------------------------------------------*/
 
 int test_dtn_event_loop_default() {
@@ -369,6 +400,33 @@ int test_dtn_event_remove_default_connection_accept() {
 
 /*----------------------------------------------------------------------------*/
 
+int test_dtn_event_loop_backend_to_string() {
+
+    dtn_event_loop_backend backends[] = {
+        DTN_EVENT_LOOP_BACKEND_DEFAULT, DTN_EVENT_LOOP_BACKEND_POLL,
+        DTN_EVENT_LOOP_BACKEND_EPOLL, DTN_EVENT_LOOP_BACKEND_IO_URING};
+
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+
+        const char *str = dtn_event_loop_backend_to_string(backends[i]);
+        testrun(str);
+        testrun(backends[i] == dtn_event_loop_backend_from_string(str));
+    }
+
+    testrun(0 == strcmp("io_uring", dtn_event_loop_backend_to_string(
+                                        DTN_EVENT_LOOP_BACKEND_IO_URING)));
+    testrun(0 == strcmp("default", dtn_event_loop_backend_to_string(100)));
+
+    testrun(DTN_EVENT_LOOP_BACKEND_DEFAULT ==
+            dtn_event_loop_backend_from_string(NULL));
+    testrun(DTN_EVENT_LOOP_BACKEND_DEFAULT ==
+            dtn_event_loop_backend_from_string("kqueue"));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
 int test_dtn_event_loop_config_from_json() {
 
     dtn_item *obj = NULL;
@@ -480,17 +538,32 @@ int test_dtn_event_loop_config_to_json() {
                      dtn_item_object_get(val, DTN_EVENT_LOOP_KEY_MAX_TIMERS)));
     testrun(0 == dtn_item_get_number(
                      dtn_item_object_get(val, DTN_EVENT_LOOP_KEY_MAX_SOCKETS)));
+
+    testrun(0 == strcmp("default", dtn_item_get_string(dtn_item_object_get(
+                                       val, DTN_EVENT_LOOP_KEY_BACKEND))));
     val = dtn_item_free(val);
 
     config.max.sockets = 15;
     config.max.timers = 1;
+    config.max.events = 8;
+    config.backend = DTN_EVENT_LOOP_BACKEND_IO_URING;
 
     val = dtn_event_loop_config_to_json(config);
     testrun(val);
+    testrun(0 == strcmp("io_uring", dtn_item_get_string(dtn_item_object_get(
+                                        val, DTN_EVENT_LOOP_KEY_BACKEND))));
     testrun(1 == dtn_item_get_number(
                      dtn_item_object_get(val, DTN_EVENT_LOOP_KEY_MAX_TIMERS)));
     testrun(15 == dtn_item_get_number(dtn_item_object_get(
                       val, DTN_EVENT_LOOP_KEY_MAX_SOCKETS)));
+    testrun(8 == dtn_item_get_number(
+                     dtn_item_object_get(val, DTN_EVENT_LOOP_KEY_MAX_EVENTS)));
+
+    config = dtn_event_loop_config_from_json(val);
+    testrun(15 == config.max.sockets);
+    testrun(1 == config.max.timers);
+    testrun(8 == config.max.events);
+    testrun(DTN_EVENT_LOOP_BACKEND_IO_URING == config.backend);
     val = dtn_item_free(val);
 
     return testrun_log_success();
@@ -508,6 +581,7 @@ int all_tests() {
 
     testrun_init();
 
+    testrun_test(test_dtn_event_loop_backend_to_string);
     testrun_test(test_dtn_event_loop_config_from_json);
     testrun_test(test_dtn_event_loop_config_to_json);
 
@@ -518,6 +592,7 @@ int all_tests() {
     testrun_test(test_dtn_event_loop_setup_signals);
     testrun_test(test_dtn_event_loop_set_type);
     testrun_test(test_dtn_event_loop_free);
+    testrun_test(test_dtn_event_loop_get_statistics);
 
     testrun_test(test_dtn_event_add_default_connection_accept);
     testrun_test(test_dtn_event_remove_default_connection_accept);
@@ -0,0 +1,692 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_flat_dict.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        @ingroup        dtn_base
+
+        @brief          Implementation of an open addressing dict.
+
+        The control array holds one byte per slot:
+
+            0x80            empty
+            0xfe            deleted
+            0x00 - 0x7f     used, lower 7 bits of the key hash
+
+        The first FLAT_GROUP control bytes are mirrored behind the
+        capacity, so a group may be loaded at any slot position.
+
+        Groups are probed with triangular steps, which visits all groups
+        of a power of 2 sized table.
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_flat_dict.h"
+#include "../include/dtn_utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *                        INTERNAL DATA STRUCTURES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+const uint16_t IMPL_FLAT_DICT_TYPE = 0xf1a7;
+
+#define FLAT_GROUP 16
+#define FLAT_MIN_CAPACITY 16
+
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xfe
+
+typedef struct flat_slot {
+
+    uint64_t hash;
+    void *key;
+    void *value;
+
+} flat_slot;
+
+/*---------------------------------------------------------------------------*/
+
+typedef struct {
+
+    dtn_dict public;
+
+    uint8_t *ctrl; // capacity + FLAT_GROUP bytes
+    flat_slot *slots;
+
+    uint64_t capacity;     // power of 2
+    uint64_t min_capacity; // capacity of config.slots
+    uint64_t count;        // used slots
+    uint64_t deleted;      // deleted slots
+    uint64_t growth_left;  // empty slots usable before resize
+    uint64_t iterating;    // running for_each calls
+
+} FlatDict;
+
+#define AS_FLAT_DICT(x)                                                        \
+    (((dtn_dict_cast(x) != 0) &&                                               \
+      (IMPL_FLAT_DICT_TYPE == ((dtn_dict *)x)->type))                          \
+         ? (FlatDict *)(x)                                                     \
+         : 0)
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *                        GROUP MATCHING
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static inline uint32_t group_match(const uint8_t *ctrl, uint8_t byte) {
+
+#ifdef __SSE2__
+
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    __m128i match = _mm_set1_epi8((char)byte);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, match));
+
+#else
+
+    uint32_t mask = 0;
+
+    for (size_t i = 0; i < FLAT_GROUP; i++) {
+        if (ctrl[i] == byte)
+            mask |= (uint32_t)1 << i;
+    }
+
+    return mask;
+
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static inline uint32_t group_match_free(const uint8_t *ctrl) {
+
+    // empty and deleted are the only control bytes with the high bit set
+
+#ifdef __SSE2__
+
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (uint32_t)_mm_movemask_epi8(group);
+
+#else
+
+    uint32_t mask = 0;
+
+    for (size_t i = 0; i < FLAT_GROUP; i++) {
+        if (ctrl[i] & 0x80)
+            mask |= (uint32_t)1 << i;
+    }
+
+    return mask;
+
+#endif
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *                        TABLE FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static inline uint64_t flat_hash(const dtn_dict *self, const void *key) {
+
+    return dtn_hash_mix64(self->config.key.hash(key));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static inline void set_ctrl(FlatDict *d, uint64_t i, uint8_t byte) {
+
+    d->ctrl[i] = byte;
+
+    if (i < FLAT_GROUP)
+        d->ctrl[d->capacity + i] = byte;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int64_t find_key(const FlatDict *d, const void *key, uint64_t hash) {
+
+    const dtn_dict *self = (const dtn_dict *)d;
+
+    uint64_t mask = d->capacity - 1;
+    uint64_t pos = (hash >> 7) & mask;
+    uint8_t h2 = hash & 0x7f;
+
+    for (uint64_t probe = 0; probe < d->capacity; probe += FLAT_GROUP) {
+
+        const uint8_t *group = d->ctrl + pos;
+        uint32_t match = group_match(group, h2);
+
+        while (match) {
+
+            uint64_t i = (pos + __builtin_ctz(match)) & mask;
+
+            if ((d->slots[i].hash == hash) &&
+                self->config.key.match(key, d->slots[i].key))
+                return i;
+
+            match &= match - 1;
+        }
+
+        if (group_match(group, CTRL_EMPTY))
+            break;
+
+        pos = (pos + probe + FLAT_GROUP) & mask;
+    }
+
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int64_t find_free(const FlatDict *d, uint64_t hash) {
+
+    uint64_t mask = d->capacity - 1;
+    uint64_t pos = (hash >> 7) & mask;
+
+    for (uint64_t probe = 0; probe < d->capacity; probe += FLAT_GROUP) {
+
+        uint32_t match = group_match_free(d->ctrl + pos);
+        if (match)
+            return (pos + __builtin_ctz(match)) & mask;
+
+        pos = (pos + probe + FLAT_GROUP) & mask;
+    }
+
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint64_t max_load(uint64_t capacity) { return capacity - capacity / 8; }
+
+/*---------------------------------------------------------------------------*/
+
+static bool flat_resize(FlatDict *d, uint64_t capacity) {
+
+    uint8_t *ctrl = malloc(capacity + FLAT_GROUP);
+    flat_slot *slots = calloc(capacity, sizeof(flat_slot));
+
+    if (!ctrl || !slots)
+        goto error;
+
+    memset(ctrl, CTRL_EMPTY, capacity + FLAT_GROUP);
+
+    uint8_t *old_ctrl = d->ctrl;
+    flat_slot *old_slots = d->slots;
+    uint64_t old_capacity = d->capacity;
+
+    d->ctrl = ctrl;
+    d->slots = slots;
+    d->capacity = capacity;
+
+    for (uint64_t i = 0; i < old_capacity; i++) {
+
+        if (old_ctrl[i] & 0x80)
+            continue;
+
+        int64_t slot = find_free(d, old_slots[i].hash);
+        DTN_ASSERT(slot >= 0);
+
+        set_ctrl(d, slot, old_slots[i].hash & 0x7f);
+        d->slots[slot] = old_slots[i];
+    }
+
+    free(old_ctrl);
+    free(old_slots);
+
+    d->deleted = 0;
+    d->growth_left = max_load(capacity) - d->count;
+    d->public.config.slots = capacity;
+    return true;
+error:
+    free(ctrl);
+    free(slots);
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void flat_reserve(FlatDict *d) {
+
+    if (d->growth_left > 0 || d->iterating)
+        return;
+
+    /* Mostly deleted slots are purged with a rehash at the same
+     * capacity, otherwise the table grows. A failed resize keeps the
+     * current table as long as some free slot is left. */
+
+    if (d->count + 1 > max_load(d->capacity) / 2) {
+        flat_resize(d, 2 * d->capacity);
+    } else {
+        flat_resize(d, d->capacity);
+    }
+
+    return;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void flat_reset_ctrl(FlatDict *d) {
+
+    memset(d->ctrl, CTRL_EMPTY, d->capacity + FLAT_GROUP);
+    memset(d->slots, 0, d->capacity * sizeof(flat_slot));
+
+    d->count = 0;
+    d->deleted = 0;
+    d->growth_left = max_load(d->capacity);
+    return;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *                        PROTOTYPE DEFINITION
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static bool impl_flat_dict_is_empty(const dtn_dict *self);
+static bool impl_flat_dict_clear(dtn_dict *self);
+static dtn_dict *impl_flat_dict_free(dtn_dict *self);
+
+static dtn_list *impl_flat_dict_get_keys(const dtn_dict *self,
+                                         const void *value);
+static void *impl_flat_dict_get(const dtn_dict *self, const void *key);
+static bool impl_flat_dict_set(dtn_dict *self, void *key, void *value,
+                               void **replaced);
+static bool impl_flat_dict_del(dtn_dict *self, const void *key);
+static void *impl_flat_dict_remove(dtn_dict *self, const void *key);
+
+static bool impl_flat_dict_for_each(dtn_dict *self, void *data,
+                                    bool (*function)(const void *key,
+                                                     void *value,
+                                                     void *data));
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *                        STRUCTURE CREATION
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_dict *dtn_flat_dict_create(dtn_dict_config config) {
+
+    dtn_dict *dict = NULL;
+
+    if (!dtn_dict_config_is_valid(&config))
+        goto error;
+
+    uint64_t capacity = FLAT_MIN_CAPACITY;
+
+    while (max_load(capacity) < config.slots) {
+
+        if (capacity > (UINT64_MAX >> 2))
+            goto error;
+
+        capacity *= 2;
+    }
+
+    dict = calloc(1, sizeof(FlatDict));
+    if (!dict)
+        goto error;
+
+    if (!dtn_dict_set_magic_bytes(dict))
+        goto error;
+
+    config.type = DTN_DICT_FLAT;
+    config.slots = capacity;
+
+    dict->type = IMPL_FLAT_DICT_TYPE;
+    dict->config = config;
+
+    dict->is_empty = impl_flat_dict_is_empty;
+    dict->create = dtn_flat_dict_create;
+    dict->clear = impl_flat_dict_clear;
+    dict->free = impl_flat_dict_free;
+    dict->get_keys = impl_flat_dict_get_keys;
+    dict->get = impl_flat_dict_get;
+    dict->set = impl_flat_dict_set;
+    dict->del = impl_flat_dict_del;
+    dict->remove = impl_flat_dict_remove;
+    dict->for_each = impl_flat_dict_for_each;
+
+    FlatDict *d = AS_FLAT_DICT(dict);
+    if (!d)
+        goto error;
+
+    d->ctrl = malloc(capacity + FLAT_GROUP);
+    d->slots = calloc(capacity, sizeof(flat_slot));
+
+    if (!d->ctrl || !d->slots)
+        goto error;
+
+    d->capacity = capacity;
+    d->min_capacity = capacity;
+    flat_reset_ctrl(d);
+
+    return dict;
+error:
+    if (dict) {
+        free(((FlatDict *)dict)->ctrl);
+        free(((FlatDict *)dict)->slots);
+        free(dict);
+    }
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool dtn_flat_dict_is_set(const dtn_dict *self, const void *key) {
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d)
+        return false;
+
+    return find_key(d, key, flat_hash(self, key)) >= 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int64_t dtn_flat_dict_count(const dtn_dict *self) {
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d)
+        return -1;
+
+    return d->count;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *                        INTERFACE IMPLEMENTATION
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static bool impl_flat_dict_is_empty(const dtn_dict *self) {
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d)
+        return false;
+
+    return 0 == d->count;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool impl_flat_dict_clear(dtn_dict *self) {
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d)
+        goto error;
+
+    for (uint64_t i = 0; i < d->capacity; i++) {
+
+        if (d->ctrl[i] & 0x80)
+            continue;
+
+        if (self->config.key.data_function.free)
+            self->config.key.data_function.free(d->slots[i].key);
+
+        if (self->config.value.data_function.free)
+            self->config.value.data_function.free(d->slots[i].value);
+    }
+
+    flat_reset_ctrl(d);
+
+    // an empty table returns to the configured capacity
+    if (!d->iterating && (d->capacity != d->min_capacity))
+        flat_resize(d, d->min_capacity);
+
+    return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static dtn_dict *impl_flat_dict_free(dtn_dict *self) {
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d)
+        return self;
+
+    if (!self->clear(self))
+        return self;
+
+    free(d->ctrl);
+    free(d->slots);
+    free(d);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static dtn_list *impl_flat_dict_get_keys(const dtn_dict *self,
+                                         const void *value) {
+
+    dtn_list *keys = NULL;
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d)
+        goto error;
+
+    keys = dtn_list_create((dtn_list_config){0});
+    if (!keys)
+        goto error;
+
+    for (uint64_t i = 0; i < d->capacity; i++) {
+
+        if (d->ctrl[i] & 0x80)
+            continue;
+
+        // same as the default dict, keys without value are not collected
+        if (!d->slots[i].value)
+            continue;
+
+        if (value && (value != d->slots[i].value))
+            continue;
+
+        if (!dtn_list_push(keys, d->slots[i].key))
+            goto error;
+    }
+
+    return keys;
+error:
+    dtn_list_free(keys);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void *impl_flat_dict_get(const dtn_dict *self, const void *key) {
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d)
+        return NULL;
+
+    int64_t i = find_key(d, key, flat_hash(self, key));
+    if (i < 0)
+        return NULL;
+
+    return d->slots[i].value;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool impl_flat_dict_set(dtn_dict *self, void *key, void *value,
+                               void **replaced) {
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d)
+        goto error;
+
+    if (self->config.key.validate_input)
+        if (!self->config.key.validate_input(key))
+            return false;
+
+    if (self->config.value.validate_input)
+        if (!self->config.value.validate_input(value))
+            return false;
+
+    uint64_t hash = flat_hash(self, key);
+
+    int64_t i = find_key(d, key, hash);
+
+    if (i >= 0) {
+
+        flat_slot *slot = &d->slots[i];
+
+        if (self->config.key.data_function.free)
+            self->config.key.data_function.free(slot->key);
+
+        slot->key = key;
+
+        if (replaced) {
+            *replaced = slot->value;
+        } else if (self->config.value.data_function.free) {
+            self->config.value.data_function.free(slot->value);
+        }
+
+        slot->value = value;
+        return true;
+    }
+
+    flat_reserve(d);
+
+    i = find_free(d, hash);
+    if (i < 0)
+        goto error;
+
+    if (CTRL_EMPTY == d->ctrl[i]) {
+
+        // growth_left is exhausted only while iterating
+        if (d->growth_left > 0)
+            d->growth_left--;
+
+    } else {
+
+        d->deleted--;
+    }
+
+    set_ctrl(d, i, hash & 0x7f);
+    d->slots[i] = (flat_slot){.hash = hash, .key = key, .value = value};
+    d->count++;
+
+    return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool impl_flat_dict_del(dtn_dict *self, const void *key) {
+
+    if (!AS_FLAT_DICT(self))
+        return false;
+
+    void *value = impl_flat_dict_remove(self, key);
+    if (value)
+        if (self->config.value.data_function.free)
+            self->config.value.data_function.free(value);
+
+    return true;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void *impl_flat_dict_remove(dtn_dict *self, const void *key) {
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d)
+        return NULL;
+
+    int64_t i = find_key(d, key, flat_hash(self, key));
+    if (i < 0)
+        return NULL;
+
+    void *value = d->slots[i].value;
+
+    if (self->config.key.data_function.free)
+        self->config.key.data_function.free(d->slots[i].key);
+
+    d->slots[i] = (flat_slot){0};
+    set_ctrl(d, i, CTRL_DELETED);
+
+    d->deleted++;
+    d->count--;
+
+    if (0 == d->count && !d->iterating)
+        flat_reset_ctrl(d);
+
+    return value;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool impl_flat_dict_for_each(dtn_dict *self, void *data,
+                                    bool (*function)(const void *key,
+                                                     void *value,
+                                                     void *data)) {
+
+    FlatDict *d = AS_FLAT_DICT(self);
+    if (!d || !function)
+        goto error;
+
+    d->iterating++;
+
+    for (uint64_t i = 0; i < d->capacity; i++) {
+
+        if (d->ctrl[i] & 0x80)
+            continue;
+
+        if (!function(d->slots[i].key, d->slots[i].value, data)) {
+            d->iterating--;
+            goto error;
+        }
+    }
+
+    d->iterating--;
+    return true;
+error:
+    return false;
+}
@@ -0,0 +1,338 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_flat_dict_test.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_dict_test_interface.h"
+#include "dtn_flat_dict.c"
+
+/*---------------------------------------------------------------------------*/
+
+static uint64_t hash_constant(const void *key) {
+
+    UNUSED(key);
+    return 42;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CASES                                                      #CASES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int test_dtn_flat_dict_create() {
+
+    dtn_dict_config config = {0};
+
+    testrun(!dtn_flat_dict_create(config));
+
+    config = dtn_dict_string_key_config(1);
+    dtn_dict *dict = dtn_flat_dict_create(config);
+    testrun(dict);
+    testrun(dtn_dict_is_valid(dict));
+    testrun(dict->type == IMPL_FLAT_DICT_TYPE);
+    testrun(dict->config.type == DTN_DICT_FLAT);
+    testrun(dict->config.slots == FLAT_MIN_CAPACITY);
+    testrun(dict->create == dtn_flat_dict_create);
+
+    FlatDict *d = AS_FLAT_DICT(dict);
+    testrun(d->capacity == FLAT_MIN_CAPACITY);
+    testrun(d->growth_left == 14);
+    testrun(d->count == 0);
+
+    for (size_t i = 0; i < FLAT_MIN_CAPACITY + FLAT_GROUP; i++) {
+        testrun(d->ctrl[i] == CTRL_EMPTY);
+    }
+
+    testrun(NULL == dtn_dict_free(dict));
+
+    // slots are the expected number of entries
+    dict = dtn_flat_dict_create(dtn_dict_string_key_config(255));
+    testrun(dict->config.slots == 512);
+    testrun(NULL == dtn_dict_free(dict));
+
+    dict = dtn_flat_dict_create(dtn_dict_string_key_config(224));
+    testrun(dict->config.slots == 256);
+    testrun(NULL == dtn_dict_free(dict));
+
+    // selected over dtn_dict_create
+    config = dtn_dict_intptr_key_config(100);
+    config.type = DTN_DICT_FLAT;
+    dict = dtn_dict_create(config);
+    testrun(AS_FLAT_DICT(dict));
+    testrun(NULL == dtn_dict_free(dict));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_flat_dict_is_set() {
+
+    dtn_dict *dict = dtn_flat_dict_create(dtn_dict_string_key_config(1));
+
+    testrun(!dtn_flat_dict_is_set(NULL, "key"));
+    testrun(!dtn_flat_dict_is_set(dict, "key"));
+
+    testrun(dtn_dict_set(dict, strdup("key"), NULL, NULL));
+    testrun(dtn_flat_dict_is_set(dict, "key"));
+    testrun(dtn_dict_is_set(dict, "key"));
+    testrun(!dtn_dict_is_set(dict, "key1"));
+
+    testrun(dtn_dict_del(dict, "key"));
+    testrun(!dtn_dict_is_set(dict, "key"));
+
+    testrun(NULL == dtn_dict_free(dict));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_flat_dict_count() {
+
+    dtn_dict *dict = dtn_flat_dict_create(dtn_dict_intptr_key_config(1));
+
+    testrun(-1 == dtn_flat_dict_count(NULL));
+    testrun(0 == dtn_flat_dict_count(dict));
+
+    for (intptr_t i = 1; i <= 100; i++) {
+        testrun(dtn_dict_set(dict, (void *)i, (void *)i, NULL));
+        testrun(i == dtn_dict_count(dict));
+    }
+
+    // replace does not change the count
+    testrun(dtn_dict_set(dict, (void *)1, (void *)2, NULL));
+    testrun(100 == dtn_flat_dict_count(dict));
+
+    for (intptr_t i = 1; i <= 100; i++) {
+        testrun(dtn_dict_del(dict, (void *)i));
+        testrun(100 - i == dtn_dict_count(dict));
+    }
+
+    testrun(NULL == dtn_dict_free(dict));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_flat_resize() {
+
+    dtn_dict *dict = dtn_flat_dict_create(dtn_dict_intptr_key_config(1));
+    FlatDict *d = AS_FLAT_DICT(dict);
+
+    for (intptr_t i = 1; i <= 14; i++) {
+        testrun(dtn_dict_set(dict, (void *)i, (void *)i, NULL));
+    }
+
+    testrun(16 == d->capacity);
+    testrun(0 == d->growth_left);
+
+    // grows on the next insert
+    testrun(dtn_dict_set(dict, (void *)15, (void *)15, NULL));
+    testrun(32 == d->capacity);
+    testrun(32 == dict->config.slots);
+    testrun(28 - 15 == d->growth_left);
+
+    for (intptr_t i = 16; i <= 10000; i++) {
+        testrun(dtn_dict_set(dict, (void *)i, (void *)i, NULL));
+    }
+
+    testrun(16384 == d->capacity);
+
+    for (intptr_t i = 1; i <= 10000; i++) {
+        testrun((void *)i == dtn_dict_get(dict, (void *)i));
+    }
+
+    testrun(!dtn_dict_get(dict, (void *)10001));
+
+    // clear returns to the configured capacity
+    testrun(dtn_dict_clear(dict));
+    testrun(16 == d->capacity);
+    testrun(16 == dict->config.slots);
+    testrun(dtn_dict_is_empty(dict));
+
+    testrun(NULL == dtn_dict_free(dict));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_flat_deleted() {
+
+    dtn_dict *dict = dtn_flat_dict_create(dtn_dict_intptr_key_config(1));
+    FlatDict *d = AS_FLAT_DICT(dict);
+
+    testrun(dtn_dict_set(dict, (void *)1, (void *)1, NULL));
+
+    // insert and delete cycles are purged without growing the table
+    for (intptr_t i = 2; i <= 1000; i++) {
+
+        testrun(dtn_dict_set(dict, (void *)i, (void *)i, NULL));
+        testrun(dtn_dict_del(dict, (void *)i));
+        testrun(d->count == 1);
+        testrun(d->count + d->deleted + d->growth_left == 14);
+    }
+
+    testrun(16 == d->capacity);
+    testrun((void *)1 == dtn_dict_get(dict, (void *)1));
+
+    // removing the last pair resets all slots
+    testrun((void *)1 == dtn_dict_remove(dict, (void *)1));
+    testrun(0 == d->deleted);
+    testrun(14 == d->growth_left);
+
+    testrun(NULL == dtn_dict_free(dict));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_flat_collisions() {
+
+    dtn_dict_config config = dtn_dict_intptr_key_config(1);
+    config.key.hash = hash_constant;
+
+    dtn_dict *dict = dtn_flat_dict_create(config);
+
+    for (intptr_t i = 1; i <= 100; i++) {
+        testrun(dtn_dict_set(dict, (void *)i, (void *)i, NULL));
+    }
+
+    for (intptr_t i = 1; i <= 100; i++) {
+        testrun((void *)i == dtn_dict_get(dict, (void *)i));
+    }
+
+    // lookups behind deleted slots
+    for (intptr_t i = 1; i <= 100; i += 2) {
+        testrun(dtn_dict_del(dict, (void *)i));
+    }
+
+    for (intptr_t i = 1; i <= 100; i++) {
+
+        if (i % 2) {
+            testrun(!dtn_dict_is_set(dict, (void *)i));
+        } else {
+            testrun((void *)i == dtn_dict_get(dict, (void *)i));
+        }
+    }
+
+    testrun(50 == dtn_dict_count(dict));
+    testrun(NULL == dtn_dict_free(dict));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool set_while_iterating(const void *key, void *value, void *data) {
+
+    UNUSED(value);
+
+    dtn_dict *dict = dtn_dict_cast(data);
+    intptr_t k = (intptr_t)key;
+
+    if (k > 1000)
+        return true;
+
+    return dtn_dict_set(dict, (void *)(k + 1000), (void *)k, NULL);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool add_while_iterating(const void *key, void *value, void *data) {
+
+    UNUSED(value);
+
+    dtn_dict *dict = dtn_dict_cast(data);
+    intptr_t k = (intptr_t)key;
+
+    return dtn_dict_set(dict, (void *)(k + 2000), NULL, NULL);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_flat_for_each_modify() {
+
+    dtn_dict *dict = dtn_flat_dict_create(dtn_dict_intptr_key_config(1));
+    FlatDict *d = AS_FLAT_DICT(dict);
+
+    for (intptr_t i = 1; i <= 8; i++) {
+        testrun(dtn_dict_set(dict, (void *)i, (void *)i, NULL));
+    }
+
+    // no resize while iterating, free slots are used instead
+    testrun(dtn_dict_for_each(dict, dict, set_while_iterating));
+    testrun(16 == d->capacity);
+    testrun(0 == d->iterating);
+    testrun(16 == dtn_dict_count(dict));
+
+    for (intptr_t i = 1; i <= 8; i++) {
+        testrun((void *)i == dtn_dict_get(dict, (void *)(i + 1000)));
+    }
+
+    // a full table rejects inserts while iterating
+    testrun(!dtn_dict_for_each(dict, dict, add_while_iterating));
+    testrun(0 == d->iterating);
+
+    // resize resumes after iteration
+    testrun(dtn_dict_set(dict, (void *)5000, NULL, NULL));
+    testrun(32 == d->capacity);
+    testrun(17 == dtn_dict_count(dict));
+
+    testrun(NULL == dtn_dict_free(dict));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int all_tests() {
+
+    testrun_init();
+    testrun_test(test_dtn_flat_dict_create);
+    testrun_test(test_dtn_flat_dict_is_set);
+    testrun_test(test_dtn_flat_dict_count);
+
+    DTN_DICT_PERFORM_PERFORM_INTERFACE_TESTS(dtn_flat_dict_create);
+
+    testrun_test(test_flat_resize);
+    testrun_test(test_flat_deleted);
+    testrun_test(test_flat_collisions);
+    testrun_test(test_flat_for_each_modify);
+
+    return testrun_counter;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST EXECUTION                                                  #EXEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+testrun_run(all_tests);
@@ -36,6 +36,7 @@
 #include "../include/dtn_socket.h"
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 uint64_t dtn_hash_simple_c_string(const void *c_string) {
 
@@ -119,6 +120,107 @@ uint64_t dtn_hash_pearson_c_string(const void *c_string) {
     return h;
 }
 
+/******************************************************************************
+ *                              64 BIT HASHING
+ *
+ *      Multiply and fold hashing of 8 byte words in the style of wyhash.
+ ******************************************************************************/
+
+#define HASH_SECRET_0 0xa0761d6478bd642full
+#define HASH_SECRET_1 0xe7037ed1a0b428dbull
+#define HASH_SECRET_2 0x8ebc6af09c88c6e3ull
+
+/*----------------------------------------------------------------------------*/
+
+static inline uint64_t hash_fold(uint64_t a, uint64_t b) {
+
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)(r >> 64) ^ (uint64_t)r;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static inline uint64_t hash_read64(const uint8_t *p) {
+
+    uint64_t v = 0;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static inline uint64_t hash_read_tail(const uint8_t *p, size_t size) {
+
+    // 0 < size < 8
+    uint64_t v = 0;
+    memcpy(&v, p, size);
+    return v;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_hash_bytes(const void *data, size_t size) {
+
+    return dtn_hash_bytes_seed(data, size, 0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_hash_bytes_seed(const void *data, size_t size, uint64_t seed) {
+
+    const uint8_t *p = data;
+    seed ^= HASH_SECRET_0 ^ size;
+
+    if (!p)
+        size = 0;
+
+    while (size >= 16) {
+
+        seed = hash_fold(hash_read64(p) ^ HASH_SECRET_1,
+                         hash_read64(p + 8) ^ seed);
+        p += 16;
+        size -= 16;
+    }
+
+    uint64_t a = 0;
+    uint64_t b = 0;
+
+    if (size >= 8) {
+
+        a = hash_read64(p);
+        p += 8;
+        size -= 8;
+    }
+
+    if (size > 0)
+        b = hash_read_tail(p, size);
+
+    return hash_fold(HASH_SECRET_1 ^ seed,
+                     hash_fold(a ^ HASH_SECRET_1, b ^ seed) ^ HASH_SECRET_2);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_hash_c_string(const void *c_string) {
+
+    if (0 == c_string)
+        return 0;
+
+    return dtn_hash_bytes(c_string, strlen(c_string));
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_hash_mix64(uint64_t value) {
+
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
 /*----------------------------------------------------------------------------*/
 
 uint64_t dtn_hash_intptr(const void *intptr) {
@@ -164,5 +266,5 @@ uint64_t dtn_hash_dtn_socket_data(const void *self) {
     dtn_socket_data *data = (dtn_socket_data *)self;
     size_t bytes = snprintf(buffer, 1024, "%s:%i", data->host, data->port);
     buffer[bytes + 1] = 0;
-    return dtn_hash_pearson_c_string(buffer);
+    return dtn_hash_c_string(buffer);
 }
\ No newline at end of file
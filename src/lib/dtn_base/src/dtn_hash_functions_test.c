@@ -156,6 +156,116 @@ int test_dtn_hash_pearson_c_string() {
 
 /*----------------------------------------------------------------------------*/
 
+int test_dtn_hash_bytes() {
+
+    uint8_t buffer[100] = {0};
+
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)i;
+    }
+
+    testrun(dtn_hash_bytes(NULL, 0) == dtn_hash_bytes(buffer, 0));
+    testrun(dtn_hash_bytes(buffer, 10) == dtn_hash_bytes(buffer, 10));
+
+    // every length and every byte matters
+    for (size_t i = 1; i < sizeof(buffer); i++) {
+
+        testrun(dtn_hash_bytes(buffer, i) != dtn_hash_bytes(buffer, i - 1));
+
+        uint64_t hash = dtn_hash_bytes(buffer, i);
+        buffer[i - 1] ^= 0x01;
+        testrun(hash != dtn_hash_bytes(buffer, i));
+        buffer[i - 1] ^= 0x01;
+    }
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_hash_bytes_seed() {
+
+    uint8_t buffer[100] = {0};
+
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)i;
+    }
+
+    testrun(dtn_hash_bytes(buffer, 10) == dtn_hash_bytes_seed(buffer, 10, 0));
+    testrun(dtn_hash_bytes_seed(buffer, 10, 1) ==
+            dtn_hash_bytes_seed(buffer, 10, 1));
+
+    // every seed matters, no common bits of different seeds
+
+    uint64_t same = 0;
+
+    for (uint64_t seed = 1; seed < 1000; seed++) {
+
+        uint64_t a = dtn_hash_bytes_seed(buffer, 20, seed - 1);
+        uint64_t b = dtn_hash_bytes_seed(buffer, 20, seed);
+        testrun(a != b);
+        same += 64 - __builtin_popcountll(a ^ b);
+    }
+
+    // about half of the bits are the same
+    testrun(same > 999 * 28);
+    testrun(same < 999 * 36);
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_hash_c_string() {
+
+    testrun(0 == dtn_hash_c_string(NULL));
+    testrun(dtn_hash_c_string("abc") == dtn_hash_bytes("abc", 3));
+    testrun(dtn_hash_c_string("abc") != dtn_hash_c_string("abd"));
+
+    helper_hash_function_c_string(dtn_hash_c_string, UINT64_MAX / 2);
+
+    // similar keys spread over all slots
+    uint64_t slots[256] = {0};
+    char key[32] = {0};
+
+    for (size_t i = 0; i < 256 * 100; i++) {
+
+        snprintf(key, sizeof(key), "dtn://node-%zu/", i);
+        slots[dtn_hash_c_string(key) % 256]++;
+    }
+
+    for (size_t i = 0; i < 256; i++) {
+        testrun(slots[i] > 50);
+        testrun(slots[i] < 150);
+    }
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_hash_mix64() {
+
+    testrun(dtn_hash_mix64(1) != 1);
+    testrun(dtn_hash_mix64(1) != dtn_hash_mix64(2));
+
+    // aligned pointers spread over all slots
+    uint64_t slots[64] = {0};
+
+    for (uint64_t i = 0; i < 64 * 100; i++) {
+        slots[dtn_hash_mix64(0x7f0000001000 + i * 64) % 64]++;
+    }
+
+    for (size_t i = 0; i < 64; i++) {
+        testrun(slots[i] > 50);
+        testrun(slots[i] < 150);
+    }
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
 int test_dtn_hash_intptr() {
 
     for (intptr_t i = 0; i < 0xffff; i++) {
@@ -213,6 +323,10 @@ int all_tests() {
     testrun_init();
     testrun_test(test_dtn_hash_simple_c_string);
     testrun_test(test_dtn_hash_pearson_c_string);
+    testrun_test(test_dtn_hash_bytes);
+    testrun_test(test_dtn_hash_bytes_seed);
+    testrun_test(test_dtn_hash_c_string);
+    testrun_test(test_dtn_hash_mix64);
     testrun_test(test_dtn_hash_intptr);
     testrun_test(test_dtn_hash_uint64);
     testrun_test(test_dtn_hash_int64);
@@ -63,7 +63,8 @@ dtn_io_buffer *dtn_io_buffer_create(dtn_io_buffer_config config) {
         goto error;
 
     dtn_dict_config d_config =
-        (dtn_dict_config){.slots = 255,
+        (dtn_dict_config){.type = DTN_DICT_FLAT,
+                          .slots = 255,
                           .key.data_function.free = dtn_data_pointer_free,
                           .key.hash = dtn_hash_dtn_socket_data,
                           .key.match = dtn_match_dtn_socket_data,
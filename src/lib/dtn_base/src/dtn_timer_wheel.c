@@ -0,0 +1,598 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_timer_wheel.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_timer_wheel.h"
+
+#include "../include/dtn_log.h"
+#include "../include/dtn_utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DTN_TIMER_WHEEL_MAGIC_BYTES 0x7768
+
+#define LEVELS 4
+#define LEVEL_BITS 8
+#define SLOTS (1 << LEVEL_BITS)
+#define SLOT_MASK (SLOTS - 1)
+#define WORDS (SLOTS / 64)
+
+#define BLOCK_BITS 8
+#define BLOCK_SIZE (1 << BLOCK_BITS)
+
+/* id = generation << INDEX_BITS | index + 1 */
+#define INDEX_BITS 20
+#define INDEX_MASK ((1u << INDEX_BITS) - 1)
+#define GENERATION_MASK ((1u << (32 - INDEX_BITS)) - 1)
+
+#define EXPIRED LEVELS
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct wheel_link {
+
+    struct wheel_link *prev;
+    struct wheel_link *next;
+
+} wheel_link;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct wheel_timer {
+
+    wheel_link link; // first member, slot lists link timers
+
+    uint64_t expires;
+
+    uint32_t id; // 0 if not in use
+    uint32_t index;
+    uint16_t generation;
+
+    uint8_t level;
+    uint8_t slot;
+
+    void *data;
+    bool (*callback)(uint32_t id, void *data);
+
+} wheel_timer;
+
+/*----------------------------------------------------------------------------*/
+
+struct dtn_timer_wheel {
+
+    uint16_t magic_bytes;
+    dtn_timer_wheel_config config;
+
+    uint64_t current;
+    size_t count;
+
+    wheel_link slots[LEVELS][SLOTS];
+    uint64_t occupied[LEVELS][WORDS];
+
+    // timers of the tick in progress, callbacks may unset them
+    wheel_link expired;
+
+    wheel_timer **blocks;
+    size_t num_blocks;
+
+    wheel_timer *unused; // linked over link.next
+};
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      LISTS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static void list_init(wheel_link *head) {
+
+    head->prev = head;
+    head->next = head;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool list_is_empty(const wheel_link *head) {
+
+    return head->next == head;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void list_append(wheel_link *head, wheel_link *item) {
+
+    item->prev = head->prev;
+    item->next = head;
+    head->prev->next = item;
+    head->prev = item;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void list_remove(wheel_link *item) {
+
+    item->prev->next = item->next;
+    item->next->prev = item->prev;
+    item->prev = NULL;
+    item->next = NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void list_move(wheel_link *to, wheel_link *from) {
+
+    if (list_is_empty(from))
+        return;
+
+    from->next->prev = to->prev;
+    to->prev->next = from->next;
+    from->prev->next = to;
+    to->prev = from->prev;
+
+    list_init(from);
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      SLOTS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static void slot_mark(dtn_timer_wheel *self, uint8_t level, uint8_t slot) {
+
+    self->occupied[level][slot >> 6] |= (uint64_t)1 << (slot & 63);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void slot_unmark(dtn_timer_wheel *self, uint8_t level, uint8_t slot) {
+
+    self->occupied[level][slot >> 6] &= ~((uint64_t)1 << (slot & 63));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int occupied_distance(const uint64_t bits[WORDS], uint32_t start) {
+
+    uint32_t distance = 0;
+
+    while (distance < SLOTS) {
+
+        uint32_t pos = (start + distance) & SLOT_MASK;
+        uint64_t word = bits[pos >> 6] >> (pos & 63);
+
+        if (word)
+            return distance + __builtin_ctzll(word);
+
+        distance += 64 - (pos & 63);
+    }
+
+    return -1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void timer_insert(dtn_timer_wheel *self, wheel_timer *timer) {
+
+    uint64_t expires = timer->expires;
+    uint64_t delta = 0;
+
+    if (expires > self->current)
+        delta = expires - self->current;
+
+    // out of range timers wait at the end of the top level
+
+    const uint64_t range = (uint64_t)1 << (LEVELS * LEVEL_BITS);
+
+    if (delta >= range) {
+        delta = range - 1;
+        expires = self->current + delta;
+    }
+
+    uint8_t level = 0;
+
+    while ((level < LEVELS - 1) &&
+           (delta >= ((uint64_t)1 << ((level + 1) * LEVEL_BITS)))) {
+        level++;
+    }
+
+    timer->level = level;
+    timer->slot = (expires >> (level * LEVEL_BITS)) & SLOT_MASK;
+
+    list_append(&self->slots[level][timer->slot], &timer->link);
+    slot_mark(self, level, timer->slot);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void timer_unlink(dtn_timer_wheel *self, wheel_timer *timer) {
+
+    list_remove(&timer->link);
+
+    if (EXPIRED == timer->level)
+        return;
+
+    if (list_is_empty(&self->slots[timer->level][timer->slot]))
+        slot_unmark(self, timer->level, timer->slot);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void cascade(dtn_timer_wheel *self, uint8_t level, uint8_t slot) {
+
+    wheel_link pending;
+    list_init(&pending);
+    list_move(&pending, &self->slots[level][slot]);
+    slot_unmark(self, level, slot);
+
+    while (!list_is_empty(&pending)) {
+
+        wheel_link *item = pending.next;
+        list_remove(item);
+        timer_insert(self, (wheel_timer *)item);
+    }
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TIMER ALLOCATION
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static bool add_block(dtn_timer_wheel *self) {
+
+    size_t capacity = (self->num_blocks + 1) * BLOCK_SIZE;
+    if (capacity > INDEX_MASK)
+        goto error;
+
+    wheel_timer **blocks =
+        realloc(self->blocks, (self->num_blocks + 1) * sizeof(wheel_timer *));
+
+    if (!blocks)
+        goto error;
+
+    self->blocks = blocks;
+
+    wheel_timer *block = calloc(BLOCK_SIZE, sizeof(wheel_timer));
+    if (!block)
+        goto error;
+
+    self->blocks[self->num_blocks] = block;
+
+    for (size_t i = BLOCK_SIZE; i > 0; i--) {
+
+        wheel_timer *timer = &block[i - 1];
+        timer->index = self->num_blocks * BLOCK_SIZE + i - 1;
+        timer->link.next = (wheel_link *)self->unused;
+        self->unused = timer;
+    }
+
+    self->num_blocks++;
+    return true;
+error:
+    dtn_log_error("Failed to add timers to wheel");
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static wheel_timer *timer_acquire(dtn_timer_wheel *self) {
+
+    if (!self->unused && !add_block(self))
+        return NULL;
+
+    wheel_timer *timer = self->unused;
+    self->unused = (wheel_timer *)timer->link.next;
+
+    timer->link.next = NULL;
+    timer->id = (((uint32_t)timer->generation & GENERATION_MASK)
+                 << INDEX_BITS) |
+                (timer->index + 1);
+
+    self->count++;
+    return timer;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void timer_release(dtn_timer_wheel *self, wheel_timer *timer) {
+
+    timer->id = 0;
+    timer->generation++;
+    timer->data = NULL;
+    timer->callback = NULL;
+
+    timer->link.next = (wheel_link *)self->unused;
+    self->unused = timer;
+
+    self->count--;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static wheel_timer *timer_lookup(const dtn_timer_wheel *self, uint32_t id) {
+
+    uint32_t index = (id & INDEX_MASK);
+    if (0 == index)
+        return NULL;
+
+    index--;
+
+    if (index >= self->num_blocks * BLOCK_SIZE)
+        return NULL;
+
+    wheel_timer *timer = &self->blocks[index >> BLOCK_BITS][index & 0xff];
+
+    if (id != timer->id)
+        return NULL;
+
+    return timer;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_timer_wheel *dtn_timer_wheel_create(dtn_timer_wheel_config config) {
+
+    dtn_timer_wheel *self = NULL;
+
+    if (0 == config.timers)
+        config.timers = DTN_TIMER_WHEEL_DEFAULT_TIMERS;
+
+    if (config.timers > INDEX_MASK)
+        config.timers = INDEX_MASK;
+
+    self = calloc(1, sizeof(dtn_timer_wheel));
+    if (!self)
+        goto error;
+
+    self->magic_bytes = DTN_TIMER_WHEEL_MAGIC_BYTES;
+    self->config = config;
+
+    for (size_t l = 0; l < LEVELS; l++) {
+        for (size_t s = 0; s < SLOTS; s++) {
+            list_init(&self->slots[l][s]);
+        }
+    }
+
+    list_init(&self->expired);
+
+    while (self->num_blocks * BLOCK_SIZE < config.timers) {
+        if (!add_block(self))
+            goto error;
+    }
+
+    return self;
+error:
+    dtn_timer_wheel_free(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_timer_wheel *dtn_timer_wheel_cast(const void *data) {
+
+    if (!data)
+        return NULL;
+
+    if (*(uint16_t *)data != DTN_TIMER_WHEEL_MAGIC_BYTES)
+        return NULL;
+
+    return (dtn_timer_wheel *)data;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_timer_wheel *dtn_timer_wheel_free(dtn_timer_wheel *self) {
+
+    if (!dtn_timer_wheel_cast(self))
+        return self;
+
+    for (size_t i = 0; i < self->num_blocks; i++) {
+        free(self->blocks[i]);
+    }
+
+    free(self->blocks);
+    free(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint32_t dtn_timer_wheel_set(dtn_timer_wheel *self, uint64_t tick, void *data,
+                             bool (*callback)(uint32_t id, void *data)) {
+
+    if (!self || !callback)
+        return 0;
+
+    wheel_timer *timer = timer_acquire(self);
+    if (!timer)
+        return 0;
+
+    if (tick <= self->current)
+        tick = self->current + 1;
+
+    timer->expires = tick;
+    timer->data = data;
+    timer->callback = callback;
+
+    timer_insert(self, timer);
+    return timer->id;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_timer_wheel_unset(dtn_timer_wheel *self, uint32_t id,
+                           void **userdata) {
+
+    if (!self || (0 == id))
+        return false;
+
+    wheel_timer *timer = timer_lookup(self, id);
+    if (!timer)
+        return true;
+
+    if (userdata)
+        *userdata = timer->data;
+
+    timer_unlink(self, timer);
+    timer_release(self, timer);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t run_expired(dtn_timer_wheel *self) {
+
+    uint64_t expired = 0;
+
+    while (!list_is_empty(&self->expired)) {
+
+        wheel_timer *timer = (wheel_timer *)self->expired.next;
+
+        uint32_t id = timer->id;
+        void *data = timer->data;
+        bool (*callback)(uint32_t, void *) = timer->callback;
+
+        timer_unlink(self, timer);
+        timer_release(self, timer);
+
+        callback(id, data);
+        expired++;
+    }
+
+    return expired;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_timer_wheel_advance(dtn_timer_wheel *self, uint64_t tick) {
+
+    uint64_t expired = 0;
+
+    if (!self)
+        return 0;
+
+    while (self->current < tick) {
+
+        // jump over ticks without anything to do
+
+        uint64_t next = dtn_timer_wheel_next(self);
+
+        if (next > tick) {
+            self->current = tick;
+            break;
+        }
+
+        self->current = next;
+
+        for (uint8_t level = 1; level < LEVELS; level++) {
+
+            uint64_t mask = ((uint64_t)1 << (level * LEVEL_BITS)) - 1;
+            if (self->current & mask)
+                break;
+
+            cascade(self, level,
+                    (self->current >> (level * LEVEL_BITS)) & SLOT_MASK);
+        }
+
+        uint8_t slot = self->current & SLOT_MASK;
+
+        list_move(&self->expired, &self->slots[0][slot]);
+        slot_unmark(self, 0, slot);
+
+        for (wheel_link *item = self->expired.next; item != &self->expired;
+             item = item->next) {
+            ((wheel_timer *)item)->level = EXPIRED;
+        }
+
+        expired += run_expired(self);
+    }
+
+    return expired;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_timer_wheel_next(const dtn_timer_wheel *self) {
+
+    if (!self || (0 == self->count))
+        return UINT64_MAX;
+
+    uint64_t next = UINT64_MAX;
+
+    for (uint8_t level = 0; level < LEVELS; level++) {
+
+        uint64_t base = self->current >> (level * LEVEL_BITS);
+
+        int distance =
+            occupied_distance(self->occupied[level], (base + 1) & SLOT_MASK);
+
+        if (distance < 0)
+            continue;
+
+        uint64_t tick = (base + 1 + distance) << (level * LEVEL_BITS);
+
+        if (tick < next)
+            next = tick;
+    }
+
+    return next;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t dtn_timer_wheel_current(const dtn_timer_wheel *self) {
+
+    if (!self)
+        return 0;
+
+    return self->current;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t dtn_timer_wheel_count(const dtn_timer_wheel *self) {
+
+    if (!self)
+        return 0;
+
+    return self->count;
+}
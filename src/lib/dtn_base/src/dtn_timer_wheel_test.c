@@ -0,0 +1,377 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_timer_wheel_test.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "dtn_timer_wheel.c"
+#include "../include/testrun.h"
+
+/*---------------------------------------------------------------------------*/
+
+struct expiry {
+
+    dtn_timer_wheel *wheel;
+    uint64_t tick;
+    uint32_t id;
+    size_t called;
+
+    uint32_t unset; // timer to unset on expiry
+    uint64_t set;   // tick to set again on expiry, once
+};
+
+/*---------------------------------------------------------------------------*/
+
+static bool expiry_cb(uint32_t id, void *data) {
+
+    struct expiry *e = data;
+
+    e->called++;
+    e->id = id;
+    e->tick = dtn_timer_wheel_current(e->wheel);
+
+    if (e->unset)
+        dtn_timer_wheel_unset(e->wheel, e->unset, NULL);
+
+    uint64_t set = e->set;
+    e->set = 0;
+
+    if (set)
+        dtn_timer_wheel_set(e->wheel, set, e, expiry_cb);
+
+    return true;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CASES                                                      #CASES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int test_dtn_timer_wheel_create() {
+
+    dtn_timer_wheel *wheel =
+        dtn_timer_wheel_create((dtn_timer_wheel_config){0});
+
+    testrun(wheel);
+    testrun(dtn_timer_wheel_cast(wheel));
+    testrun(wheel->config.timers == DTN_TIMER_WHEEL_DEFAULT_TIMERS);
+    testrun(1 == wheel->num_blocks);
+    testrun(0 == dtn_timer_wheel_count(wheel));
+    testrun(0 == dtn_timer_wheel_current(wheel));
+    testrun(UINT64_MAX == dtn_timer_wheel_next(wheel));
+    testrun(NULL == dtn_timer_wheel_free(wheel));
+
+    wheel = dtn_timer_wheel_create((dtn_timer_wheel_config){.timers = 1000});
+    testrun(4 == wheel->num_blocks);
+    testrun(NULL == dtn_timer_wheel_free(wheel));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_timer_wheel_cast() {
+
+    uint16_t data = 0;
+
+    testrun(!dtn_timer_wheel_cast(NULL));
+    testrun(!dtn_timer_wheel_cast(&data));
+
+    data = DTN_TIMER_WHEEL_MAGIC_BYTES;
+    testrun(dtn_timer_wheel_cast(&data));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_timer_wheel_free() {
+
+    testrun(NULL == dtn_timer_wheel_free(NULL));
+
+    dtn_timer_wheel *wheel =
+        dtn_timer_wheel_create((dtn_timer_wheel_config){0});
+
+    struct expiry e = {.wheel = wheel};
+
+    for (size_t i = 1; i < 1000; i++) {
+        testrun(dtn_timer_wheel_set(wheel, i * 1000, &e, expiry_cb));
+    }
+
+    testrun(NULL == dtn_timer_wheel_free(wheel));
+    testrun(0 == e.called);
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_timer_wheel_set() {
+
+    dtn_timer_wheel *wheel =
+        dtn_timer_wheel_create((dtn_timer_wheel_config){0});
+
+    struct expiry e = {.wheel = wheel};
+
+    testrun(0 == dtn_timer_wheel_set(NULL, 1, &e, expiry_cb));
+    testrun(0 == dtn_timer_wheel_set(wheel, 1, &e, NULL));
+
+    uint32_t id = dtn_timer_wheel_set(wheel, 10, &e, expiry_cb);
+    testrun(0 != id);
+    testrun(1 == dtn_timer_wheel_count(wheel));
+    testrun(10 == dtn_timer_wheel_next(wheel));
+
+    testrun(0 == dtn_timer_wheel_advance(wheel, 9));
+    testrun(0 == e.called);
+    testrun(9 == dtn_timer_wheel_current(wheel));
+
+    testrun(1 == dtn_timer_wheel_advance(wheel, 100));
+    testrun(1 == e.called);
+    testrun(10 == e.tick);
+    testrun(id == e.id);
+    testrun(0 == dtn_timer_wheel_count(wheel));
+    testrun(100 == dtn_timer_wheel_current(wheel));
+
+    // ticks in the past expire with the next tick
+    testrun(dtn_timer_wheel_set(wheel, 5, &e, expiry_cb));
+    testrun(101 == dtn_timer_wheel_next(wheel));
+    testrun(1 == dtn_timer_wheel_advance(wheel, 101));
+    testrun(101 == e.tick);
+
+    // released timers get a new id
+    uint32_t next = dtn_timer_wheel_set(wheel, 200, &e, expiry_cb);
+    testrun(next != id);
+    testrun((next & INDEX_MASK) == (id & INDEX_MASK));
+
+    // timers grow beyond the preallocated blocks
+    for (size_t i = 0; i < 1000; i++) {
+        testrun(dtn_timer_wheel_set(wheel, 300, &e, expiry_cb));
+    }
+
+    testrun(1001 == dtn_timer_wheel_count(wheel));
+    testrun(4 == wheel->num_blocks);
+
+    e.called = 0;
+    testrun(1001 == dtn_timer_wheel_advance(wheel, 300));
+    testrun(1001 == e.called);
+
+    testrun(NULL == dtn_timer_wheel_free(wheel));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_timer_wheel_unset() {
+
+    dtn_timer_wheel *wheel =
+        dtn_timer_wheel_create((dtn_timer_wheel_config){0});
+
+    struct expiry e = {.wheel = wheel};
+    void *userdata = NULL;
+
+    uint32_t id = dtn_timer_wheel_set(wheel, 10, &e, expiry_cb);
+
+    testrun(!dtn_timer_wheel_unset(NULL, id, NULL));
+    testrun(!dtn_timer_wheel_unset(wheel, 0, NULL));
+
+    testrun(dtn_timer_wheel_unset(wheel, id, &userdata));
+    testrun(&e == userdata);
+    testrun(0 == dtn_timer_wheel_count(wheel));
+    testrun(UINT64_MAX == dtn_timer_wheel_next(wheel));
+
+    // unset again or unknown is no error
+    testrun(dtn_timer_wheel_unset(wheel, id, NULL));
+    testrun(dtn_timer_wheel_unset(wheel, 12345, NULL));
+
+    // an old id does not unset a new timer of the same slot
+    uint32_t next = dtn_timer_wheel_set(wheel, 10, &e, expiry_cb);
+    testrun(dtn_timer_wheel_unset(wheel, id, NULL));
+    testrun(1 == dtn_timer_wheel_count(wheel));
+
+    testrun(0 == dtn_timer_wheel_advance(wheel, 9));
+    testrun(1 == dtn_timer_wheel_advance(wheel, 10));
+    testrun(next == e.id);
+
+    testrun(NULL == dtn_timer_wheel_free(wheel));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_timer_wheel_advance() {
+
+    dtn_timer_wheel *wheel =
+        dtn_timer_wheel_create((dtn_timer_wheel_config){0});
+
+    // expiry on all levels and beyond the range of the wheel
+
+    uint64_t ticks[] = {1,
+                        255,
+                        256,
+                        300,
+                        65535,
+                        65536,
+                        70000,
+                        (1ull << 24) + 5,
+                        (1ull << 32) + 7,
+                        (1ull << 40)};
+
+    size_t num = sizeof(ticks) / sizeof(ticks[0]);
+
+    struct expiry e[num];
+    memset(e, 0, sizeof(e));
+
+    for (size_t i = num; i > 0; i--) {
+        e[i - 1].wheel = wheel;
+        testrun(dtn_timer_wheel_set(wheel, ticks[i - 1], &e[i - 1],
+                                    expiry_cb));
+    }
+
+    testrun(num == dtn_timer_wheel_count(wheel));
+
+    for (size_t i = 0; i < num; i++) {
+
+        testrun(ticks[i] >= dtn_timer_wheel_next(wheel));
+
+        testrun(0 == dtn_timer_wheel_advance(wheel, ticks[i] - 1));
+        testrun(0 == e[i].called);
+
+        testrun(1 == dtn_timer_wheel_advance(wheel, ticks[i]));
+        testrun(1 == e[i].called);
+        testrun(ticks[i] == e[i].tick);
+    }
+
+    testrun(0 == dtn_timer_wheel_count(wheel));
+    testrun(NULL == dtn_timer_wheel_free(wheel));
+
+    // one advance over all timers expires them in order
+
+    wheel = dtn_timer_wheel_create((dtn_timer_wheel_config){0});
+
+    memset(e, 0, sizeof(e));
+
+    for (size_t i = 0; i < num - 2; i++) {
+        e[i].wheel = wheel;
+        testrun(dtn_timer_wheel_set(wheel, ticks[i], &e[i], expiry_cb));
+    }
+
+    testrun(num - 2 == dtn_timer_wheel_advance(wheel, 1ull << 30));
+
+    for (size_t i = 0; i < num - 2; i++) {
+        testrun(1 == e[i].called);
+        testrun(ticks[i] == e[i].tick);
+    }
+
+    testrun(NULL == dtn_timer_wheel_free(wheel));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_timer_wheel_advance_modify() {
+
+    dtn_timer_wheel *wheel =
+        dtn_timer_wheel_create((dtn_timer_wheel_config){0});
+
+    struct expiry a = {.wheel = wheel};
+    struct expiry b = {.wheel = wheel};
+    struct expiry c = {.wheel = wheel};
+
+    // a unsets b of the same tick
+
+    testrun(dtn_timer_wheel_set(wheel, 100, &a, expiry_cb));
+    a.unset = dtn_timer_wheel_set(wheel, 100, &b, expiry_cb);
+
+    testrun(1 == dtn_timer_wheel_advance(wheel, 100));
+    testrun(1 == a.called);
+    testrun(0 == b.called);
+    testrun(0 == dtn_timer_wheel_count(wheel));
+
+    // a unsets c of some later tick on a higher level
+
+    a.called = 0;
+    testrun(dtn_timer_wheel_set(wheel, 200, &a, expiry_cb));
+    a.unset = dtn_timer_wheel_set(wheel, 100000, &c, expiry_cb);
+
+    testrun(1 == dtn_timer_wheel_advance(wheel, 200000));
+    testrun(1 == a.called);
+    testrun(0 == c.called);
+    testrun(0 == dtn_timer_wheel_count(wheel));
+    testrun(UINT64_MAX == dtn_timer_wheel_next(wheel));
+
+    // a timer set within a callback expires within the same advance
+
+    memset(&a, 0, sizeof(a));
+    a.wheel = wheel;
+    a.set = 200500;
+
+    testrun(dtn_timer_wheel_set(wheel, 200400, &a, expiry_cb));
+    testrun(2 == dtn_timer_wheel_advance(wheel, 200600));
+    testrun(2 == a.called);
+    testrun(200500 == a.tick);
+
+    // past ticks set within a callback expire with the next tick
+
+    a.set = 1;
+
+    testrun(dtn_timer_wheel_set(wheel, 200700, &a, expiry_cb));
+    testrun(2 == dtn_timer_wheel_advance(wheel, 200800));
+    testrun(4 == a.called);
+    testrun(200701 == a.tick);
+    testrun(0 == dtn_timer_wheel_count(wheel));
+
+    testrun(NULL == dtn_timer_wheel_free(wheel));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int all_tests() {
+
+    testrun_init();
+    testrun_test(test_dtn_timer_wheel_create);
+    testrun_test(test_dtn_timer_wheel_cast);
+    testrun_test(test_dtn_timer_wheel_free);
+    testrun_test(test_dtn_timer_wheel_set);
+    testrun_test(test_dtn_timer_wheel_unset);
+    testrun_test(test_dtn_timer_wheel_advance);
+    testrun_test(test_dtn_timer_wheel_advance_modify);
+
+    return testrun_counter;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST EXECUTION                                                  #EXEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+testrun_run(all_tests);
@@ -91,7 +91,7 @@ static void *impl_vector_list_next(dtn_list *self, void *iter, void **element);
  *                              PUBLIC FUNCTIONS
  ******************************************************************************/
 
-dtn_list *dtn_vector_list_create(dtn_list_config config) {
+static dtn_list *vector_list_create(dtn_list_config config, size_t size) {
 
     dtn_list_default_implementations default_implementations =
         dtn_list_get_default_implementations();
@@ -122,11 +122,11 @@ dtn_list *dtn_vector_list_create(dtn_list_config config) {
             },
 
         .config.shrink = false,
-        .config.rate = VECTOR_DEFAULT_SIZE,
+        .config.rate = size,
         .last = 0,
-        .size = VECTOR_DEFAULT_SIZE,
+        .size = size,
 
-        .items = calloc(VECTOR_DEFAULT_SIZE, sizeof(void *)),
+        .items = calloc(size, sizeof(void *)),
 
     };
 
@@ -135,6 +135,25 @@ dtn_list *dtn_vector_list_create(dtn_list_config config) {
 
 /*----------------------------------------------------------------------------*/
 
+dtn_list *dtn_vector_list_create(dtn_list_config config) {
+
+    return vector_list_create(config, VECTOR_DEFAULT_SIZE);
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_list *dtn_vector_list_create_sized(dtn_list_config config, size_t items) {
+
+    // growth by a rate of 1 is not supported by push
+    if (items < 2)
+        items = 2;
+
+    // slot 0 is never used
+    return vector_list_create(config, items + 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
 bool dtn_vector_list_set_shrink(dtn_list *self, bool shrink) {
 
     VectorList *list = AS_VECTOR_LIST(self);
@@ -93,6 +93,45 @@ int test_dtn_vector_list_create() {
 
 /*----------------------------------------------------------------------------*/
 
+int test_dtn_vector_list_create_sized() {
+
+    dtn_list *list = dtn_vector_list_create_sized((dtn_list_config){0}, 3);
+    VectorList *vector = AS_VECTOR_LIST(list);
+
+    testrun(list);
+    testrun(vector);
+    testrun(vector->config.rate == 4);
+    testrun(vector->size == 4);
+    testrun(vector->last == 0);
+
+    for (intptr_t i = 1; i <= 10; i++) {
+        testrun(list->push(list, (void *)i));
+    }
+
+    testrun(10 == list->count(list));
+    for (intptr_t i = 1; i <= 10; i++) {
+        testrun((void *)i == list->get(list, i));
+    }
+
+    list = list->free(list);
+
+    // minimum size
+    list = dtn_vector_list_create_sized((dtn_list_config){0}, 0);
+    vector = AS_VECTOR_LIST(list);
+    testrun(vector->size == 3);
+    testrun(vector->config.rate == 3);
+
+    for (intptr_t i = 1; i <= 10; i++) {
+        testrun(list->push(list, (void *)i));
+    }
+    testrun(10 == list->count(list));
+
+    list = list->free(list);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
 int test_dtn_vector_list_set_shrink() {
 
     dtn_list *list = dtn_linked_list_create((dtn_list_config){0});
@@ -338,6 +377,7 @@ int all_tests() {
 
     testrun_init();
 
+    testrun_test(test_dtn_vector_list_create_sized);
     testrun_test(test_dtn_vector_list_set_shrink);
     testrun_test(test_dtn_vector_list_set_rate);
 
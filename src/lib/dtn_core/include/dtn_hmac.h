@@ -46,4 +46,54 @@ bool dtn_hmac(dtn_hash_function type, const uint8_t *buffer, size_t size,
               const void *key, size_t key_len, uint8_t *result,
               size_t *result_len);
 
+/*----------------------------------------------------------------------------*/
+
+/**
+        Incremental HMAC of input fed in pieces. The result is the same
+        as dtn_hmac over the concatenated pieces.
+*/
+typedef struct dtn_hmac_context dtn_hmac_context;
+
+dtn_hmac_context *dtn_hmac_context_create(dtn_hash_function type,
+                                          const void *key, size_t key_len);
+
+dtn_hmac_context *dtn_hmac_context_free(dtn_hmac_context *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Copy a context including its prepared key. Copying a context with
+        a prepared key is cheaper than a key setup for long keys. Concurrent
+        copies of a context not used otherwise are safe.
+*/
+dtn_hmac_context *dtn_hmac_context_copy(const dtn_hmac_context *self);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Restart the context for a new HMAC with the hash function of
+        create. Contexts are meant to be reused, as setting up a context
+        costs more than the HMAC of small input.
+
+        @param key              new key or NULL to keep the current key
+*/
+bool dtn_hmac_context_reset(dtn_hmac_context *self, const void *key,
+                            size_t key_len);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_hmac_update(dtn_hmac_context *self, const uint8_t *buffer,
+                     size_t size);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Write the HMAC to result. The context MUST NOT be updated after
+        final.
+
+        @param result_len       size of result, set to the HMAC size
+*/
+bool dtn_hmac_final(dtn_hmac_context *self, uint8_t *result,
+                    size_t *result_len);
+
 #endif /* dtn_hmac_h */
@@ -25,6 +25,12 @@
 
         @date           2026-01-03
 
+        Keys are read without lock. Each change publishes a new snapshot
+        of all keys, readers use the snapshot they started with. A
+        snapshot is freed once no reader of it is left.
+
+        Keys are immutable and shared by reference. The HMAC key setup of
+        a key is done once when it is set.
 
         ------------------------------------------------------------------------
 */
@@ -37,6 +43,8 @@
 
 #include <dtn_base/dtn_buffer.h>
 
+#include "dtn_hmac.h"
+
 /*----------------------------------------------------------------------------*/
 
 #define DTN_DEFAULT_KEY_PATH "/etc/opendtn/keys"
@@ -44,6 +52,7 @@
 /*----------------------------------------------------------------------------*/
 
 typedef struct dtn_key_store dtn_key_store;
+typedef struct dtn_key dtn_key;
 
 /*----------------------------------------------------------------------------*/
 
@@ -102,6 +111,16 @@ dtn_buffer *dtn_key_store_get(dtn_key_store *self, const char *destination);
 
 /*----------------------------------------------------------------------------*/
 
+/**
+ *  Get a reference to the key for some destination, without lock and
+ *  without copy.
+ *
+ *  @returns key to be released by the caller with dtn_key_release
+ */
+dtn_key *dtn_key_store_acquire(dtn_key_store *self, const char *destination);
+
+/*----------------------------------------------------------------------------*/
+
 /**
  *  Set a key for some destination of form:
  *      reg_name/node_name
@@ -113,4 +132,31 @@ dtn_buffer *dtn_key_store_get(dtn_key_store *self, const char *destination);
 bool dtn_key_store_set(dtn_key_store *self, const char *destination,
                        dtn_buffer *key);
 
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      KEY FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_key *dtn_key_acquire(dtn_key *key);
+dtn_key *dtn_key_release(dtn_key *key);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Key data, valid as long as the key is referenced. MUST NOT be changed.
+ */
+const dtn_buffer *dtn_key_get_buffer(const dtn_key *key);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Create an HMAC context with the key, copied from the context prepared
+ *  for the key. Falls back to a key setup if there is none.
+ */
+dtn_hmac_context *dtn_key_hmac_create(const dtn_key *key,
+                                      dtn_hash_function type);
+
 #endif /* dtn_key_store_h */
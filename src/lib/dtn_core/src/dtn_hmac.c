@@ -33,7 +33,9 @@
 */
 #include "../include/dtn_hmac.h"
 
+#include <openssl/core_names.h>
 #include <openssl/hmac.h>
+#include <pthread.h>
 #include <string.h>
 
 /*----------------------------------------------------------------------------*/
@@ -58,3 +60,149 @@ bool dtn_hmac(dtn_hash_function type, const uint8_t *buffer, size_t size,
 error:
     return false;
 }
+
+/*----------------------------------------------------------------------------*/
+
+struct dtn_hmac_context {
+
+    EVP_MAC_CTX *ctx;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/* The HMAC implementation is fetched once and shared by all contexts. */
+
+static EVP_MAC *g_mac = NULL;
+static pthread_once_t g_mac_once = PTHREAD_ONCE_INIT;
+
+/*----------------------------------------------------------------------------*/
+
+static void mac_fetch() {
+
+    g_mac = EVP_MAC_fetch(NULL, OSSL_MAC_NAME_HMAC, NULL);
+    return;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_hmac_context *dtn_hmac_context_create(dtn_hash_function type,
+                                          const void *key, size_t key_len) {
+
+    dtn_hmac_context *self = NULL;
+
+    if (!key)
+        goto error;
+
+    const EVP_MD *hash_func = dtn_hash_function_to_EVP(type);
+    if (!hash_func)
+        goto error;
+
+    pthread_once(&g_mac_once, mac_fetch);
+    if (!g_mac)
+        goto error;
+
+    self = calloc(1, sizeof(dtn_hmac_context));
+    if (!self)
+        goto error;
+
+    self->ctx = EVP_MAC_CTX_new(g_mac);
+    if (!self->ctx)
+        goto error;
+
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(
+            OSSL_MAC_PARAM_DIGEST, (char *)EVP_MD_get0_name(hash_func), 0),
+        OSSL_PARAM_construct_end()};
+
+    if (1 != EVP_MAC_init(self->ctx, key, key_len, params))
+        goto error;
+
+    return self;
+
+error:
+    return dtn_hmac_context_free(self);
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_hmac_context *dtn_hmac_context_free(dtn_hmac_context *self) {
+
+    if (!self)
+        return NULL;
+
+    EVP_MAC_CTX_free(self->ctx);
+    free(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_hmac_context *dtn_hmac_context_copy(const dtn_hmac_context *self) {
+
+    dtn_hmac_context *copy = NULL;
+
+    if (!self)
+        goto error;
+
+    copy = calloc(1, sizeof(dtn_hmac_context));
+    if (!copy)
+        goto error;
+
+    copy->ctx = EVP_MAC_CTX_dup(self->ctx);
+    if (!copy->ctx)
+        goto error;
+
+    return copy;
+error:
+    return dtn_hmac_context_free(copy);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_hmac_context_reset(dtn_hmac_context *self, const void *key,
+                            size_t key_len) {
+
+    if (!self)
+        return false;
+
+    // a NULL key restarts with the prepared state of the previous key
+
+    return 1 == EVP_MAC_init(self->ctx, key, key ? key_len : 0, NULL);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_hmac_update(dtn_hmac_context *self, const uint8_t *buffer,
+                     size_t size) {
+
+    if (!self || (!buffer && size > 0))
+        return false;
+
+    if (0 == size)
+        return true;
+
+    return 1 == EVP_MAC_update(self->ctx, buffer, size);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_hmac_final(dtn_hmac_context *self, uint8_t *result,
+                    size_t *result_len) {
+
+    size_t length = 0;
+
+    if (!self || !result || !result_len)
+        goto error;
+
+    if (*result_len < EVP_MAC_CTX_get_mac_size(self->ctx))
+        goto error;
+
+    if (1 != EVP_MAC_final(self->ctx, result, &length, *result_len))
+        goto error;
+
+    *result_len = length;
+    return true;
+
+error:
+    return false;
+}
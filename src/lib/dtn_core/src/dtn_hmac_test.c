@@ -42,14 +42,184 @@
  *      ------------------------------------------------------------------------
  */
 
-/*
-int test_dtn_hmac(){
+int test_dtn_hmac() {
+
+    // RFC 4231 test case 2
+    const char *key = "Jefe";
+    const char *data = "what do ya want for nothing?";
+
+    uint8_t expect[] = {0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e,
+                        0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+                        0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83,
+                        0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43};
+
+    uint8_t result[DTN_SHA512_SIZE] = {0};
+    size_t size = sizeof(result);
+
+    testrun(!dtn_hmac(DTN_HASH_SHA256, NULL, 0, key, 4, result, &size));
+    testrun(!dtn_hmac(DTN_HASH_SHA256, (uint8_t *)data, strlen(data), NULL, 4,
+                      result, &size));
 
-        testrun_log("... to be implemented");
+    testrun(dtn_hmac(DTN_HASH_SHA256, (uint8_t *)data, strlen(data), key, 4,
+                     result, &size));
+    testrun(DTN_SHA256_SIZE == size);
+    testrun(0 == memcmp(result, expect, size));
 
-        return testrun_log_success();
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_hmac_context() {
+
+    uint8_t data[1000] = {0};
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+
+    uint8_t key[32] = {1, 2, 3};
+    uint8_t expect[DTN_SHA512_SIZE] = {0};
+    uint8_t result[DTN_SHA512_SIZE] = {0};
+    size_t expect_size = 0;
+    size_t size = 0;
+
+    testrun(!dtn_hmac_context_create(DTN_HASH_UNSPEC, key, sizeof(key)));
+    testrun(!dtn_hmac_context_create(DTN_HASH_SHA256, NULL, sizeof(key)));
+
+    dtn_hash_function functions[] = {DTN_HASH_SHA256, DTN_HASH_SHA384,
+                                     DTN_HASH_SHA512};
+
+    for (size_t f = 0; f < 3; f++) {
+
+        expect_size = sizeof(expect);
+        testrun(dtn_hmac(functions[f], data, sizeof(data), key, sizeof(key),
+                         expect, &expect_size));
+
+        // any split of the input gives the same HMAC
+        for (size_t split = 0; split <= sizeof(data); split += 111) {
+
+            dtn_hmac_context *ctx =
+                dtn_hmac_context_create(functions[f], key, sizeof(key));
+            testrun(ctx);
+
+            testrun(!dtn_hmac_update(NULL, data, split));
+            testrun(!dtn_hmac_update(ctx, NULL, 1));
+            testrun(dtn_hmac_update(ctx, NULL, 0));
+            testrun(dtn_hmac_update(ctx, data, split));
+            testrun(dtn_hmac_update(ctx, data + split, sizeof(data) - split));
+
+            size = expect_size - 1;
+            testrun(!dtn_hmac_final(ctx, result, &size));
+
+            size = sizeof(result);
+            testrun(dtn_hmac_final(ctx, result, &size));
+            testrun(size == expect_size);
+            testrun(0 == memcmp(result, expect, size));
+
+            testrun(NULL == dtn_hmac_context_free(ctx));
+        }
+    }
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_hmac_context_copy() {
+
+    uint8_t data[100] = {0};
+    uint8_t key[200] = {1, 2, 3};
+    uint8_t expect[DTN_SHA384_SIZE] = {0};
+    uint8_t result[DTN_SHA384_SIZE] = {0};
+    size_t size = sizeof(expect);
+
+    testrun(dtn_hmac(DTN_HASH_SHA384, data, sizeof(data), key, sizeof(key),
+                     expect, &size));
+
+    dtn_hmac_context *prepared =
+        dtn_hmac_context_create(DTN_HASH_SHA384, key, sizeof(key));
+    testrun(prepared);
+
+    testrun(!dtn_hmac_context_copy(NULL));
+
+    // copies keep the key of the original, which stays unchanged
+    for (size_t i = 0; i < 2; i++) {
+
+        dtn_hmac_context *copy = dtn_hmac_context_copy(prepared);
+        testrun(copy);
+        testrun(dtn_hmac_update(copy, data, sizeof(data)));
+
+        size = sizeof(result);
+        testrun(dtn_hmac_final(copy, result, &size));
+        testrun(0 == memcmp(result, expect, sizeof(expect)));
+        testrun(NULL == dtn_hmac_context_free(copy));
+    }
+
+    testrun(dtn_hmac_update(prepared, data, sizeof(data)));
+    size = sizeof(result);
+    testrun(dtn_hmac_final(prepared, result, &size));
+    testrun(0 == memcmp(result, expect, sizeof(expect)));
+
+    testrun(NULL == dtn_hmac_context_free(prepared));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_hmac_context_reset() {
+
+    uint8_t data[100] = {0};
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+
+    uint8_t key[32] = {1, 2, 3};
+    uint8_t other[20] = {4, 5, 6};
+    uint8_t expect[DTN_SHA256_SIZE] = {0};
+    uint8_t expect_other[DTN_SHA256_SIZE] = {0};
+    uint8_t result[DTN_SHA256_SIZE] = {0};
+    size_t size = sizeof(expect);
+
+    testrun(dtn_hmac(DTN_HASH_SHA256, data, sizeof(data), key, sizeof(key),
+                     expect, &size));
+    size = sizeof(expect_other);
+    testrun(dtn_hmac(DTN_HASH_SHA256, data, sizeof(data), other,
+                     sizeof(other), expect_other, &size));
+
+    dtn_hmac_context *ctx =
+        dtn_hmac_context_create(DTN_HASH_SHA256, key, sizeof(key));
+    testrun(ctx);
+
+    testrun(!dtn_hmac_context_reset(NULL, key, sizeof(key)));
+
+    // reset after final, with and without an update before
+    for (size_t i = 0; i < 3; i++) {
+
+        testrun(dtn_hmac_update(ctx, data, sizeof(data)));
+        size = sizeof(result);
+        testrun(dtn_hmac_final(ctx, result, &size));
+        testrun(0 == memcmp(result, expect, sizeof(expect)));
+
+        testrun(dtn_hmac_context_reset(ctx, NULL, 0));
+    }
+
+    testrun(dtn_hmac_update(ctx, data, 10));
+    testrun(dtn_hmac_context_reset(ctx, NULL, 0));
+    testrun(dtn_hmac_update(ctx, data, sizeof(data)));
+    size = sizeof(result);
+    testrun(dtn_hmac_final(ctx, result, &size));
+    testrun(0 == memcmp(result, expect, sizeof(expect)));
+
+    // new key
+    testrun(dtn_hmac_context_reset(ctx, other, sizeof(other)));
+    testrun(dtn_hmac_update(ctx, data, sizeof(data)));
+    size = sizeof(result);
+    testrun(dtn_hmac_final(ctx, result, &size));
+    testrun(0 == memcmp(result, expect_other, sizeof(expect_other)));
+
+    testrun(NULL == dtn_hmac_context_free(ctx));
+    return testrun_log_success();
 }
-*/
 
 /*----------------------------------------------------------------------------*/
 
@@ -64,9 +234,11 @@ int test_dtn_hmac(){
 int all_tests() {
 
     testrun_init();
-    // testrun_test(test_dtn_hmac);
+    testrun_test(test_dtn_hmac);
+    testrun_test(test_dtn_hmac_context);
+    testrun_test(test_dtn_hmac_context_copy);
+    testrun_test(test_dtn_hmac_context_reset);
 
-    testrun(0 == result);
     return testrun_counter;
 }
 
@@ -34,22 +34,131 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <libgen.h>
+#include <stdatomic.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 #include <dtn_base/dtn_dict.h>
+#include <dtn_base/dtn_epoch.h>
 #include <dtn_base/dtn_file.h>
 #include <dtn_base/dtn_string.h>
 #include <dtn_base/dtn_thread_lock.h>
 
+#include <openssl/crypto.h>
+
+#define HMAC_FUNCTIONS 3
+
+static const dtn_hash_function hmac_functions[HMAC_FUNCTIONS] = {
+    DTN_HASH_SHA256, DTN_HASH_SHA384, DTN_HASH_SHA512};
+
+/*----------------------------------------------------------------------------*/
+
+struct dtn_key {
+
+    atomic_uint_fast64_t refs;
+
+    dtn_buffer *buffer;
+
+    // prepared with the key, only copied
+    dtn_hmac_context *hmac[HMAC_FUNCTIONS];
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ *      data is the current snapshot of all keys and is never changed once
+ *      published by dtn_epoch. Writers are serialized by lock, copy the
+ *      snapshot, change the copy and publish it.
+ */
 struct dtn_key_store {
 
     dtn_key_store_config config;
 
     dtn_thread_lock lock;
-    dtn_dict *data;
+    dtn_epoch data;
 };
 
+/*----------------------------------------------------------------------------*/
+
+static dtn_key *key_create(dtn_buffer *buffer) {
+
+    dtn_key *self = calloc(1, sizeof(dtn_key));
+    if (!self)
+        return NULL;
+
+    atomic_init(&self->refs, 1);
+    self->buffer = buffer;
+
+    // a failed preparation falls back to the key setup on use
+
+    for (size_t i = 0; i < HMAC_FUNCTIONS; i++) {
+
+        if (buffer->start && (0 < buffer->length))
+            self->hmac[i] = dtn_hmac_context_create(
+                hmac_functions[i], buffer->start, buffer->length);
+    }
+
+    return self;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *key_free(void *key) {
+
+    dtn_key_release((dtn_key *)key);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_dict *data_create() {
+
+    dtn_dict_config d_config = dtn_dict_string_key_config(255);
+    d_config.value.data_function.free = key_free;
+
+    return dtn_dict_create(d_config);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool copy_key(const void *key, void *val, void *data) {
+
+    if (!key)
+        return true;
+
+    char *name = dtn_string_dup(key);
+
+    if (name && dtn_dict_set((dtn_dict *)data, name, dtn_key_acquire(val),
+                             NULL))
+        return true;
+
+    dtn_data_pointer_free(name);
+    dtn_key_release(val);
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ *      Copy of the current snapshot, to be changed and published.
+ *      MUST be called with the lock held.
+ */
+static dtn_dict *data_copy(dtn_key_store *self) {
+
+    dtn_dict *copy = data_create();
+    if (!copy)
+        goto error;
+
+    if (!dtn_dict_for_each(dtn_epoch_data(&self->data), copy, copy_key))
+        goto error;
+
+    return copy;
+error:
+    return dtn_dict_free(copy);
+}
+
+/*----------------------------------------------------------------------------*/
+
 static bool init_config(dtn_key_store_config *config) {
 
     if (!config)
@@ -87,11 +196,8 @@ dtn_key_store *dtn_key_store_create(dtn_key_store_config config) {
 
     self->config = config;
 
-    dtn_dict_config d_config = dtn_dict_string_key_config(255);
-    d_config.value.data_function.free = dtn_buffer_free;
-
-    self->data = dtn_dict_create(d_config);
-    if (!self->data)
+    dtn_epoch_init(&self->data, data_create(), dtn_dict_free);
+    if (!dtn_epoch_data(&self->data))
         goto error;
 
     if (!dtn_thread_lock_init(&self->lock,
@@ -112,7 +218,7 @@ dtn_key_store *dtn_key_store_free(dtn_key_store *self) {
         return NULL;
 
     dtn_thread_lock_clear(&self->lock);
-    self->data = dtn_dict_free(self->data);
+    dtn_epoch_clear(&self->data);
 
     self = dtn_data_pointer_free(self);
     return NULL;
@@ -126,14 +232,15 @@ dtn_key_store *dtn_key_store_free(dtn_key_store *self) {
  *      ------------------------------------------------------------------------
  */
 
-static bool add_file_key(dtn_key_store *self, const char *filepath,
+static bool add_file_key(dtn_dict *data, const char *filepath,
                          const char *filename) {
 
     uint8_t *buf = NULL;
     dtn_buffer *buffer = NULL;
+    dtn_key *handle = NULL;
     char *key = NULL;
 
-    if (!self || !filename || !filepath)
+    if (!data || !filename || !filepath)
         goto error;
 
     size_t len = 0;
@@ -145,9 +252,14 @@ static bool add_file_key(dtn_key_store *self, const char *filepath,
     if (!dtn_buffer_push(buffer, buf, len))
         goto error;
 
+    handle = key_create(buffer);
+    if (!handle)
+        goto error;
+
+    buffer = NULL;
     key = dtn_string_dup(filename);
 
-    if (!dtn_dict_set(self->data, key, buffer, NULL))
+    if (!dtn_dict_set(data, key, handle, NULL))
         goto error;
 
     dtn_log_debug("loaded key for %s", filename);
@@ -158,14 +270,15 @@ error:
     buf = dtn_data_pointer_free(buf);
     key = dtn_data_pointer_free(key);
     buffer = dtn_buffer_free(buffer);
+    handle = dtn_key_release(handle);
     return false;
 }
 
 /*----------------------------------------------------------------------------*/
 
-static bool read_sub_dir(dtn_key_store *self, const char *path) {
+static bool read_sub_dir(dtn_dict *data, const char *path) {
 
-    if (!self || !path)
+    if (!data || !path)
         goto error;
 
     errno = 0;
@@ -226,7 +339,7 @@ static bool read_sub_dir(dtn_key_store *self, const char *path) {
 
         snprintf(name, PATH_MAX, "%s/%s", basename((char *)path), ep->d_name);
 
-        if (!add_file_key(self, filename, name))
+        if (!add_file_key(data, filename, name))
             goto error;
     }
 
@@ -241,7 +354,7 @@ error:
 
 /*----------------------------------------------------------------------------*/
 
-static bool read_dir(dtn_key_store *self, const char *path) {
+static bool read_dir(dtn_dict *data, const char *path) {
 
     errno = 0;
 
@@ -291,7 +404,7 @@ static bool read_dir(dtn_key_store *self, const char *path) {
 
         if (S_ISDIR(st.st_mode)) {
 
-            read_sub_dir(self, filename);
+            read_sub_dir(data, filename);
 
         } else {
 
@@ -307,7 +420,7 @@ static bool read_dir(dtn_key_store *self, const char *path) {
             if (i != 0)
                 continue;
 
-            if (!add_file_key(self, filename, ep->d_name))
+            if (!add_file_key(data, filename, ep->d_name))
                 goto error;
         }
     }
@@ -335,7 +448,15 @@ bool dtn_key_store_load(dtn_key_store *self, const char *optional_path) {
     if (!dtn_thread_lock_try_lock(&self->lock))
         goto error;
 
-    bool result = read_dir(self, path);
+    // keys read before a failure are kept
+
+    bool result = false;
+    dtn_dict *data = data_copy(self);
+
+    if (data) {
+        result = read_dir(data, path);
+        dtn_epoch_publish(&self->data, data);
+    }
 
     if (!dtn_thread_lock_unlock(&self->lock)) {
 
@@ -363,7 +484,7 @@ static bool write_file(const void *key, void *val, void *data) {
         return true;
 
     const char *name = (const char *)key;
-    dtn_buffer *buffer = dtn_buffer_cast(val);
+    const dtn_buffer *buffer = ((dtn_key *)val)->buffer;
     struct container *container = (struct container *)data;
 
     char path[PATH_MAX] = {0};
@@ -385,7 +506,8 @@ static bool write_dir(dtn_key_store *self, const char *path) {
 
     struct container container = (struct container){.self = self, .path = path};
 
-    return dtn_dict_for_each(self->data, &container, write_file);
+    return dtn_dict_for_each(dtn_epoch_data(&self->data), &container,
+                             write_file);
 
 error:
     return false;
@@ -429,26 +551,29 @@ dtn_buffer *dtn_key_store_get(dtn_key_store *self, const char *destination) {
 
     dtn_buffer *out = NULL;
 
-    if (!self || !destination)
-        goto error;
+    dtn_key *key = dtn_key_store_acquire(self, destination);
+    if (!key)
+        return NULL;
 
-    if (!dtn_thread_lock_try_lock(&self->lock))
-        goto error;
+    dtn_buffer_copy((void **)&out, key->buffer);
+    dtn_key_release(key);
+    return out;
+}
 
-    dtn_buffer *data = dtn_dict_get(self->data, destination);
+/*----------------------------------------------------------------------------*/
 
-    if (data)
-        dtn_buffer_copy((void **)&out, data);
+dtn_key *dtn_key_store_acquire(dtn_key_store *self, const char *destination) {
 
-    if (!dtn_thread_lock_unlock(&self->lock)) {
+    if (!self || !destination)
+        return NULL;
 
-        dtn_log_error("failed to unlock keystore");
-    }
+    uint64_t epoch = dtn_epoch_enter(&self->data);
 
-    return out;
+    dtn_key *key = dtn_key_acquire(
+        dtn_dict_get(dtn_epoch_data(&self->data), destination));
 
-error:
-    return NULL;
+    dtn_epoch_leave(&self->data, epoch);
+    return key;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -456,24 +581,114 @@ error:
 bool dtn_key_store_set(dtn_key_store *self, const char *destination,
                        dtn_buffer *key) {
 
+    char *name = NULL;
+    dtn_key *handle = NULL;
+    dtn_dict *data = NULL;
+
     if (!self || !destination || !key)
         goto error;
 
+    handle = key_create(key);
+    if (!handle)
+        goto error;
+
+    key = NULL;
+
     if (!dtn_thread_lock_try_lock(&self->lock))
         goto error;
 
-    char *k = dtn_string_dup(destination);
-    bool result = dtn_dict_set(self->data, k, key, NULL);
+    bool result = false;
+
+    name = dtn_string_dup(destination);
+    data = data_copy(self);
+
+    if (name && data && dtn_dict_set(data, name, handle, NULL)) {
+
+        name = NULL;
+        handle = NULL;
+
+        dtn_epoch_publish(&self->data, data);
+        data = NULL;
+        result = true;
+    }
 
     if (!dtn_thread_lock_unlock(&self->lock)) {
 
         dtn_log_error("failed to unlock keystore");
     }
 
-    if (!result)
-        k = dtn_data_pointer_free(k);
-
+    name = dtn_data_pointer_free(name);
+    handle = dtn_key_release(handle);
+    data = dtn_dict_free(data);
     return result;
 error:
+    handle = dtn_key_release(handle);
     return false;
-}
\ No newline at end of file
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      KEY FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_key *dtn_key_acquire(dtn_key *key) {
+
+    if (key)
+        atomic_fetch_add(&key->refs, 1);
+
+    return key;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_key *dtn_key_release(dtn_key *key) {
+
+    if (!key)
+        return NULL;
+
+    if (1 != atomic_fetch_sub(&key->refs, 1))
+        return NULL;
+
+    for (size_t i = 0; i < HMAC_FUNCTIONS; i++) {
+        key->hmac[i] = dtn_hmac_context_free(key->hmac[i]);
+    }
+
+    if (key->buffer && (0 < key->buffer->capacity))
+        OPENSSL_cleanse(key->buffer->start, key->buffer->capacity);
+
+    key->buffer = dtn_buffer_free(key->buffer);
+
+    key = dtn_data_pointer_free(key);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+const dtn_buffer *dtn_key_get_buffer(const dtn_key *key) {
+
+    if (!key)
+        return NULL;
+
+    return key->buffer;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_hmac_context *dtn_key_hmac_create(const dtn_key *key,
+                                      dtn_hash_function type) {
+
+    if (!key)
+        return NULL;
+
+    for (size_t i = 0; i < HMAC_FUNCTIONS; i++) {
+
+        if ((hmac_functions[i] == type) && key->hmac[i])
+            return dtn_hmac_context_copy(key->hmac[i]);
+    }
+
+    return dtn_hmac_context_create(type, key->buffer->start,
+                                   key->buffer->length);
+}
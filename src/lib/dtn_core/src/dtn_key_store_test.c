@@ -30,6 +30,8 @@
 #include "dtn_key_store.c"
 #include <dtn_base/testrun.h>
 
+#include <pthread.h>
+
 #ifndef DTN_TEST_RESOURCE_DIR
 #error "Must provide -D DTN_TEST_RESOURCE_DIR=value while compiling this file."
 #endif
@@ -49,7 +51,7 @@ int test_dtn_key_store_create() {
 
     dtn_key_store *store = dtn_key_store_create(config);
     testrun(store);
-    testrun(store->data);
+    testrun(dtn_epoch_data(&store->data));
 
     testrun(NULL == dtn_key_store_free(store));
 
@@ -65,12 +67,12 @@ int test_dtn_key_store_free() {
 
     dtn_key_store *store = dtn_key_store_create(config);
     testrun(store);
-    testrun(store->data);
+    testrun(dtn_epoch_data(&store->data));
 
     dtn_log_debug("%s", store->config.path);
 
     testrun(dtn_key_store_load(store, NULL));
-    testrun(3 == dtn_dict_count(store->data));
+    testrun(3 == dtn_dict_count(dtn_epoch_data(&store->data)));
 
     testrun(NULL == dtn_key_store_free(store));
 
@@ -86,13 +88,13 @@ int test_dtn_key_store_load() {
 
     dtn_key_store *store = dtn_key_store_create(config);
     testrun(store);
-    testrun(store->data);
+    testrun(dtn_epoch_data(&store->data));
 
     testrun(dtn_key_store_load(store, NULL));
-    testrun(3 == dtn_dict_count(store->data));
-    testrun(dtn_dict_get(store->data, "aes128"));
-    testrun(dtn_dict_get(store->data, "aes192"));
-    testrun(dtn_dict_get(store->data, "aes256"));
+    testrun(3 == dtn_dict_count(dtn_epoch_data(&store->data)));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes128"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes192"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes256"));
 
     testrun(NULL == dtn_key_store_free(store));
 
@@ -108,13 +110,13 @@ int test_dtn_key_store_save() {
 
     dtn_key_store *store = dtn_key_store_create(config);
     testrun(store);
-    testrun(store->data);
+    testrun(dtn_epoch_data(&store->data));
 
     testrun(dtn_key_store_load(store, NULL));
-    testrun(3 == dtn_dict_count(store->data));
-    testrun(dtn_dict_get(store->data, "aes128"));
-    testrun(dtn_dict_get(store->data, "aes192"));
-    testrun(dtn_dict_get(store->data, "aes256"));
+    testrun(3 == dtn_dict_count(dtn_epoch_data(&store->data)));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes128"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes192"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes256"));
 
     testrun(dtn_key_store_save(store, NULL));
 
@@ -132,13 +134,13 @@ int test_dtn_key_store_get() {
 
     dtn_key_store *store = dtn_key_store_create(config);
     testrun(store);
-    testrun(store->data);
+    testrun(dtn_epoch_data(&store->data));
 
     testrun(dtn_key_store_load(store, NULL));
-    testrun(3 == dtn_dict_count(store->data));
-    testrun(dtn_dict_get(store->data, "aes128"));
-    testrun(dtn_dict_get(store->data, "aes192"));
-    testrun(dtn_dict_get(store->data, "aes256"));
+    testrun(3 == dtn_dict_count(dtn_epoch_data(&store->data)));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes128"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes192"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes256"));
 
     dtn_buffer *buffer = dtn_key_store_get(store, "aes128");
     testrun(buffer);
@@ -159,27 +161,208 @@ int test_dtn_key_store_set() {
 
     dtn_key_store *store = dtn_key_store_create(config);
     testrun(store);
-    testrun(store->data);
+    testrun(dtn_epoch_data(&store->data));
 
     testrun(dtn_key_store_load(store, NULL));
-    testrun(3 == dtn_dict_count(store->data));
-    testrun(dtn_dict_get(store->data, "aes128"));
-    testrun(dtn_dict_get(store->data, "aes192"));
-    testrun(dtn_dict_get(store->data, "aes256"));
+    testrun(3 == dtn_dict_count(dtn_epoch_data(&store->data)));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes128"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes192"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes256"));
 
     dtn_buffer *buffer = dtn_key_store_get(store, "aes128");
     testrun(buffer);
     testrun(buffer->length == 128);
 
     testrun(dtn_key_store_set(store, "test", buffer));
-    testrun(4 == dtn_dict_count(store->data));
-    testrun(dtn_dict_get(store->data, "aes128"));
-    testrun(dtn_dict_get(store->data, "aes192"));
-    testrun(dtn_dict_get(store->data, "aes256"));
-    testrun(dtn_dict_get(store->data, "test"));
+    testrun(4 == dtn_dict_count(dtn_epoch_data(&store->data)));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes128"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes192"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "aes256"));
+    testrun(dtn_dict_get(dtn_epoch_data(&store->data), "test"));
+
+    testrun(NULL == dtn_key_store_free(store));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_buffer *test_key(uint8_t fill, size_t size) {
+
+    dtn_buffer *buffer = dtn_buffer_create(size);
+    memset(buffer->start, fill, size);
+    buffer->length = size;
+    return buffer;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_key_store_acquire() {
+
+    dtn_key_store *store = dtn_key_store_create((dtn_key_store_config){0});
+    testrun(store);
+
+    testrun(!dtn_key_store_acquire(NULL, "test"));
+    testrun(!dtn_key_store_acquire(store, NULL));
+    testrun(!dtn_key_store_acquire(store, "test"));
+
+    testrun(dtn_key_store_set(store, "test", test_key(1, 32)));
+
+    dtn_key *key = dtn_key_store_acquire(store, "test");
+    testrun(key);
+    testrun(2 == atomic_load(&key->refs));
+    testrun(dtn_key_get_buffer(key)->length == 32);
+    testrun(dtn_key_get_buffer(key)->start[31] == 1);
+
+    testrun(key == dtn_key_store_acquire(store, "test"));
+    testrun(3 == atomic_load(&key->refs));
+    testrun(NULL == dtn_key_release(key));
+
+    // a replaced key stays valid while referenced
+
+    testrun(dtn_key_store_set(store, "test", test_key(2, 64)));
+    testrun(1 == atomic_load(&key->refs));
+    testrun(dtn_key_get_buffer(key)->start[31] == 1);
+
+    dtn_key *replaced = dtn_key_store_acquire(store, "test");
+    testrun(replaced != key);
+    testrun(dtn_key_get_buffer(replaced)->length == 64);
+
+    testrun(NULL == dtn_key_release(key));
+    testrun(NULL == dtn_key_release(replaced));
+    testrun(NULL == dtn_key_release(NULL));
+
+    // other keys are kept by a change
+
+    testrun(dtn_key_store_set(store, "other", test_key(3, 16)));
+    testrun(2 == dtn_dict_count(dtn_epoch_data(&store->data)));
+
+    key = dtn_key_store_acquire(store, "test");
+    testrun(key == replaced);
+    testrun(NULL == dtn_key_release(key));
+
+    testrun(NULL == dtn_key_store_free(store));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_key_hmac_create() {
+
+    uint8_t data[] = "some data";
+    uint8_t expect[DTN_SHA512_SIZE] = {0};
+    uint8_t result[DTN_SHA512_SIZE] = {0};
+    size_t expect_size = 0;
+    size_t size = 0;
+
+    dtn_key_store *store = dtn_key_store_create((dtn_key_store_config){0});
+    testrun(dtn_key_store_set(store, "test", test_key(1, 256)));
+
+    dtn_key *key = dtn_key_store_acquire(store, "test");
+    testrun(key);
+
+    testrun(!dtn_key_hmac_create(NULL, DTN_HASH_SHA256));
+    testrun(!dtn_key_hmac_create(key, DTN_HASH_UNSPEC));
 
+    dtn_hash_function functions[] = {DTN_HASH_SHA256, DTN_HASH_SHA384,
+                                     DTN_HASH_SHA512};
+
+    for (size_t i = 0; i < 3; i++) {
+
+        testrun(key->hmac[i]);
+
+        expect_size = sizeof(expect);
+        testrun(dtn_hmac(functions[i], data, sizeof(data),
+                         dtn_key_get_buffer(key)->start, 256, expect,
+                         &expect_size));
+
+        // the prepared context is copied, not used
+
+        for (size_t n = 0; n < 2; n++) {
+
+            dtn_hmac_context *ctx = dtn_key_hmac_create(key, functions[i]);
+            testrun(ctx);
+            testrun(dtn_hmac_update(ctx, data, sizeof(data)));
+
+            size = sizeof(result);
+            testrun(dtn_hmac_final(ctx, result, &size));
+            testrun(size == expect_size);
+            testrun(0 == memcmp(result, expect, size));
+            testrun(NULL == dtn_hmac_context_free(ctx));
+        }
+    }
+
+    testrun(NULL == dtn_key_release(key));
     testrun(NULL == dtn_key_store_free(store));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+#define READER_THREADS 4
+#define READER_LOOKUPS 20000
+
+struct reader {
+
+    dtn_key_store *store;
+    size_t failed;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static void *read_keys(void *arg) {
+
+    struct reader *reader = (struct reader *)arg;
 
+    for (size_t i = 0; i < READER_LOOKUPS; i++) {
+
+        dtn_key *key = dtn_key_store_acquire(reader->store, "test");
+        const dtn_buffer *buffer = dtn_key_get_buffer(key);
+
+        // any key seen is complete, all bytes are the same
+
+        if (!buffer || (buffer->length != 32) ||
+            (buffer->start[0] != buffer->start[31]))
+            reader->failed++;
+
+        dtn_key_release(key);
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_key_store_acquire_threads() {
+
+    dtn_key_store *store = dtn_key_store_create(
+        (dtn_key_store_config){.limits.threadlock_timeout_usec = 1000000});
+    testrun(dtn_key_store_set(store, "test", test_key(0, 32)));
+
+    pthread_t threads[READER_THREADS] = {0};
+    struct reader readers[READER_THREADS] = {0};
+
+    for (size_t i = 0; i < READER_THREADS; i++) {
+
+        readers[i].store = store;
+        testrun(0 == pthread_create(threads + i, 0, read_keys, readers + i));
+    }
+
+    // keys are replaced while read
+
+    for (size_t i = 1; i < 200; i++) {
+        testrun(dtn_key_store_set(store, "test", test_key(i, 32)));
+    }
+
+    for (size_t i = 0; i < READER_THREADS; i++) {
+        testrun(0 == pthread_join(threads[i], NULL));
+        testrun(0 == readers[i].failed);
+    }
+
+    testrun(0 == atomic_load(&store->data.readers[0]));
+    testrun(0 == atomic_load(&store->data.readers[1]));
+
+    testrun(NULL == dtn_key_store_free(store));
     return testrun_log_success();
 }
 
@@ -202,6 +385,9 @@ int all_tests() {
     testrun_test(test_dtn_key_store_save);
     testrun_test(test_dtn_key_store_get);
     testrun_test(test_dtn_key_store_set);
+    testrun_test(test_dtn_key_store_acquire);
+    testrun_test(test_dtn_key_hmac_create);
+    testrun_test(test_dtn_key_store_acquire_threads);
 
     return testrun_counter;
 }
@@ -125,7 +125,10 @@ int domains_init() {
     testrun(dtn_item_object_set(cert, "file", val));
     val = dtn_item_string(DTN_TEST_CERT_KEY);
     testrun(dtn_item_object_set(cert, "key", val));
+    // connections without SNI are served by the default domain
+    testrun(dtn_item_object_set(conf, "default", dtn_item_true()));
     testrun(dtn_item_json_write_file(domain_config_file, conf));
+    testrun(dtn_item_object_delete(conf, "default"));
 
     val = dtn_item_string(TEST_DOMAIN_NAME_ONE);
     testrun(dtn_item_object_set(conf, "name", val));
@@ -55,6 +55,7 @@ typedef struct dtn_file_node_app_config {
     char path[PATH_MAX];
     char uri[PATH_MAX];
     char keys[PATH_MAX];
+    char store_path[PATH_MAX];
 
     dtn_socket_configuration socket; // command & control socket
 
@@ -69,6 +70,8 @@ typedef struct dtn_file_node_app_config {
         uint64_t buffer_time_cleanup_usecs;
         uint64_t history_secs;
         uint64_t max_buffer_time_secs;
+        uint64_t buffer_workers;
+        uint64_t buffer_queue_size;
 
         struct {
 
@@ -0,0 +1,182 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_node_store.h
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        Encoded bundles held for next hops of a node in a dtn_bundle_store,
+        until the link of the interface of the next hop is up.
+
+        A bundle is held once per next hop, stored under the key of
+        dtn_routing_info_to_key. Next hops are tracked per interface,
+        including those of records recovered by the store, so releasing
+        an interface drains the keys of the interface only.
+
+        The bundle age block of released bundles is set to the time the
+        bundle spent in the store.
+
+        Functions are thread safe.
+
+        ------------------------------------------------------------------------
+*/
+#ifndef dtn_node_store_h
+#define dtn_node_store_h
+
+#include <dtn/dtn_bundle.h>
+#include <dtn/dtn_bundle_store.h>
+#include <dtn/dtn_routing.h>
+
+typedef struct dtn_node_store dtn_node_store;
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct dtn_node_store_config {
+
+    char path[PATH_MAX]; // directory of the dtn_bundle_store
+
+    struct {
+
+        uint64_t threadlock_timeout_usecs;
+
+    } limits;
+
+    struct {
+
+        void *userdata;
+
+        // send data to hop, released bundles are removed if true
+        bool (*send)(void *userdata, const dtn_routing_info *hop,
+                     const uint8_t *data, size_t size);
+
+    } callbacks;
+
+} dtn_node_store_config;
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_node_store *dtn_node_store_create(dtn_node_store_config config);
+dtn_node_store *dtn_node_store_free(dtn_node_store *self);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+        Hold data, the encoding of bundle, for hop. The record expires
+        with the lifetime of the bundle left, see
+        dtn_node_store_lifetime_left.
+
+        @returns false if held for hop already or the bundle is expired
+*/
+bool dtn_node_store_hold(dtn_node_store *self, const dtn_routing_info *hop,
+                         dtn_bundle *bundle, const uint8_t *data,
+                         size_t size);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_node_store_contains(dtn_node_store *self, const dtn_routing_info *hop,
+                             const dtn_bundle *bundle);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Send the bundles held for next hops at interface.
+
+        @returns number of bundles sent, -1 on error
+*/
+int64_t dtn_node_store_release(dtn_node_store *self, const char *interface);
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_node_store_get_stats(dtn_node_store *self,
+                              dtn_bundle_store_stats *stats);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      BUNDLE LIFETIME
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+        DTN time now, milliseconds since 2000-01-01 00:00:00 UTC, used as
+        creation timestamp of bundles created at this node (RFC 9171).
+*/
+uint64_t dtn_node_store_dtn_time();
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        Lifetime of bundle left at now_usecs, for a bundle received at
+        received_usecs. Both are CLOCK_REALTIME.
+
+        With a creation time set the bundle expires at creation time plus
+        lifetime on the DTN clock. With a creation time of 0 it expires
+        after the lifetime left after its bundle age, from its arrival.
+
+        @returns false if the bundle is expired
+*/
+bool dtn_node_store_lifetime_left(dtn_bundle *bundle, uint64_t received_usecs,
+                                  uint64_t now_usecs, uint64_t *left_usecs);
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      BUNDLE AGE
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/**
+        Set the bundle age block of bundle to the lifetime used up at
+        now_usecs for a bundle expiring at expires_usecs.
+
+        @param aged     set if bundle has a bundle age block
+*/
+bool dtn_node_store_stamp_age(dtn_bundle *bundle, uint64_t expires_usecs,
+                              uint64_t now_usecs, bool *aged);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+        dtn_node_store_stamp_age for an encoded bundle, encoded again to
+        out. length is 0 for bundles without bundle age block, which are
+        sent as they are.
+*/
+bool dtn_node_store_restamp_age(const uint8_t *data, size_t size,
+                                uint64_t expires_usecs, uint64_t now_usecs,
+                                uint8_t *out, size_t out_size,
+                                size_t *length);
+
+#endif /* dtn_node_store_h */
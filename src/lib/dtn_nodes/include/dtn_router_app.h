@@ -49,6 +49,8 @@ typedef struct dtn_router_app_config {
 
     char name[PATH_MAX];
     char route_config_path[PATH_MAX];
+    char store_path[PATH_MAX];
+    char contact_plan_path[PATH_MAX];
 
     dtn_socket_configuration socket; // command & control socket
 
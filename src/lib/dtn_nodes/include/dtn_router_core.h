@@ -24,17 +24,56 @@
 
         @date           2025-12-21
 
+        Bundles received at an interface are forwarded in worker threads:
+
+            duplicate check -> lifetime / hop count check -> route lookup
+            -> contact queue of the next hop -> interface send
+
+        Duplicates are detected by source, creation timestamp, sequence
+        number and fragment offset. A bundle is remembered once it is
+        accepted for a next hop, so a bundle dropped as expired, unroutable
+        or over a limit is forwarded when sent again.
+
+        Bundles with a creation time expire at creation time plus lifetime
+        on the DTN clock (RFC 9171). Bundles with a creation time of 0
+        expire after the lifetime left after their bundle age block, from
+        the arrival at this node. The age block is set to the received age
+        plus the time spent at this node, when forwarded and again when
+        held or stored bundles are sent.
+
+        Bundles for a next hop without an interface or with a link not up
+        are held in the contact queue of the next hop, until the link of
+        the interface changes to up.
+
+        With config.store_path set, bundles exceeding the contact queue
+        are spilled to a dtn_bundle_store at store_path, which keeps them
+        over restarts. Stored bundles are sent after the contact queue,
+        once the link of their interface changes to up.
+
+        With config.contact_plan_path set, bundles are routed over the
+        contacts of the plan from the node config.name first, see
+        dtn_cgr.h, and over the routes at route_config_path otherwise.
+        A bundle is sent to the next hop of the earliest arrival at once,
+        if the first contact of the route is open. Otherwise it is held in
+        the contact queue of the next hop until the contact starts, when a
+        timer of the loop flushes the contact queues. Bundles spilled to
+        the store are sent with the next flush of their interface.
 
         ------------------------------------------------------------------------
 */
 #ifndef dtn_router_core_h
 #define dtn_router_core_h
 
+#include <dtn/dtn_bundle.h>
 #include <dtn/dtn_cbor.h>
 #include <dtn_base/dtn_event_loop.h>
 
 /*---------------------------------------------------------------------------*/
 
+#define DTN_ROUTER_CORE_CONTACT_QUEUE 10000
+#define DTN_ROUTER_CORE_DUPLICATE_HISTORY_USEC (60 * 60 * 1000 * 1000ULL)
+#define DTN_ROUTER_CORE_DUPLICATE_MEMORY (16 * 1024 * 1024)
+
 typedef struct dtn_router_core dtn_router_core;
 
 /*---------------------------------------------------------------------------*/
@@ -46,6 +85,12 @@ typedef struct dtn_router_core_config {
     char name[PATH_MAX];
     char route_config_path[PATH_MAX];
 
+    // directory of a dtn_bundle_store, empty to not spill bundles
+    char store_path[PATH_MAX];
+
+    // contact plan file, empty to route by route_config_path only
+    char contact_plan_path[PATH_MAX];
+
     struct {
 
         uint64_t threadlock_timeout_usec;
@@ -53,10 +98,35 @@ typedef struct dtn_router_core_config {
         uint64_t threads;
         uint64_t link_check;
 
+        // bundles held per next hop, 0 for DTN_ROUTER_CORE_CONTACT_QUEUE
+        uint64_t contact_queue;
+
+        // 0 for DTN_ROUTER_CORE_DUPLICATE_HISTORY_USEC
+        uint64_t duplicate_history_usec;
+
+        // 0 for DTN_ROUTER_CORE_DUPLICATE_MEMORY, the oldest keys are
+        // dropped before their history time if exceeded
+        uint64_t duplicate_memory_bytes;
+
     } limits;
 
 } dtn_router_core_config;
 
+/*---------------------------------------------------------------------------*/
+
+typedef struct dtn_router_core_stats {
+
+    uint64_t forwarded;  // bundles sent at an interface
+    uint64_t held;       // bundles currently held for a next hop
+    uint64_t duplicates; // bundles seen before
+    uint64_t expired;    // lifetime or hop limit exceeded
+    uint64_t unroutable; // no route to the destination
+    uint64_t dropped;    // contact queue full or not encodable
+    uint64_t spilled;    // bundles spilled to the store
+    uint64_t stored;     // bundles currently in the store
+
+} dtn_router_core_stats;
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -80,4 +150,19 @@ bool dtn_router_core_send_raw(dtn_router_core *self,
                               dtn_socket_configuration remote,
                               const dtn_cbor *data);
 
+/*---------------------------------------------------------------------------*/
+
+/**
+        Forward a bundle, as done for all bundles received at interfaces.
+
+        @param bundle   bundle to forward, consumed in any case
+        @returns true if the bundle was sent or held for its next hop
+*/
+bool dtn_router_core_forward(dtn_router_core *self, dtn_bundle *bundle);
+
+/*---------------------------------------------------------------------------*/
+
+bool dtn_router_core_get_stats(dtn_router_core *self,
+                               dtn_router_core_stats *stats);
+
 #endif /* dtn_router_core_h */
@@ -51,6 +51,7 @@ typedef struct dtn_tunnel_app_config {
     char uri[PATH_MAX];
     char destination_uri[PATH_MAX];
     char keys[PATH_MAX];
+    char store_path[PATH_MAX];
 
     dtn_socket_configuration socket; // command & control socket
     dtn_socket_configuration tunnel; // tunnel socket
@@ -67,6 +68,8 @@ typedef struct dtn_tunnel_app_config {
         uint64_t buffer_time_cleanup_usecs;
         uint64_t max_buffer_time_secs;
         uint64_t history_secs;
+        uint64_t buffer_workers;
+        uint64_t buffer_queue_size;
 
         struct {
 
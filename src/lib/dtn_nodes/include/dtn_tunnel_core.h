@@ -49,6 +49,10 @@ typedef struct dtn_tunnel_core_config {
 
     char keys[PATH_MAX];
 
+    // directory of a dtn_bundle_store to hold bundles for next hops
+    // without a link up, empty to drop those bundles
+    char store_path[PATH_MAX];
+
     struct {
 
         uint64_t threadlock_timeout_usec;
@@ -59,6 +63,10 @@ typedef struct dtn_tunnel_core_config {
         uint64_t max_buffer_time_secs;
         uint64_t history_secs;
 
+        // workers and queue of the bundle buffer, see dtn_bundle_buffer.h
+        uint64_t buffer_workers;
+        uint64_t buffer_queue_size;
+
     } limits;
 
     dtn_security_config sec;
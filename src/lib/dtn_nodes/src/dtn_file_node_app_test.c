@@ -28,6 +28,7 @@
         ------------------------------------------------------------------------
 */
 #include "dtn_file_node_app.c"
+#include <dtn_base/dtn_item_json.h>
 #include <dtn_base/testrun.h>
 
 /*
@@ -46,6 +47,37 @@ int test_case() {
 
 /*----------------------------------------------------------------------------*/
 
+int test_dtn_file_node_app_config_from_item() {
+
+    dtn_item *item = dtn_item_from_json(
+        "{\"dtn\":{\"node\":{\"limits\":{\"threads\":3,"
+        "\"history_secs\":10,\"buffer_workers\":2,"
+        "\"buffer_queue_size\":16}}}}");
+    testrun(item);
+
+    dtn_file_node_app_config config = dtn_file_node_app_config_from_item(item);
+    testrun(3 == config.limits.threads);
+    testrun(10 == config.limits.history_secs);
+    testrun(2 == config.limits.buffer_workers);
+    testrun(16 == config.limits.buffer_queue_size);
+    item = dtn_item_free(item);
+
+    // limits at the node config
+
+    item = dtn_item_from_json("{\"threads\":4,\"buffer_workers\":1}");
+    testrun(item);
+
+    config = dtn_file_node_app_config_from_item(item);
+    testrun(4 == config.limits.threads);
+    testrun(1 == config.limits.buffer_workers);
+    testrun(0 == config.limits.buffer_queue_size);
+    item = dtn_item_free(item);
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -58,6 +90,7 @@ int all_tests() {
 
     testrun_init();
     testrun_test(test_case);
+    testrun_test(test_dtn_file_node_app_config_from_item);
 
     return testrun_counter;
 }
@@ -28,7 +28,9 @@
         ------------------------------------------------------------------------
 */
 #include "../include/dtn_file_node_core.h"
+#include "../include/dtn_node_store.h"
 
+#include <inttypes.h>
 #include <libgen.h>
 #include <limits.h>
 #include <stdlib.h>
@@ -88,6 +90,8 @@ struct dtn_file_node_core {
 
     dtn_key_store *keys;
 
+    dtn_node_store *store;
+
     struct {
 
         dtn_thread_lock lock_ip;
@@ -128,6 +132,52 @@ error:
     return self;
 }
 
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      SENDING
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static bool interface_send(dtn_file_node_core *self,
+                           const dtn_routing_info *info,
+                           const uint8_t *buffer, size_t size) {
+
+    bool result = false;
+
+    if (!dtn_thread_lock_try_lock(&self->interfaces.lock_ip))
+        goto error;
+
+    Interface *in = dtn_dict_get(self->interfaces.ip, info->interface);
+
+    if (in && dtn_thread_lock_try_lock(&in->lock)) {
+
+        if (DTN_IP_LINK_UP == in->state)
+            result = dtn_interface_ip_send_to(in->interface, info->remote,
+                                              &info->address, buffer, size);
+
+        if (!dtn_thread_lock_unlock(&in->lock)) {
+            dtn_log_error("failed to unlock interface.");
+        }
+    }
+
+    if (!dtn_thread_lock_unlock(&self->interfaces.lock_ip)) {
+        dtn_log_error("failed to unlock IP interfaces.");
+    }
+
+error:
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool store_send(void *userdata, const dtn_routing_info *hop,
+                       const uint8_t *data, size_t size) {
+
+    return interface_send((dtn_file_node_core *)userdata, hop, data, size);
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -328,7 +378,11 @@ static bool message_state_change_process(dtn_file_node_core *self,
 
     dtn_log_debug("THREAD IO STATE CHANGE at %s to %s", msg->interface, string);
 
-    TODO("... process state change");
+    if ((DTN_IP_LINK_UP == msg->state) && self->store &&
+        (0 > dtn_node_store_release(self->store, msg->interface))) {
+
+        dtn_log_error("failed to send stored bundles at %s", msg->interface);
+    }
 
     dtn_thread_message_free(dtn_thread_message_cast(msg));
     return true;
@@ -476,6 +530,8 @@ dtn_file_node_core_create(dtn_file_node_core_config config) {
             self->config.limits.buffer_time_cleanup_usecs,
         .limits.history_secs = self->config.limits.history_secs,
         .limits.max_buffer_time_secs = self->config.limits.max_buffer_time_secs,
+        .limits.workers = self->config.limits.buffer_workers,
+        .limits.queue_size = self->config.limits.buffer_queue_size,
         .limits.threadlock_timeout_usecs =
             self->config.limits.threadlock_timeout_usec,
         .callbacks.userdata = self,
@@ -505,6 +561,21 @@ dtn_file_node_core_create(dtn_file_node_core_config config) {
 
     dtn_key_store_load(self->keys, NULL);
 
+    if (0 != config.store_path[0]) {
+
+        dtn_node_store_config store = (dtn_node_store_config){
+            .limits.threadlock_timeout_usecs =
+                config.limits.threadlock_timeout_usec,
+            .callbacks.userdata = self,
+            .callbacks.send = store_send};
+
+        strncpy(store.path, config.store_path, PATH_MAX - 1);
+
+        self->store = dtn_node_store_create(store);
+        if (!self->store)
+            goto error;
+    }
+
     return self;
 error:
     dtn_file_node_core_free(self);
@@ -528,6 +599,7 @@ dtn_file_node_core *dtn_file_node_core_free(dtn_file_node_core *self) {
     self->garbadge = dtn_garbadge_colloctor_free(self->garbadge);
     self->interfaces.ip = dtn_dict_free(self->interfaces.ip);
     self->tloop = dtn_thread_loop_free(self->tloop);
+    self->store = dtn_node_store_free(self->store);
     self = dtn_data_pointer_free(self);
     return NULL;
 }
@@ -915,7 +987,8 @@ static dtn_list *create_bundles_for_file(dtn_file_node_core *self,
     dtn_cbor *primary = NULL;
     dtn_cbor *bib = NULL;
     dtn_cbor *bcb = NULL;
-    dtn_buffer *key = NULL;
+    dtn_key *handle = NULL;
+    const dtn_buffer *key = NULL;
 
     if (!self || !path || !buffer || size < 1)
         goto error;
@@ -932,7 +1005,7 @@ static dtn_list *create_bundles_for_file(dtn_file_node_core *self,
 
     self->sequence++;
 
-    uint64_t timestamp = dtn_time_get_current_time_usecs();
+    uint64_t timestamp = dtn_node_store_dtn_time();
     uint64_t lifetime = 24 * 60 * 60 * 1000; // 24h
 
     char destination[2 * PATH_MAX];
@@ -956,7 +1029,8 @@ static dtn_list *create_bundles_for_file(dtn_file_node_core *self,
     memset(key_source, 0, PATH_MAX);
     snprintf(key_source, PATH_MAX, "%s/%s", self->uri->name, self->uri->demux);
 
-    key = dtn_key_store_get(self->keys, key_source);
+    handle = dtn_key_store_acquire(self->keys, key_source);
+    key = dtn_key_get_buffer(handle);
 
     while (open - chunk > 0) {
 
@@ -1043,16 +1117,13 @@ static dtn_list *create_bundles_for_file(dtn_file_node_core *self,
             break;
 
         open = open - chunk;
-        self->sequence++;
     }
 
-    // add last block
+    // add last block, all fragments share timestamp and sequence
 
     bib = NULL;
     bcb = NULL;
 
-    self->sequence++;
-
     bundle = dtn_bundle_create();
     if (!bundle)
         goto error;
@@ -1126,14 +1197,14 @@ static dtn_list *create_bundles_for_file(dtn_file_node_core *self,
     }
 
     dtn_data_pointer_free(source);
-    dtn_buffer_free(key);
+    dtn_key_release(handle);
     return queue;
 
 error:
     dtn_bundle_free(bundle);
     dtn_list_free(queue);
     dtn_data_pointer_free(source);
-    dtn_buffer_free(key);
+    dtn_key_release(handle);
     return NULL;
 }
 
@@ -1150,7 +1221,8 @@ bool dtn_file_node_core_send_file(dtn_file_node_core *self, const char *uri,
     dtn_list *queue = NULL;
     uint8_t *buffer = NULL;
     size_t size = 0;
-    dtn_list *list = NULL;
+    dtn_routing_info routes[DTN_ROUTING_LOOKUP_MAX];
+    dtn_bundle *bundle = NULL;
     dtn_dtn_uri *destination = NULL;
 
     if (!self || !uri || !source_path || !dest_path)
@@ -1165,15 +1237,16 @@ bool dtn_file_node_core_send_file(dtn_file_node_core *self, const char *uri,
         goto error;
     }
 
-    list = dtn_routing_get_info_for_uri(self->routing, destination);
-    if (!list)
+    int64_t count =
+        dtn_routing_lookup(self->routing, uri, routes, DTN_ROUTING_LOOKUP_MAX);
+    if (count < 0)
         goto error;
 
     queue = create_bundles_for_file(self, destination, dest_path, buffer, size);
     if (!queue)
         goto error;
 
-    dtn_bundle *bundle = dtn_list_queue_pop(queue);
+    bundle = dtn_list_queue_pop(queue);
 
     while (bundle) {
 
@@ -1184,33 +1257,22 @@ bool dtn_file_node_core_send_file(dtn_file_node_core *self, const char *uri,
         if (!dtn_bundle_encode(bundle, out, out_size, &next))
             goto error;
 
-        dtn_routing_info *info = NULL;
+        for (int64_t i = 0; i < count; i++) {
 
-        void *nxt = list->iter(list);
+            const dtn_routing_info *info = &routes[i];
 
-        while (nxt) {
+            if (interface_send(self, info, out, next - out)) {
 
-            nxt = list->next(list, nxt, (void **)&info);
-
-            if (!dtn_thread_lock_try_lock(&self->interfaces.lock_ip))
-                continue;
+                dtn_log_debug("send bundle at %s to %s:%i", info->interface,
+                              info->remote.host, info->remote.port);
 
-            Interface *in = dtn_dict_get(self->interfaces.ip, info->interface);
-            if (in) {
+            } else if (dtn_node_store_hold(self->store, info, bundle, out,
+                                           next - out)) {
 
-                dtn_thread_lock_try_lock(&in->lock);
+                dtn_log_debug("stored bundle for %s to %s:%i",
+                              info->interface, info->remote.host,
+                              info->remote.port);
             }
-
-            dtn_thread_lock_unlock(&self->interfaces.lock_ip);
-
-            bool result = dtn_interface_ip_send(in->interface, info->remote,
-                                                out, next - out);
-
-            dtn_thread_lock_unlock(&in->lock);
-
-            if (result)
-                dtn_log_debug("send bundle at %s to %s:%i", info->interface,
-                              info->remote.host, info->remote.port);
         }
 
         bundle = dtn_bundle_free(bundle);
@@ -1222,14 +1284,12 @@ bool dtn_file_node_core_send_file(dtn_file_node_core *self, const char *uri,
     queue = dtn_list_free(queue);
     buffer = dtn_data_pointer_free(buffer);
     destination = dtn_dtn_uri_free(destination);
-    list = dtn_list_free(list);
     return true;
 error:
     bundle = dtn_bundle_free(bundle);
     queue = dtn_list_free(queue);
     buffer = dtn_data_pointer_free(buffer);
     destination = dtn_dtn_uri_free(destination);
-    list = dtn_list_free(list);
 
     return false;
 }
\ No newline at end of file
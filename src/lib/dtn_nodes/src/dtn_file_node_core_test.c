@@ -30,6 +30,7 @@
 #include "dtn_file_node_core.c"
 #include <dtn_base/testrun.h>
 
+#include <dtn_base/dtn_dir.h>
 #include <dtn_base/dtn_random.h>
 
 #ifndef DTN_TEST_RESOURCE_DIR
@@ -98,6 +99,125 @@ int test_dtn_file_node_core_enable_ip_interfaces() {
 
 /*----------------------------------------------------------------------------*/
 
+int test_dtn_file_node_core_store() {
+
+    char path[PATH_MAX] = "/tmp/dtn_file_node_core_XXXXXX";
+    testrun(mkdtemp(path));
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_file_node_core_config config =
+        (dtn_file_node_core_config){.loop = loop};
+    strncpy(config.store_path, path, PATH_MAX);
+
+    dtn_file_node_core *core = dtn_file_node_core_create(config);
+    testrun(core);
+    testrun(core->store);
+
+    dtn_routing_info info = (dtn_routing_info){
+        .class = DTN_ROUTING_DIRECT,
+        .remote = (dtn_socket_configuration){
+            .host = "127.0.0.1", .port = 4557, .type = UDP},
+        .interface = "127.0.0.1"};
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 0, "dtn://test/two",
+                                         "dtn://src/1", "dtn://src/1", 0, 2,
+                                         1000, 0, 0));
+
+    uint8_t data[] = "bundle";
+
+    // no interface, held in the store per next hop
+
+    testrun(!interface_send(core, &info, data, sizeof(data)));
+    testrun(dtn_node_store_hold(core->store, &info, bundle, data,
+                                sizeof(data)));
+    testrun(!dtn_node_store_hold(core->store, &info, bundle, data,
+                                 sizeof(data)));
+    testrun(dtn_node_store_contains(core->store, &info, bundle));
+
+    info.remote.port = 4556;
+    testrun(dtn_node_store_hold(core->store, &info, bundle, data,
+                                sizeof(data)));
+
+    // released at link up of the interface only
+
+    testrun(0 == dtn_node_store_release(core->store, "127.0.0.1"));
+    testrun(0 == dtn_node_store_release(core->store, "other"));
+    testrun(dtn_node_store_contains(core->store, &info, bundle));
+
+    // expired bundles are not held
+
+    testrun(dtn_bundle_primary_set_lifetime(bundle, 0));
+    testrun(dtn_bundle_primary_set_timestamp(bundle, 1, 3));
+    testrun(!dtn_node_store_hold(core->store, &info, bundle, data,
+                                 sizeof(data)));
+
+    bundle = dtn_bundle_free(bundle);
+    testrun(NULL == dtn_file_node_core_free(core));
+    testrun(NULL == dtn_event_loop_free(loop));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_file_node_core_buffer_workers() {
+
+    char path[PATH_MAX] = "/tmp/dtn_file_node_core_XXXXXX";
+    char file[PATH_MAX + 16] = {0};
+    testrun(mkdtemp(path));
+    snprintf(file, sizeof(file), "%s/in/test.txt", path);
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_file_node_core *core = dtn_file_node_core_create(
+        (dtn_file_node_core_config){.loop = loop,
+                                    .limits.buffer_workers = 2,
+                                    .limits.buffer_queue_size = 8});
+    testrun(core);
+    testrun(dtn_file_node_core_set_source_uri(core, "dtn://node/files"));
+    testrun(dtn_file_node_core_set_reception_path(core, path));
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 0, "dtn://node/in/test.txt",
+                                         "dtn://src/1", "dtn://src/1", 0, 1,
+                                         1000, 0, 0));
+
+    dtn_cbor *payload = dtn_cbor_string("test");
+    testrun(dtn_cbor_set_byte_string(payload, (uint8_t *)"hello", 5));
+    testrun(dtn_bundle_add_block(bundle, 1, 1, 0, 0, payload));
+
+    // processed by a worker of the bundle buffer, not the pushing thread
+
+    testrun(dtn_bundle_buffer_push(core->buffer, bundle));
+
+    uint8_t *content = NULL;
+    size_t size = 0;
+
+    for (size_t i = 0; (i < 100) && (5 != size); i++) {
+
+        usleep(10000);
+        content = dtn_data_pointer_free(content);
+        dtn_file_read(file, &content, &size);
+    }
+
+    testrun(5 == size);
+    testrun(0 == memcmp("hello", content, 5));
+    content = dtn_data_pointer_free(content);
+
+    testrun(NULL == dtn_file_node_core_free(core));
+    testrun(NULL == dtn_event_loop_free(loop));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -111,6 +231,8 @@ int all_tests() {
     testrun_init();
     testrun_test(test_dtn_file_node_core_create);
     testrun_test(test_dtn_file_node_core_enable_ip_interfaces);
+    testrun_test(test_dtn_file_node_core_store);
+    testrun_test(test_dtn_file_node_core_buffer_workers);
 
     return testrun_counter;
 }
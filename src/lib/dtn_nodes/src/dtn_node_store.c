@@ -0,0 +1,548 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_node_store.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "../include/dtn_node_store.h"
+
+#include <dtn/dtn_interface_ip.h>
+
+#include <dtn_base/dtn_dict.h>
+#include <dtn_base/dtn_linked_list.h>
+#include <dtn_base/dtn_string.h>
+#include <dtn_base/dtn_thread_lock.h>
+#include <dtn_base/dtn_utils.h>
+
+#include <time.h>
+
+// DTN epoch 2000-01-01 00:00:00 UTC in seconds of the unix epoch
+#define DTN_EPOCH_UNIX_SECS 946684800
+
+/*----------------------------------------------------------------------------*/
+
+struct dtn_node_store {
+
+    dtn_node_store_config config;
+    dtn_bundle_store *store;
+
+    struct {
+
+        dtn_thread_lock lock;
+        dtn_dict *data; // key of the hop -> dtn_routing_info
+
+    } hops;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t real_time_usecs() {
+
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool hop_set(dtn_dict *hops, const char *key,
+                    const dtn_routing_info *hop) {
+
+    if (dtn_dict_get(hops, key))
+        return true;
+
+    char *name = dtn_string_dup(key);
+    dtn_routing_info *info = calloc(1, sizeof(dtn_routing_info));
+
+    if (!name || !info)
+        goto error;
+
+    *info = *hop;
+
+    if (!dtn_dict_set(hops, name, info, NULL))
+        goto error;
+
+    return true;
+error:
+    dtn_data_pointer_free(name);
+    dtn_data_pointer_free(info);
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool hop_recovered(void *userdata, const char *destination) {
+
+    dtn_routing_info hop = {0};
+
+    if (!dtn_routing_info_from_key(&hop, destination)) {
+        dtn_log_error("stored bundles for invalid next hop %s", destination);
+        return false;
+    }
+
+    // resolved once as routes are, resolved when sending if this fails
+
+    socklen_t len = sizeof(hop.address);
+
+    if (!dtn_socket_configuration_to_sockaddr(hop.remote, &hop.address, &len))
+        memset(&hop.address, 0, sizeof(hop.address));
+
+    return hop_set((dtn_dict *)userdata, destination, &hop);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool hold_id(const dtn_routing_info *hop, const dtn_bundle *bundle,
+                    char *key, char *id) {
+
+    if (!dtn_routing_info_to_key(hop, key, DTN_ROUTING_KEY_MAX))
+        return false;
+
+    // a bundle is held once per next hop
+
+    if (!dtn_bundle_primary_get_id(bundle, id, DTN_BUNDLE_STORE_ID_MAX))
+        return false;
+
+    size_t len = strlen(id);
+    if (len + strlen(key) + 2 > DTN_BUNDLE_STORE_ID_MAX)
+        return false;
+
+    id[len] = '|';
+    strcpy(id + len + 1, key);
+    return true;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      GENERIC FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+dtn_node_store *dtn_node_store_create(dtn_node_store_config config) {
+
+    dtn_node_store *self = NULL;
+
+    if (0 == config.path[0] || !config.callbacks.send)
+        goto error;
+
+    if (0 == config.limits.threadlock_timeout_usecs)
+        config.limits.threadlock_timeout_usecs = 100000;
+
+    self = calloc(1, sizeof(dtn_node_store));
+    if (!self)
+        goto error;
+
+    self->config = config;
+
+    if (!dtn_thread_lock_init(&self->hops.lock,
+                              config.limits.threadlock_timeout_usecs))
+        goto error;
+
+    dtn_dict_config d_config = dtn_dict_string_key_config(255);
+    d_config.value.data_function.free = dtn_data_pointer_free;
+
+    self->hops.data = dtn_dict_create(d_config);
+    if (!self->hops.data)
+        goto error;
+
+    dtn_bundle_store_config store = (dtn_bundle_store_config){
+        .limits.threadlock_timeout_usecs =
+            config.limits.threadlock_timeout_usecs};
+
+    strncpy(store.path, config.path, PATH_MAX - 1);
+
+    self->store = dtn_bundle_store_create(store);
+    if (!self->store)
+        goto error;
+
+    // next hops of bundles stored before
+
+    if (0 > dtn_bundle_store_destinations(self->store, hop_recovered,
+                                          self->hops.data))
+        goto error;
+
+    return self;
+error:
+    dtn_node_store_free(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dtn_node_store *dtn_node_store_free(dtn_node_store *self) {
+
+    if (!self)
+        return NULL;
+
+    self->store = dtn_bundle_store_free(self->store);
+    self->hops.data = dtn_dict_free(self->hops.data);
+    dtn_thread_lock_clear(&self->hops.lock);
+
+    return dtn_data_pointer_free(self);
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      FUNCTIONS
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+bool dtn_node_store_hold(dtn_node_store *self, const dtn_routing_info *hop,
+                         dtn_bundle *bundle, const uint8_t *data,
+                         size_t size) {
+
+    char key[DTN_ROUTING_KEY_MAX] = {0};
+    char id[DTN_BUNDLE_STORE_ID_MAX] = {0};
+
+    if (!self || !hop || !bundle || !data)
+        goto error;
+
+    uint64_t now = real_time_usecs();
+    uint64_t left = 0;
+
+    if (!dtn_node_store_lifetime_left(bundle, now, now, &left))
+        goto error;
+
+    if (!hold_id(hop, bundle, key, id))
+        goto error;
+
+    if (!dtn_thread_lock_try_lock(&self->hops.lock))
+        goto error;
+
+    bool known = hop_set(self->hops.data, key, hop);
+
+    if (!dtn_thread_lock_unlock(&self->hops.lock)) {
+        dtn_log_error("failed to unlock next hops.");
+    }
+
+    if (!known)
+        goto error;
+
+    return dtn_bundle_store_put(
+        self->store,
+        (dtn_bundle_store_record){.id = id,
+                                  .destination = key,
+                                  .lifetime_usecs = left},
+        data, size);
+error:
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_node_store_contains(dtn_node_store *self, const dtn_routing_info *hop,
+                             const dtn_bundle *bundle) {
+
+    char key[DTN_ROUTING_KEY_MAX] = {0};
+    char id[DTN_BUNDLE_STORE_ID_MAX] = {0};
+
+    if (!self || !hop || !bundle)
+        return false;
+
+    if (!hold_id(hop, bundle, key, id))
+        return false;
+
+    return dtn_bundle_store_contains(self->store, id);
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct container_hops {
+
+    const char *interface;
+    dtn_list *hops;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static bool collect_hop(const void *key, void *val, void *data) {
+
+    if (!key)
+        return true;
+
+    dtn_routing_info *hop = (dtn_routing_info *)val;
+    struct container_hops *container = (struct container_hops *)data;
+
+    if (0 != strcmp(hop->interface, container->interface))
+        return true;
+
+    // copied with the address resolved for the hop
+
+    dtn_routing_info *copy = calloc(1, sizeof(dtn_routing_info));
+
+    if (!copy || !dtn_list_push(container->hops, copy)) {
+        dtn_data_pointer_free(copy);
+        return false;
+    }
+
+    *copy = *hop;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct container_release {
+
+    dtn_node_store *self;
+    dtn_routing_info hop;
+    uint64_t now_usecs;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static bool release_send(void *userdata, const char *destination,
+                         const uint8_t *data, size_t size,
+                         uint64_t expires_usecs) {
+
+    UNUSED(destination);
+
+    struct container_release *container = (struct container_release *)userdata;
+    dtn_node_store *self = container->self;
+
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX];
+    size_t length = 0;
+
+    if (0 != expires_usecs) {
+
+        if (!dtn_node_store_restamp_age(data, size, expires_usecs,
+                                        container->now_usecs, buffer,
+                                        sizeof(buffer), &length))
+            return false;
+
+        if (0 != length) {
+            data = buffer;
+            size = length;
+        }
+    }
+
+    return self->config.callbacks.send(self->config.callbacks.userdata,
+                                       &container->hop, data, size);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int64_t dtn_node_store_release(dtn_node_store *self, const char *interface) {
+
+    int64_t count = -1;
+    char key[DTN_ROUTING_KEY_MAX] = {0};
+
+    struct container_hops hops = (struct container_hops){
+        .interface = interface,
+        .hops = dtn_linked_list_create(
+            (dtn_list_config){.item.free = dtn_data_pointer_free})};
+
+    if (!self || !interface || !hops.hops)
+        goto error;
+
+    // hops are collected first, so holding is not blocked by sending
+
+    if (!dtn_thread_lock_try_lock(&self->hops.lock))
+        goto error;
+
+    bool collected = dtn_dict_for_each(self->hops.data, &hops, collect_hop);
+
+    if (!dtn_thread_lock_unlock(&self->hops.lock)) {
+        dtn_log_error("failed to unlock next hops.");
+    }
+
+    if (!collected)
+        goto error;
+
+    struct container_release container = (struct container_release){
+        .self = self, .now_usecs = real_time_usecs()};
+
+    count = 0;
+
+    dtn_routing_info *hop = dtn_list_pop(hops.hops);
+
+    while (hop) {
+
+        container.hop = *hop;
+
+        if (dtn_routing_info_to_key(hop, key, DTN_ROUTING_KEY_MAX)) {
+
+            int64_t sent = dtn_bundle_store_drain(self->store, key,
+                                                  release_send, &container);
+
+            if (sent > 0)
+                count += sent;
+        }
+
+        hop = dtn_data_pointer_free(hop);
+        hop = dtn_list_pop(hops.hops);
+    }
+
+error:
+    dtn_list_free(hops.hops);
+    return count;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_node_store_get_stats(dtn_node_store *self,
+                              dtn_bundle_store_stats *stats) {
+
+    if (!self || !stats)
+        return false;
+
+    return dtn_bundle_store_get_stats(self->store, stats);
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      BUNDLE LIFETIME
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+uint64_t dtn_node_store_dtn_time() {
+
+    uint64_t now = real_time_usecs() / 1000;
+    uint64_t epoch = (uint64_t)DTN_EPOCH_UNIX_SECS * 1000;
+
+    return now > epoch ? now - epoch : 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_node_store_lifetime_left(dtn_bundle *bundle, uint64_t received_usecs,
+                                  uint64_t now_usecs, uint64_t *left_usecs) {
+
+    uint64_t creation = 0;
+    uint64_t sequence = 0;
+    uint64_t expires = 0;
+
+    if (!bundle || !left_usecs)
+        return false;
+
+    uint64_t lifetime = dtn_bundle_primary_get_lifetime(bundle) * 1000;
+
+    if (!dtn_bundle_primary_get_timestamp(bundle, &creation, &sequence))
+        return false;
+
+    if (0 != creation) {
+
+        // expires on the DTN clock, independent of the hops passed
+
+        expires = (creation + (uint64_t)DTN_EPOCH_UNIX_SECS * 1000) * 1000 +
+                  lifetime;
+
+    } else {
+
+        // no clock at the source, lifetime left after the bundle age
+
+        uint64_t age = 0;
+
+        if (dtn_bundle_get_bundle_age(bundle, &age))
+            age *= 1000;
+
+        if (age >= lifetime)
+            return false;
+
+        expires = received_usecs + lifetime - age;
+    }
+
+    if (expires <= now_usecs)
+        return false;
+
+    *left_usecs = expires - now_usecs;
+    return true;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      BUNDLE AGE
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+bool dtn_node_store_stamp_age(dtn_bundle *bundle, uint64_t expires_usecs,
+                              uint64_t now_usecs, bool *aged) {
+
+    if (!bundle || !aged)
+        return false;
+
+    // age at now is the lifetime used up, rounded up to milliseconds
+
+    uint64_t lifetime = dtn_bundle_primary_get_lifetime(bundle) * 1000;
+    uint64_t age = 0;
+
+    *aged = dtn_bundle_get_bundle_age(bundle, &age);
+    if (!*aged)
+        return true;
+
+    age = lifetime;
+
+    if (expires_usecs > now_usecs)
+        age -= (expires_usecs - now_usecs < lifetime)
+                   ? expires_usecs - now_usecs
+                   : lifetime;
+
+    return dtn_bundle_set_bundle_age(bundle, (age + 999) / 1000);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool dtn_node_store_restamp_age(const uint8_t *data, size_t size,
+                                uint64_t expires_usecs, uint64_t now_usecs,
+                                uint8_t *out, size_t out_size,
+                                size_t *length) {
+
+    dtn_bundle *bundle = NULL;
+    uint8_t *next = NULL;
+    bool aged = false;
+
+    if (!data || !out || !length)
+        goto error;
+
+    *length = 0;
+
+    if (DTN_CBOR_MATCH_FULL != dtn_bundle_decode(data, size, &bundle, &next))
+        goto error;
+
+    if (!dtn_node_store_stamp_age(bundle, expires_usecs, now_usecs, &aged))
+        goto error;
+
+    if (aged) {
+
+        if (!dtn_bundle_encode(bundle, out, out_size, &next))
+            goto error;
+
+        *length = next - out;
+    }
+
+    dtn_bundle_free(bundle);
+    return true;
+error:
+    dtn_bundle_free(bundle);
+    return false;
+}
@@ -0,0 +1,596 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_node_store_test.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+
+        ------------------------------------------------------------------------
+*/
+#include "dtn_node_store.c"
+#include <dtn_base/dtn_dir.h>
+#include <dtn_base/testrun.h>
+
+/*----------------------------------------------------------------------------*/
+
+struct sent {
+
+    char interface[10][DTN_HOST_NAME_MAX];
+    uint16_t port[10];
+    uint64_t age[10];
+    size_t count;
+
+    bool reject;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static bool test_send(void *userdata, const dtn_routing_info *hop,
+                      const uint8_t *data, size_t size) {
+
+    struct sent *sent = (struct sent *)userdata;
+    dtn_bundle *bundle = NULL;
+    uint8_t *next = NULL;
+
+    if (sent->reject || (sent->count >= 10))
+        return false;
+
+    strcpy(sent->interface[sent->count], hop->interface);
+    sent->port[sent->count] = hop->remote.port;
+
+    if (DTN_CBOR_MATCH_FULL == dtn_bundle_decode(data, size, &bundle, &next))
+        dtn_bundle_get_bundle_age(bundle, &sent->age[sent->count]);
+
+    dtn_bundle_free(bundle);
+    sent->count++;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_node_store_config test_config(char *path, struct sent *sent) {
+
+    dtn_node_store_config config = (dtn_node_store_config){
+        .callbacks.userdata = sent, .callbacks.send = test_send};
+
+    strncpy(config.path, path, PATH_MAX - 1);
+    return config;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_routing_info test_hop(const char *interface, uint16_t port) {
+
+    dtn_routing_info hop = (dtn_routing_info){
+        .remote = (dtn_socket_configuration){
+            .host = "127.0.0.1", .port = port, .type = UDP}};
+
+    strncpy(hop.interface, interface, DTN_HOST_NAME_MAX - 1);
+    return hop;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_bundle *test_bundle(uint64_t sequence, uint64_t lifetime,
+                               uint64_t age) {
+
+    dtn_bundle *bundle = dtn_bundle_create();
+
+    if (!dtn_bundle_add_primary_block(bundle, 0, 0, "dtn://test/two",
+                                      "dtn://src/1", "dtn://src/1", 0,
+                                      sequence, lifetime, 0, 0))
+        goto error;
+
+    if (!dtn_bundle_add_bundle_age(bundle, age))
+        goto error;
+
+    if (!dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("data")))
+        goto error;
+
+    return bundle;
+error:
+    dtn_bundle_free(bundle);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool test_hold(dtn_node_store *self, const dtn_routing_info *hop,
+                      dtn_bundle *bundle) {
+
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX] = {0};
+    uint8_t *next = NULL;
+
+    if (!dtn_bundle_encode(bundle, buffer, sizeof(buffer), &next))
+        return false;
+
+    return dtn_node_store_hold(self, hop, bundle, buffer, next - buffer);
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST CASES                                                      #CASES
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+int test_dtn_node_store_create() {
+
+    char path[PATH_MAX] = "/tmp/dtn_node_store_XXXXXX";
+    struct sent sent = {0};
+
+    testrun(mkdtemp(path));
+
+    dtn_node_store_config config = test_config(path, &sent);
+
+    config.path[0] = 0;
+    testrun(!dtn_node_store_create(config));
+
+    config = test_config(path, &sent);
+    config.callbacks.send = NULL;
+    testrun(!dtn_node_store_create(config));
+
+    config = test_config(path, &sent);
+    dtn_node_store *self = dtn_node_store_create(config);
+    testrun(self);
+    testrun(self->store);
+    testrun(self->hops.data);
+    testrun(0 == dtn_dict_count(self->hops.data));
+
+    testrun(NULL == dtn_node_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_free() {
+
+    char path[PATH_MAX] = "/tmp/dtn_node_store_XXXXXX";
+    struct sent sent = {0};
+
+    testrun(mkdtemp(path));
+
+    testrun(NULL == dtn_node_store_free(NULL));
+
+    dtn_node_store *self = dtn_node_store_create(test_config(path, &sent));
+    testrun(self);
+
+    dtn_routing_info hop = test_hop("eth0", 4556);
+    dtn_bundle *bundle = test_bundle(1, 1000, 0);
+    testrun(test_hold(self, &hop, bundle));
+    bundle = dtn_bundle_free(bundle);
+
+    testrun(NULL == dtn_node_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_hold() {
+
+    char path[PATH_MAX] = "/tmp/dtn_node_store_XXXXXX";
+    struct sent sent = {0};
+    uint8_t data[] = "bundle";
+
+    testrun(mkdtemp(path));
+
+    dtn_node_store *self = dtn_node_store_create(test_config(path, &sent));
+    testrun(self);
+
+    dtn_routing_info hop = test_hop("eth0", 4556);
+    dtn_bundle *bundle = test_bundle(1, 1000, 0);
+
+    testrun(!dtn_node_store_hold(NULL, &hop, bundle, data, sizeof(data)));
+    testrun(!dtn_node_store_hold(self, NULL, bundle, data, sizeof(data)));
+    testrun(!dtn_node_store_hold(self, &hop, NULL, data, sizeof(data)));
+    testrun(!dtn_node_store_hold(self, &hop, bundle, NULL, sizeof(data)));
+
+    // once per next hop
+
+    testrun(dtn_node_store_hold(self, &hop, bundle, data, sizeof(data)));
+    testrun(!dtn_node_store_hold(self, &hop, bundle, data, sizeof(data)));
+    testrun(1 == dtn_dict_count(self->hops.data));
+
+    hop.remote.port = 4557;
+    testrun(dtn_node_store_hold(self, &hop, bundle, data, sizeof(data)));
+    testrun(2 == dtn_dict_count(self->hops.data));
+
+    // expires with the lifetime left after the age
+
+    bundle = dtn_bundle_free(bundle);
+    bundle = test_bundle(2, 1000, 1000);
+    testrun(!dtn_node_store_hold(self, &hop, bundle, data, sizeof(data)));
+
+    bundle = dtn_bundle_free(bundle);
+    bundle = test_bundle(3, 1000, 999);
+    testrun(dtn_node_store_hold(self, &hop, bundle, data, sizeof(data)));
+
+    usleep(2000);
+    testrun(1 == dtn_bundle_store_expire(self->store));
+
+    bundle = dtn_bundle_free(bundle);
+    testrun(NULL == dtn_node_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_contains() {
+
+    char path[PATH_MAX] = "/tmp/dtn_node_store_XXXXXX";
+    struct sent sent = {0};
+
+    testrun(mkdtemp(path));
+
+    dtn_node_store *self = dtn_node_store_create(test_config(path, &sent));
+    testrun(self);
+
+    dtn_routing_info hop = test_hop("eth0", 4556);
+    dtn_bundle *bundle = test_bundle(1, 1000, 0);
+
+    testrun(!dtn_node_store_contains(NULL, &hop, bundle));
+    testrun(!dtn_node_store_contains(self, NULL, bundle));
+    testrun(!dtn_node_store_contains(self, &hop, NULL));
+    testrun(!dtn_node_store_contains(self, &hop, bundle));
+
+    testrun(test_hold(self, &hop, bundle));
+    testrun(dtn_node_store_contains(self, &hop, bundle));
+    testrun(dtn_bundle_store_contains(
+        self->store, "dtn://src/1|0|1|0|eth0|127.0.0.1:4556"));
+
+    hop.remote.port = 4557;
+    testrun(!dtn_node_store_contains(self, &hop, bundle));
+
+    bundle = dtn_bundle_free(bundle);
+    testrun(NULL == dtn_node_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_release() {
+
+    char path[PATH_MAX] = "/tmp/dtn_node_store_XXXXXX";
+    struct sent sent = {0};
+
+    testrun(mkdtemp(path));
+
+    dtn_node_store *self = dtn_node_store_create(test_config(path, &sent));
+    testrun(self);
+
+    dtn_routing_info eth0 = test_hop("eth0", 4556);
+    dtn_routing_info eth1 = test_hop("eth1", 4557);
+
+    for (uint64_t i = 1; i < 4; i++) {
+
+        dtn_bundle *bundle = test_bundle(i, 1000, 100);
+        testrun(test_hold(self, &eth0, bundle));
+        testrun(test_hold(self, &eth1, bundle));
+        bundle = dtn_bundle_free(bundle);
+    }
+
+    testrun(-1 == dtn_node_store_release(NULL, "eth0"));
+    testrun(-1 == dtn_node_store_release(self, NULL));
+    testrun(0 == dtn_node_store_release(self, "eth2"));
+    testrun(0 == sent.count);
+
+    // rejected bundles are kept
+
+    sent.reject = true;
+    testrun(0 == dtn_node_store_release(self, "eth0"));
+
+    usleep(20000);
+
+    // next hops of the interface only, aged by the time stored
+
+    sent.reject = false;
+    testrun(3 == dtn_node_store_release(self, "eth0"));
+    testrun(3 == sent.count);
+
+    for (size_t i = 0; i < sent.count; i++) {
+        testrun(0 == strcmp(sent.interface[i], "eth0"));
+        testrun(4556 == sent.port[i]);
+        testrun(sent.age[i] >= 120);
+        testrun(sent.age[i] < 1000);
+    }
+
+    testrun(0 == dtn_node_store_release(self, "eth0"));
+
+    sent = (struct sent){0};
+    testrun(3 == dtn_node_store_release(self, "eth1"));
+    testrun(0 == strcmp(sent.interface[0], "eth1"));
+
+    testrun(NULL == dtn_node_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_recover() {
+
+    char path[PATH_MAX] = "/tmp/dtn_node_store_XXXXXX";
+    struct sent sent = {0};
+
+    testrun(mkdtemp(path));
+
+    dtn_node_store *self = dtn_node_store_create(test_config(path, &sent));
+    testrun(self);
+
+    dtn_routing_info eth0 = test_hop("eth0", 4556);
+    dtn_routing_info eth1 = test_hop("eth1", 4557);
+
+    dtn_bundle *bundle = test_bundle(1, 1000, 0);
+    testrun(test_hold(self, &eth0, bundle));
+    testrun(test_hold(self, &eth1, bundle));
+    bundle = dtn_bundle_free(bundle);
+
+    testrun(NULL == dtn_node_store_free(self));
+
+    // next hops of stored bundles are known after restart
+
+    self = dtn_node_store_create(test_config(path, &sent));
+    testrun(self);
+    testrun(2 == dtn_dict_count(self->hops.data));
+
+    testrun(1 == dtn_node_store_release(self, "eth1"));
+    testrun(1 == sent.count);
+    testrun(4557 == sent.port[0]);
+
+    testrun(NULL == dtn_node_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_get_stats() {
+
+    char path[PATH_MAX] = "/tmp/dtn_node_store_XXXXXX";
+    struct sent sent = {0};
+    dtn_bundle_store_stats stats = {0};
+
+    testrun(mkdtemp(path));
+
+    dtn_node_store *self = dtn_node_store_create(test_config(path, &sent));
+    testrun(self);
+
+    testrun(!dtn_node_store_get_stats(NULL, &stats));
+    testrun(!dtn_node_store_get_stats(self, NULL));
+    testrun(dtn_node_store_get_stats(self, &stats));
+    testrun(0 == stats.records);
+
+    dtn_routing_info hop = test_hop("eth0", 4556);
+    dtn_bundle *bundle = test_bundle(1, 1000, 0);
+    testrun(test_hold(self, &hop, bundle));
+    bundle = dtn_bundle_free(bundle);
+
+    testrun(dtn_node_store_get_stats(self, &stats));
+    testrun(1 == stats.records);
+
+    testrun(NULL == dtn_node_store_free(self));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_dtn_time() {
+
+    // 2026-01-01 00:00:00 UTC is 820454400 seconds after 2000-01-01
+
+    uint64_t now = dtn_node_store_dtn_time();
+    testrun(now > 820454400000);
+    testrun(now / 1000 + DTN_EPOCH_UNIX_SECS <= (uint64_t)time(NULL));
+    testrun(now / 1000 + DTN_EPOCH_UNIX_SECS + 1 >= (uint64_t)time(NULL));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_lifetime_left() {
+
+    uint64_t left = 0;
+    uint64_t epoch = (uint64_t)DTN_EPOCH_UNIX_SECS * 1000000;
+
+    dtn_bundle *bundle = test_bundle(1, 1000, 100);
+
+    testrun(!dtn_node_store_lifetime_left(NULL, 0, 0, &left));
+    testrun(!dtn_node_store_lifetime_left(bundle, 0, 0, NULL));
+
+    // creation time 0, lifetime left after the age from the arrival
+
+    testrun(dtn_node_store_lifetime_left(bundle, 5000000, 5000000, &left));
+    testrun(900000 == left);
+    testrun(dtn_node_store_lifetime_left(bundle, 5000000, 5400000, &left));
+    testrun(500000 == left);
+    testrun(!dtn_node_store_lifetime_left(bundle, 5000000, 5900000, &left));
+
+    dtn_bundle_free(bundle);
+    bundle = test_bundle(1, 1000, 1000);
+    testrun(!dtn_node_store_lifetime_left(bundle, 5000000, 5000000, &left));
+    dtn_bundle_free(bundle);
+
+    // creation time set, creation time plus lifetime on the DTN clock,
+    // independent of the arrival and the bundle age
+
+    bundle = dtn_bundle_create();
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 0, "dtn://test/two",
+                                         "dtn://src/1", "dtn://src/1", 2000,
+                                         1, 1000, 0, 0));
+    testrun(dtn_bundle_add_bundle_age(bundle, 900));
+
+    testrun(dtn_node_store_lifetime_left(bundle, 0, epoch + 2000000, &left));
+    testrun(1000000 == left);
+    testrun(dtn_node_store_lifetime_left(bundle, epoch + 2900000,
+                                         epoch + 2900000, &left));
+    testrun(100000 == left);
+    testrun(!dtn_node_store_lifetime_left(bundle, epoch + 2900000,
+                                          epoch + 3000000, &left));
+
+    bundle = dtn_bundle_free(bundle);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_stamp_age() {
+
+    bool aged = false;
+    uint64_t age = 0;
+
+    dtn_bundle *bundle = test_bundle(1, 1000, 100);
+
+    testrun(!dtn_node_store_stamp_age(NULL, 0, 0, &aged));
+    testrun(!dtn_node_store_stamp_age(bundle, 0, 0, NULL));
+
+    // lifetime used up at now, rounded up to milliseconds
+
+    testrun(dtn_node_store_stamp_age(bundle, 1000000, 200000, &aged));
+    testrun(aged);
+    testrun(dtn_bundle_get_bundle_age(bundle, &age));
+    testrun(200 == age);
+
+    testrun(dtn_node_store_stamp_age(bundle, 1000000, 200001, &aged));
+    testrun(dtn_bundle_get_bundle_age(bundle, &age));
+    testrun(201 == age);
+
+    // expired
+
+    testrun(dtn_node_store_stamp_age(bundle, 1000000, 2000000, &aged));
+    testrun(dtn_bundle_get_bundle_age(bundle, &age));
+    testrun(1000 == age);
+
+    // without bundle age block
+
+    dtn_bundle_free(bundle);
+    bundle = dtn_bundle_create();
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 0, "dtn://test/two",
+                                         "dtn://src/1", "dtn://src/1", 0, 1,
+                                         1000, 0, 0));
+
+    testrun(dtn_node_store_stamp_age(bundle, 1000000, 200000, &aged));
+    testrun(!aged);
+
+    bundle = dtn_bundle_free(bundle);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_node_store_restamp_age() {
+
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX] = {0};
+    uint8_t out[DTN_INTERFACE_IP_DATAGRAM_MAX] = {0};
+    uint8_t *next = NULL;
+    size_t length = 0;
+    uint64_t age = 0;
+
+    dtn_bundle *bundle = test_bundle(1, 1000, 100);
+    dtn_bundle *decoded = NULL;
+
+    testrun(dtn_bundle_encode(bundle, buffer, sizeof(buffer), &next));
+    size_t size = next - buffer;
+
+    testrun(!dtn_node_store_restamp_age(NULL, size, 1000000, 500000, out,
+                                        sizeof(out), &length));
+    testrun(!dtn_node_store_restamp_age(buffer, size, 1000000, 500000, NULL,
+                                        sizeof(out), &length));
+    testrun(!dtn_node_store_restamp_age(buffer, size, 1000000, 500000, out,
+                                        sizeof(out), NULL));
+    testrun(!dtn_node_store_restamp_age(buffer, size - 1, 1000000, 500000,
+                                        out, sizeof(out), &length));
+    testrun(!dtn_node_store_restamp_age(buffer, size, 1000000, 500000, out,
+                                        10, &length));
+
+    testrun(dtn_node_store_restamp_age(buffer, size, 1000000, 500000, out,
+                                       sizeof(out), &length));
+    testrun(0 < length);
+
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_decode(out, length, &decoded, &next));
+    testrun(dtn_bundle_get_bundle_age(decoded, &age));
+    testrun(500 == age);
+    decoded = dtn_bundle_free(decoded);
+
+    // without bundle age block, sent as is
+
+    bundle = dtn_bundle_free(bundle);
+    bundle = dtn_bundle_create();
+    testrun(dtn_bundle_add_primary_block(bundle, 0, 0, "dtn://test/two",
+                                         "dtn://src/1", "dtn://src/1", 0, 1,
+                                         1000, 0, 0));
+    testrun(dtn_bundle_add_block(bundle, 1, 1, 0, 0,
+                                 dtn_cbor_string("data")));
+    testrun(dtn_bundle_encode(bundle, buffer, sizeof(buffer), &next));
+
+    testrun(dtn_node_store_restamp_age(buffer, next - buffer, 1000000,
+                                       500000, out, sizeof(out), &length));
+    testrun(0 == length);
+
+    bundle = dtn_bundle_free(bundle);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int all_tests() {
+
+    testrun_init();
+    testrun_test(test_dtn_node_store_create);
+    testrun_test(test_dtn_node_store_free);
+    testrun_test(test_dtn_node_store_hold);
+    testrun_test(test_dtn_node_store_contains);
+    testrun_test(test_dtn_node_store_release);
+    testrun_test(test_dtn_node_store_recover);
+    testrun_test(test_dtn_node_store_get_stats);
+    testrun_test(test_dtn_node_store_dtn_time);
+    testrun_test(test_dtn_node_store_lifetime_left);
+    testrun_test(test_dtn_node_store_stamp_age);
+    testrun_test(test_dtn_node_store_restamp_age);
+
+    return testrun_counter;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TEST EXECUTION                                                  #EXEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+testrun_run(all_tests);
@@ -268,6 +268,8 @@ dtn_router_app *dtn_router_app_create(dtn_router_app_config config) {
 
     strncpy(core.name, config.name, PATH_MAX);
     strncpy(core.route_config_path, config.route_config_path, PATH_MAX);
+    strncpy(core.store_path, config.store_path, PATH_MAX);
+    strncpy(core.contact_plan_path, config.contact_plan_path, PATH_MAX);
 
     self->core = dtn_router_core_create(core);
     if (!self->core)
@@ -337,6 +339,10 @@ dtn_router_app_config dtn_router_app_config_from_item(const dtn_item *input) {
     config.password =
         dtn_password_from_item(dtn_item_object_get(conf, "password"));
 
+    str = dtn_item_get_string(dtn_item_get(conf, "store"));
+    if (str)
+        strncpy(config.store_path, str, PATH_MAX);
+
     conf = dtn_item_get(input, "/dtn/routes/path");
     if (conf) {
 
@@ -344,6 +350,10 @@ dtn_router_app_config dtn_router_app_config_from_item(const dtn_item *input) {
         strncpy(config.route_config_path, str, PATH_MAX);
     }
 
+    str = dtn_item_get_string(dtn_item_get(input, "/dtn/routes/contacts"));
+    if (str)
+        strncpy(config.contact_plan_path, str, PATH_MAX);
+
     return config;
 }
 
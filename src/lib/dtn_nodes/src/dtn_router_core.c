@@ -28,80 +28,760 @@
         ------------------------------------------------------------------------
 */
 #include "../include/dtn_router_core.h"
+#include "../include/dtn_node_store.h"
 
+#include <dtn/dtn_cgr.h>
+#include <dtn/dtn_duplicate_filter.h>
 #include <dtn/dtn_interface_ip.h>
 #include <dtn/dtn_routing.h>
 
 #include <dtn_base/dtn_dict.h>
 #include <dtn_base/dtn_garbadge_colloctor.h>
+#include <dtn_base/dtn_linked_list.h>
 #include <dtn_base/dtn_string.h>
 #include <dtn_base/dtn_thread_lock.h>
 #include <dtn_base/dtn_thread_loop.h>
 #include <dtn_base/dtn_thread_message.h>
+#include <dtn_base/dtn_time.h>
 #include <dtn_base/dtn_utils.h>
 
+#include <inttypes.h>
+#include <stdatomic.h>
+
 /*---------------------------------------------------------------------------*/
 
-#define DTN_ROUTER_CORE_MAGIC_BYTE 0xc423
+#define DTN_ROUTER_CORE_MAGIC_BYTE 0xc423
+
+// bundle ids of source, timestamp, sequence and offset
+#define KEY_MAX 512
+
+typedef enum ThreadMessageType {
+
+    BUNDLE_IO = 0,
+    STATE_CHANGE,
+    CONTACT_START
+
+} ThreadMessageType;
+
+/*---------------------------------------------------------------------------*/
+
+struct dtn_router_core {
+
+    uint16_t magic_byte;
+    dtn_router_core_config config;
+
+    dtn_garbadge_colloctor *garbadge;
+
+    dtn_thread_loop *tloop;
+
+    dtn_routing *routing;
+    dtn_node_store *store;
+    dtn_cgr *cgr;
+
+    struct {
+
+        dtn_thread_lock lock_ip;
+        dtn_dict *ip;
+
+    } interfaces;
+
+    struct {
+
+        dtn_thread_lock lock;
+        dtn_duplicate_filter *filter;
+
+    } duplicates;
+
+    struct {
+
+        dtn_thread_lock lock;
+        dtn_dict *data;
+
+    } contacts;
+
+    struct {
+
+        // earliest start of held contacts scheduled at the loop
+        atomic_uint_fast64_t next_usec;
+
+        // timer of the loop, used in the loop thread only
+        uint32_t timer;
+        uint64_t timer_usec;
+
+    } starts;
+
+    struct {
+
+        atomic_uint_fast64_t forwarded;
+        atomic_uint_fast64_t held;
+        atomic_uint_fast64_t duplicates;
+        atomic_uint_fast64_t expired;
+        atomic_uint_fast64_t unroutable;
+        atomic_uint_fast64_t dropped;
+        atomic_uint_fast64_t spilled;
+
+    } stats;
+};
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Interface {
+
+    dtn_thread_lock lock;
+    char name[DTN_HOST_NAME_MAX];
+    dtn_ip_link_state state;
+
+    dtn_interface_ip *interface;
+
+} Interface;
+
+/*----------------------------------------------------------------------------*/
+
+static void *interface_free(void *data) {
+
+    if (!data)
+        return NULL;
+
+    Interface *self = (Interface *)data;
+    if (!dtn_thread_lock_try_lock(&self->lock))
+        goto error;
+    self->interface = dtn_interface_ip_free(self->interface);
+    if (!dtn_thread_lock_unlock(&self->lock)) {
+        dtn_log_error("failed to unlock interface.");
+    }
+    dtn_thread_lock_clear(&self->lock);
+    self = dtn_data_pointer_free(self);
+error:
+    return self;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      FORWARDING
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+typedef struct Held {
+
+    dtn_buffer *buffer;
+    uint64_t opens_usec; // start of the first contact of the route
+    uint64_t expires_usec;
+    bool aged; // with bundle age block, stamped again when sent
+
+} Held;
+
+/*----------------------------------------------------------------------------*/
+
+static void *held_free(void *data) {
+
+    Held *self = (Held *)data;
+    if (!self)
+        return NULL;
+
+    self->buffer = dtn_buffer_free(self->buffer);
+    return dtn_data_pointer_free(self);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool contact_start_schedule(dtn_router_core *self, uint64_t start_usec);
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct Contact {
+
+    dtn_routing_info hop;
+
+    dtn_list *queue;
+    uint64_t held;
+
+} Contact;
+
+/*----------------------------------------------------------------------------*/
+
+static void *contact_free(void *data) {
+
+    Contact *self = (Contact *)data;
+    if (!self)
+        return NULL;
+
+    self->queue = dtn_list_free(self->queue);
+    return dtn_data_pointer_free(self);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static Contact *contact_create(const dtn_routing_info *route) {
+
+    Contact *self = calloc(1, sizeof(Contact));
+    if (!self)
+        goto error;
+
+    self->hop = *route;
+
+    self->queue = dtn_linked_list_create(
+        (dtn_list_config){.item.free = held_free});
+
+    if (!self->queue)
+        goto error;
+
+    return self;
+error:
+    contact_free(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool is_duplicate(dtn_router_core *self, const char *id,
+                         uint64_t now_usec) {
+
+    if (0 == id[0])
+        return false;
+
+    size_t size = strlen(id);
+
+    if (!dtn_thread_lock_try_lock(&self->duplicates.lock))
+        return false;
+
+    bool result = dtn_duplicate_filter_contains(self->duplicates.filter, id,
+                                                size, now_usec);
+
+    if (!dtn_thread_lock_unlock(&self->duplicates.lock)) {
+        dtn_log_error("failed to unlock duplicates.");
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool remember_bundle(dtn_router_core *self, const char *id,
+                            uint64_t now_usec) {
+
+    // only accepted bundles are remembered, a bundle dropped as expired
+    // or unroutable is forwarded once it is sent again
+
+    if (0 == id[0])
+        return true;
+
+    if (!dtn_thread_lock_try_lock(&self->duplicates.lock))
+        return false;
+
+    bool result = dtn_duplicate_filter_add(self->duplicates.filter, id,
+                                           strlen(id), now_usec);
+
+    if (!dtn_thread_lock_unlock(&self->duplicates.lock)) {
+        dtn_log_error("failed to unlock duplicates.");
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t real_time_usecs() {
+
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool check_lifetime(dtn_bundle *bundle, uint64_t received_usec,
+                           uint64_t now_usec, uint64_t *expires_usec) {
+
+    // lifetimes are on the DTN clock, expiry is kept at the monotonic
+    // clock of the contact queues
+
+    uint64_t now = real_time_usecs();
+    uint64_t waited = now_usec > received_usec ? now_usec - received_usec : 0;
+    uint64_t left = 0;
+
+    if (waited > now)
+        waited = now;
+
+    if (!dtn_node_store_lifetime_left(bundle, now - waited, now, &left))
+        return false;
+
+    *expires_usec = now_usec + left;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool check_hop_count(dtn_bundle *bundle) {
+
+    uint64_t count = 0;
+    uint64_t limit = 0;
+
+    if (!dtn_bundle_get_hop_count(bundle, &count, &limit))
+        return true;
+
+    if (count + 1 > limit)
+        return false;
+
+    return dtn_bundle_set_hop_count(bundle, count + 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool route_for_bundle(dtn_router_core *self, const dtn_bundle *bundle,
+                             uint64_t size, dtn_routing_info *route,
+                             uint64_t *start_usec) {
+
+    dtn_routing_info routes[DTN_ROUTING_LOOKUP_MAX];
+    uint64_t starts[DTN_ROUTING_LOOKUP_MAX];
+    const dtn_routing_info *usable = NULL;
+
+    const char *destination = dtn_bundle_primary_get_destination(bundle);
+
+    // routes of the contact plan first, earliest arrival first,
+    // with the start of the first contact in real time
+
+    int64_t count = 0;
+    *start_usec = 0;
+
+    if (self->cgr)
+        count = dtn_cgr_lookup(self->cgr, destination, real_time_usecs(),
+                               size, routes, starts, DTN_ROUTING_LOOKUP_MAX);
+
+    for (int64_t i = 0; i < count; i++) {
+
+        if ((0 != routes[i].interface[0]) && (0 != routes[i].remote.host[0])) {
+            *route = routes[i];
+            *start_usec = starts[i];
+            return true;
+        }
+    }
+
+    count = dtn_routing_lookup(self->routing, destination, routes,
+                               DTN_ROUTING_LOOKUP_MAX);
+
+    // direct routes before routes of the node name
+
+    for (int64_t i = 0; i < count; i++) {
+
+        const dtn_routing_info *info = &routes[i];
+
+        if ((0 == info->interface[0]) || (0 == info->remote.host[0]))
+            continue;
+
+        if (!usable || (DTN_ROUTING_DIRECT == info->class))
+            usable = info;
+    }
+
+    if (!usable)
+        return false;
+
+    *route = *usable;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool interface_send(dtn_router_core *self, const dtn_routing_info *hop,
+                           const uint8_t *buffer, size_t size) {
+
+    bool result = false;
+
+    if (!dtn_thread_lock_try_lock(&self->interfaces.lock_ip))
+        goto error;
+
+    Interface *in = dtn_dict_get(self->interfaces.ip, hop->interface);
+
+    if (in && dtn_thread_lock_try_lock(&in->lock)) {
+
+        if (DTN_IP_LINK_UP == in->state)
+            result = dtn_interface_ip_send_to(in->interface, hop->remote,
+                                              &hop->address, buffer, size);
+
+        if (!dtn_thread_lock_unlock(&in->lock)) {
+            dtn_log_error("failed to unlock interface.");
+        }
+    }
+
+    if (!dtn_thread_lock_unlock(&self->interfaces.lock_ip)) {
+        dtn_log_error("failed to unlock IP interfaces.");
+    }
+
+error:
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool interface_is_up(dtn_router_core *self, const char *name) {
+
+    bool result = false;
+
+    if (!dtn_thread_lock_try_lock(&self->interfaces.lock_ip))
+        goto error;
+
+    Interface *in = dtn_dict_get(self->interfaces.ip, name);
+
+    if (in && dtn_thread_lock_try_lock(&in->lock)) {
+
+        result = (DTN_IP_LINK_UP == in->state);
+
+        if (!dtn_thread_lock_unlock(&in->lock)) {
+            dtn_log_error("failed to unlock interface.");
+        }
+    }
+
+    if (!dtn_thread_lock_unlock(&self->interfaces.lock_ip)) {
+        dtn_log_error("failed to unlock IP interfaces.");
+    }
+
+error:
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool contact_hold(dtn_router_core *self, Contact *contact,
+                         const uint8_t *buffer, size_t size,
+                         uint64_t opens_usec, uint64_t expires_usec,
+                         bool aged) {
+
+    Held *held = NULL;
+
+    if (contact->held >= self->config.limits.contact_queue)
+        goto error;
+
+    held = calloc(1, sizeof(Held));
+    if (!held)
+        goto error;
+
+    held->opens_usec = opens_usec;
+    held->expires_usec = expires_usec;
+    held->aged = aged;
+    held->buffer = dtn_buffer_create(size);
+
+    if (!dtn_buffer_push(held->buffer, (uint8_t *)buffer, size))
+        goto error;
+
+    if (!dtn_list_queue_push(contact->queue, held))
+        goto error;
+
+    contact->held++;
+    atomic_fetch_add(&self->stats.held, 1);
+    return true;
+error:
+    held_free(held);
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct container_flush {
+
+    dtn_router_core *self;
+    const char *interface;
+    uint64_t now_usec;
+    uint64_t next_usec; // earliest start of a contact not open yet
+};
+
+/*----------------------------------------------------------------------------*/
+
+static bool held_send(dtn_router_core *self, Contact *contact, Held *held,
+                      uint64_t now_usec) {
+
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX];
+
+    const uint8_t *data = held->buffer->start;
+    size_t size = held->buffer->length;
+
+    if (held->aged) {
+
+        if (!dtn_node_store_restamp_age(
+                held->buffer->start, held->buffer->length, held->expires_usec,
+                now_usec, buffer, sizeof(buffer), &size)) {
+
+            atomic_fetch_add(&self->stats.dropped, 1);
+            return true;
+        }
+
+        if (0 != size)
+            data = buffer;
+        else
+            size = held->buffer->length;
+    }
+
+    if (!interface_send(self, &contact->hop, data, size))
+        return false;
+
+    atomic_fetch_add(&self->stats.forwarded, 1);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool contact_flush(const void *key, void *val, void *data) {
+
+    if (!key)
+        return true;
+
+    Contact *contact = (Contact *)val;
+    struct container_flush *container = (struct container_flush *)data;
+    dtn_router_core *self = container->self;
+    uint64_t now_usec = container->now_usec;
+
+    if (!contact || (0 == contact->held))
+        return true;
+
+    if (0 != strcmp(contact->hop.interface, container->interface))
+        return true;
+
+    if (!interface_is_up(self, contact->hop.interface))
+        return true;
+
+    bool lost = false;
+
+    // each held bundle is taken once, bundles kept are queued again
+    // behind the bundles not taken yet, which keeps their order
+
+    for (uint64_t count = contact->held; count > 0; count--) {
+
+        Held *held = dtn_list_queue_pop(contact->queue);
+        if (!held)
+            break;
+
+        bool expired = (held->expires_usec <= now_usec);
+        bool waiting = !expired && (held->opens_usec > now_usec);
+
+        if (waiting && ((0 == container->next_usec) ||
+                        (held->opens_usec < container->next_usec)))
+            container->next_usec = held->opens_usec;
+
+        if (!expired && !waiting && !lost) {
+
+            // link lost again, keep the rest for the next link up
+
+            lost = !held_send(self, contact, held, now_usec);
+
+            if (!lost) {
+                held = held_free(held);
+                contact->held--;
+                atomic_fetch_sub(&self->stats.held, 1);
+                continue;
+            }
+        }
+
+        if (!expired && dtn_list_queue_push(contact->queue, held))
+            continue;
+
+        atomic_fetch_add(expired ? &self->stats.expired : &self->stats.dropped,
+                         1);
+
+        held = held_free(held);
+        contact->held--;
+        atomic_fetch_sub(&self->stats.held, 1);
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool contact_spill(dtn_router_core *self,
+                          const dtn_routing_info *route, dtn_bundle *bundle,
+                          const uint8_t *buffer, size_t size) {
+
+    if (!dtn_node_store_hold(self->store, route, bundle, buffer, size))
+        return false;
+
+    atomic_fetch_add(&self->stats.spilled, 1);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool contact_enqueue(dtn_router_core *self,
+                            const dtn_routing_info *route, dtn_bundle *bundle,
+                            const uint8_t *buffer, size_t size,
+                            uint64_t now_usec, uint64_t opens_usec,
+                            uint64_t expires_usec, bool aged) {
+
+    char key[DTN_ROUTING_KEY_MAX] = {0};
+    bool sent = false;
+    bool held = false;
+    bool spilled = false;
+
+    dtn_routing_info_to_key(route, key, DTN_ROUTING_KEY_MAX);
 
-typedef enum ThreadMessageType {
+    if (!dtn_thread_lock_try_lock(&self->contacts.lock))
+        goto done;
 
-    BUNDLE_IO = 0,
-    STATE_CHANGE
+    // held bundles of the next hop go first, bundles are sent once the
+    // first contact of their route started
 
-} ThreadMessageType;
+    Contact *contact = dtn_dict_get(self->contacts.data, key);
 
-/*---------------------------------------------------------------------------*/
+    if ((opens_usec <= now_usec) && (!contact || (0 == contact->held)))
+        sent = interface_send(self, route, buffer, size);
 
-struct dtn_router_core {
+    if (!sent && !contact) {
 
-    uint16_t magic_byte;
-    dtn_router_core_config config;
+        contact = contact_create(route);
+        char *name = dtn_string_dup(key);
 
-    dtn_garbadge_colloctor *garbadge;
+        if (!contact || !name ||
+            !dtn_dict_set(self->contacts.data, name, contact, NULL)) {
 
-    dtn_thread_loop *tloop;
+            contact = contact_free(contact);
+            name = dtn_data_pointer_free(name);
+        }
+    }
 
-    dtn_routing *routing;
+    if (!sent && contact)
+        held = contact_hold(self, contact, buffer, size, opens_usec,
+                            expires_usec, aged);
 
-    struct {
+    if (!sent && !held)
+        spilled = contact_spill(self, route, bundle, buffer, size);
 
-        dtn_thread_lock lock_ip;
-        dtn_dict *ip;
+    struct container_flush container = (struct container_flush){
+        .self = self, .interface = route->interface, .now_usec = now_usec};
 
-    } interfaces;
-};
+    if (held)
+        contact_flush(key, contact, &container);
+
+    if (!dtn_thread_lock_unlock(&self->contacts.lock)) {
+        dtn_log_error("failed to unlock contacts.");
+    }
+
+    if (0 != container.next_usec)
+        contact_start_schedule(self, container.next_usec);
+
+done:
+
+    if (sent) {
+        atomic_fetch_add(&self->stats.forwarded, 1);
+    } else if (!held && !spilled) {
+        atomic_fetch_add(&self->stats.dropped, 1);
+    }
+
+    return sent || held || spilled;
+}
 
 /*----------------------------------------------------------------------------*/
 
-typedef struct Interface {
+static bool store_send(void *userdata, const dtn_routing_info *hop,
+                       const uint8_t *data, size_t size) {
 
-    dtn_thread_lock lock;
-    char name[DTN_HOST_NAME_MAX];
-    dtn_ip_link_state state;
+    dtn_router_core *self = (dtn_router_core *)userdata;
 
-    dtn_interface_ip *interface;
+    if (!interface_send(self, hop, data, size))
+        return false;
 
-} Interface;
+    atomic_fetch_add(&self->stats.forwarded, 1);
+    return true;
+}
 
 /*----------------------------------------------------------------------------*/
 
-static void *interface_free(void *data) {
+static bool contacts_flush(dtn_router_core *self, const char *interface) {
 
-    if (!data)
-        return NULL;
+    struct container_flush container = (struct container_flush){
+        .self = self,
+        .interface = interface,
+        .now_usec = dtn_time_get_current_time_usecs()};
 
-    Interface *self = (Interface *)data;
-    if (!dtn_thread_lock_try_lock(&self->lock))
+    if (!dtn_thread_lock_try_lock(&self->contacts.lock))
         goto error;
-    self->interface = dtn_interface_ip_free(self->interface);
-    if (!dtn_thread_lock_unlock(&self->lock)) {
-        dtn_log_error("failed to unlock interface.");
+
+    bool result =
+        dtn_dict_for_each(self->contacts.data, &container, contact_flush);
+
+    if (!dtn_thread_lock_unlock(&self->contacts.lock)) {
+        dtn_log_error("failed to unlock contacts.");
     }
-    dtn_thread_lock_clear(&self->lock);
-    self = dtn_data_pointer_free(self);
+
+    if (0 != container.next_usec)
+        contact_start_schedule(self, container.next_usec);
+
+    // spilled bundles are newer than the held ones
+
+    if (self->store && interface_is_up(self, interface) &&
+        (0 > dtn_node_store_release(self->store, interface)))
+        result = false;
+
+    return result;
 error:
-    return self;
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool forward_bundle(dtn_router_core *self, dtn_bundle *bundle,
+                           uint64_t received_usec) {
+
+    char id[KEY_MAX] = {0};
+    dtn_routing_info route = {0};
+    uint64_t start_usec = 0;
+    uint64_t opens_usec = 0;
+    uint64_t expires_usec = 0;
+    bool aged = false;
+
+    // encoded in one pass, larger datagrams are not received by peers
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX];
+    uint8_t *next = NULL;
+
+    if (!dtn_router_core_cast(self) || !bundle)
+        goto error;
+
+    uint64_t now_usec = dtn_time_get_current_time_usecs();
+
+    dtn_bundle_primary_get_id(bundle, id, KEY_MAX);
+
+    if (is_duplicate(self, id, now_usec)) {
+        atomic_fetch_add(&self->stats.duplicates, 1);
+        goto error;
+    }
+
+    if (!check_lifetime(bundle, received_usec, now_usec, &expires_usec) ||
+        !check_hop_count(bundle)) {
+        atomic_fetch_add(&self->stats.expired, 1);
+        goto error;
+    }
+
+    // age as received plus the time spent at this node
+
+    if (!dtn_node_store_stamp_age(bundle, expires_usec, now_usec, &aged) ||
+        !dtn_bundle_encode(bundle, buffer, sizeof(buffer), &next)) {
+        atomic_fetch_add(&self->stats.dropped, 1);
+        goto error;
+    }
+
+    // encoded size is used by routes of the contact plan
+
+    if (!route_for_bundle(self, bundle, next - buffer, &route, &start_usec)) {
+        atomic_fetch_add(&self->stats.unroutable, 1);
+        goto error;
+    }
+
+    // start of the first contact at the monotonic clock of the queues
+
+    uint64_t real_usec = real_time_usecs();
+
+    if (start_usec > real_usec)
+        opens_usec = now_usec + (start_usec - real_usec);
+
+    bool result = contact_enqueue(self, &route, bundle, buffer, next - buffer,
+                                  now_usec, opens_usec, expires_usec, aged);
+
+    if (result)
+        remember_bundle(self, id, now_usec);
+
+    dtn_bundle_free(bundle);
+    return result;
+error:
+    dtn_bundle_free(bundle);
+    return false;
 }
 
 /*
@@ -121,6 +801,8 @@ typedef struct Threadmessage {
     dtn_bundle *bundle;
     dtn_socket_data remote;
     char *interface;
+    uint64_t received_usec;
+    uint64_t start_usec;
 
 } Threadmessage;
 
@@ -173,6 +855,7 @@ static dtn_thread_message *thread_message_create(dtn_bundle *bundle,
     msg->generic.free = thread_message_free;
 
     msg->type = BUNDLE_IO;
+    msg->received_usec = dtn_time_get_current_time_usecs();
     msg->bundle = bundle;
     msg->remote = *remote;
     msg->interface = dtn_string_dup(name);
@@ -181,14 +864,123 @@ static dtn_thread_message *thread_message_create(dtn_bundle *bundle,
 
 /*----------------------------------------------------------------------------*/
 
+static dtn_thread_message *thread_message_start_create(uint64_t start_usec) {
+
+    Threadmessage *msg = calloc(1, sizeof(Threadmessage));
+    if (!msg)
+        return NULL;
+
+    msg->generic.magic_bytes = DTN_THREAD_MESSAGE_MAGIC_BYTES;
+    msg->generic.type = 1;
+    msg->generic.free = thread_message_free;
+
+    msg->type = CONTACT_START;
+    msg->start_usec = start_usec;
+    return dtn_thread_message_cast(msg);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool contact_start_schedule(dtn_router_core *self, uint64_t start_usec) {
+
+    // only starts before the start scheduled already go to the loop
+
+    uint_fast64_t next = atomic_load(&self->starts.next_usec);
+
+    do {
+
+        if ((0 != next) && (next <= start_usec))
+            return true;
+
+    } while (!atomic_compare_exchange_weak(&self->starts.next_usec, &next,
+                                           start_usec));
+
+    dtn_thread_message *msg = thread_message_start_create(start_usec);
+    if (!msg)
+        goto error;
+
+    if (!dtn_thread_loop_send_message(self->tloop, msg,
+                                      DTN_RECEIVER_EVENT_LOOP)) {
+        msg = dtn_thread_message_free(msg);
+        goto error;
+    }
+
+    return true;
+error:
+    // scheduled again with the next bundle held for a later contact
+    atomic_compare_exchange_strong(&self->starts.next_usec, &start_usec, 0);
+    dtn_log_error("failed to schedule the start of a contact");
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool contact_start_timer(uint32_t id, void *data) {
+
+    UNUSED(id);
+
+    dtn_router_core *self = dtn_router_core_cast(data);
+    if (!self)
+        return false;
+
+    self->starts.timer = DTN_TIMER_INVALID;
+    self->starts.timer_usec = 0;
+    atomic_store(&self->starts.next_usec, 0);
+
+    // flushed in the threads, which schedule the next start
+
+    dtn_thread_message *msg = thread_message_start_create(0);
+    if (!msg)
+        return false;
+
+    if (!dtn_thread_loop_send_message(self->tloop, msg, DTN_RECEIVER_THREAD)) {
+        msg = dtn_thread_message_free(msg);
+        return false;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
 static bool handle_in_loop(dtn_thread_loop *tloop, dtn_thread_message *msg) {
 
     dtn_router_core *self = dtn_thread_loop_get_data(tloop);
-    if (!self || !msg)
+    if (!self || !msg || (msg->type != 1))
         goto error;
 
-    TODO("... to be implemented.");
+    Threadmessage *message = (Threadmessage *)msg;
+
+    if (CONTACT_START != message->type)
+        goto done;
+
+    // one timer at the earliest start scheduled
+
+    if ((DTN_TIMER_INVALID != self->starts.timer) &&
+        (self->starts.timer_usec <= message->start_usec))
+        goto done;
+
+    if (DTN_TIMER_INVALID != self->starts.timer)
+        dtn_event_loop_timer_unset(self->config.loop, self->starts.timer, NULL);
+
+    uint64_t now_usec = dtn_time_get_current_time_usecs();
+    uint64_t relative_usec = 1;
+
+    if (message->start_usec > now_usec)
+        relative_usec = message->start_usec - now_usec;
+
+    self->starts.timer = dtn_event_loop_timer_set(
+        self->config.loop, relative_usec, self, contact_start_timer);
+
+    self->starts.timer_usec = message->start_usec;
+
+    if (DTN_TIMER_INVALID == self->starts.timer) {
+        self->starts.timer_usec = 0;
+        atomic_store(&self->starts.next_usec, 0);
+        dtn_log_error("failed to set the timer of a contact start");
+    }
 
+done:
     dtn_thread_message_free(msg);
     return true;
 error:
@@ -206,11 +998,12 @@ static bool message_bundle_process(dtn_router_core *self, Threadmessage *msg) {
     dtn_log_debug("THREAD IO at %s from %s:%i", msg->interface,
                   msg->remote.host, msg->remote.port);
 
-    fprintf(stderr, "DUMP INCOMING BUNDLE\n");
-    dtn_bundle_dump(stderr, msg->bundle);
-    fprintf(stderr, "\n");
+    dtn_bundle *bundle = msg->bundle;
+    msg->bundle = NULL;
 
-    TODO(" ... process message.");
+    if (!forward_bundle(self, bundle, msg->received_usec))
+        dtn_log_debug("bundle from %s:%i not forwarded", msg->remote.host,
+                      msg->remote.port);
 
     dtn_thread_message_free(dtn_thread_message_cast(msg));
     return true;
@@ -247,7 +1040,11 @@ static bool message_state_change_process(dtn_router_core *self,
 
     dtn_log_debug("THREAD IO STATE CHANGE at %s to %s", msg->interface, string);
 
-    TODO("... process state change");
+    if ((DTN_IP_LINK_UP == msg->state) &&
+        !contacts_flush(self, msg->interface)) {
+
+        dtn_log_error("failed to flush contacts of %s", msg->interface);
+    }
 
     dtn_thread_message_free(dtn_thread_message_cast(msg));
     return true;
@@ -259,6 +1056,68 @@ error:
 
 /*---------------------------------------------------------------------------*/
 
+static bool collect_interface(const void *key, void *val, void *data) {
+
+    if (!key)
+        return true;
+
+    UNUSED(val);
+
+    char *name = dtn_string_dup((const char *)key);
+
+    if (!name || !dtn_list_push((dtn_list *)data, name)) {
+        dtn_data_pointer_free(name);
+        return false;
+    }
+
+    return true;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool message_contact_start_process(dtn_router_core *self,
+                                          Threadmessage *msg) {
+
+    bool result = false;
+
+    dtn_list *names = dtn_linked_list_create(
+        (dtn_list_config){.item.free = dtn_data_pointer_free});
+
+    if (!self || !msg || !names)
+        goto done;
+
+    dtn_log_debug("THREAD CONTACT START");
+
+    // names are collected first, flushing looks up the interfaces
+
+    if (!dtn_thread_lock_try_lock(&self->interfaces.lock_ip))
+        goto done;
+
+    result = dtn_dict_for_each(self->interfaces.ip, names, collect_interface);
+
+    if (!dtn_thread_lock_unlock(&self->interfaces.lock_ip)) {
+        dtn_log_error("failed to unlock IP interfaces.");
+    }
+
+    char *name = dtn_list_pop(names);
+
+    while (name) {
+
+        if (!contacts_flush(self, name))
+            dtn_log_error("failed to flush contacts of %s", name);
+
+        name = dtn_data_pointer_free(name);
+        name = dtn_list_pop(names);
+    }
+
+done:
+    dtn_list_free(names);
+    dtn_thread_message_free(dtn_thread_message_cast(msg));
+    return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static bool handle_in_thread(dtn_thread_loop *tloop, dtn_thread_message *msg) {
 
     dtn_router_core *self = dtn_thread_loop_get_data(tloop);
@@ -279,6 +1138,10 @@ static bool handle_in_thread(dtn_thread_loop *tloop, dtn_thread_message *msg) {
     case STATE_CHANGE:
         return message_state_change_process(self, message);
         break;
+
+    case CONTACT_START:
+        return message_contact_start_process(self, message);
+        break;
     }
 
     dtn_thread_message_free(msg);
@@ -304,6 +1167,17 @@ static bool init_config(dtn_router_core_config *config) {
     if (0 == config->limits.link_check)
         config->limits.link_check = 1000000;
 
+    if (0 == config->limits.contact_queue)
+        config->limits.contact_queue = DTN_ROUTER_CORE_CONTACT_QUEUE;
+
+    if (0 == config->limits.duplicate_history_usec)
+        config->limits.duplicate_history_usec =
+            DTN_ROUTER_CORE_DUPLICATE_HISTORY_USEC;
+
+    if (0 == config->limits.duplicate_memory_bytes)
+        config->limits.duplicate_memory_bytes =
+            DTN_ROUTER_CORE_DUPLICATE_MEMORY;
+
     if (0 == config->limits.threads) {
 
         long numofcpus = sysconf(_SC_NPROCESSORS_ONLN);
@@ -359,6 +1233,7 @@ dtn_router_core *dtn_router_core_create(dtn_router_core_config config) {
         goto error;
 
     dtn_dict_config d_config = dtn_dict_string_key_config(255);
+    d_config.type = DTN_DICT_FLAT;
     d_config.value.data_function.free = interface_free;
 
     self->interfaces.ip = dtn_dict_create(d_config);
@@ -369,6 +1244,30 @@ dtn_router_core *dtn_router_core_create(dtn_router_core_config config) {
                               self->config.limits.threadlock_timeout_usec))
         goto error;
 
+    if (!dtn_thread_lock_init(&self->duplicates.lock,
+                              self->config.limits.threadlock_timeout_usec))
+        goto error;
+
+    self->duplicates.filter =
+        dtn_duplicate_filter_create((dtn_duplicate_filter_config){
+            .type = DTN_DUPLICATE_FILTER_EXACT,
+            .history_usecs = self->config.limits.duplicate_history_usec,
+            .memory_bytes = self->config.limits.duplicate_memory_bytes});
+
+    if (!self->duplicates.filter)
+        goto error;
+
+    d_config = dtn_dict_string_key_config(255);
+    d_config.value.data_function.free = contact_free;
+
+    self->contacts.data = dtn_dict_create(d_config);
+    if (!self->contacts.data)
+        goto error;
+
+    if (!dtn_thread_lock_init(&self->contacts.lock,
+                              self->config.limits.threadlock_timeout_usec))
+        goto error;
+
     self->garbadge = dtn_garbadge_colloctor_create((
         dtn_garbadge_colloctor_config){
         .loop = config.loop,
@@ -390,6 +1289,37 @@ dtn_router_core *dtn_router_core_create(dtn_router_core_config config) {
     if (!self->routing)
         goto error;
 
+    if (0 != self->config.store_path[0]) {
+
+        dtn_node_store_config store = (dtn_node_store_config){
+            .limits.threadlock_timeout_usecs =
+                self->config.limits.threadlock_timeout_usec,
+            .callbacks.userdata = self,
+            .callbacks.send = store_send};
+
+        strncpy(store.path, self->config.store_path, PATH_MAX - 1);
+
+        self->store = dtn_node_store_create(store);
+        if (!self->store)
+            goto error;
+    }
+
+    if (0 != self->config.contact_plan_path[0]) {
+
+        dtn_cgr_config cgr = (dtn_cgr_config){
+            .limits.threadlock_timeout_usecs =
+                self->config.limits.threadlock_timeout_usec};
+
+        strncpy(cgr.node, self->config.name, DTN_CGR_NODE_MAX - 1);
+
+        self->cgr = dtn_cgr_create(cgr);
+        if (!self->cgr)
+            goto error;
+
+        if (!dtn_cgr_load(self->cgr, self->config.contact_plan_path))
+            goto error;
+    }
+
     return self;
 error:
     dtn_router_core_free(self);
@@ -403,11 +1333,24 @@ dtn_router_core *dtn_router_core_free(dtn_router_core *self) {
     if (!dtn_router_core_cast(self))
         return self;
 
+    // threads first, they forward at interfaces and contacts
+    self->tloop = dtn_thread_loop_free(self->tloop);
+
+    if (DTN_TIMER_INVALID != self->starts.timer)
+        dtn_event_loop_timer_unset(self->config.loop, self->starts.timer, NULL);
+
     dtn_thread_lock_clear(&self->interfaces.lock_ip);
+    dtn_thread_lock_clear(&self->duplicates.lock);
+    dtn_thread_lock_clear(&self->contacts.lock);
 
     self->garbadge = dtn_garbadge_colloctor_free(self->garbadge);
     self->interfaces.ip = dtn_dict_free(self->interfaces.ip);
-    self->tloop = dtn_thread_loop_free(self->tloop);
+    self->contacts.data = dtn_dict_free(self->contacts.data);
+    self->duplicates.filter =
+        dtn_duplicate_filter_free(self->duplicates.filter);
+    self->routing = dtn_routing_free(self->routing);
+    self->store = dtn_node_store_free(self->store);
+    self->cgr = dtn_cgr_free(self->cgr);
     self = dtn_data_pointer_free(self);
     return NULL;
 }
@@ -775,12 +1718,12 @@ bool dtn_router_core_send_raw(dtn_router_core *self,
     if (!self || !data)
         return false;
 
-    uint64_t size = dtn_cbor_encoding_size(data);
-    uint8_t buffer[size + 1];
-    memset(buffer, 0, size + 1);
+    // encoded in one pass, larger datagrams are not received by peers
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX];
     uint8_t *next = NULL;
 
-    if (!dtn_cbor_encode_array_of_indefinite_length(data, buffer, size, &next))
+    if (!dtn_cbor_encode_array_of_indefinite_length(data, buffer,
+                                                    sizeof(buffer), &next))
         goto error;
 
     struct container1 container = (struct container1){
@@ -794,4 +1737,39 @@ bool dtn_router_core_send_raw(dtn_router_core *self,
                              send_at_interface);
 error:
     return false;
-}
\ No newline at end of file
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+
+bool dtn_router_core_forward(dtn_router_core *self, dtn_bundle *bundle) {
+
+    return forward_bundle(self, bundle, dtn_time_get_current_time_usecs());
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool dtn_router_core_get_stats(dtn_router_core *self,
+                               dtn_router_core_stats *stats) {
+
+    dtn_bundle_store_stats store = {0};
+
+    if (!dtn_router_core_cast(self) || !stats)
+        return false;
+
+    if (self->store)
+        dtn_node_store_get_stats(self->store, &store);
+
+    *stats = (dtn_router_core_stats){
+        .forwarded = atomic_load(&self->stats.forwarded),
+        .held = atomic_load(&self->stats.held),
+        .duplicates = atomic_load(&self->stats.duplicates),
+        .expired = atomic_load(&self->stats.expired),
+        .unroutable = atomic_load(&self->stats.unroutable),
+        .dropped = atomic_load(&self->stats.dropped),
+        .spilled = atomic_load(&self->stats.spilled),
+        .stored = store.records};
+
+    return true;
+}
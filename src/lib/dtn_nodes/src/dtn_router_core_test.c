@@ -28,6 +28,8 @@
         ------------------------------------------------------------------------
 */
 #include "dtn_router_core.c"
+#include <dtn_base/dtn_dir.h>
+#include <dtn_base/dtn_item_json.h>
 #include <dtn_base/testrun.h>
 
 /*
@@ -38,14 +40,655 @@
  *      ------------------------------------------------------------------------
  */
 
-int test_case() {
-    testrun(1 == 1);
+#ifndef DTN_TEST_RESOURCE_DIR
+#error "Must provide -D DTN_TEST_RESOURCE_DIR=value while compiling this file."
+#endif
+
+#define TEST_ROUTES DTN_TEST_RESOURCE_DIR "/config/routes"
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_bundle *test_bundle(const char *destination, uint64_t sequence,
+                               uint64_t lifetime, uint64_t hops) {
+
+    dtn_bundle *bundle = dtn_bundle_create();
+
+    if (!dtn_bundle_add_primary_block(bundle, 0, 0, destination,
+                                      "dtn://src/1", "dtn://src/1", 0,
+                                      sequence, lifetime, 0, 0))
+        goto error;
+
+    if (!dtn_bundle_add_hop_count(bundle, hops, 2))
+        goto error;
+
+    if (!dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("data")))
+        goto error;
+
+    return bundle;
+error:
+    dtn_bundle_free(bundle);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static dtn_bundle *test_aged_bundle(const char *destination, uint64_t sequence,
+                                    uint64_t lifetime, uint64_t age) {
+
+    dtn_bundle *bundle = dtn_bundle_create();
+
+    if (!dtn_bundle_add_primary_block(bundle, 0, 0, destination,
+                                      "dtn://src/1", "dtn://src/1", 0,
+                                      sequence, lifetime, 0, 0))
+        goto error;
+
+    if (!dtn_bundle_add_bundle_age(bundle, age))
+        goto error;
+
+    if (!dtn_bundle_add_hop_count(bundle, 0, 2))
+        goto error;
+
+    if (!dtn_bundle_add_block(bundle, 1, 1, 0, 0, dtn_cbor_string("data")))
+        goto error;
+
+    return bundle;
+error:
+    dtn_bundle_free(bundle);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t received_age(const uint8_t *buffer, size_t size) {
+
+    dtn_bundle *bundle = NULL;
+    uint8_t *next = NULL;
+    uint64_t age = 0;
+
+    if (DTN_CBOR_MATCH_FULL ==
+        dtn_bundle_decode((uint8_t *)buffer, size, &bundle, &next))
+        dtn_bundle_get_bundle_age(bundle, &age);
+
+    dtn_bundle_free(bundle);
+    return age;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t received_sequence(const uint8_t *buffer, size_t size) {
+
+    dtn_bundle *bundle = NULL;
+    uint8_t *next = NULL;
+    uint64_t time = 0;
+    uint64_t sequence = 0;
+
+    if (DTN_CBOR_MATCH_FULL ==
+        dtn_bundle_decode((uint8_t *)buffer, size, &bundle, &next))
+        dtn_bundle_primary_get_timestamp(bundle, &time, &sequence);
+
+    dtn_bundle_free(bundle);
+    return sequence;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_router_core_create() {
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_router_core_config config =
+        (dtn_router_core_config){.loop = loop, .limits.threads = 1};
+    strncpy(config.route_config_path, TEST_ROUTES, PATH_MAX);
+
+    dtn_router_core *core = dtn_router_core_create(config);
+    testrun(core);
+    testrun(dtn_router_core_cast(core));
+    testrun(core->routing);
+    testrun(core->duplicates.filter);
+    testrun(core->contacts.data);
+    testrun(DTN_ROUTER_CORE_CONTACT_QUEUE == core->config.limits.contact_queue);
+
+    testrun(NULL == dtn_router_core_free(core));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_router_core_forward() {
+
+    dtn_router_core_stats stats = {0};
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_router_core_config config = (dtn_router_core_config){
+        .loop = loop, .limits.threads = 1, .limits.contact_queue = 2};
+    strncpy(config.route_config_path, TEST_ROUTES, PATH_MAX);
+
+    dtn_router_core *core = dtn_router_core_create(config);
+    testrun(core);
+
+    testrun(!dtn_router_core_forward(NULL, NULL));
+    testrun(!dtn_router_core_forward(core, NULL));
+    testrun(!dtn_router_core_forward(NULL, test_bundle("dtn://test/one", 0,
+                                                       1000, 0)));
+
+    // no interface, held for the next hop
+
+    testrun(dtn_router_core_forward(core,
+                                    test_bundle("dtn://test/one", 1, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(1 == stats.held);
+    testrun(0 == stats.forwarded);
+    testrun(1 == dtn_dict_count(core->contacts.data));
+
+    // seen before
+
+    testrun(!dtn_router_core_forward(
+        core, test_bundle("dtn://test/one", 1, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(1 == stats.duplicates);
+    testrun(1 == stats.held);
+
+    // lifetime and hop limit
+
+    testrun(!dtn_router_core_forward(core,
+                                     test_bundle("dtn://test/one", 2, 0, 0)));
+    testrun(!dtn_router_core_forward(
+        core, test_bundle("dtn://test/one", 3, 1000, 2)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(2 == stats.expired);
+
+    dtn_bundle *bundle = test_bundle("dtn://test/one", 4, 1000, 0);
+    testrun(dtn_bundle_add_bundle_age(bundle, 1000));
+    testrun(!dtn_router_core_forward(core, bundle));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(3 == stats.expired);
+
+    // creation time set, the lifetime is on the DTN clock
+
+    bundle = test_bundle("dtn://test/one", 9, 1000, 0);
+    testrun(dtn_bundle_primary_set_timestamp(bundle, 1, 9));
+    testrun(!dtn_router_core_forward(core, bundle));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(4 == stats.expired);
+
+    bundle = test_bundle("dtn://test/one", 10, 1000, 0);
+    testrun(dtn_bundle_primary_set_timestamp(
+        bundle, dtn_node_store_dtn_time() - 1000, 10));
+    testrun(!dtn_router_core_forward(core, bundle));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(5 == stats.expired);
+
+    // no route
+
+    testrun(!dtn_router_core_forward(
+        core, test_bundle("dtn://unknown/one", 5, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(1 == stats.unroutable);
+
+    // dropped bundles are not remembered, sent again they are routed again
+
+    testrun(!dtn_router_core_forward(
+        core, test_bundle("dtn://unknown/one", 5, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(2 == stats.unroutable);
+    testrun(1 == stats.duplicates);
+
+    // contact queue limit
+
+    testrun(dtn_router_core_forward(core,
+                                    test_bundle("dtn://test/one", 6, 1000, 1)));
+    testrun(!dtn_router_core_forward(
+        core, test_bundle("dtn://test/one", 7, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(2 == stats.held);
+    testrun(1 == stats.dropped);
+
+    testrun(!dtn_router_core_forward(
+        core, test_bundle("dtn://test/one", 7, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(2 == stats.dropped);
+    testrun(1 == stats.duplicates);
+
+    // other next hop
+
+    testrun(dtn_router_core_forward(core,
+                                    test_bundle("dtn://test/two", 8, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(3 == stats.held);
+    testrun(2 == dtn_dict_count(core->contacts.data));
+
+    bundle = test_bundle("dtn://test/two", 11, 1000, 0);
+    testrun(dtn_bundle_primary_set_timestamp(
+        bundle, dtn_node_store_dtn_time() - 500, 11));
+    testrun(dtn_router_core_forward(core, bundle));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(4 == stats.held);
+
+    testrun(NULL == dtn_router_core_free(core));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_router_core_forward_link_up() {
+
+    dtn_router_core_stats stats = {0};
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX] = {0};
+    uint8_t *next = NULL;
+    dtn_bundle *bundle = NULL;
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_router_core_config config = (dtn_router_core_config){
+        .loop = loop, .limits.threads = 1, .limits.link_check = 10000};
+    strncpy(config.route_config_path, TEST_ROUTES, PATH_MAX);
+
+    dtn_router_core *core = dtn_router_core_create(config);
+    testrun(core);
+
+    // next hop of dtn://test/two
+
+    int peer = dtn_socket_create(
+        (dtn_socket_configuration){.host = "127.0.0.1", .port = 4557,
+                                   .type = UDP},
+        false, NULL);
+    testrun(peer > 0);
+    testrun(dtn_socket_ensure_nonblocking(peer));
+
+    testrun(open_interface(dtn_socket_load_dynamic_port(
+                               (dtn_socket_configuration){.host = "127.0.0.1",
+                                                          .type = UDP}),
+                           core));
+    testrun(1 == dtn_dict_count(core->interfaces.ip));
+
+    // link check not done yet
+
+    testrun(dtn_router_core_forward(
+        core, test_aged_bundle("dtn://test/two", 1, 1000, 100)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(1 == stats.held);
+
+    usleep(20000);
+
+    ssize_t bytes = -1;
+
+    for (size_t i = 0; (i < 100) && (bytes < 0); i++) {
+
+        loop->run(loop, 10000);
+        bytes = recv(peer, buffer, sizeof(buffer), 0);
+    }
+
+    testrun(bytes > 0);
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(0 == stats.held);
+    testrun(1 == stats.forwarded);
+
+    testrun(DTN_CBOR_MATCH_FULL ==
+            dtn_bundle_decode(buffer, bytes, &bundle, &next));
+
+    uint64_t count = 0;
+    uint64_t limit = 0;
+
+    testrun(dtn_bundle_get_hop_count(bundle, &count, &limit));
+    testrun(1 == count);
+    testrun(2 == limit);
+    bundle = dtn_bundle_free(bundle);
+
+    // age includes the time held
+
+    uint64_t age = received_age(buffer, bytes);
+    testrun(age >= 120);
+    testrun(age < 1000);
+
+    // link up, sent directly
+
+    testrun(dtn_router_core_forward(core,
+                                    test_bundle("dtn://test/two", 2, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(0 == stats.held);
+    testrun(2 == stats.forwarded);
+
+    bytes = -1;
+
+    for (size_t i = 0; (i < 100) && (bytes < 0); i++) {
+
+        loop->run(loop, 10000);
+        bytes = recv(peer, buffer, sizeof(buffer), 0);
+    }
+
+    testrun(bytes > 0);
+
+    close(peer);
+    testrun(NULL == dtn_router_core_free(core));
+    testrun(NULL == dtn_event_loop_free(loop));
 
     return testrun_log_success();
 }
 
 /*----------------------------------------------------------------------------*/
 
+int test_dtn_router_core_forward_spill() {
+
+    char path[PATH_MAX] = "/tmp/dtn_router_core_XXXXXX";
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX] = {0};
+    dtn_router_core_stats stats = {0};
+
+    testrun(mkdtemp(path));
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_router_core_config config =
+        (dtn_router_core_config){.loop = loop,
+                                 .limits.threads = 1,
+                                 .limits.contact_queue = 1,
+                                 .limits.link_check = 10000};
+    strncpy(config.route_config_path, TEST_ROUTES, PATH_MAX);
+    strncpy(config.store_path, path, PATH_MAX);
+
+    dtn_router_core *core = dtn_router_core_create(config);
+    testrun(core);
+    testrun(core->store);
+
+    // no interface, spilled to the store once the contact queue is full
+
+    for (uint64_t i = 1; i < 4; i++) {
+        testrun(dtn_router_core_forward(
+            core, test_aged_bundle("dtn://test/two", i, 1000, 100)));
+    }
+
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(1 == stats.held);
+    testrun(2 == stats.spilled);
+    testrun(2 == stats.stored);
+    testrun(0 == stats.dropped);
+
+    dtn_routing_info route = {0};
+    testrun(1 == dtn_routing_lookup(core->routing, "dtn://test/two", &route,
+                                    1));
+
+    dtn_bundle *bundle = test_aged_bundle("dtn://test/two", 2, 1000, 100);
+    testrun(dtn_node_store_contains(core->store, &route, bundle));
+    bundle = dtn_bundle_free(bundle);
+
+    // restart, held bundles are lost, stored ones are kept
+
+    testrun(NULL == dtn_router_core_free(core));
+    core = dtn_router_core_create(config);
+    testrun(core);
+
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(0 == stats.held);
+    testrun(2 == stats.stored);
+
+    int peer = dtn_socket_create(
+        (dtn_socket_configuration){.host = "127.0.0.1", .port = 4557,
+                                   .type = UDP},
+        false, NULL);
+    testrun(peer > 0);
+    testrun(dtn_socket_ensure_nonblocking(peer));
+
+    usleep(20000);
+
+    testrun(open_interface(dtn_socket_load_dynamic_port(
+                               (dtn_socket_configuration){.host = "127.0.0.1",
+                                                          .type = UDP}),
+                           core));
+
+    size_t received = 0;
+
+    for (size_t i = 0; (i < 200) && (received < 2); i++) {
+
+        loop->run(loop, 10000);
+
+        ssize_t bytes = recv(peer, buffer, sizeof(buffer), 0);
+        if (bytes <= 0)
+            continue;
+
+        // age includes the time stored
+
+        uint64_t age = received_age(buffer, bytes);
+        testrun(age >= 120);
+        testrun(age < 1000);
+        received++;
+    }
+
+    testrun(2 == received);
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(0 == stats.stored);
+    testrun(2 == stats.forwarded);
+
+    close(peer);
+    testrun(NULL == dtn_router_core_free(core));
+    testrun(NULL == dtn_event_loop_free(loop));
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_router_core_forward_contact_plan() {
+
+    char path[PATH_MAX] = "/tmp/dtn_router_core_XXXXXX";
+    char file[PATH_MAX + 16] = {0};
+    char json[1024] = {0};
+    dtn_router_core_stats stats = {0};
+
+    testrun(mkdtemp(path));
+    snprintf(file, sizeof(file), "%s/test.plan", path);
+
+    uint64_t now = real_time_usecs() / 1000000;
+
+    snprintf(json, sizeof(json),
+             "{\"contacts\":["
+             "{\"from\":\"router\",\"to\":\"relay\",\"start\":%" PRIu64
+             ",\"end\":%" PRIu64 ",\"rate\":100000,\"owlt\":1},"
+             "{\"from\":\"relay\",\"to\":\"far\",\"start\":%" PRIu64
+             ",\"end\":%" PRIu64 ",\"rate\":100000,\"owlt\":1}],"
+             "\"hops\":{\"relay\":{\"interface\":\"127.0.0.1\","
+             "\"socket\":{\"host\":\"127.0.0.1\",\"port\":4999,"
+             "\"type\":\"UDP\"}}}}",
+             now - 10, now + 1000, now + 100, now + 1000);
+
+    dtn_item *plan = dtn_item_from_json(json);
+    testrun(plan);
+    testrun(dtn_item_json_write_file(file, plan));
+    plan = dtn_item_free(plan);
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_router_core_config config = (dtn_router_core_config){
+        .loop = loop, .name = "router", .limits.threads = 1};
+    strncpy(config.route_config_path, TEST_ROUTES, PATH_MAX);
+    strncpy(config.contact_plan_path, "/nonexisting/test.plan", PATH_MAX);
+
+    testrun(!dtn_router_core_create(config));
+
+    strncpy(config.contact_plan_path, file, PATH_MAX - 1);
+
+    dtn_router_core *core = dtn_router_core_create(config);
+    testrun(core);
+    testrun(core->cgr);
+
+    // not within the routes, held for the first hop of the contact plan
+
+    testrun(dtn_router_core_forward(core,
+                                    test_bundle("dtn://far/one", 1, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(1 == stats.held);
+    testrun(dtn_dict_get(core->contacts.data, "127.0.0.1|127.0.0.1:4999"));
+
+    // not within the contact plan, routed by the routes
+
+    testrun(dtn_router_core_forward(core,
+                                    test_bundle("dtn://test/one", 2, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(2 == stats.held);
+    testrun(2 == dtn_dict_count(core->contacts.data));
+
+    testrun(!dtn_router_core_forward(
+        core, test_bundle("dtn://unknown/one", 3, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(1 == stats.unroutable);
+
+    testrun(NULL == dtn_router_core_free(core));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    unlink(file);
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_dtn_router_core_forward_contact_start() {
+
+    char path[PATH_MAX] = "/tmp/dtn_router_core_XXXXXX";
+    char file[PATH_MAX + 16] = {0};
+    char json[1024] = {0};
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX] = {0};
+    dtn_router_core_stats stats = {0};
+
+    testrun(mkdtemp(path));
+    snprintf(file, sizeof(file), "%s/test.plan", path);
+
+    // hop of the relay only, contacts are added below
+
+    snprintf(json, sizeof(json),
+             "{\"contacts\":[],"
+             "\"hops\":{\"relay\":{\"interface\":\"127.0.0.1\","
+             "\"socket\":{\"host\":\"127.0.0.1\",\"port\":4998,"
+             "\"type\":\"UDP\"}}}}");
+
+    dtn_item *plan = dtn_item_from_json(json);
+    testrun(plan);
+    testrun(dtn_item_json_write_file(file, plan));
+    plan = dtn_item_free(plan);
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+    testrun(loop);
+
+    dtn_router_core_config config =
+        (dtn_router_core_config){.loop = loop,
+                                 .name = "router",
+                                 .limits.threads = 1,
+                                 .limits.link_check = 10000};
+    strncpy(config.route_config_path, TEST_ROUTES, PATH_MAX);
+    strncpy(config.contact_plan_path, file, PATH_MAX - 1);
+
+    dtn_router_core *core = dtn_router_core_create(config);
+    testrun(core);
+
+    int peer = dtn_socket_create(
+        (dtn_socket_configuration){.host = "127.0.0.1", .port = 4998,
+                                   .type = UDP},
+        false, NULL);
+    testrun(peer > 0);
+    testrun(dtn_socket_ensure_nonblocking(peer));
+
+    testrun(open_interface(dtn_socket_load_dynamic_port(
+                               (dtn_socket_configuration){.host = "127.0.0.1",
+                                                          .type = UDP}),
+                           core));
+
+    for (size_t i = 0; (i < 100) && !interface_is_up(core, "127.0.0.1"); i++)
+        loop->run(loop, 10000);
+
+    testrun(interface_is_up(core, "127.0.0.1"));
+
+    // contact to the relay starts in 300ms, held until it starts
+
+    uint64_t now = real_time_usecs();
+
+    testrun(0 <= dtn_cgr_contact_add(
+                     core->cgr, (dtn_cgr_contact){.from = "router",
+                                                  .to = "relay",
+                                                  .start_usecs = now + 300000,
+                                                  .end_usecs = now + 10000000,
+                                                  .rate = 100000}));
+    testrun(0 <= dtn_cgr_contact_add(
+                     core->cgr, (dtn_cgr_contact){.from = "relay",
+                                                  .to = "far",
+                                                  .start_usecs = now,
+                                                  .end_usecs = now + 10000000,
+                                                  .rate = 100000}));
+
+    uint64_t start = dtn_time_get_current_time_usecs();
+
+    testrun(dtn_router_core_forward(core,
+                                    test_bundle("dtn://far/one", 1, 1000, 0)));
+    testrun(dtn_router_core_forward(core,
+                                    test_bundle("dtn://far/one", 2, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(2 == stats.held);
+    testrun(0 == stats.forwarded);
+
+    ssize_t bytes = -1;
+
+    for (size_t i = 0; (i < 200) && (bytes < 0); i++) {
+
+        loop->run(loop, 10000);
+        bytes = recv(peer, buffer, sizeof(buffer), 0);
+    }
+
+    testrun(bytes > 0);
+    testrun(dtn_time_get_current_time_usecs() - start >= 250000);
+
+    // held bundles are sent in order
+
+    testrun(1 == received_sequence(buffer, bytes));
+
+    bytes = -1;
+
+    for (size_t i = 0; (i < 100) && (bytes < 0); i++) {
+
+        loop->run(loop, 10000);
+        bytes = recv(peer, buffer, sizeof(buffer), 0);
+    }
+
+    testrun(bytes > 0);
+    testrun(2 == received_sequence(buffer, bytes));
+
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(0 == stats.held);
+    testrun(2 == stats.forwarded);
+    testrun(DTN_TIMER_INVALID == core->starts.timer);
+
+    // contact open, sent at once
+
+    testrun(dtn_router_core_forward(core,
+                                    test_bundle("dtn://far/one", 3, 1000, 0)));
+    testrun(dtn_router_core_get_stats(core, &stats));
+    testrun(0 == stats.held);
+    testrun(3 == stats.forwarded);
+
+    close(peer);
+    testrun(NULL == dtn_router_core_free(core));
+    testrun(NULL == dtn_event_loop_free(loop));
+
+    unlink(file);
+    testrun(dtn_dir_tree_remove(path));
+
+    return testrun_log_success();
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -57,7 +700,12 @@ int test_case() {
 int all_tests() {
 
     testrun_init();
-    testrun_test(test_case);
+    testrun_test(test_dtn_router_core_create);
+    testrun_test(test_dtn_router_core_forward);
+    testrun_test(test_dtn_router_core_forward_link_up);
+    testrun_test(test_dtn_router_core_forward_spill);
+    testrun_test(test_dtn_router_core_forward_contact_plan);
+    testrun_test(test_dtn_router_core_forward_contact_start);
 
     return testrun_counter;
 }
@@ -759,12 +759,12 @@ bool dtn_test_node_core_send_raw(dtn_test_node_core *self,
     if (!self || !data)
         return false;
 
-    uint64_t size = dtn_cbor_encoding_size(data);
-    uint8_t buffer[size + 1];
-    memset(buffer, 0, size + 1);
+    // encoded in one pass, larger datagrams are not received by peers
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX];
     uint8_t *next = NULL;
 
-    if (!dtn_cbor_encode_array_of_indefinite_length(data, buffer, size, &next))
+    if (!dtn_cbor_encode_array_of_indefinite_length(data, buffer,
+                                                    sizeof(buffer), &next))
         goto error;
 
     struct container1 container = (struct container1){
@@ -408,11 +408,16 @@ dtn_tunnel_app *dtn_tunnel_app_create(dtn_tunnel_app_config config) {
             config.limits.buffer_time_cleanup_usecs,
         .limits.max_buffer_time_secs = config.limits.max_buffer_time_secs,
         .limits.history_secs = config.limits.history_secs,
+        .limits.buffer_workers = config.limits.buffer_workers,
+        .limits.buffer_queue_size = config.limits.buffer_queue_size,
         .sec = config.sec};
 
     if (0 != config.keys[0])
         strncpy(core.keys, config.keys, PATH_MAX);
 
+    if (0 != config.store_path[0])
+        strncpy(core.store_path, config.store_path, PATH_MAX);
+
     self->core = dtn_tunnel_core_create(core);
     if (!self->core)
         goto error;
@@ -478,25 +483,38 @@ dtn_tunnel_app_config dtn_tunnel_app_config_from_item(const dtn_item *input) {
     if (!conf)
         conf = input;
 
+    // limits of the node config, or at the node config itself
+
+    const dtn_item *limits = dtn_item_get(conf, "/limits");
+    if (!limits)
+        limits = conf;
+
     config.limits.threadlock_timeout_usec =
-        dtn_item_get_number(dtn_item_get(conf, "threadlock_timeout_usec"));
+        dtn_item_get_number(dtn_item_get(limits, "/threadlock_timeout_usec"));
 
     config.limits.message_queue_capacity =
-        dtn_item_get_number(dtn_item_get(conf, "message_queue_capacity"));
+        dtn_item_get_number(dtn_item_get(limits, "/message_queue_capacity"));
 
     config.limits.link_check =
-        dtn_item_get_number(dtn_item_get(conf, "link_check_usec"));
+        dtn_item_get_number(dtn_item_get(limits, "/link_check_usec"));
 
-    config.limits.threads = dtn_item_get_number(dtn_item_get(conf, "threads"));
+    config.limits.threads =
+        dtn_item_get_number(dtn_item_get(limits, "/threads"));
 
     config.limits.buffer_time_cleanup_usecs =
-        dtn_item_get_number(dtn_item_get(conf, "buffer_time_cleanup_usecs"));
+        dtn_item_get_number(dtn_item_get(limits, "/buffer_time_cleanup_usecs"));
 
     config.limits.max_buffer_time_secs =
-        dtn_item_get_number(dtn_item_get(conf, "max_buffer_time_secs"));
+        dtn_item_get_number(dtn_item_get(limits, "/max_buffer_time_secs"));
 
     config.limits.history_secs =
-        dtn_item_get_number(dtn_item_get(conf, "history_secs"));
+        dtn_item_get_number(dtn_item_get(limits, "/history_secs"));
+
+    config.limits.buffer_workers =
+        dtn_item_get_number(dtn_item_get(limits, "/buffer_workers"));
+
+    config.limits.buffer_queue_size =
+        dtn_item_get_number(dtn_item_get(limits, "/buffer_queue_size"));
 
     const dtn_item *cbor = dtn_item_get(conf, "/cbor");
 
@@ -544,6 +562,10 @@ dtn_tunnel_app_config dtn_tunnel_app_config_from_item(const dtn_item *input) {
     if (str)
         strncpy(config.keys, str, PATH_MAX);
 
+    str = dtn_item_get_string(dtn_item_get(conf, "/store"));
+    if (str)
+        strncpy(config.store_path, str, PATH_MAX);
+
     config.sec = dtn_security_config_from_item(conf);
 
     return config;
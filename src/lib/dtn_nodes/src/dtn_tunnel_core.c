@@ -28,7 +28,9 @@
         ------------------------------------------------------------------------
 */
 #include "../include/dtn_tunnel_core.h"
+#include "../include/dtn_node_store.h"
 
+#include <inttypes.h>
 #include <libgen.h>
 #include <limits.h>
 #include <stdlib.h>
@@ -91,6 +93,8 @@ struct dtn_tunnel_core {
 
     dtn_key_store *keys;
 
+    dtn_node_store *store;
+
     struct {
 
         dtn_thread_lock lock_ip;
@@ -131,6 +135,51 @@ error:
     return self;
 }
 
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      SENDING
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static bool interface_send(dtn_tunnel_core *self, const dtn_routing_info *info,
+                           const uint8_t *buffer, size_t size) {
+
+    bool result = false;
+
+    if (!dtn_thread_lock_try_lock(&self->interfaces.lock_ip))
+        goto error;
+
+    Interface *in = dtn_dict_get(self->interfaces.ip, info->interface);
+
+    if (in && dtn_thread_lock_try_lock(&in->lock)) {
+
+        if (DTN_IP_LINK_UP == in->state)
+            result = dtn_interface_ip_send_to(in->interface, info->remote,
+                                              &info->address, buffer, size);
+
+        if (!dtn_thread_lock_unlock(&in->lock)) {
+            dtn_log_error("failed to unlock interface.");
+        }
+    }
+
+    if (!dtn_thread_lock_unlock(&self->interfaces.lock_ip)) {
+        dtn_log_error("failed to unlock IP interfaces.");
+    }
+
+error:
+    return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool store_send(void *userdata, const dtn_routing_info *hop,
+                       const uint8_t *data, size_t size) {
+
+    return interface_send((dtn_tunnel_core *)userdata, hop, data, size);
+}
+
 /*
  *      ------------------------------------------------------------------------
  *
@@ -309,7 +358,8 @@ static dtn_list *create_bundles(dtn_tunnel_core *self, uint8_t *buffer,
     dtn_cbor *bib = NULL;
     dtn_cbor *bcb = NULL;
     dtn_bundle *bundle = NULL;
-    dtn_buffer *key = NULL;
+    dtn_key *handle = NULL;
+    const dtn_buffer *key = NULL;
 
     if (!self || !buffer || size < 1)
         goto error;
@@ -326,7 +376,7 @@ static dtn_list *create_bundles(dtn_tunnel_core *self, uint8_t *buffer,
 
     self->sequence++;
 
-    uint64_t timestamp = dtn_time_get_current_time_usecs();
+    uint64_t timestamp = dtn_node_store_dtn_time();
     uint64_t lifetime = 24 * 60 * 60 * 1000; // 24h
 
     char *destination = self->destination_uri;
@@ -336,7 +386,8 @@ static dtn_list *create_bundles(dtn_tunnel_core *self, uint8_t *buffer,
     memset(key_source, 0, PATH_MAX);
     snprintf(key_source, PATH_MAX, "%s/%s", self->uri->name, self->uri->demux);
 
-    key = dtn_key_store_get(self->keys, key_source);
+    handle = dtn_key_store_acquire(self->keys, key_source);
+    key = dtn_key_get_buffer(handle);
 
     if (size < chunk) {
 
@@ -503,12 +554,10 @@ static dtn_list *create_bundles(dtn_tunnel_core *self, uint8_t *buffer,
             break;
 
         open = open - chunk;
-        self->sequence++;
     }
 
-    // add last block
+    // add last block, all fragments share timestamp and sequence
 
-    self->sequence++;
     bib = NULL;
     bcb = NULL;
 
@@ -588,14 +637,14 @@ static dtn_list *create_bundles(dtn_tunnel_core *self, uint8_t *buffer,
 
 done:
     dtn_data_pointer_free(source);
-    dtn_buffer_free(key);
+    dtn_key_release(handle);
     return queue;
 
 error:
     dtn_bundle_free(bundle);
     dtn_cbor_free(payload);
     dtn_list_free(queue);
-    dtn_buffer_free(key);
+    dtn_key_release(handle);
     dtn_data_pointer_free(source);
     return NULL;
 }
@@ -605,7 +654,8 @@ error:
 static bool message_udp_process(dtn_tunnel_core *self, Threadmessage *msg) {
 
     dtn_list *queue = NULL;
-    dtn_list *list = NULL;
+    dtn_routing_info routes[DTN_ROUTING_LOOKUP_MAX];
+    dtn_bundle *bundle = NULL;
 
     uint8_t out[2048];
     size_t out_size = 2048;
@@ -614,15 +664,16 @@ static bool message_udp_process(dtn_tunnel_core *self, Threadmessage *msg) {
     if (!self || !msg)
         goto error;
 
-    dtn_dtn_uri *dest = dtn_dtn_uri_decode(self->destination_uri);
-    list = dtn_routing_get_info_for_uri(self->routing, dest);
-    dest = dtn_dtn_uri_free(dest);
+    int64_t count = dtn_routing_lookup(self->routing, self->destination_uri,
+                                       routes, DTN_ROUTING_LOOKUP_MAX);
+    if (count < 0)
+        goto error;
 
     queue = create_bundles(self, msg->buffer->start, msg->buffer->length);
     if (!queue)
         goto error;
 
-    dtn_bundle *bundle = dtn_list_queue_pop(queue);
+    bundle = dtn_list_queue_pop(queue);
 
     while (bundle) {
 
@@ -633,33 +684,22 @@ static bool message_udp_process(dtn_tunnel_core *self, Threadmessage *msg) {
         if (!dtn_bundle_encode(bundle, out, out_size, &next))
             goto error;
 
-        dtn_routing_info *info = NULL;
-
-        void *nxt = list->iter(list);
+        for (int64_t i = 0; i < count; i++) {
 
-        while (nxt) {
+            const dtn_routing_info *info = &routes[i];
 
-            nxt = list->next(list, nxt, (void **)&info);
+            if (interface_send(self, info, out, next - out)) {
 
-            if (!dtn_thread_lock_try_lock(&self->interfaces.lock_ip))
-                continue;
+                dtn_log_debug("send bundle at %s to %s:%i", info->interface,
+                              info->remote.host, info->remote.port);
 
-            Interface *in = dtn_dict_get(self->interfaces.ip, info->interface);
-            if (in) {
+            } else if (dtn_node_store_hold(self->store, info, bundle, out,
+                                           next - out)) {
 
-                dtn_thread_lock_try_lock(&in->lock);
+                dtn_log_debug("stored bundle for %s to %s:%i",
+                              info->interface, info->remote.host,
+                              info->remote.port);
             }
-
-            dtn_thread_lock_unlock(&self->interfaces.lock_ip);
-
-            bool result = dtn_interface_ip_send(in->interface, info->remote,
-                                                out, next - out);
-
-            dtn_thread_lock_unlock(&in->lock);
-
-            if (result)
-                dtn_log_debug("send bundle at %s to %s:%i", info->interface,
-                              info->remote.host, info->remote.port);
         }
 
         bundle = dtn_bundle_free(bundle);
@@ -706,7 +746,11 @@ static bool message_state_change_process(dtn_tunnel_core *self,
 
     dtn_log_debug("THREAD IO STATE CHANGE at %s to %s", msg->interface, string);
 
-    TODO("... process state change");
+    if ((DTN_IP_LINK_UP == msg->state) && self->store &&
+        (0 > dtn_node_store_release(self->store, msg->interface))) {
+
+        dtn_log_error("failed to send stored bundles at %s", msg->interface);
+    }
 
     dtn_thread_message_free(dtn_thread_message_cast(msg));
     return true;
@@ -932,6 +976,8 @@ dtn_tunnel_core *dtn_tunnel_core_create(dtn_tunnel_core_config config) {
             self->config.limits.buffer_time_cleanup_usecs,
         .limits.max_buffer_time_secs = self->config.limits.max_buffer_time_secs,
         .limits.history_secs = self->config.limits.history_secs,
+        .limits.workers = self->config.limits.buffer_workers,
+        .limits.queue_size = self->config.limits.buffer_queue_size,
         .limits.threadlock_timeout_usecs =
             self->config.limits.threadlock_timeout_usec,
         .callbacks.userdata = self,
@@ -964,6 +1010,21 @@ dtn_tunnel_core *dtn_tunnel_core_create(dtn_tunnel_core_config config) {
 
     dtn_key_store_load(self->keys, NULL);
 
+    if (0 != config.store_path[0]) {
+
+        dtn_node_store_config store = (dtn_node_store_config){
+            .limits.threadlock_timeout_usecs =
+                config.limits.threadlock_timeout_usec,
+            .callbacks.userdata = self,
+            .callbacks.send = store_send};
+
+        strncpy(store.path, config.store_path, PATH_MAX - 1);
+
+        self->store = dtn_node_store_create(store);
+        if (!self->store)
+            goto error;
+    }
+
     return self;
 error:
     dtn_tunnel_core_free(self);
@@ -987,6 +1048,7 @@ dtn_tunnel_core *dtn_tunnel_core_free(dtn_tunnel_core *self) {
     self->garbadge = dtn_garbadge_colloctor_free(self->garbadge);
     self->interfaces.ip = dtn_dict_free(self->interfaces.ip);
     self->tloop = dtn_thread_loop_free(self->tloop);
+    self->store = dtn_node_store_free(self->store);
     self = dtn_data_pointer_free(self);
     return NULL;
 }
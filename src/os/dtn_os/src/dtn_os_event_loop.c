@@ -50,7 +50,16 @@
 
 dtn_event_loop *dtn_os_event_loop(dtn_event_loop_config config) {
 
-    dtn_log_info("Using " EVENT_LOOP_CREATOR_STR);
+    /* epoll and io_uring are selected within the linux loop */
+
+    if (DTN_EVENT_LOOP_BACKEND_POLL == config.backend) {
+        dtn_log_info("Using dtn_event_loop_default");
+        return dtn_event_loop_default(config);
+    }
+
+    dtn_log_info("Using " EVENT_LOOP_CREATOR_STR " backend %s",
+                 dtn_event_loop_backend_to_string(config.backend));
+
     return EVENT_LOOP_CREATOR(config);
 }
 
@@ -46,6 +46,16 @@
         As it is, it stands to reason whether the adaptions actually really pay
         off.
 
+        Timers are kept within a dtn_timer_wheel driven by one timer fd
+        with a resolution of 1 ms. config.max.timers is the number of
+        preallocated timers, more timers are allocated on demand.
+
+        With config.backend DTN_EVENT_LOOP_BACKEND_IO_URING readiness is
+        polled over io_uring instead of epoll, with one io_uring_enter per
+        loop iteration. The loop falls back to epoll if io_uring is not
+        available. A pending poll holds a reference to the file, so fds
+        MUST be unset before close to actually be closed.
+
         BEWARE: Just as the default implementation, this event loop is
 
                 NOT THREAD SAFE!
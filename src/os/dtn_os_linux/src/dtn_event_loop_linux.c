@@ -39,13 +39,19 @@ _Static_assert(DTN_TIMER_INVALID == 0, "DTN_TIMER_INVALID is a valid timer id");
 
 #include <dtn_base/dtn_dict.h>
 #include <dtn_base/dtn_time.h>
+#include <dtn_base/dtn_timer_wheel.h>
 #include <limits.h>
 
 #include <dtn_base/dtn_utils.h>
 #include <time.h>
 
 /* Thats the linux specific part ... */
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <signal.h>
 #include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/timerfd.h>
 
 /*-----------------------------------*/
@@ -54,24 +60,59 @@ static const uint16_t IMPL_POLL_LOOP_TYPE = 0xf001;
 
 static const uint8_t WAKEUP_SIGNAL = (uint8_t)'w';
 
-#define MAX_NO_READY_EVENTS 1
-const uint64_t TIMER_NAGGING_INTERVAL_USEC = 50 * 1000;
+/* Resolution of timers, all timers share one timer fd. */
+#define TIMER_TICK_USECS 1000
+
+/* user data of io_uring requests without completion to dispatch */
+#define URING_IGNORE UINT64_MAX
 
 /*---------------------------------------------------------------------------*/
 
 struct callback {
 
     int fd;
+    uint32_t generation; // registration, stored with the epoll event
+    uint32_t events;     // epoll flags to poll for
+    bool polling;        // io_uring poll request pending
     bool (*callback)(int socket_fd, uint8_t events, void *data);
     void *data;
 };
 
 /*----------------------------------------------------------------------------*/
 
-struct timer_cache_entry {
-    int fd;
-    void *tdata;
-};
+typedef struct {
+
+    int fd; // -1 if epoll is used
+
+    bool dispatching; // requests are submitted with the next wait
+
+    struct {
+        uint32_t *head;
+        uint32_t *tail;
+        uint32_t *array;
+        uint32_t mask;
+        uint32_t entries;
+        struct io_uring_sqe *sqes;
+        void *ring;
+        size_t ring_size;
+        size_t sqes_size;
+    } sq;
+
+    struct {
+        uint32_t *head;
+        uint32_t *tail;
+        uint32_t mask;
+        struct io_uring_cqe *cqes;
+        void *ring;
+        size_t ring_size;
+    } cq;
+
+} Uring;
+
+static const Uring URING_CLOSED = {.fd = -1,
+                                   .sq.ring = MAP_FAILED,
+                                   .sq.sqes = MAP_FAILED,
+                                   .cq.ring = MAP_FAILED};
 
 /*----------------------------------------------------------------------------*/
 
@@ -86,6 +127,8 @@ typedef struct {
 
     int epoll_fd;
 
+    Uring uring;
+
     // We assume that the fd numbers are allocated in order, starting
     // from 0, thus there are at most max_sockets fds + 0,1 and 2
     // and we can use all of them to safely index into this array...
@@ -94,9 +137,21 @@ typedef struct {
     size_t max_callbacks;
 
     struct {
-        struct timer_cache_entry *timers;
-        size_t current;
-    } timers_available;
+        dtn_timer_wheel *wheel;
+        int fd;
+        uint64_t armed; // tick the fd is armed for, UINT64_MAX if none
+        bool advancing;
+    } timers;
+
+    /* Ready events are harvested in batches of config.max.events.
+     * Each registration gets a new generation, events of a batch
+     * are only dispatched if the registration is still the same,
+     * so a callback may unset or even replace any fd of the batch. */
+
+    struct epoll_event *ready_events;
+    uint32_t generation;
+
+    dtn_event_loop_statistics stats;
 
 } Loop;
 
@@ -182,6 +237,20 @@ static char *epoll_event_to_str(uint32_t events, char *out, size_t out_size) {
 
 /*----------------------------------------------------------------------------*/
 
+static int epoll_event_fd(const struct epoll_event *event) {
+
+    return (int)(uint32_t)(event->data.u64 & 0xffffffff);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint32_t epoll_event_generation(const struct epoll_event *event) {
+
+    return (uint32_t)(event->data.u64 >> 32);
+}
+
+/*----------------------------------------------------------------------------*/
+
 static void log_epoll_event(int log_fd, struct epoll_event *event) {
 
     DTN_ASSERT(0 != event);
@@ -189,7 +258,7 @@ static void log_epoll_event(int log_fd, struct epoll_event *event) {
     if (0 >= log_fd)
         return;
 
-    int fd = event->data.fd;
+    int fd = epoll_event_fd(event);
 
     char str_events[255] = {0};
 
@@ -257,6 +326,9 @@ uint32_t impl_event_loop_linux_timer_set(dtn_event_loop *self,
 bool impl_event_loop_linux_timer_unset(dtn_event_loop *self, uint32_t id,
                                        void **userdata);
 
+dtn_event_loop_statistics
+impl_event_loop_linux_get_statistics(const dtn_event_loop *self);
+
 /*----------------------------------------------------------------------------*/
 
 static Loop *cast_to_loop(const void *x) {
@@ -299,6 +371,379 @@ static bool read_and_drop(int fd, uint8_t events, void *data) {
     return -1 < read(fd, buf, sizeof(buf) / sizeof(buf[0]));
 }
 
+/******************************************************************************
+ *                                  IO_URING
+ ******************************************************************************/
+
+/*
+ *      Readiness is polled with one shot IORING_OP_POLL_ADD requests,
+ *      which are armed again after the callback. Requests queued while
+ *      dispatching are submitted together with the next wait, so a loop
+ *      iteration costs one io_uring_enter however many fds are ready.
+ *      Requests queued outside of the loop are submitted at once, as
+ *      the loop may wait in another thread. Poll masks equal epoll flags,
+ *      completions are harvested as epoll events.
+ *
+ *      BEWARE: A pending poll holds a reference to the file, fds MUST be
+ *      unset before close to actually close them.
+ */
+
+static bool uring_is_open(const Loop *loop) { return -1 < loop->uring.fd; }
+
+/*----------------------------------------------------------------------------*/
+
+static void uring_close(Loop *loop) {
+
+    Uring *uring = &loop->uring;
+
+    if (MAP_FAILED != uring->sq.sqes)
+        munmap(uring->sq.sqes, uring->sq.sqes_size);
+
+    if ((MAP_FAILED != uring->cq.ring) && (uring->cq.ring != uring->sq.ring))
+        munmap(uring->cq.ring, uring->cq.ring_size);
+
+    if (MAP_FAILED != uring->sq.ring)
+        munmap(uring->sq.ring, uring->sq.ring_size);
+
+    if (-1 < uring->fd)
+        close(uring->fd);
+
+    *uring = URING_CLOSED;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool uring_init(Loop *loop) {
+
+    Uring *uring = &loop->uring;
+    uring_close(loop);
+
+    struct io_uring_params params = {0};
+
+    /* at most one poll per fd is pending, the kernel requires at least
+     * as many completion as submission entries */
+
+    uint32_t entries = 2 * loop->config.max.events;
+
+    uint32_t cq_entries = 2 * loop->max_callbacks;
+
+    if (cq_entries < 2 * entries)
+        cq_entries = 2 * entries;
+
+    /* task work runs on the next enter instead of interrupting the thread,
+     * which would let other blocking calls of the thread fail with EINTR,
+     * kernels before 5.19 reject the flag */
+
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP |
+                   IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = cq_entries;
+
+    uring->fd = syscall(__NR_io_uring_setup, entries, &params);
+
+    if ((0 > uring->fd) && (EINVAL == errno)) {
+
+        params = (struct io_uring_params){0};
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+        params.cq_entries = cq_entries;
+
+        uring->fd = syscall(__NR_io_uring_setup, entries, &params);
+    }
+
+    if (0 > uring->fd) {
+        dtn_log_notice("io_uring not available: %s", strerror(errno));
+        goto error;
+    }
+
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        dtn_log_notice("io_uring without timeout on wait");
+        goto error;
+    }
+
+    uring->sq.ring_size =
+        params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+
+    uring->cq.ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+    if (single_mmap && (uring->cq.ring_size > uring->sq.ring_size))
+        uring->sq.ring_size = uring->cq.ring_size;
+
+    uring->sq.ring =
+        mmap(0, uring->sq.ring_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQ_RING);
+
+    if (MAP_FAILED == uring->sq.ring)
+        goto error;
+
+    if (single_mmap) {
+
+        uring->cq.ring = uring->sq.ring;
+
+    } else {
+
+        uring->cq.ring =
+            mmap(0, uring->cq.ring_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_CQ_RING);
+
+        if (MAP_FAILED == uring->cq.ring)
+            goto error;
+    }
+
+    uring->sq.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    uring->sq.sqes =
+        mmap(0, uring->sq.sqes_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQES);
+
+    if (MAP_FAILED == uring->sq.sqes)
+        goto error;
+
+    uint8_t *sq = uring->sq.ring;
+    uint8_t *cq = uring->cq.ring;
+
+    uring->sq.head = (uint32_t *)(sq + params.sq_off.head);
+    uring->sq.tail = (uint32_t *)(sq + params.sq_off.tail);
+    uring->sq.mask = *(uint32_t *)(sq + params.sq_off.ring_mask);
+    uring->sq.entries = *(uint32_t *)(sq + params.sq_off.ring_entries);
+    uring->sq.array = (uint32_t *)(sq + params.sq_off.array);
+
+    uring->cq.head = (uint32_t *)(cq + params.cq_off.head);
+    uring->cq.tail = (uint32_t *)(cq + params.cq_off.tail);
+    uring->cq.mask = *(uint32_t *)(cq + params.cq_off.ring_mask);
+    uring->cq.cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    return true;
+
+error:
+
+    uring_close(loop);
+    return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint32_t uring_pending(const Uring *uring) {
+
+    /* the kernel moves the head on submission */
+    return *uring->sq.tail - __atomic_load_n(uring->sq.head, __ATOMIC_ACQUIRE);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int uring_enter(Loop *loop, uint32_t min_complete, int timeout_msecs) {
+
+    Uring *uring = &loop->uring;
+
+    struct __kernel_timespec ts = {
+
+        .tv_sec = timeout_msecs / 1000,
+        .tv_nsec = (timeout_msecs % 1000) * 1000 * 1000};
+
+    struct io_uring_getevents_arg arg = {
+
+        .sigmask_sz = _NSIG / 8, .ts = (uint64_t)(uintptr_t)&ts};
+
+    uint32_t flags = IORING_ENTER_EXT_ARG;
+
+    if (0 < min_complete)
+        flags |= IORING_ENTER_GETEVENTS;
+
+    int submitted = syscall(__NR_io_uring_enter, uring->fd,
+                            uring_pending(uring), min_complete, flags, &arg,
+                            sizeof(arg));
+
+    if (0 > submitted) {
+
+        /* ETIME is the timeout, nothing completed */
+        if ((ETIME == errno) || (EINTR == errno))
+            return 0;
+
+        return -1;
+    }
+
+    return submitted;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool uring_queue(Loop *loop, uint8_t opcode, int fd, uint32_t events,
+                        uint64_t addr, uint64_t user_data) {
+
+    Uring *uring = &loop->uring;
+
+    uint32_t tail = *uring->sq.tail;
+    uint32_t head = __atomic_load_n(uring->sq.head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= uring->sq.entries) {
+
+        /* full, submit without waiting */
+        if (0 > uring_enter(loop, 0, 0))
+            return false;
+
+        head = __atomic_load_n(uring->sq.head, __ATOMIC_ACQUIRE);
+
+        if (tail - head >= uring->sq.entries)
+            return false;
+    }
+
+    uint32_t index = tail & uring->sq.mask;
+
+    struct io_uring_sqe *sqe = &uring->sq.sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->poll32_events = events;
+    sqe->addr = addr;
+    sqe->user_data = user_data;
+
+    uring->sq.array[index] = index;
+
+    __atomic_store_n(uring->sq.tail, tail + 1, __ATOMIC_RELEASE);
+
+    if (uring->dispatching)
+        return true;
+
+    return -1 < uring_enter(loop, 0, 0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int uring_wait(Loop *loop, struct epoll_event *events, int max_events,
+                      int timeout_msecs) {
+
+    Uring *uring = &loop->uring;
+
+    uint32_t head = *uring->cq.head;
+    uint32_t tail = __atomic_load_n(uring->cq.tail, __ATOMIC_ACQUIRE);
+
+    /* submit pending requests, wait only if nothing completed */
+
+    if (head == tail) {
+
+        loop->stats.wait_calls++;
+
+        if (0 > uring_enter(loop, 1, timeout_msecs))
+            return -1;
+
+    } else if (0 < uring_pending(uring)) {
+
+        if (0 > uring_enter(loop, 0, 0))
+            return -1;
+    }
+
+    tail = __atomic_load_n(uring->cq.tail, __ATOMIC_ACQUIRE);
+
+    int num = 0;
+
+    while ((head != tail) && (num < max_events)) {
+
+        struct io_uring_cqe *cqe = &uring->cq.cqes[head & uring->cq.mask];
+        head++;
+
+        /* poll removals and polls cancelled by removal */
+
+        if ((URING_IGNORE == cqe->user_data) || (-ECANCELED == cqe->res))
+            continue;
+
+        events[num].data.u64 = cqe->user_data;
+        events[num].events = (uint32_t)cqe->res;
+
+        /* failed to poll, e.g. fd closed before it was unset */
+        if ((0 > cqe->res) || (cqe->res & POLLNVAL))
+            events[num].events = EPOLLERR | EPOLLHUP;
+
+        num++;
+    }
+
+    __atomic_store_n(uring->cq.head, head, __ATOMIC_RELEASE);
+
+    return num;
+}
+
+/******************************************************************************
+ *                                  POLLER
+ ******************************************************************************/
+
+static bool poller_is_open(const Loop *loop) {
+
+    return uring_is_open(loop) || (-1 < loop->epoll_fd);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static uint64_t callback_user_data(const struct callback *cb) {
+
+    return ((uint64_t)cb->generation << 32) | (uint32_t)cb->fd;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool poller_add(Loop *loop, struct callback *cb) {
+
+    if (uring_is_open(loop)) {
+
+        if (!uring_queue(loop, IORING_OP_POLL_ADD, cb->fd, cb->events, 0,
+                         callback_user_data(cb)))
+            return false;
+
+        cb->polling = true;
+        return true;
+    }
+
+    struct epoll_event ev = {0};
+
+    ev.events = cb->events;
+    ev.data.u64 = callback_user_data(cb);
+
+    return 0 == epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, cb->fd, &ev);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void poller_remove(Loop *loop, int fd, struct callback *cb) {
+
+    if (!uring_is_open(loop)) {
+
+        if (-1 < loop->epoll_fd)
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, 0);
+
+        return;
+    }
+
+    if ((0 == cb) || (fd != cb->fd) || !cb->polling)
+        return;
+
+    uring_queue(loop, IORING_OP_POLL_REMOVE, -1, 0, callback_user_data(cb),
+                URING_IGNORE);
+
+    cb->polling = false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int poller_wait(Loop *loop, int timeout_msecs) {
+
+    if (uring_is_open(loop)) {
+
+        return uring_wait(loop, loop->ready_events, loop->config.max.events,
+                          timeout_msecs);
+    }
+
+    loop->stats.wait_calls++;
+
+    int ready = epoll_wait(loop->epoll_fd, loop->ready_events,
+                           loop->config.max.events, timeout_msecs);
+
+    /* interrupted by a signal, nothing ready */
+    if ((0 > ready) && (EINTR == errno))
+        return 0;
+
+    return ready;
+}
+
 /******************************************************************************
  *                            CALLBACK REGISTERING
  ******************************************************************************/
@@ -352,11 +797,10 @@ static bool release_fd_unsafe(Loop *loop, int fd, void **attached_data) {
     if (0 > fd)
         return false;
 
-    if (-1 < loop->epoll_fd)
-        epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, 0);
-
     struct callback *cb = get_callback_for_fd_unsafe(loop, fd);
 
+    poller_remove(loop, fd, cb);
+
     void *data = 0;
 
     if ((0 == cb) || (fd != cb->fd)) {
@@ -381,11 +825,6 @@ static bool register_fd_with_epoll(
     bool (*callback)(int socket_fd, uint8_t events, void *data)) {
     bool callback_has_been_set = false;
 
-    struct epoll_event ev = {0};
-
-    ev.events = events;
-    ev.data.fd = fd;
-
     struct callback *cb = 0;
 
     if (0 == loop) {
@@ -404,8 +843,8 @@ static bool register_fd_with_epoll(
         goto error;
     }
 
-    if (0 > loop->epoll_fd) {
-        dtn_log_error("Loop does not seem to run? epoll fd not "
+    if (!poller_is_open(loop)) {
+        dtn_log_error("Loop does not seem to run? poller not "
                       "set");
         goto error;
     }
@@ -427,12 +866,14 @@ static bool register_fd_with_epoll(
     cb->fd = fd;
     cb->data = data;
     cb->callback = callback;
+    cb->events = events;
+    cb->generation = ++loop->generation;
 
     callback_has_been_set = true;
 
-    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+    if (!poller_add(loop, cb)) {
 
-        dtn_log_error("Could not add new fd to epoll: %i", fd);
+        dtn_log_error("Could not add new fd to poller: %i", fd);
         goto error;
     }
 
@@ -451,113 +892,46 @@ error:
  *                               TIMER HANDLING
  ******************************************************************************/
 
-struct timer_data {
-    uint32_t magic_bytes;
-    void *data;
-    Loop *loop;
-    bool (*callback)(uint32_t id, void *data);
-};
-
-#define TIMER_DATA_MAGIC_BYTES 0x54696d65
-
-/*----------------------------------------------------------------------------*/
+static uint64_t timer_now_usecs() {
 
-static struct timer_data *cast_to_timer_data(void *data) {
+    struct timespec ts = {0};
+    clock_gettime(dtn_CLOCK_ID, &ts);
 
-    if (0 == data)
-        return 0;
-
-    struct timer_data *tdata = data;
-
-    if (TIMER_DATA_MAGIC_BYTES != tdata->magic_bytes)
-        return 0;
-
-    return tdata;
+    return (uint64_t)ts.tv_sec * 1000 * 1000 + (uint64_t)ts.tv_nsec / 1000;
 }
 
 /*----------------------------------------------------------------------------*/
 
-static bool cache_timer_fd_unsafe(Loop *loop, int fd,
-                                  struct timer_data *tdata) {
+static bool arm_timer_fd_unsafe(Loop *loop) {
 
     DTN_ASSERT(0 != loop);
-    DTN_ASSERT(0 != tdata);
-    DTN_ASSERT(-1 < fd);
-
-    DTN_ASSERT(0 != loop->timers_available.timers);
-
-    size_t current = loop->timers_available.current;
-
-    if (!(current < loop->config.max.timers)) {
-        return false;
-    }
-
-    loop->timers_available.timers[current].fd = fd;
-    loop->timers_available.timers[current].tdata = tdata;
 
-    loop->timers_available.current += 1;
-
-    tdata->data = 0;
-
-    return true;
-}
-
-/*----------------------------------------------------------------------------*/
-
-static bool release_timer_fd_unsafe(Loop *loop, int fd, void **userdata) {
-
-    DTN_ASSERT(0 != loop);
+    /* Armed after all expired timers are done */
+    if (loop->timers.advancing)
+        return true;
 
-    if (DTN_TIMER_INVALID == fd)
-        return false;
+    /* A later expiry keeps the fd armed, an early wakeup will advance
+     * nothing and arm again. This saves a syscall for most unsets. */
 
-    struct callback *cb = get_callback_for_fd_unsafe(loop, fd);
+    uint64_t next = dtn_timer_wheel_next(loop->timers.wheel);
 
-    if ((0 == cb) || (0 > cb->fd)) {
-        /* timer was not registered - that-s fine */
+    if (next >= loop->timers.armed)
         return true;
-    }
 
-    if (fd != cb->fd) {
-        dtn_log_error("Tried to unregister non-existent timer %i ", fd);
-        return false;
-    }
+    uint64_t usecs = next * TIMER_TICK_USECS;
 
-    DTN_ASSERT(fd == cb->fd);
+    struct itimerspec tspec = {0};
 
-    struct timer_data *tdata = cast_to_timer_data(cb->data);
-    if (0 == tdata) {
+    tspec.it_value.tv_sec = usecs / 1000 / 1000;
+    tspec.it_value.tv_nsec = 1000 * (usecs % (1000 * 1000));
 
-        dtn_log_error("Tried to unregister fd %i as timer, which is no timer",
-                      fd);
+    if (0 != timerfd_settime(loop->timers.fd, TFD_TIMER_ABSTIME, &tspec, 0)) {
 
+        dtn_log_error("Could not set time on timer fd");
         return false;
     }
 
-    struct itimerspec none = {0};
-
-    if (0 != timerfd_settime(fd, 0, &none, 0)) {
-        dtn_log_warning("Could not disarm timer %i", fd);
-    }
-
-    void *vdata = 0;
-
-    release_fd_unsafe(loop, fd, &vdata);
-
-    DTN_ASSERT(vdata == tdata);
-
-    if (0 != userdata) {
-        *userdata = tdata->data;
-    }
-
-    if (!cache_timer_fd_unsafe(loop, fd, tdata)) {
-
-        close(fd);
-        free(tdata);
-
-        return true;
-    }
-
+    loop->timers.armed = next;
     return true;
 }
 
@@ -566,113 +940,65 @@ static bool release_timer_fd_unsafe(Loop *loop, int fd, void **userdata) {
 static bool callback_for_timer(int fd, uint8_t events, void *data) {
 
     UNUSED(events);
-    bool retval = false;
-    Loop *loop = 0;
-
-    if (0 > fd) {
-        dtn_log_error("Invalid fd");
-        return false;
-    }
 
-    struct timer_data *tdata = cast_to_timer_data(data);
-
-    if (0 == tdata) {
-        dtn_log_error("Timer callback did not receive valid timer data!");
-        return false;
-    }
-
-    loop = tdata->loop;
+    Loop *loop = cast_to_loop(data);
 
     if (0 == loop) {
         dtn_log_error("Expected event loop as argument");
-        close(fd);
         return false;
     }
 
-    DTN_ASSERT(0 != loop);
-
-    /* Check whether this timer was actually triggered */
+    /* Not expired if the fd was armed again since the event */
     uint64_t expired_count = 0;
 
-    if (8 != read(fd, &expired_count, sizeof(expired_count))) {
-        dtn_log_error("Could not read expiration counter for timer %i", fd);
-        goto error;
-    }
-
-    void *userdata = 0;
-    bool (*callback)(uint32_t id, void *data) = tdata->callback;
-
-    release_timer_fd_unsafe(loop, fd, &userdata);
-    tdata = 0;
-
-    if (expired_count != 1) {
-
-        dtn_log_warning("Timer %i expired %" PRIu64
-                        " times before callback was "
-                        "issued",
-                        fd, expired_count);
+    if (8 == read(fd, &expired_count, sizeof(expired_count))) {
+        loop->timers.armed = UINT64_MAX;
     }
 
-    if (0 != callback) {
-        retval = callback(fd, userdata);
-    }
+    loop->timers.advancing = true;
 
-    return retval;
+    dtn_timer_wheel_advance(loop->timers.wheel,
+                            timer_now_usecs() / TIMER_TICK_USECS);
 
-error:
-    release_timer_fd_unsafe(loop, fd, 0);
+    loop->timers.advancing = false;
 
-    return retval;
+    return arm_timer_fd_unsafe(loop);
 }
 
 /*----------------------------------------------------------------------------*/
 
-static bool acquire_timer_data_unsafe(Loop *loop, int *fd,
-                                      struct timer_data **tdata) {
+static bool timers_init(Loop *loop) {
 
     DTN_ASSERT(0 != loop);
-    DTN_ASSERT(0 != loop->timers_available.timers);
-    DTN_ASSERT(0 != fd);
-    DTN_ASSERT(0 != tdata);
 
-    int tid = -1;
+    loop->timers.armed = UINT64_MAX;
+
+    loop->timers.wheel = dtn_timer_wheel_create(
+        (dtn_timer_wheel_config){.timers = loop->config.max.timers});
 
-    if (0 > loop->epoll_fd) {
-        dtn_log_error("Loop does not seem to run? epoll fd not set");
+    if (0 == loop->timers.wheel) {
+        dtn_log_error("Could not create timer wheel");
         goto error;
     }
 
-    size_t current_cache_index = loop->timers_available.current;
-    if (0 < current_cache_index) {
+    loop->timers.fd = timerfd_create(dtn_CLOCK_ID, TFD_NONBLOCK | TFD_CLOEXEC);
 
-        loop->timers_available.current -= 1;
-
-        --current_cache_index;
-
-        tid = loop->timers_available.timers[current_cache_index].fd;
-        *tdata = loop->timers_available.timers[current_cache_index].tdata;
+    if (0 > loop->timers.fd) {
+        dtn_log_error("Could not create timer fd");
+        goto error;
     }
 
-    if (0 > tid)
-        tid = timerfd_create(dtn_CLOCK_ID, TFD_NONBLOCK | TFD_CLOEXEC);
-
-    DTN_ASSERT(DTN_TIMER_INVALID != tid);
-
-    *fd = tid;
+    if (!register_fd_with_epoll(loop, loop->timers.fd, EPOLLIN, loop,
+                                callback_for_timer)) {
 
-    if (*tdata == 0) {
-        *tdata = calloc(1, sizeof(struct timer_data));
+        dtn_log_error("Could not register timer fd with epoll");
+        goto error;
     }
 
-    DTN_ASSERT(DTN_TIMER_INVALID != tid);
-
     return true;
 
 error:
 
-    if (-1 < tid)
-        close(tid);
-
     return false;
 }
 
@@ -689,15 +1015,22 @@ static bool trigger_callback(Loop *loop, struct epoll_event *ep_event) {
     if (0 == ep_event)
         return false;
 
-    int fd = ep_event->data.fd;
+    int fd = epoll_event_fd(ep_event);
+    uint32_t generation = epoll_event_generation(ep_event);
 
     struct callback *cb = get_callback_for_fd_unsafe(loop, fd);
 
-    if ((0 == cb) || (0 > cb->fd)) {
-        dtn_log_error("No callback for fd %i", fd);
-        return false;
+    if ((0 == cb) || (fd != cb->fd) || (generation != cb->generation)) {
+
+        /* fd was unset or replaced by some earlier callback of the
+         * same batch */
+        loop->stats.stale++;
+        return true;
     }
 
+    /* io_uring polls are one shot */
+    cb->polling = false;
+
     if (0 == cb->callback) {
         dtn_log_error("Invalid callback: Function pointer 0");
         goto error;
@@ -732,9 +1065,19 @@ static bool trigger_callback(Loop *loop, struct epoll_event *ep_event) {
 
     bool retval = cb->callback(fd, events, cb->data);
 
-    if (closed) {
+    if ((fd != cb->fd) || (generation != cb->generation)) {
+
+        /* unset or replaced by the callback */
+
+    } else if (closed) {
 
         release_fd_unsafe(loop, fd, 0);
+
+    } else if (uring_is_open(loop) && !cb->polling) {
+
+        /* poll again, submitted with the next wait */
+        if (!poller_add(loop, cb))
+            dtn_log_error("Could not poll fd %i again", fd);
     }
 
     return retval;
@@ -771,15 +1114,16 @@ static int get_rel_timeout_msecs(uint64_t start_usec,
 
 static bool loop_init(Loop *loop, dtn_event_loop_config config) {
 
-    struct callback *callbacks = 0;
-    int epoll_fd = -1;
-
     if (!loop)
         goto error;
 
     if (!memset(loop, 0, sizeof(Loop)))
         goto error;
 
+    loop->epoll_fd = -1;
+    loop->uring = URING_CLOSED;
+    loop->timers.fd = -1;
+
     if (!dtn_event_loop_set_type(&loop->public, IMPL_POLL_LOOP_TYPE))
         goto error;
 
@@ -794,17 +1138,21 @@ static bool loop_init(Loop *loop, dtn_event_loop_config config) {
 
     loop->config = config;
 
-    loop->max_callbacks = 2;
+    /* wakeup and timer fds, timers do not use fds of their own, but
+     * keep the fd table sparse */
+    loop->max_callbacks = 3;
     loop->max_callbacks += loop->config.max.sockets;
     loop->max_callbacks += loop->config.max.timers;
 
     loop->callbacks = calloc(loop->max_callbacks, sizeof(struct callback));
 
-    size_t num_timers = loop->config.max.timers;
+    loop->ready_events =
+        calloc(loop->config.max.events, sizeof(struct epoll_event));
 
-    loop->timers_available.timers =
-        calloc(num_timers, sizeof(struct timer_cache_entry));
-    loop->timers_available.current = 0;
+    if (0 == loop->ready_events) {
+        dtn_log_error("Failed to allocate ready events.");
+        goto error;
+    }
 
     if (0 == loop->callbacks) {
         dtn_log_error("Failed to allocate bytes for callbacks.");
@@ -831,13 +1179,27 @@ static bool loop_init(Loop *loop, dtn_event_loop_config config) {
     loop->public.timer.set = impl_event_loop_linux_timer_set;
     loop->public.timer.unset = impl_event_loop_linux_timer_unset;
 
-    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    loop->public.get_statistics = impl_event_loop_linux_get_statistics;
 
-    if (0 > loop->epoll_fd) {
-        dtn_log_error("Could not create epoll fd");
-        goto error;
+    if ((DTN_EVENT_LOOP_BACKEND_IO_URING == config.backend) &&
+        !uring_init(loop)) {
+
+        dtn_log_notice("Falling back to epoll");
     }
 
+    if (!uring_is_open(loop)) {
+
+        loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+        if (0 > loop->epoll_fd) {
+            dtn_log_error("Could not create epoll fd");
+            goto error;
+        }
+    }
+
+    if (!timers_init(loop))
+        goto error;
+
     /*
      *      Use a wakeup socket pair to ensure a poll wakeup.
      *
@@ -874,26 +1236,29 @@ static bool loop_init(Loop *loop, dtn_event_loop_config config) {
 
 error:
 
-    epoll_fd = -1;
+    /* loop itself is owned and released by the caller */
 
     if (0 != loop) {
-        callbacks = loop->callbacks;
-        free(loop);
-        loop = 0;
-        epoll_fd = loop->epoll_fd;
-    }
 
-    DTN_ASSERT(0 == loop);
+        free(loop->callbacks);
+        free(loop->ready_events);
+        dtn_timer_wheel_free(loop->timers.wheel);
 
-    if (0 != callbacks) {
-        free(callbacks);
-        callbacks = 0;
-    }
+        loop->callbacks = 0;
+        loop->ready_events = 0;
+        loop->timers.wheel = 0;
+
+        if (-1 < loop->timers.fd)
+            close(loop->timers.fd);
+
+        if (-1 < loop->epoll_fd)
+            close(loop->epoll_fd);
 
-    callbacks = 0;
+        loop->timers.fd = -1;
+        loop->epoll_fd = -1;
 
-    if (-1 < epoll_fd)
-        close(epoll_fd);
+        uring_close(loop);
+    }
 
     return false;
 }
@@ -937,37 +1302,17 @@ static void close_all_sockets(Loop *loop) {
 
     DTN_ASSERT(0 != loop);
 
-    /* Close cached timers */
-
-    for (size_t i = 0; i < loop->timers_available.current; ++i) {
-
-        int fd = loop->timers_available.timers[i].fd;
-        void *tdata = loop->timers_available.timers[i].tdata;
-
-        if (-1 < fd)
-            close(fd);
-
-        if (0 != tdata)
-            free(tdata);
-    }
-
-    /* And prevent caching again */
-    loop->timers_available.current = loop->config.max.timers;
-
     for (size_t i = 0; i < loop->max_callbacks; ++i) {
 
         int fd = loop->callbacks[i].fd;
 
-        if (callback_for_timer == loop->callbacks[i].callback) {
-
-            release_timer_fd_unsafe(loop, fd, 0);
-            continue;
-        }
-
         if (release_fd_unsafe(loop, fd, 0)) {
             close(fd);
         }
     }
+
+    /* timer fd was closed with the callbacks */
+    loop->timers.fd = -1;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -994,10 +1339,11 @@ dtn_event_loop *impl_event_loop_linux_free(dtn_event_loop *self) {
         loop->epoll_fd = -1;
     }
 
-    if (0 != loop->timers_available.timers) {
+    uring_close(loop);
 
-        free(loop->timers_available.timers);
-    }
+    loop->timers.wheel = dtn_timer_wheel_free(loop->timers.wheel);
+
+    free(loop->ready_events);
 
     DTN_ASSERT(0 > loop->epoll_fd);
 
@@ -1041,8 +1387,6 @@ bool impl_event_loop_linux_stop(dtn_event_loop *self) {
 
 bool impl_event_loop_linux_run(dtn_event_loop *self, uint64_t max_usecs) {
 
-    struct epoll_event ready_events[MAX_NO_READY_EVENTS] = {0};
-
     Loop *loop = cast_to_loop(self);
 
     if (0 == loop)
@@ -1051,10 +1395,8 @@ bool impl_event_loop_linux_run(dtn_event_loop *self, uint64_t max_usecs) {
     if (1000 > max_usecs)
         max_usecs = 1000;
 
-    int epfs = loop->epoll_fd;
-
-    if (0 > epfs) {
-        dtn_log_error("epoll not initialized properly");
+    if (!poller_is_open(loop)) {
+        dtn_log_error("poller not initialized properly");
         goto error;
     }
 
@@ -1076,24 +1418,31 @@ bool impl_event_loop_linux_run(dtn_event_loop *self, uint64_t max_usecs) {
             break;
         }
 
-        int num_ready =
-            epoll_wait(epfs, ready_events, MAX_NO_READY_EVENTS, timeout_msecs);
+        struct epoll_event *ready_events = loop->ready_events;
+
+        int num_ready = poller_wait(loop, timeout_msecs);
 
         if (0 > num_ready) {
             dtn_log_error("I/O error occured: %s\n", strerror(errno));
             goto error;
         }
 
+        loop->stats.events += num_ready;
+
         if (0 < loop->public.log_fd) {
             dprintf(loop->public.log_fd, "epoll: Ready events: %i\n",
                     num_ready);
         }
 
+        loop->uring.dispatching = true;
+
         for (size_t r = 0; r < (size_t)num_ready; ++r) {
             log_epoll_event(loop->public.log_fd, &ready_events[r]);
             trigger_callback(loop, &ready_events[r]);
         }
 
+        loop->uring.dispatching = false;
+
     } while (loop->running);
 
     return true;
@@ -1169,72 +1518,60 @@ uint32_t impl_event_loop_linux_timer_set(dtn_event_loop *self,
                                          bool (*callback)(uint32_t id,
                                                           void *data)) {
     Loop *loop = cast_to_loop(self);
-    int timer_fd = -1;
-    struct timer_data *tdata = 0;
+    uint32_t id = DTN_TIMER_INVALID;
 
     if ((0 == loop) || (0 == callback)) {
         goto error;
     }
 
-    if (0 == relative_usec) {
-        /* Setting 0 would disable timer ... */
-        relative_usec = 1;
+    uint64_t now_usecs = timer_now_usecs();
+
+    /* Nothing to expire, move an idle wheel to now */
+    if (0 == dtn_timer_wheel_count(loop->timers.wheel)) {
+        dtn_timer_wheel_advance(loop->timers.wheel,
+                                now_usecs / TIMER_TICK_USECS);
     }
 
-    acquire_timer_data_unsafe(loop, &timer_fd, &tdata);
+    /* Round up, timers never expire early */
+    uint64_t tick =
+        (now_usecs + relative_usec + TIMER_TICK_USECS - 1) / TIMER_TICK_USECS;
+
+    id = dtn_timer_wheel_set(loop->timers.wheel, tick, data, callback);
 
-    if ((0 > timer_fd) || (0 == tdata)) {
+    if (DTN_TIMER_INVALID == id) {
         dtn_log_error("could not acquire a new timer");
         goto error;
     }
 
-    if (UINT32_MAX < (unsigned)timer_fd) {
-        dtn_log_error("timer fd %i is not handleable as it "
-                      "exceeds the "
-                      "numerical limit",
-                      timer_fd);
+    if (!arm_timer_fd_unsafe(loop))
         goto error;
-    }
-
-    uint64_t sec = relative_usec / 1000 / 1000;
-    uint64_t usec = relative_usec - 1000 * 1000 * sec;
-
-    struct itimerspec tspec = {0};
 
-    tspec.it_value.tv_sec = sec;
-    tspec.it_value.tv_nsec = 1000 * usec;
+    return id;
 
-    tspec.it_interval.tv_nsec = TIMER_NAGGING_INTERVAL_USEC * 1000;
-
-    tdata->magic_bytes = TIMER_DATA_MAGIC_BYTES;
-    tdata->loop = loop;
-    tdata->data = data;
-    tdata->callback = callback;
-
-    if (!register_fd_with_epoll(loop, timer_fd, EPOLLIN, tdata,
-                                callback_for_timer)) {
+error:
 
-        dtn_log_error("Could not register timer fd with epoll");
-        goto error;
-    }
+    if (0 != loop)
+        dtn_timer_wheel_unset(loop->timers.wheel, id, 0);
 
-    if (0 != timerfd_settime(timer_fd, 0, &tspec, 0)) {
+    return DTN_TIMER_INVALID;
+}
 
-        dtn_log_error("Could not set time on timer");
-        goto error;
-    }
+/*------------------------------------------------------------------*/
 
-    return timer_fd;
+dtn_event_loop_statistics
+impl_event_loop_linux_get_statistics(const dtn_event_loop *self) {
 
-error:
+    Loop *loop = cast_to_loop(self);
+    if (0 == loop)
+        return (dtn_event_loop_statistics){0};
 
-    if (-1 < timer_fd)
-        release_timer_fd_unsafe(loop, timer_fd, 0);
+    dtn_event_loop_statistics stats = loop->stats;
 
-    if (0 != tdata)
-        free(tdata);
+    if (0 < stats.events)
+        stats.syscalls_per_event =
+            (double)stats.wait_calls / (double)stats.events;
 
-    return DTN_TIMER_INVALID;
+    return stats;
 }
 
 /*------------------------------------------------------------------*/
@@ -1249,7 +1586,7 @@ bool impl_event_loop_linux_timer_unset(dtn_event_loop *self, uint32_t id,
         goto error;
     }
 
-    return release_timer_fd_unsafe(loop, id, userdata);
+    return dtn_timer_wheel_unset(loop->timers.wheel, id, userdata);
 
 error:
 
@@ -39,11 +39,437 @@
 
 /*----------------------------------------------------------------------------*/
 
+static dtn_event_loop *event_loop_io_uring(dtn_event_loop_config config) {
+
+    config.backend = DTN_EVENT_LOOP_BACKEND_IO_URING;
+    return dtn_event_loop_linux(config);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool io_uring_available() {
+
+    dtn_event_loop *loop = event_loop_io_uring(dtn_event_loop_config_default());
+    if (!loop)
+        return false;
+
+    bool available = -1 < cast_to_loop(loop)->uring.fd;
+    dtn_event_loop_free(loop);
+    return available;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t g_io_calls = 0;
+
+static bool count_io(int fd, uint8_t events, void *data) {
+
+    UNUSED(events);
+    UNUSED(data);
+
+    char buf[10] = {0};
+    g_io_calls++;
+    return 0 < read(fd, buf, sizeof(buf));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t run_batch(dtn_event_loop_backend backend, uint32_t max_events,
+                        size_t sockets) {
+
+    dtn_event_loop_config config = dtn_event_loop_config_default();
+    config.backend = backend;
+    config.max.events = max_events;
+
+    dtn_event_loop *loop = dtn_event_loop_linux(config);
+    if (!loop)
+        return SIZE_MAX;
+
+    int pairs[sockets][2];
+
+    for (size_t i = 0; i < sockets; i++) {
+
+        if (0 != socketpair(AF_LOCAL, SOCK_STREAM, 0, pairs[i]))
+            return SIZE_MAX;
+
+        if (!dtn_event_loop_set(loop, pairs[i][0], DTN_EVENT_IO_IN, NULL,
+                                count_io))
+            return SIZE_MAX;
+
+        if (1 != write(pairs[i][1], "x", 1))
+            return SIZE_MAX;
+    }
+
+    g_io_calls = 0;
+
+    while (g_io_calls < sockets) {
+        dtn_event_loop_run(loop, DTN_RUN_ONCE);
+    }
+
+    dtn_event_loop_statistics stats = dtn_event_loop_get_statistics(loop);
+
+    for (size_t i = 0; i < sockets; i++) {
+        close(pairs[i][1]);
+    }
+
+    dtn_event_loop_free(loop);
+
+    if (stats.events < sockets)
+        return SIZE_MAX;
+
+    return stats.wait_calls;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_impl_event_loop_linux_run_batch() {
+
+    // all ready events are harvested with one wait call
+
+    size_t calls = run_batch(DTN_EVENT_LOOP_BACKEND_EPOLL, 16, 8);
+    testrun(0 < calls);
+    testrun(8 > calls);
+
+    bool uring = io_uring_available();
+
+    if (!uring)
+        testrun_log("io_uring not available, io_uring batches skipped");
+
+    // polls completed on submission are harvested without waiting
+
+    calls = run_batch(DTN_EVENT_LOOP_BACKEND_IO_URING, 16, 8);
+    testrun(!uring || (8 > calls));
+
+    // one wait call per event
+
+    calls = run_batch(DTN_EVENT_LOOP_BACKEND_EPOLL, 1, 8);
+    testrun(SIZE_MAX > calls);
+    testrun(8 <= calls);
+
+    // completions left are harvested without waiting
+
+    calls = run_batch(DTN_EVENT_LOOP_BACKEND_IO_URING, 1, 8);
+    testrun(!uring || (8 > calls));
+
+    dtn_event_loop_config config = dtn_event_loop_config_default();
+    dtn_event_loop *loop = dtn_event_loop_linux(config);
+    dtn_event_loop_statistics stats = dtn_event_loop_get_statistics(loop);
+    testrun(0 == stats.wait_calls);
+    testrun(0 == stats.events);
+    testrun(0 == stats.syscalls_per_event);
+
+    testrun(dtn_event_loop_run(loop, 10 * 1000));
+    stats = dtn_event_loop_get_statistics(loop);
+    testrun(0 < stats.wait_calls);
+
+    loop = dtn_event_loop_free(loop);
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct batch_data {
+
+    dtn_event_loop *loop;
+    int fds[2];
+    int peers[2];
+    int replacement[2];
+    size_t called;
+};
+
+static struct batch_data g_batch = {0};
+
+/*----------------------------------------------------------------------------*/
+
+static bool replacement_io(int fd, uint8_t events, void *data) {
+
+    UNUSED(fd);
+    UNUSED(events);
+    UNUSED(data);
+
+    g_batch.called += 100;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool unset_other(int fd, uint8_t events, void *data) {
+
+    UNUSED(events);
+    UNUSED(data);
+
+    char buf[10] = {0};
+    g_batch.called++;
+
+    if (0 >= read(fd, buf, sizeof(buf)))
+        return false;
+
+    // unset and close the other fd, a new socket may reuse its number
+
+    int other = (fd == g_batch.fds[0]) ? g_batch.fds[1] : g_batch.fds[0];
+
+    dtn_event_loop_unset(g_batch.loop, other, NULL);
+    close(other);
+
+    if (0 != socketpair(AF_LOCAL, SOCK_STREAM, 0, g_batch.replacement))
+        return false;
+
+    return dtn_event_loop_set(g_batch.loop, g_batch.replacement[0],
+                              DTN_EVENT_IO_IN, NULL, replacement_io);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static int unset_within_batch(dtn_event_loop_backend backend) {
+
+    dtn_event_loop_config config = dtn_event_loop_config_default();
+    config.backend = backend;
+
+    g_batch = (struct batch_data){0};
+    g_batch.loop = dtn_event_loop_linux(config);
+    testrun(g_batch.loop);
+
+    for (size_t i = 0; i < 2; i++) {
+
+        int pair[2] = {0};
+        testrun(0 == socketpair(AF_LOCAL, SOCK_STREAM, 0, pair));
+        g_batch.fds[i] = pair[0];
+        g_batch.peers[i] = pair[1];
+
+        testrun(dtn_event_loop_set(g_batch.loop, pair[0], DTN_EVENT_IO_IN,
+                                   NULL, unset_other));
+    }
+
+    testrun(1 == write(g_batch.peers[0], "x", 1));
+    testrun(1 == write(g_batch.peers[1], "x", 1));
+
+    while (0 == g_batch.called) {
+        dtn_event_loop_run(g_batch.loop, DTN_RUN_ONCE);
+    }
+
+    // the stale event of the other fd is dropped
+
+    dtn_event_loop_statistics stats =
+        dtn_event_loop_get_statistics(g_batch.loop);
+
+    testrun(1 == g_batch.called);
+    testrun(2 == stats.events);
+    testrun(1 == stats.stale);
+
+    close(g_batch.peers[0]);
+    close(g_batch.peers[1]);
+    close(g_batch.replacement[1]);
+
+    g_batch.loop = dtn_event_loop_free(g_batch.loop);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_impl_event_loop_linux_unset_within_batch() {
+
+    testrun(1 == unset_within_batch(DTN_EVENT_LOOP_BACKEND_EPOLL));
+    testrun(1 == unset_within_batch(DTN_EVENT_LOOP_BACKEND_IO_URING));
+
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool read_one(int fd, uint8_t events, void *data) {
+
+    UNUSED(events);
+    UNUSED(data);
+
+    char c = 0;
+    g_io_calls++;
+    return 1 == read(fd, &c, 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_impl_event_loop_linux_io_uring() {
+
+    dtn_event_loop_config config = dtn_event_loop_config_default();
+
+    // default and poll select epoll
+
+    dtn_event_loop *loop = dtn_event_loop_linux(config);
+    Loop *l = cast_to_loop(loop);
+    testrun(l);
+    testrun(-1 < l->epoll_fd);
+    testrun(-1 == l->uring.fd);
+    loop = dtn_event_loop_free(loop);
+
+    loop = event_loop_io_uring(config);
+    l = cast_to_loop(loop);
+    testrun(l);
+
+    if (-1 == l->uring.fd) {
+
+        // kernel without io_uring, fell back to epoll
+        testrun(-1 < l->epoll_fd);
+        testrun(dtn_event_loop_run(loop, 10 * 1000));
+        testrun(0 < dtn_event_loop_get_statistics(loop).wait_calls);
+        loop = dtn_event_loop_free(loop);
+        testrun_log("io_uring not available, tested the epoll fallback only");
+        return testrun_log_success();
+    }
+
+    testrun(-1 == l->epoll_fd);
+
+    // polls are one shot, but data left is reported again
+
+    int pair[2] = {0};
+    testrun(0 == socketpair(AF_LOCAL, SOCK_STREAM, 0, pair));
+    testrun(dtn_event_loop_set(loop, pair[0], DTN_EVENT_IO_IN, NULL,
+                               read_one));
+
+    struct callback *cb = get_callback_for_fd_unsafe(l, pair[0]);
+    // submitted at once outside of the loop
+    testrun(cb->polling);
+    testrun(0 == uring_pending(&l->uring));
+
+    testrun(3 == write(pair[1], "abc", 3));
+
+    g_io_calls = 0;
+
+    while (g_io_calls < 3) {
+        testrun(dtn_event_loop_run(loop, DTN_RUN_ONCE));
+    }
+
+    testrun(cb->polling);
+
+    // no more events once read
+
+    testrun(dtn_event_loop_run(loop, 10 * 1000));
+    testrun(3 == g_io_calls);
+
+    // unset removes the poll
+
+    testrun(dtn_event_loop_unset(loop, pair[0], NULL));
+    testrun(!cb->polling);
+    testrun(1 == write(pair[1], "d", 1));
+    testrun(dtn_event_loop_run(loop, 10 * 1000));
+    testrun(3 == g_io_calls);
+
+    // hangup of the peer releases the fd
+
+    testrun(dtn_event_loop_set(loop, pair[0], DTN_EVENT_IO_IN, NULL,
+                               read_one));
+    close(pair[1]);
+
+    while (pair[0] == cb->fd) {
+        testrun(dtn_event_loop_run(loop, DTN_RUN_ONCE));
+    }
+
+    close(pair[0]);
+
+    testrun(NULL == dtn_event_loop_free(loop));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct timer_count {
+
+    dtn_event_loop *loop;
+    size_t called;
+    uint32_t unset;
+};
+
+/*----------------------------------------------------------------------------*/
+
+static bool count_timer(uint32_t id, void *data) {
+
+    UNUSED(id);
+
+    struct timer_count *count = data;
+    count->called++;
+
+    if (count->unset)
+        dtn_event_loop_timer_unset(count->loop, count->unset, NULL);
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int test_impl_event_loop_linux_timer_wheel() {
+
+    dtn_event_loop_config config = dtn_event_loop_config_default();
+    config.max.timers = 10;
+
+    dtn_event_loop *loop = dtn_event_loop_linux(config);
+    testrun(loop);
+
+    Loop *l = cast_to_loop(loop);
+    testrun(-1 < l->timers.fd);
+    testrun(UINT64_MAX == l->timers.armed);
+
+    // far more timers than config.max.timers, all on one timer fd
+
+    struct timer_count count = {.loop = loop};
+    size_t max = 5000;
+
+    int fd = dup(l->timers.fd);
+    testrun(-1 < fd);
+    close(fd);
+
+    for (size_t i = 0; i < max; i++) {
+        testrun(DTN_TIMER_INVALID !=
+                dtn_event_loop_timer_set(loop, 1000 + (i % 50) * 1000,
+                                         &count, count_timer));
+    }
+
+    testrun(max == dtn_timer_wheel_count(l->timers.wheel));
+    testrun(UINT64_MAX != l->timers.armed);
+
+    // no fd was used by the timers
+    int next = dup(l->timers.fd);
+    testrun(fd == next);
+    close(next);
+
+    while (count.called < max) {
+        testrun(dtn_event_loop_run(loop, 10 * 1000));
+    }
+
+    testrun(max == count.called);
+    testrun(0 == dtn_timer_wheel_count(l->timers.wheel));
+
+    // unset of a timer of the same tick
+
+    struct timer_count other = {.loop = loop};
+    count = (struct timer_count){.loop = loop};
+
+    testrun(dtn_event_loop_timer_set(loop, 1000, &count, count_timer));
+    count.unset = dtn_event_loop_timer_set(loop, 1000, &other, count_timer);
+
+    while (0 == count.called) {
+        testrun(dtn_event_loop_run(loop, 10 * 1000));
+    }
+
+    testrun(1 == count.called);
+    testrun(0 == other.called);
+    testrun(0 == dtn_timer_wheel_count(l->timers.wheel));
+
+    testrun(NULL == dtn_event_loop_free(loop));
+    return testrun_log_success();
+}
+
+/*----------------------------------------------------------------------------*/
+
 int all_tests() {
 
     testrun_init();
 
     DTN_EVENT_LOOP_PERFORM_INTERFACE_TESTS(dtn_event_loop_linux);
+    DTN_EVENT_LOOP_PERFORM_INTERFACE_TESTS(event_loop_io_uring);
+
+    testrun_test(test_impl_event_loop_linux_run_batch);
+    testrun_test(test_impl_event_loop_linux_unset_within_batch);
+    testrun_test(test_impl_event_loop_linux_timer_wheel);
+    testrun_test(test_impl_event_loop_linux_io_uring);
 
     return testrun_counter;
 }
@@ -33,12 +33,15 @@
 #include <dtn_base/dtn_event_loop.h>
 #include <dtn_base/dtn_item.h>
 #include <dtn_base/dtn_item_json.h>
+#include <dtn_base/dtn_registered_cache.h>
 #include <dtn_base/dtn_string.h>
 
 #include <dtn_core/dtn_event_api.h>
 #include <dtn_core/dtn_io.h>
 #include <dtn_core/dtn_webserver.h>
 
+#include <dtn/dtn_cbor.h>
+
 #include <dtn_nodes/dtn_tunnel_app.h>
 
 #include <dtn_os/dtn_os_event_loop.h>
@@ -49,6 +52,8 @@
     DTN_ROOT                                                                   \
     "/src/service/dtn_tunnel/config/default_config.json"
 
+#define CBOR_CACHE_CAPACITY 1000
+
 /*---------------------------------------------------------------------------*/
 
 int main(int argc, char **argv) {
@@ -86,6 +91,8 @@ int main(int argc, char **argv) {
     if (!dtn_config_log_from_json(config))
         goto error;
 
+    dtn_cbor_enable_caching(CBOR_CACHE_CAPACITY);
+
     // load eventloop
 
     loop = dtn_event_loop_default(loop_config);
@@ -131,5 +138,7 @@ error:
     io = dtn_io_free(io);
     node = dtn_tunnel_app_free(node);
     loop = dtn_event_loop_free(loop);
+    dtn_cbor_cache_flush();
+    dtn_registered_cache_free_all();
     return retval;
 }
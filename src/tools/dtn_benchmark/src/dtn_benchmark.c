@@ -0,0 +1,1985 @@
+/***
+        ------------------------------------------------------------------------
+
+        Copyright (c) 2026 German Aerospace Center DLR e.V. (GSOC)
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+
+        This file is part of the opendtn project. https://opendtn.com
+
+        ------------------------------------------------------------------------
+*//**
+        @file           dtn_benchmark.c
+        @author         Töpfer, Markus
+
+        @date           2026-10-17
+
+        Micro benchmarks of hot paths.
+
+        Each benchmark prints one line per case with the number of
+        operations and the mean cost of one operation in nanoseconds.
+
+        ------------------------------------------------------------------------
+*/
+
+#include <dtn_base/dtn_crc16.h>
+#include <dtn_base/dtn_crc32.h>
+#include <dtn_base/dtn_dict.h>
+#include <dtn_base/dtn_event_loop.h>
+#include <dtn_base/dtn_item_json.h>
+#include <dtn_base/dtn_linked_list.h>
+#include <dtn_base/dtn_socket.h>
+#include <dtn_base/dtn_string.h>
+#include <dtn_base/dtn_timer_wheel.h>
+#include <dtn_base/dtn_utils.h>
+
+#include <dtn/dtn_bundle.h>
+#include <dtn/dtn_bundle_buffer.h>
+#include <dtn/dtn_cbor.h>
+#include <dtn/dtn_cgr.h>
+#include <dtn/dtn_dtn_uri.h>
+#include <dtn/dtn_interface_ip.h>
+#include <dtn/dtn_routing.h>
+
+#include <dtn_core/dtn_key_store.h>
+
+#include <dtn_nodes/dtn_router_core.h>
+
+#include <dtn_os/dtn_os_event_loop.h>
+
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*---------------------------------------------------------------------------*/
+
+#define DEFAULT_ITERATIONS 100000
+
+typedef struct benchmark {
+
+    const char *name;
+    const char *description;
+    bool (*run)(uint64_t iterations);
+
+} benchmark;
+
+/*---------------------------------------------------------------------------*/
+
+static uint64_t now_nsecs() {
+
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void print_result(const char *name, const char *variant,
+                         uint64_t operations, uint64_t nsecs) {
+
+    double per_op = operations ? (double)nsecs / (double)operations : 0;
+
+    fprintf(stdout, "%-20s %-32s %12" PRIu64 " ops %12.1f ns/op\n", name,
+            variant, operations, per_op);
+    return;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CBOR ARRAY
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static dtn_bundle *bundle_with_blocks(uint64_t blocks) {
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    if (!bundle)
+        goto error;
+
+    if (!dtn_bundle_add_primary_block(bundle, 0, 0, "dtn://dest", "dtn://src",
+                                      "dtn://report", 1, 1, 1000, 0, 0))
+        goto error;
+
+    for (uint64_t i = 0; i < blocks; i++) {
+
+        dtn_cbor *data = dtn_cbor_string("ext");
+        if (!dtn_bundle_add_block(bundle, 192, i + 2, 0, 0, data))
+            goto error;
+    }
+
+    dtn_cbor *payload = dtn_cbor_string("payload");
+    if (!dtn_bundle_add_block(bundle, 1, 1, 0, 0, payload))
+        goto error;
+
+    return bundle;
+error:
+    dtn_bundle_free(bundle);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_cbor_array(uint64_t iterations) {
+
+    const uint64_t sizes[] = {8, 64, 512};
+    char variant[64] = {0};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+
+        uint64_t blocks = sizes[s];
+        uint64_t rounds = iterations / blocks + 1;
+
+        dtn_bundle *bundle = bundle_with_blocks(blocks);
+        if (!bundle)
+            goto error;
+
+        dtn_cbor *raw = dtn_bundle_get_raw(bundle);
+        uint64_t count = dtn_cbor_array_count(raw);
+        uint64_t found = 0;
+
+        // indexed access to all blocks of the bundle
+
+        uint64_t start = now_nsecs();
+
+        for (uint64_t r = 0; r < rounds; r++) {
+            for (uint64_t i = 0; i < count; i++) {
+                if (dtn_cbor_array_get(raw, i))
+                    found++;
+            }
+        }
+
+        snprintf(variant, sizeof(variant), "array_get %" PRIu64 " blocks",
+                 blocks);
+        print_result("cbor_array", variant, rounds * count,
+                     now_nsecs() - start);
+
+        // same access pattern on a linked list, the former array storage
+
+        dtn_list *list = dtn_linked_list_create((dtn_list_config){0});
+        for (uint64_t i = 0; i < count; i++) {
+            dtn_list_push(list, dtn_cbor_array_get(raw, i));
+        }
+
+        start = now_nsecs();
+
+        for (uint64_t r = 0; r < rounds; r++) {
+            for (uint64_t i = 1; i <= count; i++) {
+                if (dtn_list_get(list, i))
+                    found++;
+            }
+        }
+
+        snprintf(variant, sizeof(variant), "linked_list_get %" PRIu64 " blocks",
+                 blocks);
+        print_result("cbor_array", variant, rounds * count,
+                     now_nsecs() - start);
+
+        list = dtn_list_free(list);
+
+        // block lookup by block number
+
+        uint64_t lookups = iterations / 8 + 1;
+        start = now_nsecs();
+
+        for (uint64_t i = 0; i < lookups; i++) {
+            if (dtn_bundle_get_block(bundle, (i % blocks) + 2))
+                found++;
+        }
+
+        snprintf(variant, sizeof(variant), "get_block %" PRIu64 " blocks",
+                 blocks);
+        print_result("cbor_array", variant, lookups, now_nsecs() - start);
+
+        bundle = dtn_bundle_free(bundle);
+
+        if (0 == found)
+            goto error;
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      DICT
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static bool bench_dict_type(dtn_dict_type type, const char *type_name,
+                            uint64_t entries, uint64_t iterations) {
+
+    char variant[64] = {0};
+
+    dtn_dict_config config = dtn_dict_intptr_key_config(255);
+    config.type = type;
+
+    dtn_dict *dict = dtn_dict_create(config);
+    if (!dict)
+        goto error;
+
+    // keys start at 1, NULL is no valid key
+
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 1; i <= entries; i++) {
+        if (!dtn_dict_set(dict, (void *)(intptr_t)i, (void *)(intptr_t)i,
+                          NULL))
+            goto error;
+    }
+
+    snprintf(variant, sizeof(variant), "%s set %" PRIu64, type_name, entries);
+    print_result("dict", variant, entries, now_nsecs() - start);
+
+    // lookups spread over the whole key range
+
+    uint64_t found = 0;
+    start = now_nsecs();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t key = (i * 2654435761u) % entries + 1;
+        if (dtn_dict_get(dict, (void *)(intptr_t)key))
+            found++;
+    }
+
+    snprintf(variant, sizeof(variant), "%s get hit %" PRIu64, type_name,
+             entries);
+    print_result("dict", variant, iterations, now_nsecs() - start);
+
+    if (found != iterations)
+        goto error;
+
+    start = now_nsecs();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t key = entries + 1 + i;
+        if (dtn_dict_get(dict, (void *)(intptr_t)key))
+            found++;
+    }
+
+    snprintf(variant, sizeof(variant), "%s get miss %" PRIu64, type_name,
+             entries);
+    print_result("dict", variant, iterations, now_nsecs() - start);
+
+    if (found != iterations)
+        goto error;
+
+    start = now_nsecs();
+
+    for (uint64_t i = 1; i <= entries; i++) {
+        if (!dtn_dict_del(dict, (void *)(intptr_t)i))
+            goto error;
+    }
+
+    snprintf(variant, sizeof(variant), "%s del %" PRIu64, type_name, entries);
+    print_result("dict", variant, entries, now_nsecs() - start);
+
+    dict = dtn_dict_free(dict);
+    return true;
+error:
+    dtn_dict_free(dict);
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_dict(uint64_t iterations) {
+
+    const uint64_t sizes[] = {1000, 100000, 1000000};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+
+        if (!bench_dict_type(DTN_DICT_CHAINED, "chained", sizes[s],
+                             iterations))
+            goto error;
+
+        if (!bench_dict_type(DTN_DICT_FLAT, "flat", sizes[s], iterations))
+            goto error;
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      TIMER WHEEL
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static bool count_expiry(uint32_t id, void *data) {
+
+    UNUSED(id);
+    uint64_t *count = data;
+    (*count)++;
+    return true;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_timer_wheel(uint64_t iterations) {
+
+    char variant[64] = {0};
+    uint64_t expired = 0;
+
+    uint32_t *ids = calloc(iterations, sizeof(uint32_t));
+    dtn_timer_wheel *wheel =
+        dtn_timer_wheel_create((dtn_timer_wheel_config){0});
+
+    if (!ids || !wheel)
+        goto error;
+
+    // lifetimes of up to 1 hour in ticks of 1 ms
+
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        ids[i] = dtn_timer_wheel_set(wheel, (i * 2654435761u) % 3600000 + 1,
+                                     &expired, count_expiry);
+        if (0 == ids[i])
+            goto error;
+    }
+
+    snprintf(variant, sizeof(variant), "set %" PRIu64, iterations);
+    print_result("timer_wheel", variant, iterations, now_nsecs() - start);
+
+    start = now_nsecs();
+
+    for (uint64_t i = 0; i < iterations; i += 2) {
+        if (!dtn_timer_wheel_unset(wheel, ids[i], NULL))
+            goto error;
+    }
+
+    snprintf(variant, sizeof(variant), "unset %" PRIu64, iterations / 2);
+    print_result("timer_wheel", variant, (iterations + 1) / 2,
+                 now_nsecs() - start);
+
+    // advance tick by tick over the hour
+
+    uint64_t pending = dtn_timer_wheel_count(wheel);
+    start = now_nsecs();
+
+    for (uint64_t tick = 1; tick <= 3600000; tick++) {
+        dtn_timer_wheel_advance(wheel, tick);
+    }
+
+    snprintf(variant, sizeof(variant), "advance 3600000 ticks");
+    print_result("timer_wheel", variant, 3600000, now_nsecs() - start);
+
+    if (expired != pending)
+        goto error;
+
+    free(ids);
+    dtn_timer_wheel_free(wheel);
+    return true;
+error:
+    free(ids);
+    dtn_timer_wheel_free(wheel);
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      BUNDLE BUFFER
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+#define BUFFER_FRAGMENTS 4
+#define BUFFER_FRAGMENT_SIZE 64
+
+typedef enum { GATE_WAIT = 0, GATE_RUN, GATE_ABORT } gate_state;
+
+struct buffer_gate {
+
+    atomic_uint_fast64_t ready;
+    atomic_int state;
+};
+
+/*---------------------------------------------------------------------------*/
+
+struct buffer_worker {
+
+    pthread_t thread;
+    struct buffer_gate *gate;
+
+    dtn_bundle_buffer *buffer;
+    dtn_bundle **fragments;
+    uint64_t first;
+    uint64_t bundles;
+    uint64_t count;
+    bool failed;
+};
+
+/*---------------------------------------------------------------------------*/
+
+static void count_payload(void *userdata, const uint8_t *payload, size_t size,
+                          const char *source, const char *destination) {
+
+    UNUSED(payload);
+    UNUSED(source);
+    UNUSED(destination);
+
+    if (BUFFER_FRAGMENTS * BUFFER_FRAGMENT_SIZE == size)
+        atomic_fetch_add((atomic_uint_fast64_t *)userdata, 1);
+
+    return;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool create_fragments(struct buffer_worker *worker) {
+
+    uint64_t bundles = worker->bundles;
+
+    char content[BUFFER_FRAGMENT_SIZE + 1] = {0};
+    memset(content, 'x', BUFFER_FRAGMENT_SIZE);
+
+    worker->count = bundles * BUFFER_FRAGMENTS;
+    worker->fragments = calloc(worker->count, sizeof(dtn_bundle *));
+
+    if (!worker->fragments)
+        goto error;
+
+    // fragments of a bundle are interleaved with those of other bundles
+
+    for (uint64_t i = 0; i < worker->count; i++) {
+
+        uint64_t sequence = worker->first + i % bundles;
+        uint64_t offset = (i / bundles) * BUFFER_FRAGMENT_SIZE;
+
+        dtn_bundle *bundle = dtn_bundle_create();
+        worker->fragments[i] = bundle;
+
+        if (!bundle ||
+            !dtn_bundle_add_primary_block(
+                bundle, 1, 0, "dtn://dest", "dtn://src", "dtn://report", 1,
+                sequence, 1000, offset,
+                BUFFER_FRAGMENTS * BUFFER_FRAGMENT_SIZE) ||
+            !dtn_bundle_add_block(bundle, 1, 1, 0, 0,
+                                  dtn_cbor_string(content)))
+            goto error;
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void *push_fragments(void *arg) {
+
+    struct buffer_worker *worker = arg;
+
+    // fragments are created within the pushing thread, as on ingest
+
+    worker->failed = !create_fragments(worker);
+
+    atomic_fetch_add(&worker->gate->ready, 1);
+
+    while (GATE_WAIT == atomic_load(&worker->gate->state)) {
+        sched_yield();
+    }
+
+    if (GATE_ABORT == atomic_load(&worker->gate->state))
+        worker->failed = true;
+
+    for (uint64_t i = 0; !worker->failed && (i < worker->count); i++) {
+        dtn_bundle_buffer_push(worker->buffer, worker->fragments[i]);
+        worker->fragments[i] = NULL;
+    }
+
+    for (uint64_t i = 0; worker->failed && (i < worker->count); i++) {
+        worker->fragments[i] = dtn_bundle_free(worker->fragments[i]);
+    }
+
+    worker->fragments = dtn_data_pointer_free(worker->fragments);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_buffer_threads(uint64_t shards, uint64_t threads,
+                                 uint64_t iterations) {
+
+    char variant[64] = {0};
+
+    atomic_uint_fast64_t delivered = 0;
+    uint64_t bundles = iterations / (threads * BUFFER_FRAGMENTS) + 1;
+
+    struct buffer_worker workers[threads];
+    memset(workers, 0, sizeof(workers));
+
+    struct buffer_gate gate = {0};
+    uint64_t started = 0;
+
+    dtn_event_loop *loop = dtn_event_loop_default((dtn_event_loop_config){0});
+
+    dtn_bundle_buffer *buffer = dtn_bundle_buffer_create(
+        (dtn_bundle_buffer_config){.loop = loop,
+                                   .limits.shards = shards,
+                                   .limits.threadlock_timeout_usecs = 1000000,
+                                   .callbacks.userdata = &delivered,
+                                   .callbacks.payload = count_payload});
+
+    if (!buffer)
+        goto error;
+
+    for (; started < threads; started++) {
+
+        struct buffer_worker *worker = &workers[started];
+
+        worker->gate = &gate;
+        worker->buffer = buffer;
+        worker->first = started * bundles;
+        worker->bundles = bundles;
+
+        if (0 != pthread_create(&worker->thread, NULL, push_fragments, worker))
+            goto error;
+    }
+
+    // all fragments created, run all threads at once
+
+    while (threads > atomic_load(&gate.ready)) {
+        sched_yield();
+    }
+
+    uint64_t start = now_nsecs();
+    atomic_store(&gate.state, GATE_RUN);
+
+    bool failed = false;
+
+    for (uint64_t t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        failed |= workers[t].failed;
+    }
+
+    uint64_t nsecs = now_nsecs() - start;
+
+    if (failed)
+        goto done;
+
+    snprintf(variant, sizeof(variant),
+             "push %" PRIu64 " shards %" PRIu64 " threads", shards, threads);
+    print_result("bundle_buffer", variant, threads * bundles * BUFFER_FRAGMENTS,
+                 nsecs);
+
+done:
+    dtn_bundle_buffer_free(buffer);
+    dtn_event_loop_free(loop);
+
+    return !failed && (threads * bundles == atomic_load(&delivered));
+
+error:
+
+    atomic_store(&gate.state, GATE_ABORT);
+
+    for (uint64_t t = 0; t < started; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+
+    dtn_bundle_buffer_free(buffer);
+    dtn_event_loop_free(loop);
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_bundle_buffer(uint64_t iterations) {
+
+    const uint64_t threads[] = {1, 2, 4, 8};
+    const uint64_t shards[] = {1, DTN_BUNDLE_BUFFER_SHARDS_DEFAULT};
+
+    for (size_t s = 0; s < sizeof(shards) / sizeof(shards[0]); s++) {
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+
+            if (!bench_buffer_threads(shards[s], threads[t], iterations))
+                goto error;
+        }
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CRC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static bool bench_crc_size(size_t size, uint64_t iterations) {
+
+    char variant[64] = {0};
+    volatile uint32_t sink = 0;
+
+    // about iterations KiB per variant
+    uint64_t runs = iterations * 1024 / size;
+    if (0 == runs)
+        runs = 1;
+
+    uint8_t *data = calloc(1, size);
+    if (!data)
+        goto error;
+
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    struct {
+
+        dtn_crc32c_engine engine;
+        const char *name;
+
+    } engines[] = {{DTN_CRC32C_TABLE, "table"},
+                   {DTN_CRC32C_SLICE8, "slice8"},
+                   {DTN_CRC32C_SSE42, "sse4.2"}};
+
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+
+        if (DTN_CRC32C_SSE42 == engines[e].engine &&
+            DTN_CRC32C_SSE42 != dtn_crc32c_engine_active())
+            continue;
+
+        uint64_t start = now_nsecs();
+
+        for (uint64_t i = 0; i < runs; i++) {
+            sink ^= dtn_crc32c_update_engine(engines[e].engine, 0, data, size);
+        }
+
+        snprintf(variant, sizeof(variant), "crc32c %s %zu bytes",
+                 engines[e].name, size);
+        print_result("crc", variant, runs, now_nsecs() - start);
+    }
+
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 0; i < runs; i++) {
+        sink ^= crc16x25(data, size);
+    }
+
+    snprintf(variant, sizeof(variant), "crc16 slice8 %zu bytes", size);
+    print_result("crc", variant, runs, now_nsecs() - start);
+
+    free(data);
+    return true;
+error:
+    free(data);
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_crc_bundle(size_t size, uint64_t iterations) {
+
+    char variant[64] = {0};
+    dtn_bundle *out = NULL;
+    uint8_t *next = NULL;
+    uint8_t *buffer = NULL;
+    uint8_t *payload = NULL;
+
+    uint64_t runs = iterations * 1024 / size;
+    if (0 == runs)
+        runs = 1;
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    payload = calloc(1, size);
+
+    if (!bundle || !payload)
+        goto error;
+
+    if (!dtn_bundle_add_primary_block(bundle, 0, 2, "dtn://dest", "dtn://src",
+                                      "dtn://report", 1, 1, 1000, 0, 0))
+        goto error;
+
+    dtn_cbor *data = dtn_cbor_string(NULL);
+    if (!dtn_cbor_set_byte_string(data, payload, size)) {
+        dtn_cbor_free(data);
+        goto error;
+    }
+
+    if (!dtn_bundle_add_block(bundle, 1, 1, 0, 2, data))
+        goto error;
+
+    size_t length = size + 1024;
+    buffer = calloc(1, length);
+    if (!buffer)
+        goto error;
+
+    if (!dtn_bundle_encode(bundle, buffer, length, &next))
+        goto error;
+
+    length = next - buffer;
+
+    // CRCs checked over the received bytes
+
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 0; i < runs; i++) {
+
+        if (DTN_CBOR_MATCH_FULL !=
+            dtn_bundle_decode(buffer, length, &out, &next))
+            goto error;
+
+        out = dtn_bundle_free(out);
+    }
+
+    snprintf(variant, sizeof(variant), "decode crc32 %zu bytes", size);
+    print_result("crc", variant, runs, now_nsecs() - start);
+
+    // CRCs checked over a re-encoding of each block
+
+    start = now_nsecs();
+
+    for (uint64_t i = 0; i < runs; i++) {
+
+        if (!dtn_bundle_verify(bundle))
+            goto error;
+    }
+
+    snprintf(variant, sizeof(variant), "verify crc32 %zu bytes", size);
+    print_result("crc", variant, runs, now_nsecs() - start);
+
+    free(buffer);
+    free(payload);
+    dtn_bundle_free(bundle);
+    return true;
+error:
+    dtn_bundle_free(out);
+    free(buffer);
+    free(payload);
+    dtn_bundle_free(bundle);
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_crc(uint64_t iterations) {
+
+    const size_t sizes[] = {1024, 64 * 1024, 1024 * 1024};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+
+        if (!bench_crc_size(sizes[s], iterations))
+            goto error;
+
+        if (!bench_crc_bundle(sizes[s], iterations))
+            goto error;
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      BUNDLE ENCODE
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/*
+ *      Blocks keep their encoding until changed, touched blocks are encoded
+ *      again. Touching the bundle age block only is the forwarding case,
+ *      touching all blocks is a full encode.
+ */
+
+static const char *touch_names[] = {"unchanged", "age touched", "all touched"};
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_encode_crc(uint64_t crc_type, size_t size, size_t touch,
+                             uint64_t iterations) {
+
+    char variant[64] = {0};
+    uint8_t buffer[2048] = {0};
+    uint8_t payload[1024] = {0};
+    uint8_t *next = NULL;
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    dtn_cbor *data = dtn_cbor_string(NULL);
+
+    if (!bundle || !data || size > sizeof(payload))
+        goto error;
+
+    if (!dtn_cbor_set_byte_string(data, payload, size))
+        goto error;
+
+    if (!dtn_bundle_add_primary_block(bundle, 0, crc_type, "dtn://dest",
+                                      "dtn://src", "dtn://report", 1, 1, 1000,
+                                      0, 0))
+        goto error;
+
+    if (!dtn_bundle_add_block(bundle, 7, 2, 0, crc_type,
+                              dtn_cbor_string("age")))
+        goto error;
+
+    if (!dtn_bundle_add_block(bundle, 1, 1, 0, crc_type, data))
+        goto error;
+
+    data = NULL;
+
+    dtn_cbor *raw = dtn_bundle_get_raw(bundle);
+
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+
+        if (touch > 0)
+            dtn_cbor_touch(dtn_bundle_get_data(dtn_cbor_array_get(raw, 1)));
+
+        if (touch > 1) {
+            dtn_cbor_touch(dtn_cbor_array_get(raw, 0));
+            dtn_cbor_touch(dtn_bundle_get_data(dtn_cbor_array_get(raw, 2)));
+        }
+
+        if (!dtn_bundle_encode(bundle, buffer, sizeof(buffer), &next))
+            goto error;
+    }
+
+    snprintf(variant, sizeof(variant),
+             "crc type %" PRIu64 " payload %zu %s", crc_type, size,
+             touch_names[touch]);
+    print_result("bundle_encode", variant, iterations, now_nsecs() - start);
+
+    dtn_bundle_free(bundle);
+    return true;
+error:
+    dtn_cbor_free(data);
+    dtn_bundle_free(bundle);
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_bundle_encode(uint64_t iterations) {
+
+    const size_t sizes[] = {64, 1024};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+
+        for (uint64_t crc_type = 0; crc_type <= 2; crc_type++) {
+
+            for (size_t touch = 0; touch < 3; touch++) {
+
+                if (!bench_encode_crc(crc_type, sizes[s], touch, iterations))
+                    goto error;
+            }
+        }
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      BPSEC
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/*
+ *      Security input and payload are streamed, so the cost is expected to
+ *      grow linear with the payload, without any size limit.
+ */
+
+static dtn_bundle *bpsec_bundle(size_t size, uint64_t code, dtn_cbor **block,
+                                dtn_cbor **payload) {
+
+    dtn_bundle *bundle = dtn_bundle_create();
+    dtn_cbor *data = dtn_cbor_string(NULL);
+    uint8_t *bytes = calloc(1, size);
+
+    if (!bundle || !data || !bytes)
+        goto error;
+
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = i;
+    }
+
+    if (!dtn_cbor_set_byte_string(data, bytes, size))
+        goto error;
+
+    bytes = dtn_data_pointer_free(bytes);
+
+    if (!dtn_bundle_add_primary_block(bundle, 0, 1, "dtn://dest",
+                                      "dtn://src/1", "dtn://report", 1, 1,
+                                      1000, 0, 0))
+        goto error;
+
+    *block = dtn_bundle_add_block(bundle, code, 2, 0, 0,
+                                  dtn_cbor_string(NULL));
+    *payload = dtn_bundle_add_block(bundle, 1, 1, 0, 2, data);
+    data = NULL;
+
+    if (!*block || !*payload)
+        goto error;
+
+    return bundle;
+error:
+    dtn_data_pointer_free(bytes);
+    dtn_cbor_free(data);
+    dtn_bundle_free(bundle);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_bpsec_size(size_t size, dtn_buffer *key,
+                             dtn_key_store *store, dtn_dtn_uri *source,
+                             uint64_t iterations) {
+
+    char variant[64] = {0};
+    dtn_cbor *block = NULL;
+    dtn_cbor *payload = NULL;
+
+    uint64_t runs = iterations * 1024 / size / 10;
+    if (runs == 0)
+        runs = 1;
+
+    dtn_bundle *bundle = bpsec_bundle(size, 11, &block, &payload);
+    if (!bundle)
+        goto error;
+
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 0; i < runs; i++) {
+
+        if (!dtn_bundle_bib_protect(bundle, block, payload, key, 0x07,
+                                    HMAC256, source, false))
+            goto error;
+    }
+
+    snprintf(variant, sizeof(variant), "bib protect %zu", size);
+    print_result("bpsec", variant, runs, now_nsecs() - start);
+
+    start = now_nsecs();
+
+    for (uint64_t i = 0; i < runs; i++) {
+
+        if (!dtn_bundle_bib_verify(bundle, store))
+            goto error;
+    }
+
+    snprintf(variant, sizeof(variant), "bib verify %zu", size);
+    print_result("bpsec", variant, runs, now_nsecs() - start);
+
+    bundle = dtn_bundle_free(bundle);
+    bundle = bpsec_bundle(size, 12, &block, &payload);
+    if (!bundle)
+        goto error;
+
+    start = now_nsecs();
+
+    for (uint64_t i = 0; i < runs; i++) {
+
+        if (!dtn_bundle_bcb_protect(bundle, block, payload, key, source, 0x07,
+                                    A256GCM, false))
+            goto error;
+
+        if (!dtn_bundle_bcb_unprotect(bundle, store))
+            goto error;
+
+        if (!dtn_bundle_set_data(block, dtn_cbor_string(NULL)))
+            goto error;
+    }
+
+    snprintf(variant, sizeof(variant), "bcb protect+unprotect %zu", size);
+    print_result("bpsec", variant, runs, now_nsecs() - start);
+
+    dtn_bundle_free(bundle);
+    return true;
+error:
+    dtn_bundle_free(bundle);
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_bpsec(uint64_t iterations) {
+
+    const size_t sizes[] = {1024, 64 * 1024, 1024 * 1024};
+
+    dtn_dtn_uri *source = dtn_dtn_uri_decode("dtn://src/1");
+    dtn_buffer *key = dtn_buffer_create(32);
+    dtn_key_store *store = dtn_key_store_create((dtn_key_store_config){0});
+
+    if (!source || !key || !store)
+        goto error;
+
+    for (size_t i = 0; i < 32; i++) {
+        key->start[i] = 0x0b + i;
+    }
+
+    key->length = 32;
+
+    if (!dtn_key_store_set(store, "src/1", key)) {
+        key = NULL;
+        goto error;
+    }
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+
+        if (!bench_bpsec_size(sizes[s], key, store, source, iterations))
+            goto error;
+    }
+
+    dtn_key_store_free(store);
+    dtn_dtn_uri_free(source);
+    return true;
+error:
+    dtn_buffer_free(key);
+    dtn_key_store_free(store);
+    dtn_dtn_uri_free(source);
+    return false;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ROUTING
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/*
+ *      Lookups within a table of ROUTING_ROUTES node routes, with a
+ *      direct route per node and catch all prefix route.
+ */
+
+#define ROUTING_ROUTES 1000
+
+/*---------------------------------------------------------------------------*/
+
+static bool routing_write_routes(const char *path) {
+
+    char file[PATH_MAX] = {0};
+    char key[64] = {0};
+
+    dtn_item *routes = dtn_item_object();
+    dtn_item *uris = dtn_item_object();
+
+    if (!routes || !uris || !dtn_item_object_set(routes, "uris", uris)) {
+        dtn_item_free(uris);
+        goto error;
+    }
+
+    for (uint64_t i = 0; i <= ROUTING_ROUTES; i++) {
+
+        if (i == ROUTING_ROUTES) {
+            snprintf(key, sizeof(key), "*");
+        } else {
+            snprintf(key, sizeof(key), "node%" PRIu64 "/1", i);
+        }
+
+        char json[256] = {0};
+        snprintf(json, sizeof(json),
+                 "{\"interface\":\"eth0\",\"socket\":{\"host\":"
+                 "\"127.0.0.%" PRIu64 "\",\"port\":4556,"
+                 "\"type\":\"UDP\"}}",
+                 i % 250 + 1);
+
+        dtn_item *route = dtn_item_from_json(json);
+
+        if (!dtn_item_object_set(uris, key, route)) {
+            dtn_item_free(route);
+            goto error;
+        }
+    }
+
+    snprintf(file, sizeof(file), "%s/bench.route", path);
+
+    bool result = dtn_item_json_write_file(file, routes);
+    dtn_item_free(routes);
+    return result;
+error:
+    dtn_item_free(routes);
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_routing_lookup(dtn_routing *routing, const char *variant,
+                                 const char *format, uint64_t iterations) {
+
+    dtn_routing_info routes[DTN_ROUTING_LOOKUP_MAX];
+    char eid[64] = {0};
+
+    uint64_t found = 0;
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+
+        snprintf(eid, sizeof(eid), format, i % ROUTING_ROUTES);
+
+        if (0 < dtn_routing_lookup(routing, eid, routes,
+                                   DTN_ROUTING_LOOKUP_MAX))
+            found++;
+    }
+
+    print_result("routing", variant, iterations, now_nsecs() - start);
+    return found == iterations;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_routing(uint64_t iterations) {
+
+    char path[] = "/tmp/dtn_benchmark_XXXXXX";
+    char file[PATH_MAX] = {0};
+    char eid[64] = {0};
+
+    bool result = false;
+    dtn_routing *routing = NULL;
+
+    dtn_event_loop *loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+
+    if (!loop || !mkdtemp(path) || !routing_write_routes(path))
+        goto error;
+
+    dtn_routing_config config = (dtn_routing_config){.loop = loop};
+    strncpy(config.route_config_path, path, PATH_MAX - 1);
+
+    routing = dtn_routing_create(config);
+    if (!routing)
+        goto error;
+
+    if (!bench_routing_lookup(routing, "lookup direct",
+                              "dtn://node%" PRIu64 "/1", iterations) ||
+        !bench_routing_lookup(routing, "lookup prefix",
+                              "dtn://other%" PRIu64 "/1", iterations) ||
+        !bench_routing_lookup(routing, "lookup ipn prefix", "ipn:%" PRIu64 ".1",
+                              iterations))
+        goto error;
+
+    // list of the previous interface, allocated per lookup
+
+    uint64_t found = 0;
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+
+        snprintf(eid, sizeof(eid), "dtn://node%" PRIu64 "/1",
+                 i % ROUTING_ROUTES);
+
+        dtn_dtn_uri *uri = dtn_dtn_uri_decode(eid);
+        dtn_list *list = dtn_routing_get_info_for_uri(routing, uri);
+
+        if (list && list->count(list) > 0)
+            found++;
+
+        dtn_list_free(list);
+        dtn_dtn_uri_free(uri);
+    }
+
+    print_result("routing", "get info for uri", iterations,
+                 now_nsecs() - start);
+
+    result = (found == iterations);
+
+error:
+    dtn_routing_free(routing);
+    dtn_event_loop_free(loop);
+
+    snprintf(file, sizeof(file), "%s/bench.route", path);
+    unlink(file);
+    rmdir(path);
+    return result;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      CGR
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/*
+ *      A day of CGR_CONTACTS random contacts between CGR_NODES nodes.
+ *      Computed lookups start with an empty cache, each computing up to
+ *      DTN_CGR_ROUTES_MAX routes to the destination.
+ */
+
+#define CGR_NODES 100
+#define CGR_CONTACTS 1000
+#define CGR_DAY_USECS (86400 * 1000000ULL)
+
+/*---------------------------------------------------------------------------*/
+
+static uint64_t cgr_random(uint64_t *state) {
+
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state >> 33;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static dtn_cgr *cgr_plan() {
+
+    char from[32] = {0};
+    char to[32] = {0};
+    uint64_t state = 1;
+
+    dtn_cgr *cgr = dtn_cgr_create((dtn_cgr_config){.node = "node0"});
+    if (!cgr)
+        goto error;
+
+    dtn_routing_info hop = (dtn_routing_info){.interface = "eth0"};
+
+    for (uint64_t i = 0; i < CGR_CONTACTS; i++) {
+
+        uint64_t a = cgr_random(&state) % CGR_NODES;
+        uint64_t b = (a + 1 + cgr_random(&state) % (CGR_NODES - 1)) % CGR_NODES;
+
+        snprintf(from, sizeof(from), "node%" PRIu64, a);
+        snprintf(to, sizeof(to), "node%" PRIu64, b);
+
+        uint64_t start = cgr_random(&state) % CGR_DAY_USECS;
+        uint64_t duration = (600 + cgr_random(&state) % 3000) * 1000000;
+
+        dtn_cgr_contact contact =
+            (dtn_cgr_contact){.from = from,
+                              .to = to,
+                              .start_usecs = start,
+                              .end_usecs = start + duration,
+                              .rate = 125000,
+                              .owlt_usecs = 1000000};
+
+        if (0 > dtn_cgr_contact_add(cgr, contact))
+            goto error;
+
+        if (0 == a && !dtn_cgr_set_hop(cgr, to, &hop))
+            goto error;
+    }
+
+    return cgr;
+error:
+    dtn_cgr_free(cgr);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_cgr(uint64_t iterations) {
+
+    char eid[64] = {0};
+    dtn_routing_info routes[DTN_CGR_ROUTES_MAX];
+    dtn_cgr_stats stats = {0};
+
+    bool result = false;
+    dtn_cgr *cgr = NULL;
+
+    uint64_t lookups = 0;
+    uint64_t found = 0;
+    uint64_t nsecs = 0;
+
+    // cold cache, a new plan per round of all destinations
+
+    while (lookups < iterations) {
+
+        cgr = cgr_plan();
+        if (!cgr)
+            goto error;
+
+        uint64_t start = now_nsecs();
+
+        for (uint64_t n = 1; n < CGR_NODES && lookups < iterations; n++) {
+
+            snprintf(eid, sizeof(eid), "dtn://node%" PRIu64 "/1", n);
+
+            if (0 < dtn_cgr_lookup(cgr, eid, 0, 1000, routes, NULL,
+                                   DTN_CGR_ROUTES_MAX))
+                found++;
+
+            lookups++;
+        }
+
+        nsecs += now_nsecs() - start;
+
+        if (lookups < iterations)
+            cgr = dtn_cgr_free(cgr);
+    }
+
+    print_result("cgr", "compute, 1000 contacts", lookups, nsecs);
+
+    if (!dtn_cgr_get_stats(cgr, &stats))
+        goto error;
+
+    fprintf(stdout, "%-20s %-32s %12" PRIu64 " of %" PRIu64 " reachable\n",
+            "cgr", "destinations", found, lookups);
+
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+
+        snprintf(eid, sizeof(eid), "dtn://node%" PRIu64 "/1",
+                 1 + i % (CGR_NODES - 1));
+
+        dtn_cgr_lookup(cgr, eid, 0, 1000, routes, NULL, DTN_CGR_ROUTES_MAX);
+    }
+
+    print_result("cgr", "cached", iterations, now_nsecs() - start);
+
+    // contacts changed, only affected destinations are computed again
+
+    dtn_cgr_stats before = {0};
+
+    if (!dtn_cgr_get_stats(cgr, &before))
+        goto error;
+
+    start = now_nsecs();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+
+        uint64_t id = i % CGR_CONTACTS;
+
+        if (!dtn_cgr_contact_remove(cgr, id))
+            continue;
+
+        snprintf(eid, sizeof(eid), "dtn://node%" PRIu64 "/1",
+                 1 + i % (CGR_NODES - 1));
+
+        dtn_cgr_lookup(cgr, eid, 0, 1000, routes, NULL, DTN_CGR_ROUTES_MAX);
+    }
+
+    print_result("cgr", "contact removed and lookup", iterations,
+                 now_nsecs() - start);
+
+    if (!dtn_cgr_get_stats(cgr, &stats))
+        goto error;
+
+    fprintf(stdout, "%-20s %-32s %12" PRIu64 " computed\n", "cgr",
+            "after contact removals", stats.computed - before.computed);
+
+    result = (found > 0);
+
+error:
+    dtn_cgr_free(cgr);
+    return result;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      ROUTER
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/*
+ *      Datagrams are decoded and forwarded as received at an interface,
+ *      to a next hop at the loopback. Bundles held while the link check
+ *      is pending are flushed when the link is reported up.
+ */
+
+#define ROUTER_PAYLOAD 64
+#define ROUTER_ROUTE "bench.route"
+
+/*---------------------------------------------------------------------------*/
+
+static dtn_buffer *router_datagram(uint64_t sequence) {
+
+    uint8_t payload[ROUTER_PAYLOAD] = {0};
+    uint8_t buffer[DTN_INTERFACE_IP_DATAGRAM_MAX] = {0};
+    uint8_t *next = NULL;
+
+    dtn_buffer *datagram = NULL;
+    dtn_bundle *bundle = dtn_bundle_create();
+    dtn_cbor *data = dtn_cbor_string(NULL);
+
+    if (!bundle || !data)
+        goto error;
+
+    if (!dtn_cbor_set_byte_string(data, payload, ROUTER_PAYLOAD))
+        goto error;
+
+    if (!dtn_bundle_add_primary_block(bundle, 0, 0, "dtn://bench/one",
+                                      "dtn://src/1", "dtn://src/1", 1,
+                                      sequence, 60 * 1000, 0, 0))
+        goto error;
+
+    if (!dtn_bundle_add_hop_count(bundle, 0, 8))
+        goto error;
+
+    if (!dtn_bundle_add_block(bundle, 1, 1, 0, 0, data)) {
+        data = NULL;
+        goto error;
+    }
+
+    data = NULL;
+
+    if (!dtn_bundle_encode(bundle, buffer, sizeof(buffer), &next))
+        goto error;
+
+    datagram = dtn_buffer_create(next - buffer);
+    if (!dtn_buffer_push(datagram, buffer, next - buffer))
+        goto error;
+
+    dtn_bundle_free(bundle);
+    return datagram;
+error:
+    dtn_buffer_free(datagram);
+    dtn_cbor_free(data);
+    dtn_bundle_free(bundle);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static dtn_buffer **router_datagrams_free(dtn_buffer **datagrams,
+                                          uint64_t count) {
+
+    if (!datagrams)
+        return NULL;
+
+    for (uint64_t i = 0; i < count; i++) {
+        dtn_buffer_free(datagrams[i]);
+    }
+
+    free(datagrams);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static dtn_buffer **router_datagrams(uint64_t first, uint64_t count) {
+
+    dtn_buffer **datagrams = calloc(count, sizeof(dtn_buffer *));
+    if (!datagrams)
+        goto error;
+
+    for (uint64_t i = 0; i < count; i++) {
+
+        datagrams[i] = router_datagram(first + i);
+        if (!datagrams[i])
+            goto error;
+    }
+
+    return datagrams;
+error:
+    return router_datagrams_free(datagrams, count);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool router_forward(dtn_router_core *core, dtn_buffer **datagrams,
+                           uint64_t count, const char *variant) {
+
+    dtn_bundle *bundle = NULL;
+    uint8_t *next = NULL;
+    uint64_t failed = 0;
+
+    uint64_t start = now_nsecs();
+
+    for (uint64_t i = 0; i < count; i++) {
+
+        if (DTN_CBOR_MATCH_FULL != dtn_bundle_decode(datagrams[i]->start,
+                                                     datagrams[i]->length,
+                                                     &bundle, &next))
+            return false;
+
+        if (!dtn_router_core_forward(core, bundle))
+            failed++;
+    }
+
+    print_result("router", variant, count, now_nsecs() - start);
+
+    // duplicates are expected to fail
+    if (0 == strcmp(variant, "duplicate drop"))
+        return count == failed;
+
+    return 0 == failed;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool router_write_route(const char *path, uint16_t port) {
+
+    char json[512] = {0};
+    char file[PATH_MAX] = {0};
+
+    snprintf(json, sizeof(json),
+             "{\"uris\":{\"bench/one\":{\"interface\":\"127.0.0.1\","
+             "\"socket\":{\"host\":\"127.0.0.1\",\"port\":%i,"
+             "\"type\":\"UDP\"}}}}",
+             port);
+
+    snprintf(file, sizeof(file), "%s/%s", path, ROUTER_ROUTE);
+
+    dtn_item *route = dtn_item_from_json(json);
+    bool result = dtn_item_json_write_file(file, route);
+    dtn_item_free(route);
+    return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_router(uint64_t iterations) {
+
+    char path[] = "/tmp/dtn_benchmark_XXXXXX";
+    char json[512] = {0};
+    char file[PATH_MAX] = {0};
+
+    bool result = false;
+    int sink = -1;
+
+    dtn_item *sockets = NULL;
+    dtn_event_loop *loop = NULL;
+    dtn_router_core *core = NULL;
+    dtn_router_core_stats stats = {0};
+
+    dtn_buffer **down = router_datagrams(0, iterations);
+    dtn_buffer **up = router_datagrams(iterations, iterations);
+
+    if (!down || !up || !mkdtemp(path))
+        goto error;
+
+    // next hop, never read, datagrams beyond its buffer are dropped
+
+    dtn_socket_configuration next_hop = dtn_socket_load_dynamic_port(
+        (dtn_socket_configuration){.host = "127.0.0.1", .type = UDP});
+
+    sink = dtn_socket_create(next_hop, false, NULL);
+    if (sink < 0)
+        goto error;
+
+    if (!router_write_route(path, next_hop.port))
+        goto error;
+
+    dtn_socket_configuration local = dtn_socket_load_dynamic_port(
+        (dtn_socket_configuration){.host = "127.0.0.1", .type = UDP});
+
+    snprintf(json, sizeof(json),
+             "{\"sockets\":[{\"host\":\"127.0.0.1\",\"port\":%i,"
+             "\"type\":\"UDP\"}]}",
+             local.port);
+
+    sockets = dtn_item_from_json(json);
+
+    loop = dtn_event_loop_default(
+        (dtn_event_loop_config){.max.sockets = 100, .max.timers = 100});
+
+    dtn_router_core_config config =
+        (dtn_router_core_config){.loop = loop,
+                                 .limits.link_check = 1000,
+                                 .limits.contact_queue = iterations};
+
+    strncpy(config.route_config_path, path, PATH_MAX - 1);
+
+    core = dtn_router_core_create(config);
+
+    if (!sockets || !core ||
+        !dtn_router_core_enable_ip_interfaces(core, sockets))
+        goto error;
+
+    // link check pending, all bundles are held
+
+    if (!router_forward(core, down, iterations, "held, link down"))
+        goto error;
+
+    uint64_t start = now_nsecs();
+
+    do {
+
+        loop->run(loop, 1000);
+
+        if (!dtn_router_core_get_stats(core, &stats))
+            goto error;
+
+    } while (stats.held > 0);
+
+    print_result("router", "flush at link up", iterations,
+                 now_nsecs() - start);
+
+    if (!router_forward(core, up, iterations, "forward, link up"))
+        goto error;
+
+    if (!router_forward(core, up, iterations, "duplicate drop"))
+        goto error;
+
+    if (!dtn_router_core_get_stats(core, &stats))
+        goto error;
+
+    result = (2 * iterations == stats.forwarded) &&
+             (iterations == stats.duplicates);
+
+error:
+    dtn_router_core_free(core);
+    dtn_event_loop_free(loop);
+    dtn_item_free(sockets);
+
+    if (sink >= 0)
+        close(sink);
+
+    snprintf(file, sizeof(file), "%s/%s", path, ROUTER_ROUTE);
+    unlink(file);
+    rmdir(path);
+
+    router_datagrams_free(down, iterations);
+    router_datagrams_free(up, iterations);
+    return result;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      EVENT LOOP
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+/*
+ *      Dispatch of ready sockets by the loop backends. Each round makes
+ *      some sockets of a set readable, the loop is run until all ready
+ *      sockets were dispatched. Only the loop runs are timed. Waits are
+ *      the wait calls per dispatched event as counted by the loop, the
+ *      poll loop does not count them.
+ */
+
+#define EVENT_LOOP_SOCKETS_MAX 256
+
+struct event_loop_case {
+
+    size_t sockets;
+    size_t ready;
+};
+
+/*---------------------------------------------------------------------------*/
+
+static bool dispatch_read(int fd, uint8_t events, void *data) {
+
+    UNUSED(events);
+
+    uint64_t *dispatched = (uint64_t *)data;
+    char byte = 0;
+
+    if (1 != read(fd, &byte, 1))
+        return false;
+
+    (*dispatched)++;
+    return true;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_event_loop_case(dtn_event_loop_backend backend,
+                                  struct event_loop_case c,
+                                  uint64_t iterations) {
+
+    char variant[64] = {0};
+    int pairs[EVENT_LOOP_SOCKETS_MAX][2];
+
+    bool result = false;
+    size_t opened = 0;
+    uint64_t dispatched = 0;
+    uint64_t nsecs = 0;
+
+    dtn_event_loop_config config = dtn_event_loop_config_default();
+    config.backend = backend;
+    config.max.sockets = 2 * EVENT_LOOP_SOCKETS_MAX + 100;
+
+    dtn_event_loop *loop = dtn_os_event_loop(config);
+    if (!loop)
+        goto error;
+
+    for (opened = 0; opened < c.sockets; opened++) {
+
+        if (0 != socketpair(AF_LOCAL, SOCK_STREAM, 0, pairs[opened]))
+            goto error;
+
+        if (!dtn_event_loop_set(loop, pairs[opened][0], DTN_EVENT_IO_IN,
+                                &dispatched, dispatch_read)) {
+
+            close(pairs[opened][0]);
+            close(pairs[opened][1]);
+            goto error;
+        }
+    }
+
+    uint64_t rounds = iterations / c.ready;
+    if (0 == rounds)
+        rounds = 1;
+
+    for (uint64_t round = 0; round < rounds; round++) {
+
+        // ready sockets are spread over the set
+
+        for (size_t i = 0; i < c.ready; i++) {
+
+            size_t index = (round + i * (c.sockets / c.ready)) % c.sockets;
+
+            if (1 != write(pairs[index][1], "x", 1))
+                goto error;
+        }
+
+        uint64_t expected = dispatched + c.ready;
+        uint64_t start = now_nsecs();
+
+        while (dispatched < expected) {
+
+            if (!dtn_event_loop_run(loop, DTN_RUN_ONCE))
+                goto error;
+        }
+
+        nsecs += now_nsecs() - start;
+    }
+
+    dtn_event_loop_statistics stats = dtn_event_loop_get_statistics(loop);
+
+    snprintf(variant, sizeof(variant), "%s, %zu of %zu ready",
+             dtn_event_loop_backend_to_string(backend), c.ready, c.sockets);
+
+    print_result("event_loop", variant, dispatched, nsecs);
+
+    fprintf(stdout, "%-20s %-32s %12.3f waits/event\n", "event_loop",
+            variant, stats.syscalls_per_event);
+
+    result = (rounds * c.ready == dispatched);
+
+error:
+
+    // pending io_uring polls hold the fd, unset before close
+
+    for (size_t i = 0; i < opened; i++) {
+
+        if (loop)
+            dtn_event_loop_unset(loop, pairs[i][0], NULL);
+
+        close(pairs[i][0]);
+        close(pairs[i][1]);
+    }
+
+    dtn_event_loop_free(loop);
+    return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool bench_event_loop(uint64_t iterations) {
+
+    dtn_event_loop_backend backends[] = {DTN_EVENT_LOOP_BACKEND_POLL,
+                                         DTN_EVENT_LOOP_BACKEND_EPOLL,
+                                         DTN_EVENT_LOOP_BACKEND_IO_URING};
+
+    struct event_loop_case cases[] = {
+        {.sockets = 1, .ready = 1},
+        {.sockets = 16, .ready = 16},
+        {.sockets = EVENT_LOOP_SOCKETS_MAX, .ready = EVENT_LOOP_SOCKETS_MAX},
+        {.sockets = EVENT_LOOP_SOCKETS_MAX, .ready = 1}};
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+
+        for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+
+            if (!bench_event_loop_case(backends[b], cases[i], iterations))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ *      ------------------------------------------------------------------------
+ *
+ *      MAIN
+ *
+ *      ------------------------------------------------------------------------
+ */
+
+static benchmark benchmarks[] = {
+
+    {.name = "cbor_array",
+     .description = "indexed access and block lookup on bundles",
+     .run = bench_cbor_array},
+
+    {.name = "dict",
+     .description = "chained against flat dict at 1k, 100k and 1M entries",
+     .run = bench_dict},
+
+    {.name = "bundle_buffer",
+     .description = "fragment reassembly from 1 to 8 pushing threads",
+     .run = bench_bundle_buffer},
+
+    {.name = "timer_wheel",
+     .description = "set, unset and expiry of timers within a timer wheel",
+     .run = bench_timer_wheel},
+
+    {.name = "bundle_encode",
+     .description = "bundle encoding with CRC blocks, cached and changed",
+     .run = bench_bundle_encode},
+
+    {.name = "crc",
+     .description = "CRC engines and bundle CRC checks at 1K, 64K and 1M",
+     .run = bench_crc},
+
+    {.name = "bpsec",
+     .description = "BIB and BCB processing of 1K, 64K and 1M payloads",
+     .run = bench_bpsec},
+
+    {.name = "routing",
+     .description = "route lookup of 1000 routes, exact and prefix",
+     .run = bench_routing},
+
+    {.name = "cgr",
+     .description = "contact graph routes of a 1000 contact plan",
+     .run = bench_cgr},
+
+    {.name = "router",
+     .description = "decode and forward of bundles, held and sent at loopback",
+     .run = bench_router},
+
+    {.name = "event_loop",
+     .description = "socket dispatch of the poll, epoll and io_uring loops",
+     .run = bench_event_loop},
+
+    {0}};
+
+/*---------------------------------------------------------------------------*/
+
+static void print_usage() {
+
+    fprintf(stdout, "\n");
+    fprintf(stdout, "Run micro benchmarks\n");
+    fprintf(stdout, "\n");
+    fprintf(stdout, "USAGE              [OPTIONS]...\n");
+    fprintf(stdout, "\n");
+    fprintf(stdout, "               -b,     --benchmark   run benchmark "
+                    "(default all)\n");
+    fprintf(stdout, "               -n,     --iterations  number of "
+                    "iterations\n");
+    fprintf(stdout, "               -h,     --help        print this help\n");
+    fprintf(stdout, "\n");
+    fprintf(stdout, "BENCHMARKS\n");
+    fprintf(stdout, "\n");
+
+    for (size_t i = 0; benchmarks[i].name; i++) {
+        fprintf(stdout, "               %-20s %s\n", benchmarks[i].name,
+                benchmarks[i].description);
+    }
+
+    fprintf(stdout, "\n");
+    return;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool read_command_line_input(int argc, char *argv[], const char **name,
+                             uint64_t *iterations) {
+
+    int c = 0;
+    int option_index = 0;
+
+    while (1) {
+
+        static struct option long_options[] = {
+
+            {"benchmark", required_argument, 0, 'b'},
+            {"iterations", required_argument, 0, 'n'},
+            {"help", no_argument, 0, 'h'},
+            {0, 0, 0, 0}};
+
+        c = getopt_long(argc, argv, "?hb:n:", long_options, &option_index);
+
+        /* Detect the end of the options. */
+        if (c == -1)
+            break;
+
+        switch (c) {
+
+        case 'b':
+            *name = optarg;
+            break;
+
+        case 'n':
+            *iterations = strtoull(optarg, NULL, 10);
+            if (0 == *iterations)
+                goto error;
+            break;
+
+        default:
+            print_usage();
+            goto error;
+        }
+    }
+
+    return true;
+error:
+    return false;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+
+    int retval = EXIT_FAILURE;
+
+    const char *name = NULL;
+    uint64_t iterations = DEFAULT_ITERATIONS;
+
+    if (!read_command_line_input(argc, argv, &name, &iterations))
+        goto error;
+
+    bool found = false;
+
+    for (size_t i = 0; benchmarks[i].name; i++) {
+
+        if (name && (0 != dtn_string_compare(name, benchmarks[i].name)))
+            continue;
+
+        found = true;
+
+        if (!benchmarks[i].run(iterations)) {
+            fprintf(stderr, "benchmark %s failed\n", benchmarks[i].name);
+            goto error;
+        }
+    }
+
+    if (!found) {
+        print_usage();
+        goto error;
+    }
+
+    retval = EXIT_SUCCESS;
+error:
+    return retval;
+}